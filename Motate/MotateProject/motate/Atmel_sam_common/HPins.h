@@ -3,6 +3,17 @@
 #ifndef HPins_H_ONCE
 #define HPins_H_ONCE
 
+#include <stdint.h>
+#include <atomic>
+
+/* Cortex-M core intrinsics. The simulated interrupts are host threads, which can't be
+ * masked, so the PRIMASK calls do nothing here. __DMB() is a full fence. */
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) {}
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __DMB(void) { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
 
 #define ID_SUPC   ( 0) /**< \brief Supply Controller (SUPC) */
 #define ID_RSTC   ( 1) /**< \brief Reset Controller (RSTC) */
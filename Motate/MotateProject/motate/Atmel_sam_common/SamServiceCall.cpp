@@ -38,7 +38,8 @@ extern "C" {
 
 namespace Motate {
     //volatile uint32_t _internal_pendsv_handler_number = 0;
-    ServiceCallEvent * volatile ServiceCallEvent::_first_service_call = nullptr;
+    ServiceCallEvent *ServiceCallEvent::_first_registered = nullptr;
+    volatile bool ServiceCallEvent::_level_running[kServiceCallLevels] = {};
 
     // We'll support just ten for now. These take up space when not using LTO.
     template<> void ServiceCall<  0 >::interrupt() ;
@@ -89,37 +90,3 @@ namespace Motate {
     //template<> uint32_t ServiceCall< 10 >::_interrupt_level = 0;
     //template<> std::function<void(void)> ServiceCall< 10 >::_altInterruptHandler {};
 }
-
-#if 0
-void PendSV_Handler() {
-
-#define _temp_call_handler(n) \
-if (Motate::_internal_pendsv_handler_number == n) {\
-    if (Motate::ServiceCall< n >::interrupt) {\
-        Motate::ServiceCall< n >::interrupt();\
-    } else {\
-        Motate::ServiceCall< n >::alternate_interrupt();\
-    }\
-}
-    Motate::SamCommon::sync();
-
-         _temp_call_handler( 0)
-    else _temp_call_handler( 1)
-    else _temp_call_handler( 2)
-    else _temp_call_handler( 3)
-    else _temp_call_handler( 4)
-    else _temp_call_handler( 5)
-    else _temp_call_handler( 6)
-    else _temp_call_handler( 7)
-    else _temp_call_handler( 8)
-    else _temp_call_handler( 9)
-    else _temp_call_handler(10)
-#undef _temp_call_handler
-
-}
-#endif
-
-
-void PendSV_Handler() {
-
-}
@@ -49,119 +49,91 @@
 namespace Motate {
     typedef const uint32_t service_call_number;
 
-    //extern volatile uint32_t _internal_pendsv_handler_number;
+    /* Service calls - deferred work at a few priority levels
+     *
+     * A ServiceCall is a software interrupt that doesn't need a spare timer. call() (or
+     * setInterruptPending(), for code written against a TimerChannel) queues it, and it runs
+     * at the level given to setInterrupts() with the kInterruptPriority... flags. Each level
+     * drains its queue in turn before sleeping: everything queued at a level runs, including
+     * calls made while it was running, and a call made while its handler runs runs it again,
+     * as a pending NVIC interrupt would.
+     *
+     * In the simulator each level is a thread (see win/th.cpp), so levels run alongside each
+     * other like the interrupts they stand for, and calls on one level run one at a time.
+     */
+
+    static constexpr uint8_t kServiceCallLevels = 5;    // kInterruptPriorityHighest .. kInterruptPriorityLowest
+
+    // Wakes the simulator thread running level (see win/th.cpp)
+    void SimServiceCallSignal(const uint8_t level);
 
     struct ServiceCallEvent {
         std::function<void(void)> _callback {};
-        ServiceCallEvent * volatile _next = nullptr;
+        ServiceCallEvent *_next_registered = nullptr;   // every service call, newest first
         volatile bool _queued = false;
+        uint8_t _level = kServiceCallLevels - 1;        // start at the lowest
 
-        static ServiceCallEvent * volatile _first_service_call; // the pointer is volatile
+        static ServiceCallEvent *_first_registered;     // service calls are static objects, so this is built before main()
+        static volatile bool _level_running[kServiceCallLevels];
 
-        uint32_t _interrupt_level = kInterruptPriorityLowest; // start at the lowest
-
-        //ServiceCallEvent(std::function<void(void)> e) : _callback{e} {};
-        //ServiceCallEvent(std::function<void(void)> &&e) : _callback{std::move(e)} {};
+        ServiceCallEvent() : _next_registered{_first_registered} { _first_registered = this; };
 
         void _add_to_queue() {
-            if (_queued) {
-                _debug_print_num(); svc_call_debug("11");
-                return;
-            }
-
             _queued = true;
-            _next = nullptr;
-
-            bool needs_repended = false;
-
-            { // section with the interrupts off
-                
-
+            _debug_print_num(); svc_call_debug("11");
+            SimServiceCallSignal(_level);
+        };
 
-                if (_first_service_call == nullptr) {
-                    _debug_print_num(); svc_call_debug("111");
-                    _first_service_call = this;
-                    _pend();
+        // IMPORTANT: HIGHER priority levels have a LOWER number
+        void _setLevel(const uint32_t interrupts) {
+            for (uint8_t level = 0; level < kServiceCallLevels; level++) {
+                if (interrupts & (kInterruptPriorityHighest << level)) {
+                    _level = level;
                     return;
                 }
-
-    //            // This happens when we are already in a pendSV context, and we are adding a second one.
-    //            // This can also happen if there was already a second one, and we just pre-empted it with a
-    //            // higher-priority one.
-    //            // IMPORTANT: HIGHER priority tasks have a LOWER number
-    //            if (_first_service_call->_interrupt_level > _interrupt_level) {
-    //                _debug_print_num(); svc_call_debug("shuffle! ");
-    //                this->_next = _first_service_call;
-    //                _first_service_call = this;
-    //                _pend();
-    //                return;
-    //            }
-
-                ServiceCallEvent *walker = _first_service_call;
-                while (walker->_next != nullptr) {
-                    // put this in front of lower priority tasks
-                    // IMPORTANT: HIGHER priority tasks have a LOWER number
-                    if (walker->_next->_interrupt_level > _interrupt_level) {
-                        if (walker == _first_service_call) {
-                            needs_repended = true;
-                        }
-                        break;
-                    }
-                    walker = walker->_next;
-                }
-
-                _next = walker->_next; // in case we aren't putting it last in line
-                walker->_next = this;
-
-                _debug_print_num(); svc_call_debug("🖐🏻");
-            } // enable interrupts again
-
-            // If the first_service_call's priority is lower (has a higher number)
-            // then we'll pend another PendSV to esure the correct level.
-            if (needs_repended) {
-                _pend();
             }
         };
 
-        // This is static, it doesn't use any local variables
-        void _pend() {
-
-
-
-        }
-
-        // Pop the first thing off the list and return it.
-        static auto _pop() {
-            
-
-            // Other than here, we never modify the first one when adding,
-            // but we might put a higher priority
-            // in _first_service_call->_next. We might pop that one.
-
-            // IMPORTANT: HIGHER priority tasks have a LOWER number
-            if (_first_service_call->_next &&
-                (_first_service_call->_next->_interrupt_level < _first_service_call->_interrupt_level))
-            {
-                ServiceCallEvent *popped = _first_service_call->_next;
-                _first_service_call->_next = _first_service_call->_next->_next;
-                popped->_next = nullptr;
-
-                popped->_debug_print_num(); svc_call_debug("⤵︎");
-                return popped;
+        // We were queued and signaled, then called.
+        void _call() {
+            _debug_print_num(); svc_call_debug("66");
+            if (_callback) {
+                _callback();
+            } else {
+                interrupt();
             }
+        };
 
-            // pop the first one off the list
-            ServiceCallEvent *popped = _first_service_call;
-            _first_service_call = _first_service_call->_next;
-            popped->_next = nullptr;
-
-            popped->_debug_print_num(); svc_call_debug("66");
-            return popped;
+        // Run everything queued at level until nothing is. Called from the level's thread.
+        static void _runLevel(const uint8_t level) {
+            _level_running[level] = true;
+            bool ran;
+            do {
+                ran = false;
+                for (ServiceCallEvent *walker = _first_registered; walker != nullptr; walker = walker->_next_registered) {
+                    if ((walker->_level == level) && walker->_queued) {
+                        walker->_queued = false;        // before the call, so a call made meanwhile runs it again
+                        walker->_call();
+                        ran = true;
+                    }
+                }
+            } while (ran);
+            _level_running[level] = false;
         };
 
-        // We were queued and pended, then called.
-        void _call() {
-         
+        // true when nothing is queued or running on any level
+        static bool _isIdle() {
+            for (uint8_t level = 0; level < kServiceCallLevels; level++) {
+                if (_level_running[level]) {
+                    return false;
+                }
+            }
+            for (ServiceCallEvent *walker = _first_registered; walker != nullptr; walker = walker->_next_registered) {
+                if (walker->_queued) {
+                    return false;
+                }
+            }
+            return true;
         };
 
         virtual void _debug_print_num() {;};
@@ -171,14 +143,8 @@ namespace Motate {
 
     template <service_call_number svcNumber>
     struct ServiceCall final : ServiceCallEvent {
-        //std::function<void(void)> _altInterruptHandler;
 
-        ServiceCall() {
-            //_callback = [&](){
-            //    interrupt();
-            //};
-            //_first_service_call = nullptr;
-        };
+        ServiceCall() : ServiceCallEvent{} {};
 
         // Interface that makes sense for this object...
         void call() {
@@ -190,17 +156,17 @@ namespace Motate {
             call();
         };
 
+        // Only the kInterruptPriority... flags matter, the rest are ignored
         void setInterrupts(const uint32_t interrupts) {
-            _interrupt_level = interrupts;
+            _setLevel(interrupts);
         };
 
         // Stub to match the interface of Timer
         uint16_t getInterruptCause() {
-//            SCB->ICSR |= SCB_ICSR_PENDSVCLR_Msk;
-//            SamCommon::sync();
             return 0;
         };
 
+        // A handler set here is used instead of interrupt()
         void setInterruptHandler(std::function<void(void)> &&handler) {
             _callback = std::move(handler);
         }
@@ -221,13 +187,6 @@ namespace Motate {
             }
         };
 
-        // If the main interrupt isn't overidden, then we'll this one
-        //static void alternate_interrupt() {
-        //    if (_altInterruptHandler) {
-        //        _altInterruptHandler();
-        //    }
-        //};
-
         // Override this to implement this call
         void interrupt() override;
     };
@@ -35,11 +35,113 @@ namespace Motate {
 
 	Timer<SysTickTimerNum> SysTickTimer;
 	volatile uint32_t Timer<SysTickTimerNum>::_motateTickCount = 0;
+	TimeoutWheel Timer<SysTickTimerNum>::_timeouts;
+
+	/* TimeoutWheel (see SamTimers.h) */
+
+	void TimeoutWheel::_file(Timeout *t) {
+		uint32_t ahead = t->deadline_ - now_;
+		Timeout **slot;
+
+		if (ahead < kSlots) {
+			slot = &near_[t->deadline_ & kSlotMask];
+		} else if (ahead < kSlots * kSlots) {
+			slot = &far_[(t->deadline_ >> kSlotBits) & kSlotMask];
+		} else {
+			slot = &far_[((now_ >> kSlotBits) + kSlotMask) & kSlotMask];	// filed again when it comes up
+		}
+		t->next_ = *slot;
+		if (t->next_ != nullptr) {
+			t->next_->pprev_ = &t->next_;
+		}
+		t->pprev_ = slot;
+		*slot = t;
+	}
+
+	void TimeoutWheel::_unlink(Timeout *t) {
+		*t->pprev_ = t->next_;
+		if (t->next_ != nullptr) {
+			t->next_->pprev_ = t->pprev_;
+		}
+		t->next_ = nullptr;
+		t->pprev_ = nullptr;
+	}
+
+	void TimeoutWheel::add(Timeout *t) {
+		_lock();
+		if (t->pprev_ != nullptr) {
+			_unlink(t);
+		}
+		t->expired_ = false;
+		t->deadline_ = t->start_ + t->delay_ + 1;	// past once more than delay ticks have elapsed
+		if ((int32_t)(t->deadline_ - now_) <= 0) {
+			t->deadline_ = now_ + 1;
+		}
+		_file(t);
+		_unlock();
+	}
+
+	void TimeoutWheel::remove(Timeout *t) {
+		_lock();
+		if (t->pprev_ != nullptr) {
+			_unlink(t);
+		}
+		_unlock();
+	}
+
+	void TimeoutWheel::advance(const uint32_t tick) {
+		_lock();
+		now_ = tick;
+		if ((tick & kSlotMask) == 0) {				// start of a block - move its far slot down
+			Timeout *t = far_[(tick >> kSlotBits) & kSlotMask];
+			far_[(tick >> kSlotBits) & kSlotMask] = nullptr;
+			while (t != nullptr) {
+				Timeout *next = t->next_;
+				_file(t);
+				t = next;
+			}
+		}
+		Timeout *t = near_[tick & kSlotMask];
+		near_[tick & kSlotMask] = nullptr;
+		while (t != nullptr) {
+			Timeout *next = t->next_;
+			t->next_ = nullptr;
+			t->pprev_ = nullptr;
+			t->expired_ = true;
+			if (t->callback_ != nullptr) {
+				t->callback_();
+			}
+			t = next;
+		}
+		_unlock();
+	}
+
+	uint32_t TimeoutWheel::ticksToNextDeadline() {
+		uint32_t ticks = 0;
+
+		_lock();
+		for (uint32_t i = 1; i <= kSlots; i++) {
+			if (near_[(now_ + i) & kSlotMask] != nullptr) {
+				ticks = i;
+				break;
+			}
+		}
+		for (uint32_t i = 0; i < kSlots; i++) {			// parked deadlines can be in any far slot
+			for (Timeout *t = far_[i]; t != nullptr; t = t->next_) {
+				uint32_t ahead = t->deadline_ - now_;
+				if ((ticks == 0) || (ahead < ticks)) {
+					ticks = ahead;
+				}
+			}
+		}
+		_unlock();
+		return (ticks);
+	}
 } // namespace Motate
 
 void SysTick_Handler(void)
 {
-	Motate::SysTickTimer._increment();
+	Motate::SysTickTimer._increment();		// also advances the Timeout wheel
 
 	//if (Motate::SysTickTimer.interrupt) {
 	//	Motate::SysTickTimer.interrupt();
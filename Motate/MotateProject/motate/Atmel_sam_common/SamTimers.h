@@ -6,6 +6,7 @@
 #include "HPins.h"
 #include <functional> // for std::function and related
 #include <type_traits> // for std::extent and std::alignment_of
+#include <atomic>
 #include <time.h>
 
 
@@ -87,11 +88,15 @@ namespace Motate {
 
     typedef const uint8_t timer_number;
 
+    // Wakes the simulator thread servicing timerNum (see win/th.cpp)
+    void SimTimerSignal(const uint8_t timerNum);
+
 
     template <uint8_t timerNum>
     struct Timer {
 
 		int irqEn;
+		uint32_t elapsed_ticks;		// timer periods the last interrupt accounted for (simulator batching)
 
         Timer() { init(); };
         Timer(const TimerMode mode, const uint32_t freq) {
@@ -101,6 +106,7 @@ namespace Motate {
 
 		void init() { 
 			irqEn = 0;
+			elapsed_ticks = 1;
 		}
 
         int32_t setModeAndFrequency(const TimerMode mode, uint32_t freq) {
@@ -111,6 +117,7 @@ namespace Motate {
         }
         void start() {
 			irqEn = 1;
+			SimTimerSignal(timerNum);
         };
         void stop() {
 			irqEn = 0;
@@ -120,6 +127,7 @@ namespace Motate {
         }
         void setInterruptPending() {
 			irqEn = 1;
+			SimTimerSignal(timerNum);
         }
         // Placeholder for user code.
         static void interrupt();
@@ -143,10 +151,46 @@ namespace Motate {
         SysTickEvent *next;
     };
 
+    /* TimeoutWheel - the armed Timeouts, filed by deadline
+     *
+     * Two levels of 64 slots: near slots are one tick (ms) each and cover the next 64 ms,
+     * far slots are 64 ticks each and cover about 4 seconds. At the start of each 64 tick
+     * block the far slot for that block is moved down to the near slots, and each tick
+     * expires the whole near slot for that tick, so the cost per tick doesn't depend on how
+     * many Timeouts are armed. Deadlines past the far span are parked in the last far slot
+     * and filed again as it comes up.
+     *
+     * The wheel is advanced by SysTick. A spin lock stands in for masking SysTick while a
+     * Timeout is set or cleared from another thread.
+     */
+    struct Timeout;
+    struct TimeoutWheel {
+        static const uint8_t kSlotBits = 6;
+        static const uint32_t kSlots = (1 << kSlotBits);
+        static const uint32_t kSlotMask = kSlots - 1;
+
+        Timeout *near_[kSlots];         // one tick per slot
+        Timeout *far_[kSlots];          // kSlots ticks per slot
+        uint32_t now_;                  // tick the wheel has advanced to
+        std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+
+        void add(Timeout *t);
+        void remove(Timeout *t);
+        void advance(const uint32_t tick);
+        uint32_t ticksToNextDeadline();
+
+    private:
+        void _lock() { while (lock_.test_and_set(std::memory_order_acquire)) {} };
+        void _unlock() { lock_.clear(std::memory_order_release); };
+        void _file(Timeout *t);
+        void _unlink(Timeout *t);
+    };
+
     static const timer_number SysTickTimerNum = 0xFF;
     template <>
 	struct Timer<SysTickTimerNum> {
 		static volatile uint32_t _motateTickCount;
+		static TimeoutWheel _timeouts;
 		SysTickEvent *firstEvent = nullptr;
 
 		Timer() { init(); };
@@ -165,6 +209,13 @@ namespace Motate {
 
 		void _increment() {
 			_motateTickCount++;
+			_timeouts.advance(_motateTickCount);
+		};
+
+		// Ticks until the next Timeout expires, or 0 if none is armed. The simulator uses
+		// this to skip idle time.
+		uint32_t ticksToNextDeadline() {
+			return _timeouts.ticksToNextDeadline();
 		};
 
 		void registerEvent(SysTickEvent *new_event) {
@@ -225,30 +276,52 @@ namespace Motate {
 
     }
 
+    /* Timeout - a one-shot deadline kept on the SysTick timer wheel
+     *
+     * set() arms the Timeout and files it on the wheel, and SysTick marks it past when
+     * the delay has elapsed, so isPast() is a flag read rather than a clock compare.
+     * An optional callback is run from SysTick when the Timeout expires, so a task can be
+     * woken instead of polling. The callback must not set or clear Timeouts.
+     */
     struct Timeout {
         uint32_t start_, delay_;
-        Timeout() : start_ {0}, delay_ {0} {};
+        uint32_t deadline_;                 // SysTick value the Timeout expires at
+        volatile bool expired_;
+        void (*callback_)(void);            // run from SysTick on expiry, if set
+        Timeout *next_;                     // wheel slot list
+        Timeout **pprev_;                   // link that points here, nullptr if not on the wheel
+
+        Timeout() : start_ {0}, delay_ {0}, deadline_ {0}, expired_ {false}, callback_ {nullptr}, next_ {nullptr}, pprev_ {nullptr} {};
+        Timeout(void (*callback)(void)) : Timeout() { callback_ = callback; };
+        Timeout(const Timeout &) = delete;  // the wheel links to the object itself
+        ~Timeout() { clear(); };
 
         bool isSet() {
             return (start_ > 0);
         }
 
         bool isPast() {
-            if (!isSet()) {
-                return false;
-            }
-            return ((SysTickTimer.getValue() - start_) > delay_);
+            return (expired_);
         };
 
         void set(uint32_t delay) {
             start_ = SysTickTimer.getValue();
             delay_ = delay;
+            SysTickTimer._timeouts.add(this);
         };
 
         void clear() {
+            if (pprev_ != nullptr) {
+                SysTickTimer._timeouts.remove(this);
+            }
             start_ = 0;
             delay_ = 0;
+            expired_ = false;
         }
+
+        void setCallback(void (*callback)(void)) {
+            callback_ = callback;
+        };
     };
 
 } // namespace Motate
@@ -0,0 +1,308 @@
+/*
+ * th.cpp - POSIX simulator timer threads
+ *
+ *  The same timer shim as win/th.cpp, on pthreads: the DDA, exec, forward planning and
+ *  SysTick interrupts each run on a thread, the software interrupts are woken by events,
+ *  and real time is paced with clock_nanosleep() on CLOCK_MONOTONIC. Build with SIM_POSIX
+ *  defined instead of WIN32 and link with -pthread.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "MotateTimers.h"
+#include "MotateServiceCall.h"
+
+using Motate::TimerChannel;
+using Motate::ServiceCallEvent;
+
+typedef TimerChannel<3, 0> dda_timer_type;	// stepper pulse generation in stepper.cpp
+extern   dda_timer_type dda_timer;
+
+#define SIM_DDA_FREQUENCY       200000      // simulated DDA interrupt rate (Hz)
+#define SIM_DDA_BATCH_MS        1           // DDA thread wakes this often and runs the ticks that came due
+#define SIM_DDA_MAX_LAG_MS      100         // resync rather than burst if the host stalls longer than this
+#define SIM_TIMER_EVENTS        8           // one auto-reset event per timer number (masked)
+
+/*
+ * SIM_VIRTUAL_TIME - run motion faster than real time (see win/th.cpp)
+ */
+#ifndef SIM_VIRTUAL_TIME
+#define SIM_VIRTUAL_TIME        false
+#endif
+#define SIM_REPORT_IDLE_MS      1000        // report a motion burst after this much idle time
+
+void SysTick_Handler(void);
+
+
+static bool sim_virtual_time = SIM_VIRTUAL_TIME;
+static bool sim_report_bursts = true;
+static bool sim_interrupts = true;
+static volatile bool sim_skip_idle = false;
+
+static struct simVirtualClock {
+	volatile uint64_t burst_ticks;		// DDA ticks in the current motion burst
+	volatile uint64_t total_ticks;		// DDA ticks in all reported bursts
+	volatile uint32_t idle_ms;			// real ms the DDA has been idle since the last burst
+	volatile uint64_t motion_ticks;		// DDA ticks since startup
+} sim;
+
+static void _sim_wait_for_software_interrupts()
+{
+	while (!ServiceCallEvent::_isIdle()) {
+		sched_yield();
+	}
+}
+
+static void _sim_report_motion()
+{
+	if ((sim.burst_ticks != 0) && (++sim.idle_ms >= SIM_REPORT_IDLE_MS)) {
+		sim.total_ticks += sim.burst_ticks;
+		if (sim_report_bursts) {
+			printf("[sim] motion %.3f s, total %.3f s simulated\n",
+				(double)sim.burst_ticks / SIM_DDA_FREQUENCY, (double)sim.total_ticks / SIM_DDA_FREQUENCY);
+		}
+		sim.burst_ticks = 0;
+	}
+}
+
+/*
+ * xio_tim_virtual_time() - select virtual or real time (call before xio_tim_Init())
+ * xio_tim_motion_seconds() - simulated time spent moving so far (virtual time only)
+ */
+void xio_tim_virtual_time(const bool virtual_time, const bool report_bursts)
+{
+	sim_virtual_time = virtual_time;
+	sim_report_bursts = report_bursts;
+}
+
+double xio_tim_motion_seconds(void)
+{
+	return ((double)sim.motion_ticks / SIM_DDA_FREQUENCY);
+}
+
+/*
+ * xio_tim_interrupts() - start the stepper interrupt threads in xio_tim_Init() (default true)
+ */
+void xio_tim_interrupts(const bool enable)
+{
+	sim_interrupts = enable;
+}
+
+/*
+ * xio_tim_skip_idle() - jump idle virtual time to the next Timeout deadline (see win/th.cpp)
+ */
+void xio_tim_skip_idle(const bool skip)
+{
+	sim_skip_idle = skip;
+}
+
+static void _sim_skip_to_deadline()
+{
+	if (!sim_skip_idle || !ServiceCallEvent::_isIdle()) {
+		return;
+	}
+	for (uint32_t ticks = Motate::SysTickTimer.ticksToNextDeadline(); ticks > 1; ticks--) {
+		SysTick_Handler();
+	}
+}
+
+/*
+ * Simulated interrupt signalling
+ *
+ *  An auto-reset event per timer, as on Windows: SimTimerSignal() sets it and wakes one
+ *  waiter, and a wait consumes it.
+ */
+
+struct SimTimerEvent {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool set;
+
+	SimTimerEvent() : set{false} {
+		pthread_mutex_init(&lock, NULL);
+		pthread_cond_init(&cond, NULL);
+	}
+	void signal() {
+		pthread_mutex_lock(&lock);
+		set = true;
+		pthread_cond_signal(&cond);
+		pthread_mutex_unlock(&lock);
+	}
+	void wait() {
+		pthread_mutex_lock(&lock);
+		while (!set) {
+			pthread_cond_wait(&cond, &lock);
+		}
+		set = false;
+		pthread_mutex_unlock(&lock);
+	}
+};
+
+static SimTimerEvent &_timer_event(const uint8_t timerNum)
+{
+	static SimTimerEvent events[SIM_TIMER_EVENTS];	// constructed on first use - timers may start before xio_tim_Init()
+	return events[timerNum & (SIM_TIMER_EVENTS-1)];
+}
+
+void Motate::SimTimerSignal(const uint8_t timerNum)
+{
+	_timer_event(timerNum).signal();
+}
+
+static SimTimerEvent &_service_call_event(const uint8_t level)
+{
+	static SimTimerEvent events[Motate::kServiceCallLevels];
+	return events[level];
+}
+
+void Motate::SimServiceCallSignal(const uint8_t level)
+{
+	_service_call_event(level).signal();
+}
+
+static uint64_t _now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+// sleep until an absolute CLOCK_MONOTONIC deadline, then advance it by period_ns
+static void _sleep_until(struct timespec &deadline, const long period_ns)
+{
+	deadline.tv_nsec += period_ns;
+	while (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0) {}	// EINTR - sleep again
+}
+
+/*
+ * DDA_Thread_virtual() - run the DDA interrupt as fast as the host allows, advancing virtual time
+ */
+static void *DDA_Thread_virtual(void *arg)
+{
+	SimTimerEvent &run_event = _timer_event(3);
+	uint32_t ticks_in_ms = 0;
+
+	for (;;)
+	{
+		if (dda_timer.irqEn == 0) {
+			run_event.wait();
+			continue;
+		}
+		sim.idle_ms = 0;
+		while (dda_timer.irqEn != 0) {
+			dda_timer.elapsed_ticks = 1;
+			dda_timer.interrupt();
+			sim.burst_ticks += dda_timer.elapsed_ticks;
+			sim.motion_ticks += dda_timer.elapsed_ticks;
+			ticks_in_ms += dda_timer.elapsed_ticks;
+			while (ticks_in_ms >= SIM_DDA_FREQUENCY/1000) {
+				ticks_in_ms -= SIM_DDA_FREQUENCY/1000;
+				SysTick_Handler();
+			}
+			_sim_wait_for_software_interrupts();
+		}
+	}
+	return (NULL);
+}
+
+/*
+ * DDA_Thread() - run the DDA interrupt at SIM_DDA_FREQUENCY on average
+ *
+ *  Wakes every SIM_DDA_BATCH_MS on an absolute deadline and runs the ticks that came due.
+ */
+static void *DDA_Thread(void *arg)
+{
+	SimTimerEvent &run_event = _timer_event(3);
+	struct timespec deadline;
+	uint64_t start_ns, ticks_done, ticks_due;
+
+	for (;;)
+	{
+		if (dda_timer.irqEn == 0) {
+			run_event.wait();
+			continue;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		start_ns = _now_ns();
+		ticks_done = 0;
+		while (dda_timer.irqEn != 0) {
+			_sleep_until(deadline, SIM_DDA_BATCH_MS * 1000000);
+			ticks_due = (_now_ns() - start_ns) * SIM_DDA_FREQUENCY / 1000000000;
+			if ((ticks_due - ticks_done) > (uint64_t)SIM_DDA_FREQUENCY * SIM_DDA_MAX_LAG_MS / 1000) {
+				ticks_done = ticks_due - (SIM_DDA_FREQUENCY * SIM_DDA_BATCH_MS / 1000);
+				clock_gettime(CLOCK_MONOTONIC, &deadline);
+			}
+			while ((ticks_done < ticks_due) && (dda_timer.irqEn != 0)) {
+				dda_timer.elapsed_ticks = 1;
+				dda_timer.interrupt();
+				ticks_done += dda_timer.elapsed_ticks;
+			}
+		}
+	}
+	return (NULL);
+}
+
+/*
+ * ServiceCall_Thread() - software interrupts, one thread per service call level (see win/th.cpp)
+ */
+static void *ServiceCall_Thread(void *arg)
+{
+	const uint8_t level = (uint8_t)(uintptr_t)arg;
+	SimTimerEvent &run_event = _service_call_event(level);
+
+	for (;;)
+	{
+		run_event.wait();
+		ServiceCallEvent::_runLevel(level);
+	}
+	return (NULL);
+}
+
+static void *SysTick_Thread(void *arg)
+{
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for (;;)
+	{
+		if (!sim_virtual_time) {
+			SysTick_Handler();
+		} else if (dda_timer.irqEn == 0) {	// the DDA thread advances SysTick while moving
+			_sim_skip_to_deadline();
+			SysTick_Handler();
+			_sim_report_motion();
+		}
+		_sleep_until(deadline, 1000000);
+	}
+	return (NULL);
+}
+
+static void _start_thread(void *(*fn)(void *), void *arg = NULL)
+{
+	pthread_t thread;
+
+	if (pthread_create(&thread, NULL, fn, arg) == 0) {
+		pthread_detach(thread);
+	}
+}
+
+void xio_tim_Init(void)
+{
+	if (sim_interrupts) {
+		_start_thread(sim_virtual_time ? DDA_Thread_virtual : DDA_Thread);
+		for (uint8_t level = 0; level < Motate::kServiceCallLevels; level++) {
+			_start_thread(ServiceCall_Thread, (void *)(uintptr_t)level);
+		}
+	}
+	_start_thread(SysTick_Thread);
+}
@@ -0,0 +1,562 @@
+/*
+ * xio_usart.cpp - POSIX simulator serial port
+ *
+ *  The same serial shim as win/xio_usart.cpp. The port is a pseudo-terminal: its name is
+ *  printed at startup, and a host program connects to it as it would to a USB serial port.
+ *  If no pty can be opened, input comes from stdin and output goes to stdout. Jobs, captures
+ *  and replay work as on Windows, and the capture format is the same.
+ */
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+enum xioCodes {				// the codes xio_usart_gets() returns (see win/xio_usart.cpp)
+	XIO_OK = 0,
+	XIO_ERR,
+	XIO_EAGAIN
+};
+
+#define LF	0x0A		// ^j - line feed
+#define CR	0x0D		// ^m - carriage return
+#define EOT	0x04		// ^d - end of transmission (job kill)
+#define ENQ	0x05		// ^e - enquiry
+#define CAN	0x18		// ^x - cancel (reset)
+
+/*
+ * Serial rings - see win/xio_usart.cpp
+ */
+#define SER_RING_SIZE	8192				// must be 2^N
+#define SER_RING_MASK	(SER_RING_SIZE-1)
+#define SER_RX_BLOCK	1024				// largest single read
+#define SER_LINE_SIZE	1024				// longest line assembled for the parser
+#define SER_TX_LANES	3					// ack, report, bulk - as xioLane in xio.h
+
+typedef struct serRing {
+	volatile uint32_t head;					// written only by the producer
+	volatile uint32_t tail;					// written only by the consumer
+	char data[SER_RING_SIZE];
+} serRing_t;
+
+static int fdSerial = -1;					// pty master, or -1 for stdin/stdout
+
+static serRing_t rx;
+static serRing_t tx[SER_TX_LANES];
+
+static struct serEvent {					// auto-reset event - the send thread waits on it
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool set;
+} txEvent = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false };
+
+static char rxLine[SER_LINE_SIZE];			// line being assembled by xio_usart_gets()
+static int rxLen = 0;
+
+/*
+ * Control lane - see win/xio_usart.cpp
+ */
+#define SER_CTL_LINES		8				// must be 2^N
+#define SER_CTL_MASK		(SER_CTL_LINES-1)
+#define SER_CTL_LINE_SIZE	256				// longest control line
+
+typedef struct serCtlLine {
+	uint32_t mark;							// rx.head when the line was taken out of the stream
+	char line[SER_CTL_LINE_SIZE];
+} serCtlLine_t;
+
+typedef struct serCtlRing {
+	volatile uint32_t head;					// written only by the producer
+	volatile uint32_t tail;					// written only by the consumer
+	serCtlLine_t slot[SER_CTL_LINES];
+} serCtlRing_t;
+
+static serCtlRing_t ctl;
+static bool rxAtStart = true;				// producer: the next byte starts a line
+static int ctlLen = -1;						// producer: length of the control line being assembled, or -1
+static uint32_t ctlMark = 0;				// consumer: mark of the last control line read
+static bool ctlReturned = false;			// consumer: the last line read was a control line
+static bool ctlPaced = false;				// producer: a job - control lines wait for the lines before them
+
+static int fdJob = -1;						// headless job input (file or pipe) instead of the port
+static bool txRunning = false;				// the send thread is up - not when headless
+static volatile bool jobEof = false;		// job input has been read to the end
+
+bool xio_binary_rx_at(const uint8_t c, const uint32_t mark);	// binary move frames are split off before line assembly
+bool cm_has_hold(void);					// % is a control only during a feedhold
+uint32_t SysTickTimer_getValue(void);
+
+static inline uint32_t _min(uint32_t a, uint32_t b) { return ((a < b) ? a : b); }
+
+static void _sleep_ms(const long ms)
+{
+	struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+	nanosleep(&ts, NULL);
+}
+
+static void _start_thread(void *(*fn)(void *))
+{
+	pthread_t thread;
+
+	if (pthread_create(&thread, NULL, fn, NULL) == 0) {
+		pthread_detach(thread);
+	}
+}
+
+static void _tx_signal()
+{
+	pthread_mutex_lock(&txEvent.lock);
+	txEvent.set = true;
+	pthread_cond_signal(&txEvent.cond);
+	pthread_mutex_unlock(&txEvent.lock);
+}
+
+static void _tx_wait()
+{
+	pthread_mutex_lock(&txEvent.lock);
+	while (!txEvent.set) {
+		pthread_cond_wait(&txEvent.cond, &txEvent.lock);
+	}
+	txEvent.set = false;
+	pthread_mutex_unlock(&txEvent.lock);
+}
+
+/*
+ * Session capture - see win/xio_usart.cpp
+ */
+#define SER_CAPTURE_MAGIC	0x58523247		// "G2RX"
+#define SER_CAPTURE_VERSION	1
+
+typedef struct serCaptureHeader {
+	uint32_t magic;
+	uint32_t version;
+} serCaptureHeader_t;
+
+typedef struct serCaptureRecord {
+	uint32_t ms;							// SysTick at arrival
+	uint32_t len;							// raw bytes that follow
+} serCaptureRecord_t;
+
+static int fdRecord = -1;
+
+static bool _read_all(const int fd, void *buf, const size_t len)
+{
+	size_t done = 0;
+	while (done < len) {
+		ssize_t n = read(fd, (uint8_t *)buf + done, len - done);
+		if (n <= 0) {
+			return false;
+		}
+		done += n;
+	}
+	return true;
+}
+
+static void _write_all(const int fd, const void *buf, const size_t len)
+{
+	size_t done = 0;
+	while (done < len) {
+		ssize_t n = write(fd, (const uint8_t *)buf + done, len - done);
+		if (n <= 0) {
+			return;								// port or file error - drop the rest
+		}
+		done += n;
+	}
+}
+
+static void _rx_record(const uint8_t *block, const uint32_t len)
+{
+	serCaptureRecord_t rec = { SysTickTimer_getValue(), len };
+
+	_write_all(fdRecord, &rec, sizeof(rec));
+	_write_all(fdRecord, block, len);
+}
+
+/*
+ * _rx_put()       - put one byte in the receive ring, waiting if the parser is behind
+ * _ctl_single()   - true if c is a single character control
+ * _ctl_is_gcode() - true if a JSON line carries Gcode ({"gc":...})
+ * _ctl_take()     - pass the control line in the head slot to the consumer
+ * _rx_push()      - move a block into the receive ring, taking out control lines
+ *
+ *  Binary move frames are split off as the bytes go by. Each is marked with the rx position
+ *  it came in at, so it runs after the lines in front of it (see xio.cpp). rx.head is
+ *  published once for the block (or when the parser is behind and we have to wait), so the
+ *  main loop takes a whole burst at once rather than seeing it arrive a byte at a time. It
+ *  is also published before a control line is passed on, so the line's mark is never ahead
+ *  of what rx holds.
+ */
+static void _rx_put(uint32_t &head, const char c)
+{
+	while ((head - rx.tail) == SER_RING_SIZE) {	// parser is behind - publish what we have and wait
+		rx.head = head;
+		_sleep_ms(1);
+	}
+	rx.data[head & SER_RING_MASK] = c;
+	head++;
+}
+
+static bool _ctl_single(const char c)
+{
+	return ((c == '!') || (c == '~') || (c == ENQ) || (c == CAN) || (c == EOT) || ((c == '%') && cm_has_hold()));
+}
+
+static bool _ctl_is_gcode(const char *line)
+{
+	const char *p = line + 1;
+	while (*p == ' ') {
+		p++;
+	}
+	if (*p == '"') {
+		p++;
+	}
+	return (((p[0] | 0x20) == 'g') && ((p[1] | 0x20) == 'c') && ((p[2] == '"') || (p[2] == ':') || (p[2] == ' ')));
+}
+
+static void _ctl_take(const uint32_t head)
+{
+	rx.head = head;
+	while (ctlPaced && ((rx.tail != head) || (rxLen != 0)) && !cm_has_hold()) {
+		_sleep_ms(1);							// a job's line waits until the parser reaches it or holds
+	}
+	ctl.slot[ctl.head & SER_CTL_MASK].mark = head;
+	ctl.head = ctl.head + 1;
+}
+
+static void _rx_push(const uint8_t *block, const ssize_t len)
+{
+	uint32_t head = rx.head;
+
+	for (ssize_t i = 0; i < len; i++) {
+		if (xio_binary_rx_at(block[i], head))
+			continue;
+		char c = block[i];
+		char *line = ctl.slot[ctl.head & SER_CTL_MASK].line;
+		if (ctlLen >= 0) {						// in a control line
+			if ((c != CR) && (c != LF) && (ctlLen < SER_CTL_LINE_SIZE - 1)) {
+				line[ctlLen++] = c;
+				continue;
+			}
+			line[ctlLen] = 0;
+			if ((c == CR) || (c == LF)) {
+				if (!_ctl_is_gcode(line)) {
+					_ctl_take(head);
+					ctlLen = -1;
+					rxAtStart = true;
+					continue;
+				}
+			}
+			for (int j = 0; j < ctlLen; j++) {	// Gcode, or too long - it goes on as data
+				_rx_put(head, line[j]);
+			}
+			ctlLen = -1;
+		} else if (rxAtStart && ((c == '{') || _ctl_single(c))) {
+			while ((ctl.head - ctl.tail) == SER_CTL_LINES) {	// control dispatch is behind - wait
+				rx.head = head;
+				_sleep_ms(1);
+			}
+			line = ctl.slot[ctl.head & SER_CTL_MASK].line;
+			line[0] = c;
+			if (c == '{') {
+				ctlLen = 1;
+			} else {
+				line[1] = 0;
+				_ctl_take(head);				// still at the start of a line
+			}
+			continue;
+		}
+		rxAtStart = (c == CR) || (c == LF);
+		_rx_put(head, c);
+	}
+	rx.head = head;
+}
+
+static void *RecvthreadFunction(void *arg)
+{
+	uint8_t block[SER_RX_BLOCK];
+	int fd = (fdSerial >= 0) ? fdSerial : STDIN_FILENO;
+
+	for (;;)
+	{
+		ssize_t n = read(fd, block, sizeof(block));
+		if (n <= 0) {
+			_sleep_ms(1);							// pty not connected yet, or stdin closed
+			continue;
+		}
+		if (fdRecord >= 0) {
+			_rx_record(block, n);
+		}
+		_rx_push(block, n);
+	}
+	return (NULL);
+}
+
+/*
+ * JobthreadFunction() - feed a headless job (file or pipe) into the receive ring
+ */
+static void *JobthreadFunction(void *arg)
+{
+	uint8_t block[SER_RX_BLOCK];
+	ssize_t n;
+
+	while ((n = read(fdJob, block, sizeof(block))) > 0) {
+		_rx_push(block, n);
+	}
+	const uint8_t lf = LF;
+	_rx_push(&lf, 1);
+	jobEof = true;
+	return (NULL);
+}
+
+/*
+ * ReplaythreadFunction() - feed a capture into the receive ring at its recorded pacing
+ */
+static void *ReplaythreadFunction(void *arg)
+{
+	uint8_t block[SER_RX_BLOCK];
+	serCaptureRecord_t rec;
+	uint32_t first_ms = 0;
+	uint32_t start_ms = SysTickTimer_getValue();
+	bool first = true;
+
+	while (_read_all(fdJob, &rec, sizeof(rec))) {
+		if (first) {
+			first_ms = rec.ms;
+			first = false;
+		}
+		while ((SysTickTimer_getValue() - start_ms) < (rec.ms - first_ms)) {
+			_sleep_ms(1);
+		}
+		while (rec.len != 0) {
+			ssize_t n = read(fdJob, block, _min(rec.len, sizeof(block)));
+			if (n <= 0) {
+				rec.len = 0;						// truncated capture - replay what there is
+				break;
+			}
+			_rx_push(block, n);
+			rec.len -= n;
+		}
+	}
+	jobEof = true;
+	return (NULL);
+}
+
+static void *SendthreadFunction(void *arg)
+{
+	int fd = (fdSerial >= 0) ? fdSerial : STDOUT_FILENO;
+
+	int lane = 0;
+	bool midLine = false;							// lane has sent part of a line - finish it first
+
+	for (;;)
+	{
+		if (!midLine) {
+			for (lane = 0; (lane < SER_TX_LANES - 1) && (tx[lane].head == tx[lane].tail); lane++);
+		}
+		serRing_t *ring = &tx[lane];
+		uint32_t used = ring->head - ring->tail;
+		if (used == 0) {
+			_tx_wait();
+			continue;
+		}
+		uint32_t start = ring->tail & SER_RING_MASK;
+		uint32_t span = _min(used, SER_RING_SIZE - start);	// contiguous part up to the wrap
+		char *eol = (char *)memchr(&ring->data[start], LF, span);
+		if (eol != NULL) {
+			span = (uint32_t)(eol - &ring->data[start]) + 1;
+		}
+
+		ssize_t n = write(fd, &ring->data[start], span);
+		uint32_t sent = (n > 0) ? (uint32_t)n : span;		// port error - drop the span rather than spin on it
+		ring->tail = ring->tail + sent;
+		midLine = (eol == NULL) || (sent < span);
+	}
+	return (NULL);
+}
+
+/*
+ * posixserial_init() - open a pseudo-terminal for the host to connect to
+ */
+static void posixserial_init()
+{
+	struct termios tio;
+
+	fdSerial = posix_openpt(O_RDWR | O_NOCTTY);
+	if ((fdSerial < 0) || (grantpt(fdSerial) != 0) || (unlockpt(fdSerial) != 0)) {
+		if (fdSerial >= 0) {
+			close(fdSerial);
+			fdSerial = -1;
+		}
+		printf("[sim] no pty - using stdin/stdout\n");
+	} else {
+		if (tcgetattr(fdSerial, &tio) == 0) {		// raw bytes, no echo or line editing
+			cfmakeraw(&tio);
+			tcsetattr(fdSerial, TCSANOW, &tio);
+		}
+		printf("[sim] serial port is %s\n", ptsname(fdSerial));
+	}
+	_start_thread(RecvthreadFunction);
+	_start_thread(SendthreadFunction);
+	txRunning = true;
+}
+
+/*
+ * xio_usart_gets() - copy the next complete line into buf (NUL terminated)
+ *
+ *  Returns XIO_EAGAIN if no complete line has arrived yet. Blank lines and NULs are dropped.
+ */
+int xio_usart_gets(char *buf, const int size)
+{
+	while (rx.tail != rx.head) {
+		char c = rx.data[rx.tail & SER_RING_MASK];
+		rx.tail = rx.tail + 1;
+
+		if (c == 0)
+			continue;
+		if (c == CR || c == LF) {
+			if (rxLen) {
+				int len = (int)_min(rxLen, size - 1);
+				memcpy(buf, rxLine, len);
+				buf[len] = 0;
+				rxLen = 0;
+				ctlReturned = false;
+				return (XIO_OK);
+			}
+			continue;
+		}
+		rxLine[rxLen] = c;
+		if (++rxLen >= (int)sizeof(rxLine))
+			rxLen = 0;
+	}
+	return (XIO_EAGAIN);
+}
+
+/*
+ * xio_usart_gets_control()     - copy the next control line into buf (NUL terminated)
+ * xio_usart_flush_to_command() - drop the data received before the control line just read
+ * xio_usart_rx_reached()       - true once the parser has read the data received before mark
+ */
+int xio_usart_gets_control(char *buf, const int size)
+{
+	if (ctl.tail == ctl.head)
+		return (XIO_EAGAIN);
+
+	serCtlLine_t *s = &ctl.slot[ctl.tail & SER_CTL_MASK];
+	int len = (int)_min(strlen(s->line), size - 1);
+	memcpy(buf, s->line, len);
+	buf[len] = 0;
+	ctlMark = s->mark;
+	ctlReturned = true;
+	ctl.tail = ctl.tail + 1;
+	return (XIO_OK);
+}
+
+void xio_usart_flush_to_command(void)
+{
+	if (!ctlReturned)
+		return;
+	if ((int32_t)(ctlMark - rx.tail) > 0) {
+		rx.tail = ctlMark;
+		rxLen = 0;
+	}
+	ctlReturned = false;
+}
+
+bool xio_usart_rx_reached(const uint32_t mark)
+{
+	return ((int32_t)(mark - rx.tail) <= 0);
+}
+
+/*
+ * xiom_write()     - queue len bytes for the send thread; waits only if the ring is full
+ * xiom_writeline() - queue a NUL terminated string
+ */
+int xiom_write(const char *buffer, int len, int lane)
+{
+	if (!txRunning)									// responses are discarded when headless
+		return len;
+
+	serRing_t *ring = &tx[((lane < 0) || (lane >= SER_TX_LANES)) ? SER_TX_LANES - 1 : lane];
+	uint32_t head = ring->head;
+	for (int i = 0; i < len; i++) {
+		while ((head - ring->tail) == SER_RING_SIZE) {	// send thread is behind - publish what we have and wait
+			ring->head = head;
+			_tx_signal();
+			sched_yield();
+		}
+		ring->data[head & SER_RING_MASK] = buffer[i];
+		head++;
+	}
+	ring->head = head;
+	_tx_signal();
+	return len;
+}
+
+int xiom_writeline(const char *buffer, int lane)
+{
+	return xiom_write(buffer, strlen(buffer), lane);
+}
+
+void xio_usart_Init(void)
+{
+	posixserial_init();
+}
+
+/*
+ * xio_usart_init_job() - take input from a job file ("-" for stdin) instead of the port
+ * xio_usart_job_read() - true once the whole job has been read and handed to the parser
+ */
+bool xio_usart_init_job(const char *path)
+{
+	fdJob = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+	if (fdJob < 0) {
+		return false;
+	}
+	ctlPaced = true;
+	_start_thread(JobthreadFunction);
+	return true;
+}
+
+bool xio_usart_job_read(void)
+{
+	return (jobEof && (rx.tail == rx.head) && (rxLen == 0) && (ctl.tail == ctl.head));
+}
+
+/*
+ * xio_usart_init_record() - capture the port input to path (call before xio_usart_Init())
+ * xio_usart_init_replay() - take input from a capture instead of the port; ends like a job
+ */
+bool xio_usart_init_record(const char *path)
+{
+	serCaptureHeader_t hdr = { SER_CAPTURE_MAGIC, SER_CAPTURE_VERSION };
+
+	fdRecord = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fdRecord < 0) {
+		return false;
+	}
+	_write_all(fdRecord, &hdr, sizeof(hdr));
+	return true;
+}
+
+bool xio_usart_init_replay(const char *path)
+{
+	serCaptureHeader_t hdr;
+
+	fdJob = open(path, O_RDONLY);
+	if (fdJob < 0) {
+		return false;
+	}
+	if (!_read_all(fdJob, &hdr, sizeof(hdr)) ||
+		(hdr.magic != SER_CAPTURE_MAGIC) || (hdr.version != SER_CAPTURE_VERSION)) {
+		close(fdJob);
+		fdJob = -1;
+		return false;
+	}
+	_start_thread(ReplaythreadFunction);
+	return true;
+}
@@ -9,68 +9,302 @@
 #include <time.h>
 
 #include "MotateTimers.h" 
+#include "MotateServiceCall.h"
 
 using Motate::TimerChannel;
+using Motate::ServiceCallEvent;
 
 typedef TimerChannel<3, 0> dda_timer_type;	// stepper pulse generation in stepper.cpp
-typedef TimerChannel<4, 0> exec_timer_type;	// request exec timer in stepper.cpp
-typedef TimerChannel<5, 0> fwd_plan_timer_type;	// request exec timer in stepper.cpp
 extern   dda_timer_type dda_timer;
-extern   exec_timer_type exec_timer;         // һ+ 1εļ
-extern   fwd_plan_timer_type fwd_plan_timer; // һļƻ
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+#define SIM_DDA_FREQUENCY       200000      // simulated DDA interrupt rate (Hz)
+#define SIM_DDA_BATCH_MS        1           // DDA thread wakes this often and runs the ticks that came due
+#define SIM_DDA_MAX_LAG_MS      100         // resync rather than burst if the host stalls longer than this
+#define SIM_TIMER_EVENTS        8           // one auto-reset event per timer number (masked)
+
+/*
+ * SIM_VIRTUAL_TIME - run motion faster than real time
+ *
+ *  SIM_VIRTUAL_TIME sets the default; xio_tim_virtual_time() can change it before
+ *  xio_tim_Init() (the headless job runner always uses virtual time).
+ *  When true the DDA thread runs back-to-back instead of against the performance counter, and
+ *  SysTick is advanced by the DDA (one tick per SIM_DDA_FREQUENCY/1000 DDA interrupts) while
+ *  anything is moving. Exec and forward planning are waited for after every DDA interrupt, so
+ *  they behave as the higher priority interrupts they are on hardware. While the DDA is idle
+ *  SysTick free-runs in real time so timeouts and reports still happen.
+ *  Each burst of motion is reported on the console with its simulated duration.
+ */
+#ifndef SIM_VIRTUAL_TIME
+#define SIM_VIRTUAL_TIME        false
+#endif
+#define SIM_REPORT_IDLE_MS      1000        // report a motion burst after this much idle time
 
 double QuadPart;
 
-void DDA_Thread(void *pVoid)
+void SysTick_Handler(void);
+
+static bool sim_virtual_time = SIM_VIRTUAL_TIME;
+static bool sim_report_bursts = true;
+static bool sim_interrupts = true;
+static volatile bool sim_skip_idle = false;
+
+static struct simVirtualClock {
+	volatile uint64_t burst_ticks;		// DDA ticks in the current motion burst
+	volatile uint64_t total_ticks;		// DDA ticks in all reported bursts
+	volatile uint32_t idle_ms;			// real ms the DDA has been idle since the last burst
+	volatile uint64_t motion_ticks;		// DDA ticks since startup
+} sim;
+
+static void _sim_wait_for_software_interrupts()
+{
+	while (!ServiceCallEvent::_isIdle()) {
+		SwitchToThread();
+	}
+}
+
+static void _sim_report_motion()
+{
+	if ((sim.burst_ticks != 0) && (++sim.idle_ms >= SIM_REPORT_IDLE_MS)) {
+		sim.total_ticks += sim.burst_ticks;
+		if (sim_report_bursts) {
+			printf("[sim] motion %.3f s, total %.3f s simulated\n",
+				(double)sim.burst_ticks / SIM_DDA_FREQUENCY, (double)sim.total_ticks / SIM_DDA_FREQUENCY);
+		}
+		sim.burst_ticks = 0;
+	}
+}
+
+/*
+ * xio_tim_virtual_time() - select virtual or real time (call before xio_tim_Init())
+ * xio_tim_motion_seconds() - simulated time spent moving so far (virtual time only)
+ */
+void xio_tim_virtual_time(const bool virtual_time, const bool report_bursts)
 {
-	LARGE_INTEGER StartingTime, EndingTime, ElapsedMicroseconds;
-	uint32_t DDA_PER;
-	DDA_PER = QuadPart*(1000000/200000);//us
+	sim_virtual_time = virtual_time;
+	sim_report_bursts = report_bursts;
+}
+
+double xio_tim_motion_seconds(void)
+{
+	return ((double)sim.motion_ticks / SIM_DDA_FREQUENCY);
+}
+
+/*
+ * xio_tim_interrupts() - start the stepper interrupt threads in xio_tim_Init() (default true)
+ *
+ *  With interrupts off only SysTick runs, so the planner can be driven synchronously
+ *  from the main thread, as the benchmarks do.
+ */
+void xio_tim_interrupts(const bool enable)
+{
+	sim_interrupts = enable;
+}
+
+/*
+ * xio_tim_skip_idle() - jump idle virtual time to the next Timeout deadline (default false)
+ *
+ *  Only takes effect in virtual time while the DDA and the software interrupts are idle.
+ *  SysTick is then run back-to-back up to the next armed Timeout (see TimeoutWheel) rather
+ *  than once per real ms. The job runner turns it on once all job input has been read.
+ */
+void xio_tim_skip_idle(const bool skip)
+{
+	sim_skip_idle = skip;
+}
+
+static void _sim_skip_to_deadline()
+{
+	if (!sim_skip_idle || !ServiceCallEvent::_isIdle()) {
+		return;
+	}
+	for (uint32_t ticks = Motate::SysTickTimer.ticksToNextDeadline(); ticks > 1; ticks--) {
+		SysTick_Handler();
+	}
+}
+
+/*
+ * Simulated interrupt signalling
+ *
+ *  Timer::start() and Timer::setInterruptPending() raise irqEn and then call SimTimerSignal(),
+ *  which sets the timer's auto-reset event. The interrupt threads block on those events
+ *  instead of polling irqEn, so an idle simulator uses no host CPU.
+ */
+
+struct SimTimerEvents {
+	HANDLE event[SIM_TIMER_EVENTS];
+	SimTimerEvents() {
+		for (int i = 0; i < SIM_TIMER_EVENTS; i++) {
+			event[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		}
+	}
+};
+
+static HANDLE _timer_event(const uint8_t timerNum)
+{
+	static SimTimerEvents events;		// constructed on first use - timers may start before xio_tim_Init()
+	return events.event[timerNum & (SIM_TIMER_EVENTS-1)];
+}
+
+void Motate::SimTimerSignal(const uint8_t timerNum)
+{
+	SetEvent(_timer_event(timerNum));
+}
+
+static HANDLE _service_call_event(const uint8_t level)
+{
+	static SimTimerEvents events;		// one per level (the spare ones are unused)
+	return events.event[level];
+}
+
+void Motate::SimServiceCallSignal(const uint8_t level)
+{
+	SetEvent(_service_call_event(level));
+}
+
+/*
+ * DDA_Thread_virtual() - run the DDA interrupt as fast as the host allows, advancing virtual time
+ */
+void DDA_Thread_virtual(void *pVoid)
+{
+	HANDLE run_event = _timer_event(3);
+	uint32_t ticks_in_ms = 0;
+
 	for (;;)
 	{
-		while (dda_timer.irqEn == 0)
-			Sleep(0);
-		QueryPerformanceCounter(&StartingTime);
-		do
-		{
-			QueryPerformanceCounter(&EndingTime);
-			ElapsedMicroseconds.QuadPart = EndingTime.QuadPart - StartingTime.QuadPart;
-		} while (ElapsedMicroseconds.QuadPart < DDA_PER);
-		dda_timer.interrupt();
+		if (dda_timer.irqEn == 0) {
+			WaitForSingleObject(run_event, INFINITE);
+			continue;
+		}
+		sim.idle_ms = 0;
+		while (dda_timer.irqEn != 0) {
+			dda_timer.elapsed_ticks = 1;
+			dda_timer.interrupt();
+			sim.burst_ticks += dda_timer.elapsed_ticks;
+			sim.motion_ticks += dda_timer.elapsed_ticks;
+			ticks_in_ms += dda_timer.elapsed_ticks;
+			while (ticks_in_ms >= SIM_DDA_FREQUENCY/1000) {
+				ticks_in_ms -= SIM_DDA_FREQUENCY/1000;
+				SysTick_Handler();
+			}
+			_sim_wait_for_software_interrupts();
+		}
 	}
 }
 
-void EXEC_Thread(void *pVoid)
+/*
+ * _sim_periodic_timer() - a waitable timer that fires every period_ms, as finely as the host allows
+ */
+static HANDLE _sim_periodic_timer(const LONG period_ms)
 {
+	LARGE_INTEGER due_time;
+	HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	if (timer == NULL) {				// high resolution timers need Windows 10 1803 or later
+		timer = CreateWaitableTimer(NULL, FALSE, NULL);
+	}
+	due_time.QuadPart = -(LONGLONG)period_ms * 10000;	// relative, 100 ns units
+	SetWaitableTimer(timer, &due_time, period_ms, NULL, NULL, FALSE);
+	return (timer);
+}
+
+/*
+ * DDA_Thread() - run the DDA interrupt at SIM_DDA_FREQUENCY on average
+ *
+ *  Windows cannot wake a thread every 5 us, so the thread sleeps on a periodic waitable timer
+ *  and on each wakeup runs however many ticks have come due by the performance counter.
+ *  Pulse timing within a batch is not preserved; step counts and segment timing are.
+ */
+void DDA_Thread(void *pVoid)
+{
+	LARGE_INTEGER frequency, start_time, now;
+	uint64_t ticks_done, ticks_due;
+	HANDLE run_event = _timer_event(3);
+	HANDLE batch_timer = _sim_periodic_timer(SIM_DDA_BATCH_MS);
+
+	QueryPerformanceFrequency(&frequency);
 
 	for (;;)
 	{
-		while (exec_timer.irqEn == 0)
-			Sleep(0);
-		exec_timer.irqEn = 0;
-		exec_timer.interrupt();
+		if (dda_timer.irqEn == 0) {
+			WaitForSingleObject(run_event, INFINITE);
+			continue;
+		}
+		QueryPerformanceCounter(&start_time);
+		ticks_done = 0;
+		while (dda_timer.irqEn != 0) {
+			WaitForSingleObject(batch_timer, INFINITE);
+			QueryPerformanceCounter(&now);
+			ticks_due = (uint64_t)(now.QuadPart - start_time.QuadPart) * SIM_DDA_FREQUENCY / frequency.QuadPart;
+			if ((ticks_due - ticks_done) > (uint64_t)SIM_DDA_FREQUENCY * SIM_DDA_MAX_LAG_MS / 1000) {
+				ticks_done = ticks_due - (SIM_DDA_FREQUENCY * SIM_DDA_BATCH_MS / 1000);
+			}
+			while ((ticks_done < ticks_due) && (dda_timer.irqEn != 0)) {
+				dda_timer.elapsed_ticks = 1;
+				dda_timer.interrupt();
+				ticks_done += dda_timer.elapsed_ticks;
+			}
+		}
 	}
 }
 
-void fwd_plan_Thread(void *pVoid)
+/*
+ * ServiceCall_Thread() - software interrupts (exec, forward planning, ...)
+ *
+ *  One thread per service call priority level. Each wakes when a service call at its level
+ *  is queued and runs the level until nothing is queued (see SamServiceCall.h).
+ */
+void ServiceCall_Thread(void *pLevel)
 {
+	const uint8_t level = (uint8_t)(uintptr_t)pLevel;
+	HANDLE run_event = _service_call_event(level);
 
 	for (;;)
 	{
-		while (fwd_plan_timer.irqEn == 0)
-			Sleep(0);
-		fwd_plan_timer.irqEn = 0;
-		fwd_plan_timer.interrupt();
+		WaitForSingleObject(run_event, INFINITE);
+		ServiceCallEvent::_runLevel(level);
 	}
 }
 
-void SysTick_Handler(void);
+/*
+ * SysTick_Thread() - run SysTick once per ms of performance counter time
+ *
+ *  Sleep(1) wakes anywhere from 1 to 15.6 ms later, so the thread instead wakes on a
+ *  periodic timer and runs one SysTick for each ms the performance counter (the DDA's
+ *  clock) says has passed. SysTick then keeps real time even when wakeups are late, so
+ *  Timeouts, block_timeout and report intervals behave as on the board.
+ *  In virtual time the DDA thread runs SysTick while moving; the ms that pass meanwhile are
+ *  skipped here, not run in a burst afterwards.
+ */
 void SysTick_Thread(void *pVoid)
 {
+	LARGE_INTEGER frequency, start_time, now;
+	uint64_t ms_done = 0, ms_due;
+	HANDLE tick_timer = _sim_periodic_timer(1);
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start_time);
 	for (;;)
 	{
-		SysTick_Handler();
-		Sleep(1);
+		WaitForSingleObject(tick_timer, INFINITE);
+		QueryPerformanceCounter(&now);
+		ms_due = (uint64_t)(now.QuadPart - start_time.QuadPart) * 1000 / frequency.QuadPart;
+		if ((ms_due - ms_done) > SIM_DDA_MAX_LAG_MS) {	// host was suspended - resync rather than burst
+			ms_done = ms_due - 1;
+		}
+		while (ms_done < ms_due) {
+			ms_done++;
+			if (!sim_virtual_time) {
+				SysTick_Handler();
+			} else if (dda_timer.irqEn == 0) {	// the DDA thread advances SysTick while moving
+				_sim_skip_to_deadline();
+				SysTick_Handler();
+				_sim_report_motion();
+			}
+		}
 	}
 }
 
@@ -83,8 +317,11 @@ void xio_tim_Init(void)
 	}
 	QuadPart = Win32Frequency.QuadPart/1000000;
 
-	_beginthread(DDA_Thread, 0, NULL);
-	_beginthread(EXEC_Thread, 0, NULL);
-	_beginthread(fwd_plan_Thread, 0, NULL);
+	if (sim_interrupts) {
+		_beginthread(sim_virtual_time ? DDA_Thread_virtual : DDA_Thread, 0, NULL);
+		for (uint8_t level = 0; level < Motate::kServiceCallLevels; level++) {
+			_beginthread(ServiceCall_Thread, 0, (void *)(uintptr_t)level);
+		}
+	}
 	_beginthread(SysTick_Thread, 0, NULL);
 }
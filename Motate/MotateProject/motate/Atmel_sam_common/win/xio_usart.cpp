@@ -34,62 +34,344 @@ enum xioCodes {
 
 #define LF	0x0A		// ^j - line feed
 #define CR	0x0D		// ^m - carriage return
+#define EOT	0x04		// ^d - end of transmission (job kill)
+#define ENQ	0x05		// ^e - enquiry
+#define CAN	0x18		// ^x - cancel (reset)
 
-CRITICAL_SECTION CriticalSection;
 //#define LOCAL_ECHO
 
+/*
+ * Serial rings
+ *
+ *  The receive thread reads the port in blocks with overlapped I/O and pushes the bytes into
+ *  rx; the main loop pulls complete lines out of rx in xio_usart_gets(). xiom_write() pushes
+ *  into one of the tx lanes and the send thread drains them in contiguous spans, highest
+ *  lane first. It changes lanes only after a LF, so lines from different lanes are never
+ *  interleaved; a lane left mid-line is finished before any other. Each ring has exactly one
+ *  producer and one consumer, and each index is written by only one of them, so no lock is
+ *  needed (MSVC volatile accesses are ordered on x86/x64). Indexes run freely and are masked
+ *  on access.
+ */
+#define SER_RING_SIZE	8192				// must be 2^N
+#define SER_RING_MASK	(SER_RING_SIZE-1)
+#define SER_RX_BLOCK	1024				// largest single ReadFile
+#define SER_LINE_SIZE	1024				// longest line assembled for the parser
+#define SER_TX_LANES	3					// ack, report, bulk - as xioLane in xio.h
+
+typedef struct serRing {
+	volatile uint32_t head;					// written only by the producer
+	volatile uint32_t tail;					// written only by the consumer
+	char data[SER_RING_SIZE];
+} serRing_t;
+
 HANDLE hSerial = INVALID_HANDLE_VALUE;
-char xio_usart_bufTmp[1024];
 
+static serRing_t rx;
+static serRing_t tx[SER_TX_LANES];
+static HANDLE txEvent = NULL;				// set when the send thread has data to drain
+
+static char rxLine[SER_LINE_SIZE];			// line being assembled by xio_usart_gets()
 static int rxLen = 0;
-static int rxFo = 0;
 
-char rxBuf[1024];
+/*
+ * Control lane
+ *
+ *  Host lines that must not wait behind queued Gcode are taken out of the stream as they
+ *  are received, and the control dispatch reads them ahead of everything in rx - so an
+ *  override like {"mfo":1.2}, a status request or a feedhold acts at once however much
+ *  Gcode is buffered. Lines are classified by how they start, as LineRXBuffer does: the
+ *  single character controls ! ~ ENQ ^X ^D, % during a feedhold, and JSON other than
+ *  {"gc":...}, which carries Gcode and stays in order. A control line is assembled in its
+ *  own slot of the ctl ring; one too long for a slot goes on as data. Each slot records
+ *  how far rx had got when the line was taken, so a queue flush (% or ^D) can drop the
+ *  data received before it (xio_usart_flush_to_command()). Captures use the lane as they
+ *  stand in for the port. So do job files, but a job's control line is only passed on once
+ *  the parser has taken every line before it, or a feedhold has stopped it taking them -
+ *  where a host streaming the job would have sent it. A '~' behind Gcode held back by a
+ *  feedhold still gets through.
+ */
+#define SER_CTL_LINES		8				// must be 2^N
+#define SER_CTL_MASK		(SER_CTL_LINES-1)
+#define SER_CTL_LINE_SIZE	256				// longest control line
+
+typedef struct serCtlLine {
+	uint32_t mark;							// rx.head when the line was taken out of the stream
+	char line[SER_CTL_LINE_SIZE];
+} serCtlLine_t;
+
+typedef struct serCtlRing {
+	volatile uint32_t head;					// written only by the producer
+	volatile uint32_t tail;					// written only by the consumer
+	serCtlLine_t slot[SER_CTL_LINES];
+} serCtlRing_t;
+
+static serCtlRing_t ctl;
+static bool rxAtStart = true;				// producer: the next byte starts a line
+static int ctlLen = -1;						// producer: length of the control line being assembled, or -1
+static uint32_t ctlMark = 0;				// consumer: mark of the last control line read
+static bool ctlReturned = false;			// consumer: the last line read was a control line
+static bool ctlPaced = false;				// producer: a job - control lines wait for the lines before them
+
+static HANDLE hJob = INVALID_HANDLE_VALUE;	// headless job input (file or pipe) instead of the port
+static volatile bool jobEof = false;		// job input has been read to the end
+
+bool xio_binary_rx_at(const uint8_t c, const uint32_t mark);	// binary move frames are split off before line assembly
+bool cm_has_hold(void);					// % is a control only during a feedhold
+uint32_t SysTickTimer_getValue(void);
+
+/*
+ * Session capture
+ *
+ *  xio_usart_init_record() logs every block read from the port, before anything else sees
+ *  it, with the SysTick time it arrived. xio_usart_init_replay() feeds a capture back into
+ *  the receive ring at the same SysTick offsets from the start of replay; in virtual time
+ *  SysTick follows simulated motion, so a replay reproduces the stream and its pacing
+ *  against the planner. The file is a serCaptureHeader_t then serCaptureRecord_t each
+ *  followed by len raw bytes.
+ */
+#define SER_CAPTURE_MAGIC	0x58523247		// "G2RX"
+#define SER_CAPTURE_VERSION	1
+
+typedef struct serCaptureHeader {
+	uint32_t magic;
+	uint32_t version;
+} serCaptureHeader_t;
+
+typedef struct serCaptureRecord {
+	uint32_t ms;							// SysTick at arrival
+	uint32_t len;							// raw bytes that follow
+} serCaptureRecord_t;
+
+static HANDLE hRecord = INVALID_HANDLE_VALUE;
+
+static void _rx_record(const uint8_t *block, const DWORD len)
+{
+	serCaptureRecord_t rec = { SysTickTimer_getValue(), len };
+	DWORD written;
+
+	WriteFile(hRecord, &rec, sizeof(rec), &written, NULL);
+	WriteFile(hRecord, block, len, &written, NULL);
+}
+
+/*
+ * _rx_put()       - put one byte in the receive ring, waiting if the parser is behind
+ * _ctl_single()   - true if c is a single character control
+ * _ctl_is_gcode() - true if a JSON line carries Gcode ({"gc":...})
+ * _ctl_take()     - pass the control line in the head slot to the consumer
+ * _rx_push()      - move a block into the receive ring, taking out control lines
+ *
+ *  Binary move frames are split off as the bytes go by. Each is marked with the rx position
+ *  it came in at, so it runs after the lines in front of it (see xio.cpp). rx.head is
+ *  published once for the block (or when the parser is behind and we have to wait), so the
+ *  main loop takes a whole burst at once rather than seeing it arrive a byte at a time. It
+ *  is also published before a control line is passed on, so the line's mark is never ahead
+ *  of what rx holds.
+ */
+static void _rx_put(uint32_t &head, const char c)
+{
+	while ((head - rx.tail) == SER_RING_SIZE) {	// parser is behind - publish what we have and wait
+		rx.head = head;
+		Sleep(1);
+	}
+	rx.data[head & SER_RING_MASK] = c;
+	head++;
+}
+
+static bool _ctl_single(const char c)
+{
+	return ((c == '!') || (c == '~') || (c == ENQ) || (c == CAN) || (c == EOT) || ((c == '%') && cm_has_hold()));
+}
+
+static bool _ctl_is_gcode(const char *line)
+{
+	const char *p = line + 1;
+	while (*p == ' ') {
+		p++;
+	}
+	if (*p == '"') {
+		p++;
+	}
+	return (((p[0] | 0x20) == 'g') && ((p[1] | 0x20) == 'c') && ((p[2] == '"') || (p[2] == ':') || (p[2] == ' ')));
+}
+
+static void _ctl_take(const uint32_t head)
+{
+	rx.head = head;
+	while (ctlPaced && ((rx.tail != head) || (rxLen != 0)) && !cm_has_hold()) {
+		Sleep(1);								// a job's line waits until the parser reaches it or holds
+	}
+	ctl.slot[ctl.head & SER_CTL_MASK].mark = head;
+	ctl.head = ctl.head + 1;
+}
+
+static void _rx_push(const uint8_t *block, const DWORD len)
+{
+	uint32_t head = rx.head;
+
+	for (DWORD i = 0; i < len; i++) {
+		if (xio_binary_rx_at(block[i], head))
+			continue;
+		char c = block[i];
+		char *line = ctl.slot[ctl.head & SER_CTL_MASK].line;
+		if (ctlLen >= 0) {						// in a control line
+			if ((c != CR) && (c != LF) && (ctlLen < SER_CTL_LINE_SIZE - 1)) {
+				line[ctlLen++] = c;
+				continue;
+			}
+			line[ctlLen] = 0;
+			if ((c == CR) || (c == LF)) {
+				if (!_ctl_is_gcode(line)) {
+					_ctl_take(head);
+					ctlLen = -1;
+					rxAtStart = true;
+					continue;
+				}
+			}
+			for (int j = 0; j < ctlLen; j++) {	// Gcode, or too long - it goes on as data
+				_rx_put(head, line[j]);
+			}
+			ctlLen = -1;
+		} else if (rxAtStart && ((c == '{') || _ctl_single(c))) {
+			while ((ctl.head - ctl.tail) == SER_CTL_LINES) {	// control dispatch is behind - wait
+				rx.head = head;
+				Sleep(1);
+			}
+			line = ctl.slot[ctl.head & SER_CTL_MASK].line;
+			line[0] = c;
+			if (c == '{') {
+				ctlLen = 1;
+			} else {
+				line[1] = 0;
+				_ctl_take(head);				// still at the start of a line
+			}
+			continue;
+		}
+		rxAtStart = (c == CR) || (c == LF);
+		_rx_put(head, c);
+	}
+	rx.head = head;
+}
 
 void RecvthreadFunction(void *pVoid)
 {
-	DWORD  dwBytesRead;
-	uint8_t data;
-	
+	OVERLAPPED ov = { 0 };
+	uint8_t block[SER_RX_BLOCK];
+	DWORD dwBytesRead;
 
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
 	for (;;)
 	{
 		if (hSerial != INVALID_HANDLE_VALUE)
 		{
-			if (ReadFile(hSerial, &data, 1, &dwBytesRead, NULL) && dwBytesRead == 1){
-
-			}else{
-				Sleep(1);
-				data = 0;
+			dwBytesRead = 0;
+			ResetEvent(ov.hEvent);
+			if (!ReadFile(hSerial, block, sizeof(block), &dwBytesRead, &ov)) {
+				if ((GetLastError() != ERROR_IO_PENDING) || !GetOverlappedResult(hSerial, &ov, &dwBytesRead, TRUE)) {
+					Sleep(1);
+					continue;
+				}
 			}
-
-
 		}else{
-			while (_kbhit() == 0);
-			data = _getch();
+			block[0] = _getch();
+			dwBytesRead = 1;
 		}
-		if (data == 0)
-			continue;
-		if (data == CR || data == LF) {
-			if (rxLen) {
-				rxBuf[rxLen] = 0;
-				rxFo = 1;
-				while (rxFo) {
-					Sleep(0);
-				}
-			}
-			rxLen = 0;
-			continue;
+		if (hRecord != INVALID_HANDLE_VALUE) {
+			_rx_record(block, dwBytesRead);
 		}
-		rxBuf[rxLen] = data;
-		if (++rxLen > sizeof(rxBuf))
-			rxLen = 0;
+		_rx_push(block, dwBytesRead);
+	}
+}
+
+/*
+ * JobthreadFunction() - feed a headless job (file or pipe) into the receive ring
+ *
+ *  Reads synchronously - pipes do not support overlapped I/O - and ends the last line
+ *  in case the file does not.
+ */
+void JobthreadFunction(void *pVoid)
+{
+	uint8_t block[SER_RX_BLOCK];
+	DWORD dwBytesRead;
 
+	while (ReadFile(hJob, block, sizeof(block), &dwBytesRead, NULL) && (dwBytesRead != 0)) {
+		_rx_push(block, dwBytesRead);
 	}
+	const uint8_t lf = LF;
+	_rx_push(&lf, 1);
+	jobEof = true;
+}
+
+/*
+ * ReplaythreadFunction() - feed a capture into the receive ring at its recorded pacing
+ */
+void ReplaythreadFunction(void *pVoid)
+{
+	uint8_t block[SER_RX_BLOCK];
+	serCaptureRecord_t rec;
+	DWORD dwBytesRead;
+	uint32_t first_ms = 0;
+	uint32_t start_ms = SysTickTimer_getValue();
+	bool first = true;
 
+	while (ReadFile(hJob, &rec, sizeof(rec), &dwBytesRead, NULL) && (dwBytesRead == sizeof(rec))) {
+		if (first) {
+			first_ms = rec.ms;
+			first = false;
+		}
+		while ((SysTickTimer_getValue() - start_ms) < (rec.ms - first_ms)) {
+			Sleep(1);
+		}
+		while (rec.len != 0) {
+			DWORD want = min(rec.len, (uint32_t)sizeof(block));
+			if (!ReadFile(hJob, block, want, &dwBytesRead, NULL) || (dwBytesRead == 0)) {
+				rec.len = 0;						// truncated capture - replay what there is
+				break;
+			}
+			_rx_push(block, dwBytesRead);
+			rec.len -= dwBytesRead;
+		}
+	}
+	jobEof = true;
 }
 
+void SendthreadFunction(void *pVoid)
+{
+	OVERLAPPED ov = { 0 };
+	DWORD dwBytesWritten;
 
+	int lane = 0;
+	bool midLine = false;							// lane has sent part of a line - finish it first
+
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	for (;;)
+	{
+		if (!midLine) {
+			for (lane = 0; (lane < SER_TX_LANES - 1) && (tx[lane].head == tx[lane].tail); lane++);
+		}
+		serRing_t *ring = &tx[lane];
+		uint32_t used = ring->head - ring->tail;
+		if (used == 0) {
+			WaitForSingleObject(txEvent, INFINITE);
+			continue;
+		}
+		uint32_t start = ring->tail & SER_RING_MASK;
+		uint32_t span = min(used, SER_RING_SIZE - start);	// contiguous part up to the wrap
+		char *eol = (char *)memchr(&ring->data[start], LF, span);
+		if (eol != NULL) {
+			span = (uint32_t)(eol - &ring->data[start]) + 1;
+		}
+
+		dwBytesWritten = 0;
+		ResetEvent(ov.hEvent);
+		if (!WriteFile(hSerial, &ring->data[start], span, &dwBytesWritten, &ov)) {
+			if ((GetLastError() != ERROR_IO_PENDING) || !GetOverlappedResult(hSerial, &ov, &dwBytesWritten, TRUE)) {
+				dwBytesWritten = span;						// port error - drop the span rather than spin on it
+			}
+		}
+		ring->tail = ring->tail + dwBytesWritten;
+		midLine = (eol == NULL) || (dwBytesWritten < span);
+	}
+}
 
 #define MAX_DEVPATH_LENGTH 1024
 void winserial_init(char *pPort)
@@ -103,7 +385,7 @@ void winserial_init(char *pPort)
 	{
 		mbstowcs_s(NULL, devicePath, MAX_DEVPATH_LENGTH, pPort, strlen(pPort));//ֽڱַתΪַַchar*תwchar_t*
 		hSerial = CreateFile(devicePath, GENERIC_READ | GENERIC_WRITE, 0, NULL,
-			OPEN_EXISTING, 0, NULL);
+			OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
 	}
 	if (hSerial != INVALID_HANDLE_VALUE)
 	{
@@ -134,43 +416,185 @@ void winserial_init(char *pPort)
 			return;
 		}
 
+		// reads return as soon as any bytes have arrived (or after 1 s with none); writes never time out
 		GetCommTimeouts(hSerial, &commTimeout);
-		commTimeout.ReadIntervalTimeout = 1;
-		commTimeout.ReadTotalTimeoutConstant = 1;
-		commTimeout.ReadTotalTimeoutMultiplier = 1;
-		commTimeout.WriteTotalTimeoutConstant = 1;
-		commTimeout.WriteTotalTimeoutMultiplier = 1;
+		commTimeout.ReadIntervalTimeout = MAXDWORD;
+		commTimeout.ReadTotalTimeoutConstant = 1000;
+		commTimeout.ReadTotalTimeoutMultiplier = MAXDWORD;
+		commTimeout.WriteTotalTimeoutConstant = 0;
+		commTimeout.WriteTotalTimeoutMultiplier = 0;
 		SetCommTimeouts(hSerial, &commTimeout);
+
+		txEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		_beginthread(SendthreadFunction, 0, NULL);
 	}
 	_beginthread(RecvthreadFunction, 0, NULL);
-	//_beginthread(SendthreadFunction, 0, NULL);
 }
 
+/*
+ * xio_usart_gets() - copy the next complete line into buf (NUL terminated)
+ *
+ *  Returns XIO_EAGAIN if no complete line has arrived yet. Blank lines and NULs are dropped;
+ *  a line longer than SER_LINE_SIZE is discarded from the start, as before.
+ */
 int xio_usart_gets(char *buf, const int size)
 {
-	if(rxFo==0)
+	while (rx.tail != rx.head) {
+		char c = rx.data[rx.tail & SER_RING_MASK];
+		rx.tail = rx.tail + 1;
+
+		if (c == 0)
+			continue;
+		if (c == CR || c == LF) {
+			if (rxLen) {
+				int len = min(rxLen, size - 1);
+				memcpy(buf, rxLine, len);
+				buf[len] = 0;
+				rxLen = 0;
+				ctlReturned = false;
+				return (XIO_OK);
+			}
+			continue;
+		}
+		rxLine[rxLen] = c;
+		if (++rxLen >= (int)sizeof(rxLine))
+			rxLen = 0;
+	}
+	return (XIO_EAGAIN);
+}
+
+/*
+ * xio_usart_gets_control()     - copy the next control line into buf (NUL terminated)
+ * xio_usart_flush_to_command() - drop the data received before the control line just read
+ * xio_usart_rx_reached()       - true once the parser has read the data received before mark
+ *
+ *  The flush only applies right after a control line, and never moves rx back over data
+ *  the parser has already read.
+ */
+int xio_usart_gets_control(char *buf, const int size)
+{
+	if (ctl.tail == ctl.head)
 		return (XIO_EAGAIN);
-	memcpy(buf, rxBuf, rxLen);
-	buf[rxLen] = 0;
-	rxFo = 0;
+
+	serCtlLine_t *s = &ctl.slot[ctl.tail & SER_CTL_MASK];
+	int len = (int)min(strlen(s->line), (size_t)(size - 1));
+	memcpy(buf, s->line, len);
+	buf[len] = 0;
+	ctlMark = s->mark;
+	ctlReturned = true;
+	ctl.tail = ctl.tail + 1;
 	return (XIO_OK);
 }
-int xiom_writeline(const char *buffer)
+
+void xio_usart_flush_to_command(void)
+{
+	if (!ctlReturned)
+		return;
+	if ((int32_t)(ctlMark - rx.tail) > 0) {
+		rx.tail = ctlMark;
+		rxLen = 0;
+	}
+	ctlReturned = false;
+}
+
+bool xio_usart_rx_reached(const uint32_t mark)
 {
-	DWORD dwBytesWritten;
-	int len = strlen(buffer);
-	WriteFile(hSerial, buffer, len, &dwBytesWritten, NULL);
-	return len;
+	return ((int32_t)(mark - rx.tail) <= 0);
 }
-int xiom_write(const char *buffer,int len)
+
+/*
+ * xiom_write()     - queue len bytes in lane for the send thread; waits only if the lane is full
+ * xiom_writeline() - queue a NUL terminated string
+ */
+int xiom_write(const char *buffer, int len, int lane)
 {
-	DWORD dwBytesWritten;
-	WriteFile(hSerial, buffer, len, &dwBytesWritten, NULL);
+	if (hSerial == INVALID_HANDLE_VALUE)
+		return len;
+
+	serRing_t *ring = &tx[((lane < 0) || (lane >= SER_TX_LANES)) ? SER_TX_LANES - 1 : lane];
+	uint32_t head = ring->head;
+	for (int i = 0; i < len; i++) {
+		while ((head - ring->tail) == SER_RING_SIZE) {	// send thread is behind - publish what we have and wait
+			ring->head = head;
+			SetEvent(txEvent);
+			SwitchToThread();
+		}
+		ring->data[head & SER_RING_MASK] = buffer[i];
+		head++;
+	}
+	ring->head = head;
+	SetEvent(txEvent);
 	return len;
 }
 
+int xiom_writeline(const char *buffer, int lane)
+{
+	return xiom_write(buffer, strlen(buffer), lane);
+}
+
 void xio_usart_Init(void)
 {
-	InitializeCriticalSectionAndSpinCount(&CriticalSection, 0x00000400);
 	winserial_init("\\\\.\\COM3");
 }
+
+/*
+ * xio_usart_init_job() - take input from a job file ("-" for stdin) instead of the port
+ * xio_usart_job_read() - true once the whole job has been read and handed to the parser
+ *
+ *  Responses are discarded in job mode. Returns false if the job cannot be opened.
+ */
+bool xio_usart_init_job(const char *path)
+{
+	if (strcmp(path, "-") == 0) {
+		hJob = GetStdHandle(STD_INPUT_HANDLE);
+	} else {
+		hJob = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	}
+	if (hJob == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	ctlPaced = true;
+	_beginthread(JobthreadFunction, 0, NULL);
+	return true;
+}
+
+/*
+ * xio_usart_init_record() - capture the port input to path (call before xio_usart_Init())
+ * xio_usart_init_replay() - take input from a capture instead of the port; ends like a job
+ */
+bool xio_usart_init_record(const char *path)
+{
+	serCaptureHeader_t hdr = { SER_CAPTURE_MAGIC, SER_CAPTURE_VERSION };
+	DWORD written;
+
+	hRecord = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hRecord == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	WriteFile(hRecord, &hdr, sizeof(hdr), &written, NULL);
+	return true;
+}
+
+bool xio_usart_init_replay(const char *path)
+{
+	serCaptureHeader_t hdr;
+	DWORD dwBytesRead;
+
+	hJob = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hJob == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	if (!ReadFile(hJob, &hdr, sizeof(hdr), &dwBytesRead, NULL) || (dwBytesRead != sizeof(hdr)) ||
+		(hdr.magic != SER_CAPTURE_MAGIC) || (hdr.version != SER_CAPTURE_VERSION)) {
+		CloseHandle(hJob);
+		hJob = INVALID_HANDLE_VALUE;
+		return false;
+	}
+	_beginthread(ReplaythreadFunction, 0, NULL);
+	return true;
+}
+
+bool xio_usart_job_read(void)
+{
+	return (jobEof && (rx.tail == rx.head) && (rxLen == 0) && (ctl.tail == ctl.head));
+}
@@ -21,6 +21,12 @@ typedef enum {         		        // BSEL	  BSCALE
 } xioBAUDRATES;
 
 int xio_usart_gets(char *buf, const int size);
+int xio_usart_gets_control(char *buf, const int size);
+void xio_usart_flush_to_command(void);
+bool xio_usart_init_job(const char *path);
+bool xio_usart_job_read(void);
+bool xio_usart_init_record(const char *path);
+bool xio_usart_init_replay(const char *path);
 //ʼ
 void xio_usart_Init(void);
 
@@ -130,6 +130,13 @@ namespace Motate {
         volatile uint16_t _last_requested_write_offset = 0;  // The offset into the buffer of the last requested write
 
         volatile uint16_t _transfer_requested = 0;   // keep track of how much we have requested. Non-zero means a request is active.
+        volatile bool _restarting = false;           // _restartTransfer() is running - the done callback must not re-enter it
+
+        // Statistics - never reset
+        uint32_t _rx_bytes = 0;                      // bytes received
+        uint32_t _stall_count = 0;                   // times the ring filled and no transfer could be started (the host is NAKed)
+        uint16_t _high_water = 0;                    // most bytes waiting to be read
+        bool _stalled = false;
 
         // Internal properties!
         // Some devices write in whole-word (4-byte) chunks, even though the last bytes are garbage, and past what we requested.
@@ -143,9 +150,15 @@ namespace Motate {
         RXBuffer(owner_type owner) : _owner(owner) { _data[_size] = 0; };
 
         void init() {
+            // Re-arm from the transfer-done interrupt, so the endpoint is taking data again
+            // right away instead of NAKing the host until the main loop next reads.
+            // If the transfer finished inside our own startRXTransfer() call we leave the
+            // restart to the next read().
             _owner->setRXTransferDoneCallback([&]() { // use a closure
                 _transfer_requested = 0;
-                //_restartTransfer();
+                if (!_restarting) {
+                    _restartTransfer();
+                }
             });
         };
 
@@ -168,7 +181,14 @@ namespace Motate {
         uint16_t _getWriteOffset() {
             base_type* pos = _owner->getRXTransferPosition();
             if (nullptr != pos) {
-                _last_known_write_offset = (pos - _data) & (_size-1); // if it's one past the end, we want it to become zero
+                uint16_t write_offset = (pos - _data) & (_size-1); // if it's one past the end, we want it to become zero
+                _rx_bytes += (write_offset - _last_known_write_offset) & (_size-1);
+                _last_known_write_offset = write_offset;
+
+                uint16_t waiting = (write_offset - _read_offset) & (_size-1);
+                if (waiting > _high_water) {
+                    _high_water = waiting;
+                }
             }
             return _last_known_write_offset;
         }
@@ -227,16 +247,39 @@ namespace Motate {
             return;
         };
 
+        // Span reads: look at unread data in place, then consume() what was used.
+        // getReadSpan() returns the contiguous unread length at the read position and points
+        // span at it. If the unread data wraps the end of the ring, consuming the first span
+        // makes the rest the next span. Consumed space is handed back to the transfer.
+        uint16_t getReadSpan(base_type *&span) {
+            _getWriteOffset();
+            span = _data + _read_offset;
+            if (_last_known_write_offset >= _read_offset) {
+                return _last_known_write_offset - _read_offset;
+            }
+            return _size - _read_offset;
+        };
+
+        void consume(const uint16_t count) {
+            _read_offset = (_read_offset + count) & (_size-1);
+        };
+
         void _restartTransfer() {
             if (_transfer_requested != 0) {
                 return;
             }
+            _restarting = true;
+            _startTransfer();
+            _restarting = false;
+        };
 
+        void _startTransfer() {
             // We can only request contiguous chunks. Let's see what the next one is.
             _getWriteOffset(); // cache the write position
 
             // Bail early if the buffer is full.
             if (isFull()) {
+                _stall();
                 return;
             }
 
@@ -280,6 +323,7 @@ namespace Motate {
             if (_read_offset > _last_known_write_offset) {
                 transfer_size = (_read_offset - _last_known_write_offset) - 4;
                 if (transfer_size < 1) {
+                    _stall();
                     return;
                 }
             // Case [2a]
@@ -295,6 +339,7 @@ namespace Motate {
             _transfer_requested = transfer_size + transfer_size_extra;
 
             // startRXTransfer will return false if it couldn't start the transfer.
+            _stalled = false;
             if (_owner->startRXTransfer(write_pos, transfer_size, write_pos_extra, transfer_size_extra)) {
                 _last_requested_write_offset = (_last_known_write_offset + _transfer_requested) & (_size-1);
                 return;
@@ -305,6 +350,14 @@ namespace Motate {
             _transfer_requested = 0;
         };
 
+        // count each run of failed restarts once
+        void _stall() {
+            if (!_stalled) {
+                _stalled = true;
+                _stall_count++;
+            }
+        };
+
         int16_t read() {
             if (isEmpty()) {
                 _restartTransfer();
@@ -360,6 +413,8 @@ namespace Motate {
 
         uint16_t _transfer_requested = 0;   // keep track of how much we have requested. Non-zero means a request is active.
 
+        uint32_t _full_waits = 0;           // writes that found the buffer full - never reset
+
         constexpr int16_t size() { return _size; };
 
         TXBuffer(owner_type owner) : _owner(owner) { _data[_size] = 0; };
@@ -386,6 +441,12 @@ namespace Motate {
             return true;
         };
 
+        // Bytes that can be written without waiting
+        uint16_t space() {
+            _getReadOffset();
+            return (_last_known_read_offset - _write_offset - 1) & (_size-1);
+        }
+
         uint16_t _getReadOffset() {
             base_type* pos = _owner->getTXTransferPosition();
             if (pos==nullptr) {
@@ -477,6 +538,7 @@ namespace Motate {
             const char *src = buffer;
             while (to_write--) {
                 if (isFull()) {
+                    _full_waits++;
                     _restartTransfer();
 
                     // Wait until something has been read out
@@ -498,6 +560,7 @@ namespace Motate {
         // non-blocking write
         int16_t write_nb(const char *buffer, size_t write_size) {
             if (isFull()) {
+                _full_waits++;
                 _restartTransfer();
                 return -1;
             }
@@ -291,6 +291,65 @@ namespace Motate {
     };
 
 
+#pragma mark PinSet
+    /**************************************************
+     *
+     * PIN GROUPS: PinSet
+     *
+     * A fixed list of (already initialized) output pins that are set or cleared
+     * together. Bit n of the value passed to set() or clear() selects the nth pin
+     * of the list. The selected pins are merged into one mask per port, so all of
+     * them on the same port change with a single register write.
+     *
+     * Which ports the list uses is known at compile time, so unused ports and
+     * null pins cost nothing.
+     *
+     **************************************************/
+
+    template<pin_number... pinNums>
+    struct PinSet;
+
+    template<>
+    struct PinSet<> {
+        static constexpr uint32_t maskForPort(const uint8_t portLetter, const uint32_t bits) { return 0; };
+    };
+
+    template<pin_number pinNum, pin_number... pinNums>
+    struct PinSet<pinNum, pinNums...> {
+        // Port bits of the pins selected by bits, for one port
+        static constexpr uint32_t maskForPort(const uint8_t portLetter, const uint32_t bits) {
+            return ((bits & 1) ? (uint32_t)Pin<pinNum>::maskForPort(portLetter) : 0) | PinSet<pinNums...>::maskForPort(portLetter, bits >> 1);
+        };
+
+        void set(const uint32_t bits) {
+            _set<'A'>(bits); _set<'B'>(bits); _set<'C'>(bits); _set<'D'>(bits); _set<'E'>(bits);
+        };
+        void clear(const uint32_t bits) {
+            _clear<'A'>(bits); _clear<'B'>(bits); _clear<'C'>(bits); _clear<'D'>(bits); _clear<'E'>(bits);
+        };
+
+    private:
+        template<uint8_t portLetter>
+        void _set(const uint32_t bits) {
+            if (maskForPort(portLetter, ~0u) == 0) { return; } // no pins on this port
+            const uint32_t mask = maskForPort(portLetter, bits);
+            if (mask) {
+                PortHardware<portLetter> port;
+                port.set(mask);
+            }
+        };
+        template<uint8_t portLetter>
+        void _clear(const uint32_t bits) {
+            if (maskForPort(portLetter, ~0u) == 0) { return; }
+            const uint32_t mask = maskForPort(portLetter, bits);
+            if (mask) {
+                PortHardware<portLetter> port;
+                port.clear(mask);
+            }
+        };
+    };
+
+
 #pragma mark IRQPin / LookupIRQPin
     /**************************************************
      *
@@ -326,7 +385,8 @@ namespace Motate {
     };
 
     // IRQPin壬ġ
-	#if 0    template<pin_number pinNum>
+	#if 0
+    template<pin_number pinNum>
     struct IRQPin<pinNum, typename std::enable_if<IsIRQPin<pinNum>() && !Pin<pinNum>::isNull()>::type> : Pin<pinNum>, _pinChangeInterrupt {
         static_assert(!Pin<pinNum>::isNull(), "Cannot have a null pin be an IRQ");
 
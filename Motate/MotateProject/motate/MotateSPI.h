@@ -246,7 +246,8 @@ namespace Motate {
 
 
         SPIBusDeviceBase *_first_device, *_current_transaction_device;
-        SPIMessage * volatile _first_message;//, *_last_message;
+        SPIMessage * volatile _first_message;
+        SPIMessage * volatile _last_message;
 
         volatile bool sending = false; // as long as this is true, sendNextMessage() does nothing
 
@@ -312,6 +313,36 @@ namespace Motate {
             hardware.enable();
         };
 
+        // Link messages first..last (already linked through next_message) onto the end of the queue.
+        // The interrupt pops from the head and may queue from callbacks, so this is done masked.
+        void _appendMessages(SPIMessage *first, SPIMessage *last) {
+            last->next_message = nullptr;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_first_message == nullptr) {
+                _first_message = first;
+            } else {
+                _last_message->next_message = first;
+            }
+            _last_message = last;
+            __set_PRIMASK(primask);
+        };
+
+        // Queue a chain of messages, built with SPIBusDevice::chainMessage(), in one go.
+        // The messages may be for different devices. Each runs from the transfer-done
+        // interrupt of the one before, so a whole polling pass (driver status, encoder
+        // reads...) goes out without the CPU. Chip select follows each message's device
+        // and deassert_after/ends_transaction as for single messages.
+        void queueChain(SPIMessage *first) {
+            SPIMessage *last = first;
+            while (last->next_message != nullptr) {
+                last = last->next_message;
+            }
+            _appendMessages(first, last);
+            sendNextMessage();
+        };
+
         // This function uses a ServiceCall to jump to the correct interrupt level, which may be higher or lower than the current level.
         void sendNextMessage() {
             message_manager.call();
@@ -334,6 +365,9 @@ namespace Motate {
                     while (walker_message != nullptr) {
                         if (walker_message->device == _current_transaction_device) {
                             // we have our actual next message, we'll pop it to the first position
+                            if (_last_message == walker_message) {
+                                _last_message = previous_message;
+                            }
                             previous_message->next_message = walker_message->next_message;
                             walker_message->next_message = _first_message;
                             _first_message = walker_message;
@@ -391,6 +425,9 @@ namespace Motate {
                 if (_first_message) {
                     auto this_message = _first_message;
                     _first_message = this_message->next_message;
+                    if (_first_message == nullptr) {
+                        _last_message = nullptr;
+                    }
                     this_message->next_message = nullptr;
                     this_message->sending = false;
 
@@ -478,18 +515,7 @@ namespace Motate {
             // queue message
             void queueMessage (SPIMessage *msg) override {
                 msg->device = this;
-                if (_spi_bus->_first_message == nullptr) {
-                    _spi_bus->_first_message = msg;
-                    //_spi_bus->_last_message = msg;
-                }
-                else {
-                    SPIMessage *walker_message = _spi_bus->_first_message;
-                    while (walker_message->next_message != nullptr) {
-                        walker_message = walker_message->next_message;
-                    }
-
-                    walker_message->next_message = msg;
-                }
+                _spi_bus->_appendMessages(msg, msg);
 
                 // Either we just queued the first message, OR we *might* have
                 // just queued a message for the current transaction
@@ -499,6 +525,17 @@ namespace Motate {
                 _spi_bus->sendNextMessage();
             };
 
+            // add a message for this device to a chain being built for queueChain()
+            // pass nullptr as after to start a chain. Returns msg, to chain the next one after.
+            SPIMessage *chainMessage(SPIMessage *msg, SPIMessage *after) {
+                msg->device = this;
+                msg->next_message = nullptr;
+                if (after != nullptr) {
+                    after->next_message = msg;
+                }
+                return msg;
+            };
+
             uint32_t getChannel() override { return _cs_value; };
         };
 
@@ -334,6 +334,8 @@ namespace Motate {
             } else if ((kSerialNumberId == stringNum) && getUSBSerialNumberString) {
                 string = (const char *)getUSBSerialNumberString(length);
             } else {
+                // An interface may own the string (e.g. the MS OS string of a vendor interface)
+                _mixins_type::sendSpecialDescriptorOrConfig(setup);
                 return; // This is wrong, but works...?
             }
 
@@ -579,13 +579,14 @@ namespace Motate {
             {
                 uint16_t ep_size = Motate::getEndpointSize(read_endpoint, kEndpointTypeBulk, deviceSpeed, otherSpeed, limitedSize);
                 const EndpointBufferSettings_t _buffer_size = getBufferSizeFlags(ep_size);
-                return kEndpointBufferOutputFromHost | _buffer_size | kEndpointBufferBlocks1 | kEndpointBufferTypeBulk;
+                // two banks (ping-pong): the host can send the next packet while the last one is drained
+                return kEndpointBufferOutputFromHost | _buffer_size | kEndpointBufferBlocksUpTo2 | kEndpointBufferTypeBulk;
             }
             else if (endpoint == write_endpoint)
             {
                 uint16_t ep_size = Motate::getEndpointSize(write_endpoint, kEndpointTypeBulk, deviceSpeed, otherSpeed, limitedSize);
                 const EndpointBufferSettings_t _buffer_size = getBufferSizeFlags(ep_size);
-                return kEndpointBufferInputToHost | _buffer_size | kEndpointBufferBlocks1 | kEndpointBufferTypeBulk;
+                return kEndpointBufferInputToHost | _buffer_size | kEndpointBufferBlocksUpTo2 | kEndpointBufferTypeBulk;
             }
             return kEndpointBufferNull;
         };
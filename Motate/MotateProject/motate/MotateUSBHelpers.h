@@ -850,6 +850,60 @@ namespace Motate {
         };
     } ATTR_PACKED;
 
+#pragma mark Microsoft OS descriptors
+    // Windows asks for string 0xEE the first time it sees a VID/PID. If the answer is the
+    // descriptor below it follows up with a vendor request (bRequest = VendorCode, wIndex = 4)
+    // for the compatible ID descriptor, and binds WinUSB to the interface named there - no .inf
+    // is needed. libusb on other hosts ignores both.
+
+    static const uint8_t  kMSOSStringIndex   = 0xEE;
+    static const uint8_t  kMSOSVendorCode    = 0x4D; // any value - the host echoes it back as bRequest
+    static const uint16_t kMSOSCompatIDIndex = 0x0004;
+
+    struct USBDescriptorMSOSString_t
+    {
+        USBDescriptorHeader_t Header;
+        char16_t Signature[7];      // "MSFT100"
+        uint8_t  VendorCode;
+        uint8_t  Padding;
+
+        constexpr USBDescriptorMSOSString_t()
+        : Header{sizeof(USBDescriptorMSOSString_t), kStringDescriptor},
+          Signature{u'M', u'S', u'F', u'T', u'1', u'0', u'0'},
+          VendorCode{kMSOSVendorCode},
+          Padding{0}
+        {};
+    } ATTR_PACKED;
+
+    // Header section followed by one function section
+    struct USBDescriptorMSCompatID_t
+    {
+        uint32_t Length;
+        uint16_t Version;           // 1.00
+        uint16_t Index;             // kMSOSCompatIDIndex
+        uint8_t  Count;             // function sections that follow
+        uint8_t  Reserved0[7];
+
+        uint8_t  FirstInterface;
+        uint8_t  Reserved1;         // must be 0x01
+        char     CompatibleID[8];
+        char     SubCompatibleID[8];
+        uint8_t  Reserved2[6];
+
+        constexpr USBDescriptorMSCompatID_t(const uint8_t _FirstInterface)
+        : Length{sizeof(USBDescriptorMSCompatID_t)},
+          Version{0x0100},
+          Index{kMSOSCompatIDIndex},
+          Count{1},
+          Reserved0{},
+          FirstInterface{_FirstInterface},
+          Reserved1{0x01},
+          CompatibleID{'W', 'I', 'N', 'U', 'S', 'B', 0, 0},
+          SubCompatibleID{},
+          Reserved2{}
+        {};
+    } ATTR_PACKED;
+
 #pragma mark Setup_t
     struct Setup_t
     {
@@ -992,6 +1046,15 @@ namespace Motate {
             return (_bmRequestType == (kRequestHostToDevice | kRequestClass | kRequestInterface));
         };
 
+        // Any recipient - the MS OS requests go to the device, our own to the interface
+        const bool isADeviceToHostVendorRequest() const {
+            return ((_bmRequestType & (kRequestDirectionMask | kRequestTypeMask)) == (kRequestDeviceToHost | kRequestVendor));
+        };
+
+        const bool isAHostToDeviceVendorRequest() const {
+            return ((_bmRequestType & (kRequestDirectionMask | kRequestTypeMask)) == (kRequestHostToDevice | kRequestVendor));
+        };
+
         const bool requestIs(uint8_t testRequest) const {
             return _bRequest == testRequest;
         };
@@ -0,0 +1,404 @@
+/*
+ utility/MotateUSBVendor.h - Library for the Motate system
+ http://github.com/synthetos/motate/
+
+ Copyright (c) 2013 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+#ifndef MOTATEUSBVENDOR_ONCE
+#define MOTATEUSBVENDOR_ONCE
+
+#include "MotateUSBHelpers.h"
+#include <functional>
+
+namespace Motate {
+
+    /* ############################################ */
+    /* #                                          # */
+    /* #        USB Vendor Bulk Interface         # */
+    /* #                                          # */
+    /* ############################################ */
+
+    // One vendor-specific interface (class 0xFF) with a bulk OUT and a bulk IN endpoint, and
+    // nothing else - no line coding, no notification endpoint. The host talks to it with
+    // WinUSB or libusb and can queue transfers much larger than a packet, which a tty
+    // cannot do. It answers the Microsoft OS descriptor requests so Windows binds WinUSB
+    // without an .inf. Use at most one per device (the compatible ID names one interface).
+    //
+    // There are no DTR/RTS lines, so the host says when it has the interface open with
+    // kVendorBulkSetOpen (wValue 1 = open, 0 = closed).
+
+    /** Vendor requests understood by the interface (bmRequestType: vendor, to the interface) */
+    enum USBVendorBulkRequests_t
+    {
+        kVendorBulkSetOpen = 0x01,
+    };
+
+    // Placeholder for use in end-code
+    // IOW: USBDevice<USBCDC, USBVendor> usb;
+    // Also, used as the base class for the resulting specialized USBMixin.
+    struct USBVendor {
+        static bool isNull() { return false; };
+        static const uint8_t endpoints_used = (uint8_t)2;
+    };
+
+#pragma mark USBVendorBulk
+
+    template <typename usb_parent_type>
+    struct USBVendorBulk {
+        usb_parent_type &usb;
+        const uint8_t read_endpoint;
+        const uint8_t write_endpoint;
+        const uint8_t interface_number;
+        std::function<void(bool)> connection_state_changed_callback;
+        std::function<void(const size_t &length)> data_available_callback;
+        std::function<void(void)> transfer_rx_done_callback;
+        std::function<void(void)> transfer_tx_done_callback;
+
+        volatile bool _open = false;
+
+        USBVendorBulk(usb_parent_type &usb_parent,
+                      const uint8_t new_endpoint_offset,
+                      const uint8_t new_interface_number
+                      )
+        : usb(usb_parent),
+        read_endpoint(new_endpoint_offset),
+        write_endpoint(new_endpoint_offset+1),
+        interface_number(new_interface_number)
+        {};
+
+        USBVendorBulk(const USBVendorBulk&) = delete;
+        USBVendorBulk(USBVendorBulk&& other) = delete;
+
+        // Non-Blocking, returns how much was read
+        uint16_t readSome(char *buffer, const uint16_t length) {
+            int16_t total_read = 0;
+            int16_t to_read = length;
+            char *read_ptr = buffer;
+
+            do {
+                int16_t amount_read = usb.read(read_endpoint, read_ptr, to_read);
+
+                if (amount_read <  1)
+                    break;
+
+                total_read += amount_read;
+                to_read -= amount_read;
+                read_ptr += amount_read;
+            } while (to_read > 0);
+
+            return total_read;
+        };
+
+        USB_DMA_Descriptor _rx_dma_descriptor;
+        // for now we ignore buffer2 and length2
+        bool startRXTransfer(char *buffer, const uint16_t length, char *buffer2, const uint16_t length2) {
+            _rx_dma_descriptor.setBuffer(buffer, length);
+            return usb.transfer(read_endpoint, _rx_dma_descriptor);
+        };
+
+        char* getRXTransferPosition() {
+            return usb.getTransferPositon(read_endpoint);
+        };
+
+        void setRXTransferDoneCallback(const std::function<void()> &callback) {
+            transfer_rx_done_callback = callback;
+        }
+
+        void setRXTransferDoneCallback(std::function<void()> &&callback) {
+            transfer_rx_done_callback = std::move(callback);
+        }
+
+        USB_DMA_Descriptor _tx_dma_descriptor;
+        bool startTXTransfer(char *buffer, const uint16_t length) {
+            _tx_dma_descriptor.setBuffer(buffer, length);
+            return usb.transfer(write_endpoint, _tx_dma_descriptor);
+        };
+
+        char* getTXTransferPosition() {
+            return usb.getTransferPositon(write_endpoint);
+        };
+
+        void setTXTransferDoneCallback(const std::function<void()> &callback) {
+            transfer_tx_done_callback = callback;
+        }
+
+        void setTXTransferDoneCallback(std::function<void()> &&callback) {
+            transfer_tx_done_callback = std::move(callback);
+        }
+
+        // This write will write what it can, return how much it wrote, and will NOT flush.
+        int32_t writeSome(const char *data, const uint16_t length) {
+            int16_t total_written = 0;
+            const char *out_buffer = data;
+            int16_t to_write = length;
+
+            do {
+                int16_t written = usb.write(write_endpoint, out_buffer, to_write);
+
+                if (written < 1) // -1 = ERROR, and 0 means we would block
+                    break;
+
+                total_written += written;
+                to_write -= written;
+                out_buffer += written;
+            } while (to_write > 0);
+
+            return total_written;
+        }
+
+        void flush() {
+            usb.flush(write_endpoint);
+        }
+
+        void flushRead() {
+            usb.flushRead(read_endpoint);
+        }
+
+        bool isConnected() {
+            return usb.isConnected() && _open;
+        }
+
+        void setConnectionCallback(const std::function<void(bool)> &callback) {
+            connection_state_changed_callback = callback;
+            if (connection_state_changed_callback && isConnected()) {
+                connection_state_changed_callback(true);
+            }
+        }
+
+        void setConnectionCallback(std::function<void(bool)> &&callback) {
+            connection_state_changed_callback = std::move(callback);
+            if (connection_state_changed_callback && isConnected()) {
+                connection_state_changed_callback(true);
+            }
+        }
+
+        void setDataAvailableCallback(const std::function<void(const size_t &length)> &callback) {
+            usb.enableRXInterrupt(read_endpoint);
+            data_available_callback = callback;
+        }
+
+        void setDataAvailableCallback(std::function<void(const size_t &length)> &&callback) {
+            usb.enableRXInterrupt(read_endpoint);
+            data_available_callback = std::move(callback);
+        }
+
+        // This is to be called from USBDeviceHardware when new data is available.
+        // It returns if the request was handled or not.
+        bool handleDataAvailable(const uint8_t &endpointNum, const size_t &length) {
+            if (data_available_callback && (endpointNum == read_endpoint)) {
+                data_available_callback(length);
+                return true;
+            }
+            return false;
+        }
+
+        // This is to be called from USBDeviceHardware when a transfer is done.
+        // It returns if the request was handled or not.
+        bool handleTransferDone(const uint8_t &endpointNum) {
+            if (transfer_rx_done_callback && (endpointNum == read_endpoint)) {
+                transfer_rx_done_callback();
+                return true;
+            }
+            if (transfer_tx_done_callback && (endpointNum == write_endpoint)) {
+                transfer_tx_done_callback();
+                return true;
+            }
+            return false;
+        }
+
+        bool handleNonstandardRequest(const Setup_t &setup) {
+            // MS OS compatible ID - asked of the device, not of an interface
+            if (setup.isADeviceToHostVendorRequest() && setup.requestIs(kMSOSVendorCode) &&
+                (setup.index() == kMSOSCompatIDIndex)) {
+                USBDescriptorMSCompatID_t *compat_id = new (&USBControlBuffer) USBDescriptorMSCompatID_t(interface_number);
+                uint16_t length = (setup.length() < sizeof(USBDescriptorMSCompatID_t)) ? setup.length() : sizeof(USBDescriptorMSCompatID_t);
+                usb.writeToControl((char *)compat_id, length);
+                return true;
+            }
+
+            if (setup.index() != interface_number)
+                return false;
+
+            if (setup.isAHostToDeviceVendorRequest() && setup.requestIs(kVendorBulkSetOpen)) {
+                bool was_open = _open;
+                _open = (setup.valueLow() != 0);
+                if (was_open != _open) {
+                    flush();
+                    if (connection_state_changed_callback) {
+                        connection_state_changed_callback(_open);
+                    }
+                }
+                return true;
+            }
+            return false;
+        };
+
+        bool sendSpecialDescriptor(const Setup_t &setup) const {
+            if ((setup.valueHigh() == kStringDescriptor) && (setup.valueLow() == kMSOSStringIndex)) {
+                USBDescriptorMSOSString_t *os_string = new (&USBControlBuffer) USBDescriptorMSOSString_t();
+                usb.writeToControl((char *)os_string, sizeof(USBDescriptorMSOSString_t));
+                return true;
+            }
+            return false;
+        };
+
+        void handleConnectionStateChanged(const bool connected) {
+            if (!connected) {
+                _open = false;
+                if (connection_state_changed_callback) {
+                    connection_state_changed_callback(false);
+                }
+            }
+        }
+
+        // Stub in begin() and end()
+        void begin(uint32_t baud_count) {};
+        void end(void){};
+
+        const EndpointBufferSettings_t getEndpointSettings(const uint8_t endpoint, const USBDeviceSpeed_t deviceSpeed, const bool otherSpeed, const bool limitedSize) const {
+            if (endpoint == read_endpoint)
+            {
+                uint16_t ep_size = Motate::getEndpointSize(read_endpoint, kEndpointTypeBulk, deviceSpeed, otherSpeed, limitedSize);
+                const EndpointBufferSettings_t _buffer_size = getBufferSizeFlags(ep_size);
+                return kEndpointBufferOutputFromHost | _buffer_size | kEndpointBufferBlocksUpTo2 | kEndpointBufferTypeBulk;
+            }
+            else if (endpoint == write_endpoint)
+            {
+                uint16_t ep_size = Motate::getEndpointSize(write_endpoint, kEndpointTypeBulk, deviceSpeed, otherSpeed, limitedSize);
+                const EndpointBufferSettings_t _buffer_size = getBufferSizeFlags(ep_size);
+                return kEndpointBufferInputToHost | _buffer_size | kEndpointBufferBlocksUpTo2 | kEndpointBufferTypeBulk;
+            }
+            return kEndpointBufferNull;
+        };
+
+        uint16_t getEndpointSize(const uint8_t &endpoint, const USBDeviceSpeed_t deviceSpeed, const bool otherSpeed, const bool limitedSize) const {
+            if ((endpoint == read_endpoint) || (endpoint == write_endpoint))
+            {
+                return Motate::getEndpointSize(endpoint, kEndpointTypeBulk, deviceSpeed, otherSpeed, limitedSize);
+            }
+            return 0;
+        };
+    };
+
+#pragma mark USBMixin< usb_parent_type, position, USBVendor >
+    template <typename usb_parent_type, uint8_t position>
+    struct USBMixin< usb_parent_type, position, USBVendor > : USBVendor {
+
+        typedef USBMixin<usb_parent_type, position, USBVendor> this_type;
+
+        // USBVendor defines endpoints_used
+        static const uint8_t interfaces_used = 1;
+
+        USBVendorBulk< usb_parent_type > Bulk;
+
+        USBMixin (usb_parent_type &usb_parent,
+                   const uint8_t new_endpoint_offset,
+                   const uint8_t first_interface_number
+                   )
+        : Bulk(usb_parent, new_endpoint_offset, first_interface_number)
+        {};
+
+        const EndpointBufferSettings_t getEndpointConfigFromMixin(const uint8_t endpoint, const USBDeviceSpeed_t deviceSpeed, const bool other_speed) const {
+            return Bulk.getEndpointSettings(endpoint, deviceSpeed, other_speed, /*limitedSize*/ false);
+        };
+        void handleConnectionStateChangedInMixin(const bool connected) {
+            Bulk.handleConnectionStateChanged(connected);
+        };
+        bool handleNonstandardRequestInMixin(const Setup_t &setup) {
+            return Bulk.handleNonstandardRequest(setup);
+        };
+        bool handleTransferDoneInMixin(const uint8_t &endpointNum) {
+            return Bulk.handleTransferDone(endpointNum);
+        }
+        bool handleDataAvailableInMixin(const uint8_t &endpointNum, const size_t &length) {
+            return Bulk.handleDataAvailable(endpointNum, length);
+        }
+        uint16_t getEndpointSizeFromMixin(const uint8_t endpoint, const USBDeviceSpeed_t deviceSpeed, const bool otherSpeed) const {
+            return Bulk.getEndpointSize(endpoint, deviceSpeed, otherSpeed, /*limitedSize*/ false);
+        };
+        bool sendSpecialDescriptorOrConfig(const Setup_t &setup) const {
+            return Bulk.sendSpecialDescriptor(setup);
+        };
+    };
+
+#pragma mark USBConfigMixin< USBVendor, ?, ? >
+
+    // A single interface needs no IAD, so one layout serves every position and count.
+    template <uint8_t usb_interface_positon, uint8_t interface_count>
+    struct USBConfigMixin<USBVendor, usb_interface_positon, interface_count>
+    {
+        static const uint8_t interfaces = 1;
+        static const uint8_t endpoints = 2;
+
+        const USBDescriptorInterface_t Vendor_Interface;
+        const USBDescriptorEndpoint_t  Vendor_DataOutEndpoint;
+        const USBDescriptorEndpoint_t  Vendor_DataInEndpoint;
+
+        USBConfigMixin (
+                         const uint8_t _first_endpoint_number,
+                         const uint8_t _first_interface_number,
+                         const USBDeviceSpeed_t _deviceSpeed,
+                         const bool _other_speed,
+                         const bool _limited_size = false
+                         )
+        : Vendor_Interface(
+                           /* _InterfaceNumber   = */ _first_interface_number,
+                           /* _AlternateSetting  = */ 0,
+                           /* _TotalEndpoints    = */ 2,
+
+                           /* _Class             = */ kVendorSpecificClass,
+                           /* _SubClass          = */ kVendorSpecificSubclass,
+                           /* _Protocol          = */ kVendorSpecificProtocol,
+
+                           /* _InterfaceStrIndex = */ 0 // none
+                           ),
+        Vendor_DataOutEndpoint(
+                               /* _deviceSpeed       = */ _deviceSpeed,
+                               /* _otherSpeed        = */ _other_speed,
+                               /* _input             = */ false,
+                               /* _EndpointAddress   = */ _first_endpoint_number,
+                               /* _Attributes        = */ (kEndpointTypeBulk | kEndpointAttrNoSync | kEndpointUsageData),
+                               /* _PollingIntervalMS = */ 0x01,
+                               /* _limited_size      = */ _limited_size
+                               ),
+        Vendor_DataInEndpoint(
+                              /* _deviceSpeed       = */ _deviceSpeed,
+                              /* _otherSpeed        = */ _other_speed,
+                              /* _input             = */ true,
+                              /* _EndpointAddress   = */ _first_endpoint_number+1,
+                              /* _Attributes        = */ (kEndpointTypeBulk | kEndpointAttrNoSync | kEndpointUsageData),
+                              /* _PollingIntervalMS = */ 0x01,
+                              /* _limited_size      = */ _limited_size
+                              )
+        {};
+
+        static bool isNull() { return false; };
+    };
+}
+
+#endif
+// MOTATEUSBVENDOR_ONCE
@@ -35,6 +35,7 @@
 #include "spindle.h"
 #include "coolant.h"
 #include "temperature.h"
+#include "sync.h"
 #include "util.h"
 
 /****************************************************************************************
@@ -166,6 +167,7 @@ stat_t cm_alarm(const stat_t status, const char *msg)
         (cm->machine_state == MACHINE_PANIC)) {
         return (STAT_OK);                       // don't alarm if already in an alarm state
     }
+    sync_alarm_raised();                        // alarm the other board too
     cm_request_feedhold(FEEDHOLD_TYPE_SCRAM, FEEDHOLD_EXIT_ALARM);  // fast stop and alarm
     rpt_exception(status, msg);                 // send alarm message
     sr_request_status_report(SR_REQUEST_TIMED);
@@ -194,6 +196,7 @@ stat_t cm_shutdown(const stat_t status, const char *msg)
     if ((cm->machine_state == MACHINE_SHUTDOWN) || (cm->machine_state == MACHINE_PANIC)) {
         return (STAT_OK);                       // don't shutdown if shutdown or panic'd
     }
+    sync_alarm_raised();
     cm_request_feedhold(FEEDHOLD_TYPE_SCRAM, FEEDHOLD_EXIT_SHUTDOWN);  // fast stop and shutdown
 
 //    spindle_reset();                            // stop spindle immediately and set speed to 0 RPM
@@ -204,6 +207,7 @@ stat_t cm_shutdown(const stat_t status, const char *msg)
     for (uint8_t i = 0; i < HOMING_AXES; i++) { // unhome axes and the machine
         cm->homed[i] = false;
     }
+    cm_update_soft_limits();
     cm->homing_state = HOMING_NOT_HOMED;
 
 //    cm1.machine_state = MACHINE_SHUTDOWN;       // shut down both machines...
@@ -230,6 +234,7 @@ stat_t cm_panic(const stat_t status, const char *msg)
     if (cm->machine_state == MACHINE_PANIC) {    // only do this once
         return (STAT_OK);
     }
+    sync_alarm_raised();
     cm_halt_motion();                           // halt motors (may have already been done from GPIO)
     spindle_reset();                            // stop spindle immediately and set speed to 0 RPM
     coolant_reset();                            // stop coolant immediately
@@ -0,0 +1,474 @@
+/*
+ * benchmark.cpp - planner and parser micro-benchmarks
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "benchmark.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "json_parser.h"
+#include "planner.h"
+#include "plan_arc.h"
+#include "profile.h"
+#include "stepper.h"
+#include "text_parser.h"
+#include "controller.h"
+#include "xio.h"
+#include "util.h"
+
+#define BENCH_SEGMENT   0.05                // short segment length (mm)
+#define BENCH_HEADROOM  4                   // reset the planner when fewer buffers are free
+#define BENCH_EXEC_MAX  100000              // most mp_exec_move() calls to drain the queue (a stuck runtime)
+
+enum benchStage {                           // stages timed by the job workload
+    BENCH_PARSE = 0,
+    BENCH_PLAN,
+    BENCH_FWD_PLAN,
+    BENCH_EXEC,
+    BENCH_STAGES
+};
+
+// a small closed path - short segments, corners and two half circles - run incrementally
+static const char bench_job_lines[] =
+    "G1 X0.5 Y0.2\n"
+    "G1 X0.4 Y-0.3\n"
+    "G1 X0.02 Y0.01\n"
+    "G1 X0.08 Y0.09\n"
+    "G2 X1 I0.5 J0\n"
+    "G1 X-0.2 Y0.5\n"
+    "G1 X-0.8 Y-0.2\n"
+    "G3 X-1 I-0.5 J0\n"
+    "G1 Y-0.3\n";
+
+/**** Allocate Structures ****/
+
+static struct benchSingleton {
+    benchResult_t r;                        // result being accumulated
+    uint32_t start;                         // cycle count at _bench_start()
+    char line[64];                          // working copy - the parsers edit in place
+    benchResult_t stage[BENCH_STAGES];      // job workload results, one per stage
+    uint32_t ops;                           // ops per workload of the last {bench:n}
+} bench;
+
+static xio_flash_file bench_job = make_xio_flash_file(bench_job_lines);
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+
+static inline void _bench_start() { bench.start = prof_cycle_count(); }
+static inline void _bench_stop() { bench.r.cycles += prof_cycle_count() - bench.start; }
+
+// empty the planner and start it priming, as mp_planner_callback() would - the controller
+// doesn't run while a benchmark does, and mp_plan_block_list() needs mp->p and the state
+static void _bench_planner_reset()
+{
+    planner_reset(mp);
+    mp->p = mp_get_r();
+    mp->planner_state = PLANNER_PRIMING;
+}
+
+static void _bench_begin(const char *name)
+{
+    bench.r.name = name;
+    bench.r.ops = 0;
+    bench.r.cycles = 0;
+    bench.r.status = STAT_OK;
+    _bench_planner_reset();
+}
+
+// report the workload just run and keep the first error seen
+static stat_t _bench_report(benchReport report, stat_t status = STAT_OK)
+{
+    report(&bench.r);
+    return ((status != STAT_OK) ? status : bench.r.status);
+}
+
+static bool _bench_fail(stat_t status)
+{
+    if ((status != STAT_OK) && (bench.r.status == STAT_OK)) {
+        bench.r.status = status;
+    }
+    return (status != STAT_OK);
+}
+
+static stat_t _bench_gcode(const char *block)
+{
+    strncpy(bench.line, block, sizeof(bench.line) - 1);
+    return (gcode_parser(bench.line));
+}
+
+static void _bench_make_room()
+{
+    if (mp_get_planner_buffers(mp) < BENCH_HEADROOM) {
+        _bench_planner_reset();
+    }
+}
+
+// short segments alternate +/- so the position never drifts (the moves are incremental)
+static const char *_bench_segment(uint32_t op)
+{
+    return ((op & 1) ? "G1 X-0.05 Y-0.02" : "G1 X0.05 Y0.02");
+}
+
+/*
+ * Workloads - each times ops operations into bench.r
+ */
+
+static void _bench_gcode_parser(uint32_t ops)
+{
+    _bench_begin("gcode_parser");
+    for (uint32_t op = 0; op < ops; op++) {
+        _bench_make_room();
+        strncpy(bench.line, _bench_segment(op), sizeof(bench.line) - 1);
+        _bench_start();
+        stat_t status = gcode_parser(bench.line);
+        _bench_stop();
+        if (_bench_fail(status)) { return; }
+        bench.r.ops++;
+    }
+}
+
+static void _bench_mp_aline(uint32_t ops, bool plan)
+{
+    _bench_begin(plan ? "mp_plan_block_list" : "mp_aline");
+    GCodeState_t gm = cm->gm;                           // carries the feed rate and modes
+    float x = mp->position[AXIS_X];
+
+    for (uint32_t op = 0; op < ops; op++) {
+        _bench_make_room();
+        gm.target[AXIS_X] = x + ((op & 1) ? 0 : BENCH_SEGMENT);
+        if (plan) {
+            if (_bench_fail(mp_aline(&gm))) { return; }
+            _bench_start();
+            mp_plan_block_list();
+            _bench_stop();
+        } else {
+            _bench_start();
+            stat_t status = mp_aline(&gm);
+            _bench_stop();
+            if (_bench_fail(status)) { return; }
+        }
+        bench.r.ops++;
+    }
+}
+
+static void _bench_mp_calculate_ramps(uint32_t ops)
+{
+    _bench_begin("mp_calculate_ramps");
+    GCodeState_t gm = cm->gm;
+    mpBlockRuntimeBuf_t block;
+
+    gm.target[AXIS_X] = mp->position[AXIS_X] + BENCH_SEGMENT;
+    if (_bench_fail(mp_aline(&gm))) { return; }
+    gm.target[AXIS_X] -= BENCH_SEGMENT;                 // a following move so the first has an exit
+    if (_bench_fail(mp_aline(&gm))) { return; }
+    mp_plan_block_list();
+
+    mpBuf_t *bf = mp_get_run_buffer();
+    for (uint32_t op = 0; op < ops; op++) {
+        _bench_start();
+        mp_calculate_ramps(&block, bf, 0);
+        _bench_stop();
+        bench.r.ops++;
+    }
+}
+
+static void _bench_arc(uint32_t ops)
+{
+    _bench_begin("arc");
+    for (uint32_t op = 0; op < ops; op++) {
+        _bench_planner_reset();
+        strncpy(bench.line, "G2 I1 J0", sizeof(bench.line) - 1);
+        _bench_start();
+        stat_t status = gcode_parser(bench.line);
+        while ((status == STAT_OK) && (cm->arc.run_state != BLOCK_INACTIVE)) {
+            if (mp_planner_is_full(mp)) {               // circle outgrew the queue
+                _bench_planner_reset();
+            }
+            cm_arc_callback(cm);
+        }
+        _bench_stop();
+        if (_bench_fail(status)) { return; }
+        bench.r.ops++;
+    }
+}
+
+static void _bench_feed_override(uint32_t ops)
+{
+    _bench_begin("feed override");
+    GCodeState_t gm = cm->gm;
+    float x = mp->position[AXIS_X];
+
+    for (uint32_t op = 0; !mp_planner_is_full(mp) && (mp_get_planner_buffers(mp) > BENCH_HEADROOM); op++) {
+        gm.target[AXIS_X] = x + ((op & 1) ? 0 : BENCH_SEGMENT);
+        if (_bench_fail(mp_aline(&gm))) { return; }
+    }
+    mp_plan_block_list();
+    mp->planner_state = PLANNER_STARTUP;                // overrides are ignored while idle
+
+    for (uint32_t op = 0; op < ops; op++) {
+        _bench_start();
+        mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME, (op & 1) ? 1.2 : 0.8);
+        mp_plan_block_list();
+        _bench_stop();
+        bench.r.ops++;
+    }
+    mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME, 1.0);
+    cm_reset_overrides();
+}
+
+/*
+ * _bench_job() - run ops lines of the compiled-in job through parse, plan and exec
+ *
+ *  Each line is parsed (with any arc it starts) and the queue backplanned, then segments
+ *  are run until the queue has headroom again. The queue is drained at the end, so the
+ *  path closes and the runtime finishes where it started.
+ */
+
+static inline uint32_t _bench_time_start() { return (prof_cycle_count()); }
+static inline void _bench_time_stop(benchStage s, uint32_t start)
+{
+    bench.stage[s].cycles += prof_cycle_count() - start;
+    bench.stage[s].ops++;
+}
+
+static stat_t _bench_job_exec(bool drain)
+{
+    for (uint32_t n = 0; n < BENCH_EXEC_MAX; n++) {
+        if (!drain && (mp_get_planner_buffers(mp) >= BENCH_HEADROOM)) {
+            return (STAT_OK);
+        }
+        uint32_t start = _bench_time_start();
+        if (mp_forward_plan() == STAT_OK) {
+            _bench_time_stop(BENCH_FWD_PLAN, start);
+        }
+        start = _bench_time_start();
+        stat_t status = mp_exec_move();
+        if (status == STAT_NOOP) {
+            return (STAT_OK);               // nothing left to run
+        }
+        _bench_time_stop(BENCH_EXEC, start);
+        if ((status != STAT_OK) && (status != STAT_EAGAIN)) {   // EAGAIN - the move has more segments
+            return (status);
+        }
+    }
+    return (STAT_INTERNAL_ERROR);
+}
+
+static stat_t _bench_job_line()
+{
+    uint16_t size;
+    const char *from = bench_job.readline(false, size);
+    if (from == NULL) {
+        bench_job.reset();
+        from = bench_job.readline(false, size);
+    }
+    if (size >= sizeof(bench.line)) {
+        size = sizeof(bench.line) - 1;
+    }
+    memcpy(bench.line, from, size);
+    bench.line[size] = NUL;
+
+    uint32_t start = _bench_time_start();
+    stat_t status = gcode_parser(bench.line);
+    while ((status == STAT_OK) && (cm->arc.run_state != BLOCK_INACTIVE)) {
+        if (mp_planner_is_full(mp)) {       // arc outgrew the queue - run some of it
+            bench.stage[BENCH_PARSE].cycles += prof_cycle_count() - start;
+            ritorno(_bench_job_exec(false));
+            start = _bench_time_start();
+        }
+        cm_arc_callback(cm);
+    }
+    _bench_time_stop(BENCH_PARSE, start);
+    return (status);
+}
+
+static stat_t _bench_job(uint32_t ops)
+{
+    const char *names[BENCH_STAGES] = { "job parse", "job plan", "job fwd plan", "job exec" };
+    for (uint8_t s = 0; s < BENCH_STAGES; s++) {
+        bench.stage[s].name = names[s];
+        bench.stage[s].ops = 0;
+        bench.stage[s].cycles = 0;
+        bench.stage[s].status = STAT_OK;
+    }
+    _bench_planner_reset();
+    bench_job.reset();
+
+    stat_t status = STAT_OK;
+    for (uint32_t op = 0; (op < ops) || !bench_job.isDone(); op++) {    // always end on a closed path
+        if ((status = _bench_job_line()) != STAT_OK) {
+            break;
+        }
+        if (mp->planner_state < PLANNER_PRIMING) {                      // as mp_planner_callback() would
+            if (mp->planner_state == PLANNER_IDLE) {
+                mp->p = mp_get_r();
+            }
+            mp->planner_state = PLANNER_PRIMING;
+        }
+        uint32_t start = _bench_time_start();
+        mp_plan_block_list();
+        _bench_time_stop(BENCH_PLAN, start);
+        if ((status = _bench_job_exec(false)) != STAT_OK) {
+            break;
+        }
+    }
+    if (status == STAT_OK) {
+        status = _bench_job_exec(true);
+    }
+    bench.stage[BENCH_PARSE].status = status;
+    return (status);
+}
+
+// one nominal segment on two motors into the null sink - the prep work exec does per segment
+static void _bench_st_prep_line(uint32_t ops)
+{
+    _bench_begin("st_prep_line");
+    float travel[MOTORS] = { 0 };
+    float error[MOTORS] = { 0 };
+    float segment_time = NOM_SEGMENT_MS / 60000;            // minutes
+
+    for (uint32_t op = 0; op < ops; op++) {
+        travel[MOTOR_1] = (op & 1) ? -12.5 : 12.5;
+        travel[MOTOR_2] = (op & 1) ? -5.25 : 5.25;
+        _bench_start();
+        stat_t status = st_prep_line(travel, error, segment_time, 0);
+        _bench_stop();
+        if (_bench_fail(status)) { return; }
+        bench.r.ops++;
+    }
+}
+
+static void _bench_json_parser(uint32_t ops)
+{
+    _bench_begin("json_parser");
+    for (uint32_t op = 0; op < ops; op++) {
+        strncpy(bench.line, (op & 1) ? "{\"xvm\":15000,\"yvm\":15000,\"zvm\":1000}"
+                                     : "{\"xvm\":16000,\"yvm\":16000,\"zvm\":1200}", sizeof(bench.line) - 1);
+        _bench_start();
+        json_parser(bench.line);
+        _bench_stop();
+        bench.r.ops++;
+    }
+}
+
+/*
+ * benchmark_run() - run all workloads with ops operations each, reporting each result
+ *
+ *  The machine must be idle. Runs in incremental mode at a fixed feed and restores
+ *  absolute mode and an empty planner when done. Returns the first workload error.
+ */
+
+stat_t benchmark_run(uint32_t ops, benchReport report)
+{
+    stat_t status;
+
+    if (ops == 0) {
+        ops = BENCHMARK_DEFAULT_OPS;
+    }
+    st_set_null_sink(true);
+    if ((status = _bench_gcode("G91 G17 G21 G94 F1000")) != STAT_OK) {
+        st_set_null_sink(false);
+        return (status);
+    }
+    _bench_gcode_parser(ops);           status = _bench_report(report);
+    _bench_mp_aline(ops, false);        status = _bench_report(report, status);
+    _bench_mp_aline(ops, true);         status = _bench_report(report, status);
+    _bench_mp_calculate_ramps(ops);     status = _bench_report(report, status);
+    _bench_st_prep_line(ops);           status = _bench_report(report, status);
+    _bench_arc(ops / 10);               status = _bench_report(report, status);  // an arc is tens of segments
+    _bench_feed_override(ops);          status = _bench_report(report, status);
+    _bench_json_parser(ops / 10);       status = _bench_report(report, status);  // three values and a response
+
+    stat_t job_status = _bench_job(ops / 10);                                      // each line is tens of segments
+    for (uint8_t s = 0; s < BENCH_STAGES; s++) {
+        report(&bench.stage[s]);
+    }
+    if (status == STAT_OK) {
+        status = job_status;
+    }
+    planner_reset(mp);
+    _bench_gcode("G90");
+    st_set_null_sink(false);
+    return (status);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * _bench_write_result() - write one workload result as a line to the host
+ */
+
+static void _bench_write_result(const benchResult_t *r)
+{
+    uint32_t cycles = (r->ops == 0) ? 0 : (uint32_t)(r->cycles / r->ops);
+    if (js.json_mode == TEXT_MODE) {
+        sprintf(cs.out_buf, "[bench] %-20s %8lu ops %10lu cycles/op %s\n",
+                r->name, (unsigned long)r->ops, (unsigned long)cycles,
+                (r->status == STAT_OK) ? "" : get_status_message(r->status));
+    } else {
+        sprintf(cs.out_buf, "{\"bench\":{\"wl\":\"%s\",\"ops\":%lu,\"cyc\":%lu,\"st\":%d}}\n",
+                r->name, (unsigned long)r->ops, (unsigned long)cycles, (int)r->status);
+    }
+    xio_writeline(cs.out_buf);
+}
+
+/*
+ * bm_get_bench() - get the ops per workload of the last run (0 if none)
+ * bm_set_bench() - run the benchmarks with n ops per workload {bench:n}, 0 for the default
+ */
+
+stat_t bm_get_bench(nvObj_t *nv) { return (get_integer(nv, bench.ops)); }
+
+stat_t bm_set_bench(nvObj_t *nv)
+{
+    if ((cm_get_machine_state() == MACHINE_CYCLE) || !mp_runtime_is_idle() || mp_has_runnable_buffer(mp)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    bench.ops = (nv->value_int > 0) ? nv->value_int : BENCHMARK_DEFAULT_OPS;
+    stat_t status = benchmark_run(bench.ops, _bench_write_result);
+    nv->value_int = bench.ops;
+    nv->valuetype = TYPE_INTEGER;
+    return (status);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_bench[] = "[bench] benchmark ops%14d\n";
+
+void bm_print_bench(nvObj_t *nv) { text_print(nv, fmt_bench); }
+
+#endif // __TEXT_MODE
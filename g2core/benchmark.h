@@ -0,0 +1,81 @@
+/*
+ * benchmark.h - planner and parser micro-benchmarks
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * BENCHMARKS
+ *
+ *  Runs fixed workloads through the hot paths of the parser and planner and reports
+ *  ns/op and cycles/op for each, so regressions show up before release:
+ *
+ *    gcode_parser        short G1 segments, parsed and queued (includes mp_aline)
+ *    mp_aline            short segments queued directly from a gcode model
+ *    mp_plan_block_list  backplanning after each queued segment (drives _plan_block)
+ *    mp_calculate_ramps  trapezoid generation for a planned short segment
+ *    st_prep_line        one nominal segment prepared for the DDA (step table, if built in)
+ *    arc                 a small full circle, parsed and cut into segments
+ *    feed override       alternating 80% / 120% override over a full queue, with replan
+ *    json_parser         a three-value config burst, including the response
+ *    job parse           lines of a compiled-in job (an xio_flash_file) parsed and queued
+ *    job plan            ...backplanned (mp_plan_block_list) after each line
+ *    job fwd plan        ...forward planned (mp_forward_plan) - one op per block
+ *    job exec            ...and run into the null stepper sink (mp_exec_move) - one op per segment
+ *
+ *  Cycles come from the profiler's cycle counter (profile.h) - CPU cycles on the target,
+ *  performance counter ticks on the simulator. The planner is reset between batches and
+ *  the reset is not timed. Benchmarks drive the planner synchronously with the stepper
+ *  null sink on (st_set_null_sink()), so segments are fully prepared but no motor moves.
+ *
+ *  On the target {bench:n} runs all workloads with n ops each (0 for the default) and
+ *  writes one line per workload, so firmware builds can be compared on a bare board. The
+ *  machine must be idle. The simulator runs them with -b (sim_harness.h).
+ */
+
+#ifndef BENCHMARK_H_ONCE
+#define BENCHMARK_H_ONCE
+
+#define BENCHMARK_DEFAULT_OPS   10000
+
+typedef struct benchResult {
+    const char *name;       // workload name
+    uint32_t ops;           // operations timed
+    uint64_t cycles;        // total cycles for those operations
+    stat_t status;          // STAT_OK, or the first error the workload hit
+} benchResult_t;
+
+typedef void (*benchReport)(const benchResult_t *result);
+
+stat_t benchmark_run(uint32_t ops, benchReport report);
+
+stat_t bm_get_bench(nvObj_t *nv);
+stat_t bm_set_bench(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void bm_print_bench(nvObj_t *nv);
+#else
+    #define bm_print_bench tx_print_stub
+#endif // __TEXT_MODE
+
+#endif  // End of include guard: BENCHMARK_H_ONCE
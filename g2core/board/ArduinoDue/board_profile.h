@@ -0,0 +1,94 @@
+/*
+ * board_profile.h - compile-time build profiles
+ * For: /board/ArduinoDue
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * BUILD PROFILES
+ *
+ *  Select a profile in the makefile or compiler command line, e.g. BOARD_PROFILE=BOARD_PROFILE_CNC
+ *
+ *    BOARD_PROFILE_FULL    all subsystems, default step generation and queue size (default)
+ *    BOARD_PROFILE_CNC     CNC only: no heaters or Marlin compatibility, no diagnostic logging,
+ *                          step table DDA with port-wide step writes, 200 KHz DDA with the
+ *                          step path in SRAM, and a deeper planner queue in the SRAM the
+ *                          heaters and logs no longer use
+ *
+ *  A profile only picks defaults. Anything it sets can still be set on the command line, and a
+ *  SETTINGS_FILE must not contradict it (a 3D printer settings file needs BOARD_PROFILE_FULL).
+ *  This file is read before the settings file and before hardware.h, so the values here win
+ *  over the defaults in settings_default.h and the module headers.
+ */
+
+#ifndef BOARD_PROFILE_H_ONCE
+#define BOARD_PROFILE_H_ONCE
+
+#define BOARD_PROFILE_FULL  0
+#define BOARD_PROFILE_CNC   1
+
+#ifndef BOARD_PROFILE
+#define BOARD_PROFILE BOARD_PROFILE_FULL
+#endif
+
+#if BOARD_PROFILE == BOARD_PROFILE_CNC
+
+// subsystems
+#ifndef TEMPERATURE_ENABLED
+#define TEMPERATURE_ENABLED false           // heaters, fans and PIDs are compiled out (see temperature.h)
+#endif
+#ifndef MARLIN_COMPAT_ENABLED
+#define MARLIN_COMPAT_ENABLED false
+#endif
+#ifndef ENCODER_LOG_ENABLED
+#define ENCODER_LOG_ENABLED false
+#endif
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED false
+#endif
+
+// step generation
+#ifndef FREQUENCY_DDA
+#define FREQUENCY_DDA 200000UL
+#endif
+#ifndef DDA_STEP_TABLE
+#define DDA_STEP_TABLE true                 // exec runs the accumulators, the DDA plays a table
+#endif
+#ifndef DDA_STEP_PINSET
+#define DDA_STEP_PINSET true                // one step pin write per port
+#endif
+#ifndef HOT_PATH_IN_RAM
+#define HOT_PATH_IN_RAM true                // DDA, loader, exec and prep run from SRAM (see hardware.h)
+#endif
+
+// queues
+#ifndef PLANNER_QUEUE_SIZE
+#define PLANNER_QUEUE_SIZE 80
+#endif
+
+#elif BOARD_PROFILE != BOARD_PROFILE_FULL
+#error "BOARD_PROFILE must be BOARD_PROFILE_FULL or BOARD_PROFILE_CNC"
+#endif
+
+#endif  // BOARD_PROFILE_H_ONCE
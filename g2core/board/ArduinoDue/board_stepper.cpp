@@ -91,3 +91,7 @@ Stepper* Motors[MOTORS] = {&motor_1, &motor_2, &motor_3, &motor_4};
 void board_stepper_init() {
     for (uint8_t motor = 0; motor < MOTORS; motor++) { Motors[motor]->init(); }
 }
+
+// The gShield has no encoder inputs, so ENCODER_HW_MOTORS must stay 0 on this board.
+// Boards with quadrature (TC QDEC) or SPI encoders return the raw counter here.
+int32_t board_encoder_read(const uint8_t motor) { return (0); }
@@ -88,6 +88,17 @@ extern StepDirStepper<Motate::kSocket4_StepPinNumber,
 
 extern Stepper* Motors[MOTORS];
 
+// Motors run by the DDA interrupt, in motor order - must name MOTORS motors (see stepper.cpp)
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4
+
+// Driver timing of the same motors, in the same order (see step_dir_driver.h)
+#define DDA_MOTOR_TIMING M1_STEP_DRIVER, M2_STEP_DRIVER, M3_STEP_DRIVER, M4_STEP_DRIVER
+
+// Step pins of the same motors, in the same order (used with DDA_STEP_PINSET)
+#define DDA_STEP_PINS Motate::kSocket1_StepPinNumber, Motate::kSocket2_StepPinNumber, \
+                      Motate::kSocket3_StepPinNumber, Motate::kSocket4_StepPinNumber
+
 void board_stepper_init();
+int32_t board_encoder_read(const uint8_t motor);     // hardware encoder counter (see encoder.h)
 
 #endif  // BOARD_STEPPER_H_ONCE
\ No newline at end of file
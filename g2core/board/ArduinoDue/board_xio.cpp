@@ -49,6 +49,9 @@ decltype(usb.mixin<0>::Serial) &SerialUSB = usb.mixin<0>::Serial;
 #if USB_SERIAL_PORTS_EXPOSED == 2
 decltype(usb.mixin<1>::Serial) &SerialUSB1 = usb.mixin<1>::Serial;
 #endif
+#if USB_VENDOR_BULK_EXPOSED == 1
+decltype(usb.mixin<USB_SERIAL_PORTS_EXPOSED>::Bulk) &VendorUSB = usb.mixin<USB_SERIAL_PORTS_EXPOSED>::Bulk;
+#endif
 
 MOTATE_SET_USB_VENDOR_STRING( u"Synthetos" )
 MOTATE_SET_USB_PRODUCT_STRING( u"TinyG v2" )
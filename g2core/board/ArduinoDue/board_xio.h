@@ -36,19 +36,34 @@
 #if XIO_HAS_USB
 #include "MotateUSB.h"
 #include "MotateUSBCDC.h"
+#if USB_VENDOR_BULK_EXPOSED == 1
+#include "MotateUSBVendor.h"
+#endif
 
+#if USB_VENDOR_BULK_EXPOSED == 1
+#if USB_SERIAL_PORTS_EXPOSED == 1
+typedef Motate::USBDevice< Motate::USBCDC, Motate::USBVendor > XIOUSBDevice_t;
+#endif
+#if USB_SERIAL_PORTS_EXPOSED == 2
+typedef Motate::USBDevice<Motate::USBCDC, Motate::USBCDC, Motate::USBVendor> XIOUSBDevice_t;
+#endif
+#else
 #if USB_SERIAL_PORTS_EXPOSED == 1
 typedef Motate::USBDevice< Motate::USBCDC > XIOUSBDevice_t;
 #endif
 #if USB_SERIAL_PORTS_EXPOSED == 2
 typedef Motate::USBDevice<Motate::USBCDC, Motate::USBCDC> XIOUSBDevice_t;
 #endif
+#endif // USB_VENDOR_BULK_EXPOSED
 
 extern XIOUSBDevice_t usb;
 extern decltype(usb.mixin<0>::Serial)& SerialUSB;
 #if USB_SERIAL_PORTS_EXPOSED == 2
 extern decltype(usb.mixin<1>::Serial)& SerialUSB1;
 #endif
+#if USB_VENDOR_BULK_EXPOSED == 1
+extern decltype(usb.mixin<USB_SERIAL_PORTS_EXPOSED>::Bulk)& VendorUSB;   // always after the CDC ports
+#endif
 #endif  // XIO_HAS_USB
 
 
@@ -64,6 +79,52 @@ extern Motate::SPI<Motate::kSocket4_SPISlaveSelectPinNumber> spi;
 extern Motate::UART<Motate::kSerial_RXPinNumber, Motate::kSerial_TXPinNumber> Serial;
 #endif
 
+//******** Buffer sizing ********
+// Per-device RX/TX ring sizes (2^N), skip-section header counts (2^N) and the longest
+// line each device will return (must not exceed RX_BUFFER_SIZE in xio.h).
+#ifndef XIO_USB0_RX_BUFFER_SIZE
+#define XIO_USB0_RX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_USB0_TX_BUFFER_SIZE
+#define XIO_USB0_TX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_USB0_HEADER_COUNT
+#define XIO_USB0_HEADER_COUNT           16
+#endif
+#ifndef XIO_USB0_LINE_BUFFER_SIZE
+#define XIO_USB0_LINE_BUFFER_SIZE       512
+#endif
+
+#ifndef XIO_USB1_RX_BUFFER_SIZE
+#define XIO_USB1_RX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_USB1_TX_BUFFER_SIZE
+#define XIO_USB1_TX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_USB1_HEADER_COUNT
+#define XIO_USB1_HEADER_COUNT           16
+#endif
+#ifndef XIO_USB1_LINE_BUFFER_SIZE
+#define XIO_USB1_LINE_BUFFER_SIZE       512
+#endif
+
+#ifndef XIO_UART_RX_BUFFER_SIZE
+#define XIO_UART_RX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_UART_TX_BUFFER_SIZE
+#define XIO_UART_TX_BUFFER_SIZE         1024
+#endif
+#ifndef XIO_UART_HEADER_COUNT
+#define XIO_UART_HEADER_COUNT           16
+#endif
+#ifndef XIO_UART_LINE_BUFFER_SIZE
+#define XIO_UART_LINE_BUFFER_SIZE       512
+#endif
+
+#ifndef XIO_FLASH_LINE_BUFFER_SIZE
+#define XIO_FLASH_LINE_BUFFER_SIZE      512
+#endif
+
 //******* Generic Functions *******
 void board_hardware_init(void);  // called 1st
 void board_xio_init(void);       // called later
@@ -31,7 +31,9 @@
 #include "config.h"  // #2
 #include "hardware.h"
 #include "controller.h"
+#include "canonical_machine.h"
 #include "text_parser.h"
+#include "profile.h"
 #include "board_xio.h"
 
 #include "MotateUtilities.h"
@@ -45,17 +47,56 @@
 
 void hardware_init()
 {
+#if !defined(WIN32) && !defined(SIM_POSIX)
+    EFC0->EEFC_FMR = EEFC_FMR_FWS(FLASH_WAIT_STATES);   // 128-bit access (FAM clear) for speed
+    EFC1->EEFC_FMR = EEFC_FMR_FWS(FLASH_WAIT_STATES);
+#endif
     board_hardware_init();
 	return;
 }
 
 /*
- * hardware_periodic() - callback from the controller loop - TIME CRITICAL.
+ * Board housekeeping tasks
+ *
+ *  Each job the board needs done in the main loop is its own controller task with its
+ *  own period (see the task table in controller.cpp), and each is timed in the "b"
+ *  profiling region so its cost shows up in {prof:n}. USB connection changes are not
+ *  polled here - they arrive through xio's connection callback.
+ *
+ * hardware_driver_fault_callback() - alarm when a motor driver pulls its fault line
+ *
+ *  The fault lines are the socket interrupt pins, active low. Sockets without one (all
+ *  of them on the gShield) are null pins and compile away. A fault alarms once when
+ *  it is raised; it has to clear before it can alarm again.
  */
 
-stat_t hardware_periodic()
+static Motate::InputPin<Motate::kSocket1_InterruptPinNumber> _socket1_fault{Motate::kPullUp};
+static Motate::InputPin<Motate::kSocket2_InterruptPinNumber> _socket2_fault{Motate::kPullUp};
+static Motate::InputPin<Motate::kSocket3_InterruptPinNumber> _socket3_fault{Motate::kPullUp};
+static Motate::InputPin<Motate::kSocket4_InterruptPinNumber> _socket4_fault{Motate::kPullUp};
+
+static uint8_t _driver_faults;             // one bit per socket, as last polled
+
+stat_t hardware_driver_fault_callback()
 {
-    return STAT_OK;
+    if (_socket1_fault.isNull() && _socket2_fault.isNull() &&
+        _socket3_fault.isNull() && _socket4_fault.isNull()) {
+        return (STAT_NOOP);
+    }
+    PROFILE_CALL(PROF_BOARD);
+
+    uint8_t faults = 0;
+    if (!_socket1_fault.isNull() && !_socket1_fault) { faults |= 0x01; }
+    if (!_socket2_fault.isNull() && !_socket2_fault) { faults |= 0x02; }
+    if (!_socket3_fault.isNull() && !_socket3_fault) { faults |= 0x04; }
+    if (!_socket4_fault.isNull() && !_socket4_fault) { faults |= 0x08; }
+
+    uint8_t raised = faults & ~_driver_faults;
+    _driver_faults = faults;
+    if (raised) {
+        cm_alarm(STAT_ALARM, "motor driver fault");
+    }
+    return (STAT_OK);
 }
 
 /*
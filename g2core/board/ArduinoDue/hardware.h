@@ -29,6 +29,7 @@
  * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "board_profile.h"          // build profile - must precede everything else
 #include "config.h"
 #include "error.h"
 
@@ -55,6 +56,11 @@
 #define SYS_ID_DIGITS 16            // actual digits in system ID (up to 16)
 #define SYS_ID_LEN 24               // total length including dashes and NUL
 
+// board housekeeping task periods (ms) - see hardware.cpp
+#ifndef HARDWARE_DRIVER_FAULT_MS
+#define HARDWARE_DRIVER_FAULT_MS 10 // motor driver fault lines
+#endif
+
 /*************************
  * Motate Setup          *
  *************************/
@@ -103,16 +109,44 @@ using Motate::OutputPin;
 /**** Stepper DDA and dwell timer settings ****/
 
 //#define FREQUENCY_DDA		200000UL		// Hz step frequency. Interrupts actually fire at 2x (400 KHz)
+#ifndef FREQUENCY_DDA						// build profiles can override this value (see board_profile.h)
 #define FREQUENCY_DDA		150000UL		// Hz步频率。 中断实际发射2倍（300 KHz）
+#endif
 #define FREQUENCY_DWELL		1000UL
-#define FREQUENCY_SGI		200000UL		// 200,000 Hz表示软件中断在被调用后将激活5 uSec
+#define FREQUENCY_SGI		200000UL
+
+/**** Hot path placement and flash wait states ****
+ *
+ *  At 84 MHz the SAM3X flash needs FLASH_WAIT_STATES extra cycles per access, which the
+ *  128-bit flash read buffer only hides for straight-line code. With HOT_PATH_IN_RAM the
+ *  functions marked RAMFUNC - the DDA interrupt, _load_move(), mp_exec_move() and
+ *  st_prep_line() - go in the .ramfunc section. The Atmel linker scripts place .ramfunc in
+ *  .relocate, which the startup code copies to SRAM with the initialized data, so they run
+ *  with no wait states and with the same timing every time. Calls between SRAM and flash
+ *  are out of BL range; the linker inserts long-call veneers.
+ *
+ *  The cost is SRAM. Compare {prof:n} (the DDA and load regions) and {bench:n} (job exec
+ *  and st_prep_line) built with and without it before raising FREQUENCY_DDA on the strength
+ *  of it. The simulators ignore it.
+ */
+#ifndef HOT_PATH_IN_RAM						// build profiles can override this value (see board_profile.h)
+#define HOT_PATH_IN_RAM		false
+#endif
+#if (HOT_PATH_IN_RAM == true) && !defined(WIN32) && !defined(SIM_POSIX)
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+#ifndef FLASH_WAIT_STATES
+#define FLASH_WAIT_STATES	4				// FWS for 84 MHz - the datasheet minimum. Set in hardware_init()
+#endif		// 200,000 Hz表示软件中断在被调用后将激活5 uSec
 
 /**** Motate Definitions ****/
 
 // Timer definitions. See stepper.h and other headers for setup
 typedef TimerChannel<3,0> dda_timer_type;	// stepper pulse generation in stepper.cpp
-typedef TimerChannel<4,0> exec_timer_type;	// request exec timer in stepper.cpp
-typedef TimerChannel<5,0> fwd_plan_timer_type;	// request exec timer in stepper.cpp
+typedef ServiceCall<4> exec_timer_type;		// request exec service call in stepper.cpp
+typedef ServiceCall<5> fwd_plan_timer_type;	// request forward plan service call in stepper.cpp
 
 // Pin assignments
 
@@ -154,7 +188,7 @@ static OutputPin<Motate::kCoolant_EnablePinNumber> mist_enable_pin;
  ********************************/
 
 void hardware_init(void);			// master hardware init
-stat_t hardware_periodic();  // callback from the main loop (time sensitive)
+stat_t hardware_driver_fault_callback(void);    // controller task - poll motor driver fault lines
 void hw_hard_reset(void);
 stat_t hw_flash(nvObj_t *nv);
 
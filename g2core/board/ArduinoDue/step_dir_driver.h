@@ -41,6 +41,35 @@ using Motate::kStartLow;
 using Motate::kNormal;
 using Motate::Timeout;
 
+/* Step driver timing profiles
+ *
+ *  Minimum step pulse width and direction setup time for common driver families, from their
+ *  data sheets. Each motor selects one with M1_STEP_DRIVER ... M6_STEP_DRIVER in the settings
+ *  file. The DDA holds a step pulse for as many ticks as the driver needs and holds off the
+ *  first step after a direction change until the setup time has passed (see stepper.cpp), so
+ *  FREQUENCY_DDA can be raised or lowered without violating driver timing.
+ *
+ *  A pulse longer than one tick also needs the same time low, so a motor cannot step faster
+ *  than FREQUENCY_DDA / (2 * pulse ticks).
+ */
+typedef struct stStepTiming {
+    uint16_t pulse_ns;                      // minimum step pulse width (high and low)
+    uint16_t dir_setup_ns;                  // minimum direction setup time before a step edge
+} stStepTiming_t;
+
+constexpr stStepTiming_t STEP_DRIVER_DRV8818 = { 1000,  200 };  // gShield
+constexpr stStepTiming_t STEP_DRIVER_DRV8825 = { 1900,  650 };
+constexpr stStepTiming_t STEP_DRIVER_A4988   = { 1000,  200 };
+constexpr stStepTiming_t STEP_DRIVER_TMC     = {  100,   20 };  // TMC2100/2130/2208/5160 step/dir input
+constexpr stStepTiming_t STEP_DRIVER_SERVO   = { 2500, 5000 };  // typical external servo or closed loop drive
+
+// DDA ticks needed to cover a time in ns - never less than the one tick the DDA always gives
+constexpr uint8_t step_timing_ticks(const uint32_t ns)
+{
+    return ((ns * (uint64_t)FREQUENCY_DDA <= 1000000000ULL) ? 1 :
+            (uint8_t)((ns * (uint64_t)FREQUENCY_DDA + 999999999ULL) / 1000000000ULL));
+}
+
 
 // Motor structures
 template <pin_number step_num,  // Setup a stepper template to hold our pins
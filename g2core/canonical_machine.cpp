@@ -99,13 +99,16 @@
 #include "plan_arc.h"
 #include "planner.h"
 #include "stepper.h"
+#include "kinematics.h"
 #include "encoder.h"
 //#include "toolhead.h"
 #include "spindle.h"
 #include "coolant.h"
 #include "pwm.h"
 #include "report.h"
+#include "persistence.h"
 #include "gpio.h"
+#include "macro.h"
 #include "temperature.h"
 #include "hardware.h"
 #include "util.h"
@@ -125,6 +128,22 @@ cmToolTable_t tt; // 全局工具表
  ****************************************************************************************/
 
 static int8_t _axis(const nvObj_t *nv); // return axis number from token/group in nv
+static void _cm_recalc_rotary_scale(const uint8_t axis);
+static void _exec_offset(float *value, bool *flag);
+static void _checkpoint_callback(void);
+static stat_t _uncoordinated_traverse(void);
+
+static inline bool _any_axis_flagged(const bool *flags)
+{
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++)
+    {
+        if (flags[axis])
+        {
+            return (true);
+        }
+    }
+    return (false);
+}
 
 /****************************************************************************************
  **** CODE ******************************************************************************
@@ -142,8 +161,8 @@ static int8_t _axis(const nvObj_t *nv); // return axis number from token/group i
 
 void canonical_machine_inits()
 {
-    planner_init(&mp1, &mr1, mp1_queue, PLANNER_QUEUE_SIZE);
-    planner_init(&mp2, &mr2, mp2_queue, SECONDARY_QUEUE_SIZE);
+    planner_init(&mp1, &mr1, mp_pool, mp_pool_cold, PRIMARY_POOL_SIZE);
+    planner_init(&mp2, &mr2, &mp_pool[PRIMARY_POOL_SIZE], &mp_pool_cold[PRIMARY_POOL_SIZE], SECONDARY_QUEUE_MIN);
     canonical_machine_init(&cm1, &mp1); // primary canonical machine
     canonical_machine_init(&cm2, &mp2); // secondary canonical machine
     cm = &cm1;                          // set global canonical machine pointer to primary machine
@@ -187,10 +206,8 @@ void canonical_machine_reset(cmMachine_t *_cm)
     _cm->queue_flush_state = QUEUE_FLUSH_OFF;
     _cm->cycle_start_state = CYCLE_START_OFF;
     _cm->job_kill_state = JOB_KILL_OFF;
-    _cm->limit_requested = 0;             // resets switch closures that occurred during initialization
-    _cm->safety_interlock_disengaged = 0; // ditto
+    gpio_flush_events();                  // resets switch closures that occurred during initialization
     _cm->safety_interlock_reengaged = 0;  // ditto
-    _cm->shutdown_requested = 0;          // ditto
     _cm->request_interlock = false;
     _cm->request_interlock_exit = false;
 
@@ -222,6 +239,7 @@ void canonical_machine_reset_rotation(cmMachine_t *_cm)
     // Separately handle a z-offset so that the new plane maintains a consistent
     // distance from the old one. We only need z, since we are rotating to the z axis.
     _cm->rotation_z_offset = 0.0;
+    _cm->rotation_identity = true;
 }
 
 /****************************************************************************************
@@ -407,6 +425,7 @@ stat_t cm_check_linenum()
  ****************************************************************************************/
 /*
  * cm_get_combined_offset() - return the combined offsets for an axis (G53-G59, G92, Tools)
+ * cm_update_combined_offsets() - recompute the cached combined offsets after any offset changes
  * cm_get_display_offset()  - return the current display offset from pecified Gcode model
  * cm_set_display_offsets() - capture combined offsets from the model into absolute values 
  *                            in the active Gcode dynamic model
@@ -437,6 +456,10 @@ stat_t cm_check_linenum()
  *
  *    - cm_get_combined_offset() puts the above together to provide a combined, active offset. 
  *      G92 offsets are only included if g92 is active (gmx.g92_offset_enable == true)
+ *    - The sum is cached in cm.combined_offset[], which target setting and the display offsets
+ *      both read. cm_update_combined_offsets() must be called whenever the active coordinate
+ *      system, its offsets, the tool offset or the G92 offsets change. It also refreshes the
+ *      display offsets in the model.
  *
  *  Display offsets
  *      *** Display offsets are for display only and CANNOT be used to set positions ***
@@ -464,12 +487,20 @@ float cm_get_combined_offset(const uint8_t axis)
     {
         return (0);
     }
-    float offset = cm->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
-    if (cm->gmx.g92_offset_enable == true)
+    return (cm->combined_offset[axis]);
+}
+
+void cm_update_combined_offsets()
+{
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++)
     {
-        offset += cm->gmx.g92_offset[axis];
+        cm->combined_offset[axis] = cm->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
+        if (cm->gmx.g92_offset_enable == true)
+        {
+            cm->combined_offset[axis] += cm->gmx.g92_offset[axis];
+        }
     }
-    return (offset);
+    cm_set_display_offsets(MODEL);
 }
 
 float cm_get_display_offset(const GCodeState_t *gcode_state, const uint8_t axis)
@@ -491,12 +522,7 @@ void cm_set_display_offsets(GCodeState_t *gcode_state)
         // 所有其他情况：位置应显示当前有效的偏移量
         else
         {
-            gcode_state->display_offset[axis] = cm->coord_offset[cm->gm.coord_system][axis] +
-                                                cm->tool_offset[axis];
-            if (cm->gmx.g92_offset_enable == true)
-            {
-                gcode_state->display_offset[axis] += cm->gmx.g92_offset[axis];
-            }
+            gcode_state->display_offset[axis] = cm->combined_offset[axis];
         }
     }
 }
@@ -517,9 +543,9 @@ float cm_get_display_position(const GCodeState_t *gcode_state, const uint8_t axi
     }
     else
     {
-        position = mp_get_runtime_display_position(axis);
+        position = mp_get_runtime_snapshot()->display[axis];
     }
-    if (axis <= AXIS_W)
+    if (axis <= AXIS_LINEAR_MAX)
     { // linears
         if (gcode_state->units_mode == INCHES)
         {
@@ -533,6 +559,8 @@ float cm_get_display_position(const GCodeState_t *gcode_state, const uint8_t axi
  * cm_get_absolute_position() - get position of axis in absolute coordinates from the active Gcode dynamic model
  *
  *      ... machine position is always returned in mm mode. No units conversion is performed
+ *
+ *  Runtime positions come from the runtime snapshot (see mp_get_runtime_snapshot())
  */
 
 float cm_get_absolute_position(const GCodeState_t *gcode_state, const uint8_t axis)
@@ -541,7 +569,7 @@ float cm_get_absolute_position(const GCodeState_t *gcode_state, const uint8_t ax
     {
         return (cm->gmx.position[axis]);
     }
-    return (mp_get_runtime_absolute_position(mr, axis));
+    return (mp_get_runtime_snapshot()->position[axis]);
 }
 
 /****************************************************************************************
@@ -569,13 +597,19 @@ void cm_update_model_position()
 /****************************************************************************************
  * cm_deferred_write_callback() - write any changed G10 values back to persistence
  *
- *  Only runs if there is G10 data to write, there is no movement, and the serial queues 
- *  are quiescent.
+ *  Only runs if there is no movement. G10 data is handed to persistence when there is
+ *  some to write, then any changed values are appended to NVM a batch at a time.
+ *  Job checkpoints are taken and written first, during cycles as well.
  */
 
 stat_t cm_deferred_write_callback()
 {
-    if ((cm->cycle_type == CYCLE_NONE) && (cm->deferred_write_flag == true))
+    _checkpoint_callback();
+    if (cm->cycle_type != CYCLE_NONE)
+    {
+        return (STAT_OK);
+    }
+    if (cm->deferred_write_flag == true)
     {
         cm->deferred_write_flag = false;
         nvObj_t nv;
@@ -583,14 +617,14 @@ stat_t cm_deferred_write_callback()
         {
             for (uint8_t j = 0; j < AXES; j++)
             {
-                sprintf((char *)nv.token, "g%2d%c", 53 + i, ("xyzuvwabc")[j]);
+                sprintf((char *)nv.token, "g%2d%c", 53 + i, AXIS_CHARS[j]);
                 nv.index = nv_get_index((const char *)"", nv.token);
                 nv.value_flt = cm->coord_offset[i][j];
                 nv_persist(&nv); // Note: nv_persist() only writes values that have changed
             }
         }
     }
-    return (STAT_OK);
+    return (persistence_flush());
 }
 
 /****************************************************************************************
@@ -600,23 +634,27 @@ stat_t cm_deferred_write_callback()
  * For set_tram there MUST be three valid probes stored.
  */
 
-stat_t cm_get_tram(nvObj_t *nv)
+static bool _rotation_is_identity(cmMachine_t *_cm)
 {
-    nv->value_int = true; // believe it or not, the compiler likes this form best - most efficient code
-
-    if (fp_NOT_ZERO(cm->rotation_z_offset) ||
-        fp_NOT_ZERO(cm->rotation_matrix[0][1]) ||
-        fp_NOT_ZERO(cm->rotation_matrix[0][2]) ||
-        fp_NOT_ZERO(cm->rotation_matrix[1][0]) ||
-        fp_NOT_ZERO(cm->rotation_matrix[1][2]) ||
-        fp_NOT_ZERO(cm->rotation_matrix[2][0]) ||
-        fp_NOT_ZERO(cm->rotation_matrix[2][1]) ||
-        fp_NE(1.0, cm->rotation_matrix[0][0]) ||
-        fp_NE(1.0, cm->rotation_matrix[1][1]) ||
-        fp_NE(1.0, cm->rotation_matrix[2][2]))
+    if (fp_NOT_ZERO(_cm->rotation_z_offset) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[0][1]) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[0][2]) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[1][0]) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[1][2]) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[2][0]) ||
+        fp_NOT_ZERO(_cm->rotation_matrix[2][1]) ||
+        fp_NE(1.0, _cm->rotation_matrix[0][0]) ||
+        fp_NE(1.0, _cm->rotation_matrix[1][1]) ||
+        fp_NE(1.0, _cm->rotation_matrix[2][2]))
     {
-        nv->value_int = false;
+        return (false);
     }
+    return (true);
+}
+
+stat_t cm_get_tram(nvObj_t *nv)
+{
+    nv->value_int = cm->rotation_identity;
     nv->valuetype = TYPE_BOOLEAN;
     return (STAT_OK);
 }
@@ -708,6 +746,9 @@ stat_t cm_set_tram(nvObj_t *nv)
                              n_y * cm->probe_results[1][1]) /
                                 n_z +
                             cm->probe_results[1][2];
+
+    // A level bed can come out as identity. Moves then skip the transform (see mp_aline())
+    cm->rotation_identity = _rotation_is_identity(cm);
     return (STAT_OK);
 }
 
@@ -733,6 +774,111 @@ stat_t cm_get_nxln(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * _checkpoint_callback() - take and write job checkpoints
+ * cm_get_ckpt()          - return the checkpointed line number, -1 if there is no checkpoint
+ * cm_set_ckpt()          - 1 restores the checkpointed state, 0 discards the checkpoint
+ *
+ *  While the runtime works through a job its line number, machine position, modal state
+ *  and offsets are checkpointed to NVM every NVM_CHECKPOINT_MS, and only when the line
+ *  has moved on. A checkpoint is programmed a chunk per controller pass (see persistence.h)
+ *  so the loop never waits on flash. Position and line come from one runtime snapshot.
+ *  G92 and tool offsets are taken from the model, which may be a few lines ahead.
+ *
+ *  After a power loss {ckpt:n} tells the host where the job stopped. {ckpt:1} puts the
+ *  machine back in that state - units, distance mode, plane, coordinate system, offsets,
+ *  tool, feed rate and position - and sets the line number, so the host can restart
+ *  the job by sending the lines from the checkpointed one on. The machine must be idle.
+ *  Homing state is not restored; the position is taken on trust, as with G28.3.
+ *  A program end discards the checkpoint.
+ */
+
+static void _checkpoint_callback()
+{
+    static uint32_t checkpoint_time = 0;
+    static uint32_t checkpoint_line = 0;
+
+    if (persistence_checkpoint_busy())
+    {
+        persistence_checkpoint_step();
+        return;
+    }
+    if (cm->machine_state == MACHINE_PROGRAM_END)
+    {
+        checkpoint_line = 0;
+        persistence_checkpoint_clear();             // does nothing if already clear
+        return;
+    }
+    if ((cm->cycle_type != CYCLE_MACHINING) ||
+        (SysTickTimer_getValue() - checkpoint_time < NVM_CHECKPOINT_MS))
+    {
+        return;
+    }
+    const mpRuntimeSnapshot_t *s = mp_get_runtime_snapshot();
+    if ((s->linenum == 0) || (s->linenum == checkpoint_line))
+    {
+        return;
+    }
+    checkpoint_time = SysTickTimer_getValue();
+    checkpoint_line = s->linenum;
+
+    nvmCheckpointState_t c;
+    c.linenum = s->linenum;
+    copy_vector(c.position, s->position);
+    copy_vector(c.g92_offset, cm->gmx.g92_offset);
+    copy_vector(c.tool_offset, cm->tool_offset);
+    c.feed_rate = mr->gm.feed_rate;
+    c.coord_system = mr->gm.coord_system;
+    c.units_mode = mr->gm.units_mode;
+    c.distance_mode = mr->gm.distance_mode;
+    c.select_plane = mr->gm.select_plane;
+    c.tool = mr->gm.tool;
+    c.g92_offset_enable = cm->gmx.g92_offset_enable;
+    persistence_checkpoint_write(&c);
+}
+
+stat_t cm_get_ckpt(nvObj_t *nv)
+{
+    const nvmCheckpointState_t *c = persistence_checkpoint();
+    nv->value_int = (c == NULL) ? -1 : (int32_t)c->linenum;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t cm_set_ckpt(nvObj_t *nv)
+{
+    if (!nv->value_int)
+    {
+        persistence_checkpoint_clear();
+        return (STAT_OK);
+    }
+    const nvmCheckpointState_t *c = persistence_checkpoint();
+    if (c == NULL)
+    {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if ((cm->cycle_type != CYCLE_NONE) || cm_get_runtime_busy())
+    {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    cm_set_units_mode(c->units_mode);
+    cm_set_distance_mode(c->distance_mode);
+    cm_select_plane(c->select_plane);
+    cm_set_tool_number(MODEL, c->tool);
+    cm->gm.tool_select = c->tool;
+    cm->gm.feed_rate = c->feed_rate;
+    copy_vector(cm->tool_offset, c->tool_offset);
+    copy_vector(cm->gmx.g92_offset, c->g92_offset);
+    cm->gmx.g92_offset_enable = c->g92_offset_enable;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++)
+    {
+        cm_set_position_by_axis(axis, c->position[axis]);
+    }
+    cm_set_coord_system(c->coord_system);           // applies all the offsets, in the runtime too
+    cm_set_model_linenum(c->linenum);
+    return (STAT_OK);
+}
+
 /****************************************************************************************
  * cm_set_model_target() - set target vector in GM model
  *
@@ -759,12 +905,12 @@ stat_t cm_get_nxln(nvObj_t *nv)
 
 static float _calc_ABC(const uint8_t axis, const float target[])
 {
-    if ((cm->a[axis].axis_mode == AXIS_STANDARD) || (cm->a[axis].axis_mode == AXIS_INHIBITED))
+    if (cm->a[axis].degrees_per_mm == 0)
     {
         return (target[axis]); // no mm conversion - it's in degrees
     }
     // radius mode
-    return (_to_millimeters(target[axis]) * 360.0 / (2 * M_PI * cm->a[axis].radius));
+    return (_to_millimeters(target[axis]) * cm->a[axis].degrees_per_mm);
 }
 
 void cm_set_model_target(const float target[], const bool flags[])
@@ -776,7 +922,7 @@ void cm_set_model_target(const float target[], const bool flags[])
     //copy_vector(cm->gm.target, cm->gmx.position);
     memcpy(cm->gm.target, cm->gmx.position, sizeof(cm->gm.target));
     // process linear axes (XYZUVW) first
-    for (axis = AXIS_X; axis <= AXIS_W; axis++)
+    for (axis = AXIS_X; axis <= AXIS_LINEAR_MAX; axis++)
     {
         if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED)
         {
@@ -796,7 +942,7 @@ void cm_set_model_target(const float target[], const bool flags[])
         }
     }
     // 仅供参考：下面的ABC循环依赖于首先运行的XYZUVW循环
-    for (axis = AXIS_A; axis <= AXIS_C; axis++)
+    for (axis = AXIS_A; axis <= AXIS_ROTARY_MAX; axis++)
     {
         if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED)
         {
@@ -843,7 +989,9 @@ void cm_set_model_target(const float target[], const bool flags[])
 /****************************************************************************************
  * cm_get_soft_limits()
  * cm_set_soft_limits()
- * cm_test_soft_limits() - return error code if soft limit is exceeded
+ * cm_update_soft_limits() - rebuild the active soft limit set
+ * cm_check_soft_limits()  - return error code if a min/max box exceeds soft limits
+ * cm_test_soft_limits()   - return error code if soft limit is exceeded
  *
  *  The target[] arg must be in absolute machine coordinates. Best done after cm_set_model_target().
  *
@@ -851,6 +999,10 @@ void cm_set_model_target(const float target[], const bool flags[])
  *  and max to the same value (e.g. 0,0) to disable soft limits for an axis. Also will not test
  *  a min or a max if the value is more than +/- 1000000 (plus or minus 1 million ).
  *  This allows a single end to be tested w/the other disabled, should that requirement ever arise.
+ *
+ *  The axes that pass these tests are compiled into cm->soft_limit[] by cm_update_soft_limits(),
+ *  which must be called whenever homed[] or an axis travel_min / travel_max changes. The per-move
+ *  tests then only visit those axes.
  */
 
 bool cm_get_soft_limits() { return (cm->soft_limit_enable); }
@@ -863,42 +1015,66 @@ static stat_t _finalize_soft_limits(const stat_t status)
     return (cm_alarm(status, "soft_limits"));            // throw an alarm
 }
 
-stat_t cm_test_soft_limits(const float target[])
+void cm_update_soft_limits()
 {
-    if (cm->soft_limit_enable == true)
+    uint8_t count = 0;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++)
     {
-        for (uint8_t axis = AXIS_X; axis < AXES; axis++)
+        if (cm->homed[axis] != true)
         {
-            if (cm->homed[axis] != true)
-            {
-                continue;
-            } // skip axis if not homed
-            if (fp_EQ(cm->a[axis].travel_min, cm->a[axis].travel_max))
-            {
-                continue;
-            } // skip axis if identical
-            if (fabs(cm->a[axis].travel_min) > DISABLE_SOFT_LIMIT)
-            {
-                continue;
-            } // skip min test if disabled
-            if (fabs(cm->a[axis].travel_max) > DISABLE_SOFT_LIMIT)
-            {
-                continue;
-            } // skip max test if disabled
+            continue;
+        } // skip axis if not homed
+        if (fp_EQ(cm->a[axis].travel_min, cm->a[axis].travel_max))
+        {
+            continue;
+        } // skip axis if identical
+        if (fabs(cm->a[axis].travel_min) > DISABLE_SOFT_LIMIT)
+        {
+            continue;
+        } // skip min test if disabled
+        if (fabs(cm->a[axis].travel_max) > DISABLE_SOFT_LIMIT)
+        {
+            continue;
+        } // skip max test if disabled
 
-            if (target[axis] < cm->a[axis].travel_min)
+        cm->soft_limit[count].axis = axis;
+        cm->soft_limit[count].min = cm->a[axis].travel_min;
+        cm->soft_limit[count].max = cm->a[axis].travel_max;
+        count++;
+    }
+    cm->soft_limit_count = count;
+}
+
+stat_t cm_check_soft_limits(const float min[], const float max[])
+{
+    if (cm->soft_limit_enable == true)
+    {
+        for (uint8_t i = 0; i < cm->soft_limit_count; i++)
+        {
+            const cmSoftLimit_t *limit = &cm->soft_limit[i];
+            if (min[limit->axis] < limit->min)
             {
-                return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2 * axis));
+                return (STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2 * limit->axis);
             }
-            if (target[axis] > cm->a[axis].travel_max)
+            if (max[limit->axis] > limit->max)
             {
-                return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2 * axis));
+                return (STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2 * limit->axis);
             }
         }
     }
     return (STAT_OK);
 }
 
+stat_t cm_test_soft_limits(const float target[])
+{
+    stat_t status = cm_check_soft_limits(target, target);
+    if (status != STAT_OK)
+    {
+        return (_finalize_soft_limits(status));
+    }
+    return (STAT_OK);
+}
+
 /****************************************************************************************
  **** CANONICAL MACHINING FUNCTIONS *****************************************************
  ****************************************************************************************
@@ -1018,7 +1194,15 @@ stat_t cm_set_g10_data(const uint8_t P_word, const bool P_flag,
     {
         return (STAT_L_WORD_IS_INVALID);
     }
-    cm_set_display_offsets(MODEL);
+    cm_update_combined_offsets();
+
+    // Changing the active system's offsets updates the runtime here, so a G54-G59 that
+    // names the system already in effect is not needed to apply it (and is skipped).
+    if (((L_word == 2) || (L_word == 20)) && (P_word == cm->gm.coord_system))
+    {
+        float value[AXES] = {(float)cm->gm.coord_system}; // mp_queue_command() copies AXES values
+        mp_queue_command(_exec_offset, value, FLAGS_ONE);
+    }
     return (STAT_OK);
 }
 
@@ -1079,7 +1263,7 @@ stat_t cm_set_tl_offset(const uint8_t H_word, const bool H_flag, const bool appl
             cm->tool_offset[axis] = tt.tt_offset[tool][axis];
         }
     }
-    cm_set_display_offsets(MODEL); // display new offsets in the model right now
+    cm_update_combined_offsets(); // display new offsets in the model right now
 
     float value[] = {(float)cm->gm.coord_system};   // pass coordinate system in value[0] element
     mp_queue_command(_exec_offset, value, nullptr_bool); // second vector (flags) is not used, so fake it
@@ -1092,7 +1276,7 @@ stat_t cm_cancel_tl_offset()
     {
         cm->tool_offset[axis] = 0;
     }
-    cm_set_display_offsets(MODEL); // display new offsets in the model right now
+    cm_update_combined_offsets(); // display new offsets in the model right now
 
     float value[] = {(float)cm->gm.coord_system};
     mp_queue_command(_exec_offset, value, FLAGS_ONE); // changes it in the runtime when executed
@@ -1102,7 +1286,7 @@ stat_t cm_cancel_tl_offset()
 stat_t cm_set_coord_system(const uint8_t coord_system) // 设置与planner同步的坐标系
 {
     cm->gm.coord_system = (cmCoordSystem)coord_system;
-    cm_set_display_offsets(MODEL); // 如果更改坐标系，则必须重置显示偏移
+    cm_update_combined_offsets(); // 如果更改坐标系，则必须重置显示偏移
 
     float value[] = {(float)coord_system};
     mp_queue_command(_exec_offset, value, FLAGS_ONE); //xzw168
@@ -1172,6 +1356,7 @@ static void _exec_absolute_origin(float *value, bool *flag)
             cm->homed[axis] = true; // G28.3 is not considered homed until you get here
         }
     }
+    cm_update_soft_limits();
     mp_set_steps_to_runtime_position();
 }
 
@@ -1221,7 +1406,7 @@ stat_t cm_set_g92_offsets(const float offset[], const bool flag[])
     // now pass the offset to the callback - setting the coordinate system also applies the offsets
     float value[] = {(float)cm->gm.coord_system}; // pass coordinate system in value[0] element
     mp_queue_command(_exec_offset, value, nullptr_bool);
-    cm_set_display_offsets(MODEL);
+    cm_update_combined_offsets();
     return (STAT_OK);
 }
 
@@ -1234,7 +1419,7 @@ stat_t cm_reset_g92_offsets()
     }
     float value[] = {(float)cm->gm.coord_system};
     mp_queue_command(_exec_offset, value, nullptr_bool);
-    cm_set_display_offsets(MODEL);
+    cm_update_combined_offsets();
     return (STAT_OK);
 }
 
@@ -1243,7 +1428,7 @@ stat_t cm_suspend_g92_offsets()
     cm->gmx.g92_offset_enable = false;
     float value[] = {(float)cm->gm.coord_system};
     mp_queue_command(_exec_offset, value, nullptr_bool);
-    cm_set_display_offsets(MODEL);
+    cm_update_combined_offsets();
     return (STAT_OK);
 }
 
@@ -1252,7 +1437,7 @@ stat_t cm_resume_g92_offsets()
     cm->gmx.g92_offset_enable = true;
     float value[] = {(float)cm->gm.coord_system};
     mp_queue_command(_exec_offset, value, nullptr_bool);
-    cm_set_display_offsets(MODEL);
+    cm_update_combined_offsets();
     return (STAT_OK);
 }
 
@@ -1261,6 +1446,11 @@ stat_t cm_resume_g92_offsets()
  ****************************************************************************************/
 /*
  * cm_straight_traverse() - G0线性快速
+ *
+ *  With {tru:1} the traverse runs each axis at its own velocity limit ("dogleg" rapids)
+ *  instead of holding them all to the slowest, see _uncoordinated_traverse(). Either way
+ *  the path stays inside the box spanned by the start and the target, so testing the
+ *  target covers the box soft limits.
  */
 
 stat_t cm_straight_traverse(const float *target, const bool *flags, const uint8_t motion_profile)
@@ -1268,9 +1458,7 @@ stat_t cm_straight_traverse(const float *target, const bool *flags, const uint8_
     cm->gm.motion_mode = MOTION_MODE_STRAIGHT_TRAVERSE; //运动模式直线
 
     // G0没有轴字是合法的，但我们不想处理它
-    if (!(flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z] |
-          flags[AXIS_U] | flags[AXIS_V] | flags[AXIS_W] |
-          flags[AXIS_A] | flags[AXIS_B] | flags[AXIS_C]))
+    if (!_any_axis_flagged(flags))
     {
         return (STAT_OK);
     }
@@ -1278,7 +1466,8 @@ stat_t cm_straight_traverse(const float *target, const bool *flags, const uint8_
     ritorno(cm_test_soft_limits(cm->gm.target)); // 测试软限制; 如果被抛出则退出
     cm_set_display_offsets(&cm->gm);             // 捕获完全解决的状态偏移  从模型中捕获组合偏移到有效Gcode动态模型中的绝对值
     cm_cycle_start();                            // 这里需要归位与其他周期
-    stat_t status = mp_aline(&cm->gm);           // 将移动发送给计划者 计划加速/减速的线
+    stat_t status = cm->traverse_uncoordinated ? _uncoordinated_traverse() // per-axis rapid, as a chain of lines
+                                               : mp_aline(&cm->gm);       // 将移动发送给计划者 计划加速/减速的线
 	copy_vector(cm->gmx.position, cm->gm.target); //cm_update_model_position();                  // 更新gmx.position以准备下一次进入的移动 
 	
     if (status == STAT_MINIMUM_LENGTH_MOVE)
@@ -1292,6 +1481,80 @@ stat_t cm_straight_traverse(const float *target, const bool *flags, const uint8_
     return (status);
 }
 
+/*
+ * _uncoordinated_traverse() - queue a G0 as lines that run every axis at its own velocity limit
+ *
+ *  Each axis alone would take |travel| / velocity_max. Sorted by those times, the move
+ *  is split where each axis arrives: up to there every axis still travelling moves at
+ *  its own limit, so the planner gives that line the limit of all of them at once. The
+ *  last line ends on the target. The lines blend at the planner's junction velocities
+ *  and accelerate at the jerk their direction allows, so each leg runs as fast as its
+ *  axes can take it rather than at the pace of the slowest axis.
+ *
+ *  Falls back to one coordinated line when the machine is rotated (the times are taken
+ *  in unrotated axes) or an axis has no velocity limit, and stops splitting when the
+ *  planner has less than a free buffer per line - the rest then goes in one line.
+ */
+
+static stat_t _uncoordinated_traverse()
+{
+    float start[AXES];
+    float target[AXES];
+    float time[AXES];
+    copy_vector(start, cm->gmx.position);
+    copy_vector(target, cm->gm.target);
+
+    uint8_t lines = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        time[axis] = 0;
+        if (fp_EQ(start[axis], target[axis])) {
+            continue;
+        }
+        if (cm->a[axis].velocity_max <= 0) {
+            return (mp_aline(&cm->gm));
+        }
+        time[axis] = fabs(target[axis] - start[axis]) / cm->a[axis].velocity_max;
+        lines++;
+    }
+    uint16_t room = mp_get_planner_buffers(mp);
+    if (!cm->rotation_identity || (lines < 2) || (room < 2)) {
+        return (mp_aline(&cm->gm));
+    }
+    lines = min(lines, (uint8_t)(room - 1));    // leave a buffer for the command after it
+
+    stat_t status = STAT_MINIMUM_LENGTH_MOVE;
+    float elapsed = 0;                          // time at the end of the last line
+    for (uint8_t line = 1; line <= lines; line++) {
+        float next = 0;                         // the next axis to arrive
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            if ((time[axis] > elapsed * (1 + EPSILON)) && ((next == 0) || (time[axis] < next))) {
+                next = time[axis];
+            }
+        }
+        if (next == 0) {
+            break;                              // every axis has arrived
+        }
+        if (line == lines) {
+            copy_vector(cm->gm.target, target);
+        } else {
+            for (uint8_t axis = 0; axis < AXES; axis++) {
+                cm->gm.target[axis] = (time[axis] <= next) ? target[axis]
+                    : start[axis] + (target[axis] - start[axis]) * (next / time[axis]);
+            }
+        }
+        stat_t line_status = mp_aline(&cm->gm);
+        if (line_status == STAT_OK) {
+            status = STAT_OK;
+        } else if (line_status != STAT_MINIMUM_LENGTH_MOVE) {
+            copy_vector(cm->gm.target, target);
+            return (line_status);
+        }
+        elapsed = next;
+    }
+    copy_vector(cm->gm.target, target);
+    return (status);
+}
+
 /****************************************************************************************
  * cm_goto_g28_position()  - G28
  * cm_set_g28_position()   - G28.1
@@ -1315,7 +1578,7 @@ stat_t _goto_stored_position(const float stored_position[],     // always in mm
 
     if (cm->gm.units_mode == INCHES)
     {
-        for (uint8_t i = 0; i < AXIS_A; i++)
+        for (uint8_t i = 0; i <= AXIS_LINEAR_MAX; i++)
         { // Only convert linears (not rotaries)
             target[i] *= INCHES_PER_MM;
         }
@@ -1400,11 +1663,19 @@ stat_t cm_set_feed_rate_mode(const uint8_t mode)
 
 /****************************************************************************************
  * cm_set_path_control() - G61, G61.1, G64
+ *
+ *  G64 P<tolerance> lets the planner round each corner between feed moves with an arc
+ *  that stays within tolerance of the corner (see mp_aline()). G64 without P, and the
+ *  other modes, clear the tolerance.
  */
 
-stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode)
+stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode, const float P_word, const bool P_flag)
 {
+    if (P_flag && (P_word < 0)) {
+        return (STAT_P_WORD_IS_NEGATIVE);
+    }
     gcode_state->path_control = (cmPathControl)mode;
+    gcode_state->path_tolerance = ((mode == PATH_CONTINUOUS) && P_flag) ? _to_millimeters(P_word) : 0;
     return (STAT_OK);
 }
 
@@ -1439,9 +1710,7 @@ stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t mo
     cm->gm.motion_mode = MOTION_MODE_STRAIGHT_FEED;
 
     // it's legal for a G0 to have no axis words but we don't want to process it
-    if (!(flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z] |
-          flags[AXIS_U] | flags[AXIS_V] | flags[AXIS_W] |
-          flags[AXIS_A] | flags[AXIS_B] | flags[AXIS_C]))
+    if (!_any_axis_flagged(flags))
     {
         return (STAT_OK);
     }
@@ -1476,7 +1745,7 @@ stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t mo
  * cm_select_tool()     - T parameter
  * _exec_select_tool()  - execution callback
  *
- * cm_change_tool()     - M6 (This might become a complete tool change cycle)
+ * cm_change_tool()     - M6 - also runs the stored tool change macro, if any
  * _exec_change_tool()  - execution callback
  *
  * Note: These functions don't actually do anything for now, and there's a bug
@@ -1493,8 +1762,8 @@ stat_t cm_select_tool(const uint8_t tool_select)
     {
         return (STAT_T_WORD_IS_INVALID);
     }
-    float value[] = {(float)tool_select};
-    mp_queue_command(_exec_select_tool, value, nullptr_bool);
+    float value[MP_ACTION_VALUES] = {(float)tool_select};
+    mp_queue_inline_action(_exec_select_tool, value, nullptr_bool); // selecting a tool doesn't stop motion
     return (STAT_OK);
 }
 
@@ -1508,7 +1777,7 @@ stat_t cm_change_tool(const uint8_t tool_change)
 {
     float value[] = {(float)cm->gm.tool_select};
     mp_queue_command(_exec_change_tool, value, nullptr_bool);
-    return (STAT_OK);
+    return (mc_run_macro(MACRO_TOOL_CHANGE_ID));   // its lines queue right behind the M6
 }
 
 /****************************************************************************************
@@ -1875,6 +2144,7 @@ stat_t cm_run_home(nvObj_t *nv)
  *
  * cm_get_jogging_dest()
  * cm_run_jog()
+ * cm_run_jgv()
  */
 
 float cm_get_jogging_dest(void)
@@ -1889,6 +2159,13 @@ stat_t cm_run_jog(nvObj_t *nv)
     return (STAT_OK);
 }
 
+stat_t cm_run_jgv(nvObj_t *nv)
+{
+    float velocity = 0;
+    set_float(nv, velocity);
+    return (cm_jogging_velocity(_axis(nv), velocity));
+}
+
 /**************************************
  * END OF CANONICAL MACHINE FUNCTIONS *
  **************************************/
@@ -1948,7 +2225,7 @@ static int8_t _axis(const nvObj_t *nv)
 
     // otherwise it's an axis. Or undefined, which is usually a global.
     char *ptr;
-    char axes[] = {"xyzuvwabc"};
+    char axes[] = {AXIS_CHARS};
 
     if ((ptr = strchr(axes, c)) == NULL)
     {                                                                             // not NULL indicates a prefixed axis
@@ -1977,10 +2254,9 @@ cmAxisType cm_get_axis_type(const nvObj_t *nv)
 
 char cm_get_axis_char(const int8_t axis) // Uses internal axis numbering
 {
-    char axis_char[] = "XYZUVWABC";
     if ((axis < 0) || (axis > AXES))
         return (' ');
-    return (axis_char[axis]);
+    return (toupper(AXIS_CHARS[axis]));
 }
 
 /**** Functions called directly from cfgArray table - mostly wrappers ****
@@ -2199,7 +2475,14 @@ stat_t cm_get_frmo(nvObj_t *nv) { return (_get_msg_helper(nv, msg_frmo, cm_get_f
 
 stat_t cm_get_toolv(nvObj_t *nv) { return (get_integer(nv, cm_get_tool(ACTIVE_MODEL))); }
 stat_t cm_get_mline(nvObj_t *nv) { return (get_integer(nv, cm_get_linenum(MODEL))); }
-stat_t cm_get_line(nvObj_t *nv) { return (get_integer(nv, cm_get_linenum(ACTIVE_MODEL))); }
+stat_t cm_get_line(nvObj_t *nv)
+{
+    if (ACTIVE_MODEL == MODEL)
+    {
+        return (get_integer(nv, cm_get_linenum(MODEL)));
+    }
+    return (get_integer(nv, mp_get_runtime_snapshot()->linenum));
+}
 
 stat_t cm_get_vel(nvObj_t *nv)
 {
@@ -2209,7 +2492,7 @@ stat_t cm_get_vel(nvObj_t *nv)
     }
     else
     {
-        nv->value_flt = mp_get_runtime_velocity();
+        nv->value_flt = mp_get_runtime_snapshot()->velocity;
         if (cm_get_units_mode(RUNTIME) == INCHES)
         {
             nv->value_flt *= INCHES_PER_MM;
@@ -2233,7 +2516,24 @@ stat_t cm_get_prob(nvObj_t *nv) { return (_get_msg_helper(nv, msg_probe, cm_get_
 stat_t cm_get_prb(nvObj_t *nv) { return (get_float(nv, cm->probe_results[0][_axis(nv)])); }
 
 stat_t cm_get_coord(nvObj_t *nv) { return (get_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
-stat_t cm_set_coord(nvObj_t *nv) { return (set_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
+// Editing the active system queues the runtime offset update, as G10 L2 does - a G54-G59
+// naming the system in effect is skipped, so it would never be applied otherwise.
+stat_t cm_set_coord(nvObj_t *nv)
+{
+    bool active = (_coord(nv) == cm->gm.coord_system) && (cm->machine_state != MACHINE_INITIALIZING);
+    if (active && mp_planner_is_full(mp))
+    {
+        return (STAT_COMMAND_NOT_ACCEPTED); // no room to queue the update - the host can retry
+    }
+    stat_t status = set_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)]);
+    cm_update_combined_offsets();
+    if (active && (status == STAT_OK))
+    {
+        float value[AXES] = {(float)cm->gm.coord_system}; // mp_queue_command() copies AXES values
+        mp_queue_command(_exec_offset, value, FLAGS_ONE);
+    }
+    return (status);
+}
 
 stat_t cm_get_g92e(nvObj_t *nv) { return (get_integer(nv, cm->gmx.g92_offset_enable)); }
 stat_t cm_get_g92(nvObj_t *nv) { return (get_float(nv, cm->gmx.g92_offset[_axis(nv)])); }
@@ -2254,7 +2554,12 @@ static uint8_t _tool(nvObj_t *nv)
 }
 
 stat_t cm_get_tof(nvObj_t *nv) { return (get_float(nv, cm->tool_offset[_axis(nv)])); }
-stat_t cm_set_tof(nvObj_t *nv) { return (set_float(nv, cm->tool_offset[_axis(nv)])); }
+stat_t cm_set_tof(nvObj_t *nv)
+{
+    stat_t status = set_float(nv, cm->tool_offset[_axis(nv)]);
+    cm_update_combined_offsets();
+    return (status);
+}
 
 stat_t cm_get_tt(nvObj_t *nv)
 {
@@ -2315,15 +2620,49 @@ stat_t cm_set_am(nvObj_t *nv) // axis mode
     }
     nv->valuetype = TYPE_INTEGER;
     cm->a[_axis(nv)].axis_mode = (cmAxisMode)nv->value_int;
+    _cm_recalc_rotary_scale(_axis(nv));
+    kn_config_changed();
     return (STAT_OK);
 }
 
 stat_t cm_get_tn(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_min)); }
-stat_t cm_set_tn(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_min)); }
+stat_t cm_set_tn(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->a[_axis(nv)].travel_min));
+    cm_update_soft_limits();
+    return (STAT_OK);
+}
 stat_t cm_get_tm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_max)); }
-stat_t cm_set_tm(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_max)); }
+stat_t cm_set_tm(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->a[_axis(nv)].travel_max));
+    cm_update_soft_limits();
+    return (STAT_OK);
+}
 stat_t cm_get_ra(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].radius)); }
-stat_t cm_set_ra(nvObj_t *nv) { return (set_float_range(nv, cm->a[_axis(nv)].radius, RADIUS_MIN, 1000000)); }
+stat_t cm_set_ra(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, cm->a[_axis(nv)].radius, RADIUS_MIN, 1000000));
+    _cm_recalc_rotary_scale(_axis(nv));
+    return (STAT_OK);
+}
+
+/*
+ * _cm_recalc_rotary_scale() - keep the radius mode conversion used by cm_set_model_target()
+ *
+ *  Only ABC axes in RADIUS mode convert linear Gcode values to degrees. The factor is set
+ *  here when the mode or radius changes so a block costs one multiply per rotary axis.
+ */
+
+static void _cm_recalc_rotary_scale(const uint8_t axis)
+{
+    cfgAxis_t *a = &cm->a[axis];
+    a->degrees_per_mm = 0;
+    if ((axis >= AXIS_A) && (a->axis_mode == AXIS_RADIUS) && (a->radius > 0))
+    {
+        a->degrees_per_mm = 360 / (2 * M_PI * a->radius);
+    }
+}
 
 /**** Axis Jerk Primitives
  * cm_get_axis_jerk() - returns max jerk for an axis
@@ -2348,12 +2687,14 @@ void _cm_recalc_junction_accel(const uint8_t axis)
 void cm_set_axis_max_jerk(const uint8_t axis, const float jerk)
 {
     cm->a[axis].jerk_max = jerk;
+    cm->a[axis].recip_jerk_max = 1 / jerk;
     _cm_recalc_junction_accel(axis); // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
 void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
 {
     cm->a[axis].jerk_high = jerk;
+    cm->a[axis].recip_jerk_high = 1 / jerk;
     _cm_recalc_junction_accel(axis); // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
@@ -2367,6 +2708,8 @@ void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
  * cm_set_jm() - set jerk max value     - called from dispatch table
  * cm_get_jh() - get jerk homing value  - called from dispatch table
  * cm_set_jh() - set jerk homing value  - called from dispatch table
+ * cm_get_ac() - get acceleration max   - called from dispatch table
+ * cm_set_ac() - set acceleration max   - called from dispatch table
  *
  *  Jerk values can be rather large, often in the billions. This makes for some pretty big
  *  numbers for people to deal with. Jerk values are stored in the system in truncated format;
@@ -2413,6 +2756,15 @@ stat_t cm_set_jh(nvObj_t *nv)
     return (STAT_OK);
 }
 
+stat_t cm_get_ac(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].accel_max)); }
+stat_t cm_set_ac(nvObj_t *nv)
+{
+    uint8_t axis = _axis(nv);
+    ritorno(set_float_range(nv, cm->a[axis].accel_max, 0, MAX_LONG));
+    cm->a[axis].recip_accel_max = (nv->value_flt > 0) ? 1 / (nv->value_flt * 3600) : 0;   // s^2 to min^2
+    return (STAT_OK);
+}
+
 /**** Axis Homing Settings
  * cm_get_hi() - get homing input
  * cm_set_hi() - set homing input
@@ -2429,7 +2781,13 @@ stat_t cm_set_jh(nvObj_t *nv)
  */
 
 stat_t cm_get_hi(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_input)); }
-stat_t cm_set_hi(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_input, 0, D_IN_CHANNELS)); }
+stat_t cm_set_hi(nvObj_t *nv)
+{
+    if (nv->value_int == HOMING_INPUT_STALL) {
+        return (set_integer(nv, cm->a[_axis(nv)].homing_input, HOMING_INPUT_STALL, HOMING_INPUT_STALL));
+    }
+    return (set_integer(nv, cm->a[_axis(nv)].homing_input, 0, D_IN_CHANNELS));
+}
 stat_t cm_get_hd(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_dir)); }
 stat_t cm_set_hd(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_dir, 0, 1)); }
 stat_t cm_get_sv(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].search_velocity)); }
@@ -2474,6 +2832,9 @@ stat_t cm_set_ct(nvObj_t *nv) { return (set_float_range(nv, cm->chordal_toleranc
 stat_t cm_get_zl(nvObj_t *nv) { return (get_float(nv, cm->feedhold_z_lift)); }
 stat_t cm_set_zl(nvObj_t *nv) { return (set_float(nv, cm->feedhold_z_lift)); }
 
+stat_t cm_get_tru(nvObj_t *nv) { return (get_integer(nv, cm->traverse_uncoordinated)); }
+stat_t cm_set_tru(nvObj_t *nv) { return (set_integer(nv, (uint8_t &)cm->traverse_uncoordinated, 0, 1)); }
+
 stat_t cm_get_sl(nvObj_t *nv) { return (get_integer(nv, cm->soft_limit_enable)); }
 stat_t cm_set_sl(nvObj_t *nv) { return (set_integer(nv, (uint8_t &)cm->soft_limit_enable, 0, 1)); }
 
@@ -2608,6 +2969,7 @@ void cm_print_gdi(nvObj_t *nv) { text_print(nv, fmt_gdi); } // TYPE_INT
 static const char fmt_jt[] = "[jt]  junction integration time%7.2f\n";
 static const char fmt_ct[] = "[ct]  chordal tolerance%17.4f%s\n";
 static const char fmt_zl[] = "[zl]  Z lift on feedhold%16.3f%s\n";
+static const char fmt_tru[] = "[tru] traverse axes independently%2d [0=coordinated,1=per-axis]\n";
 static const char fmt_sl[] = "[sl]  soft limit enable%12d [0=disable,1=enable]\n";
 static const char fmt_lim[] = "[lim] limit switch enable%10d [0=disable,1=enable]\n";
 static const char fmt_saf[] = "[saf] safety interlock enable%6d [0=disable,1=enable]\n";
@@ -2615,6 +2977,7 @@ static const char fmt_saf[] = "[saf] safety interlock enable%6d [0=disable,1=ena
 void cm_print_jt(nvObj_t *nv) { text_print(nv, fmt_jt); } // TYPE FLOAT
 void cm_print_ct(nvObj_t *nv) { text_print_flt_units(nv, fmt_ct, GET_UNITS(ACTIVE_MODEL)); }
 void cm_print_zl(nvObj_t *nv) { text_print_flt_units(nv, fmt_zl, GET_UNITS(ACTIVE_MODEL)); }
+void cm_print_tru(nvObj_t *nv) { text_print(nv, fmt_tru); } // TYPE_INT
 void cm_print_sl(nvObj_t *nv) { text_print(nv, fmt_sl); }   // TYPE_INT
 void cm_print_lim(nvObj_t *nv) { text_print(nv, fmt_lim); } // TYPE_INT
 void cm_print_saf(nvObj_t *nv) { text_print(nv, fmt_saf); } // TYPE_INT
@@ -2626,6 +2989,7 @@ static const char fmt_troe[] = "[troe] traverse over enable%8d [0=disable,1=enab
 static const char fmt_tro[] = "[tro]  traverse override%15.3f [0.05 < mto < 1.00]\n";
 static const char fmt_tram[] = "[tram] is coordinate space rotated to be tram %s\n";
 static const char fmt_nxln[] = "[nxln] next line number %lu\n";
+static const char fmt_ckpt[] = "[ckpt] checkpointed line number %li\n";
 
 void cm_print_m48(nvObj_t *nv) { text_print(nv, fmt_m48); }    // TYPE_INT
 void cm_print_froe(nvObj_t *nv) { text_print(nv, fmt_froe); }  // TYPE INT
@@ -2634,6 +2998,7 @@ void cm_print_troe(nvObj_t *nv) { text_print(nv, fmt_troe); }  // TYPE INT
 void cm_print_tro(nvObj_t *nv) { text_print(nv, fmt_tro); }    // TYPE FLOAT
 void cm_print_tram(nvObj_t *nv) { text_print(nv, fmt_tram); }; // TYPE BOOL
 void cm_print_nxln(nvObj_t *nv) { text_print(nv, fmt_nxln); }; // TYPE INT
+void cm_print_ckpt(nvObj_t *nv) { text_print(nv, fmt_ckpt); }; // TYPE INT
 
 /*
  * axis print functions
@@ -2649,6 +3014,7 @@ void cm_print_nxln(nvObj_t *nv) { text_print(nv, fmt_nxln); }; // TYPE INT
  *    cm_print_tn()
  *    cm_print_jm()
  *    cm_print_jh()
+ *    cm_print_ac()
  *    cm_print_ra()
  *    cm_print_hi()
  *    cm_print_hd()
@@ -2668,6 +3034,7 @@ static const char fmt_Xtm[] = "[%s%s] %s travel maximum%17.3f%s\n";
 static const char fmt_Xtn[] = "[%s%s] %s travel minimum%17.3f%s\n";
 static const char fmt_Xjm[] = "[%s%s] %s jerk maximum%15.0f%s/min^3 * 1 million\n";
 static const char fmt_Xjh[] = "[%s%s] %s jerk homing%16.0f%s/min^3 * 1 million\n";
+static const char fmt_Xac[] = "[%s%s] %s acceleration maximum%7.0f%s/s^2 [0=jerk only]\n";
 static const char fmt_Xra[] = "[%s%s] %s radius value%20.4f%s\n";
 static const char fmt_Xhi[] = "[%s%s] %s homing input%15d [input 1-N or 0 to disable homing this axis]\n";
 static const char fmt_Xhd[] = "[%s%s] %s homing direction%11d [0=search-to-negative, 1=search-to-positive]\n";
@@ -2686,7 +3053,7 @@ static const char fmt_hom[] = "%c axis homing state:%2.0f\n";
 
 static void _print_axis_ui8(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_int);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_int);
     xio_writeline(cs.out_buf);
 }
 
@@ -2701,7 +3068,7 @@ static void _print_axis_flt(nvObj_t *nv, const char *format)
     {
         units = (char *)GET_TEXT_ITEM(msg_units, DEGREE_INDEX);
     }
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt, units);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt, units);
     xio_writeline(cs.out_buf);
 }
 
@@ -2716,7 +3083,7 @@ static void _print_axis_coord_flt(nvObj_t *nv, const char *format)
     {
         units = (char *)GET_TEXT_ITEM(msg_units, DEGREE_INDEX);
     }
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->token, nv->value_flt, units);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->token, nv->value_flt, units);
     xio_writeline(cs.out_buf);
 }
 
@@ -2728,7 +3095,7 @@ static void _print_pos(nvObj_t *nv, const char *format, uint8_t units)
     {
         units = DEGREES;
     }
-    sprintf(cs.out_buf, format, axes[axis], nv->value_flt, GET_TEXT_ITEM(msg_units, units));
+    text_sprintf(cs.out_buf, format, axes[axis], nv->value_flt, GET_TEXT_ITEM(msg_units, units));
     xio_writeline(cs.out_buf);
 }
 
@@ -2736,13 +3103,13 @@ static void _print_hom(nvObj_t *nv, const char *format)
 {
     char axes[] = {"XYZABC"};
     uint8_t axis = _axis(nv);
-    sprintf(cs.out_buf, format, axes[axis], nv->value_int);
+    text_sprintf(cs.out_buf, format, axes[axis], nv->value_int);
     xio_writeline(cs.out_buf);
 }
 
 void cm_print_am(nvObj_t *nv) // print axis mode with enumeration string
 {
-    sprintf(cs.out_buf, fmt_Xam, nv->group, nv->token, nv->group, (int)nv->value_int,
+    text_sprintf(cs.out_buf, fmt_Xam, nv->group, nv->token, nv->group, (int)nv->value_int,
             GET_TEXT_ITEM(msg_am, nv->value_int));
     xio_writeline(cs.out_buf);
 }
@@ -2753,6 +3120,7 @@ void cm_print_tm(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xtm); }
 void cm_print_tn(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xtn); }
 void cm_print_jm(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xjm); }
 void cm_print_jh(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xjh); }
+void cm_print_ac(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xac); }
 void cm_print_ra(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xra); }
 
 void cm_print_hi(nvObj_t *nv) { _print_axis_ui8(nv, fmt_Xhi); }
@@ -55,6 +55,7 @@
 #define JERK_INPUT_MAX (1000000) // maximum allowable jerk setting in millions mm/min^3
 #define PROBES_STORED 3          // we store three probes for coordinate rotation computation
 #define MAX_LINENUM 2000000000   // set 2 billion as max line number
+#define HOMING_INPUT_STALL 100   // {xhi:100} homes the axis on its motors' driver stall flags (sensorless)
 
 /*****************************************************************************
  * MACHINE STATE MODEL
@@ -220,6 +221,7 @@ typedef struct cmAxis
     float feedrate_max;   // max velocity in mm/min or deg/min
     float jerk_max;       // max jerk (Jm) in mm/min^3 divided by 1 million
     float jerk_high;      // high speed deceleration jerk (Jh) in mm/min^3 divided by 1 million
+    float accel_max;      // max acceleration in mm/s^2 or deg/s^2. 0 = limited by jerk only
     float travel_min;     // min work envelope for soft limits
     float travel_max;     // max work envelope for soft limits
     float radius;         // radius in mm for rotary axis modes
@@ -227,11 +229,15 @@ typedef struct cmAxis
     // internal derived variables - computed during data entry and cached for computational efficiency
     float recip_velocity_max;
     float recip_feedrate_max;
+    float recip_jerk_max;       // kept by cm_set_axis_max_jerk() - do not write jerk_max directly
+    float recip_jerk_high;      // kept by cm_set_axis_high_jerk()
+    float recip_accel_max;      // 1/accel_max in min^2/mm, 0 if no limit. kept by cm_set_ac()
+    float degrees_per_mm;       // ABC in RADIUS mode: 360/(2 pi radius), else 0. kept by _cm_recalc_rotary_scale()
     float max_junction_accel;
     float high_junction_accel;
 
     // homing settings
-    uint8_t homing_input;  // set 1-N for homing input. 0 will disable homing
+    uint8_t homing_input;  // set 1-N for homing input, HOMING_INPUT_STALL for sensorless. 0 will disable homing
     uint8_t homing_dir;    // 0=search to negative, 1=search to positive
     float search_velocity; // homing search velocity
     float latch_velocity;  // homing latch velocity
@@ -266,11 +272,22 @@ typedef struct cmArc
     float segment_linear_travel; // linear motion per segment
     float center_0;              // center of circle at plane axis 0 (e.g. X for G17)
     float center_1;              // center of circle at plane axis 1 (e.g. Y for G17)
+    float segment_sin;           // sin(segment_theta) for incremental rotation
+    float segment_cos;           // cos(segment_theta) for incremental rotation
+    float offset_0;              // current position relative to center at plane axis 0: sin(theta) * radius
+    float offset_1;              // current position relative to center at plane axis 1: cos(theta) * radius
 
     GCodeState_t gm; // Gcode state struct is passed for each arc segment.
     magic_t magic_end;
 } cmArc_t;
 
+typedef struct cmSoftLimit
+{               // one axis of the active soft limit set
+    uint8_t axis; // axis the limits apply to
+    float min;    // copy of a[axis].travel_min
+    float max;    // copy of a[axis].travel_max
+} cmSoftLimit_t;
+
 typedef struct cmMachine
 {                        // struct to manage canonical machine globals and state
     magic_t magic_start; // magic number to test memory integrity
@@ -281,12 +298,14 @@ typedef struct cmMachine
     float junction_integration_time; // how aggressively will the machine corner? 1.6 or so is about the upper limit
     float chordal_tolerance;         // arc chordal accuracy setting in mm
     float feedhold_z_lift;           // mm to move Z axis on feedhold, or 0 to disable
+    bool traverse_uncoordinated;     // true to run G0 axes at their own velocity limits (dogleg rapids)
     bool soft_limit_enable;          // true to enable soft limit testing on Gcode inputs
     bool limit_enable;               // true to enable limit switches (disabled is same as override)
 
     // Coordinate systems and offsets
     float coord_offset[COORDS + 1][AXES]; // persistent coordinate offsets: absolute (G53) + G54,G55,G56,G57,G58,G59
     float tool_offset[AXES];              // current tool offset
+    float combined_offset[AXES];          // cached coord + tool + G92 offsets - see cm_update_combined_offsets()
 
     // Axis settings
     cfgAxis_t a[AXES];
@@ -318,27 +337,28 @@ typedef struct cmMachine
 
     bool return_flags[AXES]; // flags for recording which axes moved - used in feedhold exit move
 
-    uint8_t limit_requested;    // set non-zero to request limit switch processing (value is input number)
-    uint8_t shutdown_requested; // set non-zero to request shutdown in support of external estop (value is input number)
     bool deferred_write_flag;   // G10 data has changed (e.g. offsets) - flag to persist them
 
     bool safety_interlock_enable;         // true to enable safety interlock system
     bool request_interlock;               // enter interlock
     bool request_interlock_exit;          // exit interlock
-    uint8_t safety_interlock_disengaged;  // set non-zero to start interlock processing (value is input number)
-    uint8_t safety_interlock_reengaged;   // set non-zero to end interlock processing (value is input number)
+    uint8_t safety_interlock_reengaged;   // non-zero while an interlock restart waits for the runtime (value is input number)
     cmSafetyState safety_interlock_state; // safety interlock state
     uint32_t esc_boot_timer;              // timer for Electronic Speed Control (Spindle electronics) to boot
 
     cmHomingState homing_state; // home: homing cycle sub-state machine
     uint8_t homed[AXES];        // individual axis homing flags
 
+    uint8_t soft_limit_count;         // number of entries in soft_limit[]
+    cmSoftLimit_t soft_limit[AXES];   // homed axes with enabled limits - see cm_update_soft_limits()
+
     bool probe_report_enable;                 // 0=disabled, 1=enabled
     cmProbeState probe_state[PROBES_STORED];  // probing state machine (simple)
     float probe_results[PROBES_STORED][AXES]; // probing results
 
     float rotation_matrix[3][3]; // three-by-three rotation matrix. We ignore UVW and ABC axes
     float rotation_z_offset;     // separately handle a z-offset to maintain consistent distance to bed
+    bool rotation_identity;      // true if the matrix is identity and there is no z-offset. Set when they change
 
     float jogging_dest; // jogging destination as a relative move from current position
 
@@ -405,6 +425,7 @@ stat_t cm_check_linenum();
 
 // Coordinate systems and offsets
 float cm_get_combined_offset(const uint8_t axis);
+void cm_update_combined_offsets(void);
 float cm_get_display_offset(const GCodeState_t *gcode_state, const uint8_t axis);
 void cm_set_display_offsets(GCodeState_t *gcode_state);
 float cm_get_display_position(const GCodeState_t *gcode_state, const uint8_t axis);
@@ -417,6 +438,8 @@ void cm_set_model_target(const float target[], const bool flag[]);
 bool cm_get_soft_limits(void);
 void cm_set_soft_limits(bool enable);
 
+void cm_update_soft_limits(void);
+stat_t cm_check_soft_limits(const float min[], const float max[]);
 stat_t cm_test_soft_limits(const float target[]);
 
 /*--- Canonical machining functions (loosely) defined by NIST [organized by NIST Gcode doc] ---*/
@@ -462,7 +485,8 @@ stat_t cm_goto_g30_position(const float target[], const bool flags[]);
 // Machining Attributes (4.3.5)
 stat_t cm_set_feed_rate(const float feed_rate);                            // F parameter
 stat_t cm_set_feed_rate_mode(const uint8_t mode);                          // G93, G94, (G95 unimplemented)
-stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode); // G61, G61.1, G64
+stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode,   // G61, G61.1, G64 [P<tolerance>]
+                           const float P_word = 0, const bool P_flag = false);
 
 // Machining Functions (4.3.6)
 stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t motion_profile); //G1
@@ -532,10 +556,30 @@ stat_t cm_straight_probe(float target[], bool flags[], // G38.x
 stat_t cm_probing_cycle_callback(void); // G38.x main loop callback
 stat_t cm_get_prbr(nvObj_t *nv);        // enable/disable probe report
 stat_t cm_set_prbr(nvObj_t *nv);
+stat_t cm_get_mesh(nvObj_t *nv);        // return if a probed mesh is stored
+stat_t cm_set_mesh(nvObj_t *nv);        // run the probing grid, or discard the mesh
+
+// Canned drilling cycles (cycle_drilling.cpp)
+stat_t cm_set_retract_mode(const uint8_t mode);         // G98, G99
+stat_t cm_canned_cycle(const cmMotionMode motion_mode,  // G81, G82, G83, G85, G89
+                       const float target[], const bool flags[],
+                       const float R_word, const bool R_flag,
+                       const float Q_word, const bool Q_flag,
+                       const float P_word, const bool P_flag,
+                       const uint8_t L_word, const bool L_flag);
+stat_t cm_canned_cycle_callback(void);                  // queues the cycle moves from the main loop
+bool cm_canned_cycle_running(void);
+void cm_abort_canned_cycle(void);
+
+// Spindle synchronized motion (cycle_spindle_sync.cpp)
+stat_t cm_spindle_sync_feed(const cmMotionMode motion_mode,   // G33, G33.1
+                            const float target[], const bool flags[],
+                            const float K_word, const bool K_flag);
 
 // Jogging cycle (cycle_jogging.cpp)
 stat_t cm_jogging_cycle_callback(void);      // jogging cycle main loop
 stat_t cm_jogging_cycle_start(uint8_t axis); // {"jogx":-100.3}
+stat_t cm_jogging_velocity(int8_t axis, float velocity); // {"jgvx":1200}
 float cm_get_jogging_dest(void);             // get jogging destination
 
 // Alarm management (alarm.cpp)
@@ -573,6 +617,7 @@ stat_t cm_get_hom(nvObj_t *nv);  // get homing state for axis
 stat_t cm_get_prob(nvObj_t *nv); // get probe state
 stat_t cm_get_prb(nvObj_t *nv);  // get probe result for axis
 stat_t cm_run_jog(nvObj_t *nv);  // start jogging cycle
+stat_t cm_run_jgv(nvObj_t *nv);  // start or steer a velocity jog
 
 stat_t cm_get_unit(nvObj_t *nv);  // get unit mode
 stat_t cm_get_coor(nvObj_t *nv);  // get coordinate system in effect
@@ -629,6 +674,8 @@ stat_t cm_get_jm(nvObj_t *nv); // get jerk max with 1,000,000 correction
 stat_t cm_set_jm(nvObj_t *nv); // set jerk max with 1,000,000 correction
 stat_t cm_get_jh(nvObj_t *nv); // get jerk high with 1,000,000 correction
 stat_t cm_set_jh(nvObj_t *nv); // set jerk high with 1,000,000 correction
+stat_t cm_get_ac(nvObj_t *nv); // get acceleration max
+stat_t cm_set_ac(nvObj_t *nv); // set acceleration max and reciprocal
 
 stat_t cm_get_hi(nvObj_t *nv); // get homing input
 stat_t cm_set_hi(nvObj_t *nv); // set homing input
@@ -649,6 +696,8 @@ stat_t cm_get_ct(nvObj_t *nv);  // get chordal tolerance
 stat_t cm_set_ct(nvObj_t *nv);  // set chordal tolerance
 stat_t cm_get_zl(nvObj_t *nv);  // get feedhold Z lift
 stat_t cm_set_zl(nvObj_t *nv);  // set feedhold Z lift
+stat_t cm_get_tru(nvObj_t *nv); // get uncoordinated traverse
+stat_t cm_set_tru(nvObj_t *nv); // set uncoordinated traverse
 stat_t cm_get_sl(nvObj_t *nv);  // get soft limit enable
 stat_t cm_set_sl(nvObj_t *nv);  // set soft limit enable
 stat_t cm_get_lim(nvObj_t *nv); // get hard limit enable
@@ -674,6 +723,9 @@ stat_t cm_get_tram(nvObj_t *nv); // return if the rotation matrix is non-identit
 stat_t cm_set_nxln(nvObj_t *nv); // set what value we expect the next line number to have
 stat_t cm_get_nxln(nvObj_t *nv); // return what value we expect the next line number to have
 
+stat_t cm_set_ckpt(nvObj_t *nv); // restore or discard the job checkpoint
+stat_t cm_get_ckpt(nvObj_t *nv); // return the checkpointed line number, -1 if none
+
 stat_t cm_get_gpl(nvObj_t *nv); // get gcode default plane
 stat_t cm_set_gpl(nvObj_t *nv); // set gcode default plane
 stat_t cm_get_gun(nvObj_t *nv); // get gcode default units mode
@@ -725,6 +777,7 @@ void cm_print_tof(nvObj_t *nv); // print tool length offset
 void cm_print_jt(nvObj_t *nv); // global CM settings
 void cm_print_ct(nvObj_t *nv);
 void cm_print_zl(nvObj_t *nv);
+void cm_print_tru(nvObj_t *nv);
 void cm_print_sl(nvObj_t *nv);
 void cm_print_lim(nvObj_t *nv);
 void cm_print_saf(nvObj_t *nv);
@@ -736,7 +789,9 @@ void cm_print_troe(nvObj_t *nv);
 void cm_print_tro(nvObj_t *nv);
 
 void cm_print_tram(nvObj_t *nv); // print if the axis has been rotated
+void cm_print_mesh(nvObj_t *nv); // print if a probed mesh is stored
 void cm_print_nxln(nvObj_t *nv); // print the value of the next line number expected
+void cm_print_ckpt(nvObj_t *nv); // print the checkpointed line number
 
 void cm_print_am(nvObj_t *nv); // axis print functions
 void cm_print_fr(nvObj_t *nv);
@@ -745,6 +800,7 @@ void cm_print_tm(nvObj_t *nv);
 void cm_print_tn(nvObj_t *nv);
 void cm_print_jm(nvObj_t *nv);
 void cm_print_jh(nvObj_t *nv);
+void cm_print_ac(nvObj_t *nv);
 void cm_print_ra(nvObj_t *nv);
 
 void cm_print_hi(nvObj_t *nv);
@@ -793,6 +849,7 @@ void cm_print_cpos(nvObj_t *nv);
 #define cm_print_jt tx_print_stub // global CM settings
 #define cm_print_ct tx_print_stub
 #define cm_print_zl tx_print_stub
+#define cm_print_tru tx_print_stub
 #define cm_print_sl tx_print_stub
 #define cm_print_lim tx_print_stub
 #define cm_print_saf tx_print_stub
@@ -805,7 +862,9 @@ void cm_print_cpos(nvObj_t *nv);
 #define cm_print_tram tx_print_stub
 
 #define cm_print_tram tx_print_stub
+#define cm_print_mesh tx_print_stub
 #define cm_print_nxln tx_print_stub
+#define cm_print_ckpt tx_print_stub
 
 #define cm_print_am tx_print_stub // axis print functions
 #define cm_print_fr tx_print_stub
@@ -814,6 +873,7 @@ void cm_print_cpos(nvObj_t *nv);
 #define cm_print_tn tx_print_stub
 #define cm_print_jm tx_print_stub
 #define cm_print_jh tx_print_stub
+#define cm_print_ac tx_print_stub
 #define cm_print_ra tx_print_stub
 
 #define cm_print_hi tx_print_stub
@@ -41,7 +41,8 @@
 #include "util.h"
 #include "xio.h"
 
-static void _set_defa(nvObj_t *nv, bool print);
+static void _set_defa(nvObj_t *nv, bool print, bool restore, bool imaged);
+static bool _defaults_loading;                  // _set_defa() is running the SET functions
 
 /***********************************************************************************
  **** STRUCTURE ALLOCATIONS ********************************************************
@@ -104,6 +105,10 @@ stat_t nv_persist(nvObj_t *nv)
  *  (1) if persistence is set up or out-of-rev load RAM and NVM with settings.h defaults
  *  (2) if persistence is set up and at current config version use NVM data for config
  *
+ *  If the boot image matches the persisted values the structs in cfgImage[] are copied
+ *  from it and only the items it doesn't cover run their SET functions. Otherwise all
+ *  items are set and a new image is taken for the next boot.
+ *
  *  You can assume the cfg struct has been zeroed by a hard reset.
  *  Do not clear it as the version and build numbers have already been set by tg_init()
  *
@@ -113,26 +118,47 @@ void config_init()
 {
     nvObj_t *nv = nv_reset_nv_list();
     config_init_assertions();
+    nv_index_init();                             // build the token lookup index
     js.json_mode = JSON_MODE;                    // initial value until persistence is read
-    _set_defa(nv, false);
+    bool imaged = persistence_load_image(cfgImage, cfgImageRegions);
+    nv->index = nv_get_index("", "mprof");      // the profile unpersisted items fall back to
+    nv->value_int = 0;
+    read_persistent_value(nv);
+    cfg.profile = cfg_profile_usable(nv->value_int) ? nv->value_int : 0;
+    _set_defa(nv, false, persistence_is_loaded(), imaged); // persisted values where there are any
+    if (!imaged) {
+        persistence_save_image(cfgImage, cfgImageRegions);
+    }
     rpt_print_loading_configs_message();
 }
 
 /*
  * set_defaults() - reset persistence with default values for machine profile
  * _set_defa() - helper function and called directly from config_init()
+ *
+ *  With restore set, persisted items take their value from NVM and fall back to the
+ *  default only if nothing was persisted for them. Restored values are already in NVM,
+ *  so persisting them again writes nothing. With imaged set, items the boot image has
+ *  already restored are skipped. Defaults come from the machine profile in use.
  */
 
-static void _set_defa(nvObj_t *nv, bool print)
+static void _set_defa(nvObj_t *nv, bool print, bool restore, bool imaged)
 {
     cm_set_units_mode(MILLIMETERS);             // must do inits in MM mode
+    _defaults_loading = true;
     for (nv->index=0; nv_index_is_single(nv->index); nv->index++) {
+        if ((imaged && cfg_image_restores(nv->index)) || !nv_axis_active(nv->index)) {
+            continue;
+        }
         if (cfgArray[nv->index].flags & F_INITIALIZE) {
             if ((cfgArray[nv->index].flags & TYPE_INTEGER) ||
                 (cfgArray[nv->index].flags & TYPE_BOOLEAN)) {    // Fix for Issue #357
-                nv->value_int = cfgArray[nv->index].def_value;
+                nv->value_int = cfg_profile_value(nv->index);
             } else {
-                nv->value_flt = cfgArray[nv->index].def_value;
+                nv->value_flt = cfg_profile_value(nv->index);
+            }
+            if (restore && (cfgArray[nv->index].flags & F_PERSIST)) {
+                read_persistent_value(nv);      // leaves the default if there is no value
             }
             strncpy(nv->token, cfgArray[nv->index].token, TOKEN_LEN);
             cfgArray[nv->index].set(nv);        // run the set method, nv_set(nv);
@@ -141,6 +167,7 @@ static void _set_defa(nvObj_t *nv, bool print)
             }            
         }
     }
+    _defaults_loading = false;
     sr_init_status_report();                    // reset status reports
     if (print) {
         rpt_print_initializing_message();       // don't start TX until all the NVM persistence is done
@@ -153,7 +180,7 @@ stat_t set_defaults(nvObj_t *nv)
     if (!nv->value_int) { 
         return(help_defa(nv));
     }
-    _set_defa(nv, true);
+    _set_defa(nv, true, false, false);
 
     // The nvlist was used for the initialize message so the values are all garbage
     // Mark the nv as $defa so it displays nicely in the response
@@ -165,6 +192,45 @@ stat_t set_defaults(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/*
+ * cfg_get_mprof() - get the machine profile in use
+ * cfg_set_mprof() - switch to another compiled-in machine profile
+ *
+ *  Profile 0 is the build's own SETTINGS_FILE. The others are the settings files compiled
+ *  in as CONFIG_PROFILE_1..4 (see config_profile.h), each a table of default values in
+ *  flash. A switch is a $defa from the new profile's table: one pass over cfgArray with
+ *  no parsing, token lookup or response per item, and the changed values reach NVM from
+ *  persistence_flush(). The profile itself is persisted, so $defa and items without a
+ *  persisted value keep using it after a reset.
+ */
+
+stat_t cfg_get_mprof(nvObj_t *nv) { return (get_integer(nv, cfg.profile)); }
+
+stat_t cfg_set_mprof(nvObj_t *nv)
+{
+    if (_defaults_loading) {                    // being set by _set_defa(): keep the profile in use
+        nv->value_int = cfg.profile;
+        return (STAT_OK);
+    }
+    if ((nv->value_int < 0) || (nv->value_int >= cfgProfileCount)) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    if (!cfg_profile_usable(nv->value_int)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);     // built against a different config table
+    }
+    if ((cm->cycle_type != CYCLE_NONE) || cm_get_runtime_busy()) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    cfg.profile = nv->value_int;
+    _set_defa(nv, true, false, false);
+
+    nv_reset_nv_list();                         // the nvlist was used for the initialize message
+    strncpy(nv->token, "mprof", TOKEN_LEN);
+    nv->valuetype = TYPE_INTEGER;
+    nv->value_int = cfg.profile;
+    return (STAT_OK);
+}
+
 /*
  * config_init_assertions()
  * config_test_assertions() - check memory integrity of config sub-system
@@ -329,7 +395,7 @@ stat_t get_grp(nvObj_t *nv)
     strcpy(nv->token, group);                       // re-write the group string
     nv->valuetype = TYPE_PARENT;                    // make first object the parent
     for (index_t i=0; nv_index_is_single(i); i++) {
-        if (strcmp(group, cfgArray[i].group) != 0) { continue; }
+        if ((strcmp(group, cfgArray[i].group) != 0) || !nv_axis_active(i)) { continue; }
         (++nv)->index = i;
         nv_get_nvObj(nv);
     }
@@ -372,33 +438,71 @@ stat_t set_grp(nvObj_t *nv)
  * nvObj helper functions and other low-level nv helpers
  */
 
-/* nv_get_index() - get index from mnenonic token + group
+/* nv_index_init() - build the sorted token index used by nv_get_index()
+ * nv_get_index()  - get index from mnenonic token + group
+ *
+ * nv_get_index() used to be the most expensive routine in the whole config - a
+ * linear table scan of the strings. It now does a binary search of cfgTokenIndex[],
+ * which holds the cfgArray indexes sorted by token. The index is built once on the
+ * first lookup (or from config_init()) and costs 2 bytes of RAM per cfgArray row.
  *
- * nv_get_index() is the most expensive routine in the whole config. It does a
- * linear table scan of the strings, which of course could be further
- * optimized with indexes or hashing.
+ * Matching rules are unchanged from the table scan: tokens compare on their first
+ * NV_INDEX_KEY_LEN characters, and if more than one row matches the lowest cfgArray
+ * index wins. The sort breaks ties on the cfgArray index to keep that ordering.
+ *
+ * Items for axes a reduced build leaves out (see nv_axis_active()) are not indexed,
+ * so their tokens are not recognized.
  */
+static bool nv_index_ready = false;
+static index_t nv_index_count;                      // rows in cfgTokenIndex[]
+
+static int _compare_tokens(const void *a, const void *b)
+{
+    index_t i = *(const index_t *)a;
+    index_t j = *(const index_t *)b;
+    int cmp = strncmp(cfgArray[i].token, cfgArray[j].token, NV_INDEX_KEY_LEN);
+    if (cmp != 0) {
+        return (cmp);
+    }
+    return ((int)i - (int)j);                       // keep duplicates in table order
+}
+
+void nv_index_init()
+{
+    index_t index_max = nv_index_max();
+
+    nv_index_count = 0;
+    for (index_t i=0; i < index_max; i++) {
+        if (nv_axis_active(i)) {
+            cfgTokenIndex[nv_index_count++] = i;
+        }
+    }
+    qsort(cfgTokenIndex, nv_index_count, sizeof(index_t), _compare_tokens);
+    nv_index_ready = true;
+}
+
 index_t nv_get_index(const char *group, const char *token)
 {
-    char c;
     char str[TOKEN_LEN + GROUP_LEN+1];    // should actually never be more than TOKEN_LEN+1
     strncpy(str, group, GROUP_LEN+1);
     strncat(str, token, TOKEN_LEN+1);
 
-    index_t i;
-    index_t index_max = nv_index_max();
+    if (!nv_index_ready) {
+        nv_index_init();
+    }
+    index_t lo = 0;                                 // lower bound search for the first match
+    index_t hi = nv_index_count;
 
-    for (i=0; i < index_max; i++) {
-        if ((c = GET_TOKEN_BYTE(token[0])) != str[0]) {    continue; }              // 1st character mismatch
-        if ((c = GET_TOKEN_BYTE(token[1])) == NUL) { if (str[1] == NUL) return(i);} // one character match
-        if (c != str[1]) continue;                                                  // 2nd character mismatch
-        if ((c = GET_TOKEN_BYTE(token[2])) == NUL) { if (str[2] == NUL) return(i);} // two character match
-        if (c != str[2]) continue;                                                  // 3rd character mismatch
-        if ((c = GET_TOKEN_BYTE(token[3])) == NUL) { if (str[3] == NUL) return(i);} // three character match
-        if (c != str[3]) continue;                                                  // 4th character mismatch
-        if ((c = GET_TOKEN_BYTE(token[4])) == NUL) { if (str[4] == NUL) return(i);} // four character match
-        if (c != str[4]) continue;                                                  // 5th character mismatch
-        return (i);                                                                 // five character match
+    while (lo < hi) {
+        index_t mid = lo + ((hi - lo) >> 1);
+        if (strncmp(cfgArray[cfgTokenIndex[mid]].token, str, NV_INDEX_KEY_LEN) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ((lo < nv_index_count) && (strncmp(cfgArray[cfgTokenIndex[lo]].token, str, NV_INDEX_KEY_LEN) == 0)) {
+        return (cfgTokenIndex[lo]);
     }
     return (NO_MATCH);
 }
@@ -514,18 +618,31 @@ nvObj_t *nv_reset_nv(nvObj_t *nv)               // clear a single nvObj structur
     return (nv);                                // return pointer to nv as a convenience to callers
 }
 
-void _nv_reset_a_list(nvObj_t *nv, uint8_t length) // clear some nv list (called from below)
+/*
+ * _nv_reset_a_list() - clear the used part of an nv list (called from below)
+ *
+ *  Lists are filled front to back and every object that is used gets a type or a token,
+ *  so the used part is the run of objects up to the first one still in its reset state.
+ *  Only that run is cleared, which makes a reset cost what the last command used rather
+ *  than the whole list. The first reset after power-up finds nothing clean and does it all.
+ */
+
+static void _nv_reset_a_list(nvObj_t *nv, uint8_t length)
 {
-    for (uint8_t i=0; i<length; i++, nv++) {
+    nvObj_t *last = nv + length - 1;
+    for ( ; nv <= last; nv++) {
+        nvObj_t *nx = (nv == last) ? NULL : (nv+1);
+        if ((nv->valuetype == TYPE_EMPTY) && (nv->token[0] == NUL) && (nv->nx == nx)) {
+            return;                             // clean from here on
+        }
         nv->pv = (nv-1);                        // the ends are bogus & corrected later
-        nv->nx = (nv+1);
+        nv->nx = nx;
         nv->index = 0;
         nv->depth = 1;                          // header and footer are corrected later
         nv->precision = 0;
         nv->valuetype = TYPE_EMPTY;
         nv->token[0] = NUL;
     }
-    (--nv)->nx = NULL;
 }
 
 nvObj_t *nv_reset_nv_list()                     // clear the header and response body
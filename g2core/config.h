@@ -97,8 +97,8 @@
  *     Look in the modules for examples - e.g. at the end of canoonical_machine.cpp
  *
  *   - The ordering of group displays is set by the order of items in cfgArray. None of the other
- *     orders matter but are generally kept sequenced for easier reading and code maintenance. Also,
- *     Items earlier in the array will resolve token searches faster than ones later in the array.
+ *     orders matter but are generally kept sequenced for easier reading and code maintenance.
+ *     Token searches use a sorted index (see nv_index_init()) so table position does not affect speed.
  *
  *     Note that matching will occur from the most specific to the least specific, meaning that
  *     if tokens overlap the longer one should be earlier in the array: "gco" should precede "gc".
@@ -151,13 +151,17 @@
  *  The observation is that the total rendered output in JSON or text mode cannot exceed the size of
  *  the output buffer (typ 256 bytes), So some number less than that is sufficient for shared strings.
  *  This is all mediated through nv_copy_string(), nv_copy_string_P(), and nv_reset_nv_list().
+ *
+ *  The nvObj list and the shared string are used as an arena: both are filled from the front
+ *  and released all at once. nv_reset_nv_list() rewinds the string in one store and only clears
+ *  the objects the previous command used, so a small command doesn't pay for NV_BODY_LEN.
  */
 /*  --- Setting nvObj indexes ---
  *
  *  It's the responsibility of the object creator to set the index. Downstream functions
  *  all expect a valid index. Set the index by calling nv_get_index(). This also validates
- *  the token and group if no lookup exists. Setting the index is an expensive operation
- *  (linear table scan), so there are some exceptions where the index does not need to be set.
+ *  the token and group if no lookup exists. Setting the index is a binary search of the token
+ *  index, so it's cheap but not free. There are some exceptions where the index does not need to be set.
  *  These cases are put in the code, commented out, and explained.
  */
 /*  --- Other Notes:---
@@ -192,6 +196,7 @@ typedef uint16_t index_t;               // use this if there are > 255 indexed o
 #define NV_EXEC_FIRST (NV_BODY_LEN+2)   // index of the first EXEC nv
 #define NV_MAX_OBJECTS (NV_BODY_LEN-1)  // maximum number of objects in a body string
 #define NO_MATCH (index_t)0xFFFF
+#define NV_INDEX_KEY_LEN 5              // token characters significant for index lookups
 
 typedef enum {
     TEXT_MODE = 0,                      // sticky text mode
@@ -334,6 +339,7 @@ typedef struct cfgItem {
 extern nvStr_t nvStr;
 extern nvList_t nvl;
 extern const cfgItem_t cfgArray[];
+extern index_t cfgTokenIndex[];         // cfgArray indexes sorted by token (see config_app.cpp)
 
 //#define nv_header nv.list
 #define nv_header (&nvl.list[0])
@@ -344,6 +350,8 @@ extern const cfgItem_t cfgArray[];
 
 void config_init(void);
 stat_t set_defaults(nvObj_t *nv);       // reset config to default values
+stat_t cfg_get_mprof(nvObj_t *nv);      // get the machine profile in use
+stat_t cfg_set_mprof(nvObj_t *nv);      // switch machine profiles and load its defaults
 void config_init_assertions(void);
 stat_t config_test_assertions(void);
 
@@ -356,12 +364,16 @@ stat_t nv_persist(nvObj_t *nv);         // main entry point for persistence
 // helpers
 uint8_t nv_get_type(nvObj_t *nv);
 void nv_coerce_types(nvObj_t *nv);
+void nv_index_init(void);
 index_t nv_get_index(const char *group, const char *token);
 index_t nv_index_max(void);             // (see config_app.c)
 bool nv_index_is_single(index_t index); // (see config_app.c)
 bool nv_index_is_group(index_t index);  // (see config_app.c)
 bool nv_index_lt_groups(index_t index); // (see config_app.c)
+bool nv_axis_active(index_t index);     // (see config_app.c)
 bool nv_group_is_prefixed(char *group);
+stat_t nv_dump_callback(void);          // (see config_app.c)
+bool nv_dump_pending(void);             // (see config_app.c)
 
 // generic internal functions and accessors
 stat_t get_nul(nvObj_t *nv);            // get null value type
@@ -407,6 +419,34 @@ stat_t set_int32(nvObj_t *nv, int32_t &value, int32_t low, int32_t high);
 
 stat_t get_string(nvObj_t *nv, const char *str);
 
+// boot config image (config_app.c)
+typedef struct cfgImageRegion {         // a config struct restored from the boot image
+    void *addr;
+    uint16_t size;
+} cfgImageRegion_t;
+
+extern const cfgImageRegion_t cfgImage[];
+extern const uint8_t cfgImageRegions;
+bool cfg_image_restores(index_t index); // true if the image holds everything this item's SET does
+
+// machine profiles (config_app.c, see config_profile.h)
+typedef struct cfgProfileValue {        // a config table row reduced to its default value
+    float value;
+    constexpr cfgProfileValue(const char *, const char *, uint8_t, int8_t, fptrPrint, fptrCmd, fptrCmd,
+                              const void *, float def_value) : value(def_value) {}
+} cfgProfileValue_t;
+
+typedef struct cfgProfile {             // the defaults of one settings file
+    const char *name;                   // the settings file
+    index_t count;                      // rows in its value table, 0 for the build's own settings
+    const cfgProfileValue_t *values;    // default for each single-valued item, in cfgArray order
+} cfgProfile_t;
+
+extern const cfgProfile_t *const cfgProfiles[];
+extern const uint8_t cfgProfileCount;
+bool cfg_profile_usable(uint8_t profile);   // true if the profile was built against this cfgArray
+float cfg_profile_value(index_t index);     // default for an item in the profile in use
+
 // diagnostics
 void nv_dump_nv(nvObj_t *nv);
 
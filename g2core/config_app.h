@@ -44,6 +44,8 @@ typedef struct cfgParameters {  // mostly communications variables at this point
     // Job ID
     int32_t job_id[4];  // uuid to identify the job
 
+    uint8_t profile;    // machine profile in use - index into cfgProfiles[]
+
 #ifdef __USER_DATA
     // user-defined data groups
     uint32_t user_data_a[4];
@@ -83,6 +85,7 @@ void cfg_print_ew(nvObj_t* nv);
 void cfg_print_baud(nvObj_t* nv);
 void cfg_print_net(nvObj_t* nv);
 void cfg_print_rx(nvObj_t* nv);
+void cfg_print_mprof(nvObj_t* nv);
 
 #else
 
@@ -93,6 +96,7 @@ void cfg_print_rx(nvObj_t* nv);
 #define cfg_print_baud tx_print_stub
 #define cfg_print_net tx_print_stub
 #define cfg_print_rx tx_print_stub
+#define cfg_print_mprof tx_print_stub
 
 #endif  // __TEXT_MODE
 
@@ -0,0 +1,122 @@
+/*
+ * config_profile.h - machine profiles compiled in from settings files
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * MACHINE PROFILES
+ *
+ *  SETTINGS_FILE picks the settings file a build takes its defaults from. Up to four more
+ *  can be compiled into the same firmware and switched to at runtime with {mprof:n}.
+ *  Name them in the makefile or compiler command line the same way:
+ *
+ *      CONFIG_PROFILE_1=settings_shapeoko2.h CONFIG_PROFILE_2=settings_othermill.h
+ *
+ *  config_profile_n.cpp compiles config_table.h with CONFIG_PROFILE_n in place of
+ *  SETTINGS_FILE, and keeps only the default value column. That makes each profile a
+ *  constant table of one float per item (about 4K of flash). {mprof:0} goes back to the
+ *  build's own SETTINGS_FILE, which needs no table.
+ *
+ *  Only runtime settings switch. Anything a settings file fixes at compile time - motor
+ *  and axis counts, enabled subsystems, the board profile - comes from SETTINGS_FILE for
+ *  every profile. A profile whose settings file adds or removes config table rows is
+ *  compiled, but {mprof:n} won't load it (see cfg_profile_usable()).
+ */
+
+#ifndef CONFIG_PROFILE_H_ONCE
+#define CONFIG_PROFILE_H_ONCE
+
+#include "g2core.h"  // #1
+#include "config.h"  // #2
+
+extern const cfgProfile_t cfgProfile1;
+extern const cfgProfile_t cfgProfile2;
+extern const cfgProfile_t cfgProfile3;
+extern const cfgProfile_t cfgProfile4;
+
+/**** Profile value table - compiled by config_profile_n.cpp only ****/
+
+#ifdef CONFIG_PROFILE_OBJECT
+
+#include "controller.h"
+#include "canonical_machine.h"
+#include "gcode.h"
+#include "json_parser.h"
+#include "text_parser.h"
+#include "settings.h"
+#include "planner.h"
+#include "plan_arc.h"
+#include "stepper.h"
+#include "gpio.h"
+#include "spindle.h"
+#include "temperature.h"
+#include "coolant.h"
+#include "pwm.h"
+#include "report.h"
+#include "hardware.h"
+#include "util.h"
+#include "help.h"
+#include "xio.h"
+#include "profile.h"
+#include "memory_usage.h"
+#include "encoder.h"
+#include "kinematics.h"
+#include "macro.h"
+#include "raster.h"
+#include "shaper.h"
+#include "sync.h"
+#include "thc.h"
+#include "job.h"
+#include "benchmark.h"
+
+// config_app.cpp's own functions - only the default column is kept, so they are never bound
+#define get_rx nullptr
+#define get_tick nullptr
+#define get_cfg nullptr
+#define set_cfg nullptr
+#define get_cfgt nullptr
+#define set_cfgt nullptr
+
+#ifdef __DIAGNOSTIC_PARAMETERS
+static mpPlannerRuntime_t cfgProfileRuntime;    // stands in for *mr in the diagnostic rows' targets,
+#define mr (&cfgProfileRuntime)                 // as a pointer's value is not a constant expression
+#endif
+
+static constexpr cfgProfileValue_t cfgProfileValues[] = {
+#include "config_table.h"
+};
+
+#define settings_file_string1(s) #s
+#define settings_file_string2(s) settings_file_string1(s)
+const cfgProfile_t CONFIG_PROFILE_OBJECT = {
+    settings_file_string2(SETTINGS_FILE),
+    sizeof(cfgProfileValues) / sizeof(cfgProfileValue_t),
+    cfgProfileValues
+};
+#undef settings_file_string1
+#undef settings_file_string2
+
+#endif  // CONFIG_PROFILE_OBJECT
+
+#endif  // End of include guard: CONFIG_PROFILE_H_ONCE
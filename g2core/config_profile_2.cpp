@@ -0,0 +1,31 @@
+/*
+ * config_profile_2.cpp - machine profile 2, from the settings file named by CONFIG_PROFILE_2
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/* See config_profile.h. Compiles to nothing unless CONFIG_PROFILE_2 is defined.
+ * The settings file must be chosen before anything includes settings.h.
+ */
+
+#ifdef CONFIG_PROFILE_2
+
+#undef SETTINGS_FILE
+#define SETTINGS_FILE CONFIG_PROFILE_2
+#define CONFIG_PROFILE_OBJECT cfgProfile2
+
+#include "config_profile.h"
+
+#endif  // CONFIG_PROFILE_2
@@ -0,0 +1,1384 @@
+/*
+ * config_table.h - single-valued entries of the config table
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2013 - 2018 Alden S. Hart, Jr.
+ * Copyright (c) 2016 - 2018 Robert Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/* The rows of cfgArray up to the group lookups - everything with a default value.
+ * There is no include guard: the file is included inside an initializer list, once by
+ * config_app.cpp for cfgArray itself and once by each compiled-in machine profile
+ * (see config_profile.h), which keeps only the default value column. So the defaults
+ * must be constant expressions, and targets must not need a reinterpret cast.
+ *
+ * Read the notes on the config table in config_app.cpp before changing anything here.
+ */
+
+    // group token flags p, print_func,   get_func,   set_func, get/set target,    default value
+    { "sys", "fb", _fn,  2, hw_print_fb,  hw_get_fb,  set_ro, nullptr_void, 0 },   // MUST BE FIRST for persistence checking!
+    { "sys", "fv", _fn,  2, hw_print_fv,  hw_get_fv,  set_ro, nullptr_void, 0 },
+    { "sys", "fbs",_sn,  0, hw_print_fbs, hw_get_fbs, set_ro, nullptr_void, 0 },
+    { "sys", "fbc",_sn,  0, hw_print_fbc, hw_get_fbc, set_ro, nullptr_void, 0 },
+    { "sys", "hp", _sn,  0, hw_print_hp,  hw_get_hp,  set_ro, nullptr_void, 0 },
+    { "sys", "hv", _sn,  0, hw_print_hv,  hw_get_hv,  set_ro, nullptr_void, 0 },
+    { "sys", "id", _sn,  0, hw_print_id,  hw_get_id,  set_ro, nullptr_void, 0 },   // device ID (ASCII signature)
+
+    // dynamic model attributes for reporting purposes (up front for speed)
+    { "", "stat",_i0, 0, cm_print_stat, cm_get_stat, set_ro, nullptr_void, 0 },    // combined machine state
+    { "","stat2",_i0, 0, cm_print_stat, cm_get_stat2,set_ro, nullptr_void, 0 },    // combined machine state
+    { "", "n",   _ii, 0, cm_print_line, cm_get_mline,set_noop,nullptr_void,0 },    // Model line number
+    { "", "line",_ii, 0, cm_print_line, cm_get_line, set_ro, nullptr_void, 0 },    // Active line number - model or runtime line number
+    { "", "vel", _f0, 2, cm_print_vel,  cm_get_vel,  set_ro, nullptr_void, 0 },    // current velocity
+    { "", "velm",_f0, 2, en_print_velm, en_get_velm, set_ro, nullptr_void, 0 },    // measured velocity (see encoder.h)
+    { "", "feed",_f0, 2, cm_print_feed, cm_get_feed, set_ro, nullptr_void, 0 },    // feed rate
+    { "", "macs",_i0, 0, cm_print_macs, cm_get_macs, set_ro, nullptr_void, 0 },    // raw machine state
+    { "", "cycs",_i0, 0, cm_print_cycs, cm_get_cycs, set_ro, nullptr_void, 0 },    // cycle state
+    { "", "mots",_i0, 0, cm_print_mots, cm_get_mots, set_ro, nullptr_void, 0 },    // motion state
+    { "", "hold",_i0, 0, cm_print_hold, cm_get_hold, set_ro, nullptr_void, 0 },    // feedhold state
+    { "", "unit",_i0, 0, cm_print_unit, cm_get_unit, set_ro, nullptr_void, 0 },    // units mode
+    { "", "coor",_i0, 0, cm_print_coor, cm_get_coor, set_ro, nullptr_void, 0 },    // coordinate system
+    { "", "momo",_i0, 0, cm_print_momo, cm_get_momo, set_ro, nullptr_void, 0 },    // ˶ģʽ
+    { "", "plan",_i0, 0, cm_print_plan, cm_get_plan, set_ro, nullptr_void, 0 },    // plane select
+    { "", "path",_i0, 0, cm_print_path, cm_get_path, set_ro, nullptr_void, 0 },    // path control mode
+    { "", "dist",_i0, 0, cm_print_dist, cm_get_dist, set_ro, nullptr_void, 0 },    // distance mode
+    { "", "admo",_i0, 0, cm_print_admo, cm_get_admo, set_ro, nullptr_void, 0 },    // arc distance mode
+    { "", "frmo",_i0, 0, cm_print_frmo, cm_get_frmo, set_ro, nullptr_void, 0 },    // feed rate mode
+    { "", "tool",_i0, 0, cm_print_tool, cm_get_toolv,set_ro, nullptr_void, 0 },    // active tool
+    { "", "g92e",_i0, 0, cm_print_g92e, cm_get_g92e, set_ro, nullptr_void, 0 },    // G92 enable state
+#ifdef TEMPORARY_HAS_LEDS
+    { "", "_leds",_i0, 0, tx_print_nul, _get_leds,_set_leds, nullptr_void, 0 },    // TEMPORARY - change LEDs
+#endif
+
+    { "mpo","mpox",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // X machine position
+    { "mpo","mpoy",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // Y machine position
+    { "mpo","mpoz",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // Z machine position
+    { "mpo","mpou",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // U machine position
+    { "mpo","mpov",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // V machine position
+    { "mpo","mpow",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // W machine position
+    { "mpo","mpoa",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // A machine position
+    { "mpo","mpob",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // B machine position
+    { "mpo","mpoc",_f0, 5, cm_print_mpo, cm_get_mpo, set_ro, nullptr_void, 0 },    // C machine position
+
+    { "pos","posx",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // X work position
+    { "pos","posy",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // Y work position
+    { "pos","posz",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // Z work position
+    { "pos","posu",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // U work position
+    { "pos","posv",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // V work position
+    { "pos","posw",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // W work position
+    { "pos","posa",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // A work position
+    { "pos","posb",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // B work position
+    { "pos","posc",_f0, 5, cm_print_pos, cm_get_pos, set_ro, nullptr_void, 0 },    // C work position
+
+    { "ofs","ofsx",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // X work offset
+    { "ofs","ofsy",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // Y work offset
+    { "ofs","ofsz",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // Z work offset
+    { "ofs","ofsu",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // U work offset
+    { "ofs","ofsv",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // V work offset
+    { "ofs","ofsw",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // W work offset
+    { "ofs","ofsa",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // A work offset
+    { "ofs","ofsb",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // B work offset
+    { "ofs","ofsc",_f0, 5, cm_print_ofs, cm_get_ofs, set_ro, nullptr_void, 0 },    // C work offset
+
+    { "hom","home",_i0, 0, cm_print_home,cm_get_home,cm_set_home,nullptr_void,0 }, // homing state, invoke homing cycle
+    { "hom","homx",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // X homed - Homing status group
+    { "hom","homy",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // Y homed
+    { "hom","homz",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // Z homed
+    { "hom","homu",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // U homed
+    { "hom","homv",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // V homed
+    { "hom","homw",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // W homed
+    { "hom","homa",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // A homed
+    { "hom","homb",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // B homed
+    { "hom","homc",_i0, 0, cm_print_hom, cm_get_hom, set_ro, nullptr_void, 0 },    // C homed
+
+    { "prb","prbe",_i0, 0, tx_print_nul, cm_get_prob,set_ro, nullptr_void, 0 },    // ̽״̬
+    { "prb","prbx",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // X probe results
+    { "prb","prby",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // Y probe results
+    { "prb","prbz",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // Z probe results
+    { "prb","prbu",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // U probe results
+    { "prb","prbv",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // V probe results
+    { "prb","prbw",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // W probe results
+    { "prb","prba",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // A probe results
+    { "prb","prbb",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // B probe results
+    { "prb","prbc",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr_void, 0 },    // C probe results
+
+    { "jog","jogx",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in X axis
+    { "jog","jogy",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in Y axis
+    { "jog","jogz",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in Z axis
+    { "jog","jogu",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in U axis
+    { "jog","jogv",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in V axis
+    { "jog","jogw",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in W axis
+    { "jog","joga",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in A axis
+    { "jog","jogb",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in B axis
+    { "jog","jogc",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr_void, 0},    // jog in C axis
+
+    { "jgv","jgvx",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in X axis
+    { "jgv","jgvy",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in Y axis
+    { "jgv","jgvz",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in Z axis
+    { "jgv","jgvu",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in U axis
+    { "jgv","jgvv",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in V axis
+    { "jgv","jgvw",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in W axis
+    { "jgv","jgva",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in A axis
+    { "jgv","jgvb",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in B axis
+    { "jgv","jgvc",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr_void, 0},    // velocity jog in C axis
+
+	{ "pwr","pwr1",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},	  // motor power readouts
+	{ "pwr","pwr2",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},
+#if (MOTORS > 2)
+	{ "pwr","pwr3",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 3)
+	{ "pwr","pwr4",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 4)
+	{ "pwr","pwr5",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 5)
+	{ "pwr","pwr6",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr_void, 0},
+#endif
+
+	{ "ld","ld1",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},	  // smart driver load readouts
+	{ "ld","ld2",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},
+#if (MOTORS > 2)
+	{ "ld","ld3",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 3)
+	{ "ld","ld4",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 4)
+	{ "ld","ld5",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},
+#endif
+#if (MOTORS > 5)
+	{ "ld","ld6",_i0, 0, st_print_ld, st_get_ld, set_ro, nullptr_void, 0},
+#endif
+
+    // Motor parameters
+    { "1","1ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M1_MOTOR_MAP },
+    { "1","1sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M1_STEP_ANGLE },
+    { "1","1tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M1_TRAVEL_PER_REV },
+    { "1","1su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M1_STEPS_PER_UNIT },
+    { "1","1mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M1_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "1","1mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M1_COARSE_MICROSTEPS },
+#endif
+    { "1","1po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M1_POLARITY },
+    { "1","1pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M1_POWER_MODE },
+    { "1","1pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M1_POWER_LEVEL },
+    { "1","1ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M1_ENABLE_POLARITY },
+    { "1","1sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M1_STEP_POLARITY },
+    { "1","1bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M1_BACKLASH },
+    { "1","1sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M1_STALL_ACTION },
+//  { "1","1pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_1].power_idle,     M1_POWER_IDLE },
+//  { "1","1mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_1].motor_timeout,  M1_MOTOR_TIMEOUT },
+#if (MOTORS >= 2)
+    { "2","2ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M2_MOTOR_MAP },
+    { "2","2sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M2_STEP_ANGLE },
+    { "2","2tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M2_TRAVEL_PER_REV },
+    { "2","2su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M2_STEPS_PER_UNIT },
+    { "2","2mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M2_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "2","2mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M2_COARSE_MICROSTEPS },
+#endif
+    { "2","2po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M2_POLARITY },
+    { "2","2pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M2_POWER_MODE },
+    { "2","2pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M2_POWER_LEVEL},
+    { "2","2ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M2_ENABLE_POLARITY },
+    { "2","2sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M2_STEP_POLARITY },
+    { "2","2bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M2_BACKLASH },
+    { "2","2sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M2_STALL_ACTION },
+//  { "2","2pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_2].power_idle,     M2_POWER_IDLE },
+//  { "2","2mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt,  float *)&st_cfg.mot[MOTOR_2].motor_timeout,  M2_MOTOR_TIMEOUT },
+#endif
+#if (MOTORS >= 3)
+    { "3","3ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M3_MOTOR_MAP },
+    { "3","3sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M3_STEP_ANGLE },
+    { "3","3tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M3_TRAVEL_PER_REV },
+    { "3","3su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M3_STEPS_PER_UNIT },
+    { "3","3mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M3_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "3","3mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M3_COARSE_MICROSTEPS },
+#endif
+    { "3","3po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M3_POLARITY },
+    { "3","3pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M3_POWER_MODE },
+    { "3","3pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M3_POWER_LEVEL },
+    { "3","3ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M3_ENABLE_POLARITY },
+    { "3","3sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M3_STEP_POLARITY },
+    { "3","3bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M3_BACKLASH },
+    { "3","3sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M3_STALL_ACTION },
+//  { "3","3pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_3].power_idle,     M3_POWER_IDLE },
+//  { "3","3mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_3].motor_timeout,  M3_MOTOR_TIMEOUT },
+#endif
+#if (MOTORS >= 4)
+    { "4","4ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M4_MOTOR_MAP },
+    { "4","4sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M4_STEP_ANGLE },
+    { "4","4tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M4_TRAVEL_PER_REV },
+    { "4","4su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M4_STEPS_PER_UNIT },
+    { "4","4mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M4_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "4","4mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M4_COARSE_MICROSTEPS },
+#endif
+    { "4","4po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M4_POLARITY },
+    { "4","4pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M4_POWER_MODE },
+    { "4","4pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M4_POWER_LEVEL },
+    { "4","4ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M4_ENABLE_POLARITY },
+    { "4","4sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M4_STEP_POLARITY },
+    { "4","4bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M4_BACKLASH },
+    { "4","4sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M4_STALL_ACTION },
+//  { "4","4pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_4].power_idle,     M4_POWER_IDLE },
+//  { "4","4mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_4].motor_timeout,  M4_MOTOR_TIMEOUT },
+#endif
+#if (MOTORS >= 5)
+    { "5","5ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M5_MOTOR_MAP },
+    { "5","5sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M5_STEP_ANGLE },
+    { "5","5tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M5_TRAVEL_PER_REV },
+    { "5","5su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M5_STEPS_PER_UNIT },
+    { "5","5mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M5_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "5","5mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M5_COARSE_MICROSTEPS },
+#endif
+    { "5","5po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M5_POLARITY },
+    { "5","5pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M5_POWER_MODE },
+    { "5","5pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M5_POWER_LEVEL },
+    { "5","5ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M5_ENABLE_POLARITY },
+    { "5","5sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M5_STEP_POLARITY },
+    { "5","5bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M5_BACKLASH },
+    { "5","5sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M5_STALL_ACTION },
+//  { "5","5pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_5].power_idle,     M5_POWER_IDLE },
+//  { "5","5mt",_fip, 2, st_print_mt, get_flt, st_set_mt,   (float *)&st_cfg.mot[MOTOR_5].motor_timeout,  M5_MOTOR_TIMEOUT },
+#endif
+#if (MOTORS >= 6)
+    { "6","6ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr_void, M6_MOTOR_MAP },
+    { "6","6sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr_void, M6_STEP_ANGLE },
+    { "6","6tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr_void, M6_TRAVEL_PER_REV },
+    { "6","6su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr_void, M6_STEPS_PER_UNIT },
+    { "6","6mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr_void, M6_MICROSTEPS },
+#if DDA_MICROSTEP_SWITCH == true
+    { "6","6mc",_iip, 0, st_print_mc, st_get_mc, st_set_mc, nullptr_void, M6_COARSE_MICROSTEPS },
+#endif
+    { "6","6po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr_void, M6_POLARITY },
+    { "6","6pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr_void, M6_POWER_MODE },
+    { "6","6pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr_void, M6_POWER_LEVEL },
+    { "6","6ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr_void, M6_ENABLE_POLARITY },
+    { "6","6sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr_void, M6_STEP_POLARITY },
+    { "6","6bl",_fipc,4, st_print_bl, st_get_bl, st_set_bl, nullptr_void, M6_BACKLASH },
+    { "6","6sg",_iip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr_void, M6_STALL_ACTION },
+//  { "6","6pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_6].power_idle,     M6_POWER_IDLE },
+//  { "6","6mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_6].motor_timeout,  M6_MOTOR_TIMEOUT },
+// >>>>>>> refs/heads/edge
+#endif
+
+    // Axis parameters
+    { "x","xam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, X_AXIS_MODE },
+    { "x","xvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, X_VELOCITY_MAX },
+    { "x","xfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, X_FEEDRATE_MAX },
+    { "x","xtn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, X_TRAVEL_MIN },
+    { "x","xtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, X_TRAVEL_MAX },
+    { "x","xjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, X_JERK_MAX },
+    { "x","xjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, X_JERK_HIGH_SPEED },
+    { "x","xac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, X_ACCEL_MAX },
+    { "x","xhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, X_HOMING_INPUT },
+    { "x","xhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, X_HOMING_DIRECTION },
+    { "x","xsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, X_SEARCH_VELOCITY },
+    { "x","xlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, X_LATCH_VELOCITY },
+    { "x","xlb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, X_LATCH_BACKOFF },
+    { "x","xzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, X_ZERO_BACKOFF },
+    { "x","xsf",_fip,  1, sh_print_sf, sh_get_sf, sh_set_sf, nullptr_void, X_SHAPER_FREQUENCY },
+    { "x","xsd",_fip,  3, sh_print_sd, sh_get_sd, sh_set_sd, nullptr_void, X_SHAPER_DAMPING },
+    { "x","xst",_iip,  0, sh_print_st, sh_get_st, sh_set_st, nullptr_void, X_SHAPER_TYPE },
+
+    { "y","yam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, Y_AXIS_MODE },
+    { "y","yvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, Y_VELOCITY_MAX },
+    { "y","yfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, Y_FEEDRATE_MAX },
+    { "y","ytn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, Y_TRAVEL_MIN },
+    { "y","ytm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, Y_TRAVEL_MAX },
+    { "y","yjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, Y_JERK_MAX },
+    { "y","yjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, Y_JERK_HIGH_SPEED },
+    { "y","yac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, Y_ACCEL_MAX },
+    { "y","yhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, Y_HOMING_INPUT },
+    { "y","yhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, Y_HOMING_DIRECTION },
+    { "y","ysv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, Y_SEARCH_VELOCITY },
+    { "y","ylv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, Y_LATCH_VELOCITY },
+    { "y","ylb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, Y_LATCH_BACKOFF },
+    { "y","yzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, Y_ZERO_BACKOFF },
+    { "y","ysf",_fip,  1, sh_print_sf, sh_get_sf, sh_set_sf, nullptr_void, Y_SHAPER_FREQUENCY },
+    { "y","ysd",_fip,  3, sh_print_sd, sh_get_sd, sh_set_sd, nullptr_void, Y_SHAPER_DAMPING },
+    { "y","yst",_iip,  0, sh_print_st, sh_get_st, sh_set_st, nullptr_void, Y_SHAPER_TYPE },
+
+    { "z","zam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, Z_AXIS_MODE },
+    { "z","zvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, Z_VELOCITY_MAX },
+    { "z","zfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, Z_FEEDRATE_MAX },
+    { "z","ztn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, Z_TRAVEL_MIN },
+    { "z","ztm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, Z_TRAVEL_MAX },
+    { "z","zjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, Z_JERK_MAX },
+    { "z","zjh",_fipc, 0, cm_print_jh, cm_get_jm, cm_set_jh, nullptr_void, Z_JERK_HIGH_SPEED },
+    { "z","zac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, Z_ACCEL_MAX },
+    { "z","zhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, Z_HOMING_INPUT },
+    { "z","zhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, Z_HOMING_DIRECTION },
+    { "z","zsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, Z_SEARCH_VELOCITY },
+    { "z","zlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, Z_LATCH_VELOCITY },
+    { "z","zlb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, Z_LATCH_BACKOFF },
+    { "z","zzb",_fipc, 5, cm_print_zb, cm_get_lb, cm_set_zb, nullptr_void, Z_ZERO_BACKOFF },
+    { "z","zsf",_fip,  1, sh_print_sf, sh_get_sf, sh_set_sf, nullptr_void, Z_SHAPER_FREQUENCY },
+    { "z","zsd",_fip,  3, sh_print_sd, sh_get_sd, sh_set_sd, nullptr_void, Z_SHAPER_DAMPING },
+    { "z","zst",_iip,  0, sh_print_st, sh_get_st, sh_set_st, nullptr_void, Z_SHAPER_TYPE },
+
+    { "u","uam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, U_AXIS_MODE },
+    { "u","uvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, U_VELOCITY_MAX },
+    { "u","ufr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, U_FEEDRATE_MAX },
+    { "u","utn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, U_TRAVEL_MIN },
+    { "u","utm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, U_TRAVEL_MAX },
+    { "u","ujm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, U_JERK_MAX },
+    { "u","ujh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, U_JERK_HIGH_SPEED },
+    { "u","uac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, U_ACCEL_MAX },
+    { "u","uhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, U_HOMING_INPUT },
+    { "u","uhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, U_HOMING_DIRECTION },
+    { "u","usv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, U_SEARCH_VELOCITY },
+    { "u","ulv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, U_LATCH_VELOCITY },
+    { "u","ulb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, U_LATCH_BACKOFF },
+    { "u","uzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, U_ZERO_BACKOFF },
+
+    { "v","vam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, V_AXIS_MODE },
+    { "v","vvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, V_VELOCITY_MAX },
+    { "v","vfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, V_FEEDRATE_MAX },
+    { "v","vtn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, V_TRAVEL_MIN },
+    { "v","vtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, V_TRAVEL_MAX },
+    { "v","vjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, V_JERK_MAX },
+    { "v","vjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, V_JERK_HIGH_SPEED },
+    { "v","vac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, V_ACCEL_MAX },
+    { "v","vhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, V_HOMING_INPUT },
+    { "v","vhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, V_HOMING_DIRECTION },
+    { "v","vsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, V_SEARCH_VELOCITY },
+    { "v","vlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, V_LATCH_VELOCITY },
+    { "v","vlb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, V_LATCH_BACKOFF },
+    { "v","vzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, V_ZERO_BACKOFF },
+
+    { "w","wam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, W_AXIS_MODE },
+    { "w","wvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, W_VELOCITY_MAX },
+    { "w","wfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, W_FEEDRATE_MAX },
+    { "w","wtn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, W_TRAVEL_MIN },
+    { "w","wtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, W_TRAVEL_MAX },
+    { "w","wjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, W_JERK_MAX },
+    { "w","wjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, W_JERK_HIGH_SPEED },
+    { "w","wac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, W_ACCEL_MAX },
+    { "w","whi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, W_HOMING_INPUT },
+    { "w","whd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, W_HOMING_DIRECTION },
+    { "w","wsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, W_SEARCH_VELOCITY },
+    { "w","wlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, W_LATCH_VELOCITY },
+    { "w","wlb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, W_LATCH_BACKOFF },
+    { "w","wzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, W_ZERO_BACKOFF },
+
+    { "a","aam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, A_AXIS_MODE },
+    { "a","avm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, A_VELOCITY_MAX },
+    { "a","afr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, A_FEEDRATE_MAX },
+    { "a","atn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, A_TRAVEL_MIN },
+    { "a","atm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, A_TRAVEL_MAX },
+    { "a","ajm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, A_JERK_MAX },
+    { "a","ajh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, A_JERK_HIGH_SPEED },
+    { "a","aac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, A_ACCEL_MAX },
+    { "a","ara",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr_void, A_RADIUS},
+    { "a","ahi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, A_HOMING_INPUT },
+    { "a","ahd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, A_HOMING_DIRECTION },
+    { "a","asv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, A_SEARCH_VELOCITY },
+    { "a","alv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, A_LATCH_VELOCITY },
+    { "a","alb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, A_LATCH_BACKOFF },
+    { "a","azb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, A_ZERO_BACKOFF },
+
+    { "b","bam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, B_AXIS_MODE },
+    { "b","bvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, B_VELOCITY_MAX },
+    { "b","bfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, B_FEEDRATE_MAX },
+    { "b","btn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, B_TRAVEL_MIN },
+    { "b","btm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, B_TRAVEL_MAX },
+    { "b","bjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, B_JERK_MAX },
+    { "b","bjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, B_JERK_HIGH_SPEED },
+    { "b","bac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, B_ACCEL_MAX },
+    { "b","bra",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr_void, B_RADIUS },
+    { "b","bhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, B_HOMING_INPUT },
+    { "b","bhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, B_HOMING_DIRECTION },
+    { "b","bsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, B_SEARCH_VELOCITY },
+    { "b","blv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, B_LATCH_VELOCITY },
+    { "b","blb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, B_LATCH_BACKOFF },
+    { "b","bzb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, B_ZERO_BACKOFF },
+
+    { "c","cam",_iip,  0, cm_print_am, cm_get_am, cm_set_am, nullptr_void, C_AXIS_MODE },
+    { "c","cvm",_fipc, 0, cm_print_vm, cm_get_vm, cm_set_vm, nullptr_void, C_VELOCITY_MAX },
+    { "c","cfr",_fipc, 0, cm_print_fr, cm_get_fr, cm_set_fr, nullptr_void, C_FEEDRATE_MAX },
+    { "c","ctn",_fipc, 5, cm_print_tn, cm_get_tn, cm_set_tn, nullptr_void, C_TRAVEL_MIN },
+    { "c","ctm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr_void, C_TRAVEL_MAX },
+    { "c","cjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr_void, C_JERK_MAX },
+    { "c","cjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr_void, C_JERK_HIGH_SPEED },
+    { "c","cac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr_void, C_ACCEL_MAX },
+    { "c","cra",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr_void, C_RADIUS },
+    { "c","chi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr_void, C_HOMING_INPUT },
+    { "c","chd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr_void, C_HOMING_DIRECTION },
+    { "c","csv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr_void, C_SEARCH_VELOCITY },
+    { "c","clv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr_void, C_LATCH_VELOCITY },
+    { "c","clb",_fipc, 5, cm_print_lb, cm_get_lb, cm_set_lb, nullptr_void, C_LATCH_BACKOFF },
+    { "c","czb",_fipc, 5, cm_print_zb, cm_get_zb, cm_set_zb, nullptr_void, C_ZERO_BACKOFF },
+
+    // Digital input configs
+    { "di1","di1mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI1_MODE },
+    { "di1","di1ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI1_ACTION },
+    { "di1","di1fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI1_FUNCTION },
+
+    { "di2","di2mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI2_MODE },
+    { "di2","di2ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI2_ACTION },
+    { "di2","di2fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI2_FUNCTION },
+
+    { "di3","di3mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI3_MODE },
+    { "di3","di3ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI3_ACTION },
+    { "di3","di3fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI3_FUNCTION },
+
+    { "di4","di4mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI4_MODE },
+    { "di4","di4ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI4_ACTION },
+    { "di4","di4fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI4_FUNCTION },
+
+    { "di5","di5mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI5_MODE },
+    { "di5","di5ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI5_ACTION },
+    { "di5","di5fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI5_FUNCTION },
+
+    { "di6","di6mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI6_MODE },
+    { "di6","di6ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI6_ACTION },
+    { "di6","di6fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI6_FUNCTION },
+
+    { "di7","di7mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI7_MODE },
+    { "di7","di7ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI7_ACTION },
+    { "di7","di7fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI7_FUNCTION },
+
+    { "di8","di8mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI8_MODE },
+    { "di8","di8ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI8_ACTION },
+    { "di8","di8fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI8_FUNCTION },
+#if (D_IN_CHANNELS >= 9)
+    { "di9","di9mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI9_MODE },
+    { "di9","di9ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI9_ACTION },
+    { "di9","di9fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI9_FUNCTION },
+#endif
+#if (D_IN_CHANNELS >= 10)
+    { "di10","di10mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI10_MODE },
+    { "di10","di10ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI10_ACTION },
+    { "di10","di10fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI10_FUNCTION },
+#endif
+#if (D_IN_CHANNELS >= 11)
+    { "di11","di11mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI1_MODE },
+    { "di11","di11ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI11_ACTION },
+    { "di11","di11fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI11_FUNCTION },
+#endif
+#if (D_IN_CHANNELS >= 12)
+    { "di12","di12mo",_iip, 0, io_print_mo, io_get_mo, io_set_mo, nullptr_void, DI12_MODE },
+    { "di12","di12ac",_iip, 0, io_print_ac, io_get_ac, io_set_ac, nullptr_void, DI12_ACTION },
+    { "di12","di12fn",_iip, 0, io_print_fn, io_get_fn, io_set_fn, nullptr_void, DI12_FUNCTION },
+#endif
+
+    // Digital input state readers
+    { "in","in1", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in2", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in3", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in4", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in5", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in6", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in7", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+    { "in","in8", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+#if (D_IN_CHANNELS >= 9)
+    { "in","in9", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+#endif
+#if (D_IN_CHANNELS >= 10)
+    { "in","in10", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+#endif
+#if (D_IN_CHANNELS >= 11)
+    { "in","in11", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+#endif
+#if (D_IN_CHANNELS >= 12)
+    { "in","in12", _i0, 0, io_print_in, io_get_input, set_ro, nullptr_void, 0 },
+#endif
+    { "","inm", _i0, 0, io_print_inm, io_get_inputs, set_ro, nullptr_void, 0 },   // all input states as one bitmask
+
+    // digital output configs
+    { "do1", "do1mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO1_MODE },
+    { "do2", "do2mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO2_MODE },
+    { "do3", "do3mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO3_MODE },
+    { "do4", "do4mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO4_MODE },
+    { "do5", "do5mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO5_MODE },
+    { "do6", "do6mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO6_MODE },
+    { "do7", "do7mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO7_MODE },
+    { "do8", "do8mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO8_MODE },
+    { "do9", "do9mo", _iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO9_MODE },
+    { "do10","do10mo",_iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO10_MODE },
+    { "do11","do11mo",_iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO11_MODE },
+    { "do12","do12mo",_iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO12_MODE },
+    { "do13","do13mo",_iip, 0, io_print_domode, io_get_domode, io_set_domode, nullptr_void, DO13_MODE },
+
+    // Digital output state readers (default to non-active)
+    { "out","out1",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out2",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out3",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out4",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out5",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out6",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out7",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out8",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out9",  _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out10", _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out11", _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+    { "out","out12", _i0, 2, io_print_out, io_get_output, io_set_output, nullptr_void, 0 },
+
+    // PWM settings
+    { "p1","p1frq",_fip, 0, pwm_print_p1frq, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].frequency,    P1_PWM_FREQUENCY },
+    { "p1","p1csl",_fip, 0, pwm_print_p1csl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].cw_speed_lo,  P1_CW_SPEED_LO },
+    { "p1","p1csh",_fip, 0, pwm_print_p1csh, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].cw_speed_hi,  P1_CW_SPEED_HI },
+    { "p1","p1cpl",_fip, 3, pwm_print_p1cpl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].cw_phase_lo,  P1_CW_PHASE_LO },
+    { "p1","p1cph",_fip, 3, pwm_print_p1cph, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].cw_phase_hi,  P1_CW_PHASE_HI },
+    { "p1","p1wsl",_fip, 0, pwm_print_p1wsl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_speed_lo, P1_CCW_SPEED_LO },
+    { "p1","p1wsh",_fip, 0, pwm_print_p1wsh, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_speed_hi, P1_CCW_SPEED_HI },
+    { "p1","p1wpl",_fip, 3, pwm_print_p1wpl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_phase_lo, P1_CCW_PHASE_LO },
+    { "p1","p1wph",_fip, 3, pwm_print_p1wph, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_phase_hi, P1_CCW_PHASE_HI },
+    { "p1","p1pof",_fip, 3, pwm_print_p1pof, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].phase_off,    P1_PWM_PHASE_OFF },
+
+#if TEMPERATURE_ENABLED == true
+    // temperature configs - pid active values (read-only)
+    // NOTICE: If you change these PID group keys, you MUST change the get/set functions too!
+    { "pid1","pid1p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr_void, 0 },
+    { "pid1","pid1i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr_void, 0 },
+    { "pid1","pid1d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr_void, 0 },
+
+    { "pid2","pid2p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr_void, 0 },
+    { "pid2","pid2i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr_void, 0 },
+    { "pid2","pid2d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr_void, 0 },
+
+    { "pid3","pid3p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr_void, 0 },
+    { "pid3","pid3i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr_void, 0 },
+    { "pid3","pid3d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr_void, 0 },
+
+    // temperature configs - heater set values (read-write)
+    // NOTICE: If you change these heater group keys, you MUST change the get/set functions too!
+    { "he1","he1e", _bip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr_void, H1_DEFAULT_ENABLE },
+    { "he1","he1at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr_void, 0 },
+    { "he1","he1p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr_void, H1_DEFAULT_P },
+    { "he1","he1i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr_void, H1_DEFAULT_I },
+    { "he1","he1d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr_void, H1_DEFAULT_D },
+    { "he1","he1st",_fi,  1, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr_void, 0 },
+    { "he1","he1t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr_void, 0 },
+    { "he1","he1op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr_void, 0 },
+    { "he1","he1tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr_void, 0 },
+    { "he1","he1an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr_void, 0 },
+    { "he1","he1fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr_void, 0 },
+    { "he1","he1fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr_void, 0 },
+    { "he1","he1fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr_void, 0 },
+    { "he1","he1fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr_void, 0 },
+
+    { "he2","he2e", _iip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr_void, H2_DEFAULT_ENABLE },
+    { "he2","he2at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr_void, 0 },
+    { "he2","he2p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr_void, H2_DEFAULT_P },
+    { "he2","he2i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr_void, H2_DEFAULT_I },
+    { "he2","he2d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr_void, H2_DEFAULT_D },
+    { "he2","he2st",_fi,  0, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr_void, 0 },
+    { "he2","he2t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr_void, 0 },
+    { "he2","he2op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr_void, 0 },
+    { "he2","he2tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr_void, 0 },
+    { "he2","he2an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr_void, 0 },
+    { "he2","he2fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr_void, 0 },
+    { "he2","he2fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr_void, 0 },
+    { "he2","he2fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr_void, 0 },
+    { "he2","he2fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr_void, 0 },
+
+    { "he3","he3e", _iip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr_void, H3_DEFAULT_ENABLE },
+    { "he3","he3at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr_void, 0 },
+    { "he3","he3p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr_void, H3_DEFAULT_P },
+    { "he3","he3i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr_void, H3_DEFAULT_I },
+    { "he3","he3d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr_void, H3_DEFAULT_D },
+    { "he3","he3st",_fi,  0, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr_void, 0 },
+    { "he3","he3t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr_void, 0 },
+    { "he3","he3op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr_void, 0 },
+    { "he3","he3tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr_void, 0 },
+    { "he3","he3an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr_void, 0 },
+    { "he3","he3fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr_void, 0 },
+    { "he3","he3fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr_void, 0 },
+    { "he3","he3fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr_void, 0 },
+    { "he3","he3fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr_void, 0 },
+#endif
+
+    // Coordinate system offsets (G54-G59 and G92)
+    { "g54","g54x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_X_OFFSET },
+    { "g54","g54y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_Y_OFFSET },
+    { "g54","g54z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_Z_OFFSET },
+    { "g54","g54u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_U_OFFSET },
+    { "g54","g54v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_V_OFFSET },
+    { "g54","g54w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_W_OFFSET },
+    { "g54","g54a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_A_OFFSET },
+    { "g54","g54b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_B_OFFSET },
+    { "g54","g54c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G54_C_OFFSET },
+
+    { "g55","g55x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_X_OFFSET },
+    { "g55","g55y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_Y_OFFSET },
+    { "g55","g55z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_Z_OFFSET },
+    { "g55","g55u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_U_OFFSET },
+    { "g55","g55v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_V_OFFSET },
+    { "g55","g55w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_W_OFFSET },
+    { "g55","g55a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_A_OFFSET },
+    { "g55","g55b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_B_OFFSET },
+    { "g55","g55c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G55_C_OFFSET },
+
+    { "g56","g56x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_X_OFFSET },
+    { "g56","g56y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_Y_OFFSET },
+    { "g56","g56z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_Z_OFFSET },
+    { "g56","g56u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_U_OFFSET },
+    { "g56","g56v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_V_OFFSET },
+    { "g56","g56w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_W_OFFSET },
+    { "g56","g56a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_A_OFFSET },
+    { "g56","g56b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_B_OFFSET },
+    { "g56","g56c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G56_C_OFFSET },
+
+    { "g57","g57x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_X_OFFSET },
+    { "g57","g57y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_Y_OFFSET },
+    { "g57","g57z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_Z_OFFSET },
+    { "g57","g57u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_U_OFFSET },
+    { "g57","g57v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_V_OFFSET },
+    { "g57","g57w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_W_OFFSET },
+    { "g57","g57a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_A_OFFSET },
+    { "g57","g57b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_B_OFFSET },
+    { "g57","g57c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G57_C_OFFSET },
+
+    { "g58","g58x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_X_OFFSET },
+    { "g58","g58y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_Y_OFFSET },
+    { "g58","g58z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_Z_OFFSET },
+    { "g58","g58u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_U_OFFSET },
+    { "g58","g58v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_V_OFFSET },
+    { "g58","g58w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_W_OFFSET },
+    { "g58","g58a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_A_OFFSET },
+    { "g58","g58b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_B_OFFSET },
+    { "g58","g58c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G58_C_OFFSET },
+
+    { "g59","g59x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_X_OFFSET },
+    { "g59","g59y",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_Y_OFFSET },
+    { "g59","g59z",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_Z_OFFSET },
+    { "g59","g59u",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_U_OFFSET },
+    { "g59","g59v",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_V_OFFSET },
+    { "g59","g59w",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_W_OFFSET },
+    { "g59","g59a",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_A_OFFSET },
+    { "g59","g59b",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_B_OFFSET },
+    { "g59","g59c",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr_void, G59_C_OFFSET },
+
+    { "g92","g92x",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },// G92 handled differently
+    { "g92","g92y",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92z",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92u",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92v",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92w",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92a",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92b",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+    { "g92","g92c",_fic, 5, cm_print_cofs, cm_get_g92, set_ro, nullptr_void, 0 },
+
+    // Coordinate positions (G28, G30)
+    { "g28","g28x",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },// g28 handled differently
+    { "g28","g28y",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28z",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28u",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28v",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28w",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28a",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28b",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+    { "g28","g28c",_fic, 5, cm_print_cpos, cm_get_g28, set_ro, nullptr_void, 0 },
+
+    { "g30","g30x",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },// g30 handled differently
+    { "g30","g30y",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30z",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30u",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30v",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30w",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30a",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30b",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+    { "g30","g30c",_fic, 5, cm_print_cpos, cm_get_g30, set_ro, nullptr_void, 0 },
+
+    // this is a 128bit UUID for identifying a previously committed job state
+    { "jid","jida",_d0, 0, tx_print_nul, get_data, set_data, &cfg.job_id[0], 0 },
+    { "jid","jidb",_d0, 0, tx_print_nul, get_data, set_data, &cfg.job_id[1], 0 },
+    { "jid","jidc",_d0, 0, tx_print_nul, get_data, set_data, &cfg.job_id[2], 0 },
+    { "jid","jidd",_d0, 0, tx_print_nul, get_data, set_data, &cfg.job_id[3], 0 },
+
+    // Interrupt cycle-budget profiling (min/mean/max cycles per region)
+    { "prof","profdn",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profda",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profdx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profen",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profea",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profex",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","proffn",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","proffa",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","proffx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profpn",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profpa",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profpx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profln",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profla",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","proflx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profkn",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profka",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profkx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profbn",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profba",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profbx",_i0, 0, prof_print_stat, prof_get_stat, set_ro, nullptr_void, 0 },
+    { "prof","profov",_i0, 0, prof_print_ov,   prof_get_ov,   prof_set_ov, nullptr_void, 0 },
+    { "prof","profhz",_i0, 0, prof_print_hz,   prof_get_hz,   set_ro, nullptr_void, 0 },
+
+    // RAM footprint and stack usage (see memory_usage.h)
+    { "mem","memq", _i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memmp",_i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memcm",_i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memnv",_i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memrx",_i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memtx",_i0, 0, mem_print_bytes, mem_get_size,  set_ro, nullptr_void, 0 },
+    { "mem","memst",_i0, 0, mem_print_bytes, mem_get_stack, set_ro, nullptr_void, 0 },
+    { "mem","memfr",_i0, 0, mem_print_bytes, mem_get_stack, set_ro, nullptr_void, 0 },
+    { "mem","memsd",_i0, 0, mem_print_bytes, mem_get_stack, set_ro, nullptr_void, 0 },
+    { "mem","memse",_i0, 0, mem_print_bytes, mem_get_stack, set_ro, nullptr_void, 0 },
+    { "mem","memsf",_i0, 0, mem_print_bytes, mem_get_stack, set_ro, nullptr_void, 0 },
+
+    // Following error log (commanded vs. encoder steps per segment, see encoder.h)
+    { "enl","enlst",_i0, 0, en_print_enlst, en_get_enlst, en_set_enlst, nullptr_void, 0 },
+    { "enl","enlov",_i0, 0, en_print_enlov, en_get_enlov, en_set_enlov, nullptr_void, 0 },
+
+    // Measured velocity and acceleration from the encoders (see encoder.h)
+    { "vm","vmpk", _f0, 2, en_print_vm, en_get_vm, set_ro, nullptr_void, 0 },
+    { "vm","vmmn", _f0, 2, en_print_vm, en_get_vm, set_ro, nullptr_void, 0 },
+    { "vm","vmpl", _f0, 2, en_print_vm, en_get_vm, set_ro, nullptr_void, 0 },
+    { "vm","vmac", _f0, 2, en_print_vm, en_get_vm, set_ro, nullptr_void, 0 },
+
+    // Spindle functions
+    { "sp","spmo", _iip, 0, sp_print_spmo, sp_get_spmo, sp_set_spmo, nullptr_void, SPINDLE_MODE },
+    { "sp","spph", _bip, 0, sp_print_spph, sp_get_spph, sp_set_spph, nullptr_void, SPINDLE_PAUSE_ON_HOLD },
+    { "sp","spde", _fip, 2, sp_print_spde, sp_get_spde, sp_set_spde, nullptr_void, SPINDLE_SPINUP_DELAY },
+    { "sp","spdy", _bip, 0, sp_print_spdy, sp_get_spdy, sp_set_spdy, nullptr_void, SPINDLE_DYNAMIC_POWER },
+    { "sp","spas", _iip, 0, sp_print_spas, sp_get_spas, sp_set_spas, nullptr_void, SPINDLE_AT_SPEED_INPUT },
+    { "sp","spea", _iip, 0, sp_print_spea, sp_get_spea, sp_set_spea, nullptr_void, SPINDLE_ENCODER_INPUT_A },
+    { "sp","speb", _iip, 0, sp_print_speb, sp_get_speb, sp_set_speb, nullptr_void, SPINDLE_ENCODER_INPUT_B },
+    { "sp","sppr", _iip, 0, sp_print_sppr, sp_get_sppr, sp_set_sppr, nullptr_void, SPINDLE_ENCODER_PPR },
+    { "sp","spsa", _fip, 0, sp_print_spsa, sp_get_spsa, sp_set_spsa, nullptr_void, SPINDLE_SYNC_ACCEL },
+    { "sp","spsn", _fip, 2, sp_print_spsn, sp_get_spsn, sp_set_spsn, nullptr_void, SPINDLE_SPEED_MIN},
+    { "sp","spsm", _fip, 2, sp_print_spsm, sp_get_spsm, sp_set_spsm, nullptr_void, SPINDLE_SPEED_MAX},
+    { "sp","spep", _iip, 0, sp_print_spep, sp_get_spep, sp_set_spep, nullptr_void, SPINDLE_ENABLE_POLARITY },
+    { "sp","spdp", _iip, 0, sp_print_spdp, sp_get_spdp, sp_set_spdp, nullptr_void, SPINDLE_DIR_POLARITY },
+    { "sp","spoe", _bip, 0, sp_print_spoe, sp_get_spoe, sp_set_spoe, nullptr_void, SPINDLE_OVERRIDE_ENABLE},
+    { "sp","spo",  _fip, 3, sp_print_spo,  sp_get_spo,  sp_set_spo,  nullptr_void, SPINDLE_OVERRIDE_FACTOR},
+    { "sp","spc",  _i0,  0, sp_print_spc,  sp_get_spc,  sp_set_spc,  nullptr_void, 0 },   // spindle state
+    { "sp","sps",  _f0,  0, sp_print_sps,  sp_get_sps,  sp_set_sps,  nullptr_void, 0 },   // spindle speed
+
+    // Coolant functions
+    { "co","coph", _bip, 0, co_print_coph, co_get_coph, co_set_coph, nullptr_void, COOLANT_PAUSE_ON_HOLD },
+    { "co","comp", _iip, 0, co_print_comp, co_get_comp, co_set_comp, nullptr_void, COOLANT_MIST_POLARITY },
+    { "co","cofp", _iip, 0, co_print_cofp, co_get_cofp, co_set_cofp, nullptr_void, COOLANT_FLOOD_POLARITY },
+    { "co","com",  _i0,  0, co_print_com,  co_get_com,  co_set_com,  nullptr_void, 0 },   // mist coolant enable
+    { "co","cof",  _i0,  0, co_print_cof,  co_get_cof,  co_set_cof,  nullptr_void, 0 },   // flood coolant enable
+
+    // Multi-board sync
+    { "sy","symo", _iip, 0, sy_print_symo, sy_get_symo, sy_set_symo, nullptr_void, SYNC_MODE },
+    { "sy","syti", _iip, 0, sy_print_in,   sy_get_in,   sy_set_in,   nullptr_void, SYNC_TICK_INPUT },
+    { "sy","syto", _iip, 0, sy_print_out,  sy_get_out,  sy_set_out,  nullptr_void, SYNC_TICK_OUTPUT },
+    { "sy","syhi", _iip, 0, sy_print_in,   sy_get_in,   sy_set_in,   nullptr_void, SYNC_HOLD_INPUT },
+    { "sy","syho", _iip, 0, sy_print_out,  sy_get_out,  sy_set_out,  nullptr_void, SYNC_HOLD_OUTPUT },
+    { "sy","syai", _iip, 0, sy_print_in,   sy_get_in,   sy_set_in,   nullptr_void, SYNC_ALARM_INPUT },
+    { "sy","syao", _iip, 0, sy_print_out,  sy_get_out,  sy_set_out,  nullptr_void, SYNC_ALARM_OUTPUT },
+
+    // Torch height control
+    { "thc","thce",_bip, 0, thc_print_thce, thc_get_thce, thc_set_thce, nullptr_void, THC_ENABLE },
+    { "thc","thcv",_fip, 1, thc_print_thcv, thc_get_thcv, thc_set_thcv, nullptr_void, THC_TARGET_VOLTS },
+    { "thc","thcs",_fip, 1, thc_print_thcs, thc_get_thcs, thc_set_thcs, nullptr_void, THC_VOLTS_FULL_SCALE },
+    { "thc","thcp",_fip, 4, thc_print_thcp, thc_get_thcp, thc_set_thcp, nullptr_void, THC_P_FACTOR },
+    { "thc","thci",_fip, 4, thc_print_thci, thc_get_thci, thc_set_thci, nullptr_void, THC_I_FACTOR },
+    { "thc","thcd",_fip, 4, thc_print_thcd, thc_get_thcd, thc_set_thcd, nullptr_void, THC_D_FACTOR },
+    { "thc","thcm",_fip, 3, thc_print_thcm, thc_get_thcm, thc_set_thcm, nullptr_void, THC_MAX_CORRECTION },
+    { "thc","thcr",_fip, 1, thc_print_thcr, thc_get_thcr, thc_set_thcr, nullptr_void, THC_MAX_RATE },
+    { "thc","thca",_fip, 2, thc_print_thca, thc_get_thca, thc_set_thca, nullptr_void, THC_ANTI_DIVE },
+    { "thc","thcw",_fip, 2, thc_print_thcw, thc_get_thcw, thc_set_thcw, nullptr_void, THC_ARC_DELAY },
+    { "thc","thcu",_f0,  1, thc_print_thcu, thc_get_thcu, set_ro,       nullptr_void, 0 },   // measured arc voltage
+    { "thc","thcz",_f0,  3, thc_print_thcz, thc_get_thcz, set_ro,       nullptr_void, 0 },   // Z correction in effect
+
+    // General system parameters
+    { "sys","jt",  _fipn, 2, cm_print_jt,  cm_get_jt,  cm_set_jt,  nullptr_void, JUNCTION_INTEGRATION_TIME },
+    { "sys","ct",  _fipnc,4, cm_print_ct,  cm_get_ct,  cm_set_ct,  nullptr_void, CHORDAL_TOLERANCE },
+    { "sys","kin", _iipn, 0, kn_print_kin, kn_get_kin, kn_set_kin, nullptr_void, KINEMATICS },
+    { "sys","kdr", _fipn, 3, kn_print_kdr, kn_get_kdr, kn_set_kdr, nullptr_void, KINEMATICS_DELTA_RADIUS },
+    { "sys","kdl", _fipn, 3, kn_print_kdl, kn_get_kdl, kn_set_kdl, nullptr_void, KINEMATICS_DELTA_ROD },
+    { "sys","krp", _fipn, 3, kn_print_krp, kn_get_krp, kn_set_krp, nullptr_void, KINEMATICS_RTCP_PIVOT },
+    { "sys","mshx",_fipn, 3, kn_print_mshx,kn_get_mshx,kn_set_mshx,nullptr_void, MESH_ORIGIN_X },
+    { "sys","mshy",_fipn, 3, kn_print_mshy,kn_get_mshy,kn_set_mshy,nullptr_void, MESH_ORIGIN_Y },
+    { "sys","mshi",_fipn, 3, kn_print_mshi,kn_get_mshi,kn_set_mshi,nullptr_void, MESH_SIZE_X },
+    { "sys","mshj",_fipn, 3, kn_print_mshj,kn_get_mshj,kn_set_mshj,nullptr_void, MESH_SIZE_Y },
+    { "sys","mshn",_iipn, 0, kn_print_mshn,kn_get_mshn,kn_set_mshn,nullptr_void, MESH_POINTS },
+    { "sys","mshz",_fipn, 3, kn_print_mshz,kn_get_mshz,kn_set_mshz,nullptr_void, MESH_PROBE_Z },
+    { "sys","mshc",_fipn, 3, kn_print_mshc,kn_get_mshc,kn_set_mshc,nullptr_void, MESH_CLEARANCE_Z },
+    { "sys","mshe",_bipn, 0, kn_print_mshe,kn_get_mshe,kn_set_mshe,nullptr_void, MESH_ENABLE },
+    { "sys","zl",  _fipnc,3, cm_print_zl,  cm_get_zl,  cm_set_zl,  nullptr_void, FEEDHOLD_Z_LIFT },
+    { "sys","tru", _bipn, 0, cm_print_tru, cm_get_tru, cm_set_tru, nullptr_void, TRAVERSE_UNCOORDINATED },
+    { "sys","sl",  _bipn, 0, cm_print_sl,  cm_get_sl,  cm_set_sl,  nullptr_void, SOFT_LIMIT_ENABLE },
+    { "sys","lim", _bipn, 0, cm_print_lim, cm_get_lim, cm_set_lim, nullptr_void, HARD_LIMIT_ENABLE },
+    { "sys","saf", _bipn, 0, cm_print_saf, cm_get_saf, cm_set_saf, nullptr_void, SAFETY_INTERLOCK_ENABLE },
+    { "sys","m48", _bin, 0, cm_print_m48,  cm_get_m48, cm_get_m48, nullptr_void, 1 },   // M48/M49 feedrate & spindle override enable
+    { "sys","froe",_bin, 0, cm_print_froe, cm_get_froe,cm_get_froe,nullptr_void, FEED_OVERRIDE_ENABLE},
+    { "sys","fro", _fin, 3, cm_print_fro,  cm_get_fro, cm_set_fro, nullptr_void, FEED_OVERRIDE_FACTOR},
+    { "sys","troe",_bin, 0, cm_print_troe, cm_get_troe,cm_get_troe,nullptr_void, TRAVERSE_OVERRIDE_ENABLE},
+    { "sys","tro", _fin, 3, cm_print_tro,  cm_get_tro, cm_set_tro, nullptr_void, TRAVERSE_OVERRIDE_FACTOR},
+    { "sys","mt",  _fipn, 2, st_print_mt,  st_get_mt,  st_set_mt,  nullptr_void, MOTOR_POWER_TIMEOUT}, // N is seconds of timeout
+    { "",   "me",  _f0,   0, st_print_me,  get_nul,    st_set_me,  nullptr_void, 0 },    // SET to enable motors
+    { "",   "md",  _f0,   0, st_print_md,  get_nul,    st_set_md,  nullptr_void, 0 },    // SET to disable motors
+
+    // Communications and reporting parameters
+#ifdef __TEXT_MODE
+    { "sys","tv", _iipn, 0, tx_print_tv, txt_get_tv, txt_set_tv, nullptr_void, TEXT_VERBOSITY },
+#endif
+    { "sys","ej", _iipn, 0, js_print_ej,  js_get_ej, js_set_ej, nullptr_void, COMM_MODE },
+    { "sys","jv", _iipn, 0, js_print_jv,  js_get_jv, js_set_jv, nullptr_void, JSON_VERBOSITY },
+    { "sys","qv", _iipn, 0, qr_print_qv,  qr_get_qv, qr_set_qv, nullptr_void, QUEUE_REPORT_VERBOSITY },
+    { "sys","sv", _iipn, 0, sr_print_sv,  sr_get_sv, sr_set_sv, nullptr_void, STATUS_REPORT_VERBOSITY },
+    { "sys","si", _iipn, 0, sr_print_si,  sr_get_si, sr_set_si, nullptr_void, STATUS_REPORT_INTERVAL_MS },
+    { "sys","sa", _bipn, 0, sr_print_sa,  sr_get_sa, sr_set_sa, nullptr_void, STATUS_REPORT_ADAPTIVE },
+    { "sys","sbi",_iipn, 0, sr_print_sbi, sr_get_sbi,sr_set_sbi,nullptr_void, STATUS_REPORT_BINARY_MS },
+
+    // Gcode defaults
+    // NOTE: The ordering within the gcode defaults is important for token resolution. gc must follow gco
+    { "sys","gpl", _iipn, 0, cm_print_gpl, cm_get_gpl, cm_set_gpl, nullptr_void, GCODE_DEFAULT_PLANE },
+    { "sys","gun", _iipn, 0, cm_print_gun, cm_get_gun, cm_set_gun, nullptr_void, GCODE_DEFAULT_UNITS },
+    { "sys","gco", _iipn, 0, cm_print_gco, cm_get_gco, cm_set_gco, nullptr_void, GCODE_DEFAULT_COORD_SYSTEM },
+    { "sys","gpa", _iipn, 0, cm_print_gpa, cm_get_gpa, cm_set_gpa, nullptr_void, GCODE_DEFAULT_PATH_CONTROL },
+    { "sys","gdi", _iipn, 0, cm_print_gdi, cm_get_gdi, cm_set_gdi, nullptr_void, GCODE_DEFAULT_DISTANCE_MODE },
+    { "",   "gc2", _s0,   0, tx_print_nul, gc_get_gc,  gc_run_gc,  nullptr_void, 0 },  // send gcode to secondary planner
+    { "",   "gc",  _s0,   0, tx_print_nul, gc_get_gc,  gc_run_gc,  nullptr_void, 0 },  // gcode block - must be last in this group
+
+    // Actions and Reports
+    { "", "sr",   _n0, 0, sr_print_sr,   sr_get,    sr_set,    nullptr_void, 0 },    // request and set status reports
+    { "", "qr",   _n0, 0, qr_print_qr,   qr_get,    set_nul,   nullptr_void, 0 },    // get queue value - planner buffers available
+    { "", "qi",   _n0, 0, qr_print_qi,   qi_get,    set_nul,   nullptr_void, 0 },    // get queue value - buffers added to queue
+    { "", "crm",  _i0, 0, qr_print_crm,  qr_get_crm, qr_set_crm, nullptr_void, 0 },   // stream on RX credits (not persisted)
+    { "", "qo",   _n0, 0, qr_print_qo,   qo_get,    set_nul,   nullptr_void, 0 },    // get queue value - buffers removed from queue
+    { "", "qt",   _n0, 0, qr_print_qt,   qt_get,    set_nul,   nullptr_void, 0 },    // get queue value - planned time in queue (ms)
+    { "", "qtr",  _n0, 0, qr_print_qtr,  qtr_get,   set_nul,   nullptr_void, 0 },    // get queue value - run time remaining (ms)
+    { "", "qmn",  _n0, 0, qr_print_qmn,  qmn_get,   set_nul,   nullptr_void, 0 },    // get queue value - fewest buffers queued
+    { "", "qmx",  _n0, 0, qr_print_qmx,  qmx_get,   set_nul,   nullptr_void, 0 },    // get queue value - most buffers queued
+    { "", "qst",  _n0, 0, qr_print_qst,  qst_get,   set_nul,   nullptr_void, 0 },    // get queue value - planner starved (block timeouts)
+    { "", "qbp",  _n0, 0, qr_print_qbp,  qbp_get,   set_nul,   nullptr_void, 0 },    // get queue value - blocks back-planned
+    { "", "pdg",  _i0, 0, mp_print_pdg,  mp_get_pdg, mp_set_pdg, nullptr_void, 0 },  // planner diagnostics enable (not persisted)
+    { "", "pdd",  _n0, 0, mp_print_pdd,  mp_get_pdd, set_nul,  nullptr_void, 0 },    // planner diagnostics records - text mode lists the ring
+    { "", "er",   _n0, 0, tx_print_nul,  rpt_er,    set_nul,   nullptr_void, 0 },    // get bogus exception report for testing
+    { "", "rx",   _n0, 0, tx_print_int,  get_rx,    set_nul,   nullptr_void, 0 },    // get RX buffer bytes or packets
+    { "", "rxhx", _n0, 0, tx_print_int,  xio_get_rxhx, set_nul,nullptr_void, 0 },    // get RX line header exhaustion count
+    { "xio","xiorb",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // bytes received
+    { "xio","xiotb",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // bytes written
+    { "xio","xiors",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // RX stalls (host NAKed)
+    { "xio","xiohw",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // RX ring high-water (bytes)
+    { "xio","xiotw",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // TX full waits
+    { "xio","xiols",_i0, 0, xio_print_stat, xio_get_stat, set_ro, nullptr_void, 0 },  // too-long lines skipped
+    { "jr","jrln",_i0, 0, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - lines processed
+    { "jr","jrbk",_i0, 0, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - blocks queued
+    { "jr","jrbr",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - blocks queued per second
+    { "jr","jrfc",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - average commanded feed
+    { "jr","jrfa",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - average actual feed
+    { "jr","jrst",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - time starved
+    { "jr","jrhd",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - time in feedhold
+    { "jr","jrel",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - time elapsed
+    { "jr","jrtr",_f0, 1, jr_print_stat, jr_get_stat, set_ro, nullptr_void, 0 },      // job report - time remaining
+    { "", "dw",   _i0, 0, tx_print_int,  st_get_dw, set_noop,  nullptr_void, 0 },    // get dwell time remaining
+    { "", "msg",  _s0, 0, tx_print_str,  get_nul,   set_noop,  nullptr_void, 0 },    // no operation on messages
+    { "", "alarm",_n0, 0, tx_print_nul,  cm_alrm,   cm_alrm,   nullptr_void, 0 },    // trigger alarm
+    { "", "panic",_n0, 0, tx_print_nul,  cm_pnic,   cm_pnic,   nullptr_void, 0 },    // trigger panic
+    { "", "shutd",_n0, 0, tx_print_nul,  cm_shutd,  cm_shutd,  nullptr_void, 0 },    // trigger shutdown
+    { "", "clear",_n0, 0, tx_print_nul,  cm_clr,    cm_clr,    nullptr_void, 0 },    // GET "clear" to clear alarm state
+    { "", "clr",  _n0, 0, tx_print_nul,  cm_clr,    cm_clr,    nullptr_void, 0 },    // synonym for "clear"
+    { "", "tick", _n0, 0, tx_print_int,  get_tick,  set_nul,   nullptr_void, 0 },    // get system time tic
+    { "", "cfgt", _n0, 0, tx_print_nul,  get_cfgt,  set_cfgt,  nullptr_void, 0 },    // bulk read tokens by cfgArray index
+    { "", "cfg",  _n0, 0, tx_print_nul,  get_cfg,   set_cfg,   nullptr_void, 0 },    // bulk read config values by cfgArray index
+    { "", "tram", _b0, 0, cm_print_tram,cm_get_tram,cm_set_tram,nullptr_void,0 },    // SET to attempt setting rotation matrix from probes
+    { "", "ckpt", _i0, 0, cm_print_ckpt,cm_get_ckpt,cm_set_ckpt,nullptr_void,0 },    // GET the checkpointed line, SET 1 to restore the checkpoint, 0 to discard it
+    { "", "mesh", _b0, 0, cm_print_mesh,cm_get_mesh,cm_set_mesh,nullptr_void,0 },    // SET true to run the probing grid, false to discard the mesh
+    { "", "mac",  _i0, 0, mc_print_mac,  mc_get_mac, mc_set_mac, nullptr_void, 0 },   // SET to run a stored macro, GET the running macro
+    { "", "rst",  _s0, 0, rs_print_rst,  rs_get_rst, rs_set_rst, nullptr_void, 0 },   // SET base64 raster pixels for the next G1, GET pixels pending
+    { "", "job",  _i0, 0, jb_print_job,  jb_get_job, jb_set_job, nullptr_void, 0 },   // SET to record, end, run or stop a stored job, GET the job state
+    { "", "jobl", _i0, 0, jb_print_jobl, jb_get_jobl,set_ro,    nullptr_void, 0 },   // GET size of the stored job in bytes
+    { "", "bench",_i0, 0, bm_print_bench,bm_get_bench,bm_set_bench,nullptr_void, 0 },  // SET to run the benchmarks with n ops each (benchmark.h)
+    { "", "defa", _b0, 0, tx_print_nul,  help_defa,set_defaults,nullptr_void,0 },    // set/print defaults / help screen
+    { "", "mprof",_iip,0, cfg_print_mprof,cfg_get_mprof,cfg_set_mprof,nullptr_void,0 }, // machine profile the defaults come from
+    { "", "flash",_b0, 0, tx_print_nul,  help_flash,hw_flash,  nullptr_void, 0 },
+
+#ifdef __HELP_SCREENS
+    { "", "help",_b0, 0, tx_print_nul, help_config, set_nul, nullptr_void, 0 },  // prints config help screen
+    { "", "h",   _b0, 0, tx_print_nul, help_config, set_nul, nullptr_void, 0 },  // alias for "help"
+#endif
+
+#ifdef __USER_DATA
+    // User defined data groups
+    { "uda","uda0", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_a[0], USER_DATA_A0 },
+    { "uda","uda1", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_a[1], USER_DATA_A1 },
+    { "uda","uda2", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_a[2], USER_DATA_A2 },
+    { "uda","uda3", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_a[3], USER_DATA_A3 },
+
+    { "udb","udb0", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_b[0], USER_DATA_B0 },
+    { "udb","udb1", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_b[1], USER_DATA_B1 },
+    { "udb","udb2", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_b[2], USER_DATA_B2 },
+    { "udb","udb3", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_b[3], USER_DATA_B3 },
+
+    { "udc","udc0", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_c[0], USER_DATA_C0 },
+    { "udc","udc1", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_c[1], USER_DATA_C1 },
+    { "udc","udc2", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_c[2], USER_DATA_C2 },
+    { "udc","udc3", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_c[3], USER_DATA_C3 },
+
+    { "udd","udd0", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_d[0], USER_DATA_D0 },
+    { "udd","udd1", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_d[1], USER_DATA_D1 },
+    { "udd","udd2", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_d[2], USER_DATA_D2 },
+    { "udd","udd3", _fip, 0, tx_print_int, get_data, set_data, &cfg.user_data_d[3], USER_DATA_D3 },
+#endif
+
+    // Tool table offsets
+    { "tof","tofx",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofy",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofz",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofu",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofv",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofw",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofa",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofb",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+    { "tof","tofc",_fipc, 5, cm_print_cofs, cm_get_tof, cm_set_tof, nullptr_void, 0 },
+
+    // Tool table
+    { "tt1","tt1x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_X_OFFSET },
+    { "tt1","tt1y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_Y_OFFSET },
+    { "tt1","tt1z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_Z_OFFSET },
+    { "tt1","tt1u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_U_OFFSET },
+    { "tt1","tt1v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_V_OFFSET },
+    { "tt1","tt1w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_W_OFFSET },
+    { "tt1","tt1a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_A_OFFSET },
+    { "tt1","tt1b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_B_OFFSET },
+    { "tt1","tt1c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_C_OFFSET },
+
+    { "tt2","tt2x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_X_OFFSET },
+    { "tt2","tt2y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_Y_OFFSET },
+    { "tt2","tt2z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_Z_OFFSET },
+    { "tt2","tt2u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_U_OFFSET },
+    { "tt2","tt2v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_V_OFFSET },
+    { "tt2","tt2w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_W_OFFSET },
+    { "tt2","tt2a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_A_OFFSET },
+    { "tt2","tt2b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_B_OFFSET },
+    { "tt2","tt2c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT2_C_OFFSET },
+
+    { "tt3","tt3x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_X_OFFSET },
+    { "tt3","tt3y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_Y_OFFSET },
+    { "tt3","tt3z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_Z_OFFSET },
+    { "tt3","tt3u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_U_OFFSET },
+    { "tt3","tt3v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_V_OFFSET },
+    { "tt3","tt3w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_W_OFFSET },
+    { "tt3","tt3a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_A_OFFSET },
+    { "tt3","tt3b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT3_B_OFFSET },
+    { "tt3","tt3c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT1_C_OFFSET },
+
+    { "tt4","tt4x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_X_OFFSET },
+    { "tt4","tt4y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_Y_OFFSET },
+    { "tt4","tt4z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_Z_OFFSET },
+    { "tt4","tt4u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_U_OFFSET },
+    { "tt4","tt4v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_V_OFFSET },
+    { "tt4","tt4w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_W_OFFSET },
+    { "tt4","tt4a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_A_OFFSET },
+    { "tt4","tt4b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_B_OFFSET },
+    { "tt4","tt4c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT4_C_OFFSET },
+
+    { "tt5","tt5x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_X_OFFSET },
+    { "tt5","tt5y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_Y_OFFSET },
+    { "tt5","tt5z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_Z_OFFSET },
+    { "tt5","tt5u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_U_OFFSET },
+    { "tt5","tt5v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_V_OFFSET },
+    { "tt5","tt5w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_W_OFFSET },
+    { "tt5","tt5a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_A_OFFSET },
+    { "tt5","tt5b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_B_OFFSET },
+    { "tt5","tt5c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT5_C_OFFSET },
+
+    { "tt6","tt6x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_X_OFFSET },
+    { "tt6","tt6y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_Y_OFFSET },
+    { "tt6","tt6z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_Z_OFFSET },
+    { "tt6","tt6u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_U_OFFSET },
+    { "tt6","tt6v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_V_OFFSET },
+    { "tt6","tt6w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_W_OFFSET },
+    { "tt6","tt6a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_A_OFFSET },
+    { "tt6","tt6b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_B_OFFSET },
+    { "tt6","tt6c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT6_C_OFFSET },
+
+    { "tt7","tt7x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_X_OFFSET },
+    { "tt7","tt7y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_Y_OFFSET },
+    { "tt7","tt7z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_Z_OFFSET },
+    { "tt7","tt7u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_U_OFFSET },
+    { "tt7","tt7v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_V_OFFSET },
+    { "tt7","tt7w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_W_OFFSET },
+    { "tt7","tt7a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_A_OFFSET },
+    { "tt7","tt7b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_B_OFFSET },
+    { "tt7","tt7c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT7_C_OFFSET },
+
+    { "tt8","tt8x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_X_OFFSET },
+    { "tt8","tt8y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_Y_OFFSET },
+    { "tt8","tt8z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_Z_OFFSET },
+    { "tt8","tt8u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_U_OFFSET },
+    { "tt8","tt8v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_V_OFFSET },
+    { "tt8","tt8w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_W_OFFSET },
+    { "tt8","tt8a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_A_OFFSET },
+    { "tt8","tt8b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_B_OFFSET },
+    { "tt8","tt8c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT8_C_OFFSET },
+
+    { "tt9","tt9x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_X_OFFSET },
+    { "tt9","tt9y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_Y_OFFSET },
+    { "tt9","tt9z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_Z_OFFSET },
+    { "tt9","tt9u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_U_OFFSET },
+    { "tt9","tt9v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_V_OFFSET },
+    { "tt9","tt9w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_W_OFFSET },
+    { "tt9","tt9a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_A_OFFSET },
+    { "tt9","tt9b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_B_OFFSET },
+    { "tt9","tt9c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT9_C_OFFSET },
+
+    { "tt10","tt10x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_X_OFFSET },
+    { "tt10","tt10y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_Y_OFFSET },
+    { "tt10","tt10z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_Z_OFFSET },
+    { "tt10","tt10u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_U_OFFSET },
+    { "tt10","tt10v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_V_OFFSET },
+    { "tt10","tt10w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_W_OFFSET },
+    { "tt10","tt10a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_A_OFFSET },
+    { "tt10","tt10b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_B_OFFSET },
+    { "tt10","tt10c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT10_C_OFFSET },
+
+    { "tt11","tt11x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_X_OFFSET },
+    { "tt11","tt11y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_Y_OFFSET },
+    { "tt11","tt11z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_Z_OFFSET },
+    { "tt11","tt11u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_U_OFFSET },
+    { "tt11","tt11v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_V_OFFSET },
+    { "tt11","tt11w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_W_OFFSET },
+    { "tt11","tt11a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_A_OFFSET },
+    { "tt11","tt11b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_B_OFFSET },
+    { "tt11","tt11c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT11_C_OFFSET },
+
+    { "tt12","tt12x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_X_OFFSET },
+    { "tt12","tt12y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_Y_OFFSET },
+    { "tt12","tt12z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_Z_OFFSET },
+    { "tt12","tt12u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_U_OFFSET },
+    { "tt12","tt12v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_V_OFFSET },
+    { "tt12","tt12w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_W_OFFSET },
+    { "tt12","tt12a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_A_OFFSET },
+    { "tt12","tt12b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_B_OFFSET },
+    { "tt12","tt12c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT12_C_OFFSET },
+
+    { "tt13","tt13x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_X_OFFSET },
+    { "tt13","tt13y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_Y_OFFSET },
+    { "tt13","tt13z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_Z_OFFSET },
+    { "tt13","tt13u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_U_OFFSET },
+    { "tt13","tt13v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_V_OFFSET },
+    { "tt13","tt13w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_W_OFFSET },
+    { "tt13","tt13a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_A_OFFSET },
+    { "tt13","tt13b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_B_OFFSET },
+    { "tt13","tt13c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT13_C_OFFSET },
+
+    { "tt14","tt14x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_X_OFFSET },
+    { "tt14","tt14y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_Y_OFFSET },
+    { "tt14","tt14z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_Z_OFFSET },
+    { "tt14","tt14u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_U_OFFSET },
+    { "tt14","tt14v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_V_OFFSET },
+    { "tt14","tt14w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_W_OFFSET },
+    { "tt14","tt14a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_A_OFFSET },
+    { "tt14","tt14b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_B_OFFSET },
+    { "tt14","tt14c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT14_C_OFFSET },
+
+    { "tt15","tt15x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_X_OFFSET },
+    { "tt15","tt15y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_Y_OFFSET },
+    { "tt15","tt15z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_Z_OFFSET },
+    { "tt15","tt15u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_U_OFFSET },
+    { "tt15","tt15v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_V_OFFSET },
+    { "tt15","tt15w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_W_OFFSET },
+    { "tt15","tt15a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_A_OFFSET },
+    { "tt15","tt15b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_B_OFFSET },
+    { "tt15","tt15c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT15_C_OFFSET },
+
+    { "tt16","tt16x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_X_OFFSET },
+    { "tt16","tt16y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_Y_OFFSET },
+    { "tt16","tt16z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_Z_OFFSET },
+    { "tt16","tt16u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_U_OFFSET },
+    { "tt16","tt16v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_V_OFFSET },
+    { "tt16","tt16w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_W_OFFSET },
+    { "tt16","tt16a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_A_OFFSET },
+    { "tt16","tt16b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_B_OFFSET },
+    { "tt16","tt16c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT16_C_OFFSET },
+
+    { "tt17","tt17x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_X_OFFSET },
+    { "tt17","tt17y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_Y_OFFSET },
+    { "tt17","tt17z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_Z_OFFSET },
+    { "tt17","tt17u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_U_OFFSET },
+    { "tt17","tt17v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_V_OFFSET },
+    { "tt17","tt17w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_W_OFFSET },
+    { "tt17","tt17a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_A_OFFSET },
+    { "tt17","tt17b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_B_OFFSET },
+    { "tt17","tt17c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT17_C_OFFSET },
+
+    { "tt18","tt18x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_X_OFFSET },
+    { "tt18","tt18y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_Y_OFFSET },
+    { "tt18","tt18z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_Z_OFFSET },
+    { "tt18","tt18u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_U_OFFSET },
+    { "tt18","tt18v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_V_OFFSET },
+    { "tt18","tt18w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_W_OFFSET },
+    { "tt18","tt18a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_A_OFFSET },
+    { "tt18","tt18b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_B_OFFSET },
+    { "tt18","tt18c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT18_C_OFFSET },
+
+    { "tt19","tt19x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_X_OFFSET },
+    { "tt19","tt19y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_Y_OFFSET },
+    { "tt19","tt19z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_Z_OFFSET },
+    { "tt19","tt19u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_U_OFFSET },
+    { "tt19","tt19v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_V_OFFSET },
+    { "tt19","tt19w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_W_OFFSET },
+    { "tt19","tt19a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_A_OFFSET },
+    { "tt19","tt19b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_B_OFFSET },
+    { "tt19","tt19c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT19_C_OFFSET },
+
+    { "tt20","tt20x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_X_OFFSET },
+    { "tt20","tt20y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_Y_OFFSET },
+    { "tt20","tt20z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_Z_OFFSET },
+    { "tt20","tt20u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_U_OFFSET },
+    { "tt20","tt20v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_V_OFFSET },
+    { "tt20","tt20w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_W_OFFSET },
+    { "tt20","tt20a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_A_OFFSET },
+    { "tt20","tt20b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_B_OFFSET },
+    { "tt20","tt20c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT20_C_OFFSET },
+
+    { "tt21","tt21x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_X_OFFSET },
+    { "tt21","tt21y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_Y_OFFSET },
+    { "tt21","tt21z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_Z_OFFSET },
+    { "tt21","tt21u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_U_OFFSET },
+    { "tt21","tt21v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_V_OFFSET },
+    { "tt21","tt21w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_W_OFFSET },
+    { "tt21","tt21a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_A_OFFSET },
+    { "tt21","tt21b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_B_OFFSET },
+    { "tt21","tt21c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT21_C_OFFSET },
+
+    { "tt22","tt22x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_X_OFFSET },
+    { "tt22","tt22y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_Y_OFFSET },
+    { "tt22","tt22z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_Z_OFFSET },
+    { "tt22","tt22u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_U_OFFSET },
+    { "tt22","tt22v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_V_OFFSET },
+    { "tt22","tt22w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_W_OFFSET },
+    { "tt22","tt22a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_A_OFFSET },
+    { "tt22","tt22b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_B_OFFSET },
+    { "tt22","tt22c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT22_C_OFFSET },
+
+    { "tt23","tt23x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_X_OFFSET },
+    { "tt23","tt23y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_Y_OFFSET },
+    { "tt23","tt23z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_Z_OFFSET },
+    { "tt23","tt23u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_U_OFFSET },
+    { "tt23","tt23v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_V_OFFSET },
+    { "tt23","tt23w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_W_OFFSET },
+    { "tt23","tt23a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_A_OFFSET },
+    { "tt23","tt23b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_B_OFFSET },
+    { "tt23","tt23c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT23_C_OFFSET },
+
+    { "tt24","tt24x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_X_OFFSET },
+    { "tt24","tt24y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_Y_OFFSET },
+    { "tt24","tt24z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_Z_OFFSET },
+    { "tt24","tt24u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_U_OFFSET },
+    { "tt24","tt24v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_V_OFFSET },
+    { "tt24","tt24w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_W_OFFSET },
+    { "tt24","tt24a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_A_OFFSET },
+    { "tt24","tt24b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_B_OFFSET },
+    { "tt24","tt24c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT24_C_OFFSET },
+
+    { "tt25","tt25x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_X_OFFSET },
+    { "tt25","tt25y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_Y_OFFSET },
+    { "tt25","tt25z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_Z_OFFSET },
+    { "tt25","tt25u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_U_OFFSET },
+    { "tt25","tt25v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_V_OFFSET },
+    { "tt25","tt25w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_W_OFFSET },
+    { "tt25","tt25a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_A_OFFSET },
+    { "tt25","tt25b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_B_OFFSET },
+    { "tt25","tt25c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT25_C_OFFSET },
+
+    { "tt26","tt26x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_X_OFFSET },
+    { "tt26","tt26y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_Y_OFFSET },
+    { "tt26","tt26z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_Z_OFFSET },
+    { "tt26","tt26u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_U_OFFSET },
+    { "tt26","tt26v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_V_OFFSET },
+    { "tt26","tt26w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_W_OFFSET },
+    { "tt26","tt26a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_A_OFFSET },
+    { "tt26","tt26b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_B_OFFSET },
+    { "tt26","tt26c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT26_C_OFFSET },
+
+    { "tt27","tt27x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_X_OFFSET },
+    { "tt27","tt27y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_Y_OFFSET },
+    { "tt27","tt27z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_Z_OFFSET },
+    { "tt27","tt27u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_U_OFFSET },
+    { "tt27","tt27v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_V_OFFSET },
+    { "tt27","tt27w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_W_OFFSET },
+    { "tt27","tt27a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_A_OFFSET },
+    { "tt27","tt27b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_B_OFFSET },
+    { "tt27","tt27c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT27_C_OFFSET },
+
+    { "tt28","tt28x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_X_OFFSET },
+    { "tt28","tt28y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_Y_OFFSET },
+    { "tt28","tt28z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_Z_OFFSET },
+    { "tt28","tt28u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_U_OFFSET },
+    { "tt28","tt28v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_V_OFFSET },
+    { "tt28","tt28w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_W_OFFSET },
+    { "tt28","tt28a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_A_OFFSET },
+    { "tt28","tt28b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_B_OFFSET },
+    { "tt28","tt28c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT28_C_OFFSET },
+
+    { "tt29","tt29x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_X_OFFSET },
+    { "tt29","tt29y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_Y_OFFSET },
+    { "tt29","tt29z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_Z_OFFSET },
+    { "tt29","tt29u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_U_OFFSET },
+    { "tt29","tt29v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_V_OFFSET },
+    { "tt29","tt29w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_W_OFFSET },
+    { "tt29","tt29a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_A_OFFSET },
+    { "tt29","tt29b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_B_OFFSET },
+    { "tt29","tt29c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT29_C_OFFSET },
+
+    { "tt30","tt30x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_X_OFFSET },
+    { "tt30","tt30y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_Y_OFFSET },
+    { "tt30","tt30z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_Z_OFFSET },
+    { "tt30","tt30u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_U_OFFSET },
+    { "tt30","tt30v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_V_OFFSET },
+    { "tt30","tt30w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_W_OFFSET },
+    { "tt30","tt30a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_A_OFFSET },
+    { "tt30","tt30b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_B_OFFSET },
+    { "tt30","tt30c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT30_C_OFFSET },
+
+    { "tt31","tt31x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_X_OFFSET },
+    { "tt31","tt31y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_Y_OFFSET },
+    { "tt31","tt31z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_Z_OFFSET },
+    { "tt31","tt31u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_U_OFFSET },
+    { "tt31","tt31v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_V_OFFSET },
+    { "tt31","tt31w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_W_OFFSET },
+    { "tt31","tt31a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_A_OFFSET },
+    { "tt31","tt31b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_B_OFFSET },
+    { "tt31","tt31c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT31_C_OFFSET },
+
+    { "tt32","tt32x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_X_OFFSET },
+    { "tt32","tt32y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_Y_OFFSET },
+    { "tt32","tt32z",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_Z_OFFSET },
+    { "tt32","tt32u",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_U_OFFSET },
+    { "tt32","tt32v",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_V_OFFSET },
+    { "tt32","tt32w",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_W_OFFSET },
+    { "tt32","tt32a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_A_OFFSET },
+    { "tt32","tt32b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_B_OFFSET },
+    { "tt32","tt32c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr_void, TT32_C_OFFSET },
+
+    // Diagnostic parameters
+#ifdef __DIAGNOSTIC_PARAMETERS
+    { "",    "clc",_f0, 0, tx_print_nul, st_clc,  st_clc, &cs.null, 0 },  // clear diagnostic step counters
+
+    { "_te","_tex",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_X], 0 }, // X target endpoint
+    { "_te","_tey",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_Y], 0 },
+    { "_te","_tez",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_Z], 0 },
+#if (AXES >= 6)
+    { "_te","_tea",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_A], 0 },
+    { "_te","_teb",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_B], 0 },
+    { "_te","_tec",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target[AXIS_C], 0 },
+#endif
+
+    { "_tr","_trx",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_X], 0 },  // X target runtime
+    { "_tr","_try",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_Y], 0 },
+    { "_tr","_trz",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_Z], 0 },
+#if (AXES >= 6)
+    { "_tr","_tra",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_A], 0 },
+    { "_tr","_trb",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_B], 0 },
+    { "_tr","_trc",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->gm.target[AXIS_C], 0 },
+#endif
+
+#if (MOTORS >= 1)
+    { "_ts","_ts1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_1], 0 },      // Motor 1 target steps
+    { "_ps","_ps1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_1], 0 },    // Motor 1 position steps
+    { "_cs","_cs1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_1], 0 },   // Motor 1 commanded steps (delayed steps)
+    { "_es","_es1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_1], 0 },     // Motor 1 encoder steps
+    { "_xs","_xs1",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_1].corrected_steps, 0 }, // Motor 1 correction steps applied
+    { "_fe","_fe1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_1], 0 },   // Motor 1 following error in steps
+#endif
+#if (MOTORS >= 2)
+    { "_ts","_ts2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_2], 0 },
+    { "_ps","_ps2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_2], 0 },
+    { "_cs","_cs2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_2], 0 },
+    { "_es","_es2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_2], 0 },
+    { "_xs","_xs2",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_2].corrected_steps, 0 },
+    { "_fe","_fe2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_2], 0 },
+#endif
+#if (MOTORS >= 3)
+    { "_ts","_ts3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_3], 0 },
+    { "_ps","_ps3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_3], 0 },
+    { "_cs","_cs3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_3], 0 },
+    { "_es","_es3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_3], 0 },
+    { "_xs","_xs3",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_3].corrected_steps, 0 },
+    { "_fe","_fe3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_3], 0 },
+#endif
+#if (MOTORS >= 4)
+    { "_ts","_ts4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_4], 0 },
+    { "_ps","_ps4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_4], 0 },
+    { "_cs","_cs4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_4], 0 },
+    { "_es","_es4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_4], 0 },
+    { "_xs","_xs4",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_4].corrected_steps, 0 },
+    { "_fe","_fe4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_4], 0 },
+#endif
+#if (MOTORS >= 5)
+    { "_ts","_ts5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_5], 0 },
+    { "_ps","_ps5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_5], 0 },
+    { "_cs","_cs5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_5], 0 },
+    { "_es","_es5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_5], 0 },
+    { "_xs","_xs6",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_5].corrected_steps, 0 },
+    { "_fe","_fe5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_5], 0 },
+#endif
+#if (MOTORS >= 6)
+    { "_ts","_ts6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_6], 0 },
+    { "_ps","_ps6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_6], 0 },
+    { "_cs","_cs6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_6], 0 },
+    { "_es","_es6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_6], 0 },
+    { "_xs","_xs5",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_6].corrected_steps, 0 },
+    { "_fe","_fe6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_6], 0 },
+#endif
+
+#endif  //  __DIAGNOSTIC_PARAMETERS
+
+    // Persistence for status report - must be in sequence
+    // *** Count must agree with NV_STATUS_REPORT_LEN in report.h ***
+    { "","se00",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[0],0 },
+    { "","se01",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[1],0 },
+    { "","se02",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[2],0 },
+    { "","se03",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[3],0 },
+    { "","se04",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[4],0 },
+    { "","se05",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[5],0 },
+    { "","se06",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[6],0 },
+    { "","se07",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[7],0 },
+    { "","se08",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[8],0 },
+    { "","se09",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[9],0 },
+    { "","se10",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[10],0 },
+    { "","se11",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[11],0 },
+    { "","se12",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[12],0 },
+    { "","se13",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[13],0 },
+    { "","se14",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[14],0 },
+    { "","se15",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[15],0 },
+    { "","se16",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[16],0 },
+    { "","se17",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[17],0 },
+    { "","se18",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[18],0 },
+    { "","se19",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[19],0 },
+    { "","se20",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[20],0 },
+    { "","se21",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[21],0 },
+    { "","se22",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[22],0 },
+    { "","se23",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[23],0 },
+    { "","se24",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[24],0 },
+    { "","se25",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[25],0 },
+    { "","se26",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[26],0 },
+    { "","se27",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[27],0 },
+    { "","se28",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[28],0 },
+    { "","se29",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[29],0 },
+    { "","se30",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[30],0 },
+    { "","se31",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[31],0 },
+    { "","se32",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[32],0 },
+    { "","se33",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[33],0 },
+    { "","se34",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[34],0 },
+    { "","se35",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[35],0 },
+    { "","se36",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[36],0 },
+    { "","se37",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[37],0 },
+    { "","se38",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[38],0 },
+    { "","se39",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[39],0 },
+    // Count is 40, since se00 counts as one.
@@ -42,9 +42,14 @@
 #include "gpio.h"
 #include "report.h"
 #include "help.h"
+#include "macro.h"
+#include "job.h"
+#include "raster.h"
+#include "sync.h"
 #include "util.h"
 #include "xio.h"
 #include "settings.h"
+#include "sim_harness.h"
 
 #include "MotatePower.h"
 
@@ -64,9 +69,8 @@ controller_t cs; // controller state structure
 
 static void _controller_HSM(void);
 static stat_t _led_indicator(void);        // twiddle the LED indicator
-static stat_t _shutdown_handler(void);     // new (replaces _interlock_estop_handler)
-static stat_t _interlock_handler(void);    // new (replaces _interlock_estop_handler)
-static stat_t _limit_switch_handler(void); // revised for new GPIO code
+static stat_t _input_event_handler(void);  // limit, shutdown and interlock events from the inputs
+static stat_t _safe_pin_handler(void);     // toggle the SAFE pin while not alarmed, release sync lines
 
 static void _init_assertions(void);
 static stat_t _test_assertions(void);
@@ -75,9 +79,12 @@ static stat_t _test_system_assertions(void);
 static stat_t _sync_to_planner(void);
 static stat_t _sync_to_tx_buffer(void);
 static stat_t _dispatch_command(void);
+static bool _dispatch_batch_ok(const uint32_t batch_start);
 static stat_t _dispatch_control(void);
+static stat_t _dispatch_binary(void);
 static void _dispatch_kernel(const devflags_t flags);
 static stat_t _controller_state(void); // manage controller state transitions
+static stat_t _arc_callback(void);
 
 static Motate::OutputPin<Motate::kOutputSAFE_PinNumber> safe_pin;
 
@@ -100,6 +107,8 @@ void controller_init()
     cs.fw_build = G2CORE_FIRMWARE_BUILD; // set up identification
     cs.fw_version = G2CORE_FIRMWARE_VERSION;
 
+    cs.task_ready = UINT32_MAX;          // run every task once on the first pass
+
     cs.controller_state = CONTROLLER_STARTUP; // ready to run startup lines
     if (xio_connected())
     {
@@ -131,6 +140,13 @@ void controller_request_enquiry()
  * and runs the next routine in the list.
  *
  * A routine that had no action (i.e. is OFF or idle) should return STAT_NOOP
+ *
+ * The dispatch list is a task table in priority order. A task with a period only
+ * runs once its period has elapsed, or sooner if controller_wake_task() has marked
+ * it ready. Periodic housekeeping therefore no longer costs a call on every pass,
+ * and the command readers at the bottom of the table get the time that is left.
+ * A task returning STAT_EAGAIN still blocks the rest of the table, and is retried
+ * on the next pass without waiting for its period.
  */
 
 void controller_run()
@@ -142,11 +158,14 @@ void controller_run()
 }
 //using namespace Motate;
 //extern Timer<SysTickTimerNum> SysTickTimer;
-#define DISPATCH(func)       \
-    if (func == STAT_EAGAIN) \
-        return;
-static void _controller_HSM()
-{
+
+typedef struct ctrlTaskDef {
+    ctrlTask task;                      // the ctrlTask this entry is - checked against its index
+    stat_t (*func)(void);               // task continuation
+    uint16_t period_ms;                 // minimum time between runs. 0 = every pass
+} ctrlTaskDef_t;
+
+static constexpr ctrlTaskDef_t tasks[CONTROLLER_TASK_COUNT] = { // indexed by ctrlTask
     //----- 中断服务程序是控制器最高优先级的功能 ----//
     //      请参阅hardware.h以获取ISR列表及其优先级。
     //
@@ -154,42 +173,128 @@ static void _controller_HSM()
 
     // 顺序很重要，换行符表示依赖组
 
-    DISPATCH(hardware_periodic());       //给硬件一个做东西的机会
-    DISPATCH(_led_indicator());          //以当前速率闪烁LED
-    DISPATCH(_shutdown_handler());       //将系统置于关机状态
-    DISPATCH(_interlock_handler());      //调用/删除安全联锁
-    DISPATCH(temperature_callback());    //确保温度得到控制
-    DISPATCH(_limit_switch_handler());   //调用限位开关
-    DISPATCH(_controller_state());       //控制器状态管理
-    DISPATCH(_test_system_assertions()); //系统完整性断言
-    DISPATCH(_dispatch_control());       //在执行循环之前读取任何控制消息
+    { CONTROLLER_TASK_DRIVER_FAULTS,    hardware_driver_fault_callback, HARDWARE_DRIVER_FAULT_MS },       // board: motor driver fault lines
+    { CONTROLLER_TASK_LED,              _led_indicator,                 CONTROLLER_LED_MS },              //以当前速率闪烁LED
+    { CONTROLLER_TASK_INPUT_EVENTS,     _input_event_handler,           CONTROLLER_INPUT_EVENT_MS },      // limit, shutdown and interlock - woken by the input ISR
+#if TEMPERATURE_ENABLED == true
+    { CONTROLLER_TASK_TEMPERATURE,      temperature_callback,           CONTROLLER_TEMPERATURE_MS },      //确保温度得到控制
+    { CONTROLLER_TASK_TEMPERATURE_PID,  temperature_pid_callback,       CONTROLLER_TEMPERATURE_PID_MS },  // run the heater PIDs
+#endif
+    { CONTROLLER_TASK_SAFE_PIN,         _safe_pin_handler,              0 },                              // SAFE pin heartbeat, multi-board sync lines
+    { CONTROLLER_TASK_STATE,            _controller_state,              0 },                              //控制器状态管理
+#if CONTROLLER_ASSERTION_LOW_PRIORITY == false
+    { CONTROLLER_TASK_ASSERTIONS,       _test_system_assertions,        CONTROLLER_ASSERTION_MS },        //系统完整性断言
+#endif
+    { CONTROLLER_TASK_CONTROL,          _dispatch_control,              0 },                              //在执行循环之前读取任何控制消息
 
     //----- gcode和循环的规划器层次结构 ---------------------------------------//
 
-    DISPATCH(st_motor_power_callback());   // 步进电机电源排序
-    DISPATCH(sr_status_report_callback()); // 有条件地发送状态报告
-    DISPATCH(qr_queue_report_callback());  // 有条件地发送队列报告
+    { CONTROLLER_TASK_MOTOR_POWER,      st_motor_power_callback,        0 },                              // 步进电机电源排序
+    { CONTROLLER_TASK_DRIVER_STATUS,    st_driver_status_callback,      ST_DRIVER_STATUS_MS },            // smart driver stall and fault flags
+    { CONTROLLER_TASK_STATUS_REPORT,    sr_status_report_callback,      CONTROLLER_REPORT_MS },           // 有条件地发送状态报告
+    { CONTROLLER_TASK_BINARY_REPORT,    sr_binary_report_callback,      CONTROLLER_REPORT_MS },           // send binary status reports on the secondary channel, if enabled
+    { CONTROLLER_TASK_QUEUE_REPORT,     qr_queue_report_callback,       CONTROLLER_REPORT_MS },           // 有条件地发送队列报告
+    { CONTROLLER_TASK_JOB_REPORT,       jr_job_report_callback,         CONTROLLER_JOB_REPORT_MS },       // sample starved and feedhold time for job reports
+    { CONTROLLER_TASK_ENCODER,          en_callback,                    CONTROLLER_REPORT_MS },           // measure velocity and stream the following error log, if enabled
+#if EXEC_SEGMENT_TABLE == true
+    { CONTROLLER_TASK_EXEC_TABLE,       mp_exec_table_callback,         0 },                              // precompute the segments of the next block to run
+#endif
 
     // 这3个必须按照这个确切的顺序：
-    DISPATCH(mp_planner_callback());          // 运动规划师
-    DISPATCH(cm_operation_runner_callback()); // 操作动作跑步者
-    DISPATCH(cm_arc_callback(cm));            // 弧生成作为线上方的循环运行
-
-    DISPATCH(cm_homing_cycle_callback());   // 归航循环操作（G28.2）
-    DISPATCH(cm_probing_cycle_callback());  // 探测循环操作（G38.2）
-    DISPATCH(cm_jogging_cycle_callback());  // 慢跑循环操作
-    DISPATCH(cm_deferred_write_callback()); // 在不在加工循环中时保持G10的变化
-
-    DISPATCH(cm_feedhold_command_blocker()); // 阻止新的Gcode在feedhold中到达
+    { CONTROLLER_TASK_PLANNER,          mp_planner_callback,            0 },                              // 运动规划师
+    { CONTROLLER_TASK_OPERATION,        cm_operation_runner_callback,   0 },                              // 操作动作跑步者
+    { CONTROLLER_TASK_ARC,              _arc_callback,                  0 },                              // 弧生成作为线上方的循环运行
+
+    { CONTROLLER_TASK_HOMING,           cm_homing_cycle_callback,       0 },                              // 归航循环操作（G28.2）
+    { CONTROLLER_TASK_PROBING,          cm_probing_cycle_callback,      0 },                              // 探测循环操作（G38.2）
+    { CONTROLLER_TASK_JOGGING,          cm_jogging_cycle_callback,      0 },                              // 慢跑循环操作
+    { CONTROLLER_TASK_DEFERRED_WRITE,   cm_deferred_write_callback,     0 },                              // 在不在加工循环中时保持G10的变化
+
+    { CONTROLLER_TASK_FEEDHOLD_BLOCKER, cm_feedhold_command_blocker,    0 },                              // 阻止新的Gcode在feedhold中到达
+    { CONTROLLER_TASK_MACRO,            mc_macro_callback,              0 },                              // queue stored macro lines ahead of host commands
+    { CONTROLLER_TASK_JOB,              job_callback,                   0 },                              // queue the running stored job's lines ahead of host Gcode
 #if MARLIN_COMPAT_ENABLED == true
-    DISPATCH(marlin_callback()); // 处理Marlin的东西 - 可能会返回EAGAIN，必须在planner_callback之后！
+    { CONTROLLER_TASK_MARLIN,           marlin_callback,                0 },                              // 处理Marlin的东西 - 可能会返回EAGAIN，必须在planner_callback之后！
+#endif
+#if CONTROLLER_ASSERTION_LOW_PRIORITY == true
+    { CONTROLLER_TASK_ASSERTIONS,       _test_system_assertions,        CONTROLLER_ASSERTION_MS },        // system integrity assertions, when nothing above is blocked
 #endif
 
     //----- command readers and parsers --------------------------------------------------//
 
-    DISPATCH(_sync_to_planner());   //确保计划队列中至少有一个空闲缓冲区
-    DISPATCH(_sync_to_tx_buffer()); //与TX缓冲区同步（伪阻塞）
-    DISPATCH(_dispatch_command());  //必须是最后的 - 读取并执行下一个命令
+    { CONTROLLER_TASK_SYNC_PLANNER,     _sync_to_planner,               0 },                              //确保计划队列中至少有一个空闲缓冲区
+    { CONTROLLER_TASK_SYNC_TX,          _sync_to_tx_buffer,             0 },                              //与TX缓冲区同步（伪阻塞）
+    { CONTROLLER_TASK_BINARY,           _dispatch_binary,               0 },                              // run one binary channel move, if any
+    { CONTROLLER_TASK_COMMAND,          _dispatch_command,              0 }                               //必须是最后的 - 读取并执行下一个命令
+};
+static_assert(CONTROLLER_TASK_COUNT <= 32, "cs.task_ready holds one bit per controller task");
+
+static constexpr bool _tasks_in_order(const uint8_t i)
+{
+    return ((i == CONTROLLER_TASK_COUNT) || ((tasks[i].task == i) && _tasks_in_order(i + 1)));
+}
+static_assert(_tasks_in_order(0), "the task table must be in ctrlTask order (controller.h)");
+
+/*
+ * Input ISRs wake tasks too, so every change to task_ready is made with interrupts
+ * held off. PRIMASK is restored rather than enabled so this also works from an ISR
+ * or inside another critical section.
+ */
+
+static void _clear_task_ready(const uint8_t task)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    cs.task_ready &= ~(1UL << task);
+    __set_PRIMASK(primask);
+}
+
+static void _controller_HSM()
+{
+    uint32_t now = SysTickTimer_getValue();
+
+    sim_harness_poll();                                 // ends the process when a headless job finishes
+
+    for (uint8_t i = 0; i < CONTROLLER_TASK_COUNT; i++) {
+        const ctrlTaskDef_t *t = &tasks[i];
+        if (t->period_ms) {
+            if (!(cs.task_ready & (1UL << i)) && ((int32_t)(now - cs.task_next[i]) < 0)) {
+                continue;                               // not due and not woken
+            }
+            _clear_task_ready(i);
+        }
+        if (t->func() == STAT_EAGAIN) {                 // blocks the rest of the table
+            return;
+        }
+        if (t->period_ms) {
+            cs.task_next[i] = now + t->period_ms;
+        }
+    }
+}
+
+/*
+ * controller_wake_task() - run a periodic task on the next pass without waiting out its period
+ *
+ *  Safe to call from an interrupt.
+ */
+
+void controller_wake_task(const ctrlTask task)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    cs.task_ready |= (1UL << task);
+    __set_PRIMASK(primask);
+}
+
+// Canned cycles generate their moves from the arc slot - the task table is full, and
+// neither an arc nor a cycle can be running while the other is generating
+static stat_t _arc_callback()
+{
+    stat_t status = cm_arc_callback(cm);
+    if (status != STAT_NOOP) {
+        return (status);
+    }
+    return (cm_canned_cycle_callback());
 }
 
 /****************************************************************************************
@@ -204,9 +309,19 @@ static void _controller_HSM()
 *在将控制返回主循环之前的RX队列。
  */
 int xio_usart_gets(char *buf, const int size);
+int xio_usart_gets_control(char *buf, const int size);     // control lines, ahead of queued Gcode
+void xio_usart_flush_to_command(void);
 static char rxbuf[1024];
 static stat_t _dispatch_control()
 {
+    int32_t linenum;
+
+    if (xio_binary_overrun(&linenum))
+    {
+        char msg[40];
+        sprintf(msg, "binary queue full - resend N%ld", (long)linenum);
+        rpt_exception(STAT_BUFFER_FULL, msg);
+    }
     if (cs.controller_state != CONTROLLER_PAUSED)
     {
         //devflags_t flags = DEV_IS_CTRL;
@@ -215,7 +330,7 @@ static stat_t _dispatch_control()
         //}
         cs.bufp = rxbuf;
         cs.linelen = 1024;
-        if (xio_usart_gets(cs.bufp, cs.linelen) == 0)
+        if (xio_usart_gets_control(cs.bufp, cs.linelen) == 0)
         {
             _dispatch_kernel(0);
         }
@@ -231,16 +346,111 @@ static stat_t _dispatch_command()
         //if ((!mp_planner_is_full(mp)) && (cs.bufp = xio_readline(flags, cs.linelen)) != NULL) {
         //    _dispatch_kernel(flags);
         //}
-        cs.bufp = rxbuf;
-        cs.linelen = 1024;
-        if (xio_usart_gets(cs.bufp, cs.linelen) == 0)
+        uint32_t batch_start = SysTickTimer_getValue();
+        for (uint8_t lines = 0; lines < DISPATCH_BATCH_LINES; lines++)
         {
+            cs.bufp = rxbuf;
+            cs.linelen = 1024;
+            if (xio_usart_gets(cs.bufp, cs.linelen) != 0)
+            {
+                break;
+            }
             _dispatch_kernel(0);
+            if (!_dispatch_batch_ok(batch_start) || xio_binary_ready())
+            {
+                break;
+            }
         }
     }
     return (STAT_OK);
 }
 
+/*
+ * _dispatch_batch_ok() - return true if another line can be read in this controller pass
+ *
+ *  Batching only continues after a Gcode line, and only while nothing the dispatch list
+ *  blocks on before _dispatch_command() would hold the next line back: the planner has
+ *  room, no arc is being generated, no feedhold, homing, probing or jogging is running,
+ *  no stored macro is being queued, the machine is not alarmed and the batch time budget
+ *  isn't used up.
+ */
+
+static bool _dispatch_batch_ok(const uint32_t batch_start)
+{
+    if (strchr("{$?Hh!~%\x04\x05\x18", cs.saved_buf[0]) != NULL)
+    { // last line was JSON, text or a control character (or was a blank line)
+        return (false);
+    }
+#if MARLIN_COMPAT_ENABLED == true
+    if (js.json_mode == MARLIN_COMM_MODE)
+    { // marlin_callback() needs to run between lines
+        return (false);
+    }
+#endif
+    if ((cs.controller_state == CONTROLLER_PAUSED) ||
+        mp_planner_is_full(mp) ||
+        (cm->arc.run_state != BLOCK_INACTIVE) ||
+        cm_canned_cycle_running() ||
+        (cm1.hold_state != FEEDHOLD_OFF) ||
+        ((cm->cycle_type != CYCLE_NONE) && (cm->cycle_type != CYCLE_MACHINING)) ||
+        mc_macro_running() ||
+        (cm_is_alarmed() != STAT_OK))
+    {
+        return (false);
+    }
+    return ((SysTickTimer_getValue() - batch_start) < DISPATCH_BATCH_MS);
+}
+
+/*
+ * _dispatch_binary() - run the next move received on the binary channel
+ *
+ *  Binary moves go straight to the canonical machine. Returns EAGAIN after a move
+ *  so the loop re-syncs to the planner before the next move or command is read.
+ *  A move waits for the text lines sent ahead of it, and _dispatch_command() stops
+ *  reading lines when a move's turn comes. Dropped frames are reported by
+ *  _dispatch_control(), which a feedhold doesn't block.
+ */
+
+static stat_t _dispatch_binary()
+{
+#if XIO_BINARY_CHANNEL_ENABLED == true
+    xioBinaryMove_t move;
+    stat_t status = STAT_OK;
+
+    if ((cs.controller_state == CONTROLLER_PAUSED) || (!xio_binary_read_move(&move)))
+    {
+        return (STAT_NOOP);
+    }
+    if ((status = cm_is_alarmed()) == STAT_OK)
+    {
+        jr_count_line();
+        cm_set_model_linenum(move.linenum);
+        if (move.move_flags & XIO_BINARY_FEED)
+        {
+            status = cm_set_feed_rate(move.feed_rate);
+        }
+        if (status == STAT_OK)
+        {
+            if (move.move_flags & XIO_BINARY_TRAVERSE)
+            {
+                status = cm_straight_traverse(move.target, move.flags, PROFILE_NORMAL);
+            }
+            else
+            {
+                status = cm_straight_feed(move.target, move.flags, PROFILE_NORMAL);
+            }
+        }
+    }
+    if (status != STAT_OK)
+    {
+        rpt_exception(status, "binary move");
+    }
+    return (STAT_EAGAIN);
+#else
+    return (STAT_NOOP);
+#endif
+}
+
 static void _dispatch_kernel(const devflags_t flags)
 {
     stat_t status;
@@ -295,11 +505,13 @@ static void _dispatch_kernel(const devflags_t flags)
     {
         cm_request_queue_flush();
         xio_flush_to_command();
+        xio_usart_flush_to_command();
     }
     else if (*cs.bufp == EOT)
     {
         cm_request_job_kill();
         xio_flush_to_command();
+        xio_usart_flush_to_command();
     }
     else if (*cs.bufp == ENQ)
     {
@@ -319,6 +531,23 @@ static void _dispatch_kernel(const devflags_t flags)
         cs.comm_request_mode = JSON_MODE; // mode of this command
         json_parser(cs.bufp);
     }
+    else if (job_recording() && (strchr("$?Hh", *cs.bufp) == NULL))
+    { // Gcode is stored, not run, while a job is being recorded
+        status = job_write_line(cs.bufp);
+#ifdef __TEXT_MODE
+        if (js.json_mode == TEXT_MODE)
+        {
+            text_response(status, cs.saved_buf);
+            return;
+        }
+#endif
+        cs.comm_request_mode = JSON_MODE; // mode of this command
+        nvObj_t *nv = nv_reset_nv_list();
+        strcpy(nv->token, "gc");
+        nv_copy_string(nv, cs.bufp);
+        nv->valuetype = TYPE_STRING;
+        nv_print_list(status, TEXT_NO_PRINT, JSON_RESPONSE_FORMAT);
+    }
 #ifdef __TEXT_MODE
     else if (strchr("$?Hh", *cs.bufp) != NULL)
     { // process as text mode
@@ -328,8 +557,8 @@ static void _dispatch_kernel(const devflags_t flags)
         }                                 // switch to text mode
         cs.comm_request_mode = TEXT_MODE; // mode of this command
         status = text_parser(cs.bufp);
-        if (js.json_mode == TEXT_MODE)
-        { // needed in case mode was changed by $EJ=1
+        if ((js.json_mode == TEXT_MODE) && !nv_dump_pending())
+        { // needed in case mode was changed by $EJ=1. An uber group display sends its own prompt
             text_response(status, cs.saved_buf);
         }
     }
@@ -527,17 +756,21 @@ static stat_t _led_indicator()
 }
 
 /*
- * _sync_to_tx_buffer() - return eagain if TX queue is backed up
+ * _sync_to_tx_buffer() - return eagain while an uber group display is being sent
  * _sync_to_planner() - return eagain if planner is not ready for a new command
  */
 static stat_t _sync_to_tx_buffer()
 {
-    return (STAT_OK);
+    stat_t status = nv_dump_callback();
+    if ((status == STAT_OK) && (js.json_mode == TEXT_MODE)) {
+        text_response(STAT_OK, cs.saved_buf);      // the prompt held back until the display was sent
+    }
+    return ((status == STAT_EAGAIN) ? STAT_EAGAIN : STAT_OK);
 }
 
 static stat_t _sync_to_planner()
 {
-    if (mp_planner_is_full(mp))
+    if (mp_planner_is_full(mp) || raster_is_full())
     { // 允许此行最多N个计划缓冲区
         return (STAT_EAGAIN);
     }
@@ -547,30 +780,72 @@ static stat_t _sync_to_planner()
 /****************************************************************************************
  * ALARM STATE HANDLERS
  *
- * _shutdown_handler() - 将系统置于关机状态
- * _limit_switch_handler() - shut down system if limit switch fired
- * _interlock_handler() - feedhold and resume depending on edge
+ * _input_event_handler() - act on limit, shutdown and interlock edges queued by the input ISR
+ * _safe_pin_handler() - toggle the SAFE pin on every pass unless alarmed, shut down or panicked
  *
- *    Some handlers return EAGAIN causing the control loop to never advance beyond that point.
+ *    The input ISR posts an event and wakes _input_event_handler(), so nothing is polled
+ *    on every pass. The handler runs early in the table and drains the whole queue.
  *
- * _interlock_handler() reacts the follwing ways:
- *   - safety_interlock_requested == INPUT_EDGE_NONE is normal operation (no interlock)
- *   - safety_interlock_requested == INPUT_EDGE_LEADING is interlock onset
- *   - safety_interlock_requested == INPUT_EDGE_TRAILING is interlock offset
+ *  Events react the following ways:
+ *   - limit (leading edge) raises an alarm if limits are enabled
+ *   - shutdown (leading edge) shuts the machine down
+ *   - interlock leading edge is interlock onset: feedhold with FEEDHOLD_EXIT_INTERLOCK
+ *   - interlock trailing edge is interlock offset: the cycle restarts once the runtime
+ *     is idle. Until then the request stays in safety_interlock_reengaged and the task's
+ *     period paces the check. A new onset cancels it.
  */
-static stat_t _shutdown_handler(void)
+static stat_t _input_event_handler(void)
 {
-    if (cm->shutdown_requested != 0)
-    { // request may contain the (non-zero) input number
-        char msg[10];
-        sprintf(msg, "input %d", (int)cm->shutdown_requested);
-        cm->shutdown_requested = false; // clear limit request used here ^
-        cm_shutdown(STAT_SHUTDOWN, msg);
+    gpioEvent_t event;
+    char msg[10];
+
+    if (gpio_events_lost()) {
+        cm_alarm(STAT_ALARM, "input events lost");
+    }
+    while (gpio_get_event(&event)) {
+        sprintf(msg, "input %d", (int)event.input);
+        switch (event.function) {
+            case INPUT_FUNCTION_SHUTDOWN: {
+                cm_shutdown(STAT_SHUTDOWN, msg);
+                break;
+            }
+            case INPUT_FUNCTION_LIMIT: {
+                if (cm->limit_enable == true) {
+                    cm_alarm(STAT_LIMIT_SWITCH_HIT, msg);
+                }
+                break;
+            }
+            case INPUT_FUNCTION_INTERLOCK: {
+                if (!cm->safety_interlock_enable) {
+                    break;
+                }
+                if (event.edge == INPUT_EDGE_LEADING) {     // interlock broken
+                    cm->safety_interlock_reengaged = 0;
+                    cm->safety_interlock_state = SAFETY_INTERLOCK_DISENGAGED;
+                    cm_request_feedhold(FEEDHOLD_TYPE_ACTIONS, FEEDHOLD_EXIT_INTERLOCK); // may have already requested STOP as INPUT_ACTION
+                    // feedhold was initiated by input action in gpio
+                    // pause spindle
+                    // pause coolant
+                } else {
+                    cm->safety_interlock_reengaged = event.input;
+                }
+                break;
+            }
+            default: { break; }
+        }
+    }
+
+    // interlock restored
+    if ((cm->safety_interlock_reengaged != 0) && (mp_runtime_is_idle())) {
+        cm->safety_interlock_reengaged = 0;
+        cm->safety_interlock_state = SAFETY_INTERLOCK_ENGAGED;
+//      cm_request_exit_hold();                                 // use cm_request_exit_hold() instead of just ending +++++
+        cm_request_cycle_start();                               // proper way to restart the cycle
     }
     return (STAT_OK);
 }
 
-static stat_t _limit_switch_handler(void)
+static stat_t _safe_pin_handler(void)
 {
     auto machine_state = cm_get_machine_state();
     if ((machine_state != MACHINE_ALARM) &&
@@ -579,49 +854,22 @@ static stat_t _limit_switch_handler(void)
     {
         safe_pin.toggle();
     }
-    if ((cm->limit_enable == true) && (cm->limit_requested != 0))
-    {
-        char msg[10];
-        sprintf(msg, "input %d", (int)cm->limit_requested);
-        cm->limit_requested = false; // clear limit request used here ^
-        cm_alarm(STAT_LIMIT_SWITCH_HIT, msg);
-    }
-    return (STAT_OK);
-}
-
-static stat_t _interlock_handler(void)
-{
-    if (cm->safety_interlock_enable)
-    {
-        // interlock broken
-        if (cm->safety_interlock_disengaged != 0)
-        {
-            cm->safety_interlock_disengaged = 0;
-            cm->safety_interlock_state = SAFETY_INTERLOCK_DISENGAGED;
-            cm_request_feedhold(FEEDHOLD_TYPE_ACTIONS, FEEDHOLD_EXIT_INTERLOCK); // may have already requested STOP as INPUT_ACTION
-            // feedhold was initiated by input action in gpio
-            // pause spindle
-            // pause coolant
-        }
-
-        // interlock restored
-        if ((cm->safety_interlock_reengaged != 0) && (mp_runtime_is_idle()))
-        {
-            cm->safety_interlock_reengaged = 0;
-            cm->safety_interlock_state = SAFETY_INTERLOCK_ENGAGED; // interlock restored
-                                                                   //            cm_request_exit_hold();                                 // use cm_request_exit_hold() instead of just ending +++++
-            cm_request_cycle_start();                              // proper way to restart the cycle
-        }
-    }
+    sync_callback();                            // the task table is full - sync lines follow the SAFE pin
     return (STAT_OK);
 }
 
 /****************************************************************************************
  * _init_assertions() - initialize controller memory integrity assertions
  * _test_assertions() - check controller memory integrity assertions
- * _test_system_assertions() - check assertions for entire system
+ * _test_system_assertions() - check assertions for one subsystem per call, round robin
+ *
+ *  A full sweep takes ASSERTION_SUBSYSTEMS calls, i.e. ASSERTION_SUBSYSTEMS * CONTROLLER_ASSERTION_MS.
+ *  With CONTROLLER_ASSERTION_LOW_PRIORITY the task is skipped on passes where a task above
+ *  it returns EAGAIN, so the sweep can take longer while the planner is being filled.
  */
 
+#define ASSERTION_SUBSYSTEMS 9
+
 static void _init_assertions()
 {
     cs.magic_start = MAGICNUM;
@@ -639,15 +887,22 @@ static stat_t _test_assertions()
 
 stat_t _test_system_assertions()
 {
+    static uint8_t subsystem = 0;
+
     // these functions will panic if an assertion fails
-    _test_assertions(); // controller assertions (local)
-    config_test_assertions();
-    canonical_machine_test_assertions(&cm1);
-    canonical_machine_test_assertions(&cm2);
-    planner_assert(&mp1);
-    planner_assert(&mp2);
-    stepper_test_assertions();
-    encoder_test_assertions();
-    xio_test_assertions();
+    switch (subsystem) {
+        case 0: { _test_assertions(); break; }  // controller assertions (local)
+        case 1: { config_test_assertions(); break; }
+        case 2: { canonical_machine_test_assertions(&cm1); break; }
+        case 3: { canonical_machine_test_assertions(&cm2); break; }
+        case 4: { planner_assert(&mp1); break; }
+        case 5: { planner_assert(&mp2); break; }
+        case 6: { stepper_test_assertions(); break; }
+        case 7: { encoder_test_assertions(); break; }
+        case 8: { xio_test_assertions(); break; }
+    }
+    if (++subsystem == ASSERTION_SUBSYSTEMS) {
+        subsystem = 0;
+    }
     return (STAT_OK);
 }
@@ -29,6 +29,7 @@
 #define CONTROLLER_H_ONCE
 
 #include "xio.h"
+#include "settings.h"     // for MARLIN_COMPAT_ENABLED and TEMPERATURE_ENABLED
 
 // see also: g2core.h MESSAGE_LEN and config.h NV_ lengths
 #define SAVED_BUFFER_LEN RX_BUFFER_SIZE //滺Сڱ
@@ -48,6 +49,86 @@ typedef enum {                          //
     CONTROLLER_PAUSED                   // ͣ - Ϊˢ׼
 } csControllerState;
 
+#ifndef DISPATCH_BATCH_LINES
+#define DISPATCH_BATCH_LINES 8          // max complete Gcode lines parsed in one controller pass (1 = no batching)
+#endif
+#ifndef DISPATCH_BATCH_MS
+#define DISPATCH_BATCH_MS 2             // time budget for a batch (ms)
+#endif
+
+// controller task periods (ms). 0 runs the task on every pass
+#ifndef CONTROLLER_LED_MS
+#define CONTROLLER_LED_MS 10            // LED indicator (blink rates are 100 ms or more)
+#endif
+#ifndef CONTROLLER_INPUT_EVENT_MS
+#define CONTROLLER_INPUT_EVENT_MS 100   // input events wake their task; this only paces a pending interlock restart
+#endif
+#ifndef CONTROLLER_TEMPERATURE_MS
+#define CONTROLLER_TEMPERATURE_MS 10    // heater safety
+#endif
+#ifndef CONTROLLER_TEMPERATURE_PID_MS
+#define CONTROLLER_TEMPERATURE_PID_MS 100   // heater PID update rate - the PID gains are tuned for this period
+#endif
+#ifndef CONTROLLER_ASSERTION_MS
+#define CONTROLLER_ASSERTION_MS 10      // system integrity assertions - one subsystem per run
+#endif
+#ifndef CONTROLLER_ASSERTION_LOW_PRIORITY
+#define CONTROLLER_ASSERTION_LOW_PRIORITY false // true runs the assertions after the Gcode and cycle tasks
+#endif
+#ifndef CONTROLLER_REPORT_MS
+#define CONTROLLER_REPORT_MS 10         // timed status and queue reports; requests wake them early
+#endif
+#ifndef CONTROLLER_JOB_REPORT_MS
+#define CONTROLLER_JOB_REPORT_MS 10     // job report sampling of starved and feedhold time
+#endif
+
+typedef enum {                          // controller tasks in priority (dispatch) order
+    CONTROLLER_TASK_DRIVER_FAULTS = 0,  // must match the order of the task table in controller.cpp (checked there)
+    CONTROLLER_TASK_LED,
+    CONTROLLER_TASK_INPUT_EVENTS,
+#if TEMPERATURE_ENABLED == true
+    CONTROLLER_TASK_TEMPERATURE,
+    CONTROLLER_TASK_TEMPERATURE_PID,
+#endif
+    CONTROLLER_TASK_SAFE_PIN,
+    CONTROLLER_TASK_STATE,
+#if CONTROLLER_ASSERTION_LOW_PRIORITY == false
+    CONTROLLER_TASK_ASSERTIONS,
+#endif
+    CONTROLLER_TASK_CONTROL,
+    CONTROLLER_TASK_MOTOR_POWER,
+    CONTROLLER_TASK_DRIVER_STATUS,
+    CONTROLLER_TASK_STATUS_REPORT,
+    CONTROLLER_TASK_BINARY_REPORT,
+    CONTROLLER_TASK_QUEUE_REPORT,
+    CONTROLLER_TASK_JOB_REPORT,
+    CONTROLLER_TASK_ENCODER,
+#if EXEC_SEGMENT_TABLE == true
+    CONTROLLER_TASK_EXEC_TABLE,
+#endif
+    CONTROLLER_TASK_PLANNER,
+    CONTROLLER_TASK_OPERATION,
+    CONTROLLER_TASK_ARC,
+    CONTROLLER_TASK_HOMING,
+    CONTROLLER_TASK_PROBING,
+    CONTROLLER_TASK_JOGGING,
+    CONTROLLER_TASK_DEFERRED_WRITE,
+    CONTROLLER_TASK_FEEDHOLD_BLOCKER,
+    CONTROLLER_TASK_MACRO,
+    CONTROLLER_TASK_JOB,
+#if MARLIN_COMPAT_ENABLED == true
+    CONTROLLER_TASK_MARLIN,
+#endif
+#if CONTROLLER_ASSERTION_LOW_PRIORITY == true
+    CONTROLLER_TASK_ASSERTIONS,
+#endif
+    CONTROLLER_TASK_SYNC_PLANNER,
+    CONTROLLER_TASK_SYNC_TX,
+    CONTROLLER_TASK_BINARY,
+    CONTROLLER_TASK_COMMAND,
+    CONTROLLER_TASK_COUNT
+} ctrlTask;
+
 typedef struct controllerSingleton {    // main TG controller struct
     magic_t magic_start;                // magic number to test memory integrity
     float null;                         // dumping ground for items with no target
@@ -60,6 +141,8 @@ typedef struct controllerSingleton {    // main TG controller struct
     csControllerState controller_state;
     uint32_t led_timer;                 // used to flash indicator LED
     uint32_t led_blink_rate;            // used to flash indicator LED
+    volatile uint32_t task_ready;       // one bit per ctrlTask - run on the next pass regardless of period
+    uint32_t task_next[CONTROLLER_TASK_COUNT];  // systick at which a periodic task is next due
 
     // communications state variables
     // useful to know: 
@@ -89,6 +172,7 @@ void controller_init(void);
 void controller_run(void);
 void controller_set_connected(bool is_connected);
 void controller_set_muted(bool is_muted);
+void controller_wake_task(const ctrlTask task);
 bool controller_parse_control(char *p);
 
 #endif // End of include guard: CONTROLLER_H_ONCE
@@ -79,10 +79,15 @@ stat_t coolant_control_sync(coControl control, coSelect select)
         return (STAT_OK);
     }
     
-    // queue the coolant control
-    float value[] = { (float)control };
-    bool flags[]  = { (select & COOLANT_MIST), (select & COOLANT_FLOOD) };
-    mp_queue_command(_exec_coolant_control, value, flags);
+    // queue the coolant control. M7, M8 and M9 run at the end of the last move without
+    // stopping; feedhold pause and resume stay in line with the hold's other actions
+    float value[MP_ACTION_VALUES] = { (float)control };
+    bool flags[AXES] = { (select & COOLANT_MIST), (select & COOLANT_FLOOD) };
+    if ((control == COOLANT_ON) || (control == COOLANT_OFF)) {
+        mp_queue_inline_action(_exec_coolant_control, value, flags);
+    } else {
+        mp_queue_action(_exec_coolant_control, value, flags);
+    }
     return(STAT_OK);
 }
 
@@ -0,0 +1,384 @@
+/*
+ * cycle_drilling.cpp - canned drilling cycle extension to canonical_machine.cpp
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * CANNED DRILLING CYCLES
+ *
+ *  A canned cycle block drills one hole (or L holes) and leaves the cycle modal, so the
+ *  lines that follow need only carry the next hole position:
+ *
+ *      G81  drill - feed to Z, rapid out
+ *      G82  drill with dwell - feed to Z, dwell P seconds, rapid out
+ *      G83  peck drill - feed Q at a time, rapid out to R between pecks
+ *      G85  bore - feed to Z, feed out to R
+ *      G89  bore with dwell - feed to Z, dwell P seconds, feed out to R
+ *
+ *  G84 and G86 - G88 need spindle synchronization or operator action and are not
+ *  supported. Cycles run in the XY plane (G17) with Z as the drilling axis, and not in
+ *  inverse time mode. R, Z, Q and P are sticky until the cycle is left by G80 or another
+ *  motion mode. G98 retracts to the Z the block started at (or R if that is higher), G99
+ *  to R. In G91 X and Y are steps from the previous hole, R is relative to the starting Z
+ *  and Z is relative to R; L repeats the step.
+ *
+ *  cm_canned_cycle() only checks the block and latches its parameters. The moves are
+ *  generated from the controller by cm_canned_cycle_callback(), which queues them in
+ *  batches until the planner is full, the same way cm_arc_callback() queues arc segments.
+ *  Line dispatch waits while a cycle is generating. Moves are queued through the
+ *  canonical traverse and feed functions, so soft limits, offsets and the model position
+ *  apply as they would for G0 and G1 lines.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "report.h"
+#include "util.h"
+#include "xio.h"
+
+/**** Local stuff ****/
+
+#ifndef DRILL_BATCH_MOVES
+#define DRILL_BATCH_MOVES 8                 // max cycle moves queued in one controller pass
+#endif
+#ifndef DRILL_BATCH_MS
+#define DRILL_BATCH_MS 1                    // time budget for a batch (ms)
+#endif
+#define DRILL_PECK_CLEARANCE 0.254          // mm above the last peck depth to rapid back down to
+
+typedef enum {                              // next move of the cycle
+    DRILL_CLIMB = 0,                        // rapid up to R if the block starts below it
+    DRILL_XY,                               // rapid to the hole
+    DRILL_TO_R,                             // rapid down to R
+    DRILL_FEED,                             // feed to the bottom (or the next peck depth)
+    DRILL_DWELL,                            // G82, G89 dwell at the bottom
+    DRILL_PECK_OUT,                         // G83 rapid out to R
+    DRILL_PECK_IN,                          // G83 rapid back to just above the last depth
+    DRILL_FEED_OUT,                         // G85, G89 feed out to R
+    DRILL_RETRACT                           // rapid to the retract level, then the next hole
+} drillMove;
+
+struct dcDrillingSingleton {                // persistent drilling cycle variables
+    bool active;                            // true while moves are being generated
+    cmMotionMode motion_mode;               // cycle being run
+    cmRetractMode retract_mode;             // G98, G99
+
+    // sticky cycle parameters (work coordinates in mm)
+    bool r_set;
+    bool bottom_set;
+    bool peck_set;
+    float r_plane;                          // R level
+    float bottom;                           // Z bottom of the hole
+    float peck;                             // G83 Q increment
+    float dwell;                            // G82, G89 P seconds
+
+    // the block being run
+    drillMove move;                         // next move to queue
+    float hole[2];                          // XY of the hole being drilled
+    float step[2];                          // G91 XY step between repeats
+    float clear_z;                          // level to retract to between holes
+    float depth;                            // G83 depth reached so far
+    uint16_t repeats;                       // holes left to drill, including this one
+};
+static struct dcDrillingSingleton dc;
+
+static stat_t _drill_move(void);
+
+/**** NOTE: global prototypes and other .h info is located in canonical_machine.h ****/
+
+static bool _is_drilling_mode(const cmMotionMode motion_mode)
+{
+    return ((motion_mode == MOTION_MODE_CANNED_CYCLE_81) || (motion_mode == MOTION_MODE_CANNED_CYCLE_82) ||
+            (motion_mode == MOTION_MODE_CANNED_CYCLE_83) || (motion_mode == MOTION_MODE_CANNED_CYCLE_85) ||
+            (motion_mode == MOTION_MODE_CANNED_CYCLE_89));
+}
+
+static float _to_mm(const float value)
+{
+    return ((cm->gm.units_mode == INCHES) ? (value * MM_PER_INCH) : value);
+}
+
+static float _work_position(const uint8_t axis)
+{
+    return (cm->gmx.position[axis] - cm_get_combined_offset(axis));
+}
+
+/*
+ * cm_set_retract_mode() - G98, G99
+ */
+
+stat_t cm_set_retract_mode(const uint8_t mode)
+{
+    dc.retract_mode = (cmRetractMode)mode;
+    return (STAT_OK);
+}
+
+/*
+ * cm_canned_cycle() - canonical machine entry point for G81, G82, G83, G85 and G89
+ *
+ *  Values are in the units and distance mode of the block, as for the other canonical
+ *  motion functions. A block with none of X, Y, Z or R only sets the motion mode.
+ */
+
+stat_t cm_canned_cycle(const cmMotionMode motion_mode,
+                       const float target[], const bool flags[],    // XYZ of the hole
+                       const float R_word, const bool R_flag,       // R plane
+                       const float Q_word, const bool Q_flag,       // G83 peck increment
+                       const float P_word, const bool P_flag,       // G82, G89 dwell
+                       const uint8_t L_word, const bool L_flag)     // repeats
+{
+    if (!_is_drilling_mode(motion_mode)) {
+        return (STAT_GCODE_COMMAND_UNSUPPORTED);
+    }
+    if (cm->gm.select_plane != CANON_PLANE_XY) {
+        return (STAT_ACTIVE_PLANE_IS_INVALID);
+    }
+    if (cm->gm.feed_rate_mode == INVERSE_TIME_MODE) {
+        return (STAT_INVERSE_TIME_MODE_CANNOT_BE_USED);
+    }
+    if (fp_ZERO(cm->gm.feed_rate)) {
+        return (STAT_FEEDRATE_NOT_SPECIFIED);
+    }
+    if (!_is_drilling_mode(cm->gm.motion_mode)) {   // entering the cycle drops the sticky values
+        dc.r_set = false;
+        dc.bottom_set = false;
+        dc.peck_set = false;
+        dc.dwell = 0;
+    }
+    cm->gm.motion_mode = motion_mode;
+    if (!(flags[AXIS_X] || flags[AXIS_Y] || flags[AXIS_Z] || R_flag)) {
+        return (STAT_OK);
+    }
+    bool incremental = (cm->gm.distance_mode == INCREMENTAL_DISTANCE_MODE);
+    float position[3] = { _work_position(AXIS_X), _work_position(AXIS_Y), _work_position(AXIS_Z) };
+
+    if (R_flag) {
+        dc.r_plane = _to_mm(R_word) + (incremental ? position[AXIS_Z] : 0);
+        dc.r_set = true;
+    }
+    if (!dc.r_set) {
+        return (STAT_R_WORD_IS_MISSING);
+    }
+    if (flags[AXIS_Z]) {
+        dc.bottom = _to_mm(target[AXIS_Z]) + (incremental ? dc.r_plane : 0);
+        dc.bottom_set = true;
+    }
+    if (!dc.bottom_set) {
+        return (STAT_AXIS_IS_MISSING);
+    }
+    if (dc.bottom > dc.r_plane) {
+        return (STAT_R_WORD_IS_INVALID);            // R must be at or above the bottom
+    }
+    if (motion_mode == MOTION_MODE_CANNED_CYCLE_83) {
+        if (Q_flag) {
+            if (Q_word <= 0) {
+                return (STAT_Q_WORD_IS_INVALID);
+            }
+            dc.peck = _to_mm(Q_word);
+            dc.peck_set = true;
+        }
+        if (!dc.peck_set) {
+            return (STAT_Q_WORD_IS_MISSING);
+        }
+    }
+    if (P_flag) {
+        if (P_word < 0) {
+            return (STAT_P_WORD_IS_NEGATIVE);
+        }
+        dc.dwell = P_word;
+    }
+    if (L_flag && (L_word < 1)) {
+        return (STAT_L_WORD_IS_INVALID);
+    }
+    dc.repeats = L_flag ? L_word : 1;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        if (incremental) {
+            dc.step[i] = flags[AXIS_X + i] ? _to_mm(target[AXIS_X + i]) : 0;
+            dc.hole[i] = position[i] + dc.step[i];
+        } else {
+            dc.step[i] = 0;
+            dc.hole[i] = flags[AXIS_X + i] ? _to_mm(target[AXIS_X + i]) : position[i];
+        }
+    }
+    dc.clear_z = (dc.retract_mode == RETRACT_OLD_Z) ? max(position[AXIS_Z], dc.r_plane) : dc.r_plane;
+    dc.move = (position[AXIS_Z] < dc.r_plane) ? DRILL_CLIMB : DRILL_XY;
+    dc.motion_mode = motion_mode;
+    dc.active = true;
+    return (STAT_OK);
+}
+
+/*
+ * cm_canned_cycle_running() - true while a cycle is queuing moves
+ * cm_abort_canned_cycle()   - stop queuing cycle moves (queue flush)
+ */
+
+bool cm_canned_cycle_running() { return (dc.active); }
+
+void cm_abort_canned_cycle() { dc.active = false; }
+
+/*
+ * cm_canned_cycle_callback() - queue the moves of a canned cycle block
+ *
+ *  Runs only for the primary machine; a feedhold that switches to the secondary planner
+ *  leaves the rest of the block queued for after the hold. Moves are given in absolute mm
+ *  work coordinates, so the distance and units modes are switched for the batch and put
+ *  back, and the motion mode is restored to the cycle after the G0/G1 calls.
+ */
+
+stat_t cm_canned_cycle_callback()
+{
+    if (!dc.active || (cm != &cm1)) {
+        return (STAT_NOOP);
+    }
+    cmDistanceMode distance_mode = cm->gm.distance_mode;
+    cmUnitsMode units_mode = cm->gm.units_mode;
+    cm->gm.distance_mode = ABSOLUTE_DISTANCE_MODE;
+    cm->gm.units_mode = MILLIMETERS;
+
+    uint32_t batch_start = SysTickTimer_getValue();
+    stat_t status = STAT_EAGAIN;
+
+    for (uint8_t moves = 0; moves < DRILL_BATCH_MOVES; moves++) {
+        if (mp_planner_is_full(mp)) {
+            break;
+        }
+        if ((status = _drill_move()) != STAT_EAGAIN) {
+            break;
+        }
+        if ((SysTickTimer_getValue() - batch_start) >= DRILL_BATCH_MS) {
+            break;
+        }
+    }
+    cm->gm.distance_mode = distance_mode;
+    cm->gm.units_mode = units_mode;
+    cm->gm.motion_mode = dc.motion_mode;
+
+    if (status != STAT_EAGAIN) {
+        dc.active = false;
+        if (status != STAT_OK) {
+            rpt_exception(status, "canned cycle stopped");
+        }
+    }
+    return (status);
+}
+
+static stat_t _drill_rapid_z(const float z)
+{
+    float target[AXES] = {0};
+    bool flags[AXES] = {0};
+    target[AXIS_Z] = z;
+    flags[AXIS_Z] = true;
+    return (cm_straight_traverse(target, flags, PROFILE_NORMAL));
+}
+
+static stat_t _drill_feed_z(const float z)
+{
+    float target[AXES] = {0};
+    bool flags[AXES] = {0};
+    target[AXIS_Z] = z;
+    flags[AXIS_Z] = true;
+    return (cm_straight_feed(target, flags, PROFILE_NORMAL));
+}
+
+/*
+ * _drill_move() - queue the next move of the cycle
+ *
+ *  Returns STAT_EAGAIN if there are more, STAT_OK after the last retract, or an error.
+ */
+
+static stat_t _drill_move()
+{
+    switch (dc.move) {
+        case DRILL_CLIMB: {
+            dc.move = DRILL_XY;
+            ritorno(_drill_rapid_z(dc.r_plane));
+            break;
+        }
+        case DRILL_XY: {
+            float target[AXES] = {0};
+            bool flags[AXES] = {0};
+            target[AXIS_X] = dc.hole[0];
+            target[AXIS_Y] = dc.hole[1];
+            flags[AXIS_X] = true;
+            flags[AXIS_Y] = true;
+            dc.move = DRILL_TO_R;
+            ritorno(cm_straight_traverse(target, flags, PROFILE_NORMAL));
+            break;
+        }
+        case DRILL_TO_R: {
+            dc.depth = dc.r_plane;
+            dc.move = DRILL_FEED;
+            ritorno(_drill_rapid_z(dc.r_plane));
+            break;
+        }
+        case DRILL_FEED: {
+            dc.depth = (dc.motion_mode == MOTION_MODE_CANNED_CYCLE_83) ? max(dc.depth - dc.peck, dc.bottom) : dc.bottom;
+            if (dc.depth > dc.bottom) {
+                dc.move = DRILL_PECK_OUT;
+            } else if ((dc.motion_mode == MOTION_MODE_CANNED_CYCLE_82) || (dc.motion_mode == MOTION_MODE_CANNED_CYCLE_89)) {
+                dc.move = DRILL_DWELL;
+            } else if (dc.motion_mode == MOTION_MODE_CANNED_CYCLE_85) {
+                dc.move = DRILL_FEED_OUT;
+            } else {
+                dc.move = DRILL_RETRACT;
+            }
+            ritorno(_drill_feed_z(dc.depth));
+            break;
+        }
+        case DRILL_DWELL: {
+            dc.move = (dc.motion_mode == MOTION_MODE_CANNED_CYCLE_89) ? DRILL_FEED_OUT : DRILL_RETRACT;
+            ritorno(cm_dwell(dc.dwell));
+            break;
+        }
+        case DRILL_PECK_OUT: {
+            dc.move = DRILL_PECK_IN;
+            ritorno(_drill_rapid_z(dc.r_plane));
+            break;
+        }
+        case DRILL_PECK_IN: {
+            dc.move = DRILL_FEED;
+            ritorno(_drill_rapid_z(min(dc.depth + (float)DRILL_PECK_CLEARANCE, dc.r_plane)));
+            break;
+        }
+        case DRILL_FEED_OUT: {
+            dc.move = DRILL_RETRACT;
+            ritorno(_drill_feed_z(dc.r_plane));
+            break;
+        }
+        case DRILL_RETRACT: {
+            ritorno(_drill_rapid_z(dc.clear_z));
+            if (--dc.repeats == 0) {
+                return (STAT_OK);
+            }
+            dc.hole[0] += dc.step[0];
+            dc.hole[1] += dc.step[1];
+            dc.move = DRILL_XY;
+            break;
+        }
+    }
+    return (STAT_EAGAIN);
+}
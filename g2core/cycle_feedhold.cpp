@@ -1,4 +1,4 @@
-/*
+﻿/*
  * cycle_feedhold.cpp - canonical machine feedhold processing
  * This file is part of the g2core project
  *
@@ -35,6 +35,10 @@
 #include "stepper.h"
 #include "spindle.h"
 #include "coolant.h"
+#include "macro.h"
+#include "job.h"
+#include "raster.h"
+#include "sync.h"
 #include "util.h"
 //#include "xio.h"        // DIAGNOSTIC
 
@@ -410,6 +414,10 @@ static void _start_queue_flush()
 static stat_t _run_queue_flush()            // typically runs from cm1 planner
 {
     cm_abort_arc(cm);                       // kill arcs so they don't just create more alines
+    cm_abort_canned_cycle();                // ...and canned cycles, likewise
+    mc_abort_macro();                       // ...and macros so they don't queue more lines
+    job_abort();                            // ...and the stored job, likewise
+    raster_reset();                         // ...and raster pixels for the flushed moves
     planner_reset((mpPlanner_t *)cm->mp);   // reset primary planner. also resets the mr under the planner
     cm_reset_position_to_absolute_position(cm);
     cm1.queue_flush_state = QUEUE_FLUSH_OFF;
@@ -520,6 +528,7 @@ void cm_request_feedhold(cmFeedholdType type, cmFeedholdExit exit)
     if ((cm1.hold_state == FEEDHOLD_OFF) &&
         (cm1.machine_state == MACHINE_CYCLE) && (cm1.motion_state == MOTION_RUN)) {
 
+        sync_hold_requested();                  // hold the other board too
         cm1.hold_type = type;
         cm1.hold_exit = exit;
         cm1.hold_profile = ((type == FEEDHOLD_TYPE_ACTIONS) || (type == FEEDHOLD_TYPE_HOLD)) ?
@@ -586,14 +595,15 @@ static void _enter_p2()
     cm2.gm.feed_rate = 0;
     cm2.arc.run_state = BLOCK_INACTIVE;     // Stop a running p1 arc from continuing to execute in p2
 
-    // Set mp planner to p2 and reset it
+    // Set mp planner to p2 and reset it, on the shared pool buffers if p1 isn't using them
+    mp_pool_lend();
     cm2.mp = &mp2;
     planner_reset((mpPlanner_t *)cm2.mp);   // mp is a void pointer
 
     // Clear the target and set the positions to the current hold position
     memset(&(cm2.return_flags), 0, sizeof(cm2.return_flags));
     memset(&(cm2.gm.target), 0, sizeof(cm2.gm.target));
-    memset(&(cm2.gm.target_comp), 0, sizeof(cm2.gm.target_comp)); // zero Kahan compensation
+    memset(&(mr2.target_comp), 0, sizeof(mr2.target_comp));     // zero Kahan compensation
 
     copy_vector(cm2.gmx.position, mr1.position);
     copy_vector(mp2.position, mr1.position);
@@ -604,6 +614,11 @@ static void _enter_p2()
     copy_vector(mr2.position_steps, mr1.position_steps);
     copy_vector(mr2.commanded_steps, mr1.commanded_steps);
     copy_vector(mr2.encoder_steps, mr1.encoder_steps);  // NB: following error is re-computed in p2
+    copy_vector(mr2.target_fixed, mr1.target_fixed);
+    copy_vector(mr2.position_fixed, mr1.position_fixed);
+    copy_vector(mr2.commanded_fixed, mr1.commanded_fixed);
+    mr2.motor_settle = mr1.motor_settle | mr1.motor_mask;   // p2's first block may not move them
+    mr2.motor_mask = 0;
 
     // Reassign the globals to the secondary CM
     cm = &cm2;
@@ -629,11 +644,11 @@ static void _check_motion_stopped()
         if (cm->hold_type == FEEDHOLD_TYPE_SKIP) {
             copy_vector(mp->position, mr->position);    // update planner position to the final runtime position
             mp_free_run_buffer();                       // advance to next block, discarding the rest of the move
+            mp_unplan_queue(mp_get_r());                // the moves planned ahead entered at speed
         } else { // Otherwise setup the block to complete motion (regardless of how hold will ultimately be exited)
-            bf->length = get_axis_vector_length(mr->position, mr->target); // update bf w/remaining length in move
+            bf->length = mp_get_runtime_remaining_length(); // update bf w/remaining length in move
             bf->block_state = BLOCK_INITIAL_ACTION;     // tell _exec to re-use the bf buffer
-            bf->buffer_state = MP_BUFFER_BACK_PLANNED;  // so it can be forward planned again
-            bf->plannable = true;                       // needed so block can be re-planned
+            mp_unplan_queue(bf);                        // so it and the moves planned ahead are forward planned again
         }
         mr->reset();                                    // reset MR for next use and for forward planning
         cm_set_motion_state(MOTION_STOP);
@@ -679,7 +694,7 @@ static stat_t _feedhold_no_actions()
     }
     // complete the feedhold
     mp_replan_queue(mp_get_r());                // unplan current forward plan (bf head block), and reset all blocks
-    st_request_forward_plan();                  // replan from the new bf buffer
+    st_request_forward_plan();                  // plan the resume from zero velocity now (see mp_exit_hold_state())
     cm1.hold_state = FEEDHOLD_HOLD;
     return (STAT_OK);
 }
@@ -798,10 +813,10 @@ static stat_t _feedhold_restart_with_actions()   // Execute Cases (6) and (7)
 
 static stat_t _run_restart_cycle(void)
 {
-    cm1.hold_state = FEEDHOLD_OFF;          // must precede st_request_exec_move()
+    cm1.hold_state = FEEDHOLD_OFF;          // must precede mp_exit_hold_state()
     if (mp_has_runnable_buffer(&mp1)) {
         cm_cycle_start();
-        st_request_exec_move();
+        mp_exit_hold_state();               // the resume was planned during the hold
     } else {
         cm_cycle_end();
     }
@@ -37,29 +37,37 @@
 #include "kinematics.h"
 #include "gpio.h"
 #include "report.h"
+#include "stepper.h"
 #include "util.h"
 
+#ifndef HOMING_SIMULTANEOUS_XY      // boards can override this value in hardware.h
+#define HOMING_SIMULTANEOUS_XY true // home X and Y together when they have their own switches
+#endif
+
 /**** Homing singleton structure ****/
 
 struct hmHomingSingleton {          // persistent homing runtime variables
                                     // controls for homing cycle
     bool   waiting_for_motion_end;  // true when waiting for motion to complete.
-    int8_t axis;                    // axis currently being homed
-    int8_t homing_input;            // homing input for current axis
+    int8_t axis;                    // last axis of the group currently being homed
     bool   set_coordinates;         // G28.4 flag. true = set coords to zero at the end of homing cycle
     stat_t (*func)(int8_t axis);    // binding for callback function state machine
 
     bool axis_flags[AXES];          // local storage for axis flags
+    bool group[AXES];               // axes homed together - Z alone, then X and Y, then the rest
+    bool pending[AXES];             // group axes whose switch has not fired yet in this phase
+    bool sensorless;                // group homes on driver stall flags - no clear and latch
 
     // per-axis parameters
-    float direction;                // set to 1 for positive (max), -1 for negative (to min);
-    float search_travel;            // signed distance to travel in search
-    float search_velocity;          // search speed as positive number
-    float latch_backoff;            // max distance to back off switch during latch phase
-    float latch_velocity;           // latch speed as positive number
-    float zero_backoff;             // distance to back off switch before setting zero
-    float max_clear_backoff;        // maximum distance of switch clearing backoffs before erring out
-    float setpoint;                 // ultimate setpoint, usually zero, but not always
+    uint8_t homing_input[AXES];     // homing input for each group axis
+    float search_travel[AXES];      // signed distance to travel in search
+    float search_velocity[AXES];    // search speed as positive number
+    float latch_backoff[AXES];      // signed distance of the latch approach
+    float latch_velocity[AXES];     // latch speed as positive number
+    float zero_backoff[AXES];       // distance to back off switch before setting zero
+    float setpoint[AXES];           // ultimate setpoint, usually zero, but not always
+    float contact[AXES];            // switch position latched during the search
+    float saved_jerk[AXES];         // saved and restored for each axis homed
 
     // state saved from gcode model
     cmUnitsMode    saved_units_mode;      // G20,G21 global setting
@@ -67,7 +75,6 @@ struct hmHomingSingleton {          // persistent homing runtime variables
     cmDistanceMode saved_distance_mode;   // G90, G91 global setting
     cmFeedRateMode saved_feed_rate_mode;  // G93, G94 global setting
     float          saved_feed_rate;       // F setting
-    float          saved_jerk;            // saved and restored for each axis homed
 };
 static struct hmHomingSingleton hm;
 
@@ -75,12 +82,21 @@ static struct hmHomingSingleton hm;
 
 static stat_t _set_homing_func(stat_t (*func)(int8_t axis));
 static stat_t _homing_axis_start(int8_t axis);
+static stat_t _homing_axis_setup(int8_t axis);
+static bool _homing_input_active(int8_t axis);
+static bool _homing_input_mode(int8_t axis, bool homing);
 static stat_t _homing_axis_clear_init(int8_t axis);
 static stat_t _homing_axis_search(int8_t axis);
+static stat_t _homing_axis_search_check(int8_t axis);
 static stat_t _homing_axis_clear(int8_t axis);
 static stat_t _homing_axis_latch(int8_t axis);
+static stat_t _homing_axis_latch_check(int8_t axis);
 static stat_t _homing_axis_setpoint_backoff(int8_t axis);
 static stat_t _homing_axis_set_position(int8_t axis);
+static stat_t _homing_search_move(void);
+static stat_t _homing_latch_move(void);
+static bool _homing_update_pending(bool record_contact);
+static stat_t _homing_group_move(const float travel[], const float velocity[]);
 static stat_t _homing_axis_move(int8_t axis, float target, float velocity);
 static stat_t _homing_error_exit(int8_t axis, stat_t status);
 static stat_t _homing_finalize_exit(int8_t axis);
@@ -109,15 +125,34 @@ static int8_t _get_next_axis(int8_t axis);
  *  Homing is always run in the following order - for each enabled axis:
  *    Z,X,Y,A,B,C
  *
- *  After initialization the following sequence is run for each axis to be homed:
+ *  X and Y are homed together as one group when both are requested, they have
+ *  separate homing inputs, and HOMING_SIMULTANEOUS_XY is set. G28.4 always homes
+ *  one axis at a time.
+ *
+ *  After initialization the following sequence is run for each group to be homed:
  *
  *  0. Limits are automatically disabled. Shutdown and safety interlocks are not.
  *  1. If a homing input is active on invocation, clear off the input (switch)
  *  2. Drive towards homing switch in the set direction until switch is activated
- *  3. Drive away from the homing switch at search velocity for latch distance
+ *  3. Drive back to latch distance short of where the switch fired (see below)
  *  4. Drive towards homing switch at latch velocity until switch is activated
  *  5. Back off switch by the zero backoff distance and set zero for that axis
  *
+ *  Group moves run each axis at its own velocity. A switch firing stops the whole
+ *  move, so the search and latch moves are re-issued for the axes still pending.
+ *
+ *  The input interrupt latches the step position when the switch fires (see
+ *  en_take_encoder_snapshot()), so the clear in step 3 is measured from the switch
+ *  rather than from where the search stopped. Search overshoot no longer eats into
+ *  the latch distance, so search velocity can be raised to the switch's overtravel.
+ *  The latch move allows twice the latch backoff so it reaches the switch at speed.
+ *
+ *  An axis with its homing input set to HOMING_INPUT_STALL ({xhi:100}) homes without a
+ *  switch, on the stall flags of its motors' smart drivers (see st_driver_status_callback()).
+ *  The stall stops the search like a switch would, but there is no switch to clear and
+ *  latch, so steps 3 and 4 are skipped and the zero backoff is taken from the hard stop.
+ *  X and Y are only homed together if both or neither are sensorless.
+ *
  *  Homing works as a state machine that is driven by registering a callback function
  *  at hm.func() for the next state to be run. Once the axis is initialized each
  *  callback basically does two things (1) start the move for the current function,
@@ -126,7 +161,7 @@ static int8_t _get_next_axis(int8_t axis);
  *  move to stop with a feedhold. The other thing that can happen is the move will
  *  run to its full length if no switch change is detected (hit or open).
  *
- *  Once all moves for an axis are complete the next axis in the sequence is homed
+ *  Once all moves for a group are complete the next group in the sequence is homed
  *
  *  When a homing cycle is initiated the homing state is set to HOMING_NOT_HOMED
  *  When homing completes successfully this is set to HOMING_HOMED, otherwise it
@@ -166,6 +201,7 @@ stat_t cm_homing_cycle_start(const float axes[], const bool flags[]) {
     // clear rotation matrix
     canonical_machine_reset_rotation(cm);
 
+    clear_vector(hm.group);
     hm.axis          = -1;                  // set to retrieve initial axis
     hm.func          = _homing_axis_start;  // bind initial processing function
     cm->machine_state = MACHINE_CYCLE;
@@ -207,7 +243,7 @@ static stat_t _set_homing_func(stat_t (*func)(int8_t axis)) {
 }
 
 /***********************************************************************************
- * _homing_axis_start() - get next axis, initialize variables, call the clear
+ * _homing_axis_start() - get next axis or group, initialize variables, call the clear
  */
 static stat_t _homing_axis_start(int8_t axis) {
 
@@ -220,8 +256,37 @@ static stat_t _homing_axis_start(int8_t axis) {
             return (_homing_error_exit(-2, STAT_HOMING_ERROR_BAD_OR_NO_AXIS));
         }
     }
+    clear_vector(hm.group);
+    clear_vector(hm.homing_input);
+    hm.group[axis] = true;
+
+#if (HOMING_SIMULTANEOUS_XY == true)
+    bool x_stall = (cm->a[AXIS_X].homing_input == HOMING_INPUT_STALL);
+    bool y_stall = (cm->a[AXIS_Y].homing_input == HOMING_INPUT_STALL);
+    if ((axis == AXIS_X) && hm.axis_flags[AXIS_Y] && hm.set_coordinates && (x_stall == y_stall) &&
+        (x_stall || (cm->a[AXIS_X].homing_input != cm->a[AXIS_Y].homing_input))) {
+        hm.group[AXIS_Y] = true;
+        axis = AXIS_Y;                        // _get_next_axis() carries on after Y
+    }
+#endif
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (hm.group[group_axis]) {
+            ritorno(_homing_axis_setup(group_axis));
+        }
+    }
+    hm.sensorless = (hm.homing_input[axis] == HOMING_INPUT_STALL);
+    hm.axis = axis;                                             // persist the last axis of the group
+    return (_set_homing_func(_homing_axis_clear_init));         // perform an initial clear
+}
+
+/***********************************************************************************
+ * _homing_axis_setup() - check an axis configuration and load its homing parameters
+ */
+static stat_t _homing_axis_setup(int8_t axis) {
+
     // clear the homed flag for axis so we'll be able to move w/o triggering soft limits
     cm->homed[axis] = false;
+    cm_update_soft_limits();
 
     // trap axis mis-configurations
     if (fp_ZERO(cm->a[axis].homing_input)) {
@@ -230,7 +295,7 @@ static stat_t _homing_axis_start(int8_t axis) {
     if (fp_ZERO(cm->a[axis].search_velocity)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_SEARCH_VELOCITY));
     }
-    if (fp_ZERO(cm->a[axis].latch_velocity)) {
+    if (fp_ZERO(cm->a[axis].latch_velocity) && (cm->a[axis].homing_input != HOMING_INPUT_STALL)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_LATCH_VELOCITY));
     }
 
@@ -242,34 +307,56 @@ static stat_t _homing_axis_start(int8_t axis) {
 
     // Nothing to do about direction now that direction is explicit
     // However, here's a good place to stash the homing_switch:
-    hm.homing_input = cm->a[axis].homing_input;
-    gpio_set_homing_mode(hm.homing_input, true);
-    hm.axis            = axis;                                  // persist the axis
-    hm.search_velocity = fabs(cm->a[axis].search_velocity);     // search velocity is always positive
-    hm.latch_velocity  = fabs(cm->a[axis].latch_velocity);      // latch velocity is always positive
+    hm.homing_input[axis] = cm->a[axis].homing_input;
+    if (!_homing_input_mode(axis, true)) {                          // no motor on the axis reports stalls
+        return (_homing_error_exit(axis, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
+    }
+    hm.search_velocity[axis] = fabs(cm->a[axis].search_velocity);   // search velocity is always positive
+    hm.latch_velocity[axis]  = fabs(cm->a[axis].latch_velocity);    // latch velocity is always positive
 
     bool homing_to_max = cm->a[axis].homing_dir;
 
     // setup parameters for positive or negative travel (homing to the max or min switch)
     if (homing_to_max) {
-        hm.search_travel = travel_distance;                     // search travels in positive direction
-        hm.latch_backoff = fabs(cm->a[axis].latch_backoff);     // latch travels in positive direction
-        hm.zero_backoff  = -max(0.0f, cm->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
+        hm.search_travel[axis] = travel_distance;                   // search travels in positive direction
+        hm.latch_backoff[axis] = fabs(cm->a[axis].latch_backoff);   // latch travels in positive direction
+        hm.zero_backoff[axis]  = -max(0.0f, cm->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
                                                                 // will set the maximum position
                                                                 //     (plus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_max + (max(0.0f, -cm->a[axis].zero_backoff));
+        hm.setpoint[axis] = cm->a[axis].travel_max + (max(0.0f, -cm->a[axis].zero_backoff));
     } else {
-        hm.search_travel = -travel_distance;                    // search travels in negative direction
-        hm.latch_backoff = -fabs(cm->a[axis].latch_backoff);    // latch travels in negative direction
-        hm.zero_backoff  = max(0.0f, cm->a[axis].zero_backoff); // zero backoff is positive direction (or zero)
+        hm.search_travel[axis] = -travel_distance;                  // search travels in negative direction
+        hm.latch_backoff[axis] = -fabs(cm->a[axis].latch_backoff);  // latch travels in negative direction
+        hm.zero_backoff[axis]  = max(0.0f, cm->a[axis].zero_backoff); // zero backoff is positive direction (or zero)
                                                                 // will set the minimum position
                                                                 //     (minus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_min + (max(0.0f, -cm->a[axis].zero_backoff));
+        hm.setpoint[axis] = cm->a[axis].travel_min + (max(0.0f, -cm->a[axis].zero_backoff));
     }
+    hm.saved_jerk[axis] = cm_get_axis_jerk(axis);               // save the max jerk value
+    return (STAT_OK);
+}
 
-    // if homing is disabled for the axis then skip to the next axis
-    hm.saved_jerk = cm_get_axis_jerk(axis);                     // save the max jerk value
-    return (_set_homing_func(_homing_axis_clear_init));         // perform an initial clear
+/***********************************************************************************
+ * _homing_input_active() - true if the axis' switch is closed, or its motors stalled
+ * _homing_input_mode()   - start or end homing mode on the axis' input
+ *
+ *  Returns false if a sensorless axis has no motor that reports stalls.
+ */
+static bool _homing_input_active(int8_t axis)
+{
+    if (hm.homing_input[axis] == HOMING_INPUT_STALL) {
+        return (st_axis_stalled(axis));
+    }
+    return (gpio_read_input(hm.homing_input[axis]) == INPUT_ACTIVE);
+}
+
+static bool _homing_input_mode(int8_t axis, bool homing)
+{
+    if (hm.homing_input[axis] == HOMING_INPUT_STALL) {
+        return (st_set_stall_homing(axis, homing));
+    }
+    gpio_set_homing_mode(hm.homing_input[axis], homing);
+    return (true);
 }
 
 /***********************************************************************************
@@ -280,54 +367,167 @@ static stat_t _homing_axis_start(int8_t axis) {
  */
 static stat_t _homing_axis_clear_init(int8_t axis)  // first clear move
 {
-    if (gpio_read_input(hm.homing_input) == INPUT_ACTIVE) {  // the switch is closed at startup
+    float travel[] = INIT_AXES_ZEROES;
 
-        // determine if the input switch for this axis is shared w/other axes
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (!hm.group[group_axis] || !_homing_input_active(group_axis)) {
+            continue;
+        }
+        // the switch is closed at startup - determine if it is shared w/other axes
         for (uint8_t check_axis = AXIS_X; check_axis < AXES; check_axis++) {
-            if (axis != check_axis && cm->a[check_axis].homing_input == hm.homing_input) {
+            if (group_axis != check_axis && cm->a[check_axis].homing_input == hm.homing_input[group_axis]) {
                 return (_homing_error_exit(
-                    axis, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING));  // axis cannot be homed
+                    group_axis, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING));  // axis cannot be homed
             }
         }
-        _homing_axis_move(axis, -hm.latch_backoff, hm.search_velocity);  // otherwise back off the switch
+        travel[group_axis] = -hm.latch_backoff[group_axis];     // otherwise back off the switch
     }
+    _homing_group_move(travel, hm.search_velocity);
     return (_set_homing_func(_homing_axis_search));  // start the search
 }
 
 /***********************************************************************************
- * _homing_axis_search() - fast search for switch, closes switch
+ * _homing_axis_search()       - fast search for switch, closes switch
+ * _homing_axis_search_check() - continue the search for axes whose switch has not fired
+ * _homing_search_move()       - search move for the pending axes
+ *
+ *  Each pending axis runs at its search velocity for as long as the longest search.
  */
 static stat_t _homing_axis_search(int8_t axis)  // drive to switch
 {
-    cm_set_axis_max_jerk(axis, cm->a[axis].jerk_high);  // use the high-speed jerk for search onward
-    _homing_axis_move(axis, hm.search_travel, hm.search_velocity);
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (hm.group[group_axis]) {
+            cm_set_axis_max_jerk(group_axis, cm->a[group_axis].jerk_high);  // use the high-speed jerk for search onward
+        }
+    }
+    copy_vector(hm.pending, hm.group);
+    return (_homing_search_move());
+}
+
+static stat_t _homing_axis_search_check(int8_t axis)
+{
+    if (_homing_update_pending(true)) {
+        return (_homing_search_move());
+    }
+    if (hm.sensorless) {
+        return (_set_homing_func(_homing_axis_setpoint_backoff));
+    }
     return (_set_homing_func(_homing_axis_clear));
 }
 
+static stat_t _homing_search_move()
+{
+    float travel[] = INIT_AXES_ZEROES;
+    float time = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (hm.pending[axis]) {
+            time = max(time, fabs(hm.search_travel[axis]) / hm.search_velocity[axis]);
+        }
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (hm.pending[axis]) {
+            travel[axis] = copysignf(hm.search_velocity[axis] * time, hm.search_travel[axis]);
+        }
+    }
+    _homing_group_move(travel, hm.search_velocity);
+    return (_set_homing_func(_homing_axis_search_check));
+}
+
+/***********************************************************************************
+ * _homing_update_pending() - retire pending axes whose switch has fired
+ *
+ *  Returns true if a switch fired but other axes are still pending, in which case
+ *  the move is re-issued for them. With record_contact set it also records where
+ *  each switch fired, from the step position latched by the input interrupt. The
+ *  latest latch is at or after every switch that fired in this move, so it is a
+ *  safe (never short) clear reference for each of them. An axis whose search ran
+ *  out, or whose latch looks wrong, is referenced to where it stopped instead.
+ */
+static bool _homing_update_pending(bool record_contact)
+{
+    float contact_position[AXES];
+    bool fired = false;
+    bool remaining = false;
+
+    kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (!hm.pending[axis]) {
+            continue;
+        }
+        float position = cm_get_absolute_position(ACTIVE_MODEL, axis);
+        if (_homing_input_active(axis)) {
+            hm.pending[axis] = false;
+            fired = true;
+        } else {
+            remaining = true;
+            contact_position[axis] = position;
+        }
+        if (record_contact) {
+            if ((contact_position[axis] - position) * hm.search_travel[axis] > 0) {
+                contact_position[axis] = position;      // latched beyond where we stopped
+            }
+            hm.contact[axis] = contact_position[axis];
+        }
+    }
+    return (fired && remaining);
+}
+
 /***********************************************************************************
- * _homing_axis_clear() - clear off the switch
+ * _homing_axis_clear() - clear off the switch to latch distance short of the contact
  */
 static stat_t _homing_axis_clear(int8_t axis)  // drive away from switch at search speed
 {
-    _homing_axis_move(axis, -hm.latch_backoff, hm.search_velocity);
+    float travel[] = INIT_AXES_ZEROES;
+
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (hm.group[group_axis]) {
+            travel[group_axis] = hm.contact[group_axis] - cm_get_absolute_position(ACTIVE_MODEL, group_axis) -
+                                 hm.latch_backoff[group_axis];
+        }
+    }
+    _homing_group_move(travel, hm.search_velocity);
     return (_set_homing_func(_homing_axis_latch));
 }
 
 /***********************************************************************************
- * _homing_axis_latch() - slow drive until until switch closes again
+ * _homing_axis_latch()       - slow drive until until switch closes again
+ * _homing_axis_latch_check() - continue the latch for axes whose switch has not fired
+ * _homing_latch_move()       - latch move for the pending axes
  */
 static stat_t _homing_axis_latch(int8_t axis)  // drive to switch at low speed
 {
-    _homing_axis_move(axis, hm.latch_backoff, hm.latch_velocity);
+    copy_vector(hm.pending, hm.group);
+    return (_homing_latch_move());
+}
+
+static stat_t _homing_axis_latch_check(int8_t axis)
+{
+    if (_homing_update_pending(false)) {
+        return (_homing_latch_move());
+    }
     return (_set_homing_func(_homing_axis_setpoint_backoff));
 }
 
+static stat_t _homing_latch_move()
+{
+    float travel[] = INIT_AXES_ZEROES;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (hm.pending[axis]) {
+            travel[axis] = 2 * hm.latch_backoff[axis];  // switch is expected halfway
+        }
+    }
+    _homing_group_move(travel, hm.latch_velocity);
+    return (_set_homing_func(_homing_axis_latch_check));
+}
+
 /***********************************************************************************
  * _homing_axis_setpoint_backoff() - backoff to zero or max setpoint position
  */
 static stat_t _homing_axis_setpoint_backoff(int8_t axis)  // 
 {
-    _homing_axis_move(axis, hm.zero_backoff, hm.search_velocity);
+    _homing_group_move(hm.zero_backoff, hm.search_velocity);
     return (_set_homing_func(_homing_axis_set_position));
 }
 
@@ -337,29 +537,73 @@ static stat_t _homing_axis_setpoint_backoff(int8_t axis)  //
 static stat_t _homing_axis_set_position(int8_t axis)
 {
     if (hm.set_coordinates) {
-        cm_set_position_by_axis(axis, hm.setpoint);
-        cm->homed[axis] = true;
+        for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+            if (hm.group[group_axis]) {
+                cm_set_position_by_axis(group_axis, hm.setpoint[group_axis]);
+                cm->homed[group_axis] = true;
+            }
+        }
+        cm_update_soft_limits();
 
-    } else {  // handle G28.4 cycle - set position to the point of switch closure
+    } else {  // handle G28.4 cycle - set position to the point of switch closure (single axis group)
         float contact_position[AXES];
         kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
-        _homing_axis_move(axis, contact_position[AXIS_Z], hm.search_velocity);
+        _homing_axis_move(axis, contact_position[AXIS_Z], hm.search_velocity[axis]);
+    }
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (hm.group[group_axis]) {
+            cm_set_axis_max_jerk(group_axis, hm.saved_jerk[group_axis]);  // restore the max jerk value
+            _homing_input_mode(group_axis, false);                        // end homing mode
+        }
     }
-    cm_set_axis_max_jerk(axis, hm.saved_jerk);  // restore the max jerk value
-
-    gpio_set_homing_mode(hm.homing_input, false);  // end homing mode
     return (_set_homing_func(_homing_axis_start));
 }
 
 /***********************************************************************************
+ * _homing_group_move()      - move the group axes by travel[], each at its own velocity
  * _homing_axis_move()       - helper that actually executes the above moves
  * _motion_end_callback()    - callback completes when motion has stopped
+ *
+ *  The group move feed rate is set so the slowest axis runs at its velocity and
+ *  the others run slower. Group axes with zero travel are left out of the move.
  */
 static void _motion_end_callback(float* vect, bool* flag) 
 {
     hm.waiting_for_motion_end = false; 
 }
 
+static stat_t _homing_group_move(const float travel[], const float velocity[])
+{
+    float vect[]  = INIT_AXES_ZEROES;
+    bool  flags[] = INIT_AXES_ZEROES;
+    float length = 0;
+    float time = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (hm.group[axis] && fp_NOT_ZERO(travel[axis])) {
+            vect[axis]  = travel[axis];
+            flags[axis] = true;
+            length += travel[axis] * travel[axis];
+            time = max(time, fabs(travel[axis]) / velocity[axis]);
+        }
+    }
+    if (fp_ZERO(time)) {                        // nothing to move
+        return (STAT_OK);
+    }
+    hm.waiting_for_motion_end = true;
+    cm_set_feed_rate(sqrt(length) / time);
+
+    stat_t status = cm_straight_feed(vect, flags, PROFILE_FAST);
+    if (status != STAT_OK) {
+        rpt_exception(status, "Homing move failed. Check min/max settings");
+        return (_homing_error_exit(hm.axis, STAT_HOMING_CYCLE_FAILED));
+    }
+
+    // the last two arguments are ignored anyway
+    mp_queue_command(_motion_end_callback, nullptr_float, nullptr_bool);
+    return (STAT_EAGAIN);
+}
+
 static stat_t _homing_axis_move(int8_t axis, float target, float velocity) {
     float vect[]  = INIT_AXES_ZEROES;
     bool  flags[] = INIT_AXES_ZEROES;
@@ -399,6 +643,11 @@ static stat_t _homing_error_exit(int8_t axis, stat_t status) {
     }
     nv_print_list(STAT_HOMING_CYCLE_FAILED, TEXT_MULTILINE_FORMATTED, JSON_RESPONSE_FORMAT);
 
+    for (uint8_t group_axis = 0; group_axis < AXES; group_axis++) {
+        if (hm.group[group_axis] && (hm.homing_input[group_axis] != 0)) {
+            _homing_input_mode(group_axis, false);                      // release inputs already set up
+        }
+    }
     _homing_finalize_exit(axis);
     return (STAT_HOMING_CYCLE_FAILED);  // homing state remains HOMING_NOT_HOMED
 }
@@ -444,7 +693,7 @@ static int8_t _get_next_axis(int8_t axis) {
         if (hm.axis_flags[AXIS_Y]) {
             return (AXIS_Y);
         }
-        if (hm.axis_flags[AXIS_A]) {
+        if (AXIS_ACTIVE(AXIS_A) && hm.axis_flags[AXIS_A]) {
             return (AXIS_A);
         }
         return (-2);  // error
@@ -455,18 +704,18 @@ static int8_t _get_next_axis(int8_t axis) {
         if (hm.axis_flags[AXIS_Y]) {
             return (AXIS_Y);
         }
-        if (hm.axis_flags[AXIS_A]) {
+        if (AXIS_ACTIVE(AXIS_A) && hm.axis_flags[AXIS_A]) {
             return (AXIS_A);
         }
     } else if (axis == AXIS_X) {
         if (hm.axis_flags[AXIS_Y]) {
             return (AXIS_Y);
         }
-        if (hm.axis_flags[AXIS_A]) {
+        if (AXIS_ACTIVE(AXIS_A) && hm.axis_flags[AXIS_A]) {
             return (AXIS_A);
         }
     } else if (axis == AXIS_Y) {
-        if (hm.axis_flags[AXIS_A]) {
+        if (AXIS_ACTIVE(AXIS_A) && hm.axis_flags[AXIS_A]) {
             return (AXIS_A);
         }
     }
@@ -36,6 +36,16 @@
 
 #define JOGGING_START_VELOCITY ((float)10.0)
 
+#ifndef JOG_VELOCITY_SEGMENT_MS
+#define JOG_VELOCITY_SEGMENT_MS 20      // length of each queued velocity segment in ms - boards can override this value in hardware.h
+#endif
+#ifndef JOG_VELOCITY_LOOKAHEAD_MS
+#define JOG_VELOCITY_LOOKAHEAD_MS 100   // velocity segments kept queued ahead of the runtime in ms - boards can override this value in hardware.h
+#endif
+#ifndef JOG_VELOCITY_TIMEOUT_MS
+#define JOG_VELOCITY_TIMEOUT_MS 250     // velocity jog stops if no update arrives within this time - boards can override this value in hardware.h
+#endif
+
 /**** Jogging singleton structure ****/
 
 struct jmJoggingSingleton {         // persistent jogging runtime variables
@@ -47,6 +57,12 @@ struct jmJoggingSingleton {         // persistent jogging runtime variables
     float   velocity_max;
     uint8_t step;                   // what step of the ramp the jogging cycle is currently on
 
+    // controls for velocity jogging
+    bool     velocity_mode;         // true if the cycle is following streamed velocities
+    float    velocity[AXES];        // latest commanded velocity per axis, signed mm/min
+    uint32_t update_time;           // SysTick time of the latest velocity update
+    uint32_t queued_until;          // SysTick time the queued velocity segments run out
+
     uint8_t (*func)(int8_t axis);   // binding for callback function state machine
 
     // state saved from gcode model
@@ -62,10 +78,12 @@ static struct jmJoggingSingleton jog;
 
 /**** NOTE: global prototypes and other .h info is located in canonical_machine.h ****/
 
+static void _jogging_save_modes(void);
 static stat_t _set_jogging_func(uint8_t (*func)(int8_t axis));
 static stat_t _jogging_axis_start(int8_t axis);
 static stat_t _jogging_axis_ramp_jog(int8_t axis);
 static stat_t _jogging_axis_move(int8_t axis, float target, float velocity);
+static stat_t _jogging_velocity_run(int8_t axis);
 static stat_t _jogging_finalize_exit(int8_t axis);
 
 /*****************************************************************************
@@ -84,20 +102,25 @@ static stat_t _jogging_finalize_exit(int8_t axis);
  *  to cm_isbusy() is about.
  */
 
-stat_t cm_jogging_cycle_start(uint8_t axis) {
+static void _jogging_save_modes(void) {
     // save relevant non-axis parameters from Gcode model
     jog.saved_units_mode     = cm_get_units_mode(ACTIVE_MODEL);     // cm->gm.units_mode;
     jog.saved_coord_system   = cm_get_coord_system(ACTIVE_MODEL);   // cm->gm.coord_system;
     jog.saved_distance_mode  = cm_get_distance_mode(ACTIVE_MODEL);  // cm->gm.distance_mode;
     jog.saved_feed_rate_mode = cm_get_feed_rate_mode(ACTIVE_MODEL);
     jog.saved_feed_rate      = (ACTIVE_MODEL)->feed_rate;  // cm->gm.feed_rate;
-    jog.saved_jerk           = cm->a[axis].jerk_max;
 
     // set working values
     cm_set_units_mode(MILLIMETERS);
     cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
     cm_set_coord_system(ABSOLUTE_COORDS);  // jogging is done in machine coordinates
     cm_set_feed_rate_mode(UNITS_PER_MINUTE_MODE);
+}
+
+stat_t cm_jogging_cycle_start(uint8_t axis) {
+    _jogging_save_modes();
+    jog.saved_jerk = cm->a[axis].jerk_max;
+    jog.velocity_mode = false;
 
     jog.velocity_start = JOGGING_START_VELOCITY;  // see canonical_machine.h for #define
     jog.velocity_max = cm->a[axis].velocity_max;
@@ -114,12 +137,68 @@ stat_t cm_jogging_cycle_start(uint8_t axis) {
     return (STAT_OK);
 }
 
+/*****************************************************************************
+ * cm_jogging_velocity() - start or steer a velocity jog    {"jgv":{"x":1200,"y":-300}}
+ *
+ *  In velocity mode the host streams signed per-axis velocities (mm/min) instead of
+ *  jog destinations. The cycle keeps only JOG_VELOCITY_LOOKAHEAD_MS of short segments
+ *  queued ahead of the runtime, each one running along the latest commanded vector, so
+ *  a new vector takes effect within the lookahead and the planner's jerk-limited ramps
+ *  shape every change of speed or direction.
+ *
+ *  Because the planner always plans the queue to come to rest at its end, the machine
+ *  never runs further than what is queued. A zero vector - or no update for
+ *  JOG_VELOCITY_TIMEOUT_MS, so a host that stops talking stops the machine - ends
+ *  queuing and the jog decelerates to a stop within the lookahead. The lookahead also
+ *  bounds the usable jog speed: the axis has to be able to stop within that distance.
+ *
+ *  Homed axes are clamped to their soft limits rather than alarming at the boundary.
+ */
+
+stat_t cm_jogging_velocity(int8_t axis, float velocity) {
+    if ((axis < 0) || (axis >= AXES)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if ((cm_is_alarmed() != STAT_OK) || (cm->hold_state != FEEDHOLD_OFF)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if (!jog.velocity_mode) {
+        if ((cm->cycle_type != CYCLE_NONE) || (cm->machine_state == MACHINE_CYCLE)) {
+            return (STAT_COMMAND_NOT_ACCEPTED);     // don't jog into a running program
+        }
+        if (fp_ZERO(velocity)) {
+            return (STAT_OK);                       // already stopped
+        }
+        _jogging_save_modes();
+        for (uint8_t i = 0; i < AXES; i++) {
+            jog.velocity[i] = 0;
+        }
+        jog.velocity_mode = true;
+        jog.queued_until = SysTickTimer_getValue();
+        jog.func = _jogging_velocity_run;
+        cm->machine_state = MACHINE_CYCLE;
+        cm->cycle_type = CYCLE_JOG;
+    } else if (jog.func == _jogging_finalize_exit) {
+        jog.func = _jogging_velocity_run;           // picked up again while coasting to a stop
+    }
+    float limit = cm->a[axis].velocity_max;
+    if (velocity > limit) {
+        velocity = limit;
+    } else if (velocity < -limit) {
+        velocity = -limit;
+    }
+    jog.velocity[axis] = velocity;
+    jog.update_time = SysTickTimer_getValue();
+    return (STAT_OK);
+}
+
 /* Jogging axis moves - these execute in sequence for each axis
  * cm_jogging_cycle_callback()  - main loop callback for running the jogging cycle
  *  _set_jogging_func()         - a convenience for setting the next dispatch vector and exiting
  *  _jogging_axis_start()       - setup the jog
  *  _jogging_axis_ramp_jog()    - ramp the jog
  *  _jogging_axis_move()        - move the axis
+ *  _jogging_velocity_run()     - keep the velocity jog lookahead topped up
  *  _jogging_finalize_exit()    - clean up
  */
 
@@ -131,7 +210,7 @@ stat_t cm_jogging_cycle_callback(void) {
         return (STAT_EAGAIN);  // sync to planner move ends
     }
     //    if (jog.func == _jogging_axis_ramp_jog && mp_get_buffers_available() < PLANNER_BUFFER_HEADROOM) {
-    if (jog.func == _jogging_axis_ramp_jog && mp_planner_is_full(mp)) {     // +++++
+    if ((jog.func == _jogging_axis_ramp_jog || jog.func == _jogging_velocity_run) && mp_planner_is_full(mp)) {     // +++++
         return (STAT_EAGAIN);  // prevent flooding the queue with jog moves
     }
     return (jog.func(jog.axis));  // execute the current jogging move
@@ -187,6 +266,67 @@ static stat_t _jogging_axis_move(int8_t axis, float target, float velocity) {
     return (STAT_EAGAIN);
 }
 
+static stat_t _jogging_velocity_run(int8_t axis) {
+    uint32_t now = SysTickTimer_getValue();
+
+    if (((now - jog.update_time) > JOG_VELOCITY_TIMEOUT_MS) || (cm->hold_state != FEEDHOLD_OFF)) {
+        for (uint8_t i = 0; i < AXES; i++) {        // host went quiet or a hold came in
+            jog.velocity[i] = 0;
+        }
+    }
+    bool moving = false;
+    for (uint8_t i = 0; i < AXES; i++) {
+        moving |= !fp_ZERO(jog.velocity[i]);
+    }
+    if (!moving) {
+        return (_set_jogging_func(_jogging_finalize_exit));  // let the queued segments run out
+    }
+
+    if ((int32_t)(jog.queued_until - now) < 0) {
+        jog.queued_until = now;                     // runtime has drained the lookahead
+    }
+    if ((jog.queued_until - now) >= JOG_VELOCITY_LOOKAHEAD_MS) {
+        return (STAT_EAGAIN);
+    }
+
+    const float minutes = JOG_VELOCITY_SEGMENT_MS / 60000.0;
+    float target[] = INIT_AXES_ZEROES;
+    bool  flags[]  = INIT_AXES_FALSE;
+    for (uint8_t i = 0; i < AXES; i++) {
+        if (!fp_ZERO(jog.velocity[i])) {
+            target[i] = cm_get_absolute_position(MODEL, i) + jog.velocity[i] * minutes;
+            flags[i] = true;
+        }
+    }
+    if (cm->soft_limit_enable) {
+        for (uint8_t i = 0; i < cm->soft_limit_count; i++) {
+            const cmSoftLimit_t *limit = &cm->soft_limit[i];
+            if (flags[limit->axis]) {
+                if (target[limit->axis] > limit->max) {
+                    target[limit->axis] = limit->max;
+                } else if (target[limit->axis] < limit->min) {
+                    target[limit->axis] = limit->min;
+                }
+            }
+        }
+    }
+    float length = 0;
+    for (uint8_t i = 0; i < AXES; i++) {
+        if (flags[i]) {
+            float travel = target[i] - cm_get_absolute_position(MODEL, i);
+            length += travel * travel;
+        }
+    }
+    length = sqrt(length);
+    if (length < EPSILON) {
+        return (STAT_EAGAIN);                       // pinned at the soft limits - hold position
+    }
+    cm_set_feed_rate(length / minutes);
+    ritorno(cm_straight_feed(target, flags, PROFILE_FAST));
+    jog.queued_until += JOG_VELOCITY_SEGMENT_MS;
+    return (STAT_EAGAIN);
+}
+
 static stat_t _jogging_finalize_exit(int8_t axis)  // finish a jog
 {
     //    cm_end_hold();                                // ends hold if one is in effect
@@ -198,6 +338,7 @@ static stat_t _jogging_finalize_exit(int8_t axis)  // finish a jog
     (MODEL)->feed_rate = jog.saved_feed_rate;
     cm_set_motion_mode(MODEL, MOTION_MODE_CANCEL_MOTION_MODE);
     cm_canned_cycle_end();
+    jog.velocity_mode = false;
     xio_writeline("{\"jog\":0}\n");  // needed by OMC jogging function
     return (STAT_OK);
 }
@@ -66,6 +66,17 @@ struct pbProbingSingleton {             // persistent probing runtime variables
 };
 static struct pbProbingSingleton pb;
 
+struct pbGridSingleton {                // probing grid runtime variables (see cm_set_mesh())
+    bool active;                        // true while the grid cycle is running
+    uint8_t point;                      // next point to probe, in probing order
+    stat_t (*func)();                   // binding for grid state machine
+
+    // saved gcode model state
+    cmUnitsMode saved_units_mode;       // G20,G21 setting
+    cmDistanceMode saved_distance_mode; // G90,G91 global setting
+};
+static struct pbGridSingleton pg;
+
 /**** NOTE: global prototypes and other .h info is located in canonical_machine.h ****/
 
 static stat_t _probing_start();
@@ -75,6 +86,13 @@ static stat_t _probing_exception_exit(stat_t status);
 static stat_t _probe_move(const float target[], const bool flags[]);
 static void _motion_end_callback(float* vect, bool* flag);
 static void _send_probe_report(void);
+static stat_t _grid_start();
+static stat_t _grid_lift();
+static stat_t _grid_traverse();
+static stat_t _grid_probe();
+static stat_t _grid_record();
+static stat_t _grid_finish();
+static stat_t _grid_exit();
 
 /***********************************************************************************
  **** G38.x Probing Cycle **********************************************************
@@ -93,7 +111,9 @@ static void _send_probe_report(void);
  *  https://github.com/synthetos/g2/wiki/Gcode-Probes
  *
  *  When the probe input fires the input interrupt takes a snapshot of the internal
- *  encoders, then requests a "high speed" feedhold. We then run forward kinematics
+ *  encoders, then requests a "high speed" feedhold. The snapshot is the step count
+ *  at the DDA tick the input fired in, not the last segment boundary, so its error
+ *  does not grow with probing feed rate. We then run forward kinematics
  *  on the encoder snapshot to get the reported position. We also execute a move
  *  from the final position (after the feedhold) back to the point we report.
  *
@@ -137,8 +157,11 @@ uint8_t cm_straight_probe(float target[], bool flags[], bool trip_sense, bool al
     }
 
     // error if no axes specified
-    if (!(flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z] |
-          flags[AXIS_A] | flags[AXIS_B] | flags[AXIS_C])) {
+    bool any_axis = flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z];
+    for (uint8_t axis = AXIS_A; axis <= AXIS_ROTARY_MAX; axis++) {
+        any_axis |= flags[axis];
+    }
+    if (!any_axis) {
         return(cm_alarm(STAT_AXIS_IS_MISSING, "Axis is missing"));
     }
 
@@ -186,7 +209,17 @@ uint8_t cm_straight_probe(float target[], bool flags[], bool trip_sense, bool al
 uint8_t cm_probing_cycle_callback(void) 
 {
     if ((cm->cycle_type != CYCLE_PROBE) && (cm->probe_state[0] != PROBE_WAITING)) { 
-        return (STAT_NOOP);                 // exit if not in a probing cycle
+        if (!pg.active) {
+            return (STAT_NOOP);             // exit if not in a probing cycle or grid
+        }
+        if ((cm->machine_state == MACHINE_ALARM) || (cm->machine_state == MACHINE_SHUTDOWN) ||
+            (cm->machine_state == MACHINE_PANIC)) {
+            return (_grid_exit());          // queued moves were flushed - abandon the grid
+        }
+        if (pb.waiting_for_motion_complete) {
+            return (STAT_EAGAIN);
+        }
+        return (pg.func());                 // execute the current grid step
     }
     if (pb.waiting_for_motion_complete) {   // sync to planner move ends (using callback)
         return (STAT_EAGAIN);
@@ -302,7 +335,7 @@ static void _probe_restore_settings()
     gpio_set_probing_mode(pb.probe_input, false);       // set input back to normal operation
 
     for (uint8_t axis = 0; axis < AXES; axis++) {       // restore axis jerks
-        cm->a[axis].jerk_max = pb.saved_jerk[axis]; 
+        cm_set_axis_max_jerk(axis, pb.saved_jerk[axis]);
     }
     cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_OFF); // release abs override and restore work offsets
     cm_set_distance_mode(pb.saved_distance_mode);
@@ -358,19 +391,191 @@ static void _send_probe_report() {
         if (pb.flags[AXIS_Z]) {
             sprintf(bufp, "z\":%0.3f}}\n", cm->probe_results[0][AXIS_Z]);
         }
-        if (pb.flags[AXIS_A]) {
+        if (AXIS_ACTIVE(AXIS_A) && pb.flags[AXIS_A]) {
             sprintf(bufp, "a\":%0.3f}}\n", cm->probe_results[0][AXIS_A]);
         }
-        if (pb.flags[AXIS_B]) {
+        if (AXIS_ACTIVE(AXIS_B) && pb.flags[AXIS_B]) {
             sprintf(bufp, "b\":%0.3f}}\n", cm->probe_results[0][AXIS_B]);
         }
-        if (pb.flags[AXIS_C]) {
+        if (AXIS_ACTIVE(AXIS_C) && pb.flags[AXIS_C]) {
             sprintf(bufp, "c\":%0.3f}}\n", cm->probe_results[0][AXIS_C]);
         }
         xio_writeline(buf);
     }
 }
 
+/***********************************************************************************
+ **** Probing Grid *****************************************************************
+ ***********************************************************************************/
+
+/***********************************************************************************
+ * cm_get_mesh() - JSON query to determine if a probed mesh is stored
+ * cm_set_mesh() - JSON command to run the probing grid (true) or discard the mesh (false)
+ *
+ *  The grid probes mshn x mshn points over the rectangle set by mshx, mshy, mshi and
+ *  mshj (machine coordinates, see kinematics.h). Points are visited in serpentine
+ *  order starting at the origin. For each point the tool lifts to mshc, traverses to
+ *  the point and runs a G38.2 toward mshz at the current feed rate, so a probe that
+ *  fails to trip alarms and abandons the grid. Compensation is off while probing.
+ *
+ *  When all points succeed the heights are stored relative to the first point and
+ *  the tool is returned over the origin, where compensation is zero, before the mesh
+ *  is marked valid. Each probe sends its own probe report if those are enabled.
+ */
+
+stat_t cm_get_mesh(nvObj_t *nv)
+{
+    nv->value_int = kn.mesh_valid;
+    nv->valuetype = TYPE_BOOLEAN;
+    return (STAT_OK);
+}
+
+stat_t cm_set_mesh(nvObj_t *nv)
+{
+    if ((cm_get_machine_state() == MACHINE_CYCLE) || pg.active) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if (!nv->value_int) {
+        kn_set_mesh_valid(false);
+        return (STAT_OK);
+    }
+    if (fp_ZERO(cm->gm.feed_rate)) {
+        return (STAT_FEEDRATE_NOT_SPECIFIED);
+    }
+    if (gpio_get_probing_input() == -1) {
+        return (STAT_NO_PROBE_INPUT_CONFIGURED);
+    }
+    pg.saved_distance_mode = (cmDistanceMode)cm_get_distance_mode(MODEL);
+    pg.saved_units_mode = (cmUnitsMode)cm_get_units_mode(MODEL);
+    pg.active = true;
+    pg.point = 0;
+    pg.func = _grid_start;
+    pb.waiting_for_motion_complete = true;  // start once the planner has drained
+    mp_queue_command(_motion_end_callback, nullptr_float, nullptr_bool);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * _grid_move()      - queue one absolute machine coordinate traverse and wait for it
+ * _grid_point_xy()  - machine XY of a point in probing order
+ */
+
+static stat_t _grid_move(const float target[], const bool flags[])
+{
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);
+    pb.waiting_for_motion_complete = true;          // set this BEFORE the motion starts
+    cm_straight_traverse(target, flags, PROFILE_NORMAL);
+    mp_queue_command(_motion_end_callback, nullptr_float, nullptr_bool);
+    return (STAT_EAGAIN);
+}
+
+static void _grid_point_xy(uint8_t point, uint8_t &i, uint8_t &j)
+{
+    j = point / kn.mesh_points;
+    i = point % kn.mesh_points;
+    if (j & 1) {                                    // odd rows run backwards
+        i = kn.mesh_points - 1 - i;
+    }
+}
+
+/***********************************************************************************
+ * _grid_start()    - set working modes and turn compensation off
+ * _grid_lift()     - lift to the clearance height
+ * _grid_traverse() - traverse to the next point, or back to the origin when done
+ * _grid_probe()    - start a G38.2 at the current point
+ * _grid_record()   - store the probed height and advance
+ * _grid_finish()   - store the mesh and restore modes
+ * _grid_exit()     - restore modes without storing a mesh
+ */
+
+static stat_t _grid_start()
+{
+    cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
+    cm_set_units_mode(MILLIMETERS);
+
+    kn_set_mesh_valid(false);                       // probe the uncompensated surface
+    pg.func = _grid_lift;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _grid_lift()
+{
+    float target[AXES] = {0};
+    bool flags[AXES] = {0};
+    target[AXIS_Z] = kn.mesh_clear_z;
+    flags[AXIS_Z] = true;
+    pg.func = _grid_traverse;
+    return (_grid_move(target, flags));
+}
+
+static stat_t _grid_traverse()
+{
+    float target[AXES] = {0};
+    bool flags[AXES] = {0};
+    uint8_t i = 0, j = 0;
+    if (pg.point < kn.mesh_points * kn.mesh_points) {
+        _grid_point_xy(pg.point, i, j);
+        pg.func = _grid_probe;
+    } else {
+        pg.func = _grid_finish;                     // origin is where compensation is zero
+    }
+    target[AXIS_X] = kn.mesh_origin[0] + i * kn.mesh_size[0] / (kn.mesh_points - 1);
+    target[AXIS_Y] = kn.mesh_origin[1] + j * kn.mesh_size[1] / (kn.mesh_points - 1);
+    flags[AXIS_X] = true;
+    flags[AXIS_Y] = true;
+    return (_grid_move(target, flags));
+}
+
+static stat_t _grid_probe()
+{
+    float target[AXES] = {0};
+    bool flags[AXES] = {0};
+    target[AXIS_Z] = kn.mesh_probe_z;
+    flags[AXIS_Z] = true;
+
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);
+    pg.func = _grid_record;
+    if (cm_straight_probe(target, flags, true, true) != STAT_OK) {  // G38.2 - the probe cycle takes over until done
+        return (_grid_exit());
+    }
+    return (STAT_EAGAIN);
+}
+
+static stat_t _grid_record()
+{
+    if (cm->probe_state[0] != PROBE_SUCCEEDED) {    // the probe has already alarmed
+        return (_grid_exit());
+    }
+    uint8_t i, j;
+    _grid_point_xy(pg.point, i, j);
+    kn.mesh_z[j][i] = cm->probe_results[0][AXIS_Z];
+    pg.point++;
+    pg.func = _grid_lift;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _grid_finish()
+{
+    float z0 = kn.mesh_z[0][0];
+    for (uint8_t j = 0; j < kn.mesh_points; j++) {
+        for (uint8_t i = 0; i < kn.mesh_points; i++) {
+            kn.mesh_z[j][i] -= z0;
+        }
+    }
+    kn_set_mesh_valid(true);
+    return (_grid_exit());
+}
+
+static stat_t _grid_exit()
+{
+    pg.active = false;
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_OFF);
+    cm_set_distance_mode(pg.saved_distance_mode);
+    cm_set_units_mode(pg.saved_units_mode);
+    sr_request_status_report(SR_REQUEST_IMMEDIATE);
+    return (STAT_OK);
+}
+
 /*
  * cm_get_prbr() - get probe report enable setting
  * cm_set_prbr() - set probe report enable setting
@@ -388,3 +593,15 @@ stat_t cm_set_prbr(nvObj_t *nv)
     cm->probe_report_enable = nv->value_int;
     return (STAT_OK);
 }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_mesh[] = "[mesh] probed mesh stored %s\n";
+
+void cm_print_mesh(nvObj_t *nv) { text_print(nv, fmt_mesh); }  // TYPE BOOL
+
+#endif // __TEXT_MODE
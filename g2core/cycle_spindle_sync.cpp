@@ -0,0 +1,148 @@
+/*
+ * cycle_spindle_sync.cpp - spindle synchronized motion extension to canonical_machine.cpp
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * SPINDLE SYNCHRONIZED MOTION
+ *
+ *      G33   X Y Z K  threading - move to the target, K units of travel per spindle revolution
+ *      G33.1 X Y Z K  rigid tapping - move to the target at K per revolution, reverse the
+ *                     spindle, follow it back out to the start, and restore the direction
+ *
+ *  The moves are straight lines queued like a G1, but the runtime does not play them
+ *  against time. Each segment reads the spindle encoder (see spindle.cpp) and moves the
+ *  axes along the line to K times the revolutions since the block started, so the feed
+ *  tracks the actual spindle speed - through load, a spindle override, or a reversal.
+ *  The axes follow at the sync acceleration {spsa:}, and stop on the target.
+ *
+ *  A G33 block waits in place until the spindle passes a whole revolution of the
+ *  encoder count, so every pass of a thread starts at the same angle. A G33.1 starts at
+ *  once, as the tap only has to stay in its own thread. Its tap-out is measured from
+ *  the spindle position at which the tap-in reached depth, so the axis keeps following
+ *  the spindle as it coasts on, stops and reverses: the tap goes a little past depth by
+ *  the spindle overshoot rather than cutting the thread in place.
+ *
+ *  Synchronized blocks start and end stopped and are not blended. Feed override does
+ *  not apply, and a feedhold takes effect at the end of the block - the axis can't be
+ *  stopped while the spindle is in the cut. K is the pitch in the block's units and
+ *  must be on every G33 or G33.1 line. The spindle must be turning (S and M3 or M4)
+ *  and an encoder set up {spea:}, {sppr:}; S with K also gives the planner the feed
+ *  it uses for the block's time estimate. Inverse time mode can't be used. G33.1
+ *  needs the encoder's B channel {speb:}: a single channel counts in the commanded
+ *  direction, and would read the coast through the reversal as the wrong way.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "spindle.h"
+#include "util.h"
+
+/**** NOTE: global prototypes and other .h info is located in canonical_machine.h ****/
+
+/*
+ * _sync_line() - queue one synchronized line to cm->gm.target
+ *
+ *  The pitch rides to the runtime in the P word, negated for a G33.1 tap-out (see
+ *  _exec_aline_sync() in plan_exec.cpp). The feed rate is only the planner's estimate.
+ */
+
+static stat_t _sync_line(const float pitch)
+{
+    float P_word = cm->gm.P_word;
+    float feed_rate = cm->gm.feed_rate;
+
+    cm->gm.P_word = pitch;
+    cm->gm.feed_rate = fabs(pitch) * cm->gm.spindle_speed;
+    stat_t status = mp_aline(&cm->gm);
+    cm_update_model_position();
+
+    cm->gm.P_word = P_word;
+    cm->gm.feed_rate = feed_rate;
+    return (status);
+}
+
+/*
+ * cm_spindle_sync_feed() - canonical machine entry point for G33 and G33.1
+ *
+ *  Target values are in the units and distance mode of the block, as for cm_straight_feed().
+ */
+
+stat_t cm_spindle_sync_feed(const cmMotionMode motion_mode,
+                            const float target[], const bool flags[],
+                            const float K_word, const bool K_flag)
+{
+    if (!spindle_encoder_enabled()) {
+        return (STAT_GCODE_COMMAND_UNSUPPORTED);    // no spindle position to follow
+    }
+    if ((motion_mode == MOTION_MODE_RIGID_TAP) && (spindle.encoder_input_b == 0)) {
+        return (STAT_GCODE_COMMAND_UNSUPPORTED);    // can't see the spindle coast through the reversal
+    }
+    if (cm->gm.feed_rate_mode == INVERSE_TIME_MODE) {
+        return (STAT_INVERSE_TIME_MODE_CANNOT_BE_USED);
+    }
+    cm->gm.motion_mode = motion_mode;
+
+    bool moves = false;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        moves |= flags[axis];
+    }
+    if (!moves) {
+        return (STAT_OK);                           // only sets the motion mode
+    }
+    if (!K_flag) {
+        return (STAT_K_WORD_IS_MISSING);
+    }
+    if (K_word <= 0) {
+        return (STAT_K_WORD_IS_INVALID);
+    }
+    if (cm->gm.spindle_speed <= 0) {
+        return (STAT_SPINDLE_MUST_BE_TURNING);
+    }
+    float pitch = (cm->gm.units_mode == INCHES) ? (K_word * MM_PER_INCH) : K_word;
+    float start[AXES];
+    copy_vector(start, cm->gmx.position);
+
+    cm_set_model_target(target, flags);
+    ritorno(cm_test_soft_limits(cm->gm.target));
+    cm_set_display_offsets(&cm->gm);
+    cm_cycle_start();
+
+    stat_t status = _sync_line(pitch);
+    if ((status == STAT_OK) && (motion_mode == MOTION_MODE_RIGID_TAP)) {
+        spindle_reverse_sync();
+        copy_vector(cm->gm.target, start);
+        status = _sync_line(-pitch);
+        spindle_reverse_sync();
+    }
+    if (status == STAT_MINIMUM_LENGTH_MOVE) {
+        if (!mp_has_runnable_buffer(mp)) {
+            cm_cycle_end();
+        }
+        status = STAT_OK;
+    }
+    return (status);
+}
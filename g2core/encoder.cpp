@@ -28,7 +28,12 @@
 #include "g2core.h"
 #include "config.h"
 #include "encoder.h"
+#include "stepper.h"            // st_get_step_position()
 #include "canonical_machine.h"  // needed for cm_panic() in assertions
+#include "kinematics.h"         // kn_forward_kinematics()
+#include "util.h"
+#include "text_parser.h"
+#include "xio.h"
 
 /**** Allocate Structures ****/
 
@@ -45,6 +50,7 @@ enEncoders_t en;
 
 void encoder_init() {
     memset(&en, 0, sizeof(en));  // clear all values, pointers and status
+    for (uint8_t m = 0; m < MOTORS; m++) { en.en[m].steps_per_count = 1.0; }
     encoder_init_assertions();
 }
 
@@ -74,7 +80,26 @@ stat_t encoder_test_assertions() {
  *	position except if the machine is at zero.
  */
 
-void en_set_encoder_steps(uint8_t motor, float steps) { en.en[motor].encoder_steps = (int32_t)round(steps); }
+void en_set_encoder_steps(uint8_t motor, float steps) {
+    en.en[motor].encoder_steps = (int32_t)round(steps);
+    if (ENCODER_IS_HW(motor)) {
+        en.en[motor].counts = board_encoder_read(motor);
+        en.en[motor].count_zero = en.en[motor].counts;
+        en.en[motor].step_zero = steps;
+    }
+}
+
+/*
+ * en_set_encoder_scale() - set steps per hardware encoder count
+ *
+ *  Call again whenever the microsteps of the motor change. The current position is kept.
+ */
+
+void en_set_encoder_scale(uint8_t motor, float steps_per_count) {
+    float steps = en_read_encoder(motor);
+    en.en[motor].steps_per_count = steps_per_count;
+    en_set_encoder_steps(motor, steps);
+}
 
 /*
  * en_read_encoder()
@@ -84,9 +109,20 @@ void en_set_encoder_steps(uint8_t motor, float steps) { en.en[motor].encoder_ste
  *	therefore always stable. But be advised: the position lags target and position
  *	valaes elsewhere in the system because the sample is taken when the steps for
  *	that segment are complete.
+ *
+ *	Hardware encoders are latched at the same point, so they lag the same way.
  */
 
-float en_read_encoder(uint8_t motor) { return ((float)en.en[motor].encoder_steps); }
+static float _hw_encoder_steps(uint8_t motor, int32_t counts) {
+    return ((counts - en.en[motor].count_zero) * en.en[motor].steps_per_count + en.en[motor].step_zero);
+}
+
+float en_read_encoder(uint8_t motor) {
+    if (ENCODER_IS_HW(motor)) {
+        return (_hw_encoder_steps(motor, en.en[motor].counts));
+    }
+    return ((float)en.en[motor].encoder_steps);
+}
 
 /*
  * en_take_encoder_snapshot()
@@ -96,13 +132,22 @@ float en_read_encoder(uint8_t motor) { return ((float)en.en[motor].encoder_steps
  *  Take a snapshot of the encoder position at an exact point in time. This provides
  *  a very accurate view of step position at the time of the snapshot,  which is
  *  presumably in the middle of a switch closure interrupt. Taking the snapshot
- *  does not affect the normal accumulation run by the stepper DDA.
+ *  does not affect the normal accumulation run by the stepper DDA. The step count
+ *  is exact to the DDA tick whichever way the DDA runs (see st_get_step_position()).
  *
  *  The results are in STEPS, which may need to be converted back to position using
  *  forward kinematics, depending on your use. See probe cycle for example.
  */
 void en_take_encoder_snapshot() {
-    for (uint8_t m = 0; m < MOTORS; m++) { en.snapshot[m] = en.en[m].encoder_steps + en.en[m].steps_run; }
+    int32_t steps[MOTORS];
+    st_get_step_position(steps);                    // taken at the current DDA tick
+    for (uint8_t m = 0; m < MOTORS; m++) {
+        if (ENCODER_IS_HW(m)) {
+            en.snapshot[m] = _hw_encoder_steps(m, board_encoder_read(m));  // live count, not the latch
+        } else {
+            en.snapshot[m] = steps[m];
+        }
+    }
 
     /* loop unrolled version for faster execution
         en.snapshot[MOTOR_1] = en.en[MOTOR_1].encoder_steps + en.en[MOTOR_1].steps_run;
@@ -118,11 +163,286 @@ float en_get_encoder_snapshot_steps(uint8_t motor) { return (en.snapshot[motor])
 
 float* en_get_encoder_snapshot_vector() { return (en.snapshot); }
 
+/*
+ * en_log_segment() - record the commanded and encoder steps of a segment (called from exec)
+ * _log_callback()  - send logged segments to the host as binary frames (called from controller)
+ *
+ *  The log is a single-producer / single-consumer ring. Exec only writes the head and the
+ *  controller only writes the tail, so neither side needs to mask interrupts. The entries are
+ *  the same vectors exec uses for the following error, so logging costs exec one copy per
+ *  segment and nothing in the DDA or loader.
+ *
+ *  Frame payload: record type (ENCODER_LOG_RECORD), motor count, segment number (uint32),
+ *  then MOTORS commanded and MOTORS encoder step values (float), all little-endian.
+ */
+
+#if ENCODER_LOG_ENABLED == true
+
+static_assert((ENCODER_LOG_SEGMENTS & (ENCODER_LOG_SEGMENTS - 1)) == 0, "ENCODER_LOG_SEGMENTS must be a power of 2");
+static_assert(ENCODER_LOG_SEGMENTS <= 256, "ENCODER_LOG_SEGMENTS must fit the uint8_t ring indexes");
+
+void en_log_segment(const float commanded[], const float encoder[])
+{
+    uint8_t next = (en.log.head + 1) & (ENCODER_LOG_SEGMENTS - 1);
+    uint32_t segment = en.log.segment++;
+
+    if (next == en.log.tail) {
+        en.log.overruns++;
+        return;
+    }
+    enLogEntry_t *e = &en.log.entry[en.log.head];
+    e->segment = segment;
+    for (uint8_t m = 0; m < MOTORS; m++) {
+        e->commanded[m] = commanded[m];
+        e->encoder[m] = encoder[m];
+    }
+    en.log.head = next;
+}
+
+static stat_t _log_callback()
+{
+    if (en.log.tail == en.log.head) {
+        return (STAT_NOOP);
+    }
+    if (!en.log.stream) {
+        en.log.tail = en.log.head;                  // not streaming - keep the ring fresh
+        return (STAT_NOOP);
+    }
+    uint8_t payload[2 + sizeof(uint32_t) + 2 * MOTORS * sizeof(float)];
+    payload[0] = ENCODER_LOG_RECORD;
+    payload[1] = MOTORS;
+
+    for (uint8_t n = 0; (n < ENCODER_LOG_BATCH) && (en.log.tail != en.log.head); n++) {
+        const enLogEntry_t *e = &en.log.entry[en.log.tail];
+        uint8_t *p = &payload[2];
+        memcpy(p, &e->segment, sizeof(uint32_t));        p += sizeof(uint32_t);
+        memcpy(p, e->commanded, MOTORS * sizeof(float)); p += MOTORS * sizeof(float);
+        memcpy(p, e->encoder, MOTORS * sizeof(float));
+        xio_binary_write(payload, sizeof(payload));
+        en.log.tail = (en.log.tail + 1) & (ENCODER_LOG_SEGMENTS - 1);
+    }
+    return (STAT_OK);
+}
+
+#else
+
+void en_log_segment(const float commanded[], const float encoder[]) {}
+static stat_t _log_callback() { return (STAT_NOOP); }
+
+#endif // ENCODER_LOG_ENABLED
+
+/*
+ * en_measure_segment() - queue the encoder position and planned values of a segment (called from exec)
+ * _measure_sample()    - measure the velocity and acceleration of one queued segment
+ * _measure_publish()   - publish the window results and start a new window
+ * _measure_callback()  - run the queued segments (called from controller)
+ *
+ *  The ring works like the following error log: exec only writes the head and the controller
+ *  only writes the tail. Exec reads the encoders and copies them, and the forward kinematics
+ *  run in the controller. See encoder.h for what is measured.
+ */
+
+#if ENCODER_MEASURE_ENABLED == true
+
+static_assert((ENCODER_MEASURE_SAMPLES & (ENCODER_MEASURE_SAMPLES - 1)) == 0, "ENCODER_MEASURE_SAMPLES must be a power of 2");
+static_assert(ENCODER_MEASURE_SAMPLES <= 256, "ENCODER_MEASURE_SAMPLES must fit the uint8_t ring indexes");
+
+void en_measure_segment(const float segment_time, const float velocity)
+{
+    enMeasure_t *ms = &en.measure;
+    uint8_t next = (ms->head + 1) & (ENCODER_MEASURE_SAMPLES - 1);
+
+    if (next == ms->tail) {
+        ms->dropped = true;
+        return;
+    }
+    enMeasureSample_t *s = &ms->sample[ms->head];
+    for (uint8_t m = 0; m < MOTORS; m++) {
+        s->steps[m] = en_read_encoder(m);           // all motors - one not in this move may still be stepping
+    }
+    s->segment_time = segment_time;
+    s->velocity = velocity;
+    s->tick = SysTickTimer_getValue();
+    s->restart = ms->dropped;
+    ms->dropped = false;
+    ms->head = next;
+}
+
+static void _measure_publish(enMeasure_t *ms)
+{
+    if (ms->count == 0) {
+        return;
+    }
+    ms->window_peak = ms->peak_velocity;
+    ms->window_mean = ms->length / ms->time;
+    ms->window_planned = ms->planned_length / ms->time;
+    ms->window_accel = ms->peak_accel;
+
+    ms->count = 0;
+    ms->time = 0;
+    ms->length = 0;
+    ms->planned_length = 0;
+    ms->peak_velocity = 0;
+    ms->peak_accel = 0;
+}
+
+static void _measure_sample(enMeasure_t *ms, const enMeasureSample_t *s)
+{
+    float position[AXES];
+    kn_forward_kinematics(s->steps, position);
+
+    if (s->restart || (s->tick - ms->tick > ENCODER_MEASURE_GAP_MS)) {
+        _measure_publish(ms);                       // the move before the gap is a window of its own
+        ms->chain = 0;
+        ms->measured_velocity = 0;
+    }
+    if (ms->chain >= 2) {                           // the encoders have moved through the segment two back
+        float segment_time = ms->segment_time[1];
+        float velocity = get_axis_vector_length(position, ms->position) / segment_time;
+
+        if (ms->chain >= 3) {
+            float accel = fabs(velocity - ms->velocity) / ((segment_time + ms->velocity_time) / 2);
+            ms->peak_accel = max(ms->peak_accel, accel / 3600);     // mm/min^2 to mm/s^2
+        }
+        ms->velocity = velocity;
+        ms->velocity_time = segment_time;
+        ms->measured_velocity = velocity;
+
+        ms->count++;
+        ms->time += segment_time;
+        ms->length += velocity * segment_time;
+        ms->planned_length += ms->planned[1] * segment_time;
+        ms->peak_velocity = max(ms->peak_velocity, velocity);
+        if (ms->count >= ENCODER_MEASURE_WINDOW) {
+            _measure_publish(ms);
+        }
+    }
+    ms->segment_time[1] = ms->segment_time[0];
+    ms->segment_time[0] = s->segment_time;
+    ms->planned[1] = ms->planned[0];
+    ms->planned[0] = s->velocity;
+    copy_vector(ms->position, position);
+    ms->tick = s->tick;
+    if (ms->chain < 3) {
+        ms->chain++;
+    }
+}
+
+static void _measure_callback()
+{
+    enMeasure_t *ms = &en.measure;
+
+    if (ms->tail == ms->head) {
+        if ((ms->count != 0) && (SysTickTimer_getValue() - ms->tick > ENCODER_MEASURE_GAP_MS)) {
+            _measure_publish(ms);                   // motion has stopped - publish the last move
+            ms->measured_velocity = 0;
+        }
+        return;
+    }
+    while (ms->tail != ms->head) {
+        _measure_sample(ms, &ms->sample[ms->tail]);
+        ms->tail = (ms->tail + 1) & (ENCODER_MEASURE_SAMPLES - 1);
+    }
+}
+
+#else
+
+void en_measure_segment(const float segment_time, const float velocity) {}
+static void _measure_callback() {}
+
+#endif // ENCODER_MEASURE_ENABLED
+
+/*
+ * en_callback() - measure velocity and stream the following error log (called from controller)
+ */
+
+stat_t en_callback()
+{
+    _measure_callback();
+    return (_log_callback());
+}
+
 /***********************************************************************************
  * CONFIGURATION AND INTERFACE FUNCTIONS
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
 
+/*
+ * en_get_enlst() - get following error log streaming
+ * en_set_enlst() - start (1) or stop (0) streaming the following error log
+ * en_get_enlov() - get count of log entries dropped because the ring was full
+ * en_set_enlov() - writing 0 clears the count
+ *
+ *  Both read as 0 and are read-only unless ENCODER_LOG_ENABLED is true.
+ */
+
+#if ENCODER_LOG_ENABLED == true
+
+stat_t en_get_enlst(nvObj_t *nv) { return (get_integer(nv, en.log.stream)); }
+stat_t en_set_enlst(nvObj_t *nv)
+{
+    if ((nv->value_int != 0) && (nv->value_int != 1)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    en.log.tail = en.log.head;                      // start from the next segment
+    en.log.stream = nv->value_int;
+    return (STAT_OK);
+}
+
+stat_t en_get_enlov(nvObj_t *nv) { return (get_integer(nv, en.log.overruns)); }
+stat_t en_set_enlov(nvObj_t *nv)
+{
+    if (nv->value_int != 0) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    en.log.overruns = 0;
+    return (STAT_OK);
+}
+
+#else
+
+stat_t en_get_enlst(nvObj_t *nv) { return (get_integer(nv, 0)); }
+stat_t en_set_enlst(nvObj_t *nv) { return (set_ro(nv)); }
+stat_t en_get_enlov(nvObj_t *nv) { return (get_integer(nv, 0)); }
+stat_t en_set_enlov(nvObj_t *nv) { return (set_ro(nv)); }
+
+#endif // ENCODER_LOG_ENABLED
+
+/*
+ * en_get_velm() - get the last measured velocity
+ * en_get_vm()   - get a measured window result: vm + {pk=peak, mn=mean, pl=planned mean, ac=peak accel}
+ *
+ *  Both are in the runtime units and read as 0 unless ENCODER_MEASURE_ENABLED is true.
+ */
+
+static stat_t _get_measured(nvObj_t *nv, float value)
+{
+    if (cm_get_units_mode(RUNTIME) == INCHES) {
+        value *= INCHES_PER_MM;
+    }
+    return (get_float(nv, value));
+}
+
+#if ENCODER_MEASURE_ENABLED == true
+
+stat_t en_get_velm(nvObj_t *nv) { return (_get_measured(nv, en.measure.measured_velocity)); }
+stat_t en_get_vm(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    switch (token[2]) {
+        case 'p': { return (_get_measured(nv, (token[3] == 'k') ? en.measure.window_peak : en.measure.window_planned)); }
+        case 'm': { return (_get_measured(nv, en.measure.window_mean)); }
+        default:  { return (_get_measured(nv, en.measure.window_accel)); }
+    }
+}
+
+#else
+
+stat_t en_get_velm(nvObj_t *nv) { return (get_float(nv, 0)); }
+stat_t en_get_vm(nvObj_t *nv) { return (get_float(nv, 0)); }
+
+#endif // ENCODER_MEASURE_ENABLED
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
@@ -130,4 +450,31 @@ float* en_get_encoder_snapshot_vector() { return (en.snapshot); }
 
 #ifdef __TEXT_MODE
 
+static const char fmt_enlst[] = "[enlst] following error log streaming%3d [0=off,1=on]\n";
+static const char fmt_enlov[] = "[enlov] following error log overruns%12lu\n";
+
+void en_print_enlst(nvObj_t *nv) { text_print(nv, fmt_enlst); }
+void en_print_enlov(nvObj_t *nv) { text_print(nv, fmt_enlov); }
+
+static const char fmt_velm[] = "[velm] measured velocity%18.3f %s/min\n";
+static const char fmt_vmpk[] = "[vmpk] measured peak velocity%13.3f %s/min\n";
+static const char fmt_vmmn[] = "[vmmn] measured mean velocity%13.3f %s/min\n";
+static const char fmt_vmpl[] = "[vmpl] planned mean velocity%14.3f %s/min\n";
+static const char fmt_vmac[] = "[vmac] measured peak acceleration%9.3f %s/s^2\n";
+
+static const char *_units() { return ((cm_get_units_mode(RUNTIME) == INCHES) ? "in" : "mm"); }
+
+void en_print_velm(nvObj_t *nv) { text_print_flt_units(nv, fmt_velm, _units()); }
+void en_print_vm(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    const char *format = fmt_vmac;
+    if (token[2] == 'm') {
+        format = fmt_vmmn;
+    } else if (token[2] == 'p') {
+        format = (token[3] == 'k') ? fmt_vmpk : fmt_vmpl;
+    }
+    text_print_flt_units(nv, format, _units());
+}
+
 #endif  // __TEXT_MODE
@@ -87,19 +87,78 @@
  */
 
 #include "hardware.h"  // for MOTORS
+#include "config.h"
+#include "settings.h"  // for ENCODER_LOG_ENABLED
 
 #ifndef ENCODER_H_ONCE
 #define ENCODER_H_ONCE
 
 /**** Configs and Constants ****/
 
+/* Hardware encoders
+ *
+ *  Motors set in the ENCODER_HW_MOTORS bit mask (bit 0 = motor 1) read a real quadrature
+ *  or SPI encoder through board_encoder_read() instead of counting DDA steps. The counter is
+ *  latched by the loader, the same place the virtual encoder is accumulated, so the reading
+ *  is taken at a segment boundary and lines up with commanded_steps for step correction.
+ *  The latch is a single counter read at HI interrupt level. Conversion to steps is done in
+ *  en_read_encoder(), which runs in exec. Boards set ENCODER_HW_MOTORS in hardware.h and the
+ *  counter scale with en_set_encoder_scale().
+ */
+#ifndef ENCODER_HW_MOTORS
+#define ENCODER_HW_MOTORS 0
+#endif
+#define ENCODER_IS_HW(m) (ENCODER_HW_MOTORS & (1 << (m)))
+
+/* Following error log
+ *
+ *  With ENCODER_LOG_ENABLED exec records the commanded and encoder steps of every segment
+ *  into a ring of ENCODER_LOG_SEGMENTS entries, as they are compared in _exec_aline_segment().
+ *  While {enlst:1} is set the controller drains the ring as binary frames (see xio.h), so lost
+ *  steps and the STEP_CORRECTION_ settings can be studied under load without logging from the
+ *  interrupts. Entries that find the ring full are dropped and counted in {enlov:n}.
+ */
+#ifndef ENCODER_LOG_SEGMENTS
+#define ENCODER_LOG_SEGMENTS 64             // must be a power of 2
+#endif
+#define ENCODER_LOG_BATCH 8                 // max entries sent per controller pass
+#define ENCODER_LOG_RECORD 'E'              // binary frame record type
+
+/* Measured velocity
+ *
+ *  With ENCODER_MEASURE_ENABLED exec queues the encoder position of every segment, with the
+ *  segment time and planned velocity, into a ring of ENCODER_MEASURE_SAMPLES entries. The
+ *  encoder callback converts them to tool path positions with forward kinematics - off the
+ *  interrupts - and differences them into the velocity and acceleration the motors actually
+ *  made. {velm:} is the latest measured velocity, to report beside the planned {vel:}. The
+ *  {vm:} group holds the peak and mean measured velocity, the mean planned velocity and the
+ *  peak measured acceleration of the last window of ENCODER_MEASURE_WINDOW segments, or of
+ *  the last move if it was shorter. Velocities are in units/min, acceleration in units/s^2.
+ *
+ *  The encoder reading trails exec by two segments (see above), so the planned values are
+ *  delayed to match. A dropped sample, or one that follows a gap of ENCODER_MEASURE_GAP_MS
+ *  (a stop, a dwell, a position reset), restarts the differences from that sample.
+ */
+#ifndef ENCODER_MEASURE_SAMPLES
+#define ENCODER_MEASURE_SAMPLES 32          // must be a power of 2
+#endif
+#ifndef ENCODER_MEASURE_WINDOW
+#define ENCODER_MEASURE_WINDOW 128          // segments per published window
+#endif
+#define ENCODER_MEASURE_GAP_MS 10           // longer between segments and the motion had stopped
+
 /**** Macros ****/
 // used to abstract the encoder code out of the stepper so it can be managed in one place
 
 #define SET_ENCODER_STEP_SIGN(m, s) en.en[m].step_sign = s;
 #define INCREMENT_ENCODER(m) en.en[m].steps_run += en.en[m].step_sign;
+#define LOAD_ENCODER_STEPS(m, s) en.en[m].steps_run = s;     // whole segment counted up front (DDA_STEP_TABLE)
 #define ACCUMULATE_ENCODER(m)                     \
-    en.en[m].encoder_steps += en.en[m].steps_run; \
+    if (ENCODER_IS_HW(m)) {                       \
+        en.en[m].counts = board_encoder_read(m);  \
+    } else {                                      \
+        en.en[m].encoder_steps += en.en[m].steps_run; \
+    }                                             \
     en.en[m].steps_run = 0;
 
 /**** Structures ****/
@@ -108,12 +167,75 @@ typedef struct enEncoder {          // one real or virtual encoder per controlle
     int8_t  step_sign;              // set to +1 or -1
     int16_t steps_run;              // + or - steps counted during stepper interrupt
     int32_t encoder_steps;          // counted encoder position	in steps
+
+    // hardware encoders only
+    int32_t counts;                 // counter latched at the last segment boundary
+    int32_t count_zero;             // counter value at step_zero
+    float   step_zero;              // step position set by en_set_encoder_steps()
+    float   steps_per_count;        // counter scale (negative if the encoder counts backwards)
 } enEncoder_t;
 
+typedef struct enLogEntry {         // one segment of the following error log
+    uint32_t segment;               // segment sequence number (gaps show dropped entries)
+    float commanded[MOTORS];        // commanded steps, time aligned to the encoder reading
+    float encoder[MOTORS];          // encoder steps
+} enLogEntry_t;
+
+typedef struct enLog {
+    enLogEntry_t entry[ENCODER_LOG_SEGMENTS];
+    volatile uint8_t head;          // written by exec only
+    volatile uint8_t tail;          // written by the controller only
+    uint32_t segment;               // next segment sequence number
+    uint32_t overruns;              // entries dropped because the ring was full
+    bool stream;                    // send entries to the host as they arrive
+} enLog_t;
+
+typedef struct enMeasureSample {   // one segment queued for velocity measurement
+    float steps[MOTORS];            // encoder steps, two segments behind the planned values
+    float segment_time;             // segment time (minutes)
+    float velocity;                 // planned segment velocity
+    uint32_t tick;                  // SysTick when the segment was run by exec
+    bool restart;                   // the sample before this one was dropped
+} enMeasureSample_t;
+
+typedef struct enMeasure {
+    enMeasureSample_t sample[ENCODER_MEASURE_SAMPLES];
+    volatile uint8_t head;          // written by exec only
+    volatile uint8_t tail;          // written by the controller only
+    bool dropped;                   // exec dropped a sample because the ring was full
+
+    uint8_t chain;                  // samples since the differences were restarted (saturates at 3)
+    uint32_t tick;                  // SysTick of the last sample
+    float position[AXES];           // measured position of the last sample
+    float segment_time[2];          // planned values delayed to line up with the encoder
+    float planned[2];
+    float velocity;                 // last measured velocity (mm/min)
+    float velocity_time;            // time of the segment it was measured over
+
+    uint16_t count;                 // window accumulators
+    float time;
+    float length;
+    float planned_length;
+    float peak_velocity;
+    float peak_accel;
+
+    float measured_velocity;        // {velm:} published results, mm/min and mm/s^2
+    float window_peak;              // {vmpk:}
+    float window_mean;              // {vmmn:}
+    float window_planned;           // {vmpl:}
+    float window_accel;             // {vmac:}
+} enMeasure_t;
+
 typedef struct enEncoders {
     magic_t     magic_start;
     enEncoder_t en[MOTORS];         // runtime encoder structures
     float       snapshot[MOTORS];   // snapshot vector
+#if ENCODER_LOG_ENABLED == true
+    enLog_t     log;                // following error log
+#endif
+#if ENCODER_MEASURE_ENABLED == true
+    enMeasure_t measure;            // measured velocity
+#endif
     magic_t     magic_end;
 } enEncoders_t;
 
@@ -129,9 +251,35 @@ stat_t encoder_test_assertions(void);
 
 void en_set_encoder_steps(uint8_t motor, float steps);
 float en_read_encoder(uint8_t motor);
+void en_set_encoder_scale(uint8_t motor, float steps_per_count);
+
+int32_t board_encoder_read(const uint8_t motor);    // provided by the board (see board_stepper.cpp)
 
 void en_take_encoder_snapshot();
 float en_get_encoder_snapshot_steps(uint8_t motor);
 float* en_get_encoder_snapshot_vector();
 
+void en_log_segment(const float commanded[], const float encoder[]);
+void en_measure_segment(const float segment_time, const float velocity);
+stat_t en_callback(void);
+
+stat_t en_get_enlst(nvObj_t *nv);
+stat_t en_set_enlst(nvObj_t *nv);
+stat_t en_get_enlov(nvObj_t *nv);
+stat_t en_set_enlov(nvObj_t *nv);
+stat_t en_get_velm(nvObj_t *nv);
+stat_t en_get_vm(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void en_print_enlst(nvObj_t *nv);
+    void en_print_enlov(nvObj_t *nv);
+    void en_print_velm(nvObj_t *nv);
+    void en_print_vm(nvObj_t *nv);
+#else
+    #define en_print_enlst tx_print_stub
+    #define en_print_enlov tx_print_stub
+    #define en_print_velm tx_print_stub
+    #define en_print_vm tx_print_stub
+#endif // __TEXT_MODE
+
 #endif  // End of include guard: ENCODER_H_ONCE
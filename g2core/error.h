@@ -281,11 +281,11 @@ char *get_status_message(stat_t status);
 
 #define STAT_T_WORD_IS_MISSING 180
 #define STAT_T_WORD_IS_INVALID 181
+#define STAT_K_WORD_IS_MISSING 182     // G33 and G33.1 need the pitch
+#define STAT_K_WORD_IS_INVALID 183
 
 /* reserved for Gcode or other program errors */
 
-#define STAT_ERROR_182 182
-#define STAT_ERROR_183 183
 #define STAT_ERROR_184 184
 #define STAT_ERROR_185 185
 #define STAT_ERROR_186 186
@@ -576,8 +576,8 @@ static const char stat_179[] = "S word invalid";
 
 static const char stat_180[] = "T word missing";
 static const char stat_181[] = "T word invalid";
-static const char stat_182[] = "182";
-static const char stat_183[] = "183";
+static const char stat_182[] = "K word missing";
+static const char stat_183[] = "K word invalid";
 static const char stat_184[] = "184";
 static const char stat_185[] = "185";
 static const char stat_186[] = "186";
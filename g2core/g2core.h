@@ -70,11 +70,32 @@ typedef uint16_t magic_t;		        // magic number size
 
 // Note: If you change COORDS you must adjust the entries in cfgArray table in config.c
 
+/*
+ * AXES may be set on the compiler command line to build for a smaller machine. Every
+ * per-axis array in the Gcode model, the planner buffers and the runtime is AXES long,
+ * so a 3 axis router (AXES=3) carries a third of the axis data of the full build.
+ *
+ *    AXES=9    XYZUVWABC - the full set (default)
+ *    AXES=3..6 XYZABC truncated to AXES: 3 is XYZ, 4 is XYZA, 6 is XYZABC
+ *
+ *  Reduced builds number the axes in the external (XYZABC) order so the active axes are
+ *  the first AXES entries. The axes that are left out keep their enum values (>= AXES),
+ *  have no storage and their config tokens are not recognized (see nv_axis_active()).
+ */
+#ifndef AXES
 #define AXES 9          // number of axes supported in this version
+#endif
+#if (AXES == 9)
 #define HOMING_AXES 4   // number of axes that can be homed (assumes Zxyabc sequence)
+#elif (AXES >= 3) && (AXES <= 6)
+#define HOMING_AXES ((AXES < 4) ? AXES : 4)
+#else
+#error "AXES must be 9 or 3 to 6"
+#endif
 #define COORDS 6        // number of supported coordinate systems (index starts at 1)
 #define TOOLS 32        // number of entries in tool table (index starts at 1)
 
+#if (AXES == 9)
 typedef enum {
     AXIS_X = 0,
     AXIS_Y,
@@ -87,6 +108,30 @@ typedef enum {
     AXIS_C
 } cmAxes;
 
+#define AXIS_CHARS "xyzuvwabc"          // axis letters in cmAxes order
+#define AXIS_LINEAR_MAX AXIS_W          // last linear axis
+#define AXIS_ROTARY_MAX AXIS_C          // last rotary axis
+
+#else
+typedef enum {
+    AXIS_X = 0,
+    AXIS_Y,
+    AXIS_Z,
+    AXIS_A,
+    AXIS_B,
+    AXIS_C,
+    AXIS_U,                             // U, V and W are never active in a reduced build
+    AXIS_V,
+    AXIS_W
+} cmAxes;
+
+#define AXIS_CHARS "xyzabcuvw"
+#define AXIS_LINEAR_MAX AXIS_Z
+#define AXIS_ROTARY_MAX (AXES - 1)      // AXIS_Z if there are no rotaries
+#endif
+
+#define AXIS_ACTIVE(a) ((a) < AXES)     // constant for a constant axis - the test compiles away
+
 typedef enum {  // external representation of axes (used in initialization)
     AXIS_X_EXTERNAL = 0,
     AXIS_Y_EXTERNAL,
@@ -40,7 +40,9 @@ typedef enum
     MOTION_MODE_CANNED_CYCLE_86,       // G86 - boring, spindle stop, rapid out
     MOTION_MODE_CANNED_CYCLE_87,       // G87 - back boring
     MOTION_MODE_CANNED_CYCLE_88,       // G88 - boring, spindle stop, manual out
-    MOTION_MODE_CANNED_CYCLE_89        // G89 - boring, dwell, feed out
+    MOTION_MODE_CANNED_CYCLE_89,       // G89 - boring, dwell, feed out
+    MOTION_MODE_SPINDLE_SYNC,          // G33 - spindle synchronized motion (threading)
+    MOTION_MODE_RIGID_TAP              // G33.1 - rigid tapping
 } cmMotionMode;
 
 typedef enum
@@ -51,6 +53,12 @@ typedef enum
     CANON_PLANE_YZ      // G19    Y      Z      X
 } cmCanonicalPlane;
 
+typedef enum
+{                       // return mode in canned cycles
+    RETRACT_OLD_Z = 0,  // G98 - retract to the Z the block started at (or R if higher)
+    RETRACT_R_PLANE     // G99 - retract to the R plane
+} cmRetractMode;
+
 typedef enum
 {
     INCHES = 0,  // G20
@@ -178,16 +186,17 @@ typedef struct GCodeState
                               //         G83, G84, G85, G86, G87, G88, G89
 
     float target[AXES];         // XYZABC target where the move should go
-    float target_comp[AXES];    // summation compensation (Kahan) overflow value
     float display_offset[AXES]; // work offsets from the machine coordinate system (for reporting only)
 
     float feed_rate; // F - normalized to millimeters/minute or in inverse time mode
     float P_word;    // P - parameter used for dwell time in seconds, G10 coord select...
+    float spindle_speed; // S - spindle speed or laser power the move runs at (see spindle_speed_sync())
 
     cmFeedRateMode feed_rate_mode;        // See cmFeedRateMode for settings
     cmCanonicalPlane select_plane;        // G17,G18,G19 - values to set plane to
     cmUnitsMode units_mode;               // G20,G21 - 0=inches (G20), 1 = mm (G21)
     cmPathControl path_control;           // G61... EXACT_PATH, EXACT_STOP, CONTINUOUS
+    float path_tolerance;                 // G64 P - blend corners within this deviation (mm), 0 = no blending
     cmDistanceMode distance_mode;         // G90=use absolute coords, G91=incremental movement
     cmDistanceMode arc_distance_mode;     // G90.1=use absolute IJK offsets, G91.1=incremental IJK offsets
     cmAbsoluteOverride absolute_override; // G53 TRUE = move using machine coordinates - this block only
@@ -208,11 +217,13 @@ typedef struct GCodeState
 
         feed_rate = 0.0;
         P_word = 0.0;
+        spindle_speed = 0.0;
 
         feed_rate_mode = INVERSE_TIME_MODE;
         select_plane = CANON_PLANE_XY;
         units_mode = INCHES;
         path_control = PATH_EXACT_PATH;
+        path_tolerance = 0.0;
         distance_mode = ABSOLUTE_DISTANCE_MODE;
         arc_distance_mode = ABSOLUTE_DISTANCE_MODE;
         absolute_override = ABSOLUTE_OVERRIDE_OFF;
@@ -26,6 +26,7 @@
 #include "spindle.h"
 #include "coolant.h"
 #include "util.h"
+#include "report.h"
 #include "xio.h" // for char definitions
 
 #if MARLIN_COMPAT_ENABLED == true
@@ -130,6 +131,7 @@ typedef struct GCodeInputValue
     float S_word;        // S word - 通常以RPM为单位
     uint8_t H_word;      // H word - 由G43s使用
     uint8_t L_word;      // L word - 由G10s使用
+    float Q_word;        // Q word - G83 peck increment
 
     uint8_t feed_rate_mode;     // 有关设置，请参阅cmFeedRateMode
     uint8_t select_plane;       // G17,G18,G19 - 将平面设置为的值
@@ -138,6 +140,7 @@ typedef struct GCodeInputValue
     uint8_t path_control;       // G61... EXACT_PATH, EXACT_STOP, CONTINUOUS
     uint8_t distance_mode;      // G91   0=使用绝对坐标(G90), 1=增量运动
     uint8_t arc_distance_mode;  // G90.1=使用绝对IJK偏移, G91.1=增量IJK偏移
+    uint8_t retract_mode;       // G98, G99 - canned cycle return mode
     uint8_t origin_offset_mode; // G92...TRUE=原点偏移模式
     uint8_t absolute_override;  // G53 TRUE = 使用机器坐标移动 - 仅此块（G53）
 
@@ -178,6 +181,7 @@ typedef struct GCodeFlags
     bool S_word;
     bool H_word;
     bool L_word;
+    bool Q_word;
 
     bool feed_rate_mode;
     bool select_plane;
@@ -186,6 +190,7 @@ typedef struct GCodeFlags
     bool path_control;
     bool distance_mode;
     bool arc_distance_mode;
+    bool retract_mode;
     bool origin_offset_mode;
     bool absolute_override;
 
@@ -212,9 +217,23 @@ typedef struct GCodeFlags
 
 } GCodeFlag_t;
 
+#define GCODE_MAX_WORDS 64 // maximum words in a block (letter + value pairs)
+
+typedef struct GCodeWord
+{                      // a tokenized word from a normalized block
+    char letter;       // word letter, e.g. G or X
+    uint16_t offset;   // offset of the word's letter in the normalized block
+    float value;       // word value (e.g. 2 for G2)
+    int32_t value_int; // integer value - needed for line numbers
+} GCodeWord_t;
+
 typedef struct GCodeParser
 {
     bool modals[MODAL_GROUP_COUNT];
+    uint8_t word_count;               // number of words in the word table
+    uint16_t word_end;                // offset where tokenizing stopped
+    stat_t word_status;               // tokenizing status, reported after the words before it are parsed
+    GCodeWord_t word[GCODE_MAX_WORDS]; // word table for the current block
 } GCodeParser_t;
 
 GCodeParser_t gp; // 主解析器结构
@@ -223,7 +242,7 @@ GCodeFlag_t gf;   // gcode输入标志
 
 // 本地帮助程序函数和宏
 static void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag);
-static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int32_t *value_int);
+static void _tokenize_gcode_block(char *buf);
 static stat_t _point(float value);
 static stat_t _verify_checksum(char *str);
 static stat_t _validate_gcode_block(char *active_comment);
@@ -244,6 +263,11 @@ static stat_t _execute_gcode_block(char *active_comment);           // Execute t
     {                     \
         status = f(gv.v); \
     }
+#define EXEC_CHANGED(f, v, m)      \
+    if (gf.v && (gv.v != (m)))     \
+    {                              \
+        status = f(gv.v);          \
+    }
 
 /*
  * gcode_parser_init()
@@ -268,6 +292,8 @@ stat_t gcode_parser(char *block)
     char *active_comment = &none; // gcode comment or NUL string
     uint8_t block_delete_flag;
 
+    jr_count_line();   // for job progress reports
+
     stat_t check_ret = _verify_checksum(str);
     if (check_ret != STAT_OK)
     {
@@ -303,6 +329,8 @@ stat_t gcode_parser(char *block)
  * 返回STAT_OK是否有效。
  * 如果校验和不匹配，则返回STAT_CHECKSUM_MATCH_FAILED。
  */
+#define _HAS_ZERO_BYTE(w) (((w) - 0x01010101) & ~(w) & 0x80808080)
+
 static stat_t _verify_checksum(char *str)
 {
     bool has_line_number = false; // -1表示我们没有
@@ -311,7 +339,30 @@ static stat_t _verify_checksum(char *str)
         has_line_number = true;
     }
 
+    // XOR a word at a time once aligned. A word holding a NUL, '*', LF or CR is left to the
+    // byte loop. Aligned reads never cross into an unmapped page, so reading past the NUL is safe.
     char checksum = 0;
+    while (((uintptr_t)str & 3) && *str && (*str != '*') && (*str != '\n') && (*str != '\r'))
+    {
+        checksum ^= *str++;
+    }
+    uint32_t sum_word = 0;
+    while (((uintptr_t)str & 3) == 0)       // unaligned here means the byte loop found the end
+    {
+        uint32_t w;
+        memcpy(&w, str, sizeof(w));
+        if (_HAS_ZERO_BYTE(w) | _HAS_ZERO_BYTE(w ^ 0x2A2A2A2A) | _HAS_ZERO_BYTE(w ^ 0x0A0A0A0A) |
+            _HAS_ZERO_BYTE(w ^ 0x0D0D0D0D))
+        {
+            break;
+        }
+        sum_word ^= w;
+        str += sizeof(w);
+    }
+    sum_word ^= sum_word >> 16;
+    sum_word ^= sum_word >> 8;
+    checksum ^= (char)sum_word;
+
     char c = *str++;
     while (c && (c != '*') && (c != '\n') && (c != '\r'))
     {
@@ -627,63 +678,64 @@ void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_del
 }
 
 /****************************************************************************************
- * _get_next_gcode_word() - 获取由字母和值组成的gcode单词
+ * _tokenize_gcode_block() - 将标准化块拆分为单词表
+ *
+ *  Builds the word table (letter, value, offset) for the block in a single pass so the
+ *  parser and everything after it work from the table rather than rescanning the line.
+ *  A malformed word ends the table and its status is kept in gp.word_status; the parser
+ *  reports it only after the words before it, as some words (e.g. Marlin M23) consume
+ *  the rest of the line.
  *
  *  This function requires the Gcode string to be normalized.
  *  Normalization must remove any leading zeros or they will be converted to Octal
- *  G0X... is not interpreted as hexadecimal. This is trapped.
  */
 
-static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int32_t *value_int)
+static void _tokenize_gcode_block(char *buf)
 {
-    if (**pstr == NUL)
-    {
-        return (STAT_COMPLETE);
-    } // no more words
+    char *pstr = buf;
+    gp.word_count = 0;
+    gp.word_status = STAT_OK;
 
-    // get letter part
-    if (isupper(**pstr) == false)
-    {
-        return (STAT_INVALID_OR_MALFORMED_COMMAND);
-    }
-    *letter = **pstr;
-    (*pstr)++;
-
-    // Removed support for hex numbers
-    //    // X-axis-becomes-a-hexadecimal-number get-value case, e.g. G0X100 --> G255
-    //    if ((**pstr == '0') && (*(*pstr+1) == 'X')) {
-    //        *value = 0;
-    //        (*pstr)++;
-    //        return (STAT_OK);                           // pointer points to X
-    //    }
-    //
-    //    // get-value general case
-    //    char *end;
-    //    *value_int = atol(*pstr);                       // needed to get an accurate line number for N > 8,388,608
-    //    *value = strtof(*pstr, &end);
-
-    // get-value general case
-    char *end = *pstr;
-    *value = c_atof(end);
-    *value_int = atol(*pstr); // needed to get an accurate line number for N > 8,388,608
-
-    if (end == *pstr)
+    while (*pstr != NUL)
     {
-#if MARLIN_COMPAT_ENABLED == true
-        if (mst.marlin_flavor)
+        // get letter part
+        if (isupper(*pstr) == false)
         {
-            *value = 0;
+            gp.word_status = STAT_INVALID_OR_MALFORMED_COMMAND;
+            break;
         }
-        else
+        if (gp.word_count >= GCODE_MAX_WORDS)
         {
-            return (STAT_BAD_NUMBER_FORMAT);
+            gp.word_status = STAT_INPUT_EXCEEDS_MAX_LENGTH;
+            break;
         }
+        GCodeWord_t *w = &gp.word[gp.word_count++];
+        w->letter = *pstr;
+        w->offset = (uint16_t)(pstr - buf);
+        pstr++;
+
+        // get-value general case
+        // value_int is needed to get an accurate line number for N > 8,388,608
+        char *end = atonum(pstr, &w->value, &w->value_int, false);
+
+        if (end == pstr)
+        {
+#if MARLIN_COMPAT_ENABLED == true
+            if (!mst.marlin_flavor)
+            {
+                gp.word_count--;
+                gp.word_status = STAT_BAD_NUMBER_FORMAT;
+                break;
+            } // Marlin allows bare words; atonum() has already set the value to 0
 #else
-        return (STAT_BAD_NUMBER_FORMAT);
+            gp.word_count--;
+            gp.word_status = STAT_BAD_NUMBER_FORMAT;
+            break;
 #endif
-    } // more robust test then checking for value=0;
-    *pstr = end;
-    return (STAT_OK); // pointer points to next character after the word
+        } // more robust test then checking for value=0;
+        pstr = end;
+    }
+    gp.word_end = (uint16_t)(pstr - buf);
 }
 
 /*
@@ -724,21 +776,24 @@ static stat_t _validate_gcode_block(char *active_comment)
  * _parse_gcode_block() - 解析一行NULL终止的G-Code。
  *
  *  All the parser does is load the state values in gn (next model state) and set flags
- *  in gf (model state flags). The execute routine applies them. The buffer is assumed to
- *  contain only uppercase characters and signed floats (no whitespace).
+ *  in gf (model state flags) from the block's word table. The execute routine applies
+ *  them. The buffer is assumed to contain only uppercase characters and signed floats
+ *  (no whitespace).
  */
 
 static stat_t _parse_gcode_block(char *buf, char *active_comment)
 {
-    char *pstr = (char *)buf; // persistent pointer into gcode block for parsing words
-    char letter;              // parsed letter, eg.g. G or X or Y
-    float value = 0;          // value parsed from letter (e.g. 2 for G2)
-    int32_t value_int = 0;    // integer value parsed from letter - needed for line numbers
+    char letter;           // parsed letter, eg.g. G or X or Y
+    float value = 0;       // value parsed from letter (e.g. 2 for G2)
+    int32_t value_int = 0; // integer value parsed from letter - needed for line numbers
     stat_t status = STAT_OK;
 
+    _tokenize_gcode_block(buf);
+
     // set initial state for new move
     memset(&gv, 0, sizeof(GCodeValue_t));       // clear all next-state values
     memset(&gf, 0, sizeof(GCodeFlag_t));        // clear all next-state flags
+    memset(gp.modals, 0, sizeof(gp.modals));    // clear the modal groups named in the block
     gv.motion_mode = cm_get_motion_mode(MODEL); // get motion mode from previous block
 
     // Causes a later exception if
@@ -751,8 +806,11 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
     }
 
     // extract commands and parameters
-    while ((status = _get_next_gcode_word(&pstr, &letter, &value, &value_int)) == STAT_OK)
+    for (uint8_t w = 0; w < gp.word_count; w++)
     {
+        letter = gp.word[w].letter;
+        value = gp.word[w].value;
+        value_int = gp.word[w].value_int;
         switch (letter)
         {
         case 'G':
@@ -816,6 +874,19 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 }
                 break;
             }
+            case 33:
+            {
+                switch (_point(value))
+                {
+                case 0:
+                    SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_SPINDLE_SYNC);
+                case 1:
+                    SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_RIGID_TAP);
+                default:
+                    status = STAT_GCODE_COMMAND_UNSUPPORTED;
+                }
+                break;
+            }
             case 38:
             {
                 switch (_point(value))
@@ -881,6 +952,16 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 SET_MODAL(MODAL_GROUP_G13, path_control, PATH_CONTINUOUS);
             case 80:
                 SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANCEL_MOTION_MODE);
+            case 81:
+                SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANNED_CYCLE_81);
+            case 82:
+                SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANNED_CYCLE_82);
+            case 83:
+                SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANNED_CYCLE_83);
+            case 85:
+                SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANNED_CYCLE_85);
+            case 89:
+                SET_MODAL(MODAL_GROUP_G1, motion_mode, MOTION_MODE_CANNED_CYCLE_89);
             case 90:
             {
                 switch (_point(value))
@@ -929,6 +1010,10 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
             case 94:
                 SET_MODAL(MODAL_GROUP_G5, feed_rate_mode, UNITS_PER_MINUTE_MODE);
                 //              case 95: SET_MODAL (MODAL_GROUP_G5, feed_rate_mode, UNITS_PER_REVOLUTION_MODE);
+            case 98:
+                SET_MODAL(MODAL_GROUP_G9, retract_mode, RETRACT_OLD_Z);
+            case 99:
+                SET_MODAL(MODAL_GROUP_G9, retract_mode, RETRACT_R_PLANE);
 
             default:
                 status = STAT_GCODE_COMMAND_UNSUPPORTED;
@@ -1000,7 +1085,7 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 status = STAT_COMPLETE;
                 break; // Release SD card
             case 23:
-                marlin_select_sd_response(pstr);
+                marlin_select_sd_response(buf + ((w + 1 < gp.word_count) ? gp.word[w + 1].offset : gp.word_end));
                 status = STAT_COMPLETE;
                 break; // Select SD file
 
@@ -1068,18 +1153,26 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
             SET_NON_MODAL(target[AXIS_Y], value);
         case 'Z':
             SET_NON_MODAL(target[AXIS_Z], value);
+#if (AXES >= 4)                     // axes a reduced build leaves out are unsupported words
         case 'A':
             SET_NON_MODAL(target[AXIS_A], value);
+#endif
+#if (AXES >= 5)
         case 'B':
             SET_NON_MODAL(target[AXIS_B], value);
+#endif
+#if (AXES >= 6)
         case 'C':
             SET_NON_MODAL(target[AXIS_C], value);
+#endif
+#if (AXES == 9)
         case 'U':
             SET_NON_MODAL(target[AXIS_U], value);
         case 'V':
             SET_NON_MODAL(target[AXIS_V], value);
         case 'W':
             SET_NON_MODAL(target[AXIS_W], value);
+#endif
         case 'H':
             SET_NON_MODAL(H_word, value);
         case 'I':
@@ -1091,7 +1184,9 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
         case 'L':
             SET_NON_MODAL(L_word, value);
         case 'R':
-            SET_NON_MODAL(arc_radius, value);
+            SET_NON_MODAL(arc_radius, value); // also the R plane of canned cycles
+        case 'Q':
+            SET_NON_MODAL(Q_word, value);
         case 'N':
             SET_NON_MODAL(linenum, value_int); // line number handled as special case to preserve integer value
 
@@ -1105,6 +1200,10 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
         if (status != STAT_OK)
             break;
     }
+    if (status == STAT_OK)
+    {
+        status = gp.word_status; // any tokenizing error comes after the words before it
+    }
     if ((status != STAT_OK) && (status != STAT_COMPLETE))
         return (status);
 	//#define ritorno(a) if((status_code=a) != STAT_OK) { return(status_code); }
@@ -1181,7 +1280,10 @@ stat_t _execute_gcode_block(char *active_comment)
         ritorno(spindle_override_control(gv.P_word, gf.P_word));
     }
     //#define EXEC_FUNC(f,v) if(gf.v) { status=f(gv.v);}
-    EXEC_FUNC(cm_set_feed_rate_mode, feed_rate_mode); // G93, G94
+    // Modal words a post repeats on every line (G17, G21, G90, G94, G54...) are compared
+    // to the model and skipped when they would not change it. G54-G59 would otherwise
+    // queue a planner command each time.
+    EXEC_CHANGED(cm_set_feed_rate_mode, feed_rate_mode, cm->gm.feed_rate_mode); // G93, G94
     EXEC_FUNC(cm_set_feed_rate, F_word);              // F
 
     ritorno(_execute_gcode_block_marlin()); // 如果启用Marlin兼容性，则执行Marlin命令
@@ -1214,8 +1316,8 @@ stat_t _execute_gcode_block(char *active_comment)
     {                                 // G4 - dwell
         ritorno(cm_dwell(gv.P_word)); // return if error, otherwise complete the block
     }
-    EXEC_FUNC(cm_select_plane, select_plane); // G17, G18, G19
-    EXEC_FUNC(cm_set_units_mode, units_mode); // G20, G21
+    EXEC_CHANGED(cm_select_plane, select_plane, cm->gm.select_plane); // G17, G18, G19
+    EXEC_CHANGED(cm_set_units_mode, units_mode, cm->gm.units_mode);     // G20, G21
     //--> cutter radius compensation goes here
 
     switch (gv.next_action)
@@ -1240,16 +1342,16 @@ stat_t _execute_gcode_block(char *active_comment)
     } // quiet the compiler warning about all the things we don't handle here
     }
 
-    EXEC_FUNC(cm_set_coord_system, coord_system); // G54, G55, G56, G57, G58, G59
+    EXEC_CHANGED(cm_set_coord_system, coord_system, cm->gm.coord_system); // G54, G55, G56, G57, G58, G59
 
     if (gf.path_control)
     { // G61, G61.1, G64
-        status = cm_set_path_control(MODEL, gv.path_control);
+        status = cm_set_path_control(MODEL, gv.path_control, gv.P_word, gf.P_word);
     }
 
-    EXEC_FUNC(cm_set_distance_mode, distance_mode);         // G90, G91
-    EXEC_FUNC(cm_set_arc_distance_mode, arc_distance_mode); // G90.1, G91.1
-    //--> set retract mode goes here
+    EXEC_CHANGED(cm_set_distance_mode, distance_mode, cm->gm.distance_mode);             // G90, G91
+    EXEC_CHANGED(cm_set_arc_distance_mode, arc_distance_mode, cm->gm.arc_distance_mode); // G90.1, G91.1
+    EXEC_FUNC(cm_set_retract_mode, retract_mode);           // G98, G99
 
     switch (gv.next_action)
     {
@@ -1387,6 +1489,28 @@ stat_t _execute_gcode_block(char *active_comment)
                                  gv.motion_mode);
             break;
         }
+        case MOTION_MODE_CANNED_CYCLE_81: // G81
+        case MOTION_MODE_CANNED_CYCLE_82: // G82
+        case MOTION_MODE_CANNED_CYCLE_83: // G83
+        case MOTION_MODE_CANNED_CYCLE_85: // G85
+        case MOTION_MODE_CANNED_CYCLE_89: // G89
+        {
+            status = cm_canned_cycle(gv.motion_mode,
+                                     gv.target, gf.target,
+                                     gv.arc_radius, gf.arc_radius,
+                                     gv.Q_word, gf.Q_word,
+                                     gv.P_word, gf.P_word,
+                                     gv.L_word, gf.L_word);
+            break;
+        }
+        case MOTION_MODE_SPINDLE_SYNC: // G33
+        case MOTION_MODE_RIGID_TAP:    // G33.1
+        {
+            status = cm_spindle_sync_feed(gv.motion_mode,
+                                          gv.target, gf.target,
+                                          gv.arc_offset[2], gf.arc_offset[2]);
+            break;
+        }
         default:
             break;
         }
@@ -1460,13 +1584,13 @@ static stat_t _execute_gcode_block_marlin()
     if (gf.E_word)
     {
         // Ennn T0 -> Annn
-        if (cm->gm.tool_select == 1)
+        if ((cm->gm.tool_select == 1) && AXIS_ACTIVE(AXIS_A))
         {
             gf.target[AXIS_A] = true;
             gv.target[AXIS_A] = gv.E_word;
         }
         // Ennn T1 -> Bnnn
-        else if (cm->gm.tool_select == 2)
+        else if ((cm->gm.tool_select == 2) && AXIS_ACTIVE(AXIS_B))
         {
             gf.target[AXIS_B] = true;
             gv.target[AXIS_B] = gv.E_word;
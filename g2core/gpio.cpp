@@ -52,6 +52,8 @@
 #include "controller.h"
 #include "util.h"
 #include "report.h"
+#include "sync.h"
+#include "spindle.h"
 #include "xio.h"
 
 #include "MotateTimers.h"
@@ -64,6 +66,61 @@ d_out_t  d_out[D_OUT_CHANNELS];
 a_in_t   a_in[A_IN_CHANNELS];
 a_out_t  a_out[A_OUT_CHANNELS];
 
+/**** Input event queue ****
+ *
+ *  Limit, shutdown and interlock edges are posted here by the input ISR and drained
+ *  by the controller, which the ISR wakes. The input interrupts share one priority so
+ *  there is only ever one writer (head) and one reader (tail). Indexes are free-running
+ *  and masked on use. An event that finds the queue full sets overrun, which the reader
+ *  turns into an alarm rather than lose a limit or shutdown.
+ */
+
+static struct gpioEventQueue {
+    gpioEvent_t event[GPIO_EVENT_QUEUE_SIZE];
+    volatile uint8_t head;              // next slot to write (ISR)
+    volatile uint8_t tail;              // next slot to read (main loop)
+    volatile bool overrun;              // an event was dropped
+} geq;
+static_assert(((GPIO_EVENT_QUEUE_SIZE & (GPIO_EVENT_QUEUE_SIZE-1)) == 0) && (GPIO_EVENT_QUEUE_SIZE <= 128),
+              "GPIO_EVENT_QUEUE_SIZE must be a power of 2 that fits the uint8_t queue indexes");
+
+static void _post_event(const inputFunc function, const inputEdgeFlag edge, const uint8_t input)
+{
+    uint8_t head = geq.head;
+    if ((uint8_t)(head - geq.tail) >= GPIO_EVENT_QUEUE_SIZE) {
+        geq.overrun = true;
+    } else {
+        geq.event[head & (GPIO_EVENT_QUEUE_SIZE-1)] = { function, edge, input };
+        __DMB();                        // the event must be in place before the reader can see it
+        geq.head = head + 1;
+    }
+    controller_wake_task(CONTROLLER_TASK_INPUT_EVENTS);
+}
+
+/**** Input state snapshot ****
+ *
+ *  Bit n-1 is set while input n is active, so a status report can carry every input
+ *  as one value ({inm:}) instead of one nvObj per input. Inputs write their own bit
+ *  from the pin change ISR, which all share one priority. Other writers hold off
+ *  interrupts while they update the mask.
+ */
+
+static volatile uint32_t input_mask;
+static_assert(D_IN_CHANNELS <= 32, "input_mask holds one bit per digital input");
+
+static void _set_input_state(d_in_t *in, const uint8_t ext_pin_number, const ioState state)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    in->state = state;
+    if (state == INPUT_ACTIVE) {
+        input_mask |= (1UL << (ext_pin_number-1));
+    } else {
+        input_mask &= ~(1UL << (ext_pin_number-1));
+    }
+    __set_PRIMASK(primask);
+}
+
 /**** Extended DI structure ****/
 
 // To be merged with ioDigitalInput later.
@@ -96,13 +153,13 @@ struct ioDigitalInputExt {
         d_in_t *in = &d_in[ext_pin_number-1];
 
         if (in->mode == IO_MODE_DISABLED) {
-            in->state = INPUT_DISABLED;
+            _set_input_state(in, ext_pin_number, INPUT_DISABLED);
             return;
         }
 
         bool pin_value = (bool)input_pin;
         int8_t pin_value_corrected = (pin_value ^ ((int)in->mode ^ 1));    // correct for NO or NC mode
-        in->state = (ioState)pin_value_corrected;
+        _set_input_state(in, ext_pin_number, (ioState)pin_value_corrected);
         in->ext_pin_number = ext_pin_number;    // diagnostic only. Not used by code
     }
 
@@ -113,7 +170,27 @@ struct ioDigitalInputExt {
 
         // return if input is disabled (not supposed to happen)
         if (in->mode == IO_MODE_DISABLED) {
-            in->state = INPUT_DISABLED;
+            _set_input_state(in, ext_pin_number, INPUT_DISABLED);
+            return;
+        }
+
+        // sync lines from another board are acted on at once - no lockout, action or function
+        if (sync_owns_input(ext_pin_number)) {
+            ioState state = (ioState)((bool)input_pin ^ ((int)in->mode ^ 1));
+            if (in->state != state) {
+                _set_input_state(in, ext_pin_number, state);
+                sync_input_changed(ext_pin_number, state);
+            }
+            return;
+        }
+
+        // spindle encoder channels are counted on every edge - no lockout, action or function
+        if (spindle_encoder_owns_input(ext_pin_number)) {
+            ioState state = (ioState)((bool)input_pin ^ ((int)in->mode ^ 1));
+            if (in->state != state) {
+                _set_input_state(in, ext_pin_number, state);
+                spindle_encoder_edge(ext_pin_number, state);
+            }
             return;
         }
 
@@ -133,7 +210,7 @@ struct ioDigitalInputExt {
         in->lockout_timer.set(in->lockout_ms);
 
         // record the changed state (we know it changed or we would have exited beforehand)
-        in->state = (ioState)pin_value_corrected;
+        _set_input_state(in, ext_pin_number, (ioState)pin_value_corrected);
         if (pin_value_corrected == INPUT_ACTIVE) {
             in->edge = INPUT_EDGE_LEADING;
         } else {
@@ -195,24 +272,11 @@ struct ioDigitalInputExt {
             }
         }
 
-        // these functions trigger on the leading edge
-        if (in->edge == INPUT_EDGE_LEADING) {
-            if (in->function == INPUT_FUNCTION_LIMIT) {
-                cm->limit_requested = ext_pin_number;
-
-            } else if (in->function == INPUT_FUNCTION_SHUTDOWN) {
-                cm->shutdown_requested = ext_pin_number;
-
-            } else if (in->function == INPUT_FUNCTION_INTERLOCK) {
-                cm->safety_interlock_disengaged = ext_pin_number;
-            }
-        }
-
-        // trigger interlock release on trailing edge
-        if (in->edge == INPUT_EDGE_TRAILING) {
-            if (in->function == INPUT_FUNCTION_INTERLOCK) {
-                cm->safety_interlock_reengaged = ext_pin_number;
-            }
+        // limit and shutdown trigger on the leading edge, interlock on both
+        if ((in->function == INPUT_FUNCTION_INTERLOCK) ||
+            ((in->edge == INPUT_EDGE_LEADING) &&
+             ((in->function == INPUT_FUNCTION_LIMIT) || (in->function == INPUT_FUNCTION_SHUTDOWN)))) {
+            _post_event(in->function, in->edge, ext_pin_number);
         }
         sr_request_status_report(SR_REQUEST_TIMED);
     };
@@ -385,7 +449,7 @@ void inputs_reset(void) {
     for (uint8_t i=0; i<D_IN_CHANNELS; i++) {
         in = &d_in[i];
         if (in->mode == IO_MODE_DISABLED) {
-            in->state = INPUT_DISABLED;
+            _set_input_state(in, i+1, INPUT_DISABLED);
             continue;
         }
         in->lockout_ms = INPUT_LOCKOUT_MS;
@@ -432,6 +496,39 @@ void gpio_reset(void)
  *  The counter continues to increment positive until the lockout is exceeded.
  */
 
+/*
+ * gpio_get_event()    - take the oldest input event. Returns false if there are none
+ * gpio_events_lost()  - true (once) if an event was dropped on a full queue
+ * gpio_flush_events() - discard queued events (e.g. switch closures during initialization)
+ */
+
+bool gpio_get_event(gpioEvent_t *event)
+{
+    uint8_t tail = geq.tail;
+    if (tail == geq.head) {
+        return (false);
+    }
+    *event = geq.event[tail & (GPIO_EVENT_QUEUE_SIZE-1)];
+    __DMB();                            // finish reading the slot before the writer may reuse it
+    geq.tail = tail + 1;
+    return (true);
+}
+
+bool gpio_events_lost(void)
+{
+    if (!geq.overrun) {
+        return (false);
+    }
+    geq.overrun = false;
+    return (true);
+}
+
+void gpio_flush_events(void)
+{
+    geq.tail = geq.head;
+    geq.overrun = false;
+}
+
 /*
  * gpio_set_homing_mode()   - set/clear input to homing mode
  * gpio_set_probing_mode()  - set/clear input to probing mode
@@ -529,7 +626,7 @@ static uint8_t _io(const index_t index)
         if (isdigit(*ptr)) { 
             return (atoi(ptr)-1);   // need to reduce by 1 for internal 0-based arrays
         }
-    } while (++ptr != NUL);
+    } while (*(++ptr) != NUL);
 
     return (0);
 }
@@ -573,7 +670,8 @@ stat_t io_set_fn(nvObj_t *nv)
 }
 
 /*
- *  io_get_input() - return input state given an nv object
+ *  io_get_input()  - return input state given an nv object
+ *  io_get_inputs() - return all input states as a bitmask (bit 0 = in1)
  */
 stat_t io_get_input(nvObj_t *nv)
 {
@@ -582,6 +680,13 @@ stat_t io_get_input(nvObj_t *nv)
     return (STAT_OK);
 }
 
+stat_t io_get_inputs(nvObj_t *nv)
+{
+    nv->value_int = input_mask;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
 /*
  * io_get_domode() - get digital output mode
  * io_set_domode() - set digital output mode
@@ -676,6 +781,7 @@ stat_t io_set_output(nvObj_t *nv)
     static const char fmt_gpio_ac[] = "[%sac] input action%15d [0=none,1=stop,2=fast_stop,3=halt,4=alarm,5=shutdown,6=panic,7=reset]\n";
     static const char fmt_gpio_fn[] = "[%sfn] input function%13d [0=none,1=limit,2=interlock,3=shutdown,4=probe]\n";
     static const char fmt_gpio_in[] = "Input %s state: %5d\n";
+    static const char fmt_gpio_inm[] = "[inm]  input states%15lu [bit 0 = in1]\n";
 
     static const char fmt_gpio_domode[] = "[%smo] output mode%16d [0=active low,1=active high,2=disabled]\n";
     static const char fmt_gpio_out[] = "Output %s state: %5d\n";
@@ -693,6 +799,11 @@ stat_t io_set_output(nvObj_t *nv)
         xio_writeline(cs.out_buf);
     }
 
+    void io_print_inm(nvObj_t *nv) {
+        sprintf(cs.out_buf, fmt_gpio_inm, (unsigned long)nv->value_int);
+        xio_writeline(cs.out_buf);
+    }
+
     void io_print_domode(nvObj_t *nv) {_print_di(nv, fmt_gpio_domode);}
     void io_print_out(nvObj_t *nv) {
         sprintf(cs.out_buf, fmt_gpio_out, nv->token, (int)nv->value_int);
@@ -120,6 +120,16 @@ typedef struct ioDigitalInput {		    // one struct per digital input
     Motate::Timeout lockout_timer;      // time to expire current debounce lockout, or 0 if no lockout
 } d_in_t;
 
+typedef struct gpioEvent {              // input function edge, posted by the input ISR for the main loop
+    inputFunc function;
+    inputEdgeFlag edge;
+    uint8_t input;                      // external input number (as in "di1")
+} gpioEvent_t;
+
+#ifndef GPIO_EVENT_QUEUE_SIZE
+#define GPIO_EVENT_QUEUE_SIZE 16        // must be a power of 2. boards can override this value in hardware.h
+#endif
+
 typedef struct gpioDigitalOutput {      // one struct per digital output
     ioMode mode;
 } d_out_t;
@@ -150,6 +160,9 @@ void gpio_set_homing_mode(const uint8_t input_num, const bool is_homing);
 void gpio_set_probing_mode(const uint8_t input_num, const bool is_probing);
 int8_t gpio_get_probing_input(void);
 bool gpio_read_input(const uint8_t input_num);
+bool gpio_get_event(gpioEvent_t *event);
+bool gpio_events_lost(void);
+void gpio_flush_events(void);
 stat_t gpio_set_output(uint8_t output_num, float value);
 
 stat_t io_get_mo(nvObj_t *nv);
@@ -160,6 +173,7 @@ stat_t io_get_fn(nvObj_t *nv);
 stat_t io_set_fn(nvObj_t *nv);
 
 stat_t io_get_input(nvObj_t *nv);
+stat_t io_get_inputs(nvObj_t *nv);
 
 stat_t io_get_domode(nvObj_t *nv);			// output sense
 stat_t io_set_domode(nvObj_t *nv);			// output sense
@@ -171,6 +185,7 @@ stat_t io_set_output(nvObj_t *nv);
     void io_print_ac(nvObj_t *nv);
     void io_print_fn(nvObj_t *nv);
     void io_print_in(nvObj_t *nv);
+    void io_print_inm(nvObj_t *nv);
     void io_print_domode(nvObj_t *nv);
     void io_print_out(nvObj_t *nv);
 #else
@@ -178,6 +193,7 @@ stat_t io_set_output(nvObj_t *nv);
     #define io_print_ac tx_print_stub
     #define io_print_fn tx_print_stub
     #define io_print_in tx_print_stub
+    #define io_print_inm tx_print_stub
     #define io_print_st tx_print_stub
     #define io_print_domode tx_print_stub
     #define io_print_out tx_print_stub
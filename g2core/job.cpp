@@ -0,0 +1,484 @@
+/*
+ * job.cpp - Gcode jobs stored on the board and run from there
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "job.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "planner.h"
+#include "report.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+#define JOB_MAGIC 0x424F4A47        // "GJOB"
+#define JOB_ERASED 0xFF             // value of an erased storage byte
+#define JOB_DATA_START JOB_PAGE_SIZE // Gcode follows the header page
+#define JOB_MOVE_NO_LINENUM 0x80    // move record flag: the line had no N word, keep the model's
+
+static_assert(XIO_BINARY_PAYLOAD_MAX <= JOB_LINE_LEN, "a move record payload must fit in the line buffer");
+
+static_assert((JOB_SECTOR_SIZE % JOB_PAGE_SIZE) == 0, "JOB_PAGE_SIZE must divide JOB_SECTOR_SIZE");
+
+typedef struct jobHeader {          // start of the store, written when recording ends
+    uint32_t magic;
+    uint32_t length;                // bytes of Gcode stored from JOB_DATA_START
+    uint32_t check;                 // ~length
+} jobHeader_t;
+
+enum jobMotion {                    // motion mode of the last stored line, while recording
+    JOB_MOTION_UNKNOWN = 0,         // not known - axis-only lines are stored as text
+    JOB_MOTION_TRAVERSE,            // G0
+    JOB_MOTION_FEED                 // G1
+};
+
+/**** Job singleton structure ****/
+
+struct jobSingleton {
+    uint8_t state;                  // jobState
+    uint8_t motion;                 // jobMotion
+    bool open;                      // the store has a backend
+    uint32_t length;                // bytes recorded so far, or the size of the stored job
+    uint32_t offset;                // next byte to read while running
+    uint16_t fill;                  // bytes in page: to program while recording, read while running
+    uint16_t index;                 // next byte of page to run
+    uint8_t page[JOB_PAGE_SIZE];    // page being recorded or run
+    char line[JOB_LINE_LEN];        // working copy of the line - the parser edits it in place
+};
+static struct jobSingleton job;
+
+/*
+ * Store backend
+ *
+ * _store_open()    - attach the store, returns false if there is none
+ * _store_read()    - read bytes from a store address
+ * _store_program() - program erased bytes, no more than a page and not across a page boundary
+ * _store_erase()   - erase a sector to all 0xFF
+ *
+ *  The simulators keep the store in JOB_FILE. Boards would supply these from their SPI
+ *  flash or SD card driver.
+ */
+
+#if defined(WIN32) || defined(SIM_POSIX)
+
+static FILE *job_file;
+
+static bool _store_open()
+{
+    if ((job_file = fopen(JOB_FILE, "r+b")) == NULL) {
+        job_file = fopen(JOB_FILE, "w+b");
+    }
+    return (job_file != NULL);
+}
+
+static void _store_read(uint32_t address, void *buf, uint32_t len)
+{
+    memset(buf, JOB_ERASED, len);                   // a short file reads as erased
+    fseek(job_file, address, SEEK_SET);
+    fread(buf, 1, len, job_file);
+}
+
+static void _store_program(uint32_t address, const void *buf, uint32_t len)
+{
+    fseek(job_file, address, SEEK_SET);
+    fwrite(buf, 1, len, job_file);
+    fflush(job_file);
+}
+
+static void _store_erase(uint32_t sector)
+{
+    uint8_t erased[JOB_PAGE_SIZE];
+    memset(erased, JOB_ERASED, sizeof(erased));
+    fseek(job_file, sector * JOB_SECTOR_SIZE, SEEK_SET);
+    for (uint16_t i = 0; i < (JOB_SECTOR_SIZE / JOB_PAGE_SIZE); i++) {
+        fwrite(erased, 1, sizeof(erased), job_file);
+    }
+    fflush(job_file);
+}
+
+#else
+
+static bool _store_open() { return (false); }
+static void _store_read(uint32_t address, void *buf, uint32_t len) { memset(buf, JOB_ERASED, len); }
+static void _store_program(uint32_t address, const void *buf, uint32_t len) {}
+static void _store_erase(uint32_t sector) {}
+
+#endif
+
+/****************************************************************************************
+ * job_init()      - attach the store and pick up the stored job, if any
+ * job_recording() - true while Gcode lines are being stored
+ * job_running()   - true while the stored job still has lines to queue
+ * job_progress()  - bytes of the running job read so far and still to read, 0 and 0 if none
+ */
+
+void job_init()
+{
+    memset(&job, 0, sizeof(job));
+    if (!(job.open = _store_open())) {
+        return;
+    }
+    jobHeader_t h;
+    _store_read(0, &h, sizeof(h));
+    if ((h.magic == JOB_MAGIC) && (h.check == ~h.length) &&
+        (h.length <= JOB_STORE_SIZE - JOB_DATA_START)) {
+        job.length = h.length;
+    }
+}
+
+bool job_recording() { return (job.state == JOB_RECORDING); }
+
+bool job_running() { return (job.state == JOB_RUNNING); }
+
+void job_progress(uint32_t *run, uint32_t *left)
+{
+    *run = (job.state == JOB_RUNNING) ? job.offset : 0;
+    *left = (job.state == JOB_RUNNING) ? job.length - job.offset : 0;
+}
+
+/****************************************************************************************
+ * _tokenize_line() - turn a plain G0 or G1 line into a move, returns false if it isn't one
+ *
+ *  A plain line holds an optional N word, an optional G0 or G1, one or more axis words
+ *  and an optional F word, and nothing else. Without a G word the motion is the one of
+ *  the line stored before, which is only known if that line was tokenized too - a text
+ *  line, or a macro it runs, may change the motion mode. Numbers are read with atonum()
+ *  as the Gcode parser reads them, and stay in the units and distance mode of the block:
+ *  they are interpreted when the move runs, as with the binary move channel.
+ */
+
+#if (AXES == 9)
+static const char axis_letters[] = "XYZUVWABC";     // in cmAxes order
+#else
+static const char axis_letters[] = "XYZABCUVW";
+#endif
+
+static bool _tokenize_line(char *line, xioBinaryMove_t *move)
+{
+    uint8_t motion = job.motion;
+    bool gword = false;
+    bool linenum = false;
+    bool axes = false;
+
+    memset(move, 0, sizeof(xioBinaryMove_t));
+    for (char *p = line; *p != NUL; ) {
+        char letter = toupper(*p++);
+        if ((letter == SPC) || (letter == TAB)) {
+            continue;
+        }
+        float value;
+        int32_t value_int;
+        char *end = atonum(p, &value, &value_int, false);
+        if (end == p) {
+            return (false);                         // not a word
+        }
+        p = end;
+
+        const char *axis = strchr(axis_letters, letter);
+        if (axis != NULL) {
+            uint8_t a = axis - axis_letters;
+            if ((a >= AXES) || move->flags[a]) {    // not an axis of this build, or a repeat
+                return (false);
+            }
+            move->flags[a] = true;
+            move->target[a] = value;
+            axes = true;
+        } else if ((letter == 'G') && !gword && (value == value_int) && ((value_int == 0) || (value_int == 1))) {
+            motion = (value_int == 0) ? JOB_MOTION_TRAVERSE : JOB_MOTION_FEED;
+            gword = true;
+        } else if ((letter == 'F') && !(move->move_flags & XIO_BINARY_FEED)) {
+            move->feed_rate = value;
+            move->move_flags |= XIO_BINARY_FEED;
+        } else if ((letter == 'N') && !linenum) {
+            move->linenum = value_int;
+            linenum = true;
+        } else {
+            return (false);
+        }
+    }
+    if (!axes || (motion == JOB_MOTION_UNKNOWN)) {
+        return (false);
+    }
+    if (motion == JOB_MOTION_TRAVERSE) {
+        move->move_flags |= XIO_BINARY_TRAVERSE;
+    }
+    if (!linenum) {
+        move->move_flags |= JOB_MOVE_NO_LINENUM;
+    }
+    return (true);
+}
+
+/****************************************************************************************
+ * job_write_line() - store a Gcode line while recording
+ *
+ *  Plain G0 and G1 lines are stored as move records: XIO_BINARY_SYNC, the payload length
+ *  and a binary move channel payload (see xio.h). Other lines are stored as '\n'
+ *  terminated text; Gcode is 7 bit, so text never starts with XIO_BINARY_SYNC.
+ *
+ *  Records are programmed a page at a time. A sector is erased when the first page in it
+ *  is programmed. Sector 0, with the header, was erased when recording started.
+ */
+
+static void _program_page()
+{
+    uint32_t address = JOB_DATA_START + job.length - job.fill;     // always on a page boundary
+    if ((address % JOB_SECTOR_SIZE) == 0) {
+        _store_erase(address / JOB_SECTOR_SIZE);
+    }
+    _store_program(address, job.page, job.fill);
+    job.fill = 0;
+}
+
+static void _write_byte(const uint8_t b)
+{
+    job.page[job.fill++] = b;
+    job.length++;
+    if (job.fill == JOB_PAGE_SIZE) {
+        _program_page();
+    }
+}
+
+stat_t job_write_line(const char *line)
+{
+    uint32_t len = strlen(line);
+    if (len >= JOB_LINE_LEN) {
+        return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
+    }
+    xioBinaryMove_t move;
+    uint8_t record[2 + XIO_BINARY_PAYLOAD_MAX];
+    const uint8_t *bytes = (const uint8_t *)line;
+    uint8_t motion = JOB_MOTION_UNKNOWN;
+
+    strcpy(job.line, line);                         // atonum() wants a writable string
+    if (_tokenize_line(job.line, &move)) {
+        record[0] = XIO_BINARY_SYNC;
+        record[1] = xio_binary_encode(&move, &record[2]);
+        bytes = record;
+        len = record[1] + 2;
+        motion = (move.move_flags & XIO_BINARY_TRAVERSE) ? JOB_MOTION_TRAVERSE : JOB_MOTION_FEED;
+    }
+    uint32_t size = (bytes == record) ? len : len + 1;      // text takes a '\n'
+    if ((JOB_DATA_START + job.length + size) > JOB_STORE_SIZE) {
+        return (STAT_FILE_SIZE_EXCEEDED);
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        _write_byte(bytes[i]);
+    }
+    if (bytes != record) {
+        _write_byte('\n');
+    }
+    job.motion = motion;
+    return (STAT_OK);
+}
+
+/****************************************************************************************
+ * job_callback() - controller continuation that queues the running job's lines
+ * job_abort()    - drop the rest of the running job
+ *
+ *  Move records go straight to cm_straight_traverse() or cm_straight_feed(), as the
+ *  binary move channel does. Text lines go through the Gcode parser.
+ */
+
+static int16_t _read_byte()
+{
+    if (job.offset == job.length) {
+        return (-1);
+    }
+    if (job.index == job.fill) {
+        job.fill = (uint16_t)min((uint32_t)JOB_PAGE_SIZE, job.length - job.offset);
+        _store_read(JOB_DATA_START + job.offset, job.page, job.fill);
+        job.index = 0;
+    }
+    job.offset++;
+    return (job.page[job.index++]);
+}
+
+static stat_t _run_move(const xioBinaryMove_t *move)
+{
+    jr_count_line();
+    if (!(move->move_flags & JOB_MOVE_NO_LINENUM)) {
+        cm_set_model_linenum(move->linenum);
+    }
+    if (move->move_flags & XIO_BINARY_FEED) {
+        ritorno(cm_set_feed_rate(move->feed_rate));
+    }
+    if (move->move_flags & XIO_BINARY_TRAVERSE) {
+        return (cm_straight_traverse(move->target, move->flags, PROFILE_NORMAL));
+    }
+    return (cm_straight_feed(move->target, move->flags, PROFILE_NORMAL));
+}
+
+stat_t job_callback()
+{
+    if (job.state != JOB_RUNNING) {
+        return (STAT_NOOP);
+    }
+    if (cm_is_alarmed() != STAT_OK) {
+        job_abort();
+        return (STAT_NOOP);
+    }
+    if (mp_planner_is_full(mp)) {
+        return (STAT_EAGAIN);
+    }
+
+    stat_t status;
+    int16_t c = _read_byte();
+    if (c == XIO_BINARY_SYNC) {                     // move record
+        xioBinaryMove_t move;
+        uint8_t len = (uint8_t)_read_byte();
+        for (uint8_t i = 0; (i < len) && (i < XIO_BINARY_PAYLOAD_MAX); i++) {
+            job.line[i] = (char)_read_byte();
+        }
+        if ((len <= XIO_BINARY_PAYLOAD_MAX) && xio_binary_decode((const uint8_t *)job.line, len, &move)) {
+            status = _run_move(&move);
+        } else {
+            status = STAT_INTERNAL_ERROR;           // the store is damaged
+        }
+    } else {                                        // text line - stored lines always fit
+        uint16_t len = 0;
+        while ((c >= 0) && (c != '\n') && (len < JOB_LINE_LEN - 1)) {
+            job.line[len++] = (char)c;
+            c = _read_byte();
+        }
+        job.line[len] = NUL;
+        status = gcode_parser(job.line);
+    }
+    if ((status != STAT_OK) && (status != STAT_NOOP)) {
+        rpt_exception(status, "job line");
+        job_abort();
+        return (STAT_OK);
+    }
+    if (job.offset == job.length) {                 // last line is queued
+        job.state = JOB_IDLE;
+        return (STAT_OK);
+    }
+    return (STAT_EAGAIN);
+}
+
+void job_abort()
+{
+    if (job.state == JOB_RUNNING) {
+        job.state = JOB_IDLE;
+    }
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * job_set_state() - record, end, run or stop a job (jobState)
+ * jb_get_job()    - return the job state
+ * jb_set_job()    - record, end, run or stop a job    {job:3}
+ * jb_get_jobl()   - return the size of the stored job in bytes, 0 if none
+ */
+
+stat_t job_set_state(const uint8_t state)
+{
+    switch (state) {
+        case JOB_IDLE: {
+            if (job.state == JOB_RECORDING) {           // the header was erased at the start
+                job.length = 0;
+            }
+            job.state = JOB_IDLE;
+            return (STAT_OK);
+        }
+        case JOB_RECORDING: {
+            if (job.state == JOB_RUNNING) {
+                return (STAT_COMMAND_NOT_ACCEPTED);
+            }
+            if (!job.open) {
+                return (STAT_FILE_NOT_OPEN);
+            }
+            _store_erase(0);
+            job.length = 0;
+            job.fill = 0;
+            job.motion = JOB_MOTION_UNKNOWN;
+            job.state = JOB_RECORDING;
+            return (STAT_OK);
+        }
+        case JOB_END: {
+            if (job.state != JOB_RECORDING) {
+                return (STAT_COMMAND_NOT_ACCEPTED);
+            }
+            if (job.fill != 0) {
+                _program_page();
+            }
+            jobHeader_t h = { JOB_MAGIC, job.length, ~job.length };
+            _store_program(0, &h, sizeof(h));
+            job.state = JOB_IDLE;
+            return (STAT_OK);
+        }
+        case JOB_RUNNING: {
+            if ((job.state != JOB_IDLE) || (job.length == 0)) {
+                return (STAT_COMMAND_NOT_ACCEPTED);
+            }
+            job.offset = 0;
+            job.fill = 0;
+            job.index = 0;
+            job.state = JOB_RUNNING;
+            jr_reset_job_report();                      // the job progress report follows the job
+            return (STAT_OK);
+        }
+        default: {
+            return (STAT_INPUT_VALUE_RANGE_ERROR);
+        }
+    }
+}
+
+stat_t jb_get_job(nvObj_t *nv)
+{
+    nv->value_int = job.state;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t jb_set_job(nvObj_t *nv) { return (job_set_state((uint8_t)nv->value_int)); }
+
+stat_t jb_get_jobl(nvObj_t *nv)
+{
+    nv->value_int = (job.state == JOB_RECORDING) ? 0 : job.length;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_job[]  = "[job]  job state%18d\n";
+static const char fmt_jobl[] = "[jobl] stored job bytes%12d\n";
+
+void jb_print_job(nvObj_t *nv) { text_print(nv, fmt_job); }     // TYPE_INT
+void jb_print_jobl(nvObj_t *nv) { text_print(nv, fmt_jobl); }   // TYPE_INT
+
+#endif // __TEXT_MODE
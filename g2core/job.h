@@ -0,0 +1,117 @@
+/*
+ * job.h - Gcode jobs stored on the board and run from there
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * JOB STORE
+ *
+ *  A job is a Gcode program sent to the board once, kept in the job store and then run
+ *  from there with no host in the loop. Recording only writes the store, so the upload
+ *  goes as fast as the link allows; playback feeds the planner as fast as it takes lines,
+ *  whatever the host and the link are doing.
+ *
+ *      {job:1}         start recording - drops the stored job
+ *      G0 X10 ...      Gcode lines are stored instead of run, and acknowledged as usual
+ *      {job:2}         end recording - the job is kept from here on
+ *      {job:3}         run the stored job
+ *      {job:0}         stop recording or running
+ *
+ *  JSON and $ lines still run while recording, so the host can watch and end the upload.
+ *  Reading {job:} returns the state (0 idle, 1 recording, 3 running) and {jobl:} the size
+ *  of the stored job in bytes, 0 if there is none. A recording that is stopped or cut off
+ *  by a reset before {job:2} leaves no job.
+ *
+ *  A job runs like a stored macro (see macro.h): job_callback() parses one line per pass
+ *  while the planner has room and holds host Gcode back until the last line is queued.
+ *  Control and JSON lines from the host are still read, so feedhold, status and {job:0}
+ *  work during a job. The job stops on a parse error, an alarm or a queue flush.
+ *
+ *  Plain G0 and G1 lines are tokenized as they are recorded and stored as binary move
+ *  records, which run without going through the Gcode parser; everything else is stored
+ *  as text. Long runs of short moves then queue at the rate the planner takes them,
+ *  not the rate they can be parsed.
+ *
+ *  The store is programmed a page at a time and each sector is erased as recording first
+ *  reaches it, as on serial NOR flash. The job header in the first page is written last.
+ *  Only the simulators have a backend (a file image). Boards with SPI flash or an SD card
+ *  would supply the store functions in job.cpp from their SPI driver.
+ */
+
+#ifndef JOB_H_ONCE
+#define JOB_H_ONCE
+
+#include "config.h"
+
+#ifndef JOB_FILE
+#define JOB_FILE "g2core.job"       // job store image used by the simulators
+#endif
+#ifndef JOB_STORE_SIZE
+#define JOB_STORE_SIZE (1024UL * 1024UL) // bytes of storage, header page included. boards can override this value in hardware.h
+#endif
+#ifndef JOB_SECTOR_SIZE
+#define JOB_SECTOR_SIZE 4096        // erase unit. boards can override this value in hardware.h
+#endif
+#ifndef JOB_PAGE_SIZE
+#define JOB_PAGE_SIZE 256           // program unit - must divide JOB_SECTOR_SIZE. boards can override this value in hardware.h
+#endif
+#ifndef JOB_LINE_LEN
+#define JOB_LINE_LEN 128            // longest stored line, including the terminator
+#endif
+
+typedef enum {
+    JOB_IDLE = 0,                   // {job:0} - stop
+    JOB_RECORDING,                  // {job:1} - storing Gcode lines
+    JOB_END,                        // {job:2} - end recording (command only)
+    JOB_RUNNING                     // {job:3} - running the stored job
+} jobState;
+
+/**** Function Prototypes ****/
+
+void job_init(void);
+stat_t job_set_state(const uint8_t state);
+stat_t job_write_line(const char *line);
+stat_t job_callback(void);
+void job_abort(void);
+bool job_recording(void);
+bool job_running(void);
+void job_progress(uint32_t *run, uint32_t *left);
+
+stat_t jb_get_job(nvObj_t *nv);
+stat_t jb_set_job(nvObj_t *nv);
+stat_t jb_get_jobl(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void jb_print_job(nvObj_t *nv);
+void jb_print_jobl(nvObj_t *nv);
+
+#else
+
+#define jb_print_job tx_print_stub
+#define jb_print_jobl tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: JOB_H_ONCE
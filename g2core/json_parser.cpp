@@ -32,6 +32,7 @@
 #include "json_parser.h"
 #include "text_parser.h"
 #include "canonical_machine.h"
+#include "gcode_parser.h"
 #include "report.h"
 #include "util.h"
 #include "xio.h"
@@ -44,14 +45,14 @@ jsSingleton_t js;
 
 static stat_t _json_parser_kernal(nvObj_t *nv, char *str);
 static stat_t _json_parser_execute(nvObj_t *nv);
-static stat_t _normalize_json_string(char *str, uint16_t size);
 static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
+static char *_compact_string(char *str);
+static bool _json_gcode_fast(char *str, stat_t *status);
 
 /****************************************************************************
  * json_parser() - exposed part of JSON parser
  * _json_parser_kernal()
- * _normalize_json_string()
- * _get_nv_pair_strict()
+ * _get_nv_pair()
  *
  *  This is a dumbed down JSON parser to fit in limited memory with no malloc
  *  or practical way to do recursion ("depth" tracks parent/child levels).
@@ -80,6 +81,7 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
  *
  *  Separation of concerns
  *    json_parser() is the only exposed part. It does parsing, display, and status reports.
+ *    _json_gcode_fast() takes a lone {"gc":"..."} line straight to the gcode parser
  *    _get_nv_pair() only does parsing and syntax; no semantic validation or group handling
  *    _json_parser_kernal() does index validation and group handling
  *    _json_parser_execute() executes sets and gets in an application agnostic way. It should work for other apps than g2core
@@ -87,11 +89,14 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
 
 stat_t json_parser(char *str, bool suppress_response) // suppress_response defaults to false, see decalaration in .h
 {
-    nvObj_t *nv = nv_reset_nv_list();               // get a fresh nvObj list
-    stat_t status = _json_parser_kernal(nv, str);
-    if (status == STAT_OK) {                        // execute the command
-        nv = nv_body;
-        status = _json_parser_execute(nv);
+    stat_t status;
+    if (!_json_gcode_fast(str, &status)) {
+        nvObj_t *nv = nv_reset_nv_list();           // get a fresh nvObj list
+        status = _json_parser_kernal(nv, str);
+        if (status == STAT_OK) {                    // execute the command
+            nv = nv_body;
+            status = _json_parser_execute(nv);
+        }
     }
     if (suppress_response || (status == STAT_COMPLETE)) {  // skip the print if returning from something that already did it.
         return status;
@@ -140,6 +145,57 @@ static stat_t _json_parser_execute(nvObj_t *nv) {
     return (STAT_OK);                               // only successful commands exit through this point
 }
 
+/*
+ * _json_gcode_fast() - run a {"gc":"..."} line without the general parser
+ *
+ *  Hosts send most gcode as one wrapped block per line. When the line is exactly that
+ *  shape - the gc name with or without quotes, one string value and the closing curly -
+ *  the block is compacted in place the same way _get_nv_pair() would and passed to the
+ *  gcode parser as _json_parser_execute() would, with no token lookup and no copy into
+ *  the shared string. The response list still gets its header and the gc object, since
+ *  the gcode side can add line numbers and messages to it and the response echoes it.
+ *
+ *  Returns false, with nothing consumed, if the line needs the general parser.
+ */
+
+static bool _json_gcode_fast(char *str, stat_t *status)
+{
+    char *block;
+    if (strncmp(str, "{\"gc\":\"", 7) == 0) {
+        block = str + 7;
+    } else if (strncmp(str, "{gc:\"", 5) == 0) {
+        block = str + 5;
+    } else {
+        return (false);
+    }
+    char *end = strchr(block, '\"');              // gcode can't contain a quote, so this ends the value
+    if ((end == NULL) || ((end - str) > JSON_INPUT_STRING_MAX)) {
+        return (false);
+    }
+    char *tail = end + 1;
+    if (*tail++ != '}') {
+        return (false);
+    }
+    while ((*tail != NUL) && ((*tail <= ' ') || (*tail == DEL))) {
+        tail++;
+    }
+    if ((*tail != NUL) || ((block[0] == '0') && (tolower(block[1]) == 'x'))) { // more to parse, or data not gcode
+        return (false);
+    }
+
+    _compact_string(block);
+    nvObj_t *nv = nv_reset_nv_list();
+    nv->valuetype = TYPE_STRING;                    // nv_body - the only object the general parser would add
+    strcpy(nv->token, "gc");
+    nv->stringp = (char (*)[])block;                // the input buffer outlives the response
+
+    cm_parse_clear(block);                          // parse Gcode and clear alarms if M30 or M2 is found
+    if ((*status = cm_is_alarmed()) == STAT_OK) {   // same order as _json_parser_execute()
+        *status = gcode_parser(block);
+    }
+    return (true);
+}
+
 // (*) Note: The JSON / token system is essentially flat, as it was derived from a command-line flat-ASCII approach
 //     If the JSON objects had proper recursive descent handlers that just passed the remaining string (at that level) 
 //     off for further processing, we would not need to do this hack. A fix is in the works. For now, this is OK.
@@ -149,16 +205,15 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
     stat_t status;
     int8_t depth;
     char group[GROUP_LEN+1] = {""};                 // group identifier - starts as NUL
+    char *start = str;
     int8_t i = NV_BODY_LEN;
 
-    status = _normalize_json_string(str, JSON_INPUT_STRING_MAX);
-    if (status != STAT_OK) {
-        nv->valuetype = TYPE_NULL;
-        return (status);
-    }
-
-    // parse the JSON command into the nv body
+    // parse the JSON command into the nv body in a single pass over the raw input
     do {
+        if ((str - start) > JSON_INPUT_STRING_MAX) {
+            nv->valuetype = TYPE_NULL;
+            return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
+        }
         if (--i == 0) {
             return (STAT_JSON_TOO_MANY_PAIRS);      // length error
         }
@@ -190,21 +245,34 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
 }
 
 /*
- * _normalize_json_string - normalize a JSON string in place
+ * _json_skip() - advance past whitespace, control characters and DEL; return the next character
+ */
+
+static inline char _json_skip(char **pstr)
+{
+    while ((**pstr != NUL) && ((**pstr <= ' ') || (**pstr == DEL))) {
+        (*pstr)++;
+    }
+    return (**pstr);
+}
+
+/*
+ * _compact_string() - compact a string value in place up to its closing quote
  *
- *  Validate string size limits, remove all whitespace and convert
- *  to lower case, with the exception of gcode comments
+ *  Removes whitespace, ctrls and DEL and lowercases, except inside gcode comments.
+ *  NUL terminates the compacted value and returns a pointer to the closing quote, or
+ *  NULL if the input ends first.
  */
 
-static stat_t _normalize_json_string(char *str, uint16_t size)
+static char *_compact_string(char *str)
 {
-    char *wr;                                       // write pointer
-    uint8_t in_comment = false;
+    char *wr = str;                                 // write pointer trails the read pointer
+    bool in_comment = false;
 
-    if (strlen(str) > size) {
-        return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
-    }
-    for (wr = str; *str != NUL; str++) {
+    for (; *str != '\"'; str++) {
+        if (*str == NUL) {
+            return (NULL);
+        }
         if (!in_comment) {                          // normal processing
             if (*str == '(') in_comment = true;
             if ((*str <= ' ') || (*str == DEL)) continue; // toss ctrls, WS & DEL
@@ -214,8 +282,8 @@ static stat_t _normalize_json_string(char *str, uint16_t size)
             *wr++ = *str;
         }
     }
-    *wr = NUL;
-    return (STAT_OK);
+    *wr = NUL;                                      // may overwrite the quote if nothing was removed
+    return (str);
 }
 
 /*
@@ -231,7 +299,10 @@ static stat_t _normalize_json_string(char *str, uint16_t size)
  *  If this were to be extended to track multiple parents or more than two
  *  levels deep it would have to track closing curlies - which it does not.
  *
- *  ASSUMES INPUT STRING HAS FIRST BEEN NORMALIZED BY _normalize_json_string()
+ *  Works on the raw input in one pass. Whitespace between elements is skipped as it
+ *  is met, names are lowercased as they are copied into the token, and string values
+ *  are compacted in place - whitespace and ctrls removed and lowercased, except inside
+ *  gcode comments - so they read the same as they did after the old normalization pass.
  *
  *  If a group prefix is passed in it will be pre-pended to any name parsed
  *  to form a token string. For example, if "x" is provided as a group and
@@ -249,82 +320,89 @@ static stat_t _normalize_json_string(char *str, uint16_t size)
 static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
 {
     uint8_t i;
+    char c;
     char *tmp;
     char leaders[] = {"{,\""};      // open curly, quote and leading comma
-    char separators[] = {":\""};    // colon and quote
     char terminators[] = {"},\""};  // close curly, comma and quote
     char value[] = {"{\".-+"};      // open curly, quote, period, minus and plus
 
     nv_reset_nv(nv);                // wipes the object and sets the depth
 
     // --- Process name part ---
-    // Find, terminate and set pointers for the name. Allow for leading and trailing name quotes.
-    char * name = *pstr;
+    // Skip leading characters. Allow for leading and trailing name quotes.
     for (i=0; true; i++, (*pstr)++) {
-        if (strchr(leaders, (int)**pstr) == NULL) {     // find leading character of name
-            name = (*pstr)++;
+        c = _json_skip(pstr);
+        if ((c != NUL) && (strchr(leaders, (int)c) == NULL)) { // find leading character of name
             break;
         }
-        if (i == MAX_PAD_CHARS) {
+        if ((c == NUL) || (i == MAX_PAD_CHARS)) {
             return (STAT_JSON_SYNTAX_ERROR);
         }
     }
 
-    // Find the end of name, NUL terminate and copy token
-    for (i=0; true; i++, (*pstr)++) {
-        if (strchr(separators, (int)**pstr) != NULL) {
-            *(*pstr)++ = NUL;
-            strncpy(nv->token, name, TOKEN_LEN+1);      // copy the string to the token
+    // Copy the name into the token up to the separator, folding case on the way
+    for (i=0; true; (*pstr)++) {
+        c = **pstr;
+        if ((c == ':') || (c == '\"')) {
+            (*pstr)++;
             break;
         }
+        if (c == NUL) {
+            return (STAT_JSON_SYNTAX_ERROR);
+        }
+        if ((c <= ' ') || (c == DEL)) {
+            continue;
+        }
         if (i == TOKEN_LEN) {
             return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
         }
+        nv->token[i++] = tolower(c);
     }
+    nv->token[i] = NUL;
 
     // --- Process value part ---  (organized from most to least frequently encountered)
 
     // Find the start of the value part
     for (i=0; true; i++, (*pstr)++) {
-        if (isalnum((int)**pstr)) break;
-        if (strchr(value, (int)**pstr) != NULL) break;
-        if (i == MAX_PAD_CHARS) {
+        c = tolower(_json_skip(pstr));
+        if (isalnum((int)c)) break;
+        if ((c != NUL) && (strchr(value, (int)c) != NULL)) break;
+        if ((c == NUL) || (i == MAX_PAD_CHARS)) {
             return (STAT_JSON_SYNTAX_ERROR);
         }
     }
 
     // nulls (gets)
-    if ((**pstr == 'n') || ((**pstr == '\"') && (*(*pstr+1) == '\"'))) { // process null value
+    if ((c == 'n') || ((c == '\"') && (*(*pstr+1) == '\"'))) { // process null value
         nv->valuetype = TYPE_NULL;
         nv->value_int = TYPE_NULL;
 
     // numbers
-    } else if (isdigit(**pstr) || (**pstr == '-')) {    // value is a number
-        nv->value_int = atol(*pstr);                    // get the number as an integer
-        nv->value_flt = (float)strtod(*pstr, &tmp);     // get the number as a float - tmp is the end pointer
+    } else if (isdigit(c) || (c == '-')) {              // value is a number
+        tmp = atonum(*pstr, &nv->value_flt, &nv->value_int, true); // get float and integer - tmp is the end pointer
 
         if ((tmp == *pstr) ||                           // if start pointer equals end the conversion failed
-            (strchr(terminators, *tmp) == NULL)) {      // terminators are the only legal chars at the end of a number
+            (strchr(terminators, _json_skip(&tmp)) == NULL)) { // terminators are the only legal chars at the end of a number
             nv->valuetype = TYPE_NULL;                  // report back an error
             return (STAT_BAD_NUMBER_FORMAT);
         }
+        *pstr = tmp;
         nv->valuetype = TYPE_FLOAT;
 
     // object parent
-    } else if (**pstr == '{') {
+    } else if (c == '{') {
         nv->valuetype = TYPE_PARENT;
 //        *depth += 1;                                  // nv_reset_nv() sets the next object's level so this is redundant
         (*pstr)++;
         return(STAT_EAGAIN);                            // signal that there is more to parse
 
     // strings
-    } else if (**pstr == '\"') {                        // value is a string
+    } else if (c == '\"') {                             // value is a string
         (*pstr)++;
         nv->valuetype = TYPE_STRING;
-        if ((tmp = strchr(*pstr, '\"')) == NULL) {
+        if ((tmp = _compact_string(*pstr)) == NULL) {
             return (STAT_JSON_SYNTAX_ERROR);            // find the end of the string
         }
-        *tmp = NUL;
 
         // if string begins with 0x it might be data, needs to be at least 3 chars long
         if( strlen(*pstr)>=3 && (*pstr)[0]=='0' && (*pstr)[1]=='x')
@@ -338,15 +416,15 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
         *pstr = ++tmp;
 
     // boolean true/false
-    } else if (**pstr == 't') {
+    } else if (c == 't') {
         nv->valuetype = TYPE_BOOLEAN;
         nv->value_int = true;
-    } else if (**pstr == 'f') {
+    } else if (c == 'f') {
         nv->valuetype = TYPE_BOOLEAN;
         nv->value_int = false;
 
     // arrays
-    } else if (**pstr == '[') {
+    } else if (c == '[') {
         nv->valuetype = TYPE_ARRAY;
         ritorno(nv_copy_string(nv, *pstr));     // copy array into string for error displays
         return (STAT_VALUE_TYPE_ERROR);         // return error as the parser doesn't do input arrays yet
@@ -364,10 +442,12 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
         *depth -= 1;                            // pop up a nesting level
         (*pstr)++;                              // advance to comma or whatever follows
     }
-    if (**pstr == ',') {
+    if (_json_skip(pstr) == ',') {
         return (STAT_EAGAIN);                   // signal that there is more to parse
     }
-    (*pstr)++;
+    if (**pstr != NUL) {
+        (*pstr)++;
+    }
     return (STAT_OK);                           // signal that parsing is complete
 }
 
@@ -403,7 +483,7 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
  *    - If a JSON object is empty omit the object altogether (no curlies)
  */
 
-uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
+int16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
 {
     char *str = out_buf;
     char *str_max = out_buf + size;
@@ -500,8 +580,10 @@ uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
  */
 void json_print_object(nvObj_t *nv)
 {
-    json_serialize(nv, cs.out_buf, sizeof(cs.out_buf));
-    xio_writeline(cs.out_buf);
+    int16_t len = json_serialize(nv, cs.out_buf, sizeof(cs.out_buf));
+    if (len > 0) {
+        xio_write(cs.out_buf, len);             // length is known - skip writeline's rescan
+    }
 }
 
 /*
@@ -519,6 +601,49 @@ void json_print_list(stat_t status, uint8_t flags)
     }
 }
 
+/*
+ * _json_print_ack() - print a response with an empty body, or only a line number, from a template
+ *
+ *  Most streamed gcode lines are answered with {"r":{},"f":[1,0,n]}, or {"r":{"n":123},"f":[...]}
+ *  when line numbers are echoed. The fixed text is copied and only the line number, status and
+ *  byte count are formatted. Returns false, writing nothing, if the body holds anything else.
+ */
+
+static bool _json_print_ack(nvObj_t *nv, uint8_t status, const bool only_to_muted)
+{
+    static const char head[] = "{\"r\":{";
+    static const char line[] = "\"n\":";
+    static const char foot[] = "},\"f\":[1,";
+    nvObj_t *linenum = NULL;
+
+    for ( ; (nv != NULL) && ((nv->valuetype != TYPE_EMPTY) || (nv->token[0] != NUL)); nv = nv->nx) {
+        if (nv->valuetype == TYPE_EMPTY) {
+            continue;                                       // suppressed echo
+        }
+        if ((linenum != NULL) || (nv->valuetype != TYPE_INTEGER) || (nv->value_int < 0) ||
+            (nv_get_type(nv) != NV_TYPE_LINENUM)) {
+            return (false);
+        }
+        linenum = nv;
+    }
+    char *str = cs.out_buf;
+    memcpy(str, head, sizeof(head)-1); str += sizeof(head)-1;
+    if (linenum != NULL) {
+        memcpy(str, line, sizeof(line)-1); str += sizeof(line)-1;
+        str += inttoa(str, linenum->value_int);
+    }
+    memcpy(str, foot, sizeof(foot)-1); str += sizeof(foot)-1;
+    str += inttoa(str, status);
+    *str++ = ',';
+    str += inttoa(str, cs.linelen+1);
+    cs.linelen = 0;                                         // reset linelen so it's only reported once
+    memcpy(str, "]}\n", 4); str += 3;
+    xioLane lane = xio_set_lane(XIO_LANE_ACK);
+    xio_write(cs.out_buf, str - cs.out_buf, only_to_muted);
+    xio_set_lane(lane);
+    return (true);
+}
+
 /*
  * json_print_response() - JSON responses with headers, footers and observing JSON verbosity
  *
@@ -589,6 +714,9 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     if (nv == NULL) {                                       // this can happen when processing a stale list
         return;                                             //...that already has a null-terminated footer
     }
+    if (_json_print_ack(nv_body, status, only_to_muted)) {  // common acks skip the footer object and serializer
+        return;
+    }
     while(nv->valuetype != TYPE_EMPTY) {                    // find a free nvObj at end of the list...
         if ((nv = nv->nx) == NULL) {                        // oops! No free nvObj!
             rpt_exception(STAT_JSON_OUTPUT_TOO_LONG, "json_print_response() json too long"); // report this as an exception
@@ -617,8 +745,11 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     nv->nx = NULL;                                          // terminate the list
 
     // serialize the JSON response and print it if there were no errors
-    if (json_serialize(nv_header, cs.out_buf, sizeof(cs.out_buf)) >= 0) {
-        xio_writeline(cs.out_buf, only_to_muted);
+    int16_t len = json_serialize(nv_header, cs.out_buf, sizeof(cs.out_buf));
+    if (len > 0) {
+        xioLane lane = xio_set_lane(XIO_LANE_ACK);  // the host paces its sends on the response
+        xio_write(cs.out_buf, len, only_to_muted);
+        xio_set_lane(lane);
     }
 }
 
@@ -84,7 +84,7 @@ extern jsSingleton_t js;
 
 stat_t json_parser(char *str, bool suppress_response = false);
 void json_parse_for_exec(char *str, bool execute);
-uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size);
+int16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size);
 void json_print_object(nvObj_t *nv);
 void json_print_response(uint8_t status, const bool only_to_muted = false);
 void json_print_list(stat_t status, uint8_t flags);
@@ -29,100 +29,166 @@
 #include "g2core.h"
 #include "config.h"
 #include "canonical_machine.h"
+#include "planner.h"
 #include "stepper.h"
 #include "kinematics.h"
+#include "profile.h"
+#include "thc.h"
+#include "text_parser.h"
 #include "util.h"
 
-static void _inverse_kinematics(const float travel[], float joint[]);
+static void _cartesian_inverse(const float travel[], float joint[]);
+static void _cartesian_forward(const float joint[], float travel[]);
+static void _corexy_inverse(const float travel[], float joint[]);
+static void _corexy_forward(const float joint[], float travel[]);
+static void _delta_inverse(const float travel[], float joint[]);
+static void _delta_forward(const float joint[], float travel[]);
+static void _rtcp_inverse(const float travel[], float joint[]);
+static void _rtcp_forward(const float joint[], float travel[]);
+static float _mesh_offset(const float travel[]);
+
+static const kinKinematics_t kinematics[KIN_TYPE_MAX] = {   // indexed by kinType
+    { _cartesian_inverse, _cartesian_forward },
+    { _corexy_inverse,    _corexy_forward },
+    { _delta_inverse,     _delta_forward },
+    { _rtcp_inverse,      _rtcp_forward }
+};
+
+/**** Allocate Structures ****/
+
+kinSingleton_t kn = {                                   // usable before kinematics_init()
+    KIN_CARTESIAN, &kinematics[KIN_CARTESIAN],
+    0, 0, 0,                                            // delta_radius, delta_rod, rtcp_pivot
+    {}, 0, 0,                                           // delta_tower, delta_rod2, delta_home
+    {}, {},                                             // motor_axis, steps_per_unit
+    false, false, 0, {}, {}, 0, 0, {}, {}               // mesh
+};
+
+/*
+ * kinematics_init() - select the default transform and build the motor table
+ *
+ *  Config settings loaded later call kn_config_changed() to keep the table current.
+ */
+
+void kinematics_init()
+{
+    kn.type = KINEMATICS;
+    kn.delta_radius = KINEMATICS_DELTA_RADIUS;
+    kn.delta_rod = KINEMATICS_DELTA_ROD;
+    kn.rtcp_pivot = KINEMATICS_RTCP_PIVOT;
+    kn.mesh_enable = MESH_ENABLE;
+    kn.mesh_points = MESH_POINTS;
+    kn.mesh_origin[0] = MESH_ORIGIN_X;
+    kn.mesh_origin[1] = MESH_ORIGIN_Y;
+    kn.mesh_size[0] = MESH_SIZE_X;
+    kn.mesh_size[1] = MESH_SIZE_Y;
+    kn.mesh_probe_z = MESH_PROBE_Z;
+    kn.mesh_clear_z = MESH_CLEARANCE_Z;
+    kn_config_changed();
+}
+
+/*
+ * kn_config_changed() - rebuild derived geometry and the motor->joint table
+ *
+ *  Call this after changing motor mapping, steps per unit, axis mode or kinematics settings.
+ *  Motors that are unmapped or mapped to an inhibited axis get -1 and are not updated.
+ */
+
+void kn_config_changed()
+{
+    kn.k = &kinematics[kn.type];
+
+    for (uint8_t tower = 0; tower < 3; tower++) {       // towers A, B, C at 210, 330 and 90 degrees
+        float angle = (210 + 120 * tower) * (M_PI / 180);
+        kn.delta_tower[tower][0] = kn.delta_radius * cos(angle);
+        kn.delta_tower[tower][1] = kn.delta_radius * sin(angle);
+    }
+    kn.delta_rod2 = kn.delta_rod * kn.delta_rod;
+    kn.delta_home = sqrt(max((float)0, kn.delta_rod2 - kn.delta_radius * kn.delta_radius));
+
+    for (uint8_t n = 0; n < 2; n++) {
+        kn.mesh_step_inv[n] = (kn.mesh_points - 1) / kn.mesh_size[n];
+    }
+
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        uint8_t axis = st_cfg.mot[motor].motor_map;
+        if ((axis >= AXES) || (cm->a[axis].axis_mode == AXIS_INHIBITED)) {
+            kn.motor_axis[motor] = -1;
+        } else {
+            kn.motor_axis[motor] = axis;
+        }
+        kn.steps_per_unit[motor] = st_cfg.mot[motor].steps_per_unit;
+    }
+}
 
 /*
- * kn_kinematics() - ˶ѧİװ
+ * kn_inverse_kinematics() - ˶ѧİװ
  *
- *	Calls kinematics function(s).
- *	Performs axis mapping & conversion of length units to steps (and deals with inhibited axes)
+ *	Calls the selected kinematics transform, then maps joints to motors and converts
+ *	length units to steps using the table built by kn_config_changed().
  *
  *	The reason steps are returned as floats (as opposed to, say, uint32_t) is to accommodate
  *	fractional DDA steps. The DDA deals with fractional step values as fixed-point binary in
  *	order to get the smoothest possible operation. Steps are passed to the move prep routine
  *	as floats and converted to fixed-point binary during queue loading. See stepper.c for details.
+ *
+ *	This is run once per interpolation segment during the _exec() portion of the cycle,
+ *	so the transform needs to fit well inside the segment time. Its cost is profiled as
+ *	PROF_KINEMATICS.
  */
 
 void kn_inverse_kinematics(const float travel[], float steps[]) {
+    PROFILE_CALL(PROF_KINEMATICS);
     float joint[AXES];
+    float z_offset = thc.z_offset;
 
-    _inverse_kinematics(travel, joint);  // insert inverse kinematics transformations here
-
-// We'll time-test each and see if unrolling is worth it.
-#if 0
-    // Map motors to axes and convert length units to steps
-    // Most of the conversion math has already been done in during config in steps_per_unit()
-    // which takes axis travel, step angle and microsteps into account.
-    for (uint8_t axis=0; axis<AXES; axis++) {
-        if (cm->a[axis].axis_mode == AXIS_INHIBITED) { joint[axis] = 0;}
-        if (st_cfg.mot[MOTOR_1].motor_map == axis) {
-            steps[MOTOR_1] = joint[axis] * st_cfg.mot[MOTOR_1].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_2].motor_map == axis) {
-            steps[MOTOR_2] = joint[axis] * st_cfg.mot[MOTOR_2].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_3].motor_map == axis) {
-            steps[MOTOR_3] = joint[axis] * st_cfg.mot[MOTOR_3].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_4].motor_map == axis) {
-            steps[MOTOR_4] = joint[axis] * st_cfg.mot[MOTOR_4].steps_per_unit;
-        }
-#if (MOTORS >= 5)
-        if (st_cfg.mot[MOTOR_5].motor_map == axis) {
-            steps[MOTOR_5] = joint[axis] * st_cfg.mot[MOTOR_5].steps_per_unit;
-        }
-#endif
-#if (MOTORS >= 6)
-        if (st_cfg.mot[MOTOR_6].motor_map == axis) {
-            steps[MOTOR_6] = joint[axis] * st_cfg.mot[MOTOR_6].steps_per_unit;
-        }
-#endif
+    if (kn.mesh_enable && kn.mesh_valid) {
+        z_offset += _mesh_offset(travel);
+    }
+    if (z_offset != 0) {
+        float compensated[AXES];
+        copy_vector(compensated, travel);
+        compensated[AXIS_Z] += z_offset;
+        kn.k->inverse(compensated, joint);
+    } else {
+        kn.k->inverse(travel, joint);
     }
 
-#else
-
-    for (uint8_t axis = 0; axis < AXES; axis++) {
-        if (cm->a[axis].axis_mode == AXIS_INHIBITED) {
-            joint[axis] = 0;
-            continue;
-        }
-        for (uint8_t motor = 0; motor < MOTORS; motor++) {
-            if (st_cfg.mot[motor].motor_map == axis) {
-                steps[motor] = joint[axis] * st_cfg.mot[motor].steps_per_unit;
-            }
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        if (kn.motor_axis[motor] >= 0) {
+            steps[motor] = joint[kn.motor_axis[motor]] * kn.steps_per_unit[motor];
         }
     }
-#endif
 }
 
 /*
- * _inverse_kinematics() - ˶ѧ - ǵѿ
- *
- *	You can glue in inverse kinematics here, but be aware of time budget constraints.
- *	This function is run during the _exec() portion of the cycle and will therefore
- *	be run once per interpolation segment. The total time for the segment load,
- *	including the inverse kinematics transformation cannot exceed the segment time,
- *	and ideally should be no more than 25-50% of the segment time. Currently segments
- *	run every 1.5 ms, but this might be lowered. To profile this time look at the
- *	time it takes to complete the mp_exec_move() function.
- *
- *	Note: the compiler will  inline trivial functions (like memcpy) so there is no
- *	size or performance penalty for breaking this out
+ * kn_active_motors() - motors that can step in a move on the axes in axis_mask
+ *
+ *	Bit per axis in, bit per motor out. Under Cartesian kinematics a motor moves only
+ *	when its own axis does, plus Z under XY moves when mesh compensation is on and Z
+ *	under every move while torch height control can move it. The
+ *	other transforms couple joints, so every mapped motor is returned for them.
  */
-static void _inverse_kinematics(const float travel[], float joint[]) {
-    memcpy(joint, travel, sizeof(float) * AXES);  // just do a memcpy for Cartesian machines
 
-    //	for (uint8_t i=0; i<AXES; i++) {
-    //		joint[i] = travel[i];
-    //	}
+uint8_t kn_active_motors(const uint16_t axis_mask) {
+    uint16_t axes = axis_mask;
+    if (kn.type != KIN_CARTESIAN) {
+        axes = (1 << AXES) - 1;
+    } else if (thc_active() ||
+               (kn.mesh_enable && kn.mesh_valid && (axes & ((1 << AXIS_X) | (1 << AXIS_Y))))) {
+        axes |= (1 << AXIS_Z);
+    }
+    uint8_t motors = 0;
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        if ((kn.motor_axis[motor] >= 0) && (axes & (1 << kn.motor_axis[motor]))) {
+            motors |= (1 << motor);
+        }
+    }
+    return (motors);
 }
 
 /*
- * kn_forward_kinematics() - forward kinematics for a cartesian machine
+ * kn_forward_kinematics() - forward kinematics from motor steps to axis positions
  *
  * This is designed for PRECISION, not PERFORMANCE!
  *
@@ -131,18 +197,19 @@ static void _inverse_kinematics(const float travel[], float joint[]) {
  */
 
 void kn_forward_kinematics(const float steps[], float travel[]) {
+    float joint[AXES];
     float best_steps_per_unit[AXES];
 
     // Setup
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        travel[axis]              = 0.0;
+        joint[axis]               = 0.0;
         best_steps_per_unit[axis] = -1.0;
     }
 
-    // Scan through each axis then through each motor
+    // Scan through each axis then through each motor to find joint positions
     for (uint8_t axis = 0; axis < AXES; axis++) {
         if (cm->a[axis].axis_mode == AXIS_INHIBITED) {
-            travel[axis] = 0.0;
+            joint[axis] = 0.0;
             continue;
         }
         for (uint8_t motor = 0; motor < MOTORS; motor++) {
@@ -150,12 +217,330 @@ void kn_forward_kinematics(const float steps[], float travel[]) {
                 // If this motor has a better (or the only) resolution, then use this motor's value
                 if (best_steps_per_unit[axis] < st_cfg.mot[motor].steps_per_unit) {
                     best_steps_per_unit[axis] = st_cfg.mot[motor].steps_per_unit;
-                    travel[axis]              = steps[motor] * st_cfg.mot[motor].units_per_step;
+                    joint[axis]               = steps[motor] * st_cfg.mot[motor].units_per_step;
                 } // If a second motor has the same resolution for the same axis average their values
                 else if (fp_EQ(best_steps_per_unit[axis], st_cfg.mot[motor].steps_per_unit)) {
-                    travel[axis] = (travel[axis] + (steps[motor] * st_cfg.mot[motor].units_per_step)) / 2.0;
+                    joint[axis] = (joint[axis] + (steps[motor] * st_cfg.mot[motor].units_per_step)) / 2.0;
                 }
             }
         }
     }
+    kn.k->forward(joint, travel);
+    if (kn.mesh_enable && kn.mesh_valid) {
+        travel[AXIS_Z] -= _mesh_offset(travel);         // compensation depends on XY only
+    }
+    travel[AXIS_Z] -= thc.z_offset;
 }
+
+/*
+ * kn_set_mesh_valid() - mark the stored mesh usable or not
+ *
+ *  If this turns compensation on or off the step counters are re-derived from the
+ *  runtime position (see MESH COMPENSATION in kinematics.h). Call it at rest.
+ */
+
+void kn_set_mesh_valid(bool valid)
+{
+    bool was_active = kn.mesh_enable && kn.mesh_valid;
+    kn.mesh_valid = valid;
+    if (was_active != (kn.mesh_enable && kn.mesh_valid)) {
+        mp_set_steps_to_runtime_position();
+    }
+}
+
+/*
+ * _mesh_offset() - bilinear interpolation of the stored mesh at the travel XY
+ */
+
+static float _mesh_offset(const float travel[])
+{
+    float last = kn.mesh_points - 1;
+    float fx = (travel[AXIS_X] - kn.mesh_origin[0]) * kn.mesh_step_inv[0];
+    float fy = (travel[AXIS_Y] - kn.mesh_origin[1]) * kn.mesh_step_inv[1];
+    fx = min(max(fx, (float)0), last);                  // hold the edge value outside the grid
+    fy = min(max(fy, (float)0), last);
+
+    uint8_t i = min((uint8_t)fx, (uint8_t)(kn.mesh_points - 2));  // cell containing the point
+    uint8_t j = min((uint8_t)fy, (uint8_t)(kn.mesh_points - 2));
+    fx -= i;
+    fy -= j;
+
+    float z0 = kn.mesh_z[j][i]   + (kn.mesh_z[j][i+1]   - kn.mesh_z[j][i])   * fx;
+    float z1 = kn.mesh_z[j+1][i] + (kn.mesh_z[j+1][i+1] - kn.mesh_z[j+1][i]) * fx;
+    return (z0 + (z1 - z0) * fy);
+}
+
+/*
+ * Kinematics transforms
+ *
+ *	_cartesian_ - ˶ѧ - ǵѿ. The compiler inlines the memcpy.
+ *	_corexy_    - X and Y joints are the A and B belts: A = X+Y, B = X-Y
+ *	_delta_     - X, Y, Z joints are carriage heights relative to the home height at X0Y0.
+ *	              Positions outside the rod reach are clamped to the rod length.
+ *	              Forward is a trilateration of the three carriage pivots.
+ *	_rtcp_      - tool tip (XYZ) to pivot (XYZ) for a head with A tilting about X and C
+ *	              rotating about Z. The pivot is rtcp_pivot above the tool tip at A=0.
+ */
+
+static void _cartesian_inverse(const float travel[], float joint[])
+{
+    memcpy(joint, travel, sizeof(float) * AXES);
+}
+
+static void _cartesian_forward(const float joint[], float travel[])
+{
+    memcpy(travel, joint, sizeof(float) * AXES);
+}
+
+static void _corexy_inverse(const float travel[], float joint[])
+{
+    memcpy(joint, travel, sizeof(float) * AXES);
+    joint[AXIS_X] = travel[AXIS_X] + travel[AXIS_Y];
+    joint[AXIS_Y] = travel[AXIS_X] - travel[AXIS_Y];
+}
+
+static void _corexy_forward(const float joint[], float travel[])
+{
+    memcpy(travel, joint, sizeof(float) * AXES);
+    travel[AXIS_X] = (joint[AXIS_X] + joint[AXIS_Y]) * 0.5;
+    travel[AXIS_Y] = (joint[AXIS_X] - joint[AXIS_Y]) * 0.5;
+}
+
+static void _delta_inverse(const float travel[], float joint[])
+{
+    memcpy(joint, travel, sizeof(float) * AXES);
+    for (uint8_t tower = 0; tower < 3; tower++) {
+        float dx = travel[AXIS_X] - kn.delta_tower[tower][0];
+        float dy = travel[AXIS_Y] - kn.delta_tower[tower][1];
+        float reach = kn.delta_rod2 - (dx * dx) - (dy * dy);
+        joint[AXIS_X + tower] = travel[AXIS_Z] + sqrt(max((float)0, reach)) - kn.delta_home;
+    }
+}
+
+static void _delta_forward(const float joint[], float travel[])
+{
+    memcpy(travel, joint, sizeof(float) * AXES);
+
+    float p[3][3];                                      // carriage pivot positions
+    for (uint8_t tower = 0; tower < 3; tower++) {
+        p[tower][0] = kn.delta_tower[tower][0];
+        p[tower][1] = kn.delta_tower[tower][1];
+        p[tower][2] = joint[AXIS_X + tower] + kn.delta_home;
+    }
+    float ex[3], ey[3], ez[3], p31[3];
+    float d = 0, i = 0, j = 0;
+
+    for (uint8_t n = 0; n < 3; n++) {                   // ex = unit vector from tower A to B
+        ex[n] = p[1][n] - p[0][n];
+        d += ex[n] * ex[n];
+    }
+    d = sqrt(d);
+    for (uint8_t n = 0; n < 3; n++) {
+        ex[n] /= d;
+        p31[n] = p[2][n] - p[0][n];
+        i += ex[n] * p31[n];
+    }
+    float ey_len = 0;
+    for (uint8_t n = 0; n < 3; n++) {                   // ey = unit vector toward tower C, normal to ex
+        ey[n] = p31[n] - (i * ex[n]);
+        ey_len += ey[n] * ey[n];
+    }
+    ey_len = sqrt(ey_len);
+    for (uint8_t n = 0; n < 3; n++) {
+        ey[n] /= ey_len;
+        j += ey[n] * p31[n];
+    }
+    ez[0] = ex[1] * ey[2] - ex[2] * ey[1];              // ez = ex x ey
+    ez[1] = ex[2] * ey[0] - ex[0] * ey[2];
+    ez[2] = ex[0] * ey[1] - ex[1] * ey[0];
+
+    float x = d * 0.5;                                  // all rods are the same length
+    float y = ((i * i) + (j * j) - (2 * i * x)) / (2 * j);
+    float z = sqrt(max((float)0, kn.delta_rod2 - (x * x) - (y * y)));
+    if (ez[2] > 0) {                                    // effector hangs below the carriages
+        z = -z;
+    }
+    for (uint8_t n = 0; n < 3; n++) {
+        travel[AXIS_X + n] = p[0][n] + (x * ex[n]) + (y * ey[n]) + (z * ez[n]);
+    }
+}
+
+static void _rtcp_offset(const float travel[], float offset[])
+{
+#if (AXES >= 6)
+    float a = travel[AXIS_A] * (M_PI / 180);
+    float c = travel[AXIS_C] * (M_PI / 180);
+#else
+    float a = 0, c = 0;                                 // not selectable without A and C
+#endif
+    offset[0] = kn.rtcp_pivot * sin(c) * sin(a);
+    offset[1] = -kn.rtcp_pivot * cos(c) * sin(a);
+    offset[2] = kn.rtcp_pivot * (cos(a) - 1);
+}
+
+static void _rtcp_inverse(const float travel[], float joint[])
+{
+    float offset[3];
+    memcpy(joint, travel, sizeof(float) * AXES);
+    _rtcp_offset(travel, offset);
+    for (uint8_t n = 0; n < 3; n++) {
+        joint[AXIS_X + n] += offset[n];
+    }
+}
+
+static void _rtcp_forward(const float joint[], float travel[])
+{
+    float offset[3];
+    memcpy(travel, joint, sizeof(float) * AXES);        // rotary positions are joint positions
+    _rtcp_offset(travel, offset);
+    for (uint8_t n = 0; n < 3; n++) {
+        travel[AXIS_X + n] -= offset[n];
+    }
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * _set_kinematics() - helper to apply a kinematics setting
+ *
+ *  Joint positions change for the same axis positions, so the step counters are
+ *  re-derived from the runtime position. Rejected while the machine is in a cycle.
+ */
+
+static stat_t _set_kinematics(nvObj_t *nv, float &value, float low, float high)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(set_float_range(nv, value, low, high));
+    kn_config_changed();
+    mp_set_steps_to_runtime_position();
+    return (STAT_OK);
+}
+
+stat_t kn_get_kin(nvObj_t *nv) { return (get_integer(nv, kn.type)); }
+stat_t kn_set_kin(nvObj_t *nv)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if ((nv->value_int < 0) || (nv->value_int >= KIN_TYPE_MAX)) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if ((nv->value_int == KIN_RTCP) && !AXIS_ACTIVE(AXIS_C)) {     // needs A and C
+        nv->valuetype = TYPE_NULL;
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    kn.type = (kinType)nv->value_int;
+    kn_config_changed();
+    mp_set_steps_to_runtime_position();
+    return (STAT_OK);
+}
+
+stat_t kn_get_kdr(nvObj_t *nv) { return (get_float(nv, kn.delta_radius)); }
+stat_t kn_set_kdr(nvObj_t *nv) { return (_set_kinematics(nv, kn.delta_radius, 0, 10000)); }
+stat_t kn_get_kdl(nvObj_t *nv) { return (get_float(nv, kn.delta_rod)); }
+stat_t kn_set_kdl(nvObj_t *nv) { return (_set_kinematics(nv, kn.delta_rod, 0, 10000)); }
+stat_t kn_get_krp(nvObj_t *nv) { return (get_float(nv, kn.rtcp_pivot)); }
+stat_t kn_set_krp(nvObj_t *nv) { return (_set_kinematics(nv, kn.rtcp_pivot, 0, 10000)); }
+
+/*
+ * Mesh settings
+ *
+ *  Changing the grid geometry discards the stored mesh, since its points no longer
+ *  line up with the grid. Probe and clearance heights only affect the next grid cycle.
+ */
+
+static stat_t _set_mesh_geometry(nvObj_t *nv, float &value, float low, float high)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(set_float_range(nv, value, low, high));
+    kn_config_changed();
+    kn_set_mesh_valid(false);
+    return (STAT_OK);
+}
+
+stat_t kn_get_mshx(nvObj_t *nv) { return (get_float(nv, kn.mesh_origin[0])); }
+stat_t kn_set_mshx(nvObj_t *nv) { return (_set_mesh_geometry(nv, kn.mesh_origin[0], -10000, 10000)); }
+stat_t kn_get_mshy(nvObj_t *nv) { return (get_float(nv, kn.mesh_origin[1])); }
+stat_t kn_set_mshy(nvObj_t *nv) { return (_set_mesh_geometry(nv, kn.mesh_origin[1], -10000, 10000)); }
+stat_t kn_get_mshi(nvObj_t *nv) { return (get_float(nv, kn.mesh_size[0])); }
+stat_t kn_set_mshi(nvObj_t *nv) { return (_set_mesh_geometry(nv, kn.mesh_size[0], 1, 10000)); }
+stat_t kn_get_mshj(nvObj_t *nv) { return (get_float(nv, kn.mesh_size[1])); }
+stat_t kn_set_mshj(nvObj_t *nv) { return (_set_mesh_geometry(nv, kn.mesh_size[1], 1, 10000)); }
+stat_t kn_get_mshz(nvObj_t *nv) { return (get_float(nv, kn.mesh_probe_z)); }
+stat_t kn_set_mshz(nvObj_t *nv) { return (set_float_range(nv, kn.mesh_probe_z, -10000, 10000)); }
+stat_t kn_get_mshc(nvObj_t *nv) { return (get_float(nv, kn.mesh_clear_z)); }
+stat_t kn_set_mshc(nvObj_t *nv) { return (set_float_range(nv, kn.mesh_clear_z, -10000, 10000)); }
+
+stat_t kn_get_mshn(nvObj_t *nv) { return (get_integer(nv, kn.mesh_points)); }
+stat_t kn_set_mshn(nvObj_t *nv)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(set_integer(nv, kn.mesh_points, 2, MESH_POINTS_MAX));
+    kn_config_changed();
+    kn_set_mesh_valid(false);
+    return (STAT_OK);
+}
+
+stat_t kn_get_mshe(nvObj_t *nv) { return (get_integer(nv, kn.mesh_enable)); }
+stat_t kn_set_mshe(nvObj_t *nv)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    bool was_active = kn.mesh_enable && kn.mesh_valid;
+    ritorno(set_integer(nv, (uint8_t &)kn.mesh_enable, 0, 1));
+    if (was_active != (kn.mesh_enable && kn.mesh_valid)) {
+        mp_set_steps_to_runtime_position();
+    }
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_kin[] = "[kin] kinematics%19d [0=cartesian,1=corexy,2=delta,3=rtcp]\n";
+static const char fmt_kdr[] = "[kdr] delta tower radius%16.3f mm\n";
+static const char fmt_kdl[] = "[kdl] delta rod length%18.3f mm\n";
+static const char fmt_krp[] = "[krp] rtcp pivot length%17.3f mm\n";
+static const char fmt_mshx[] = "[mshx] mesh origin X%20.3f mm\n";
+static const char fmt_mshy[] = "[mshy] mesh origin Y%20.3f mm\n";
+static const char fmt_mshi[] = "[mshi] mesh size X%22.3f mm\n";
+static const char fmt_mshj[] = "[mshj] mesh size Y%22.3f mm\n";
+static const char fmt_mshn[] = "[mshn] mesh points per side%12d\n";
+static const char fmt_mshz[] = "[mshz] mesh probe Z%21.3f mm\n";
+static const char fmt_mshc[] = "[mshc] mesh clearance Z%17.3f mm\n";
+static const char fmt_mshe[] = "[mshe] mesh compensation%14d [0=disable,1=enable]\n";
+
+void kn_print_kin(nvObj_t *nv) { text_print(nv, fmt_kin); }
+void kn_print_kdr(nvObj_t *nv) { text_print(nv, fmt_kdr); }
+void kn_print_kdl(nvObj_t *nv) { text_print(nv, fmt_kdl); }
+void kn_print_krp(nvObj_t *nv) { text_print(nv, fmt_krp); }
+void kn_print_mshx(nvObj_t *nv) { text_print(nv, fmt_mshx); }
+void kn_print_mshy(nvObj_t *nv) { text_print(nv, fmt_mshy); }
+void kn_print_mshi(nvObj_t *nv) { text_print(nv, fmt_mshi); }
+void kn_print_mshj(nvObj_t *nv) { text_print(nv, fmt_mshj); }
+void kn_print_mshn(nvObj_t *nv) { text_print(nv, fmt_mshn); }
+void kn_print_mshz(nvObj_t *nv) { text_print(nv, fmt_mshz); }
+void kn_print_mshc(nvObj_t *nv) { text_print(nv, fmt_mshc); }
+void kn_print_mshe(nvObj_t *nv) { text_print(nv, fmt_mshe); }
+
+#endif // __TEXT_MODE
@@ -28,11 +28,153 @@
 #ifndef KINEMATICS_H_ONCE
 #define KINEMATICS_H_ONCE
 
+#include "config.h"
+#include "hardware.h"         // for MOTORS
+
+#ifndef MESH_POINTS_MAX
+#define MESH_POINTS_MAX     7   // largest probing grid per side; boards can override this value in hardware.h
+#endif
+
+/*
+ * KINEMATICS
+ *
+ *  Moves are planned in axis (Cartesian tool) space. A kinematics transform converts axis
+ *  positions to joint positions; joints are then mapped to motors through a table built
+ *  from the motor map ($1ma), steps per unit and axis modes, so the per-segment step
+ *  conversion is one multiply per motor. The joint for an axis is the joint driven by the
+ *  motors mapped to that axis (e.g. CoreXY motors mapped to X and Y drive joints A and B).
+ *
+ *  The transform is selected with $kin. Changing it or its geometry resets the step
+ *  counters to the current runtime position, so it can't be done while in a cycle.
+ *  The cost of each inverse transform call is reported in {"prof":n} as profk*
+ *  (see profile.h) when profiling is enabled.
+ *
+ *  MESH COMPENSATION
+ *
+ *  A probing grid ({"mesh":t}, see cycle_probing.cpp) stores the surface height at
+ *  mshn x mshn points spread over the rectangle mshx,mshy to mshx+mshi,mshy+mshj
+ *  (machine coordinates). Heights are relative to the first point, so compensation
+ *  is zero at the grid origin. When enabled ($mshe) the height at the tool XY is
+ *  bilinearly interpolated and added to Z ahead of the transform. This runs per
+ *  segment, so long moves follow the surface rather than only their endpoints.
+ *  Outside the grid the nearest edge value is held.
+ *
+ *  Turning compensation on or off re-derives the step counters like a kinematics
+ *  change. Do it with the tool over the grid origin (where the grid cycle leaves it)
+ *  or re-home afterwards; elsewhere Z is shifted by the compensation at that XY.
+ *
+ *  The torch height control offset (see thc.h) is added to Z with the mesh height,
+ *  and taken off again by the forward transform.
+ */
+
+typedef enum {                  // kinematics transforms
+    KIN_CARTESIAN = 0,          // joints are axes
+    KIN_COREXY,                 // X joint = X+Y, Y joint = X-Y
+    KIN_DELTA,                  // X, Y, Z joints are the heights of carriages on towers A, B, C
+    KIN_RTCP,                   // 5 axis head with A (tilt about X) and C (rotate about Z) and a pivot offset
+    KIN_TYPE_MAX                // must be last
+} kinType;
+
+typedef struct kinKinematics {  // a kinematics transform
+    void (*inverse)(const float travel[], float joint[]);   // axis positions -> joint positions
+    void (*forward)(const float joint[], float travel[]);   // joint positions -> axis positions
+} kinKinematics_t;
+
+typedef struct kinSingleton {
+    kinType type;                       // selected transform
+    const kinKinematics_t *k;           // pointer to selected transform
+
+    float delta_radius;                 // tower radius from center to carriage pivots (mm)
+    float delta_rod;                    // diagonal rod length (mm)
+    float rtcp_pivot;                   // pivot to tool tip length (mm)
+
+    float delta_tower[3][2];            // derived: tower XY positions
+    float delta_rod2;                   // derived: delta_rod squared
+    float delta_home;                   // derived: carriage height above effector at X0Y0
+
+    int8_t motor_axis[MOTORS];          // joint driven by each motor, or -1 for none (unmapped or inhibited)
+    float steps_per_unit[MOTORS];       // copy of st_cfg steps per unit, aligned with motor_axis
+
+    bool mesh_enable;                   // apply Z mesh compensation when a mesh is stored
+    bool mesh_valid;                    // mesh_z holds a completed probing grid
+    uint8_t mesh_points;                // grid points per side
+    float mesh_origin[2];               // XY of the first grid point (machine mm)
+    float mesh_size[2];                 // XY extent of the grid (mm)
+    float mesh_probe_z;                 // machine Z the grid probes toward
+    float mesh_clear_z;                 // machine Z for traverses between grid points
+    float mesh_step_inv[2];             // derived: grid cells per mm
+    float mesh_z[MESH_POINTS_MAX][MESH_POINTS_MAX]; // height of each point relative to the first, [y][x]
+} kinSingleton_t;
+
+extern kinSingleton_t kn;
+
 /*
  * Global Scope Functions
  */
 
+void kinematics_init(void);
+void kn_config_changed(void);
+
 void kn_inverse_kinematics(const float travel[], float steps[]);
 void kn_forward_kinematics(const float steps[], float travel[]);
+uint8_t kn_active_motors(const uint16_t axis_mask);
+void kn_set_mesh_valid(bool valid);
+
+stat_t kn_get_kin(nvObj_t *nv);
+stat_t kn_set_kin(nvObj_t *nv);
+stat_t kn_get_kdr(nvObj_t *nv);
+stat_t kn_set_kdr(nvObj_t *nv);
+stat_t kn_get_kdl(nvObj_t *nv);
+stat_t kn_set_kdl(nvObj_t *nv);
+stat_t kn_get_krp(nvObj_t *nv);
+stat_t kn_set_krp(nvObj_t *nv);
+stat_t kn_get_mshx(nvObj_t *nv);
+stat_t kn_set_mshx(nvObj_t *nv);
+stat_t kn_get_mshy(nvObj_t *nv);
+stat_t kn_set_mshy(nvObj_t *nv);
+stat_t kn_get_mshi(nvObj_t *nv);
+stat_t kn_set_mshi(nvObj_t *nv);
+stat_t kn_get_mshj(nvObj_t *nv);
+stat_t kn_set_mshj(nvObj_t *nv);
+stat_t kn_get_mshn(nvObj_t *nv);
+stat_t kn_set_mshn(nvObj_t *nv);
+stat_t kn_get_mshz(nvObj_t *nv);
+stat_t kn_set_mshz(nvObj_t *nv);
+stat_t kn_get_mshc(nvObj_t *nv);
+stat_t kn_set_mshc(nvObj_t *nv);
+stat_t kn_get_mshe(nvObj_t *nv);
+stat_t kn_set_mshe(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+    void kn_print_kin(nvObj_t *nv);
+    void kn_print_kdr(nvObj_t *nv);
+    void kn_print_kdl(nvObj_t *nv);
+    void kn_print_krp(nvObj_t *nv);
+    void kn_print_mshx(nvObj_t *nv);
+    void kn_print_mshy(nvObj_t *nv);
+    void kn_print_mshi(nvObj_t *nv);
+    void kn_print_mshj(nvObj_t *nv);
+    void kn_print_mshn(nvObj_t *nv);
+    void kn_print_mshz(nvObj_t *nv);
+    void kn_print_mshc(nvObj_t *nv);
+    void kn_print_mshe(nvObj_t *nv);
+
+#else
+
+    #define kn_print_kin tx_print_stub
+    #define kn_print_kdr tx_print_stub
+    #define kn_print_kdl tx_print_stub
+    #define kn_print_krp tx_print_stub
+    #define kn_print_mshx tx_print_stub
+    #define kn_print_mshy tx_print_stub
+    #define kn_print_mshi tx_print_stub
+    #define kn_print_mshj tx_print_stub
+    #define kn_print_mshn tx_print_stub
+    #define kn_print_mshz tx_print_stub
+    #define kn_print_mshc tx_print_stub
+    #define kn_print_mshe tx_print_stub
+
+#endif // __TEXT_MODE
 
 #endif  // End of include Guard: KINEMATICS_H_ONCE
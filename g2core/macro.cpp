@@ -0,0 +1,188 @@
+/*
+ * macro.cpp - stored Gcode macros run from the controller
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "macro.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "planner.h"
+#include "report.h"
+#include "settings.h"
+#include "text_parser.h"
+#include "xio.h"
+
+/**** Macro singleton structure ****/
+
+struct mcMacroSingleton {           // state of the running macro
+    uint8_t macro;                  // macroId of the running macro, MACRO_NONE if idle
+    const char *next;               // next line to run, in flash
+    char line[MACRO_LINE_LEN];      // working copy of the line - the parser edits it in place
+
+    // state saved from gcode model
+    float   saved_feed_rate;        // F setting
+    uint8_t saved_units_mode;       // G20,G21 global setting
+    uint8_t saved_coord_system;     // G54 - G59 setting
+    uint8_t saved_distance_mode;    // G90,G91 global setting
+    uint8_t saved_feed_rate_mode;   // G93,G94 global setting
+};
+static struct mcMacroSingleton mac;
+
+static const char *const macros[MACRO_COUNT] = {   // indexed by macroId
+    "",
+    MACRO_TOOL_CHANGE,
+    MACRO_TOOL_PROBE,
+    MACRO_PARK
+};
+
+static void _restore_modes(void);
+
+/****************************************************************************************
+ * mc_run_macro()      - start a stored macro
+ * mc_macro_callback() - controller continuation that queues the running macro's lines
+ * mc_abort_macro()    - drop the rest of the running macro
+ * mc_macro_running()  - true while a macro still has lines to queue
+ */
+
+stat_t mc_run_macro(const uint8_t macro)
+{
+    if (macro >= MACRO_COUNT) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if ((mac.macro != MACRO_NONE) || (*macros[macro] == NUL)) {
+        return (STAT_OK);                           // already in a macro, or nothing to run
+    }
+    mac.saved_units_mode     = cm_get_units_mode(MODEL);
+    mac.saved_coord_system   = cm_get_coord_system(MODEL);
+    mac.saved_distance_mode  = cm_get_distance_mode(MODEL);
+    mac.saved_feed_rate_mode = cm_get_feed_rate_mode(MODEL);
+    mac.saved_feed_rate      = (MODEL)->feed_rate;
+
+    mac.macro = macro;
+    mac.next = macros[macro];
+    return (STAT_OK);
+}
+
+stat_t mc_macro_callback()
+{
+    if (mac.macro == MACRO_NONE) {
+        return (STAT_NOOP);
+    }
+    if (cm_is_alarmed() != STAT_OK) {
+        mc_abort_macro();
+        return (STAT_NOOP);
+    }
+    if (mp_planner_is_full(mp)) {
+        return (STAT_EAGAIN);
+    }
+
+    const char *p = mac.next;                       // copy out the next line
+    uint8_t len = 0;
+    while ((*p != NUL) && (*p != '\n')) {
+        if (len < MACRO_LINE_LEN - 1) {
+            mac.line[len] = *p;
+        }
+        len++;
+        p++;
+    }
+    mac.next = (*p == '\n') ? p + 1 : p;
+
+    stat_t status;
+    if (len >= MACRO_LINE_LEN) {
+        status = STAT_INPUT_EXCEEDS_MAX_LENGTH;
+    } else {
+        mac.line[len] = NUL;
+        status = gcode_parser(mac.line);
+    }
+    if ((status != STAT_OK) && (status != STAT_NOOP)) {
+        rpt_exception(status, "macro line");
+        mc_abort_macro();
+        return (STAT_OK);
+    }
+    if (*mac.next == NUL) {                         // last line is queued
+        _restore_modes();
+        mac.macro = MACRO_NONE;
+        return (STAT_OK);
+    }
+    return (STAT_EAGAIN);
+}
+
+void mc_abort_macro()
+{
+    if (mac.macro != MACRO_NONE) {
+        _restore_modes();
+        mac.macro = MACRO_NONE;
+    }
+}
+
+bool mc_macro_running() { return (mac.macro != MACRO_NONE); }
+
+static void _restore_modes()
+{
+    cm_set_units_mode(mac.saved_units_mode);
+    cm_set_distance_mode(mac.saved_distance_mode);
+    cm_set_feed_rate_mode(mac.saved_feed_rate_mode);
+    (MODEL)->feed_rate = mac.saved_feed_rate;
+    if (cm_get_coord_system(MODEL) != mac.saved_coord_system) {
+        cm_set_coord_system(mac.saved_coord_system);
+    }
+}
+
+/****************************************************************************************
+ * mc_get_mac() - return the running macro, 0 if none
+ * mc_set_mac() - run a stored macro     {mac:3}
+ */
+
+stat_t mc_get_mac(nvObj_t *nv)
+{
+    nv->value_int = mac.macro;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t mc_set_mac(nvObj_t *nv)
+{
+    if (mac.macro != MACRO_NONE) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if ((nv->value_int <= MACRO_NONE) || (nv->value_int >= MACRO_COUNT)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    return (mc_run_macro((uint8_t)nv->value_int));
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_mac[] = "[mac]  running macro%14d\n";
+
+void mc_print_mac(nvObj_t *nv) { text_print(nv, fmt_mac); }  // TYPE_INT
+
+#endif // __TEXT_MODE
@@ -0,0 +1,81 @@
+/*
+ * macro.h - stored Gcode macros run from the controller
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * STORED MACROS
+ *
+ *  A macro is a short Gcode program compiled into flash by the machine's settings file
+ *  (MACRO_TOOL_CHANGE, MACRO_TOOL_PROBE, MACRO_PARK - lines separated by '\n'). Running
+ *  one feeds its lines straight into the Gcode parser from mc_macro_callback(), one line
+ *  per pass while the planner has room, so the moves queue behind the block that started
+ *  the macro without a round trip to the host. The callback returns EAGAIN until the last
+ *  line is queued, which holds the next host command back until then.
+ *
+ *  The tool change macro runs at M6; any macro can be started with {mac:n}. An empty
+ *  macro does nothing. Units, distance mode, coordinate system and feed rate are saved
+ *  when a macro starts and restored once its last line is queued, so macros can use
+ *  G20/G21, G90/G91 and G53..G59 freely. A macro is abandoned on a parse error, an
+ *  alarm or a queue flush. Macros don't nest: M6 inside a macro only sets the tool.
+ */
+
+#ifndef MACRO_H_ONCE
+#define MACRO_H_ONCE
+
+#include "config.h"
+
+#ifndef MACRO_LINE_LEN
+#define MACRO_LINE_LEN 80           // longest macro line, including the terminator
+#endif
+
+typedef enum {
+    MACRO_NONE = 0,                 // no macro running
+    MACRO_TOOL_CHANGE_ID,           // {mac:1} - also run at M6
+    MACRO_TOOL_PROBE_ID,            // {mac:2} - measure tool length
+    MACRO_PARK_ID,                  // {mac:3} - move to the park position
+    MACRO_COUNT
+} macroId;
+
+/**** Function Prototypes ****/
+
+stat_t mc_run_macro(const uint8_t macro);
+stat_t mc_macro_callback(void);
+void mc_abort_macro(void);
+bool mc_macro_running(void);
+
+stat_t mc_get_mac(nvObj_t *nv);
+stat_t mc_set_mac(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void mc_print_mac(nvObj_t *nv);
+
+#else
+
+#define mc_print_mac tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: MACRO_H_ONCE
@@ -24,6 +24,7 @@
 #include "config.h"  // #2
 #include "hardware.h"
 #include "persistence.h"
+#include "job.h"
 #include "controller.h"
 #include "canonical_machine.h"
 #include "json_parser.h"			// required for unit tests only
@@ -37,6 +38,11 @@
 #include "gpio.h"
 #include "pwm.h"
 #include "xio.h"
+#include "profile.h"
+#include "memory_usage.h"
+#include "motion_trace.h"
+#include "sim_harness.h"
+#include "kinematics.h"
 
 #include "util.h"
 #include "MotateUniqueID.h"
@@ -99,6 +105,7 @@ void application_init_services(void)
     hardware_init();				    // system hardware setup 			- must be first
     persistence_init();				    // set up EEPROM or other NVM		- must be second
     xio_init();						    // xtended io subsystem				- must be third
+    job_init();                         // stored Gcode job, if any
 }
 
 void application_init_machine(void)
@@ -107,9 +114,13 @@ void application_init_machine(void)
     cm->machine_state = MACHINE_INITIALIZING;
 	canonical_machine_inits();          // combined inits for CMs and planner 
     stepper_init();                     // stepper subsystem
+    kinematics_init();                  // kinematics transform and motor table
     encoder_init();                     // virtual encoders
     gpio_init();                        // inputs and outputs
     pwm_init();                         // pulse width modulation drivers
+    profile_init();                     // interrupt cycle counters
+    mem_init();                         // paint the unused stack for the high-water mark
+    motion_trace_init();                // simulator motion trace file
        
 }
 
@@ -175,13 +186,16 @@ void xio_tim_Init(void);
 char nullptrP[100];
 
 
-int main() {
-
-
-
+int main(int argc, char *argv[]) {
 
+	int exit_code = 0;
+	if (sim_harness_start(argc, argv, exit_code)) {	// parallel job parent, or a bad argument
+		return exit_code;
+	}
 	xio_tim_Init();
-	xio_usart_Init();
+	if (!sim_harness_headless()) {
+		xio_usart_Init();
+	}
 	setup();
 	for (;;) {
 		loop();
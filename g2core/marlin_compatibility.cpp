@@ -89,37 +89,23 @@ Motate::Timeout temperature_update_timeout;
 
 // local helper functions and macros
 
-/***********************************************************************************
- * _get_specific_nv() - convenience function to get an NV object
- */
-nvObj_t *_get_specific_nv(const char *key) {
-    nvObj_t *nv = nv_reset_nv_list();           // returns first object in the body
-
-    strncpy(nv->token, key, TOKEN_LEN);
-
-    // validate and post-process the token
-    if ((nv->index = nv_get_index((const char *)"", nv->token)) == NO_MATCH) { // get index or fail it
-        return nullptr;        // since we JUST provided the keys, this should never happen
-    }
-    strcpy(nv->group, cfgArray[nv->index].group); // capture the group string if there is one
-    nv_get(nv);
-    return nv;
-}
-
 /***********************************************************************************
  * _report_temperatures() - convenience function called from marlin_response() and marlin_callback()
+ *
+ *  Temperatures are the readings taken by the last heater PID pass, so a host polling
+ *  M105 costs no sensor reads.
  */
 void _report_temperatures(char *(&str)) {
     // Tool 0 is extruder 1
     uint8_t tool = cm->gm.tool;
 
     str_concat(str, " T:");
-    str += floattoa(str, cm_get_temperature(tool), 2);
+    str += floattoa(str, cm_get_last_temperature(tool), 2);
     str_concat(str, " /");
     str += floattoa(str, cm_get_set_temperature(tool), 2);
 
     str_concat(str, " B:");
-    str += floattoa(str, cm_get_temperature(3), 2);
+    str += floattoa(str, cm_get_last_temperature(3), 2);
     str_concat(str, " /");
     str += floattoa(str, cm_get_set_temperature(3), 2);
 
@@ -273,6 +259,10 @@ void _marlin_end_temperature_updates(float* vect, bool* flag) {
     temperature_updates_requested = false;
 }
 
+void _marlin_set_temperature(float* vect, bool* flag) {
+    cm_set_set_temperature((uint8_t)vect[0], vect[1]);
+}
+
 bool _queue_next_temperature_commands()
 {
     if (MarlinSetTempState::Idle != set_temp_state) {
@@ -280,18 +270,11 @@ bool _queue_next_temperature_commands()
             return false;
         }
 
-        char buffer[128];
-        char *str = buffer;
-
         if ((MarlinSetTempState::SettingTemperature == set_temp_state) ||
             (MarlinSetTempState::SettingTemperatureNoWait == set_temp_state))
         {
-            str_concat(str, "{he");
-            str += inttoa(str, next_temperature_tool);
-            str_concat(str, "st:");
-            str += floattoa(str, next_temperature, 2);
-            str_concat(str, "}");
-            cm_json_command(buffer);
+            float value[AXES] = { (float)next_temperature_tool, next_temperature };
+            mp_queue_command(_marlin_set_temperature, value, nullptr_bool);
 
             if (MarlinSetTempState::SettingTemperatureNoWait == set_temp_state) {
                 set_temp_state = MarlinSetTempState::Idle;
@@ -314,11 +297,7 @@ bool _queue_next_temperature_commands()
         }
 
         if (MarlinSetTempState::StartingWait == set_temp_state) {
-            str = buffer;
-            str_concat(str, "{he");
-            str += inttoa(str, next_temperature_tool);
-            str_concat(str, "at:t}");
-            cm_json_wait(buffer);
+            mp_heater_wait(next_temperature_tool, 0);     // wait for the PID's set point
 
             set_temp_state = MarlinSetTempState::StoppingUpdates;
             if (mp_planner_is_full(mp)) {
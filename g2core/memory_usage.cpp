@@ -0,0 +1,191 @@
+/*
+ * memory_usage.cpp - RAM footprint and stack usage diagnostics
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "memory_usage.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "text_parser.h"
+#include "controller.h"
+#include "xio.h"
+
+#if !defined(WIN32) && !defined(SIM_POSIX)
+#include <unistd.h>         // for sbrk()
+#endif
+
+#define MEM_PAINT 0xC5C5C5C5            // fill pattern for unused stack
+#define MEM_PAINT_MARGIN 16             // words left unpainted below the stack pointer
+
+/**** Allocate Structures ****/
+
+memSingleton_t mem;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+/*
+ * mem_init()   - paint the unused stack and clear the interrupt entry samples
+ * _heap_top()  - first word above the heap
+ * _deepest()   - lowest stack word that has been written since mem_init()
+ *
+ *  The paint runs from the top of the heap to just under the stack pointer, with
+ *  interrupts off so no interrupt frame is painted over. The scan starts at the top of
+ *  the heap as it is now, so a heap that has grown since is not read as stack.
+ */
+
+#if !defined(WIN32) && !defined(SIM_POSIX)
+
+static uint32_t *_heap_top()
+{
+    return ((uint32_t *)(((uint32_t)sbrk(0) + 3) & ~3));
+}
+
+static uint32_t *_deepest()
+{
+    uint32_t *p = _heap_top();
+    uint32_t *sp = (uint32_t *)__get_MSP();
+
+    while ((p < sp) && (*p == MEM_PAINT)) {
+        p++;
+    }
+    return (p);
+}
+
+void mem_init()
+{
+    mem.stack_top = *(uint32_t *)SCB->VTOR;     // the initial stack pointer is the first vector
+    for (uint8_t l = 0; l < MEM_ISR_LEVELS; l++) {
+        mem.isr_sp[l] = UINT32_MAX;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t *p = _heap_top();
+    uint32_t *end = (uint32_t *)__get_MSP() - MEM_PAINT_MARGIN;
+    while (p < end) {
+        *p++ = MEM_PAINT;
+    }
+    __set_PRIMASK(primask);
+}
+
+#else
+
+void mem_init()
+{
+    mem.stack_top = 0;
+    for (uint8_t l = 0; l < MEM_ISR_LEVELS; l++) {
+        mem.isr_sp[l] = UINT32_MAX;
+    }
+}
+
+#endif // !WIN32 && !SIM_POSIX
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * mem_get_size()  - get a static footprint, decoded from the token:
+ *                   mem + {q=planner pool, mp=planners, cm=machines, nv=nv list, rx, tx}
+ * mem_get_stack() - get memfr free RAM, or a stack figure decoded from the token:
+ *                   mems + {t=high-water, d=DDA, e=exec, f=forward plan entry}
+ */
+
+stat_t mem_get_size(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+
+    switch (token[3]) {
+        case 'q': { return (get_integer(nv, sizeof(mp_pool) + sizeof(mp_pool_cold))); }
+        case 'm': { return (get_integer(nv, sizeof(mp1) + sizeof(mp2))); }
+        case 'c': { return (get_integer(nv, sizeof(cm1) + sizeof(cm2))); }
+        case 'n': { return (get_integer(nv, sizeof(nvl) + sizeof(nvStr))); }
+        case 'r': { return (get_integer(nv, xio_rx_buffer_bytes())); }
+        case 't': { return (get_integer(nv, xio_tx_buffer_bytes())); }
+        default:  { return (STAT_INTERNAL_ERROR); }
+    }
+}
+
+stat_t mem_get_stack(nvObj_t *nv)
+{
+#if !defined(WIN32) && !defined(SIM_POSIX)
+    const char *token = cfgArray[nv->index].token;
+    uint32_t sp;
+
+    if (token[3] == 'f') {
+        return (get_integer(nv, (uint32_t)_deepest() - (uint32_t)_heap_top()));
+    }
+    switch (token[4]) {
+        case 't': { return (get_integer(nv, mem.stack_top - (uint32_t)_deepest())); }
+        case 'd': { sp = mem.isr_sp[MEM_ISR_DDA]; break; }
+        case 'e': { sp = mem.isr_sp[MEM_ISR_EXEC]; break; }
+        case 'f': { sp = mem.isr_sp[MEM_ISR_FWD_PLAN]; break; }
+        default:  { return (STAT_INTERNAL_ERROR); }
+    }
+    return (get_integer(nv, (sp == UINT32_MAX) ? 0 : mem.stack_top - sp));
+#else
+    return (get_integer(nv, 0));
+#endif
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_mem_bytes[] = "[%s] %-28s%8lu bytes\n";
+
+void mem_print_bytes(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    const char *label;
+
+    switch (token[3]) {
+        case 'q': { label = "planner buffer pool"; break; }
+        case 'm': { label = "planner contexts"; break; }
+        case 'c': { label = "canonical machines"; break; }
+        case 'n': { label = "nv list"; break; }
+        case 'r': { label = "RX buffers"; break; }
+        case 't': { label = "TX buffers"; break; }
+        case 'f': { label = "free RAM"; break; }
+        default: {
+            switch (token[4]) {
+                case 't': { label = "stack high-water mark"; break; }
+                case 'd': { label = "stack at DDA interrupt entry"; break; }
+                case 'e': { label = "stack at exec interrupt entry"; break; }
+                default:  { label = "stack at fwd plan entry"; break; }
+            }
+        }
+    }
+    sprintf(cs.out_buf, fmt_mem_bytes, token, label, (unsigned long)nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
+#endif // __TEXT_MODE
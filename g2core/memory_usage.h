@@ -0,0 +1,111 @@
+/*
+ * memory_usage.h - RAM footprint and stack usage diagnostics
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * MEMORY DIAGNOSTICS
+ *
+ *  The {"mem":n} group reports, in bytes:
+ *
+ *      memq    planner buffer pool, shared by the primary and secondary queues
+ *      memmp   planner contexts (mp1, mp2)
+ *      memcm   canonical machines (cm1, cm2)
+ *      memnv   nvObj list and its string pool
+ *      memrx   RX buffers of all xio devices, including their line buffers
+ *      memtx   TX buffers of all xio devices
+ *      memst   stack high-water mark - the most stack ever in use
+ *      memfr   RAM never touched, between the top of the heap and the stack high-water mark
+ *      memsd   stack in use when the DDA interrupt was entered, deepest seen
+ *      memse   same for the exec interrupt
+ *      memsf   same for the forward planning interrupt
+ *
+ *  On Cortex-M all interrupt levels share the main stack, so painting can only give one
+ *  high-water mark. mem_init() fills the unused stack with a pattern, and the mark is the
+ *  deepest word that no longer holds it. Each interrupt level is sampled on entry
+ *  instead: the stack in use then is what the code it preempted had taken, so memst
+ *  less the deepest entry sample is the headroom that interrupt and any above it had.
+ *  The entry samples are taken with the profiling hooks and read 0 unless PROFILE_ENABLED
+ *  is true. The stack and free RAM figures read 0 on the simulators.
+ */
+
+#ifndef MEMORY_USAGE_H_ONCE
+#define MEMORY_USAGE_H_ONCE
+
+#include "config.h"
+#include "settings.h"       // for PROFILE_ENABLED
+
+/**** Structures ****/
+
+typedef enum {              // interrupt levels sampled on entry
+    MEM_ISR_DDA = 0,
+    MEM_ISR_EXEC,
+    MEM_ISR_FWD_PLAN,
+    MEM_ISR_LEVELS          // must be last
+} memIsrLevel;
+
+typedef struct memSingleton {
+    uint32_t stack_top;                 // initial stack pointer
+    uint32_t isr_sp[MEM_ISR_LEVELS];    // lowest stack pointer seen on entry to each level
+} memSingleton_t;
+
+extern memSingleton_t mem;
+
+/**** Function prototypes ****/
+
+void mem_init(void);
+
+/*
+ * mem_isr_entry() - sample the stack on entry to an interrupt level
+ */
+
+#if (PROFILE_ENABLED == true) && !defined(WIN32) && !defined(SIM_POSIX)
+static inline void mem_isr_entry(const memIsrLevel level)
+{
+    uint32_t sp = __get_MSP();
+    if (sp < mem.isr_sp[level]) {
+        mem.isr_sp[level] = sp;
+    }
+}
+#define MEM_ISR(l)  mem_isr_entry(l);
+#else
+#define MEM_ISR(l)
+#endif
+
+/**** Configuration and interface functions ****/
+
+stat_t mem_get_size(nvObj_t *nv);
+stat_t mem_get_stack(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+    void mem_print_bytes(nvObj_t *nv);
+
+#else
+
+    #define mem_print_bytes tx_print_stub
+
+#endif // __TEXT_MODE
+
+#endif  // End of include guard: MEMORY_USAGE_H_ONCE
@@ -0,0 +1,177 @@
+/*
+ * motion_trace.cpp - per-segment motion trace for the simulator
+ * This file is part of the g2core project
+ *
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "motion_trace.h"
+#include "stepper.h"
+#include "planner.h"
+
+#if MOTION_TRACE_ENABLED == true
+
+#ifdef WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+#include <stdio.h>
+
+#define MT_FLUSH_MS 100             // writer wakes this often to drain the queue
+
+static_assert(((MOTION_TRACE_RECORDS - 1) & MOTION_TRACE_RECORDS) == 0, "MOTION_TRACE_RECORDS must be 2^N");
+
+/**** Allocate Structures ****/
+
+typedef struct mtSingleton {
+    mtRecord_t pending[PREP_BUFFER_SLOTS];  // filled in by exec, queued by the loader
+    mtRecord_t queue[MOTION_TRACE_RECORDS]; // loader -> writer thread
+    volatile uint32_t head;                 // written only by the loader
+    volatile uint32_t tail;                 // written only by the writer thread
+    uint32_t sequence;                      // segments loaded since startup
+    uint32_t motion_ticks;                  // simulated motion time (DDA ticks)
+    volatile uint32_t dropped;              // records lost because the queue was full
+    FILE *file;
+} mtSingleton_t;
+
+static mtSingleton_t mt;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+
+/*
+ * _mt_writer() - background thread that drains the record queue to the trace file
+ */
+
+#ifdef WIN32
+static void _mt_writer(void *arg)
+#else
+static void *_mt_writer(void *arg)
+#endif
+{
+    uint32_t reported_drops = 0;
+
+    for (;;) {
+#ifdef WIN32
+        Sleep(MT_FLUSH_MS);
+#else
+        struct timespec flush = { 0, MT_FLUSH_MS * 1000000L };
+        nanosleep(&flush, NULL);
+#endif
+        uint32_t head = mt.head;
+        if (head == mt.tail) {
+            continue;
+        }
+        while (mt.tail != head) {               // write up to the wrap, then the rest
+            uint32_t start = mt.tail & (MOTION_TRACE_RECORDS - 1);
+            uint32_t count = head - mt.tail;
+            if (count > MOTION_TRACE_RECORDS - start) {
+                count = MOTION_TRACE_RECORDS - start;
+            }
+            fwrite(&mt.queue[start], sizeof(mtRecord_t), count, mt.file);
+            mt.tail = mt.tail + count;
+        }
+        fflush(mt.file);
+        if (mt.dropped != reported_drops) {
+            reported_drops = mt.dropped;
+            printf("[trace] %lu segment records dropped\n", (unsigned long)reported_drops);
+        }
+    }
+}
+
+/*
+ * motion_trace_init() - open the trace file, write its header and start the writer thread
+ */
+
+void motion_trace_init()
+{
+    mtHeader_t header = { {'G','2','M','T'}, MOTION_TRACE_VERSION, sizeof(mtRecord_t), AXES, MOTORS, 0, FREQUENCY_DDA };
+
+    if ((mt.file = fopen(MOTION_TRACE_FILE, "wb")) == NULL) {
+        printf("[trace] could not open %s - motion trace disabled\n", MOTION_TRACE_FILE);
+        return;
+    }
+    fwrite(&header, sizeof(header), 1, mt.file);
+#ifdef WIN32
+    _beginthread(_mt_writer, 0, NULL);
+#else
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, _mt_writer, NULL) == 0) {
+        pthread_detach(writer);
+    }
+#endif
+}
+
+/*
+ * mt_prep_segment() - fill in the record for a prep slot (exec interrupt, from st_prep_line())
+ * mt_load_segment() - time stamp a slot's record and queue it for writing (loader)
+ */
+
+void mt_prep_segment(const uint8_t slot, const float travel_steps[], const float segment_time)
+{
+    mtRecord_t *r = &mt.pending[slot];
+
+    r->segment_time = segment_time;
+    r->velocity = mr->segment_velocity;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        r->position[axis] = mr->position[axis];
+    }
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        r->travel_steps[motor] = travel_steps[motor];
+    }
+}
+
+void mt_load_segment(const uint8_t slot, const uint32_t dda_ticks)
+{
+    mtRecord_t *r = &mt.pending[slot];
+
+    r->sequence = mt.sequence++;
+    r->load_ticks = mt.motion_ticks;
+    r->dda_ticks = dda_ticks;
+    mt.motion_ticks += dda_ticks;
+
+    if (mt.file == NULL) {
+        return;
+    }
+    if ((mt.head - mt.tail) == MOTION_TRACE_RECORDS) {  // writer is behind - never stall the loader
+        mt.dropped = mt.dropped + 1;
+        return;
+    }
+    mt.queue[mt.head & (MOTION_TRACE_RECORDS - 1)] = *r;
+    mt.head = mt.head + 1;
+}
+
+#else
+
+void motion_trace_init() {}
+void mt_prep_segment(const uint8_t slot, const float travel_steps[], const float segment_time) {}
+void mt_load_segment(const uint8_t slot, const uint32_t dda_ticks) {}
+
+#endif // MOTION_TRACE_ENABLED
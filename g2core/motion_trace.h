@@ -0,0 +1,100 @@
+/*
+ * motion_trace.h - per-segment motion trace for the simulator
+ * This file is part of the g2core project
+ *
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * MOTION TRACE
+ *
+ *  Writes one fixed-size record per loaded segment to MOTION_TRACE_FILE for offline analysis
+ *  of velocity, acceleration and jerk profiles. Exec fills in the record for a prep slot in
+ *  st_prep_line() and the loader stamps it with the simulated time and queues it when the
+ *  slot loads in _load_move(). A background thread writes queued records to the file, so
+ *  neither interrupt ever waits on file I/O. If the writer falls behind, records are dropped
+ *  and the number dropped is printed on the console when the file is flushed.
+ *
+ *  File layout (little endian):
+ *    mtHeader_t                - magic "G2MT", version, record size, axis and motor counts
+ *    mtRecord_t ...            - one per segment, in load order
+ *
+ *  Simulated time is the sum of the DDA ticks of all segments loaded before this one, so
+ *  idle time between moves is not counted. Tracing is compiled out unless
+ *  MOTION_TRACE_ENABLED is true, and is only available in the simulators.
+ */
+
+#ifndef MOTION_TRACE_H_ONCE
+#define MOTION_TRACE_H_ONCE
+
+#include "config.h"
+#include "hardware.h"       // for MOTORS
+#include "settings.h"       // for MOTION_TRACE_ENABLED
+
+#if (MOTION_TRACE_ENABLED == true) && !defined(WIN32) && !defined(SIM_POSIX)
+#error "MOTION_TRACE_ENABLED is only supported in the simulators"
+#endif
+
+#ifndef MOTION_TRACE_FILE
+#define MOTION_TRACE_FILE "motion_trace.bin"
+#endif
+#define MOTION_TRACE_RECORDS 1024       // records queued for the writer thread (must be 2^N)
+#define MOTION_TRACE_VERSION 1
+
+/**** Structures ****/
+
+typedef struct mtHeader {
+    char magic[4];                  // "G2MT"
+    uint16_t version;               // MOTION_TRACE_VERSION
+    uint16_t record_size;           // sizeof(mtRecord_t)
+    uint8_t axes;                   // entries in mtRecord_t.position
+    uint8_t motors;                 // entries in mtRecord_t.travel_steps
+    uint16_t reserved;
+    uint32_t dda_frequency;         // DDA ticks per second
+} mtHeader_t;
+
+typedef struct mtRecord {
+    uint32_t sequence;              // segment number since startup
+    uint32_t load_ticks;            // simulated motion time when the segment loaded (DDA ticks)
+    uint32_t dda_ticks;             // segment length (DDA ticks)
+    float segment_time;             // segment length as planned (minutes)
+    float velocity;                 // mr->segment_velocity (mm/min)
+    float position[AXES];           // mr->position at the end of the segment
+    float travel_steps[MOTORS];     // steps commanded to each motor, after correction
+} mtRecord_t;
+
+/**** Function prototypes ****/
+
+void motion_trace_init(void);
+void mt_prep_segment(const uint8_t slot, const float travel_steps[], const float segment_time);
+void mt_load_segment(const uint8_t slot, const uint32_t dda_ticks);
+
+#if MOTION_TRACE_ENABLED == true
+#define MOTION_TRACE_PREP(slot, steps, time)    mt_prep_segment(slot, steps, time);
+#define MOTION_TRACE_LOAD(slot, ticks)          mt_load_segment(slot, ticks);
+#else
+#define MOTION_TRACE_PREP(slot, steps, time)
+#define MOTION_TRACE_LOAD(slot, ticks)
+#endif
+
+#endif  // End of include guard: MOTION_TRACE_H_ONCE
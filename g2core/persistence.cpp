@@ -24,7 +24,9 @@
  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
  * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <stddef.h>                         // offsetof
 #include "g2core.h"
+#include "g2core_info.h"
 #include "persistence.h"
 #include "canonical_machine.h"
 #include "report.h"
@@ -40,25 +42,299 @@ nvmSingleton_t nvm;
  **** GENERIC STATIC FUNCTIONS AND VARIABLES ***************************************
  ***********************************************************************************/
 
+#define NVM_VALID 0x01              // cache holds a value for this index
+#define NVM_DIRTY 0x02              // value has not been written to the log yet
+#define NVM_ERASED 0xFF             // value of an erased flash byte
+
+static_assert(NVM_SECTORS <= 127, "NVM_SECTORS must fit in nvm.sector");
+static_assert((NVM_SECTOR_SIZE - sizeof(nvmSectorHeader_t)) / sizeof(nvmRecord_t) > NVM_INDEX_MAX,
+              "NVM_SECTOR_SIZE must hold a compacted record for every cache entry");
+#define NVM_CHECKPOINT_HEADER offsetof(nvmCheckpoint_t, state)   // bytes of record header
+
+/*
+ * Flash backend
+ *
+ * _flash_open()    - attach the flash, returns false if there is none
+ * _flash_read()    - read bytes from a flash address
+ * _flash_program() - program erased bytes (bits only go from 1 to 0, as on NOR flash)
+ * _flash_erase()   - erase a sector to all 0xFF
+ *
+ *  The simulators keep the whole flash in RAM and write every change through to
+ *  NVM_FILE. Boards would supply these from their flash controller.
+ */
+
+#if defined(WIN32) || defined(SIM_POSIX)
+
+static uint8_t nvm_flash[(NVM_SECTORS + 3) * NVM_SECTOR_SIZE];   // log sectors, image sector and checkpoint sectors
+static FILE *nvm_file;
+
+static void _flash_sync(uint32_t address, uint32_t len)
+{
+    fseek(nvm_file, address, SEEK_SET);
+    fwrite(&nvm_flash[address], 1, len, nvm_file);
+    fflush(nvm_file);
+}
+
+static bool _flash_open()
+{
+    memset(nvm_flash, NVM_ERASED, sizeof(nvm_flash));
+    if ((nvm_file = fopen(NVM_FILE, "r+b")) != NULL) {
+        fread(nvm_flash, 1, sizeof(nvm_flash), nvm_file);   // a short file reads as erased
+        return (true);
+    }
+    if ((nvm_file = fopen(NVM_FILE, "w+b")) != NULL) {
+        _flash_sync(0, sizeof(nvm_flash));
+        return (true);
+    }
+    return (false);
+}
+
+static void _flash_read(uint32_t address, void *buf, uint32_t len)
+{
+    memcpy(buf, &nvm_flash[address], len);
+}
+
+static void _flash_program(uint32_t address, const void *buf, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    for (uint32_t i = 0; i < len; i++) {
+        nvm_flash[address + i] &= src[i];
+    }
+    _flash_sync(address, len);
+}
+
+static void _flash_erase(uint8_t sector)
+{
+    memset(&nvm_flash[sector * NVM_SECTOR_SIZE], NVM_ERASED, NVM_SECTOR_SIZE);
+    _flash_sync(sector * NVM_SECTOR_SIZE, NVM_SECTOR_SIZE);
+}
+
+#else
+
+static bool _flash_open() { return (false); }
+static void _flash_read(uint32_t address, void *buf, uint32_t len) { memset(buf, NVM_ERASED, len); }
+static void _flash_program(uint32_t address, const void *buf, uint32_t len) {}
+static void _flash_erase(uint8_t sector) {}
+
+#endif
+
+/*
+ * _check() - 8 bit check over a header or record, excluding the check field itself
+ */
+
+static uint8_t _check(const void *buf, uint8_t len)
+{
+    const uint8_t *b = (const uint8_t *)buf;
+    uint8_t check = 0x5A;                       // so an all-zero record doesn't check
+    for (uint8_t i = 0; i < len; i++) {
+        check = (check << 1 | check >> 7) ^ b[i];
+    }
+    return (check);
+}
+
+/*
+ * _crc32() - CRC-32 (reflected, poly 0xEDB88320), a nibble at a time from a 16 entry table
+ */
+
+static uint32_t _crc32(uint32_t crc, const void *buf, uint32_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t *b = (const uint8_t *)buf;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= b[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return (crc);
+}
+
+/*
+ * _values_crc() - CRC of the persisted value cache, valid entries only
+ */
+
+static uint32_t _values_crc()
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint16_t i = 0; i < nv_index_max(); i++) {
+        uint32_t value = (nvm.state[i] & NVM_VALID) ? nvm.value[i] : 0xFFFFFFFF;
+        crc = _crc32(crc, &value, sizeof(value));
+    }
+    return (crc);
+}
+
+static bool _header_valid(const nvmSectorHeader_t *h)
+{
+    return ((h->magic == NVM_MAGIC) && (h->check == _check(h, offsetof(nvmSectorHeader_t, check))) &&
+            (h->fw_build == (float)G2CORE_FIRMWARE_BUILD) && (h->index_max == nv_index_max()));
+}
+
+static bool _erased(const void *buf, uint32_t len)
+{
+    const uint8_t *b = (const uint8_t *)buf;
+    for (uint32_t i = 0; i < len; i++) {
+        if (b[i] != NVM_ERASED) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+static bool _record_erased(const nvmRecord_t *r) { return (_erased(r, sizeof(nvmRecord_t))); }
+
+static void _append(uint16_t index)
+{
+    nvmRecord_t r;
+    r.index = index;
+    r.is_int = (cfgArray[index].flags & (TYPE_INTEGER | TYPE_BOOLEAN)) ? 1 : 0;
+    r.value = nvm.value[index];
+    r.check = _check(&r, offsetof(nvmRecord_t, check));
+    _flash_program(nvm.sector * NVM_SECTOR_SIZE + nvm.address, &r, sizeof(r));
+    nvm.address += sizeof(r);
+    nvm.state[index] &= ~NVM_DIRTY;
+    nvm.dirty_count--;
+}
+
+/*
+ * _compact() - start the next sector with a copy of every cached value
+ *
+ *  The new sector only becomes live once its header is written, and a header is only
+ *  trusted if it checks. A compaction cut short leaves the previous sector live.
+ */
+
+static void _compact()
+{
+    uint8_t next = (nvm.sector < 0) ? 0 : ((nvm.sector + 1) % NVM_SECTORS);
+    nvmSectorHeader_t h = { NVM_MAGIC, nvm.sequence + 1, (float)G2CORE_FIRMWARE_BUILD, (uint16_t)nv_index_max(), 0 };
+    h.check = _check(&h, offsetof(nvmSectorHeader_t, check));
+
+    _flash_erase(next);
+    nvm.sector = next;
+    nvm.sequence = h.sequence;
+    nvm.address = sizeof(nvmSectorHeader_t);
+    for (uint16_t i = 0; i < nv_index_max(); i++) {
+        if (nvm.state[i] & NVM_VALID) {
+            if (!(nvm.state[i] & NVM_DIRTY)) {
+                nvm.state[i] |= NVM_DIRTY;      // _append() counts it back out
+                nvm.dirty_count++;
+            }
+            _append(i);
+        }
+    }
+    _flash_program(next * NVM_SECTOR_SIZE, &h, sizeof(h));
+}
+
+/*
+ * _checkpoint_load() - find the newest valid checkpoint record and where to append the next
+ *
+ *  Appending continues in the sector holding the newest record. A record that fails its
+ *  CRC but is not erased (cut off part way) still takes its slot. If the newest record
+ *  is a cleared one there is no checkpoint, but its sequence carries on.
+ */
+
+static void _checkpoint_load()
+{
+    nvmCheckpoint_t c;
+    uint32_t end[2] = { 0, 0 };
+    bool found = false;
+
+    for (uint8_t s = 0; s < 2; s++) {
+        uint32_t base = (NVM_CHECKPOINT_SECTOR + s) * NVM_SECTOR_SIZE;
+        for (uint32_t a = 0; a + sizeof(c) <= NVM_SECTOR_SIZE; a += sizeof(c)) {
+            _flash_read(base + a, &c, sizeof(c));
+            if (_erased(&c, sizeof(c))) {
+                break;                          // an erased slot ends the sector
+            }
+            end[s] = a + sizeof(c);
+            if (((c.magic == NVM_CHECKPOINT_MAGIC) || (c.magic == NVM_CHECKPOINT_CLEARED)) &&
+                (c.crc == _crc32(0xFFFFFFFF, &c.state, sizeof(c.state))) &&
+                (!found || ((int32_t)(c.sequence - nvm.checkpoint.sequence) > 0))) {
+                nvm.checkpoint = c;
+                nvm.checkpoint_sector = s;
+                found = true;
+            }
+        }
+    }
+    nvm.checkpoint_valid = found && (nvm.checkpoint.magic == NVM_CHECKPOINT_MAGIC);
+    nvm.checkpoint_address = end[nvm.checkpoint_sector];
+}
 
 /***********************************************************************************
  **** CODE *************************************************************************
  ***********************************************************************************/
 
+/*
+ * persistence_init() - attach the flash and load the live sector into the cache
+ *
+ *  The live sector is the valid one with the highest sequence. Its records are read in
+ *  order, so a later record for an index replaces an earlier one. A record that fails
+ *  its check (a write cut short) is skipped; the first erased record ends the log.
+ */
+
 void persistence_init()
 {
-    return;
+    memset(&nvm, 0, sizeof(nvm));
+    nvm.sector = -1;
+    if ((nv_index_max() > NVM_INDEX_MAX) || !_flash_open()) {
+        return;                                 // no persistence - settings defaults at every boot
+    }
+    nvm.enabled = true;
+    _checkpoint_load();
+
+    nvmSectorHeader_t h;
+    for (uint8_t s = 0; s < NVM_SECTORS; s++) {
+        _flash_read(s * NVM_SECTOR_SIZE, &h, sizeof(h));
+        if (_header_valid(&h) && ((nvm.sector < 0) || ((int32_t)(h.sequence - nvm.sequence) > 0))) {
+            nvm.sector = s;
+            nvm.sequence = h.sequence;
+        }
+    }
+    if (nvm.sector < 0) {
+        return;                                 // empty or out of rev - first flush starts a new log
+    }
+
+    nvmRecord_t r;
+    for (nvm.address = sizeof(h); nvm.address + sizeof(r) <= NVM_SECTOR_SIZE; nvm.address += sizeof(r)) {
+        _flash_read(nvm.sector * NVM_SECTOR_SIZE + nvm.address, &r, sizeof(r));
+        if (_record_erased(&r)) {
+            break;
+        }
+        if ((r.check == _check(&r, offsetof(nvmRecord_t, check))) && (r.index < nv_index_max())) {
+            nvm.value[r.index] = r.value;
+            nvm.state[r.index] = NVM_VALID;
+        }
+    }
+}
+
+/*
+ * persistence_is_loaded() - true if the cache was loaded from a log for this firmware
+ */
+
+bool persistence_is_loaded()
+{
+    return (nvm.enabled && (nvm.sector >= 0));
 }
 
 /*
  * read_persistent_value()	- return value (as float) by index
  *
- *	It's the responsibility of the caller to make sure the index does not exceed range
+ *	It's the responsibility of the caller to make sure the index does not exceed range.
+ *  Integer and boolean items are returned in value_int, others in value_flt.
+ *  Returns STAT_PERSISTENCE_ERROR if no value has been persisted for the index.
  */
 
 stat_t read_persistent_value(nvObj_t *nv)
 {
-    nv->value_flt = 0;
+    if (!nvm.enabled || !(nvm.state[nv->index] & NVM_VALID)) {
+        return (STAT_PERSISTENCE_ERROR);        // nv is left as it was
+    }
+    if (cfgArray[nv->index].flags & (TYPE_INTEGER | TYPE_BOOLEAN)) {
+        nv->value_int = (int32_t)nvm.value[nv->index];
+    } else {
+        memcpy(&nv->value_flt, &nvm.value[nv->index], sizeof(float));
+    }
     return (STAT_OK);
 }
 
@@ -67,12 +343,219 @@ stat_t read_persistent_value(nvObj_t *nv)
  *
  *	It's the responsibility of the caller to make sure the index does not exceed range
  *	Note: Removed NAN and INF checks on floats - not needed
+ *
+ *  Only the cache is updated here. The value reaches flash from persistence_flush(),
+ *  so a write never waits on flash and is safe to make during a cycle.
  */
 
 stat_t write_persistent_value(nvObj_t *nv)
 {
-//    if (cm->cycle_state != CYCLE_OFF) { // can't write when machine is moving
-//        return(rpt_exception(STAT_FILE_NOT_OPEN, "write_persistent_value() can't write when machine is in cycle"));
-//    }
+    if (!nvm.enabled) {
+        return (STAT_OK);
+    }
+    uint32_t value;
+    if (cfgArray[nv->index].flags & (TYPE_INTEGER | TYPE_BOOLEAN)) {
+        value = (uint32_t)nv->value_int;
+    } else {
+        memcpy(&value, &nv->value_flt, sizeof(float));
+    }
+    if ((nvm.state[nv->index] & NVM_VALID) && (nvm.value[nv->index] == value)) {
+        return (STAT_OK);                       // unchanged
+    }
+    nvm.value[nv->index] = value;
+    if (!(nvm.state[nv->index] & NVM_DIRTY)) {
+        nvm.dirty_count++;
+    }
+    nvm.state[nv->index] = NVM_VALID | NVM_DIRTY;
+    return (STAT_OK);
+}
+
+/*
+ * persistence_flush() - append up to NVM_FLUSH_MAX changed values to the log
+ *
+ *  Called from cm_deferred_write_callback() when no cycle is running. Compacts into the
+ *  next sector when the live one is full, which writes every value and clears the backlog.
+ */
+
+stat_t persistence_flush()
+{
+    if (!nvm.enabled || (nvm.dirty_count == 0)) {
+        return (STAT_OK);
+    }
+    if (nvm.sector < 0) {
+        _compact();                             // first write after an empty or out of rev load
+        return (STAT_OK);
+    }
+    uint8_t written = 0;
+    for (uint16_t i = 0; (i < nv_index_max()) && (written < NVM_FLUSH_MAX); i++) {
+        if (nvm.state[i] & NVM_DIRTY) {
+            if (nvm.address + sizeof(nvmRecord_t) > NVM_SECTOR_SIZE) {
+                _compact();
+                return (STAT_OK);
+            }
+            _append(i);
+            written++;
+        }
+    }
     return (STAT_OK);
 }
+
+/*
+ * persistence_load_image() - restore the config structs from the boot image
+ *
+ *  Returns false, leaving the structs untouched, unless the image was taken by this
+ *  firmware from exactly the persisted values now in the cache. The region data is
+ *  checked in place and then copied out with one memcpy per region.
+ */
+
+bool persistence_load_image(const cfgImageRegion_t *regions, uint8_t count)
+{
+    if (!persistence_is_loaded()) {
+        return (false);
+    }
+    uint32_t size = 0;
+    for (uint8_t r = 0; r < count; r++) {
+        size += regions[r].size;
+    }
+    nvmImageHeader_t h;
+    uint32_t address = NVM_IMAGE_SECTOR * NVM_SECTOR_SIZE;
+    _flash_read(address, &h, sizeof(h));
+    if ((h.magic != NVM_IMAGE_MAGIC) || (h.fw_build != (float)G2CORE_FIRMWARE_BUILD) ||
+        (h.index_max != nv_index_max()) || (h.size != size) || (h.values_crc != _values_crc())) {
+        return (false);
+    }
+    uint32_t crc = 0xFFFFFFFF;
+    address += sizeof(h);
+    for (uint8_t r = 0; r < count; r++) {
+        uint8_t buf[64];
+        for (uint32_t i = 0; i < regions[r].size; i += sizeof(buf)) {
+            uint32_t len = (regions[r].size - i < sizeof(buf)) ? (regions[r].size - i) : sizeof(buf);
+            _flash_read(address + i, buf, len);
+            crc = _crc32(crc, buf, len);
+        }
+        address += regions[r].size;
+    }
+    if (crc != h.data_crc) {
+        return (false);
+    }
+    address = NVM_IMAGE_SECTOR * NVM_SECTOR_SIZE + sizeof(h);
+    for (uint8_t r = 0; r < count; r++) {
+        _flash_read(address, regions[r].addr, regions[r].size);
+        address += regions[r].size;
+    }
+    return (true);
+}
+
+/*
+ * persistence_save_image() - take a boot image of the config structs
+ *
+ *  Called at the end of a config_init() that ran the SET functions. The header is
+ *  written last so an interrupted save leaves no image rather than a bad one.
+ */
+
+void persistence_save_image(const cfgImageRegion_t *regions, uint8_t count)
+{
+    if (!nvm.enabled) {
+        return;
+    }
+    nvmImageHeader_t h = { NVM_IMAGE_MAGIC, (float)G2CORE_FIRMWARE_BUILD, (uint16_t)nv_index_max(), 0,
+                           _values_crc(), 0xFFFFFFFF };
+    for (uint8_t r = 0; r < count; r++) {
+        h.size += regions[r].size;
+        h.data_crc = _crc32(h.data_crc, regions[r].addr, regions[r].size);
+    }
+    if (sizeof(h) + h.size > NVM_SECTOR_SIZE) {
+        return;                                 // regions outgrew the sector - every boot runs the SET functions
+    }
+    uint32_t address = NVM_IMAGE_SECTOR * NVM_SECTOR_SIZE;
+    _flash_erase(NVM_IMAGE_SECTOR);
+    for (uint8_t r = 0; r < count; r++) {
+        _flash_program(address + sizeof(h), regions[r].addr, regions[r].size);
+        address += regions[r].size;
+    }
+    _flash_program(NVM_IMAGE_SECTOR * NVM_SECTOR_SIZE, &h, sizeof(h));
+}
+
+/*
+ * persistence_checkpoint_busy()  - true while a checkpoint record is being written
+ * persistence_checkpoint_write() - start writing a checkpoint record. Ignored if busy
+ * persistence_checkpoint_step()  - erase or program the next part of the record being written
+ * persistence_checkpoint()       - newest complete checkpoint, NULL if there is none
+ * persistence_checkpoint_clear() - forget the checkpoint; a cleared record is written in steps
+ *
+ *  A step does at most one erase or NVM_CHECKPOINT_CHUNK bytes of programming, so the
+ *  caller can run one per controller pass during a cycle. A clear drops a record that is
+ *  still being written - it never gets its header - and writes the cleared record in its
+ *  place. Until that is programmed a power loss brings the old checkpoint back.
+ */
+
+static void _checkpoint_start(const uint32_t magic, const nvmCheckpointState_t *state)
+{
+    nvm.pending.magic = magic;
+    nvm.pending.sequence = nvm.checkpoint.sequence + 1;
+    nvm.pending.state = *state;
+    nvm.pending.crc = _crc32(0xFFFFFFFF, &nvm.pending.state, sizeof(nvm.pending.state));
+    if (nvm.checkpoint_address + sizeof(nvmCheckpoint_t) > NVM_SECTOR_SIZE) {
+        nvm.checkpoint_erase = true;
+        return;
+    }
+    nvm.checkpoint_written = NVM_CHECKPOINT_HEADER;     // the state goes first, the header last
+}
+
+bool persistence_checkpoint_busy() { return (nvm.checkpoint_written != 0) || nvm.checkpoint_erase; }
+
+void persistence_checkpoint_write(const nvmCheckpointState_t *state)
+{
+    if (!nvm.enabled || persistence_checkpoint_busy()) {
+        return;
+    }
+    _checkpoint_start(NVM_CHECKPOINT_MAGIC, state);
+}
+
+void persistence_checkpoint_step()
+{
+    if (nvm.checkpoint_erase) {
+        nvm.checkpoint_sector ^= 1;
+        nvm.checkpoint_address = 0;
+        _flash_erase(NVM_CHECKPOINT_SECTOR + nvm.checkpoint_sector);
+        nvm.checkpoint_erase = false;
+        nvm.checkpoint_written = NVM_CHECKPOINT_HEADER;
+        return;
+    }
+    if (nvm.checkpoint_written == 0) {
+        return;
+    }
+    uint32_t address = (NVM_CHECKPOINT_SECTOR + nvm.checkpoint_sector) * NVM_SECTOR_SIZE + nvm.checkpoint_address;
+    if (nvm.checkpoint_written < sizeof(nvmCheckpoint_t)) {
+        uint16_t len = sizeof(nvmCheckpoint_t) - nvm.checkpoint_written;
+        if (len > NVM_CHECKPOINT_CHUNK) {
+            len = NVM_CHECKPOINT_CHUNK;
+        }
+        _flash_program(address + nvm.checkpoint_written, (const uint8_t *)&nvm.pending + nvm.checkpoint_written, len);
+        nvm.checkpoint_written += len;
+        return;
+    }
+    _flash_program(address, &nvm.pending, NVM_CHECKPOINT_HEADER);
+    nvm.checkpoint = nvm.pending;
+    nvm.checkpoint_valid = (nvm.pending.magic == NVM_CHECKPOINT_MAGIC);
+    nvm.checkpoint_address += sizeof(nvmCheckpoint_t);
+    nvm.checkpoint_written = 0;
+}
+
+const nvmCheckpointState_t *persistence_checkpoint()
+{
+    return (nvm.checkpoint_valid ? &nvm.checkpoint.state : NULL);
+}
+
+void persistence_checkpoint_clear()
+{
+    if (persistence_checkpoint_busy() ? (nvm.pending.magic == NVM_CHECKPOINT_CLEARED) : !nvm.checkpoint_valid) {
+        return;                                         // already clear, or being cleared
+    }
+    nvm.checkpoint_valid = false;
+    if (nvm.checkpoint_written != 0) {                  // the dropped record keeps its slot
+        nvm.checkpoint_address += sizeof(nvmCheckpoint_t);
+        nvm.checkpoint_written = 0;
+    }
+    _checkpoint_start(NVM_CHECKPOINT_CLEARED, &nvm.checkpoint.state);
+}
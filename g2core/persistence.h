@@ -30,17 +30,111 @@
 
 #include "config.h"  // needed for nvObj_t definition
 
-#define NVM_VALUE_LEN 4       // NVM value length (float, fixed length)
-#define NVM_BASE_ADDR 0x0000  // base address of usable NVM
+/*
+ *  Persistence is an append-only log of {cfgArray index, value} records in flash.
+ *  The log fills one sector at a time. When a sector is full the live values are
+ *  compacted into the next sector in turn, so erases rotate over all of them (wear
+ *  leveling). At boot the newest sector is read in one sequential pass into a RAM
+ *  cache that reads are served from. Writes only update the cache; dirty values are
+ *  appended from cm_deferred_write_callback() when no cycle is running.
+ *
+ *  A boot image follows the log sectors: a raw copy of the config structs listed in
+ *  cfgImage[] (config_app.cpp), taken after a full config_init(). It is tagged with a
+ *  CRC of the persisted values it was built from, so any settings change since then
+ *  makes it stale and the next boot runs every SET function again and retakes it.
+ *
+ *  Two checkpoint sectors follow the image. They hold job checkpoints: the line the
+ *  runtime was on, where it was and the modal state and offsets it ran with (see
+ *  cm_deferred_write_callback() and {ckpt:}). Records are appended, and one that has been started is
+ *  programmed NVM_CHECKPOINT_CHUNK bytes per pass with its header last, so a record cut
+ *  off by power loss doesn't check and the one before it stands. When a sector is full
+ *  the other one is erased (a pass of its own) and takes over, so the newest complete
+ *  record always survives. The newest valid record is loaded at boot. Discarding the
+ *  checkpoint appends a cleared record the same way, so it outranks both sectors.
+ *
+ *  The flash is only emulated in the simulators (a file image of the sectors).
+ *  Other builds have no backend and every boot loads settings defaults as before.
+ */
+
+#ifndef NVM_FILE
+#define NVM_FILE "g2core.nvm"       // flash image used by the simulators
+#endif
+#define NVM_SECTORS 4               // sectors the log rotates through
+#define NVM_SECTOR_SIZE 16384       // bytes per sector - must hold a compacted copy of every persisted value
+#define NVM_INDEX_MAX 1536          // cfgArray indexes the cache can hold
+#define NVM_FLUSH_MAX 32            // records appended per callback pass
+#define NVM_MAGIC 0x564E3247        // "G2NV"
+#define NVM_IMAGE_SECTOR NVM_SECTORS // boot image sector follows the log sectors
+#define NVM_IMAGE_MAGIC 0x49433247  // "G2CI"
+#define NVM_CHECKPOINT_SECTOR (NVM_IMAGE_SECTOR + 1) // first of the 2 checkpoint sectors
+#define NVM_CHECKPOINT_MAGIC 0x50433247 // "G2CP"
+#define NVM_CHECKPOINT_CLEARED 0x58433247 // "G2CX" - record that discards the ones before it
+#define NVM_CHECKPOINT_CHUNK 32     // checkpoint bytes programmed per pass
+#define NVM_CHECKPOINT_MS 2000      // least time between checkpoints while a job runs
+
+typedef struct nvmSectorHeader {    // first record of every written sector
+    uint32_t magic;
+    uint32_t sequence;              // compaction count - the highest valid sector is the live one
+    float    fw_build;              // log is ignored if the firmware build...
+    uint16_t index_max;             // ...or the cfgArray size has changed
+    uint16_t check;
+} nvmSectorHeader_t;
+
+typedef struct nvmRecord {          // one persisted value; all 0xFF is unwritten flash
+    uint16_t index;                 // cfgArray index
+    uint8_t  is_int;                // value is value_int, otherwise value_flt
+    uint8_t  check;
+    uint32_t value;
+} nvmRecord_t;
+
+typedef struct nvmImageHeader {     // first bytes of the boot image sector
+    uint32_t magic;
+    float    fw_build;
+    uint16_t index_max;
+    uint16_t size;                  // bytes of region data following the header
+    uint32_t values_crc;            // CRC of the persisted values the image was taken with
+    uint32_t data_crc;              // CRC of the region data
+} nvmImageHeader_t;
+
+typedef struct nvmCheckpointState {    // machine state at a checkpoint - positions and offsets in mm
+    uint32_t linenum;               // runtime line number
+    float    position[AXES];        // runtime machine position
+    float    g92_offset[AXES];
+    float    tool_offset[AXES];
+    float    feed_rate;             // mm/min, as held in the Gcode model
+    uint8_t  coord_system;          // cmCoordSystem
+    uint8_t  units_mode;            // cmUnitsMode
+    uint8_t  distance_mode;         // cmDistanceMode
+    uint8_t  select_plane;          // cmCanonicalPlane
+    uint8_t  tool;
+    uint8_t  g92_offset_enable;
+} nvmCheckpointState_t;
+
+typedef struct nvmCheckpoint {      // one checkpoint record
+    uint32_t magic;                 // header - programmed last
+    uint32_t sequence;
+    uint32_t crc;                   // of the state
+    nvmCheckpointState_t state;
+} nvmCheckpoint_t;
 
 //**** persistence singleton ****
 
 typedef struct nvmSingleton {
-    uint16_t base_addr;     // NVM base address
-    uint16_t profile_base;  // NVM base address of current profile]
-    uint16_t address;
-    float    tmp_value;
-    int8_t   byte_array[NVM_VALUE_LEN];
+    bool     enabled;               // a flash backend is present
+    int8_t   sector;                // live sector, -1 if none yet
+    uint32_t sequence;              // sequence of the live sector
+    uint32_t address;               // next free record in the live sector
+    uint16_t dirty_count;           // cached values waiting to be written
+    uint32_t value[NVM_INDEX_MAX];  // cached values by index (float or int32 bits)
+    uint8_t  state[NVM_INDEX_MAX];  // NVM_VALID and NVM_DIRTY bits
+
+    bool     checkpoint_valid;      // checkpoint holds the newest complete record
+    uint8_t  checkpoint_sector;     // 0 or 1 - checkpoint sector being appended to
+    uint32_t checkpoint_address;    // next free record in that sector
+    uint16_t checkpoint_written;    // bytes of pending programmed so far, 0 if none is being written
+    bool     checkpoint_erase;      // pending must start in the other sector, after erasing it
+    nvmCheckpoint_t checkpoint;     // newest complete record
+    nvmCheckpoint_t pending;        // record being programmed
 } nvmSingleton_t;
 
 //**** persistence function prototypes ****
@@ -48,5 +142,14 @@ typedef struct nvmSingleton {
 void persistence_init(void);
 stat_t read_persistent_value(nvObj_t* nv);
 stat_t write_persistent_value(nvObj_t* nv);
+bool persistence_is_loaded(void);
+stat_t persistence_flush(void);
+bool persistence_load_image(const cfgImageRegion_t *regions, uint8_t count);
+void persistence_save_image(const cfgImageRegion_t *regions, uint8_t count);
+bool persistence_checkpoint_busy(void);
+void persistence_checkpoint_write(const nvmCheckpointState_t *state);
+void persistence_checkpoint_step(void);
+const nvmCheckpointState_t *persistence_checkpoint(void);
+void persistence_checkpoint_clear(void);
 
 #endif  // End of include guard: PERSISTENCE_H_ONCE
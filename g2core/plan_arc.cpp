@@ -30,6 +30,8 @@ static stat_t _compute_arc(const bool radius_f);
 static void _compute_arc_offsets_from_radius(void);
 static float _estimate_arc_time (float arc_time);
 static stat_t _test_arc_soft_limits(void);
+static bool _arc_is_native(void);
+static stat_t _queue_native_arc(void);
 
 /*****************************************************************************
  * Canonical Machining arc functions (arc prep for planning and runtime)
@@ -64,7 +66,11 @@ void cm_abort_arc(cmMachine_t *_cm)
  * cm_arc_callback() - generate an arc
  *
  *  cm_arc_cycle_callback() is called from the controller main loop. Each time it's called
- *  it queues as many arc segments (lines) as it can before it blocks, then returns.
+ *  it queues arc segments (lines) until the planner reaches its headroom, ARC_BATCH_SEGMENTS
+ *  have been queued, or ARC_BATCH_MS has elapsed, then returns. The planner only keeps
+ *  the queue topped up to its headroom, so a draining queue is refilled several segments
+ *  per pass while the tasks ahead of this one (reports, control messages) still run on
+ *  every pass of a long arc or helix.
  */
 
 stat_t cm_arc_callback(cmMachine_t *_cm)
@@ -72,22 +78,39 @@ stat_t cm_arc_callback(cmMachine_t *_cm)
     if (_cm->arc.run_state == BLOCK_INACTIVE) {
         return (STAT_NOOP);
     }
-    if (mp_planner_is_full(mp)) {
-        return (STAT_EAGAIN);
-    }
-    _cm->arc.theta += _cm->arc.segment_theta;
-    _cm->arc.gm.target[_cm->arc.plane_axis_0] = _cm->arc.center_0 + sin(_cm->arc.theta) * _cm->arc.radius;
-    _cm->arc.gm.target[_cm->arc.plane_axis_1] = _cm->arc.center_1 + cos(_cm->arc.theta) * _cm->arc.radius;
-    _cm->arc.gm.target[_cm->arc.linear_axis] += _cm->arc.segment_linear_travel;
+    uint32_t batch_start = SysTickTimer_getValue();
+
+    for (uint8_t segments = 0; segments < ARC_BATCH_SEGMENTS; segments++) {
+        if (mp_planner_is_full(mp)) {
+            break;
+        }
+        // Rotate the center offset by one segment angle. Every ARC_CORRECTION_SEGMENTS, and
+        // on the last segment, recompute it exactly so rotation rounding cannot accumulate.
+        _cm->arc.theta += _cm->arc.segment_theta;
+        if ((_cm->arc.segment_count == 1) || ((_cm->arc.segment_count % ARC_CORRECTION_SEGMENTS) == 0)) {
+            _cm->arc.offset_0 = sin(_cm->arc.theta) * _cm->arc.radius;
+            _cm->arc.offset_1 = cos(_cm->arc.theta) * _cm->arc.radius;
+        } else {
+            float offset_0 = _cm->arc.offset_0;
+            _cm->arc.offset_0 = offset_0 * _cm->arc.segment_cos + _cm->arc.offset_1 * _cm->arc.segment_sin;
+            _cm->arc.offset_1 = _cm->arc.offset_1 * _cm->arc.segment_cos - offset_0 * _cm->arc.segment_sin;
+        }
+        _cm->arc.gm.target[_cm->arc.plane_axis_0] = _cm->arc.center_0 + _cm->arc.offset_0;
+        _cm->arc.gm.target[_cm->arc.plane_axis_1] = _cm->arc.center_1 + _cm->arc.offset_1;
+        _cm->arc.gm.target[_cm->arc.linear_axis] += _cm->arc.segment_linear_travel;
 
-    mp_aline(&(_cm->arc.gm));                            // run the line
-    copy_vector(_cm->arc.position, _cm->arc.gm.target);   // update arc current position
+        mp_aline(&(_cm->arc.gm));                            // run the line
+        copy_vector(_cm->arc.position, _cm->arc.gm.target);   // update arc current position
 
-    if (--(_cm->arc.segment_count) > 0) {
-        return (STAT_EAGAIN);
+        if (--(_cm->arc.segment_count) == 0) {
+            _cm->arc.run_state = BLOCK_INACTIVE;
+            return (STAT_OK);
+        }
+        if ((SysTickTimer_getValue() - batch_start) >= ARC_BATCH_MS) {
+            break;
+        }
     }
-    _cm->arc.run_state = BLOCK_INACTIVE;
-    return (STAT_OK);
+    return (STAT_EAGAIN);
 }
 
 /*
@@ -251,11 +274,81 @@ stat_t cm_arc_feed(const float target[], const bool target_f[],     // target en
     }
 
     cm_cycle_start();                                       // if not already started
+    if (_arc_is_native()) {
+        return (_queue_native_arc());                       // one planner block - no callback needed
+    }
+    if (cm->arc.gm.feed_rate_mode == INVERSE_TIME_MODE) {
+        cm->arc.gm.feed_rate /= cm->arc.segments;           // inverse time applies to each segment
+    }
     cm->arc.run_state = BLOCK_ACTIVE;                       // enable arc to be run from the callback
     cm_update_model_position();
     return (STAT_OK);
 }
 
+/*
+ * _arc_is_native() - true if the arc can be queued as a single planner block
+ *
+ *  A native arc block is interpolated in the arc plane and along the linear axis only,
+ *  in planner coordinates. Arcs that also move other axes, or that would have to pass
+ *  through a non-identity rotation matrix (tramming), are spooled out as lines.
+ */
+
+static bool _arc_is_native()
+{
+#if ARC_NATIVE_BLOCKS == true
+    if (!cm->rotation_identity) {
+        return (false);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if ((axis == cm->arc.plane_axis_0) || (axis == cm->arc.plane_axis_1) || (axis == cm->arc.linear_axis)) {
+            continue;
+        }
+        if (fp_NE(cm->arc.gm.target[axis], cm->arc.position[axis])) {
+            return (false);
+        }
+    }
+    return (true);
+#else
+    return (false);
+#endif
+}
+
+/*
+ * _queue_native_arc() - send the arc to the planner as one block (see mp_arc())
+ */
+
+static stat_t _queue_native_arc()
+{
+    mpPath_t path;
+
+    path.type = PATH_ARC;
+    path.plane_axis_0 = cm->arc.plane_axis_0;
+    path.plane_axis_1 = cm->arc.plane_axis_1;
+    path.linear_axis = cm->arc.linear_axis;
+    path.length = cm->arc.length;
+    path.center_0 = cm->arc.center_0;
+    path.center_1 = cm->arc.center_1;
+    path.radius = cm->arc.radius;
+    path.radius_travel = hypotf(cm->gm.target[cm->arc.plane_axis_0] - cm->arc.center_0,
+                                cm->gm.target[cm->arc.plane_axis_1] - cm->arc.center_1) - cm->arc.radius;
+    path.theta = cm->arc.theta;
+    path.angular_travel = cm->arc.angular_travel;
+    path.linear_position = cm->arc.position[cm->arc.linear_axis];
+    path.linear_travel = cm->arc.linear_travel;
+
+    cm->arc.gm.target[cm->arc.linear_axis] = cm->gm.target[cm->arc.linear_axis];   // undo the segment setup
+    stat_t status = mp_arc(&(cm->arc.gm), &path);
+    cm_update_model_position();
+
+    if (status == STAT_MINIMUM_LENGTH_MOVE) {               // same handling as cm_straight_feed()
+        if (!mp_has_runnable_buffer(mp)) {
+            cm_cycle_end();
+        }
+        status = STAT_OK;
+    }
+    return (status);
+}
+
 /*
  * _compute_arc() - compute arc from I and J (arc center point)
  *
@@ -342,21 +435,32 @@ static stat_t _compute_arc(const bool radius_f)
 
     // Find the minimum number of segments that meet accuracy and time constraints...
     // Note: removed segment_length test as segment_time accounts for this (build 083.37)
+    //
+    // Chordal accuracy is set by the planar sweep only: a segment of angle t deviates from
+    // the arc by r * (1 - cos(t/2)), so the largest angle holding the chordal tolerance is
+    // 2 * acos(1 - tol/r). Helix depth adds no chordal error and does not add segments, and
+    // large radius arcs need far fewer segments than a fixed density would give them.
+    // The time constraint (from feed rate and axis limits) caps the count from above.
     float arc_time=0;
-    float segments_for_minimum_time = _estimate_arc_time(arc_time) * (MICROSECONDS_PER_MINUTE / MIN_ARC_SEGMENT_USEC);
-    float segments_for_chordal_accuracy = cm->arc.length / sqrt(4*cm->chordal_tolerance * (2 * cm->arc.radius - cm->chordal_tolerance));
-    cm->arc.segments = floor(min(segments_for_chordal_accuracy, segments_for_minimum_time));
+    float segments_for_minimum_time = floor(_estimate_arc_time(arc_time) * (MICROSECONDS_PER_MINUTE / MIN_ARC_SEGMENT_USEC));
+    float segments_for_chordal_accuracy = 1;
+    if (cm->chordal_tolerance < cm->arc.radius) {
+        float segment_theta_max = 2 * acos(1 - cm->chordal_tolerance / cm->arc.radius);
+        segments_for_chordal_accuracy = ceil(fabs(cm->arc.angular_travel) / segment_theta_max);
+    }
+    cm->arc.segments = min(segments_for_chordal_accuracy, segments_for_minimum_time);
     cm->arc.segments = max(cm->arc.segments, (float)1.0);        //...but is at least 1 segment
 
-    if (cm->arc.gm.feed_rate_mode == INVERSE_TIME_MODE) {
-        cm->arc.gm.feed_rate /= cm->arc.segments;
-    }
     // setup the rest of the arc parameters
     cm->arc.segment_count = (int32_t)cm->arc.segments;
     cm->arc.segment_theta = cm->arc.angular_travel / cm->arc.segments;
     cm->arc.segment_linear_travel = cm->arc.linear_travel / cm->arc.segments;
     cm->arc.center_0 = cm->arc.position[cm->arc.plane_axis_0] - sin(cm->arc.theta) * cm->arc.radius;
     cm->arc.center_1 = cm->arc.position[cm->arc.plane_axis_1] - cos(cm->arc.theta) * cm->arc.radius;
+    cm->arc.segment_sin = sin(cm->arc.segment_theta);
+    cm->arc.segment_cos = cos(cm->arc.segment_theta);
+    cm->arc.offset_0 = cm->arc.position[cm->arc.plane_axis_0] - cm->arc.center_0;
+    cm->arc.offset_1 = cm->arc.position[cm->arc.plane_axis_1] - cm->arc.center_1;
     cm->arc.gm.target[cm->arc.linear_axis] = cm->arc.position[cm->arc.linear_axis];    // initialize the linear target
     return (STAT_OK);
 }
@@ -508,87 +612,52 @@ static float _estimate_arc_time (float arc_time)
 /*
  * _test_arc_soft_limits() - return error code if soft limit is exceeded
  *
- *  Test if arc extends beyond arc plane boundaries set in soft limits.
- *
- *  The arc starting position (P) and target (T) define 2 points that divide the
- *  arc plane into 9 rectangles. The center of the arc is (C). P and T define the
- *  endpoints of two possible arcs; one that is less than or equal to 180 degrees (acute)
- *  and one that is greater than 180 degrees (obtuse), depending on the location of (C).
- *
- *  -------------------------------  plane boundaries in X and Y
- *  |         |         |         |
- *  |    1    |    2    |    3    |
- *  |                   |         |
- *  --------- P -------------------
- *  |                   |         |
- *  |    4    |    5    |    6    |
- *  |         |                   |
- *  ------------------- T ---------
- *  |        C|                   |  C shows one of many possible center locations
- *  |    7    |    8    |    9    |
- *  |         |         |         |
- *  -------------------------------
- *
- *  C will fall along a diagonal bisecting 7, 5 and 3, but there is some tolerance in the
- *  circle algorithm that allows C to deviate from the centerline slightly. As the centerline
- *  approaches the line connecting S and T the acute arcs will be "above" S and T in sections
- *  5 or 3, and the obtuse arcs will be "below" in sections 5 or 7. But it's simpler, because
- *  we know that the arc is > 180 degrees (obtuse) if the angular travel value is > pi.
- *
- *  The example below only tests the X axis (0 axis), but testing the other axis is similar
- *
- *    (1) If Cx <= Px and arc is acute; no test is needed
+ *  Test the arc's bounding box against the active soft limit set (see cm_update_soft_limits()).
  *
- *    (2) If Cx <= Px and arc is obtuse; test if the radius is greater than
- *          the distance from Cx to the negative X boundary
+ *  The box starts as the span of the arc starting position (arc.position) and ending position
+ *  (arc.gm.target), which covers the linear (helix) axis and any non-plane axes. In the arc
+ *  plane it is widened to the circle's extreme in each direction the arc sweeps through.
+ *  Theta is measured from the positive axis 1 direction (offset_0 = sin(theta) * radius,
+ *  offset_1 = cos(theta) * radius), so the extremes fall at theta = 0 (+axis 1), pi/2 (+axis 0),
+ *  pi (-axis 1) and 3pi/2 (-axis 0). An arc of 2pi or more reaches all four.
  *
- *    (3) If Px < Cx < Tx and arc is acute; test if the radius is greater than
- *          the distance from Cx to the positive X boundary
- *
- *    (4) If Px < Cx < Tx and arc is obtuse; test if the radius is greater than
- *          the distance from Cx to the positive X boundary
- *
- *  The arc plane is defined by 0 and 1 depending on G17/G18/G19 plane selected,
- *  corresponding to arc planes XY, XZ, YZ, respectively.
+ *  The segments are chords inside the circle, so the box is never smaller than the path run.
  *
  *  Must be called with all the following set in the arc struct
- *    -    arc starting position (arc.position)
+ *    - arc starting position (arc.position)
  *    - arc ending position (arc.gm.target)
  *    - arc center (arc.center_0, arc.center_1)
  *    - arc.radius (arc.radius)
- *    - arc angular travel in radians (arc.angular_travel)
- *    - max and min travel in axis 0 and axis 1 (in cm struct)
+ *    - arc starting angle and angular travel in radians (arc.theta, arc.angular_travel)
  */
-/*
-static stat_t _test_arc_soft_limit_plane_axis(float center, uint8_t plane_axis)
+static stat_t _test_arc_soft_limits()
 {
-    if (center <= arc.position[plane_axis]) {
-        if (arc.angular_travel < M_PI) {                            // case (1)
-            return (STAT_OK);
-        }
-        if ((center - arc.radius) < cm->a[plane_axis].travel_min) {    // case (2)
-            return (STAT_SOFT_LIMIT_EXCEEDED);
-        }
+    if ((cm->soft_limit_enable != true) || (cm->soft_limit_count == 0)) {
+        return (STAT_OK);
     }
-    if ((center + arc.radius) > cm->a[plane_axis].travel_max) {        // cases (3) and (4)
-        return (STAT_SOFT_LIMIT_EXCEEDED);
+    float box_min[AXES];
+    float box_max[AXES];
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        box_min[axis] = min(cm->arc.position[axis], cm->arc.gm.target[axis]);
+        box_max[axis] = max(cm->arc.position[axis], cm->arc.gm.target[axis]);
     }
-    return(STAT_OK);
-}
-*/
-static stat_t _test_arc_soft_limits()
-{
-/*
-    if (cm->soft_limit_enable == true) {
 
-        // Test if target falls outside boundaries. This is a 3 dimensional test
-        // so it also checks the linear axis of the arc (helix axis)
-        ritorno(cm_test_soft_limits(arc.gm.target));
+    float sweep = fabs(cm->arc.angular_travel);
+    float start = cm->arc.theta + min(cm->arc.angular_travel, (float)0.0);   // low end of the swept angle
+    float radius = fabs(cm->arc.radius);
 
-        // test arc extents
-        ritorno(_test_arc_soft_limit_plane_axis(arc.center_0, arc.plane_axis_0));
-        ritorno(_test_arc_soft_limit_plane_axis(arc.center_1, arc.plane_axis_1));
+    for (uint8_t quadrant = 0; quadrant < 4; quadrant++) {
+        if (sweep < 2*M_PI) {
+            float delta = fmod(quadrant * (M_PI/2) - start, 2*M_PI);
+            if (delta < 0) { delta += 2*M_PI; }
+            if (delta > sweep) { continue; }                                // extreme not reached
+        }
+        switch (quadrant) {
+            case 0: { box_max[cm->arc.plane_axis_1] = max(box_max[cm->arc.plane_axis_1], cm->arc.center_1 + radius); break; }
+            case 1: { box_max[cm->arc.plane_axis_0] = max(box_max[cm->arc.plane_axis_0], cm->arc.center_0 + radius); break; }
+            case 2: { box_min[cm->arc.plane_axis_1] = min(box_min[cm->arc.plane_axis_1], cm->arc.center_1 - radius); break; }
+            case 3: { box_min[cm->arc.plane_axis_0] = min(box_min[cm->arc.plane_axis_0], cm->arc.center_0 - radius); break; }
+        }
     }
-*/
-    return(STAT_OK);
+    return (cm_check_soft_limits(box_min, box_max));
 }
@@ -23,6 +23,14 @@
 #define MIN_ARC_RADIUS ((float)0.1)             // min radius that can be executed
 #define MIN_ARC_SEGMENT_LENGTH ((float)0.05)    // Arc segment size (mm).(0.03)
 #define MIN_ARC_SEGMENT_USEC ((float)10000)     // minimum arc segment time
+#define ARC_CORRECTION_SEGMENTS 16              // segments between exact sin/cos recomputes of the incremental rotation
+
+#ifndef ARC_BATCH_SEGMENTS
+#define ARC_BATCH_SEGMENTS 8                    // max arc segments queued in one controller pass (1 = no batching)
+#endif
+#ifndef ARC_BATCH_MS
+#define ARC_BATCH_MS 1                          // time budget for a batch (ms)
+#endif
 
 // Arc radius tests. See http://linuxcnc.org/docs/html/gcode/gcode.html#sec:G2-G3-Arc
 //#define ARC_RADIUS_ERROR_MAX ((float)0.5)     // max allowable mm between start and end radius
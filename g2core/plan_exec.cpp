@@ -36,15 +36,28 @@
 #include "report.h"
 #include "util.h"
 #include "spindle.h"
+#include "shaper.h"
+#include "thc.h"
 #include "xio.h" // DIAGNOSTIC
+#include "profile.h"
 
 // 执行例程（注意：这些都是从LO中断调用的）
 static stat_t _exec_aline_head(mpBuf_t *bf); //传递bf因为body可能需要它，它可能会调用body
 static stat_t _exec_aline_body(mpBuf_t *bf); //传递bf，以便在出口速度上升时身体可以自我伸展。
 static stat_t _exec_aline_tail(mpBuf_t *bf);
 static stat_t _exec_aline_segment(void);
-static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b);
+static stat_t _exec_aline_segment_steps(const float steps[]);
+static stat_t _exec_aline_table(void);
+static stat_t _exec_aline_settle(void);
+static void _exec_aline_sync_start(mpBuf_t *bf);
+static stat_t _exec_aline_sync(void);
+static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b, const float entry_velocity);
+static void _exec_aline_segment_period(void);
+static float _exec_aline_segments(const float section_time, const float segment_usec);
 static stat_t _exec_aline_feedhold(mpBuf_t *bf);
+static void _exec_path_point(const mpPath_t *p, const float end[], const float remaining, float target[]);
+static void _exec_aline_masks(void);
+static void _exec_table_start(mpBuf_t *bf);
 
 static void _init_forward_diffs(float v_0, float v_1);
 
@@ -163,15 +176,18 @@ static void _init_forward_diffs(float v_0, float v_1);
  *传入将与计划块“链接”的bf缓冲区
  * exec_aline（）隐式链接块和缓冲区
  *
- *请注意，一次只能进行一次PLANNED移动。
- *这是为了帮助同步mr-> p指向下一个计划的mr-> bf
- * mr-> p仅在mp.r = mr-> p之后在mp_exec_aline（）中前进。
- *此代码对齐exec_aline（）的缓冲区和块。
+ *  Moves are planned into the runtime block ring at mr->p, one per call, in queue order.
+ *  mp_forward_plan() keeps asking for the next one until MR_PLAN_AHEAD_MS of moves are
+ *  planned ahead or the ring is full (mr->p reaches mr->r). The Nth FULLY_PLANNED move
+ *  past the run buffer is in the Nth block past mr->r; exec_aline() relies on this.
+ *  A short move locks only a few milliseconds of the queue, so moves of a few steps
+ *  each no longer leave the exec waiting on a forward plan for every one of them.
  */
 static stat_t _plan_aline(mpBuf_t *bf, float entry_velocity)
 {
     mpBlockRuntimeBuf_t *block = mr->p;            // 设置一个本地计划块，这样指针就不会改变
     mp_calculate_ramps(block, bf, entry_velocity); // 计算梯形状斜坡参数用于块
+    mr->p = block->nx;                             // the next move is planned into the next block
 
     debug_trap_if_true((block->exit_velocity > block->cruise_velocity),
                        "_plan_line() exit velocity > cruise velocity after calculate_ramps()");
@@ -179,6 +195,7 @@ static stat_t _plan_aline(mpBuf_t *bf, float entry_velocity)
     debug_trap_if_true((block->head_length < 0.00001 && block->body_length < 0.00001 && block->tail_length < 0.00001),
                        "_plan_line() zero or negative length block after calculate_ramps()");
 
+    mp_time_recount(bf);                        // the ramps set the final block_time
     bf->buffer_state = MP_BUFFER_FULLY_PLANNED; //...here
     bf->plannable = false;
     return (STAT_OK); // report that we planned something...
@@ -213,9 +230,11 @@ stat_t mp_forward_plan()
 
     // bf points to a command block; start cases 1f, 1g, 1h, 1i, 1j, 1k, 2c, 2d, 2e, 2h, 2i, 2j
     bool planned_something = false;
+    mpBlockRuntimeBuf_t *planned = mr->r->nx; // runtime block of the first move past the run buffer
+    float ahead_time = 0;                     // minutes of moves already planned ahead
 
-    if (bf->block_type != BLOCK_TYPE_ALINE)
-    { // meaning it's a COMMAND
+    while (true)
+    {
         while (bf->block_type >= BLOCK_TYPE_COMMAND)
         {
             if (bf->buffer_state == MP_BUFFER_BACK_PLANNED)
@@ -225,22 +244,39 @@ stat_t mp_forward_plan()
             }
             bf = bf->nx;
         }
-        // Note: bf now points to the first non-command buffer past the command(s)
-        if ((bf->block_type == BLOCK_TYPE_ALINE) && (bf->buffer_state > MP_BUFFER_BACK_PLANNED))
-        {                                          // case 1i
-            entry_velocity = mr->r->exit_velocity; // set entry_velocity for Note 1a
+        // bf will always be on a non-command at this point - either a move or empty buffer
+        if (bf->block_type != BLOCK_TYPE_ALINE)
+        {
+            break;
+        }
+
+        // walk the moves that are already planned, following them through the runtime block ring
+        if (bf->buffer_state == MP_BUFFER_FULLY_PLANNED)
+        {
+            if (planned == mr->p)
+            {
+                debug_trap("mp_forward_plan() more planned moves than runtime blocks");
+                break;
+            }
+            entry_velocity = planned->exit_velocity; // the next move enters at this one's exit
+            ahead_time += bf->block_time;
+            planned = planned->nx;
+            bf = bf->nx;
+            continue;
         }
-    }
-    // bf will always be on a non-command at this point - either a move or empty buffer
 
-    // process move
-    if (bf->block_type == BLOCK_TYPE_ALINE)
-    { // do cases 1a - 1e; finish cases 1f - 1k
-        if (bf->buffer_state == MP_BUFFER_BACK_PLANNED)
+        // plan the next move if the ring has a free block and not enough is planned ahead yet
+        if ((bf->buffer_state == MP_BUFFER_BACK_PLANNED) && (mr->p != mr->r) &&
+            (ahead_time < (MR_PLAN_AHEAD_MS / 60000)))
         { // do 1a; finish 1f, 1j, 2d, 2i
             _plan_aline(bf, entry_velocity);
             planned_something = true;
+            if (mr->p != mr->r)
+            {
+                st_request_forward_plan(); // come back for the move after this one
+            }
         }
+        break;
     }
     return (planned_something ? STAT_OK : STAT_NOOP);
 }
@@ -252,7 +288,7 @@ stat_t mp_forward_plan()
  *  管理运行缓冲区和其他详细信息
  */
 
-stat_t mp_exec_move()
+RAMFUNC stat_t mp_exec_move()
 {
     mpBuf_t *bf;
 
@@ -267,12 +303,20 @@ stat_t mp_exec_move()
     if (mr->out_of_band_dwell_flag) //有条件地执行带外停顿
     {
         mr->out_of_band_dwell_flag = false;
-        st_prep_out_of_band_dwell(mr->out_of_band_dwell_seconds * 1000000);
+        st_prep_out_of_band_dwell(mr->out_of_band_dwell_seconds * 1000000, mr->out_of_band_dwell_release);
         return (STAT_OK);
     }
 
+    // Play the input shaper's settle segments before anything that doesn't continue the motion
+    bf = mp_get_run_buffer();
+    if (shaper_settling() &&
+        ((bf == NULL) || (bf->block_type != BLOCK_TYPE_ALINE) || (cm->hold_state >= FEEDHOLD_MOTION_STOPPING)))
+    {
+        return (_exec_aline_settle());
+    }
+
     // 获取NULL缓冲区意味着队列中没有运行任何东西 - 这没关系
-    if ((bf = mp_get_run_buffer()) == NULL) //bf=mp->q.r
+    if (bf == NULL) //bf=mp->q.r
     {
         st_prep_null();
         return (STAT_NOOP);
@@ -328,11 +372,11 @@ stat_t mp_exec_move()
             st_request_forward_plan(); //请求前进计划 fwd_plan_timer.setInterruptPending();
         }
     }
-    if (bf->bf_func == NULL)
+    if (bf->cold->bf_func == NULL)
     {
         return (cm_panic(STAT_INTERNAL_ERROR, "mp_exec_move()")); // 永远不应该到这里来
     }
-    return (bf->bf_func(bf)); // 在planner缓冲区中运行move回调
+    return (bf->cold->bf_func(bf)); // 在planner缓冲区中运行move回调
 }
 
 /*************************************************************************/
@@ -389,8 +433,8 @@ stat_t mp_exec_move()
 /* Synchronization of run BUFFER and run BLOCK
  *
  * Note first: mp_exec_aline() makes a huge assumption: When it comes time to get a 
- *  new run block (mr->r) it assumes the planner block (mr->p) has been fully planned 
- *  via the JIT forward planning and is ready for use as the new run block.
+ *  new run block (mr->r) it assumes the next block in the ring (mr->r->nx) has been fully
+ *  planned via the JIT forward planning and is ready for use as the new run block.
  *
  * The runtime uses 2 structures for the current move or commend, the run BUFFER 
  *  from the planner queue (mb.r, aka bf), and the run BLOCK from the runtime 
@@ -399,9 +443,10 @@ stat_t mp_exec_move()
  *  See plan_zoid.cpp / mp_calculate_ramps() for more details
  *
  * When mp_exec_aline() needs to grab a new planner buffer for a new move or command 
- *  (i.e. block state is inactive) it swaps (rolls) the run and planner BLOCKS so that
- *  mr->p (planner block) is now the mr->r (run block), and the old mr->r block becomes 
- *  available for planning; it becomes mr->p block.
+ *  (i.e. block state is inactive) it rolls the ring of run BLOCKS so that mr->r->nx
+ *  (the oldest planned block) is now the mr->r (run block), and the old mr->r block
+ *  becomes available for planning. Forward planning fills the ring at mr->p, up to
+ *  MR_BLOCKS-1 moves ahead of the run block (see mp_forward_plan()).
  *
  * At the same time, it's when finished with its current run buffer (mb.r), it has already 
  *  advanced to the next buffer. mp_exec_move() does this at the end of previous move.
@@ -463,24 +508,30 @@ stat_t mp_exec_aline(mpBuf_t *bf)
                            "mp_exec_aline() mr->exit_velocity > mr->r->cruise_velocity");
 
         // Start a new move by setting up the runtime singleton (mr)
-        memcpy(&mr->gm, &(bf->gm), sizeof(GCodeState_t)); // copy in the gcode model state
+        mp_get_block_gm(bf, &mr->gm);                     // rebuild the gcode model state
+        clear_vector(mr->target_comp);
         bf->block_state = BLOCK_ACTIVE;                   // note that this buffer is running
         mr->block_state = BLOCK_INITIAL_ACTION;           // note the planner doesn't look at block_state
 
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-        // !!! THIS IS THE ONLY PLACE WHERE mr->r AND mr->p ARE ALLOWED TO BE CHANGED !!!
+        // !!! THIS IS THE ONLY PLACE WHERE mr->r IS ALLOWED TO BE CHANGED           !!!
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-        // Swap P and R blocks
-        mr->r = mr->p;     // we are now going to run the planning block
-        mr->p = mr->p->nx; // re-use the old running block as the new planning block
+        // Roll the ring: run the oldest planned block. The old run block is free for planning
+        mr->r = mr->r->nx;
 
         // Check to make sure no sections are less than MIN_SEGMENT_TIME & adjust if necessary
-        _exec_aline_normalize_block(mr->r);
+        _exec_aline_normalize_block(mr->r, mr->entry_velocity);
+
+        // Pick the segment time for this block from the measured exec headroom
+        _exec_aline_segment_period();
 
         // transfer move parameters from planner buffer to the runtime
         copy_vector(mr->unit, bf->unit);
-        copy_vector(mr->target, bf->gm.target);
+        copy_vector(mr->target, bf->cold->gm.target);
         copy_vector(mr->axis_flags, bf->axis_flags);
+        _exec_aline_masks();
+        memcpy(&mr->path, &bf->cold->path, sizeof(mpPath_t));
+        raster_start_block(&bf->cold->raster, mr->target, mr->unit, mr->gm.spindle_speed);
 
         mr->run_bf = bf;      // DIAGNOSTIC: points to running bf
         mr->plan_bf = bf->nx; // DIAGNOSTIC: points to next bf to forward plan
@@ -498,11 +549,29 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         }
 
         // generate the way points for position correction at section ends
-        for (uint8_t axis = 0; axis < AXES; axis++)
+        if (mr->path.type == PATH_ARC)
+        {
+            mr->path_remaining = bf->length;
+            mr->waypoint_remaining[SECTION_HEAD] = bf->length - mr->r->head_length;
+            mr->waypoint_remaining[SECTION_BODY] = mr->waypoint_remaining[SECTION_HEAD] - mr->r->body_length;
+            mr->waypoint_remaining[SECTION_TAIL] = 0;
+            _exec_path_point(&mr->path, mr->target, mr->waypoint_remaining[SECTION_HEAD], mr->waypoint[SECTION_HEAD]);
+            _exec_path_point(&mr->path, mr->target, mr->waypoint_remaining[SECTION_BODY], mr->waypoint[SECTION_BODY]);
+            copy_vector(mr->waypoint[SECTION_TAIL], mr->target);
+        }
+        else
         {
-            mr->waypoint[SECTION_HEAD][axis] = mr->position[axis] + mr->unit[axis] * mr->r->head_length;
-            mr->waypoint[SECTION_BODY][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length);
-            mr->waypoint[SECTION_TAIL][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length + mr->r->tail_length);
+            for (uint8_t axis = 0; axis < AXES; axis++)
+            {
+                mr->waypoint[SECTION_HEAD][axis] = mr->position[axis] + mr->unit[axis] * mr->r->head_length;
+                mr->waypoint[SECTION_BODY][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length);
+                mr->waypoint[SECTION_TAIL][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length + mr->r->tail_length);
+            }
+        }
+        _exec_table_start(bf); // play the block from a precomputed segment table if there is one
+        if (mp_is_spindle_sync(mr->gm.motion_mode))
+        {
+            _exec_aline_sync_start(bf); // G33, G33.1 follow the spindle instead
         }
     }
 
@@ -518,10 +587,14 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         }
         // STAT_OK terminates aline execution for this move
         // STAT_NOOP terminates execution and does not load another move
-        status = _exec_aline_feedhold(bf);
-        if ((status == STAT_OK) || (status == STAT_NOOP))
+        // A spindle synchronized block runs out - the hold is taken by the block after it
+        if (!mp_is_spindle_sync(mr->gm.motion_mode))
         {
-            return (status);
+            status = _exec_aline_feedhold(bf);
+            if ((status == STAT_OK) || (status == STAT_NOOP))
+            {
+                return (status);
+            }
         }
     }
 
@@ -531,7 +604,19 @@ stat_t mp_exec_aline(mpBuf_t *bf)
 
     //**** main dispatcher to process segments ***
     status = STAT_OK;
-    if (mr->section == SECTION_HEAD)
+    if ((mr->table != NULL) && (mr->section_state != SECTION_RUNNING))
+    {
+        mr->table = NULL; // a feedhold re-planned the block - work out the rest of it here
+    }
+    if (mp_is_spindle_sync(mr->gm.motion_mode))
+    {
+        status = _exec_aline_sync();
+    }
+    else if (mr->table != NULL)
+    {
+        status = _exec_aline_table();
+    }
+    else if (mr->section == SECTION_HEAD)
     {
         status = _exec_aline_head(bf);
     }
@@ -602,6 +687,10 @@ stat_t mp_exec_aline(mpBuf_t *bf)
 
         if (bf->block_state == BLOCK_ACTIVE)
         {
+            if (bf->cold->actions != 0)
+            { // inline actions run as the segment just prepped ends (see mp_queue_inline_action())
+                st_prep_actions(bf->cold->action_first, bf->cold->actions);
+            }
             if (mp_free_run_buffer())
             { // returns true of the buffer is empty
                 if (cm->hold_state == FEEDHOLD_OFF)
@@ -808,7 +897,7 @@ static stat_t _exec_aline_head(mpBuf_t *bf)
             mr->section = SECTION_BODY;
             return (_exec_aline_body(bf)); // skip ahead to the body generator
         }
-        mr->segments = ceil(uSec(mr->r->head_time) / NOM_SEGMENT_USEC); // # of segments for the section
+        mr->segments = _exec_aline_segments(mr->r->head_time, mr->segment_usec); // # of segments for the section
         mr->segment_count = (uint32_t)mr->segments;
         mr->segment_time = mr->r->head_time / mr->segments; // time to advance for each segment
 
@@ -816,6 +905,7 @@ static stat_t _exec_aline_head(mpBuf_t *bf)
         {
             // We will only have one segment, simply average the velocities
             mr->segment_velocity = mr->r->head_length / mr->segment_time;
+            mr->segment_ramp = (mr->r->cruise_velocity - mr->entry_velocity) / mr->segment_velocity;
         }
         else
         {
@@ -835,6 +925,12 @@ static stat_t _exec_aline_head(mpBuf_t *bf)
     {
         mr->segment_velocity += mr->forward_diff_5;
     }
+#if DDA_SEGMENT_RAMP == true
+    if ((mr->segment_count > 1) && (mr->segment_velocity > 0))
+    { // the next segment is one forward difference faster - about the change across this one
+        mr->segment_ramp = mr->forward_diff_5 / mr->segment_velocity;
+    }
+#endif
 
     if (_exec_aline_segment() == STAT_OK)
     { // set up for second half
@@ -871,9 +967,10 @@ static stat_t _exec_aline_body(mpBuf_t *bf)
             return (_exec_aline_tail(bf)); // skip ahead to tail generator
         }
         float body_time = mr->r->body_time;
-        mr->segments = ceil(uSec(body_time) / NOM_SEGMENT_USEC);
+        mr->segments = _exec_aline_segments(body_time, mr->segment_usec);
         mr->segment_time = body_time / mr->segments;
         mr->segment_velocity = mr->r->cruise_velocity;
+        mr->segment_ramp = 0;
         mr->segment_count = (uint32_t)mr->segments;
         if (mr->segment_time < MIN_SEGMENT_TIME)
         {
@@ -913,13 +1010,14 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
         {                     // Needed here as feedhold may have changed the block
             return (STAT_OK); // end the move
         }
-        mr->segments = ceil(uSec(mr->r->tail_time) / NOM_SEGMENT_USEC); // # of segments for the section
+        mr->segments = _exec_aline_segments(mr->r->tail_time, mr->segment_usec); // # of segments for the section
         mr->segment_count = (uint32_t)mr->segments;
         mr->segment_time = mr->r->tail_time / mr->segments; // time to advance for each segment
 
         if (mr->segment_count == 1)
         {
             mr->segment_velocity = mr->r->tail_length / mr->segment_time;
+            mr->segment_ramp = (mr->r->exit_velocity - mr->r->cruise_velocity) / mr->segment_velocity;
         }
         else
         {
@@ -939,6 +1037,12 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
     {
         mr->segment_velocity += mr->forward_diff_5;
     }
+#if DDA_SEGMENT_RAMP == true
+    if ((mr->segment_count > 1) && (mr->segment_velocity > 0))
+    { // the next segment is one forward difference faster - about the change across this one
+        mr->segment_ramp = mr->forward_diff_5 / mr->segment_velocity;
+    }
+#endif
 
     if (_exec_aline_segment() == STAT_OK)
     {
@@ -976,8 +1080,6 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
 
 static stat_t _exec_aline_segment()
 {
-    float travel_steps[MOTORS];
-
     // Set target position for the segment
     // If the segment ends on a section waypoint synchronize to the head, body or tail end
     // Otherwise if not at a section waypoint compute target from segment time and velocity
@@ -986,50 +1088,108 @@ static stat_t _exec_aline_segment()
     if ((--mr->segment_count == 0) && (cm->hold_state == FEEDHOLD_OFF))
     {
         copy_vector(mr->gm.target, mr->waypoint[mr->section]);
+        mr->path_remaining = mr->waypoint_remaining[mr->section];
+    }
+    else if (mr->path.type == PATH_ARC)
+    {
+        mr->path_remaining = max(mr->path_remaining - mr->segment_velocity * mr->segment_time, (float)0);
+        _exec_path_point(&mr->path, mr->target, mr->path_remaining, mr->gm.target);
     }
     else
     {
         float segment_length = mr->segment_velocity * mr->segment_time;
         // See https://en.wikipedia.org/wiki/Kahan_summation_algorithm
         // for the summation compensation description
-        for (uint8_t a = 0; a < AXES; a++)
+        for (uint16_t a = 0, axes = mr->axis_mask; axes; a++, axes >>= 1)
         {
-            float to_add = (mr->unit[a] * segment_length) - mr->gm.target_comp[a];
+            if (!(axes & 1))
+            {
+                continue; // unit is zero - the target doesn't move
+            }
+            float to_add = (mr->unit[a] * segment_length) - mr->target_comp[a];
             float target = mr->position[a] + to_add;
-            mr->gm.target_comp[a] = (target - mr->position[a]) - to_add;
+            mr->target_comp[a] = (target - mr->position[a]) - to_add;
             mr->gm.target[a] = target;
             // the above replaces this line:
             // mr->gm.target[a] = mr->position[a] + (mr->unit[a] * segment_length);
         }
     }
+    // Torch height control moves Z under the segment, outside the planner (see thc.h)
+    thc_segment(mr->segment_velocity, mr->r->cruise_velocity, mr->segment_time,
+                (mr->gm.motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE));
+    return (_exec_aline_segment_steps(NULL));
+}
+
+/*
+ * _exec_aline_segment_steps() - convert the segment target to steps and prep the stepper
+ *
+ *  steps[] is the target already converted by kinematics (segment tables), or NULL to
+ *  convert mr->gm.target here.
+ */
+
+static stat_t _exec_aline_segment_steps(const float steps[])
+{
+    float travel_steps[MOTORS] = {0};
+    uint8_t motors = mr->motor_mask | mr->motor_settle;
 
     // Convert target position to steps
     // Bucket-brigade the old target down the chain before getting the new target from kinematics
     //
-    // Very small travels of less than 0.01 step are truncated to zero. This is to correct a condition
-    // where a rounding error in kinematics could reverse the direction of a move in the extreme head or tail.
-    // Truncating the move contributes to positional error, but this is corrected by encoder feedback should
-    // it ever accumulate to more than one step.
+    // Very small travels of less than 0.01 step are not sent. This is to correct a condition where a
+    // rounding error in kinematics could reverse the direction of a move in the extreme head or tail.
+    // Positions are kept in fixed point (see MR_STEP_FIXED), so the travel held back stays in position_fixed
+    // and goes out with a later segment rather than being lost.
     //
     // NB: The direct manipulation of steps to compute travel_steps only works for Cartesian kinematics.
     //     Other kinematics may require transforming travel distance as opposed to simply subtracting steps.
 
-    for (uint8_t m = 0; m < MOTORS; m++)
+    for (uint8_t m = 0, bits = motors; bits; m++, bits >>= 1)
     {
-        mr->commanded_steps[m] = mr->position_steps[m]; // previous segment's position, delayed by 1 segment
-        mr->position_steps[m] = mr->target_steps[m];    // previous segment's target becomes position
+        if (!(bits & 1))
+        {
+            continue;
+        }
+        mr->commanded_steps[m] = mp_fixed_to_steps(mr->commanded_fixed[m]); // previous segment's position, delayed by 1 segment
+        mr->position_steps[m] = mp_fixed_to_steps(mr->position_fixed[m]);   // previous segment's target becomes position
         mr->encoder_steps[m] = en_read_encoder(m);      // get current encoder position (time aligns to commanded_steps)
-        mr->following_error[m] = mr->encoder_steps[m] - mr->commanded_steps[m];
+        mr->following_error[m] = mp_fixed_to_steps(mp_steps_to_fixed(mr->encoder_steps[m]) - mr->commanded_fixed[m]);
+    }
+    en_log_segment(mr->commanded_steps, mr->encoder_steps);
+    en_measure_segment(mr->segment_time, mr->segment_velocity);
+    float shaped[AXES];
+    if (shaper_segment(mr->position, mr->gm.target, mr->segment_time, shaped))
+    {
+        kn_inverse_kinematics(shaped, mr->target_steps); // input shaped target - segment table steps don't apply
+    }
+    else if (steps == NULL)
+    {
+        kn_inverse_kinematics(mr->gm.target, mr->target_steps); // now determine the target steps...
+    }
+    else
+    {
+        memcpy(mr->target_steps, steps, sizeof(mr->target_steps));
     }
-    kn_inverse_kinematics(mr->gm.target, mr->target_steps); // now determine the target steps...
 
-    for (uint8_t m = 0; m < MOTORS; m++)
+    for (uint8_t m = 0, bits = motors; bits; m++, bits >>= 1)
     { // and compute the distances to be traveled
-        travel_steps[m] = mr->target_steps[m] - mr->position_steps[m];
-        if (fabs(travel_steps[m]) < 0.01)
-        { // truncate very small moves to deal with rounding errors
-            travel_steps[m] = 0;
+        if (!(bits & 1))
+        {
+            continue;
         }
+        mr->target_fixed[m] = mp_steps_to_fixed(mr->target_steps[m]);
+        int64_t travel = mr->target_fixed[m] - mr->position_fixed[m];
+        if ((travel < MR_STEP_TRAVEL_MIN) && (travel > -MR_STEP_TRAVEL_MIN))
+        { // hold back very small moves to deal with rounding errors
+            travel = 0;
+        }
+        if ((mr->motor_settle & (1 << m)) && !shaper_settling() &&
+            (mr->commanded_fixed[m] == mr->position_fixed[m]) && (travel == 0))
+        {
+            mr->motor_settle &= ~(1 << m); // at rest - drop it until a block moves it again
+        }
+        mr->commanded_fixed[m] = mr->position_fixed[m];
+        mr->position_fixed[m] += travel;
+        travel_steps[m] = mp_fixed_to_steps(travel);
     }
 
     // Update the mb->run_time_remaining -- we know it's missing the current segment's time before it's loaded, that's ok.
@@ -1039,8 +1199,15 @@ static stat_t _exec_aline_segment()
         mp->run_time_remaining = 0.0;
     }
 
+    // Apply the block's spindle speed / laser power for this segment (S words ride on the move)
+    // Shaper settle segments (segment_velocity == 0) leave the spindle as the block left it
+    if (!raster_prep_segment(mr->position, mr->gm.target, mr->segment_time) && (mr->segment_velocity > 0))
+    {
+        spindle_speed_segment(mr->gm.spindle_speed, mr->segment_velocity, mr->r->cruise_velocity);
+    }
+
     // Call the stepper prep function
-    ritorno(st_prep_line(travel_steps, mr->following_error, mr->segment_time));
+    ritorno(st_prep_line(travel_steps, mr->following_error, mr->segment_time, mr->segment_ramp));
     copy_vector(mr->position, mr->gm.target); // update position from target
     if (mr->segment_count == 0)
     {
@@ -1049,13 +1216,680 @@ static stat_t _exec_aline_segment()
     return (STAT_EAGAIN); // this section still has more segments to run
 }
 
+/*
+ * _exec_aline_settle() - play a segment that holds the target while the input shaper settles
+ *
+ *  Called by mp_exec_move() once the motion has ended (see shaper.h). The shaped target is
+ *  still behind the last target, so the motors are stepped the rest of the way in nominal
+ *  segments. Returns STAT_OK so a feedhold or the next command runs when it's done.
+ */
+
+static stat_t _exec_aline_settle()
+{
+    copy_vector(mr->gm.target, mr->position);
+    mr->segment_time = NOM_SEGMENT_TIME;
+    mr->segment_velocity = 0;
+    mr->segment_ramp = 0;
+    mr->segment_count = 0;
+    return (_exec_aline_segment_steps(NULL));
+}
+
+/*
+ * _exec_aline_sync_start() - set up a spindle synchronized block (G33, G33.1)
+ * _exec_aline_sync()       - run a segment of it
+ *
+ *  The block's travel is geared to the spindle encoder rather than played from its
+ *  velocity profile. Each segment reads the encoder count and takes the travel the
+ *  spindle calls for - the pitch (P word) times the revolutions past the block's zero.
+ *  The axes are steered toward it along the line within the sync acceleration {spsa:}:
+ *  the spindle's velocity is fed forward, and a gap is closed no faster than it can be
+ *  braked out, so they catch up without overshooting. They brake to stop on the target.
+ *
+ *  A G33 holds still until the spindle passes the next whole revolution of the count,
+ *  which becomes its zero. A G33.1 tap-in is zeroed where it starts. Its tap-out carries
+ *  a negative pitch, keeps the tap-in's count, and is zeroed at the revolution where the
+ *  tap-in reached depth - so while the spindle coasts past it before reversing, the axis
+ *  follows it deeper, and comes back up the thread when it turns round.
+ */
+
+static int32_t _exec_sync_index()
+{
+    int32_t count = mr->sync_direction * spindle.encoder_count;
+    int32_t ppr = spindle.encoder_ppr;
+    return ((count >= 0) ? (count / ppr) : -((ppr - 1 - count) / ppr)); // floor(count / ppr)
+}
+
+static float _exec_sync_command(const float pitch)
+{
+    float revs = (float)(spindle.encoder_count - mr->sync_count0) / spindle.encoder_ppr;
+    return (pitch * (mr->sync_direction * revs - mr->sync_revs0));
+}
+
+static void _exec_aline_sync_start(mpBuf_t *bf)
+{
+    int8_t direction = (spindle.direction == SPINDLE_CCW) ? -1 : 1;
+    float pitch = fabs(mr->gm.P_word);
+
+    if (mr->gm.P_word < 0)
+    { // tap-out - the spindle has been reversed since the tap-in set these
+        mr->sync_revs0 = direction * mr->sync_direction * (mr->sync_revs0 + mr->sync_length / pitch);
+        mr->sync_started = true;
+    }
+    else
+    {
+        mr->sync_count0 = spindle.encoder_count;
+        mr->sync_revs0 = 0;
+        mr->sync_started = (mr->gm.motion_mode == MOTION_MODE_RIGID_TAP);
+    }
+    mr->sync_direction = direction;
+    mr->sync_index = _exec_sync_index();
+    mr->sync_command = mr->sync_started ? _exec_sync_command(pitch) : 0;
+    mr->sync_travel = 0;
+    mr->sync_velocity = 0;
+    mr->sync_length = bf->length;
+    mr->table = NULL;
+    bf->plannable = false;
+}
+
+static stat_t _exec_aline_sync()
+{
+    mr->segment_time = mr->segment_usec / MICROSECONDS_PER_MINUTE;
+    mr->segment_ramp = 0;
+    mr->segment_count = 1;
+
+    if (!mr->sync_started)
+    {
+        int32_t index = _exec_sync_index();
+        if (index <= mr->sync_index)
+        { // G33 waiting for the start revolution
+            mr->sync_index = index;
+            mr->segment_velocity = 0;
+            copy_vector(mr->gm.target, mr->position);
+            return (_exec_aline_segment_steps(NULL));
+        }
+        mr->sync_count0 = mr->sync_direction * index * spindle.encoder_ppr;
+        mr->sync_started = true;
+    }
+    float pitch = fabs(mr->gm.P_word);
+    float accel = spindle.sync_accel * 3600;                    // mm/s^2 to mm/min^2
+    float dt = mr->segment_time;
+
+    float command = _exec_sync_command(pitch);
+    float spindle_velocity = (command - mr->sync_command) / dt;
+    mr->sync_command = command;
+
+    float error = command - mr->sync_travel;
+    float closing = min((float)sqrt(2 * accel * fabs(error)), (float)fabs(error) / dt);
+    float velocity = spindle_velocity + ((error < 0) ? -closing : closing);
+    velocity = max(mr->sync_velocity - accel * dt, min(mr->sync_velocity + accel * dt, velocity));
+
+    // brake to stop on the target, and no further back than a block length behind the start
+    float remaining = mr->sync_length - mr->sync_travel;
+    velocity = min(velocity, (float)sqrt(2 * accel * remaining));
+    velocity = max(velocity, -(float)sqrt(2 * accel * max(mr->sync_length + mr->sync_travel, (float)0)));
+    mr->sync_velocity = velocity;
+
+    if ((velocity > 0) && (velocity * dt >= remaining))
+    {
+        mr->sync_travel = mr->sync_length;
+        mr->segment_count = 0;                                  // last segment
+        copy_vector(mr->gm.target, mr->target);
+    }
+    else
+    {
+        mr->sync_travel += velocity * dt;
+        for (uint16_t a = 0, axes = mr->axis_mask; axes; a++, axes >>= 1)
+        {
+            if (axes & 1)
+            {
+                mr->gm.target[a] = mr->target[a] - mr->unit[a] * (mr->sync_length - mr->sync_travel);
+            }
+        }
+    }
+    mr->segment_velocity = fabs(velocity);
+    return (_exec_aline_segment_steps(NULL));
+}
+
+/*********************************************************************************************
+ * _exec_aline_masks() - set the axes and motors the running block's segments work on
+ *
+ *  Segments update the target only on the block's axes, and do the step and encoder terms
+ *  only for motors that can move. A motor that stops moving at the end of a block still
+ *  has its commanded and position steps one or two segments behind, so it stays in the
+ *  segment loops (motor_settle) until they have caught up with its target, and for as long
+ *  as the input shaper is settling. An idle motor's following error is left at its last
+ *  value; correction only acts on motors that step.
+ */
+
+static void _exec_aline_masks()
+{
+    mr->axis_mask = 0;
+    for (uint8_t a = 0; a < AXES; a++)
+    {
+        if (mr->axis_flags[a])
+        {
+            mr->axis_mask |= (1 << a);
+        }
+    }
+    uint8_t motors = kn_active_motors(mr->axis_mask);
+    mr->motor_settle = (mr->motor_settle | mr->motor_mask) & ~motors;
+    mr->motor_mask = motors;
+}
+
+/*********************************************************************************************
+ * _exec_path_point() - position on an arc path at a remaining path length
+ *
+ *  The angle, radius and linear axis are interpolated by the fraction of the full path
+ *  travelled, so a block resumed after a feedhold (with a shorter bf->length) continues
+ *  on the same arc. Axes outside the arc hold the block's end position (they do not move).
+ */
+
+static void _exec_path_point(const mpPath_t *p, const float end[], const float remaining, float target[])
+{
+    float fraction = 1 - (remaining / p->length);
+    float theta = p->theta + p->angular_travel * fraction;
+    float radius = p->radius + p->radius_travel * fraction;
+
+    memcpy(target, end, sizeof(float) * AXES);          // not copy_vector(): these are pointers here
+    target[p->plane_axis_0] = p->center_0 + sin(theta) * radius;
+    target[p->plane_axis_1] = p->center_1 + cos(theta) * radius;
+    target[p->linear_axis] = p->linear_position + p->linear_travel * fraction;
+}
+
+/*
+ * mp_get_runtime_remaining_length() - path length left in the running block
+ *
+ *  Used when planning a feedhold and when a held block is set up to resume.
+ *  A line measures straight to its target; an arc uses the remaining path length.
+ */
+
+float mp_get_runtime_remaining_length()
+{
+    if (mr->path.type == PATH_ARC)
+    {
+        return (mr->path_remaining);
+    }
+    return (get_axis_vector_length(mr->position, mr->target));
+}
+
+/*
+ * mp_exit_hold_state() - start motion again after a feedhold
+ *
+ *  A hold leaves the run block to be forward planned from zero velocity, and the exec sets
+ *  it up while still held - it stops at the feedhold test in mp_exec_aline(). Forward
+ *  planning carries on through the hold as blocks arrive (see mp_plan_block_list()), so
+ *  the resume only has to ask the exec for the next segment. A run block still waiting
+ *  for its forward plan (a hold exited before it ran, or one whose actions ran in p2) has
+ *  it requested here instead, and the forward plan calls the exec.
+ *
+ *  Call with the hold cleared and the p1 planner active.
+ */
+
+void mp_exit_hold_state()
+{
+    mpBuf_t *bf = mp_get_run_buffer();
+    if ((bf != NULL) && (bf->buffer_state == MP_BUFFER_BACK_PLANNED))
+    {
+        st_request_forward_plan();
+        return;
+    }
+    st_request_exec_move();
+}
+
+/*********************************************************************************************
+ * SEGMENT TABLES (EXEC_SEGMENT_TABLE)
+ *
+ *  mp_exec_table_callback() runs from the main loop while a block is running. It takes the
+ *  next block, which is already fully planned, and works out all its segments as the exec
+ *  would: velocity, ramp, target, arc path length and the target in motor steps. The
+ *  segments go into one of two table slots. When the block starts, _exec_table_start()
+ *  looks for a table built from the same inputs (the key: buffer, ramps after
+ *  normalization, entry velocity, start and end position). If there is one the exec plays
+ *  it with _exec_aline_table(), which only copies an entry into the runtime and preps the
+ *  stepper. Otherwise the block is computed here as usual.
+ *
+ *  Only blocks of up to EXEC_TABLE_SEGMENTS segments are tabled, and the first block of a
+ *  run or one after a command block is always computed here. A table that doesn't match
+ *  the block (the planner or a feedhold changed it, or it was built while the block was
+ *  starting) is never played and is overwritten later. A feedhold that re-plans a playing
+ *  block drops the table and the rest of the block is computed here.
+ *
+ *  Slots go EMPTY -> FILLING (main loop) -> READY -> PLAYING (exec) -> EMPTY (exec, at the
+ *  start of the next block). The main loop claims a slot with interrupts held off.
+ */
+
+#if EXEC_SEGMENT_TABLE == true
+
+typedef enum {
+    TABLE_EMPTY = 0,                    // free to fill
+    TABLE_FILLING,                      // main loop is writing it
+    TABLE_READY,                        // waiting for its block to start
+    TABLE_PLAYING                       // the exec is playing it
+} mpTableState;
+
+typedef struct mpExecTableKey {         // inputs the table was worked out from
+    mpBuf_t *bf;                        // block the table is for
+    float length;                       // bf->length
+    float entry_velocity;
+    mpBlockRuntimeBuf_t block;          // ramps after _exec_aline_normalize_block()
+    float start[AXES];                  // position at the start of the block
+    float target[AXES];                 // block target
+} mpExecTableKey_t;
+
+typedef struct mpExecSegment {          // one segment, as _exec_aline_segment() leaves the runtime
+    float target[AXES];                 // segment end position
+    float steps[MOTORS];                // target in motor steps
+    float velocity;
+    float ramp;
+    float time;
+    float remaining;                    // PATH_ARC: path length left at the segment end
+    uint16_t count;                     // segments left in the section, this one included
+    uint8_t section;                    // moveSection
+} mpExecSegment_t;
+
+typedef struct mpExecTable {
+    volatile uint8_t state;             // mpTableState
+    mpExecTableKey_t key;
+    float segment_usec;                 // nominal segment time the table was built with
+    uint16_t segments;                  // entries in use
+    uint16_t next;                      // next entry to play
+    mpExecSegment_t seg[EXEC_TABLE_SEGMENTS];
+} mpExecTable_t;
+
+#define EXEC_TABLES 2
+static mpExecTable_t exec_table[EXEC_TABLES];
+
+static bool _exec_table_key_equal(const mpExecTableKey_t *a, const mpExecTableKey_t *b)
+{
+    const mpBlockRuntimeBuf_t *x = &a->block;
+    const mpBlockRuntimeBuf_t *y = &b->block;
+
+    if ((a->bf != b->bf) || (a->length != b->length) || (a->entry_velocity != b->entry_velocity) ||
+        (x->head_length != y->head_length) || (x->body_length != y->body_length) || (x->tail_length != y->tail_length) ||
+        (x->head_time != y->head_time) || (x->body_time != y->body_time) || (x->tail_time != y->tail_time) ||
+        (x->cruise_velocity != y->cruise_velocity) || (x->exit_velocity != y->exit_velocity))
+    {
+        return (false);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        if ((a->start[axis] != b->start[axis]) || (a->target[axis] != b->target[axis]))
+        {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+static void _exec_table_key(mpExecTableKey_t *key, mpBuf_t *bf, const mpBlockRuntimeBuf_t *block,
+                            const float entry_velocity, const float start[])
+{
+    key->bf = bf;
+    key->length = bf->length;
+    key->entry_velocity = entry_velocity;
+    key->block = *block;
+    memcpy(key->start, start, sizeof(key->start));
+    copy_vector(key->target, bf->cold->gm.target);
+}
+
+// velocity on the head or tail curve at t = [0,1] - what the forward differences step through
+static float _exec_table_velocity(const float t, const float v_0, const float v_1)
+{
+    const float t_3 = t * t * t;
+    return (v_0 + (v_1 - v_0) * t_3 * (10 + t * (-15 + t * 6)));
+}
+
+/*
+ * _exec_table_fill() - work out a block's segments into a claimed slot (main loop)
+ *
+ *  segments[] is the segment count of each section, 0 for an empty section.
+ *  The arithmetic follows _exec_aline_head/body/tail() and _exec_aline_segment().
+ */
+
+static void _exec_table_fill(mpExecTable_t *t, const float segments[])
+{
+    const mpBuf_t *bf = t->key.bf;
+    const mpBlockRuntimeBuf_t *b = &t->key.block;
+    const mpPath_t *path = &bf->cold->path;
+    const float length[SECTIONS] = { b->head_length, b->body_length, b->tail_length };
+    const float time[SECTIONS] = { b->head_time, b->body_time, b->tail_time };
+    const float v_0[SECTIONS] = { t->key.entry_velocity, b->cruise_velocity, b->cruise_velocity };
+    const float v_1[SECTIONS] = { b->cruise_velocity, b->cruise_velocity, b->exit_velocity };
+
+    float waypoint[SECTIONS][AXES];
+    float waypoint_remaining[SECTIONS] = { 0, 0, 0 };
+    if (path->type == PATH_ARC)
+    {
+        waypoint_remaining[SECTION_HEAD] = bf->length - b->head_length;
+        waypoint_remaining[SECTION_BODY] = waypoint_remaining[SECTION_HEAD] - b->body_length;
+        _exec_path_point(path, t->key.target, waypoint_remaining[SECTION_HEAD], waypoint[SECTION_HEAD]);
+        _exec_path_point(path, t->key.target, waypoint_remaining[SECTION_BODY], waypoint[SECTION_BODY]);
+        copy_vector(waypoint[SECTION_TAIL], t->key.target);
+    }
+    else
+    {
+        for (uint8_t axis = 0; axis < AXES; axis++)
+        {
+            waypoint[SECTION_HEAD][axis] = t->key.start[axis] + bf->unit[axis] * b->head_length;
+            waypoint[SECTION_BODY][axis] = t->key.start[axis] + bf->unit[axis] * (b->head_length + b->body_length);
+            waypoint[SECTION_TAIL][axis] = t->key.start[axis] + bf->unit[axis] * (b->head_length + b->body_length + b->tail_length);
+        }
+    }
+
+    float target[AXES];                 // as mr->gm.target, mr->target_comp and mr->position
+    float target_comp[AXES] = {0};      // the runtime zeroes it for each block
+    float position[AXES];
+    copy_vector(target, bf->cold->gm.target);
+    copy_vector(position, t->key.start);
+    float remaining = bf->length;
+    float ramp = 0;
+    uint16_t n = 0;
+
+    for (uint8_t section = SECTION_HEAD; section < SECTIONS; section++)
+    {
+        if (segments[section] == 0)
+        {
+            continue;
+        }
+        uint16_t count = (uint16_t)segments[section];
+        float segment_time = time[section] / segments[section];
+
+        for (uint16_t i = 0; i < count; i++, n++)
+        {
+            mpExecSegment_t *s = &t->seg[n];
+            float velocity;
+
+            if (section == SECTION_BODY)
+            {
+                velocity = v_0[section];
+                ramp = 0;
+            }
+            else if (count == 1)
+            {
+                velocity = length[section] / segment_time;
+                ramp = (v_1[section] - v_0[section]) / velocity;
+            }
+            else
+            {
+                velocity = _exec_table_velocity((i + 0.5) / segments[section], v_0[section], v_1[section]);
+#if DDA_SEGMENT_RAMP == true
+                if ((i + 1 < count) && (velocity > 0))
+                {
+                    ramp = (_exec_table_velocity((i + 1.5) / segments[section], v_0[section], v_1[section]) - velocity) / velocity;
+                }
+#endif
+            }
+
+            if (i + 1 == count)
+            {
+                copy_vector(target, waypoint[section]);
+                remaining = waypoint_remaining[section];
+            }
+            else if (path->type == PATH_ARC)
+            {
+                remaining = max(remaining - velocity * segment_time, (float)0);
+                _exec_path_point(path, t->key.target, remaining, target);
+            }
+            else
+            {
+                float segment_length = velocity * segment_time;
+                for (uint8_t a = 0; a < AXES; a++)
+                {
+                    if (!bf->axis_flags[a])
+                    {
+                        continue;
+                    }
+                    float to_add = (bf->unit[a] * segment_length) - target_comp[a];
+                    float next = position[a] + to_add;
+                    target_comp[a] = (next - position[a]) - to_add;
+                    target[a] = next;
+                }
+            }
+            copy_vector(s->target, target);
+            kn_inverse_kinematics(target, s->steps);
+            copy_vector(position, target);
+            s->velocity = velocity;
+            s->ramp = ramp;
+            s->time = segment_time;
+            s->remaining = remaining;
+            s->count = count - i;
+            s->section = section;
+        }
+    }
+    t->segments = n;
+}
+
+/*
+ * mp_exec_table_callback() - build the segment table for the next block (main loop)
+ */
+
+stat_t mp_exec_table_callback()
+{
+    if ((cm->hold_state != FEEDHOLD_OFF) || thc_active())
+    {
+        return (STAT_NOOP);
+    }
+    mpBuf_t *run = mp_get_run_buffer();
+    if ((run == NULL) || (run->block_type != BLOCK_TYPE_ALINE) || (run->buffer_state != MP_BUFFER_RUNNING) ||
+        (run->block_state != BLOCK_ACTIVE) || (mr->block_state == BLOCK_INACTIVE))
+    {
+        return (STAT_NOOP);
+    }
+    mpBuf_t *bf = run->nx;              // mr->r->nx was planned for this one (see mp_forward_plan())
+    if ((bf->block_type != BLOCK_TYPE_ALINE) || (bf->buffer_state != MP_BUFFER_FULLY_PLANNED) ||
+        (mr->r->nx == mr->p))
+    {
+        return (STAT_NOOP);
+    }
+
+    // Everything read here can change under us. The key records what was read, and a
+    // table is only played if its key matches the block as it actually starts.
+    mpExecTableKey_t key;
+    float entry_velocity = mr->r->exit_velocity;
+    mpBlockRuntimeBuf_t block = *mr->r->nx;
+    _exec_aline_normalize_block(&block, entry_velocity);
+    _exec_table_key(&key, bf, &block, entry_velocity, mr->waypoint[SECTION_TAIL]);
+
+    for (uint8_t i = 0; i < EXEC_TABLES; i++)
+    {
+        if ((exec_table[i].state == TABLE_READY) && _exec_table_key_equal(&exec_table[i].key, &key))
+        {
+            return (STAT_NOOP);         // already built
+        }
+    }
+
+    float segment_usec = mr->segment_usec;
+    const float length[SECTIONS] = { block.head_length, block.body_length, block.tail_length };
+    const float time[SECTIONS] = { block.head_time, block.body_time, block.tail_time };
+    float segments[SECTIONS];
+    uint16_t total = 0;
+    for (uint8_t section = SECTION_HEAD; section < SECTIONS; section++)
+    {
+        segments[section] = 0;
+        if (fp_ZERO(length[section]))
+        {
+            continue;                   // as the exec skips an empty head, body or tail
+        }
+        segments[section] = _exec_aline_segments(time[section], segment_usec);
+        if (time[section] / segments[section] < MIN_SEGMENT_TIME)
+        {
+            return (STAT_NOOP);         // the exec traps this - leave it to the exec
+        }
+        total += (uint16_t)segments[section];
+    }
+    if ((total == 0) || (total > EXEC_TABLE_SEGMENTS))
+    {
+        return (STAT_NOOP);
+    }
+
+    mpExecTable_t *t = NULL;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint8_t i = 0; i < EXEC_TABLES; i++)
+    {
+        if ((exec_table[i].state == TABLE_EMPTY) || (exec_table[i].state == TABLE_READY))
+        {
+            t = &exec_table[i];
+            t->state = TABLE_FILLING;
+            break;
+        }
+    }
+    __set_PRIMASK(primask);
+    if (t == NULL)
+    {
+        return (STAT_NOOP);
+    }
+    t->key = key;
+    t->segment_usec = segment_usec;
+    _exec_table_fill(t, segments);
+    t->state = TABLE_READY;
+    return (STAT_OK);
+}
+
+#endif // EXEC_SEGMENT_TABLE
+
+/*
+ * _exec_table_start() - play a new block from its segment table if there is one (exec)
+ * _exec_aline_table()  - play the next table entry
+ *
+ *  _exec_table_start() runs at the end of the block setup in mp_exec_aline(). The table
+ *  also sets the block's segment time, since its entries were sized with it.
+ */
+
+static void _exec_table_start(mpBuf_t *bf)
+{
+    mr->table = NULL;
+#if EXEC_SEGMENT_TABLE == true
+    for (uint8_t i = 0; i < EXEC_TABLES; i++)
+    {
+        if (exec_table[i].state == TABLE_PLAYING)
+        {
+            exec_table[i].state = TABLE_EMPTY; // the previous block is done with it
+        }
+    }
+    if ((cm->hold_state != FEEDHOLD_OFF) || thc_active()) // table steps don't follow the torch height offset
+    {
+        return;
+    }
+    mpExecTableKey_t key;
+    _exec_table_key(&key, bf, mr->r, mr->entry_velocity, mr->position);
+
+    for (uint8_t i = 0; i < EXEC_TABLES; i++)
+    {
+        mpExecTable_t *t = &exec_table[i];
+        if ((t->state == TABLE_READY) && _exec_table_key_equal(&t->key, &key))
+        {
+            t->state = TABLE_PLAYING;
+            t->next = 0;
+            mr->table = t;
+            mr->segment_usec = t->segment_usec;
+            mr->section = (moveSection)t->seg[0].section;
+            mr->section_state = SECTION_RUNNING;
+            return;
+        }
+    }
+#endif
+}
+
+static stat_t _exec_aline_table()
+{
+#if EXEC_SEGMENT_TABLE == true
+    mpExecTable_t *t = mr->table;
+    const mpExecSegment_t *s = &t->seg[t->next++];
+
+    mr->segment_count = s->count - 1;
+    mr->segment_time = s->time;
+    mr->segment_velocity = s->velocity;
+    mr->segment_ramp = s->ramp;
+    mr->path_remaining = s->remaining;
+    copy_vector(mr->gm.target, s->target);
+
+    stat_t status = _exec_aline_segment_steps(s->steps);
+    if ((status != STAT_OK) && (status != STAT_EAGAIN))
+    {
+        return (status);
+    }
+    if (t->next == t->segments)
+    {
+        return (STAT_OK);               // ends the move
+    }
+    mr->section = (moveSection)t->seg[t->next].section; // advance the section as the live code does
+    return (STAT_EAGAIN);
+#else
+    return (cm_panic(STAT_INTERNAL_ERROR, "_exec_aline_table()")); // mr->table is never set
+#endif
+}
+
+/*********************************************************************************************
+ * _exec_aline_segment_period() - choose the nominal segment time for a new block
+ *
+ *  The mean exec interrupt cost since the previous block is sized to take SEGMENT_EXEC_LOAD
+ *  of the segment period, after the DDA interrupt's share of the CPU is taken out. Headroom
+ *  gives shorter segments (smoother velocity); load gives longer ones (avoids starving the
+ *  loader). The result is clamped to MIN/MAX_SEGMENT_USEC and smoothed across blocks.
+ *  Without SEGMENT_TIME_ADAPTIVE the time stays at NOM_SEGMENT_USEC.
+ */
+
+static void _exec_aline_segment_period()
+{
+#if SEGMENT_TIME_ADAPTIVE == true
+    static uint64_t exec_total = 0;     // profiler totals at the previous block
+    static uint32_t exec_count = 0;
+    static uint64_t dda_total = 0;
+    static uint32_t dda_count = 0;
+
+    const profStats_t *e = &prof.region[PROF_EXEC];
+    const profStats_t *d = &prof.region[PROF_DDA];
+
+    if ((e->count < exec_count) || (d->count < dda_count)) {   // statistics were cleared
+        exec_total = e->total;
+        exec_count = e->count;
+        dda_total = d->total;
+        dda_count = d->count;
+        return;
+    }
+    uint32_t samples = e->count - exec_count;
+    if (samples < SEGMENT_ADAPT_SAMPLES) {
+        return;                                                 // keep accumulating
+    }
+    float usec_per_cycle = 1000000.0 / prof_cycle_rate();
+    float exec_usec = (float)(e->total - exec_total) / samples * usec_per_cycle;
+    float dda_load = 0;
+    if (d->count > dda_count) {
+        dda_load = (float)(d->total - dda_total) / (d->count - dda_count) * usec_per_cycle * FREQUENCY_DDA / 1000000.0;
+        dda_load = min(dda_load, (float)0.90);
+    }
+    float target_usec = exec_usec / (SEGMENT_EXEC_LOAD * (1 - dda_load));
+    target_usec = max(MIN_SEGMENT_USEC, min(target_usec, MAX_SEGMENT_USEC));
+    mr->segment_usec += (target_usec - mr->segment_usec) * 0.25;
+
+    exec_total = e->total;
+    exec_count = e->count;
+    dda_total = d->total;
+    dda_count = d->count;
+#endif
+}
+
+/*********************************************************************************************
+ * _exec_aline_segments() - return the number of segments for a head, body or tail
+ *
+ *  Segments are sized to the block's segment_usec but never drop below MIN_SEGMENT_TIME.
+ *  With the default 2x ratio of NOM to MIN segment time the lower limit never binds.
+ */
+
+static float _exec_aline_segments(const float section_time, const float segment_usec)
+{
+    float segments = ceil(uSec(section_time) / segment_usec);
+    return (max((float)1.0, min(segments, (float)floor(uSec(section_time) / MIN_SEGMENT_USEC))));
+}
+
 /*********************************************************************************************
  * _exec_aline_normalize_block() - re-organize block to eliminate minimum time segments
  *
  * Check to make sure no sections are less than MIN_SEGMENT_TIME & adjust if necessary
  */
 
-static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
+static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b, const float entry_velocity)
 {
     if ((b->head_length > 0) && (b->head_time < MIN_SEGMENT_TIME))
     {
@@ -1088,7 +1922,7 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
             { // Split the body to the head and tail
                 b->head_length += b->body_length * 0.5;
                 b->tail_length += b->body_length * 0.5; // let the compiler optimize out one of these *
-                b->head_time = (2.0 * b->head_length) / (mr->entry_velocity + b->cruise_velocity);
+                b->head_time = (2.0 * b->head_length) / (entry_velocity + b->cruise_velocity);
                 b->tail_time = (2.0 * b->tail_length) / (b->cruise_velocity + b->exit_velocity);
                 b->body_length = 0;
                 b->body_time = 0;
@@ -1104,7 +1938,7 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
         else if (b->head_length > 0)
         { // Put it all in the head
             b->head_length += b->body_length;
-            b->head_time = (2.0 * b->head_length) / (mr->entry_velocity + b->cruise_velocity);
+            b->head_time = (2.0 * b->head_length) / (entry_velocity + b->cruise_velocity);
             b->body_length = 0;
             b->body_time = 0;
         }
@@ -1149,29 +1983,28 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
             if (cm->hold_type == FEEDHOLD_TYPE_SKIP)
             {
                 copy_vector(mp->position, mr->position); // update planner position to the final runtime position
+                mp_runtime_actions(bf->cold->action_first, bf->cold->actions); // the move's inline actions still run
                 mp_free_run_buffer();                    // advance to next block, discarding the rest of the move
+                mp_unplan_queue(mp_get_r());             // the moves planned ahead entered at speed
             }
 
             // Otherwise setup the block to complete motion (regardless of how hold will ultimately be exited)
             else
             {
-                bf->length = get_axis_vector_length(mr->position, mr->target); // update bf w/remaining length in move
+                bf->length = mp_get_runtime_remaining_length(); // update bf w/remaining length in move
 
                 // If length ~= 0 it's because the deceleration was exact. Handle this exception to avoid planning errors
                 if (bf->length < EPSILON4)
                 {
                     copy_vector(mp->position, mr->position); // update planner position to the final runtime position
+                    mp_runtime_actions(bf->cold->action_first, bf->cold->actions);
                     mp_free_run_buffer();                    // advance to next block, discarding the zero-length move
+                    mp_unplan_queue(mp_get_r());
                 }
                 else
                 {
                     bf->block_state = BLOCK_INITIAL_ACTION; // tell _exec to re-use the bf buffer
-                    while (bf->buffer_state > MP_BUFFER_BACK_PLANNED)
-                    {
-                        bf->buffer_state = MP_BUFFER_BACK_PLANNED; // revert from RUNNING so it can be forward planned again
-                        bf->plannable = true;                      // needed so block can be re-planned
-                        bf = mp_get_next_buffer(bf);
-                    }
+                    mp_unplan_queue(bf);                    // revert from RUNNING so it can be forward planned again
                 }
             }
             mr->reset(); // reset MR for next use and for forward planning
@@ -1234,7 +2067,7 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
         // enough (to EPSILON2) (1e). Case 1e happens frequently when the tail in the move was
         // already planned to zero. EPSILON2 deals with floating point rounding errors that can
         // mis-classify this case. EPSILON2 is 0.0001, which is 0.1 microns in length.
-        float available_length = get_axis_vector_length(mr->target, mr->position);
+        float available_length = mp_get_runtime_remaining_length();
 
         // Cases (1b1, 1c1) deceleration will fit in the block
         if ((available_length + EPSILON2 - mr->r->tail_length) > 0)
@@ -1268,7 +2101,7 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
                 mr->r->tail_time = 0;
             }
         }
-        _exec_aline_normalize_block(mr->r);
+        _exec_aline_normalize_block(mr->r, mr->entry_velocity);
     }
     return (STAT_EAGAIN); // exiting with EAGAIN will continue exec_aline() execution
 }
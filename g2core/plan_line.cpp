@@ -37,6 +37,7 @@
 #include "spindle.h"
 #include "settings.h"
 #include "xio.h"
+#include "profile.h"
 
 // using Motate::Timeout;
 
@@ -50,24 +51,67 @@ extern OutputPin<kDebug3_PinNumber> debug_pin3;
 // planner helper functions
 static mpBuf_t *_plan_block(mpBuf_t *bf);
 static void _calculate_override(mpBuf_t *bf);
-static void _calculate_jerk(mpBuf_t *bf);
+static void _calculate_jerk(mpBuf_t *bf, const float unit[]);
+static void _set_jerk(mpBuf_t *bf, const float recip_jerk);
+static void _calculate_accel_jerk(mpBuf_t *bf, const float unit[]);
+static void _calculate_traverse(mpBuf_t *bf, const float axis_length[]);
 static void _calculate_vmaxes(mpBuf_t *bf, const float axis_length[], const float axis_square[]);
+static float _centripetal_vmax(const uint8_t axis, const float radius);
+static void _calculate_curve_vmax(mpBuf_t *bf);
 static void _calculate_junction_vmax(mpBuf_t *bf);
-
-#ifdef __PLANNER_DIAGNOSTICS
-#pragma GCC push_options
-#pragma GCC optimize("O0") // this pragma is required to force the planner to actually set these unused values
-static void _set_bf_diagnostics(mpBuf_t *bf)
-{
-    UPDATE_BF_DIAGNOSTICS(bf);
-}
-#pragma GCC reset_options
-#else
-static void _set_bf_diagnostics(mpBuf_t *bf)
-{
-}
+static bool _curve_block(const mpBuf_t *bf);
+static void _calculate_curve_junction_vmax(mpBuf_t *bf);
+static void _arc_tangent(const mpPath_t *path, const float theta, float unit[]);
+static void _set_aline_geometry(mpBuf_t *bf, const float length, const float axis_length[],
+                                const float axis_square[], const bool flags[]);
+static void _blend_corner(const GCodeState_t *_gm, const float target[]);
+static bool _blend_hold(mpBuf_t *bf);
+#if PLANNER_COALESCE_ENABLED == true
+static bool _coalesce_aline(const GCodeState_t *_gm, const float target[], const float axis_length[], const float length);
 #endif
 
+/* Jerk constants cache
+ *
+ *  Consecutive blocks almost always share the same axis mix and therefore the same jerk.
+ *  The derived constants are kept for the last few jerk values (keyed on the reciprocal
+ *  found by _calculate_jerk()) so the sqrt is only taken when the jerk actually changes.
+ *  Entries are copied into the block, so replacing an entry never disturbs a queued block.
+ */
+#define JERK_CACHE_SIZE 4
+
+typedef struct mpJerkCacheEntry {
+    float recip_jerk;                   // key: max(|unit| * recip_jerk_max) from _calculate_jerk()
+    float jerk;                         // Jm, including JERK_MULTIPLIER
+    float q_recip_2_sqrt_j;             // (q/(2 sqrt(Jm))) used in length computations
+} mpJerkCacheEntry_t;
+
+static struct mpJerkCache {
+    mpJerkCacheEntry_t entry[JERK_CACHE_SIZE];
+    uint8_t next;                       // next entry to replace (round robin)
+} jc;
+
+/* Traverse axis cache
+ *
+ *  Rapids in a drilling or probing job repeat the same few axis combinations (Z alone,
+ *  XY, XYZ). Each entry keeps the participating axes of one combination, keyed on the
+ *  axis_flags bitmask, so _calculate_traverse() visits only those axes. Only the axis
+ *  list is kept; the limits are read from cm->a[] so axis settings can change at any time.
+ */
+#define TRAVERSE_CACHE_SIZE 4
+
+typedef struct mpTraverseCacheEntry {
+    uint16_t mask;                      // key: bit per participating axis (0 = unused entry)
+    uint8_t count;                      // number of participating axes
+    uint8_t axis[AXES];                 // the participating axes, in axis order
+} mpTraverseCacheEntry_t;
+
+static struct mpTraverseCache {
+    mpTraverseCacheEntry_t entry[TRAVERSE_CACHE_SIZE];
+    uint8_t next;                       // next entry to replace (round robin)
+} tc;
+
+static mpRuntimeSnapshot_t rs;
+
 /* Runtime-specific setters and getters
  *
  * mp_zero_segment_velocity()         - correct velocity in last segment for reporting purposes
@@ -76,6 +120,14 @@ static void _set_bf_diagnostics(mpBuf_t *bf)
  * mp_set_runtime_display_offset()    - set combined display offsets in the MR struct
  * mp_get_runtime_display_position()  - returns current axis position in work display coordinates
  *                                      that were in effect at move planning time
+ * mp_hold_runtime_snapshot()         - capture a runtime snapshot and keep it until released
+ * mp_release_runtime_snapshot()      - let mp_get_runtime_snapshot() capture fresh ones again
+ * mp_get_runtime_snapshot()          - return the held snapshot, or capture a fresh one
+ *
+ *  A status report holds one snapshot while it populates, so its pos, mpo, vel and line
+ *  values all come from the same segment, and the display transform runs once per report
+ *  rather than once per axis. The runtime values are copied with interrupts off so the
+ *  exec can't move mr->position half way through the copy.
  */
 
 void mp_zero_segment_velocity() { mr->segment_velocity = 0; }
@@ -84,35 +136,78 @@ float mp_get_runtime_absolute_position(mpPlannerRuntime_t *_mr, uint8_t axis) {
 void mp_set_runtime_display_offset(float offset[]) { copy_vector(mr->gm.display_offset, offset); }
 
 // We have to handle rotation - "rotate" by the transverse of the matrix to got "normal" coordinates
-float mp_get_runtime_display_position(uint8_t axis)
+static float _display_position(const float position[], const float display_offset[], uint8_t axis)
 {
     // Shorthand:
     // target_rotated[0] = a x_1 + b x_2 + c x_3
     // target_rotated[1] = a y_1 + b y_2 + c y_3
     // target_rotated[2] = a z_1 + b z_2 + c z_3 + z_offset
 
+    if (cm->rotation_identity)
+    {
+        return (position[axis] - display_offset[axis]);
+    }
     if (axis == AXIS_X)
     {
-        return mr->position[0] * cm->rotation_matrix[0][0] + mr->position[1] * cm->rotation_matrix[1][0] +
-               mr->position[2] * cm->rotation_matrix[2][0] - mr->gm.display_offset[0];
+        return position[0] * cm->rotation_matrix[0][0] + position[1] * cm->rotation_matrix[1][0] +
+               position[2] * cm->rotation_matrix[2][0] - display_offset[0];
     }
     else if (axis == AXIS_Y)
     {
-        return mr->position[0] * cm->rotation_matrix[0][1] + mr->position[1] * cm->rotation_matrix[1][1] +
-               mr->position[2] * cm->rotation_matrix[2][1] - mr->gm.display_offset[1];
+        return position[0] * cm->rotation_matrix[0][1] + position[1] * cm->rotation_matrix[1][1] +
+               position[2] * cm->rotation_matrix[2][1] - display_offset[1];
     }
     else if (axis == AXIS_Z)
     {
-        return mr->position[0] * cm->rotation_matrix[0][2] + mr->position[1] * cm->rotation_matrix[1][2] +
-               mr->position[2] * cm->rotation_matrix[2][2] - cm->rotation_z_offset - mr->gm.display_offset[2];
+        return position[0] * cm->rotation_matrix[0][2] + position[1] * cm->rotation_matrix[1][2] +
+               position[2] * cm->rotation_matrix[2][2] - cm->rotation_z_offset - display_offset[2];
     }
     else
     {
         // ABC, UVW, we don't rotate them
-        return (mr->position[axis] - mr->gm.display_offset[axis]);
+        return (position[axis] - display_offset[axis]);
     }
 }
 
+float mp_get_runtime_display_position(uint8_t axis)
+{
+    return (_display_position(mr->position, mr->gm.display_offset, axis));
+}
+
+static void _take_runtime_snapshot()
+{
+    float display_offset[AXES];
+
+    __disable_irq();
+    copy_vector(rs.position, mr->position);
+    copy_vector(display_offset, mr->gm.display_offset);
+    rs.velocity = mr->segment_velocity;
+    rs.linenum = mr->gm.linenum;
+    __enable_irq();
+
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        rs.display[axis] = _display_position(rs.position, display_offset, axis);
+    }
+}
+
+void mp_hold_runtime_snapshot()
+{
+    _take_runtime_snapshot();
+    rs.held = true;
+}
+
+void mp_release_runtime_snapshot() { rs.held = false; }
+
+const mpRuntimeSnapshot_t *mp_get_runtime_snapshot()
+{
+    if (!rs.held)
+    {
+        _take_runtime_snapshot();
+    }
+    return (&rs);
+}
+
 /****************************************************************************************
  * mp_get_runtime_busy() - returns TRUE if motion control busy (i.e. robot is moving)
  * mp_runtime_is_idle()  - returns TRUE if steppers are not actively moving
@@ -181,29 +276,48 @@ stat_t mp_aline(GCodeState_t *_gm)
     //  b being target[1],
     //  c being target[2],
     //  x_1 being cm->rotation_matrix[1][0]
+    //
+    // Most machines are not trammed. The identity flag is kept with the matrix, so they
+    // just copy the target.
 
-    target_rotated[AXIS_X] = _gm->target[AXIS_X] * cm->rotation_matrix[0][0] +
-                             _gm->target[AXIS_Y] * cm->rotation_matrix[0][1] +
-                             _gm->target[AXIS_Z] * cm->rotation_matrix[0][2];
+    if (cm->rotation_identity)
+    {
+        copy_vector(target_rotated, _gm->target);
+    }
+    else
+    {
+        target_rotated[AXIS_X] = _gm->target[AXIS_X] * cm->rotation_matrix[0][0] +
+                                 _gm->target[AXIS_Y] * cm->rotation_matrix[0][1] +
+                                 _gm->target[AXIS_Z] * cm->rotation_matrix[0][2];
 
-    target_rotated[AXIS_Y] = _gm->target[AXIS_X] * cm->rotation_matrix[1][0] +
-                             _gm->target[AXIS_Y] * cm->rotation_matrix[1][1] +
-                             _gm->target[AXIS_Z] * cm->rotation_matrix[1][2];
+        target_rotated[AXIS_Y] = _gm->target[AXIS_X] * cm->rotation_matrix[1][0] +
+                                 _gm->target[AXIS_Y] * cm->rotation_matrix[1][1] +
+                                 _gm->target[AXIS_Z] * cm->rotation_matrix[1][2];
 
-    target_rotated[AXIS_Z] = _gm->target[AXIS_X] * cm->rotation_matrix[2][0] +
-                             _gm->target[AXIS_Y] * cm->rotation_matrix[2][1] +
-                             _gm->target[AXIS_Z] * cm->rotation_matrix[2][2] +
-                             cm->rotation_z_offset;
+        target_rotated[AXIS_Z] = _gm->target[AXIS_X] * cm->rotation_matrix[2][0] +
+                                 _gm->target[AXIS_Y] * cm->rotation_matrix[2][1] +
+                                 _gm->target[AXIS_Z] * cm->rotation_matrix[2][2] +
+                                 cm->rotation_z_offset;
 
-    // 复制UVW的旋转轴（无更改）
-    target_rotated[AXIS_U] = _gm->target[AXIS_U];
-    target_rotated[AXIS_V] = _gm->target[AXIS_V];
-    target_rotated[AXIS_W] = _gm->target[AXIS_W];
+        // copy the UVW and ABC axes unrotated
+        for (uint8_t axis = AXIS_Z + 1; axis < AXES; axis++)
+        {
+            target_rotated[axis] = _gm->target[axis];
+        }
+    }
 
-    // 复制ABC的旋转轴（无变化）
-    target_rotated[AXIS_A] = _gm->target[AXIS_A];
-    target_rotated[AXIS_B] = _gm->target[AXIS_B];
-    target_rotated[AXIS_C] = _gm->target[AXIS_C];
+    // A held G64 P line is finished first - this may round its corner and move mp->position
+    if (mp->blend != NULL)
+    {
+        if (raster_pending())
+        {
+            mp_commit_blend();                    // a raster line must start where it was sent
+        }
+        else
+        {
+            _blend_corner(_gm, target_rotated);
+        }
+    }
 
     for (uint8_t axis = 0; axis < AXES; axis++)
     {
@@ -229,6 +343,13 @@ stat_t mp_aline(GCodeState_t *_gm)
         return (STAT_MINIMUM_LENGTH_MOVE);               // 结束循环所需的STAT_MINIMUM_LENGTH_MOVE
     }
 
+#if PLANNER_COALESCE_ENABLED == true
+    if (!raster_pending() && _coalesce_aline(_gm, target_rotated, axis_length, length))
+    {
+        return (STAT_OK);
+    }
+#endif
+
     //获取清除缓冲区并复制Gcode模型状态
     mpBuf_t *bf = mp_get_write_buffer();
 
@@ -236,29 +357,404 @@ stat_t mp_aline(GCodeState_t *_gm)
     { //永远不会失败
         return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "aline()"));
     }
-    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
-    copy_vector(bf->gm.target, target_rotated); //将旋转的目标复制到位
+    if (!mp_set_block_gm(bf, _gm))
+    { //永远不会失败 - the planner reports full until a context is free
+        mp_unget_write_buffer();
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "aline() gcode context"));
+    }
+    copy_vector(bf->cold->gm.target, target_rotated); //将旋转的目标复制到位
+    if (_gm->motion_mode == MOTION_MODE_STRAIGHT_FEED)
+    {
+        raster_attach(&bf->cold->raster, length);   // take any pending raster pixels
+    }
 
     // setup the buffer
-    bf->bf_func = mp_exec_aline; //将回调注册到exec函数
+    bf->cold->bf_func = mp_exec_aline; //将回调注册到exec函数
+    _set_aline_geometry(bf, length, axis_length, axis_square, flags);
+
+    //注意：这些下一行必须保持准确的顺序。在提交缓冲区之前必须更新位置。
+    copy_vector(mp->position, bf->cold->gm.target); //更新下一步的计划员位置
+    if (_blend_hold(bf))
+    {
+        return (STAT_OK);                         // committed when the next move arrives
+    }
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE); //提交当前块（必须遵循位置更新）
+    return (STAT_OK);
+}
+
+/*
+ * _blend_plane() - plane and linear axes of a gcode plane selection
+ */
+
+static void _blend_plane(const uint8_t select_plane, uint8_t &axis_0, uint8_t &axis_1, uint8_t &linear)
+{
+    if (select_plane == CANON_PLANE_XZ)
+    {
+        axis_0 = AXIS_X; axis_1 = AXIS_Z; linear = AXIS_Y;
+    }
+    else if (select_plane == CANON_PLANE_YZ)
+    {
+        axis_0 = AXIS_Y; axis_1 = AXIS_Z; linear = AXIS_X;
+    }
+    else
+    {
+        axis_0 = AXIS_X; axis_1 = AXIS_Y; linear = AXIS_Z;
+    }
+}
+
+/*
+ * _blend_hold() - hold a new line back from the planner if its end corner may be blended
+ *
+ *  Only units-per-minute feed lines in continuous mode with a P tolerance that move in
+ *  their selected plane are held. The buffer stays INITIALIZING and uncommitted, so it can
+ *  still be shortened. It is committed by the next mp_aline(), by anything else taking a
+ *  write buffer, or by mp_planner_callback() once the block timeout runs out.
+ */
+
+static bool _blend_hold(mpBuf_t *bf)
+{
+    const mpGCodeBlock_t *gm = &bf->cold->gm;
+    const mpGCodeContext_t *ctx = mp_get_block_context(bf);
+
+    if ((ctx->path_control != PATH_CONTINUOUS) || (ctx->path_tolerance <= 0) || (bf->cold->raster.pixels != 0) ||
+        (gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) || (gm->feed_rate_mode != UNITS_PER_MINUTE_MODE))
+    {
+        return (false);
+    }
+    uint8_t axis_0, axis_1, linear;
+    _blend_plane(ctx->select_plane, axis_0, axis_1, linear);
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        if (bf->axis_flags[axis] && (axis != axis_0) && (axis != axis_1))
+        {
+            return (false);
+        }
+    }
+    mp->blend = bf;
+    mp->block_timeout.set(BLOCK_TIMEOUT_MS);
+    return (true);
+}
+
+/*
+ * _blend_corner() - commit the held line, rounding its end corner into the move to target
+ *
+ *  For a turn of angle theta the arc tangent to both lines that passes within tolerance T
+ *  of the corner has radius R = T cos(theta/2) / (1 - cos(theta/2)) and meets each line
+ *  d = R tan(theta/2) from the corner. d is capped at half of either line, which shrinks
+ *  the arc (and its deviation). The held line is shortened by d, the arc is queued with
+ *  mp_arc() and mp->position is left at the arc's end, d along the new move.
+ *
+ *  If the new move leaves the held line's plane, is not a feed, or the corner is nearly
+ *  straight or nearly reversing, the held line is committed unchanged.
+ */
+
+static void _blend_corner(const GCodeState_t *_gm, const float target[])
+{
+    mpBuf_t *bf = mp->blend;
+    mpGCodeBlock_t *gm = &bf->cold->gm;
+    const mpGCodeContext_t *ctx = mp_get_block_context(bf);
+    uint8_t axis_0, axis_1, linear;
+    _blend_plane(ctx->select_plane, axis_0, axis_1, linear);
+
+    float d_0 = target[axis_0] - gm->target[axis_0];
+    float d_1 = target[axis_1] - gm->target[axis_1];
+    float length = sqrt(square(d_0) + square(d_1));
+    bool blendable = (_gm->motion_mode == MOTION_MODE_STRAIGHT_FEED) && (length >= 0.0001);
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        if ((axis != axis_0) && (axis != axis_1) && fp_NE(target[axis], gm->target[axis]))
+        {
+            blendable = false;
+        }
+    }
+    if (!blendable)
+    {
+        mp_commit_blend();
+        return;
+    }
+    float u1_0 = bf->unit[axis_0];
+    float u1_1 = bf->unit[axis_1];
+    float u2_0 = d_0 / length;
+    float u2_1 = d_1 / length;
+    float cosine = u1_0 * u2_0 + u1_1 * u2_1;
+    if ((cosine > BLEND_COS_MAX) || (cosine < BLEND_COS_MIN))
+    {
+        mp_commit_blend();
+        return;
+    }
+
+    float half = acos(cosine) / 2;
+    float radius = ctx->path_tolerance * cos(half) / (1 - cos(half));
+    float tangent = radius * tan(half);
+    float tangent_max = ((bf->length < length) ? bf->length : length) / 2;
+    if (tangent > tangent_max)
+    {
+        tangent = tangent_max;
+        radius = tangent / tan(half);
+    }
+    if ((radius * 2 * half) < 0.0001)          // same minimum as mp_aline()
+    {
+        mp_commit_blend();
+        return;
+    }
+
+    // shorten the held line to end where the arc starts, then commit it
+    GCodeState_t arc_gm;                        // the arc runs at the held line's feed
+    mp_get_block_gm(bf, &arc_gm);
+    float corner[AXES];
+    float axis_length[] = INIT_AXES_ZEROES;
+    float axis_square[] = INIT_AXES_ZEROES;
+    bool flags[] = INIT_AXES_FALSE;
+    float trimmed = bf->length - tangent;
+
+    copy_vector(corner, gm->target);
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        if ((flags[axis] = bf->axis_flags[axis]))
+        {
+            axis_length[axis] = bf->unit[axis] * trimmed;
+            axis_square[axis] = square(axis_length[axis]);
+        }
+    }
+    gm->target[axis_0] = corner[axis_0] - u1_0 * tangent;
+    gm->target[axis_1] = corner[axis_1] - u1_1 * tangent;
+    _set_aline_geometry(bf, trimmed, axis_length, axis_square, flags);
+    copy_vector(mp->position, gm->target);
+    float start_0 = gm->target[axis_0];
+    float start_1 = gm->target[axis_1];
+    mp_commit_blend();
+
+    // the center is on the inside of the turn; a left turn runs counterclockwise (negative travel)
+    float turn = u1_0 * u2_1 - u1_1 * u2_0;
+    mpPath_t path;
+    memset(&path, 0, sizeof(mpPath_t));
+    path.type = PATH_ARC;
+    path.plane_axis_0 = axis_0;
+    path.plane_axis_1 = axis_1;
+    path.linear_axis = linear;
+    path.center_0 = start_0 + ((turn > 0) ? -u1_1 : u1_1) * radius;
+    path.center_1 = start_1 + ((turn > 0) ? u1_0 : -u1_0) * radius;
+    path.radius = radius;
+    path.theta = atan2(start_0 - path.center_0, start_1 - path.center_1);
+    path.angular_travel = (turn > 0) ? -2 * half : 2 * half;
+    path.length = radius * 2 * half;
+    path.linear_position = corner[linear];
+
+    arc_gm.target[axis_0] = corner[axis_0] + u2_0 * tangent;
+    arc_gm.target[axis_1] = corner[axis_1] + u2_1 * tangent;
+    mp_arc(&arc_gm, &path);                     // updates mp->position to the arc end
+}
+
+/*
+ * _set_aline_geometry() - set length, unit vector, jerk and vmaxes of a straight block
+ */
+
+static void _set_aline_geometry(mpBuf_t *bf, const float length, const float axis_length[],
+                                const float axis_square[], const bool flags[])
+{
     bf->length = length;         //记录长度
+    float recip_length = 1 / length;
     for (uint8_t axis = 0; axis < AXES; axis++)
     { //计算单位矢量并设置标志
+        bf->unit[axis] = 0;
         if ((bf->axis_flags[axis] = flags[axis]))
-        {                                                // yes，这应该是=而不是==
-            bf->unit[axis] = axis_length[axis] / length; // nb：bf->单位被mp_get_write_buffer（）清除
+        {                                                   // yes，这应该是=而不是==
+            bf->unit[axis] = axis_length[axis] * recip_length;
+        }
+    }
+    if (bf->cold->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE)
+    {
+        _calculate_traverse(bf, axis_length);        // jerk and vmaxes in one pass, no feed terms
+    }
+    else
+    {
+        _calculate_jerk(bf, bf->unit);                   //计算bf-> jerk值
+        _calculate_vmaxes(bf, axis_length, axis_square); // compute cruise_vmax and absolute_vmax
+    }
+    _calculate_accel_jerk(bf, bf->unit);
+}
+
+#if PLANNER_COALESCE_ENABLED == true
+/*
+ * _coalesce_aline() - extend the last queued block to target if the move continues it
+ *
+ *  Returns true if the move was merged (nothing more to queue). Only a straight feed block
+ *  that planning has not primed yet can be extended - until then nothing has read its
+ *  length or vmaxes, and the planner and runtime both leave it alone. Inverse time moves
+ *  are never merged since their F word is a time for that one move. The merged block takes
+ *  the new move's gcode state, so it reports the later line number.
+ */
+
+static bool _coalesce_aline(const GCodeState_t *_gm, const float target[], const float axis_length[], const float length)
+{
+    mpBuf_t *bf = mp_get_w()->pv;
+    const mpGCodeBlock_t *gm = &bf->cold->gm;
+
+    if ((bf->buffer_state != MP_BUFFER_INITIALIZING) || (bf->block_type != BLOCK_TYPE_ALINE) ||
+        bf->primed || !bf->plannable || (bf->cold->path.type != PATH_LINE) || (bf->cold->raster.pixels != 0) ||
+        (bf->cold->actions != 0))               // its inline actions run where it ends now
+    {
+        return (false);
+    }
+    const mpGCodeContext_t *ctx = mp_get_block_context(bf);
+    if ((_gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) || (gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) ||
+        (_gm->feed_rate_mode != UNITS_PER_MINUTE_MODE) || (gm->feed_rate_mode != UNITS_PER_MINUTE_MODE) ||
+        (_gm->path_control == PATH_EXACT_STOP) || (_gm->path_control != ctx->path_control) ||
+        !fp_EQ(_gm->feed_rate, gm->feed_rate) || !fp_EQ(_gm->spindle_speed, gm->spindle_speed) ||
+        (_gm->coord_system != ctx->coord_system) ||
+        (_gm->absolute_override != ctx->absolute_override) || (_gm->tool != ctx->tool) ||
+        (_gm->path_tolerance > 0))              // G64 P lines are held for blending instead
+    {
+        return (false);
+    }
+    float cosine = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        cosine += axis_length[axis] * bf->unit[axis];
+        if (!fp_EQ(_gm->display_offset[axis], ctx->display_offset[axis]))
+        {
+            return (false);
         }
     }
-    _calculate_jerk(bf);                             //计算bf-> jerk值
-    _calculate_vmaxes(bf, axis_length, axis_square); // compute cruise_vmax and absolute_vmax
-    _set_bf_diagnostics(bf);                         // DIAGNOSTIC
+    if (cosine < (COALESCE_COS_MIN * length))
+    {
+        return (false);
+    }
 
-    //注意：这些下一行必须保持准确的顺序。在提交缓冲区之前必须更新位置。
-    copy_vector(mp->position, bf->gm.target); //更新下一步的计划员位置
-    mp_commit_write_buffer(BLOCK_TYPE_ALINE); //提交当前块（必须遵循位置更新）
+    // The block starts where it ends less its own travel
+    float merged_length[] = INIT_AXES_ZEROES;
+    float merged_square[] = INIT_AXES_ZEROES;
+    bool flags[] = INIT_AXES_FALSE;
+    float length_square = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        merged_length[axis] = target[axis] - (gm->target[axis] - bf->unit[axis] * bf->length);
+        if ((flags[axis] = fp_NOT_ZERO(merged_length[axis])))
+        {
+            merged_square[axis] = square(merged_length[axis]);
+            length_square += merged_square[axis];
+        }
+        else
+        {
+            merged_length[axis] = 0;
+        }
+    }
+    float merged = sqrt(length_square);
+    if ((merged > COALESCE_MAX_LENGTH) || ((merged / _gm->feed_rate) > COALESCE_MAX_TIME))
+    {
+        return (false);
+    }
+
+    if (!mp_set_block_gm(bf, _gm))              // restate the block - the context is nearly always the same
+    {
+        cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "coalesce() gcode context");
+        return (true);
+    }
+    copy_vector(bf->cold->gm.target, target);
+    _set_aline_geometry(bf, merged, merged_length, merged_square, flags);
+    mp_horizon_count(bf);                       // already committed - recount the longer block
+    mp_time_count(bf);
+
+    copy_vector(mp->position, target);
+    mp->request_planning = true;
+    mp->block_timeout.set(BLOCK_TIMEOUT_MS);    // the stream is still arriving
+    return (true);
+}
+#endif // PLANNER_COALESCE_ENABLED
+
+/****************************************************************************************
+ * mp_arc() - plan a circular or helical arc as a single block
+ *
+ *  The arc is queued as one BLOCK_TYPE_ALINE buffer of length path->length carrying
+ *  its geometry in bf->cold->path. mp_exec_aline() interpolates it at segment rate.
+ *  Callers only use this when the target needs no rotation and no axes other than
+ *  the arc plane and linear axis move (see cm_arc_feed()), so _gm->target and the
+ *  path geometry are already in planner coordinates.
+ *
+ *  Planning treats the arc as a line of path->length with these differences:
+ *    - the tangent sweeps through the plane, so every plane axis limits jerk and
+ *      the plane axis rate limits are applied to the full planar travel
+ *    - cruise is limited by curvature (see _calculate_curve_vmax())
+ *    - the junction into the block uses the entry tangent (bf->unit) and the
+ *      junction out of it uses the exit tangent (path.exit_unit)
+ */
+
+stat_t mp_arc(GCodeState_t *_gm, const mpPath_t *path)
+{
+    float axis_square[] = INIT_AXES_ZEROES;
+    float axis_length[] = INIT_AXES_ZEROES;
+    float jerk_unit[] = INIT_AXES_ZEROES;
+
+    if (path->length < 0.0001)                          // same minimum as mp_aline()
+    {
+        sr_request_status_report(SR_REQUEST_TIMED_FULL);
+        return (STAT_MINIMUM_LENGTH_MOVE);
+    }
+
+    mpBuf_t *bf = mp_get_write_buffer();
+    if (bf == NULL)
+    {
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "arc()"));
+    }
+    if (!mp_set_block_gm(bf, _gm))
+    {
+        mp_unget_write_buffer();
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "arc() gcode context"));
+    }
+    memcpy(&bf->cold->path, path, sizeof(mpPath_t));
+
+    mpPath_t *p = &bf->cold->path;
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        p->exit_unit[axis] = 0;
+    }
+    _arc_tangent(p, p->theta, bf->unit);
+    _arc_tangent(p, p->theta + p->angular_travel, p->exit_unit);
+
+    float planar_travel = fabs(p->angular_travel * p->radius);
+    bf->axis_flags[p->plane_axis_0] = true;
+    bf->axis_flags[p->plane_axis_1] = true;
+    jerk_unit[p->plane_axis_0] = 1.0;
+    jerk_unit[p->plane_axis_1] = 1.0;
+    axis_length[p->plane_axis_0] = planar_travel;       // feed time is taken from the square sum, so
+    axis_length[p->plane_axis_1] = planar_travel;       // only one plane axis carries the planar square
+    axis_square[p->plane_axis_0] = square(planar_travel);
+    if (fp_NOT_ZERO(p->linear_travel))
+    {
+        bf->axis_flags[p->linear_axis] = true;
+        jerk_unit[p->linear_axis] = fabs(p->linear_travel) / p->length;
+        axis_length[p->linear_axis] = p->linear_travel;
+        axis_square[p->linear_axis] = square(p->linear_travel);
+    }
+
+    bf->cold->bf_func = mp_exec_aline;
+    bf->length = p->length;
+    _calculate_jerk(bf, jerk_unit);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+    _calculate_accel_jerk(bf, jerk_unit);
+    _calculate_curve_vmax(bf);
+
+    copy_vector(mp->position, bf->cold->gm.target);
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE);
     return (STAT_OK);
 }
 
+/*
+ * _arc_tangent() - unit tangent of an arc path at angle theta, in the direction of travel
+ */
+
+static void _arc_tangent(const mpPath_t *path, const float theta, float unit[])
+{
+    float t_0 = path->radius * path->angular_travel * cos(theta);
+    float t_1 = -path->radius * path->angular_travel * sin(theta);
+    float norm = sqrt(square(t_0) + square(t_1) + square(path->linear_travel));
+
+    unit[path->plane_axis_0] = t_0 / norm;
+    unit[path->plane_axis_1] = t_1 / norm;
+    unit[path->linear_axis] = path->linear_travel / norm;
+}
+
 /****************************************************************************************
  * mp_plan_block_list() - 计划列表中的所有块
  *
@@ -274,6 +770,7 @@ stat_t mp_aline(GCodeState_t *_gm)
 
 void mp_plan_block_list()
 {
+    PROFILE_CALL(PROF_BACK_PLAN);
     mpBuf_t *bf = mp->p;
     bool planned_something = false;
 
@@ -286,20 +783,23 @@ void mp_plan_block_list()
         }
 
         // 可以在feedhold期间重新计划运行缓冲区，但没有其他时间（不应该发生）
-        if ((cm->hold_state == FEEDHOLD_OFF) && (bf->buffer_state == MP_BUFFER_RUNNING))
+        // Once held, the run buffer keeps the plan made for the resume (see mp_exit_hold_state())
+        if (((cm->hold_state == FEEDHOLD_OFF) || (cm->hold_state == FEEDHOLD_HOLD)) &&
+            (bf->buffer_state == MP_BUFFER_RUNNING))
         {
             mp->p = mp->p->nx;
             return;
         }
         bf = _plan_block(bf); // 返回下一个块进行计划
+        mp->stats.backplans++;
         planned_something = true;
         mp->p = bf; // DIAGNOSTIC - this is not needed but is set here for debugging purposes
     }
     if (mp->planner_state > PLANNER_STARTUP)//运动开始前摄入块
     {
-        if (planned_something && (cm->hold_state != FEEDHOLD_HOLD))
+        if (planned_something)
         {
-            st_request_forward_plan(); // 如果运行时尚未忙，则启动动作
+            st_request_forward_plan(); // 如果运行时尚未忙，则启动动作 - in a hold, keeps the resume plan current
         }
     }
     mp->p = bf; // update planner pointer
@@ -317,13 +817,27 @@ static mpBuf_t *_plan_block(mpBuf_t *bf)
     {
         // Timings from *here*
 
+        // A replan (feed override) re-primes blocks that were primed before. The junction
+        // doesn't depend on the override, and blocks whose vmaxes come out unchanged keep
+        // their plan, so only blocks that actually change are backplanned again.
+        bool replan = bf->primed;
+        float cruise_vmax = bf->cruise_vmax;
+        float exit_vmax = bf->pv->exit_vmax;
+
+        _calculate_override(bf); //计算cruise_vmax给定的cruise_vset和进给速率系数
+                                 //     bf->plannable_time = bf->pv->plannable_time;    // set plannable time - excluding current move
         if (bf->pv->plannable)
         {
 			// 计算最大出口速度可以通过交汇点。
 			//bf->pv->junction_vmax
-            _calculate_junction_vmax(bf->pv); 
-			if (bf->pv->gm.path_control == PATH_EXACT_STOP)
+            if (!replan)
             {
+                _calculate_junction_vmax(bf->pv);
+                _calculate_curve_junction_vmax(bf->pv);
+            }
+			if ((mp_get_block_context(bf->pv)->path_control == PATH_EXACT_STOP) ||
+                mp_is_spindle_sync(bf->pv->cold->gm.motion_mode) || mp_is_spindle_sync(bf->cold->gm.motion_mode))
+            { // spindle synchronized blocks start and end stopped
                 bf->pv->exit_vmax = 0;
             }
             else
@@ -331,10 +845,14 @@ static mpBuf_t *_plan_block(mpBuf_t *bf)
                 bf->pv->exit_vmax = min3(bf->pv->junction_vmax, bf->pv->cruise_vmax, bf->cruise_vmax);
             }
         }
-        _calculate_override(bf); //计算cruise_vmax给定的cruise_vset和进给速率系数
-                                 //     bf->plannable_time = bf->pv->plannable_time;    // set plannable time - excluding current move
-        bf->buffer_state = MP_BUFFER_NOT_PLANNED;
-        bf->hint = NO_HINT; // ensure we've cleared the hints
+        bf->primed = true;
+
+        if (!replan || (bf->buffer_state < MP_BUFFER_BACK_PLANNED) ||
+            !fp_EQ(cruise_vmax, bf->cruise_vmax) || !fp_EQ(exit_vmax, bf->pv->exit_vmax))
+        {
+            bf->buffer_state = MP_BUFFER_NOT_PLANNED;
+            bf->hint = NO_HINT; // ensure we've cleared the hints
+        }
 
         // Time: 12us-41us
         if (bf->nx->plannable)
@@ -493,6 +1011,7 @@ static mpBuf_t *_plan_block(mpBuf_t *bf)
  * _calculate_override() - 计算cruise_vmax给定的cruise_vset和进给速率系数
  * _calculate_jerk()
  * _calculate_vmaxes()
+ * _calculate_traverse()
  * _calculate_junction_vmax()
  * _calculate_decel_time()
  */
@@ -501,56 +1020,31 @@ static void _calculate_override(mpBuf_t *bf) // execute ramp to adjust cruise ve
 {
     // TODO: Account for rapid overrides as well as feed overrides
 
-    // pull in override factor from previous block or seed initial value from the system setting
-    bf->override_factor = fp_ZERO(bf->pv->override_factor) ? cm->gmx.mfo_factor : bf->pv->override_factor;
-    bf->cruise_vmax = bf->override_factor * bf->cruise_vset;
+    // pull in override factor from previous block or seed initial value from the planner target
+    float factor = fp_ZERO(bf->pv->override_factor) ? mp->mfo_factor : bf->pv->override_factor;
 
-    // generate ramp term is a ramp is active
-    if (mp->ramp_active)
+    // Step toward the target by the velocity change this block can make within its jerk.
+    // The step is measured from the block's cruise at the previous factor, which bounds its
+    // entry velocity, so a ramp down can always be met from a locked entry. The change
+    // itself is left to backplanning and the zoid; only cruise_vmax is moved here.
+    if (!fp_EQ(factor, mp->mfo_factor))
     {
-        bf->override_factor += mp->ramp_dvdt * bf->block_time;
-        if (mp->ramp_dvdt > 0)
-        { // positive is an acceleration ramp
-            if (bf->override_factor > mp->ramp_target)
-            {
-                bf->override_factor = mp->ramp_target;
-                mp->ramp_active = false; // detect end of ramp
-            }
-            bf->cruise_velocity *= bf->override_factor;
-            if (bf->cruise_velocity > bf->absolute_vmax)
-            { // test max cruise_velocity
-                bf->cruise_velocity = bf->absolute_vmax;
-                mp->ramp_active = false; // don't allow exceeding absolute_vmax
-            }
+        float v_0 = factor * bf->cruise_vset;
+        float step = (mp_get_target_velocity(v_0, bf->length, bf) - v_0) / bf->cruise_vset;
+
+        if (fabs(mp->mfo_factor - factor) <= step)
+        {
+            factor = mp->mfo_factor;
         }
         else
-        { // negative is deceleration ramp
-            if (bf->override_factor < mp->ramp_target)
-            {
-                bf->override_factor = mp->ramp_target;
-                mp->ramp_active = false;
-            }
-            bf->cruise_velocity *= bf->override_factor; // +++++ this is probably wrong
-            //  bf->exit_velocity *= bf->mfo_factor;        //...but I'm not sure this is right,
-            //  bf->cruise_velocity = bf->pv->exit_velocity;//...either
+        {
+            factor += (mp->mfo_factor > factor) ? step : -step;
         }
     }
-    else
-    {
-        bf->cruise_velocity *= bf->override_factor; // apply original or changed factor
-    }
-    // Correction for velocity constraints
-    // In the case of a acceleration these conditions must hold:
-    //      Ve < Vc = Vx
-    // In the case of a deceleration:
-    //      Ve = Vc > Vx
-    // in the case of "lump":
-    //      Ve < Vc > Vx
-    // if (bf->cruise_velocity < bf->pv->exit_velocity) { // deceleration case
-    //     bf->cruise_velocity = bf->pv->exit_velocity;
-    // } else {                                        // acceleration case
-    //     ...
-    // }
+    mp->ramp_active = !fp_EQ(factor, mp->mfo_factor); // stays set until a block reaches the target
+
+    bf->override_factor = factor;
+    bf->cruise_vmax = min(factor * bf->cruise_vset, bf->absolute_vmax);
 }
 
 /****************************************************************************************
@@ -559,52 +1053,107 @@ static void _calculate_override(mpBuf_t *bf) // execute ramp to adjust cruise ve
  *  Set the jerk scaling to the lowest axis with a non-zero unit vector.
  *  Go through the axes one by one and compute the scaled jerk, then pick
  *  the highest jerk that does not violate any of the axes in the move.
+ *  The derived constants come from the jerk constants cache when the jerk repeats.
  *
  * Cost about ~65 uSec
  */
 
-static void _calculate_jerk(mpBuf_t *bf)
+static void _calculate_jerk(mpBuf_t *bf, const float unit[])
 {
     // compute the jerk as the largest jerk that still meets axis constraints
-    bf->jerk = 8675309; // a ridiculously large number
-    float jerk = 0;
+    // min(jerk_max / |unit|) is found as max(|unit| * recip_jerk_max) so the loop is multiply-only
+    float recip_jerk = 1 / (float)8675309; // reciprocal of a ridiculously large number
 
     for (uint8_t axis = 0; axis < AXES; axis++)
     {
-        if (fabs(bf->unit[axis]) > 0)
+        float unit_abs = fabs(unit[axis]);
+        if (unit_abs > 0)
         { // if this axis is participating in the move
-            float axis_jerk = 0;
+            float axis_recip_jerk = 0;
 #ifdef TRAVERSE_AT_HIGH_JERK
 #warning using experimental feature TRAVERSE_AT_HIGH_JERK!
-            switch (bf->gm.motion_mode)
+            switch (bf->cold->gm.motion_mode)
             {
             case MOTION_MODE_STRAIGHT_TRAVERSE:
                 //case MOTION_MODE_STRAIGHT_PROBE: // <-- not sure on this one
-                axis_jerk = cm->a[axis].jerk_high;
+                axis_recip_jerk = cm->a[axis].recip_jerk_high;
                 break;
             default:
-                axis_jerk = cm->a[axis].jerk_max;
+                axis_recip_jerk = cm->a[axis].recip_jerk_max;
             }
 #else
-            axis_jerk = cm->a[axis].jerk_max;
+            axis_recip_jerk = cm->a[axis].recip_jerk_max;
 #endif
 
-            jerk = axis_jerk / fabs(bf->unit[axis]);
-            if (jerk < bf->jerk)
+            float scaled = unit_abs * axis_recip_jerk;
+            if (scaled > recip_jerk)
             {
-                bf->jerk = jerk;
+                recip_jerk = scaled;
                 //              bf->jerk_axis = axis;           // +++ diagnostic
             }
         }
     }
-    bf->jerk *= JERK_MULTIPLIER;       // goose it!
-    bf->jerk_sq = bf->jerk * bf->jerk; // pre-compute terms used multiple times during planning
-    bf->recip_jerk = 1 / bf->jerk;
 
+    _set_jerk(bf, recip_jerk);
+}
+
+/*
+ * _set_jerk() - set the block's jerk and derived constants from max(|unit| * recip_jerk)
+ */
+
+static void _set_jerk(mpBuf_t *bf, const float recip_jerk)
+{
+    // reuse the derived constants if this jerk was seen recently
+    for (uint8_t i = 0; i < JERK_CACHE_SIZE; i++)
+    {
+        if (jc.entry[i].recip_jerk == recip_jerk)
+        {
+            bf->jerk = jc.entry[i].jerk;
+            bf->q_recip_2_sqrt_j = jc.entry[i].q_recip_2_sqrt_j;
+            return;
+        }
+    }
     const float q = 2.40281141413; // (sqrt(10)/(3^(1/4)))
-    const float sqrt_j = sqrt(bf->jerk);
-    bf->sqrt_j = sqrt_j;
-    bf->q_recip_2_sqrt_j = q / (2 * sqrt_j);
+    mpJerkCacheEntry_t *e = &jc.entry[jc.next];
+    jc.next = (jc.next + 1) % JERK_CACHE_SIZE;
+
+    e->recip_jerk = recip_jerk;
+    e->jerk = JERK_MULTIPLIER / recip_jerk;         // goose it!
+    e->q_recip_2_sqrt_j = q / (2 * sqrt(e->jerk));
+    bf->jerk = e->jerk;
+    bf->q_recip_2_sqrt_j = e->q_recip_2_sqrt_j;
+}
+
+/*
+ * _calculate_accel_jerk() - lower the jerk so the block's ramps stay within axis acceleration
+ *
+ *  The exec ramps velocity along a quintic (see _init_forward_diffs()), which has no
+ *  constant acceleration phase. A ramp of dV at jerk J takes q sqrt(dV/J) and peaks at
+ *  1.875 dV / that time, so the peak acceleration grows with sqrt(dV J). Axes with an
+ *  acceleration limit ({xac:}) cap the block's jerk so that its largest ramp - from 0 to
+ *  cruise_vmax - peaks at the lowest limit along the unit vector. Smaller ramps peak lower.
+ *  Must run after the vmaxes are known. Axes with no limit (0) don't take part.
+ */
+
+static void _calculate_accel_jerk(mpBuf_t *bf, const float unit[])
+{
+    const float peak = 0.780330085889911;   // 1.875 / q - peak acceleration is peak * sqrt(dV J)
+
+    // lowest block acceleration the axes allow, found as max(|unit| * recip_accel_max)
+    float recip_accel = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        recip_accel = max(recip_accel, (float)fabs(unit[axis]) * cm->a[axis].recip_accel_max);
+    }
+    if ((recip_accel == 0) || (bf->cruise_vmax < EPSILON))
+    {
+        return;
+    }
+    float jerk = square(1 / (recip_accel * peak)) / bf->cruise_vmax;
+    if (jerk < bf->jerk)
+    {
+        _set_jerk(bf, JERK_MULTIPLIER / jerk);
+    }
 }
 
 /****************************************************************************************
@@ -693,22 +1242,27 @@ static void _calculate_vmaxes(mpBuf_t *bf, const float axis_length[], const floa
     float block_time;         // resulting move time
 
     // compute feed time for feeds and probe motion
-    if (bf->gm.motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE)
+    if (bf->cold->gm.motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE)
     {
-        if (bf->gm.feed_rate_mode == INVERSE_TIME_MODE)
+        if (bf->cold->gm.feed_rate_mode == INVERSE_TIME_MODE)
         {
-            feed_time = bf->gm.feed_rate; // NB: feed rate was un-inverted to minutes by cm_set_feed_rate()
-            bf->gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
+            feed_time = bf->cold->gm.feed_rate; // NB: feed rate was un-inverted to minutes by cm_set_feed_rate()
+            bf->cold->gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
         }
         else
         {
             // compute length of linear move in millimeters. Feed rate is provided as mm/min
-            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z]) / bf->gm.feed_rate;
+            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z]) / bf->cold->gm.feed_rate;
             // if no linear axes, compute length of multi-axis rotary move in degrees.
             // Feed rate is provided as degrees/min
             if (fp_ZERO(feed_time))
             {
-                feed_time = sqrt(axis_square[AXIS_A] + axis_square[AXIS_B] + axis_square[AXIS_C]) / bf->gm.feed_rate;
+                float rotary_square = 0;
+                for (uint8_t axis = AXIS_A; axis <= AXIS_ROTARY_MAX; axis++)
+                {
+                    rotary_square += axis_square[axis];
+                }
+                feed_time = sqrt(rotary_square) / bf->cold->gm.feed_rate;
             }
         }
     }
@@ -717,13 +1271,13 @@ static void _calculate_vmaxes(mpBuf_t *bf, const float axis_length[], const floa
     {
         if (bf->axis_flags[axis])
         {
-            if (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE)
+            if (bf->cold->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE)
             {
-                tmp_time = fabs(axis_length[axis]) / cm->a[axis].velocity_max;
+                tmp_time = fabs(axis_length[axis]) * cm->a[axis].recip_velocity_max;
             }
             else
             { // gm.motion_mode == MOTION_MODE_STRAIGHT_FEED
-                tmp_time = fabs(axis_length[axis]) / cm->a[axis].feedrate_max;
+                tmp_time = fabs(axis_length[axis]) * cm->a[axis].recip_feedrate_max;
             }
             max_time = max(max_time, tmp_time);
 
@@ -741,6 +1295,140 @@ static void _calculate_vmaxes(mpBuf_t *bf, const float axis_length[], const floa
     bf->block_time = block_time;               // initial estimate - used for ramp computations
 }
 
+/****************************************************************************************
+ * _calculate_traverse() - jerk, cruise_vmax and absolute_vmax of a straight traverse
+ *
+ *  Gives the same results as _calculate_jerk() and _calculate_vmaxes() for a G0, which
+ *  has no feed rate, inverse time or feed rate mode to consider. The participating axes
+ *  come from the traverse axis cache and jerk and rate limits are found in one pass over
+ *  them. A single axis rapid - the common case in drilling - needs no loop at all.
+ *
+ *  Prerequisites: the block length, unit vector and axis flags are set.
+ */
+
+static void _calculate_traverse(mpBuf_t *bf, const float axis_length[])
+{
+    uint16_t mask = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++)
+    {
+        if (bf->axis_flags[axis])
+        {
+            mask |= (1 << axis);
+        }
+    }
+
+    mpTraverseCacheEntry_t *e = NULL;
+    for (uint8_t i = 0; i < TRAVERSE_CACHE_SIZE; i++)
+    {
+        if (tc.entry[i].mask == mask)
+        {
+            e = &tc.entry[i];
+            break;
+        }
+    }
+    if (e == NULL)
+    {
+        e = &tc.entry[tc.next];
+        tc.next = (tc.next + 1) % TRAVERSE_CACHE_SIZE;
+        e->mask = mask;
+        e->count = 0;
+        for (uint8_t axis = 0; axis < AXES; axis++)
+        {
+            if (mask & (1 << axis))
+            {
+                e->axis[e->count++] = axis;
+            }
+        }
+    }
+
+    float recip_jerk = 1 / (float)8675309;   // same seed as _calculate_jerk()
+    float max_time = 0;
+    float min_time = 8675309;
+
+    if (e->count == 1)
+    {                                           // the unit vector is +/-1 on the one axis
+        uint8_t axis = e->axis[0];
+#ifdef TRAVERSE_AT_HIGH_JERK
+        recip_jerk = max(recip_jerk, cm->a[axis].recip_jerk_high);
+#else
+        recip_jerk = max(recip_jerk, cm->a[axis].recip_jerk_max);
+#endif
+        max_time = fabs(axis_length[axis]) * cm->a[axis].recip_velocity_max;
+        if (max_time > 0)
+        {
+            min_time = max_time;
+        }
+    }
+    else
+    {
+        for (uint8_t i = 0; i < e->count; i++)
+        {
+            uint8_t axis = e->axis[i];
+#ifdef TRAVERSE_AT_HIGH_JERK
+            recip_jerk = max(recip_jerk, (float)fabs(bf->unit[axis]) * cm->a[axis].recip_jerk_high);
+#else
+            recip_jerk = max(recip_jerk, (float)fabs(bf->unit[axis]) * cm->a[axis].recip_jerk_max);
+#endif
+            float tmp_time = fabs(axis_length[axis]) * cm->a[axis].recip_velocity_max;
+            max_time = max(max_time, tmp_time);
+            if (tmp_time > 0)
+            {
+                min_time = min(min_time, tmp_time);
+            }
+        }
+    }
+    _set_jerk(bf, recip_jerk);
+
+    float block_time = max(max_time, MIN_BLOCK_TIME);
+    min_time = max(min_time, MIN_BLOCK_TIME);
+    bf->cruise_vset = bf->length / block_time;
+    bf->cruise_vmax = bf->cruise_vset;
+    bf->absolute_vmax = bf->length / min_time;
+    bf->block_time = block_time;
+}
+
+/****************************************************************************************
+ * _centripetal_vmax() - fastest velocity one axis allows on a curve of the given radius
+ *
+ *  At velocity v on radius r the centripetal acceleration is v^2/r and the jerk is v^3/r^2.
+ *  The acceleration is held to what a junction may apply over one integration time
+ *  (max_junction_accel / T, see _calculate_junction_vmax()) and the jerk to jerk_max.
+ */
+
+static float _centripetal_vmax(const uint8_t axis, const float radius)
+{
+    float T = cm->junction_integration_time / 1000.0;
+    return (min((float)sqrt(cm->a[axis].max_junction_accel / T * radius),
+                cbrtf(cm->a[axis].jerk_max * JERK_MULTIPLIER * square(radius))));
+}
+
+/****************************************************************************************
+ * _calculate_curve_vmax() - limit an arc block's velocities by its curvature
+ *
+ *  Each plane axis is held to its _centripetal_vmax(). A fanned-out arc got a comparable
+ *  limit from the corner at every segment, but it varied with how finely the arc was cut.
+ */
+
+static void _calculate_curve_vmax(mpBuf_t *bf)
+{
+    const mpPath_t *p = &bf->cold->path;
+    float radius = min(p->radius, p->radius + p->radius_travel);
+    float vmax = 8675309;
+    const uint8_t plane[] = { p->plane_axis_0, p->plane_axis_1 };
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        vmax = min(vmax, _centripetal_vmax(plane[i], radius));
+    }
+    if (vmax < bf->cruise_vset)
+    {
+        bf->cruise_vset = vmax;
+        bf->cruise_vmax = vmax;
+        bf->block_time = bf->length / vmax;
+    }
+    bf->absolute_vmax = min(bf->absolute_vmax, vmax);
+}
+
 /****************************************************************************************
  * _calculate_junction_vmax() - 最大出口速度可以通过交汇点。
  *
@@ -795,6 +1483,7 @@ static void _calculate_junction_vmax(mpBuf_t *bf)
     // If we change cruise_vmax, we'll need to recompute junction_vmax, if we do this:
     //    float velocity = min(bf->cruise_vmax, bf->nx->cruise_vmax);  // start with our maximum possible velocity
     float velocity = 8675309;
+    const float *exit_unit = (bf->cold->path.type == PATH_ARC) ? bf->cold->path.exit_unit : bf->unit;
 
     // cmAxes jerk_axis = AXIS_X;   // a diagnostic in case you want to find the limiting axis
 
@@ -802,7 +1491,7 @@ static void _calculate_junction_vmax(mpBuf_t *bf)
     {
         if (bf->axis_flags[axis] || bf->nx->axis_flags[axis])
         {                                                            // skip axes with no movement
-            float delta = fabs(bf->unit[axis] - bf->nx->unit[axis]); // formula (1)
+            float delta = fabs(exit_unit[axis] - bf->nx->unit[axis]); // formula (1)
 
             // Corner case: If an axis has zero delta, we might have a straight line.
             // Corner case: An axis doesn't change (and it's not a straight line).
@@ -822,3 +1511,98 @@ static void _calculate_junction_vmax(mpBuf_t *bf)
     }
     bf->junction_vmax = velocity;
 }
+
+/****************************************************************************************
+ * _calculate_curve_junction_vmax() - junction velocity from the curvature of a tessellated curve
+ *
+ *  CAM output cuts curves into short lines, and _calculate_junction_vmax() limits each small
+ *  corner on its own. That limit follows the chord length rather than the curve, so the feed
+ *  jitters from junction to junction and is usually lower than the curve needs.
+ *
+ *  If the junction at the end of bf is one of a run of line blocks that turn the same way by
+ *  small, similar angles, the run is taken as samples of one curve. Its radius is fitted as
+ *  the path length around the junctions over the total turn, and the junction is limited by
+ *  the centripetal limit of every moving axis instead (_centripetal_vmax(), as for arcs).
+ *
+ *  The window looks back from bf->nx over up to CURVE_WINDOW blocks, stopping at anything
+ *  that isn't a queued XYZ line. A run shorter than 3 blocks, a sharper turn than
+ *  CURVE_ANGLE_MAX, or a reversal of the turn is a corner and keeps the junction limit.
+ */
+
+static bool _curve_block(const mpBuf_t *bf)
+{
+    if ((bf->buffer_state == MP_BUFFER_EMPTY) || (bf->block_type != BLOCK_TYPE_ALINE) ||
+        (bf->cold->path.type != PATH_LINE))
+    {
+        return (false);
+    }
+    for (uint8_t axis = AXIS_Z + 1; axis < AXES; axis++)
+    {
+        if (bf->axis_flags[axis])
+        {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+static void _calculate_curve_junction_vmax(mpBuf_t *bf)
+{
+    mpBuf_t *b = bf->nx;
+    float arc_length = 0;
+    float turn = 0;
+    float turn_min = 8675309;
+    float turn_max = 0;
+    float length_min = b->length;
+    float length_max = b->length;
+    float last_normal[3] = { 0, 0, 0 };
+    uint8_t junctions = 0;
+
+    if (!_curve_block(b))
+    {
+        return;
+    }
+    for (uint8_t i = 1; i < CURVE_WINDOW; i++, b = b->pv)
+    {
+        const mpBuf_t *a = b->pv;
+        if ((a == bf->nx) || !_curve_block(a))
+        {
+            break;
+        }
+        float normal[3] = { a->unit[AXIS_Y] * b->unit[AXIS_Z] - a->unit[AXIS_Z] * b->unit[AXIS_Y],
+                            a->unit[AXIS_Z] * b->unit[AXIS_X] - a->unit[AXIS_X] * b->unit[AXIS_Z],
+                            a->unit[AXIS_X] * b->unit[AXIS_Y] - a->unit[AXIS_Y] * b->unit[AXIS_X] };
+        float cosine = a->unit[AXIS_X] * b->unit[AXIS_X] + a->unit[AXIS_Y] * b->unit[AXIS_Y] +
+                       a->unit[AXIS_Z] * b->unit[AXIS_Z];
+        float angle = atan2f(sqrt(square(normal[0]) + square(normal[1]) + square(normal[2])), cosine);
+
+        if ((angle < EPSILON) || (angle > CURVE_ANGLE_MAX) ||
+            ((normal[0] * last_normal[0] + normal[1] * last_normal[1] + normal[2] * last_normal[2]) < 0))
+        {
+            break; // straight, a corner, or turning back the other way
+        }
+        copy_vector(last_normal, normal);
+        arc_length += (a->length + b->length) / 2;
+        turn += angle;
+        turn_min = min(turn_min, angle);
+        turn_max = max(turn_max, angle);
+        length_min = min(length_min, a->length);
+        length_max = max(length_max, a->length);
+        junctions++;
+    }
+    if ((junctions < 2) || (turn_max > turn_min * CURVE_RATIO_MAX) || (length_max > length_min * CURVE_RATIO_MAX))
+    {
+        return; // not enough of a curve to fit, or the samples don't look like one
+    }
+
+    float radius = arc_length / turn;
+    float velocity = 8675309;
+    for (uint8_t axis = AXIS_X; axis <= AXIS_Z; axis++)
+    {
+        if (bf->axis_flags[axis] || bf->nx->axis_flags[axis])
+        {
+            velocity = min(velocity, _centripetal_vmax(axis, radius));
+        }
+    }
+    bf->junction_vmax = velocity;
+}
@@ -37,13 +37,6 @@
 
 stat_t _ramp_exit_logger(mpBuf_t* bf, const char *msg)
 {
-    #ifdef __PLANNER_DIAGNOSTICS
-    if (mp_runtime_is_idle()) {  // normally the runtime keeps this value fresh
-//      bf->time_in_plan_ms += bf->block_time_ms;
-        bf->plannable_time_ms += bf->block_time_ms;\
-    }
-    #endif
-
 /* insert logger functions here if needed:
 
     // LOG_RETURN with full state dump
@@ -405,55 +398,36 @@ float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t* bf)
  *  Get the velocity that we would end up at if we decelerated from v_0,
  *  over the provided L (length) and J (jerk, provided in the bf structure).
  *
- *  We have to use a root finding solution, since there are actually three possible
- *  solutions. We can eliminate one quickly, since it's the acceleration case.
+ *  With s = sqrt(v_0 - v_1) the length equation L = q/(2 sqrt(J)) * s * (v_0 + v_1)
+ *  becomes the depressed cubic s^3 - 2 v_0 s + L/(q/(2 sqrt(J))) = 0. Of its three
+ *  roots one is negative, and the smaller positive one is the first velocity reached
+ *  while decelerating. That root is taken directly from the trigonometric form, so a
+ *  feedhold that spans blocks costs the same fixed handful of operations per block
+ *  rather than a data dependent number of Newton iterations. The jerk term is
+ *  precomputed per block by the planner (bf->q_recip_2_sqrt_j), as it is for the
+ *  braking length in mp_get_target_length().
  *
- *  The other two cases are occasionally the same value, but this is rare.
- *  Otherwise there is a "high" value and a "low" value. The low value can be
- *  negative and then eliminated.
+ *  This function should only be used to compute feedholds or other cases where
+ *  exact velocity is not mandatory.
  *
- *  This function may generate minor errors in target velocity, and should only
- *  be used to compute feedholds or other cases where exact velocity is not mandatory. 
- *
- *  This function can fail if the length is too short to get a good answer. 
- *  Failures return (float)-1.0  Negative velocities should never be returned.
+ *  This function fails if the length is too long to be covered by a deceleration
+ *  from v_0 (no real root). Failures return (float)-1.0  Negative velocities should
+ *  never be returned.
  */
 
+// 6 *, 1 /, 2 sqrt, 1 acos, 1 cos
 float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf) 
 {
-    const float q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
-    float v_1 = 0;              // start the guess at zero
-
-    int i = 0;                  // limit the iterations
-    while (i++ < 20) {          // If it fails after 20 iterations something's wrong
-
-        // l_t is the difference in length between the L provided and the current guessed deceleration length
-        const float sqrt_delta_v_0 = sqrt(v_0 - v_1);
-        const float l_t = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0)) - L;
-
-        // The return condition allows a minor error in length (in mm). 
-        // Note: This comparison does NOT affect actual lengths or steps, which would be bad.
-        //       The actual lengths traveled must be controlled by the caller.
-        if (fabs(l_t) < 0.001) {
-            break;
-        }
-        // For the first pass we tested velocity 0. If velocity 0 yields a l_t > 0, 
-        // then we need to start searching at v_1 instead. 
-        // (We can't start AT v_1, so we start at v_1 - 0.1)
-        if (i==1 && (l_t > 0)) {
-            v_1 = v_0 - 0.1;
-            continue;
-        }
-        const float v_1x3 = 3 * v_1;
-        const float recip_l_t = (2 * sqrt_delta_v_0) / ((v_0 - v_1x3) * q_recip_2_sqrt_j);
-        v_1 = v_1 - (l_t * recip_l_t);
-        
-        // In some extreme cases there is no solution because the length is too short
-        if (v_1 > v_0) {
-            return (-1.0);    // cannot decelerate. Return an error
-        }
+    if (v_0 < EPSILON) {
+        return (0);
     }
-    return v_1;
+    const float m = sqrt(v_0 * (float)(2.0 / 3.0));        // sqrt(-p/3) for p = -2 v_0
+    const float cos_phi = -L / (bf->q_recip_2_sqrt_j * 2 * m * m * m);
+    if (cos_phi < -1) {
+        return (-1.0);          // cannot decelerate. Return an error
+    }
+    const float s = 2 * m * cos(acos(cos_phi) * (float)(1.0 / 3.0) - (float)(2.0 * M_PI / 3.0));
+    return (max(v_0 - s * s, (float)0));
 }
 
 //Is there a way to derive the average slope of a deceleration given the starting velocity, length and jerk? We don't need the
@@ -465,6 +439,18 @@ float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf)
  * and jerk (J), will locate the velocity v_1 that will allow acceleration from v_0
  * at jerk J to v_1 and then deceleration at jerk J to v_2, all over total length L.
  *
+ * The head plus tail length l(v_1) has no closed-form inverse, so it is solved with a
+ * bracketed (safeguarded) Newton iteration:
+ *
+ *  - lo = max(v_0, v_2) is a lower bound. If l(lo) already fills L there is no meet
+ *    velocity and the block is a single ramp with a body (Case 2), decided up front.
+ *  - hi = the velocity reached ramping from min(v_0, v_2) over all of L is an upper bound,
+ *    since the other ramp can only add length.
+ *  - Each Newton step that would leave (lo, hi) is replaced by a bisection, and the
+ *    bracket shrinks every pass. l(v_1) changes curvature at 5/3 of the lower velocity,
+ *    so unguarded Newton could overshoot below lo and be mistaken for Case 2.
+ *  - After MEET_ITERATIONS_MAX passes the solver settles on lo, which always fits
+ *    (the rest becomes body), so the worst case forward planning time is bounded.
  */
 
 static float _get_meet_velocity(const float          v_0,
@@ -478,11 +464,6 @@ static float _get_meet_velocity(const float          v_0,
     // v_1 can never be smaller than v_0 or v_2, so we keep track of this value
     const float min_v_1 = max(v_0, v_2);
 
-    // v_1 is our estimated return value.
-    // We estimate with the speed obtained by L/2 traveled from the highest speed of v_0 or v_2.
-    float v_1 = mp_get_target_velocity(min_v_1, L / 2.0, bf);
-    // var v_1 = min_v_1 + 100;
-
     if (fp_EQ(v_0, v_2)) {
         // Case (1)
         // We can catch a symmetric case early and return now
@@ -492,58 +473,59 @@ static float _get_meet_velocity(const float          v_0,
         block->body_length = 0;
         block->tail_length = L - block->head_length;
         SET_PLANNER_ITERATIONS(-1);     // DIAGNOSTIC
-        return v_1;
+        return (mp_get_target_velocity(min_v_1, L / 2.0, bf));
     }
 
-    // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
-    int i = 0;          // limit the iterations // 466us - 644us
-    while (i++ < 30) {  // If it fails after 30, something's wrong
-        if (v_1 < min_v_1) {
-            // Case (2)
-            // We have caught a rather nasty problem. There is no meet velocity.
-            // This is due to an inversion in the velocities of very short moves.
-            // We need to compute the head OR tail length, and the body will be the rest.
-            // Yes, that means we're computing a cruise in here.
-
-            v_1 = min_v_1;
-
-            if (v_0 < v_2) {
-                // acceleration - it'll be a head/body
-                block->head_length = mp_get_target_length(v_0, v_2, bf);
-                if (block->head_length > L) {
-                    block->head_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_0, L, bf);
-                } else {
-                    block->body_length = L - block->head_length;
-                }
-                block->tail_length = 0;
-
+    if (mp_get_target_length(min(v_0, v_2), min_v_1, bf) >= L) {
+        // Case (2)
+        // There is no meet velocity. This is due to an inversion in the velocities of very
+        // short moves. We need to compute the head OR tail length, and the body will be the rest.
+        // Yes, that means we're computing a cruise in here.
+        float v_1 = min_v_1;
+        if (v_0 < v_2) {
+            // acceleration - it'll be a head/body
+            block->head_length = mp_get_target_length(v_0, v_2, bf);
+            if (block->head_length > L) {
+                block->head_length = L;
+                block->body_length = 0;
+                v_1 = mp_get_target_velocity(v_0, L, bf);
             } else {
-                // deceleration - it'll be tail/body
-                block->tail_length = mp_get_target_length(v_2, v_0, bf);
-                if (block->tail_length > L) {
-                    block->tail_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_2, L, bf);
-                } else {
-                    block->body_length = L - block->tail_length;
-                }
-                block->head_length = 0;
+                block->body_length = L - block->head_length;
             }
+            block->tail_length = 0;
 
-            break;
+        } else {
+            // deceleration - it'll be tail/body
+            block->tail_length = mp_get_target_length(v_2, v_0, bf);
+            if (block->tail_length > L) {
+                block->tail_length = L;
+                block->body_length = 0;
+                v_1 = mp_get_target_velocity(v_2, L, bf);
+            } else {
+                block->body_length = L - block->tail_length;
+            }
+            block->head_length = 0;
         }
+        SET_MEET_ITERATIONS(0);     // DIAGNOSTIC
+        return (v_1);
+    }
+
+    // bracket the meet velocity. l(lo) < L <= l(hi)
+    float lo = min_v_1;
+    float hi = mp_get_target_velocity(min(v_0, v_2), L, bf);
 
-        // Precompute some common chunks -- note that some attempts may have v_1 < v_0 or v_1 < v_2
+    // We estimate with the speed obtained by L/2 traveled from the highest speed of v_0 or v_2.
+    float v_1 = min(mp_get_target_velocity(min_v_1, L / 2.0, bf), hi);
+
+    // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
+    uint8_t i = 0;
+    while (true) {
+        // Precompute some common chunks
         const float sqrt_delta_v_0 = sqrt(fabs(v_1 - v_0));
-        const float sqrt_delta_v_2 = sqrt(fabs(v_1 - v_2));  // 849us
+        const float sqrt_delta_v_2 = sqrt(fabs(v_1 - v_2));
 
         // l_c is our total-length calculation with the current v_1 estimate, minus the expected length.
         // This makes l_c == 0 when v_1 is the correct value.
-
-        // GAMBLE: At the cost of one more multiply per iteration, we will keep the two length calculations seperate.
-        // This allows us to store the resulting head/tail lengths.
         const float l_h = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0));
         const float l_t = q_recip_2_sqrt_j * (sqrt_delta_v_2 * (v_1 + v_2));
         const float l_c = (l_h + l_t) - L;
@@ -568,12 +550,28 @@ static float _get_meet_velocity(const float          v_0,
             }
             break;
         }
+        if (i++ == MEET_ITERATIONS_MAX) {
+            // Case (3c) - out of iterations. lo always fits; the remainder is body
+            v_1 = lo;
+            block->head_length = mp_get_target_length(v_0, v_1, bf);
+            block->tail_length = mp_get_target_length(v_2, v_1, bf);
+            block->body_length = max(L - block->head_length - block->tail_length, (float)0);
+            break;
+        }
 
+        if (l_c < 0) {
+            lo = v_1;
+        } else {
+            hi = v_1;
+        }
         const float v_1x3     = 3 * v_1;
         const float recip_l_d = (2 * sqrt_delta_v_0 * sqrt_delta_v_2) /
                                 ((sqrt_delta_v_0 * (v_1x3 - v_2) - (v_0 - v_1x3) * sqrt_delta_v_2) * q_recip_2_sqrt_j);
 
         v_1 = v_1 - (l_c * recip_l_d);
+        if (!((v_1 > lo) && (v_1 < hi))) {     // also catches NaN
+            v_1 = (lo + hi) / 2;
+        }
     }
     SET_MEET_ITERATIONS(i);     // DIAGNOSTIC
     return v_1;
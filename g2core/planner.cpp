@@ -62,7 +62,10 @@
 #include "report.h"
 #include "util.h"
 #include "json_parser.h"
+#include "text_parser.h"
 #include "xio.h"
+#include "temperature.h"
+#include "shaper.h"
 
 // Allocate planner structures
 
@@ -74,8 +77,19 @@ mpPlannerRuntime_t *mr; // 规划器块运行时的上下文
 mpPlannerRuntime_t mr1; // 初步计划运行时上下文
 mpPlannerRuntime_t mr2; // 二级计划程序运行时上下文
 
-mpBuf_t mp1_queue[PLANNER_QUEUE_SIZE];   // 主计划程序队列缓冲区的存储分配
-mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE]; // 二次规划器队列缓冲器存储分配
+mpBuf_t mp_pool[PLANNER_POOL_SIZE];          // 主、二次规划器队列缓冲区的存储分配
+mpBufCold_t mp_pool_cold[PLANNER_POOL_SIZE]; // cold records for the planner pool
+mpDiag_t mp_diag;                            // planner diagnostics ring (see planner.h)
+static bool mp_pool_lent;                    // true while the shared buffers belong to the secondary planner
+
+static_assert(PLANNER_QUEUE_SIZE > PLANNER_BUFFER_HEADROOM, "PLANNER_QUEUE_SIZE must exceed PLANNER_BUFFER_HEADROOM");
+static_assert(((PLANNER_ACTIONS & (PLANNER_ACTIONS - 1)) == 0) && (PLANNER_ACTIONS <= 128),
+              "PLANNER_ACTIONS must be a power of 2 that fits the uint8_t action indexes");
+static_assert(PLANNER_POOL_SIZE <= UINT16_MAX, "PLANNER_QUEUE_SIZE is limited to 65535 less the secondary queue");
+static_assert((SECONDARY_QUEUE_MIN > PLANNER_BUFFER_HEADROOM) && (SECONDARY_QUEUE_MIN <= SECONDARY_QUEUE_SIZE),
+              "SECONDARY_QUEUE_MIN must exceed PLANNER_BUFFER_HEADROOM and not exceed SECONDARY_QUEUE_SIZE");
+static_assert(sizeof(mp_pool) + sizeof(mp_pool_cold) <= PLANNER_QUEUE_MEMORY_MAX,
+              "planner queues exceed PLANNER_QUEUE_MEMORY_MAX - reduce PLANNER_QUEUE_SIZE or raise the board budget");
 
 // Execution routines (NB: These are called from the LO interrupt)
 static stat_t _exec_dwell(mpBuf_t *bf);
@@ -84,68 +98,95 @@ static stat_t _exec_command(mpBuf_t *bf);
 // DIAGNOSTICS
 //static void _planner_time_accounting();
 static void _audit_buffers();
+static bool _gm_context_free(const mpPlanner_t *_mp);
+static void _diag_commit(const mpBuf_t *bf);
+static void _diag_free(const mpBuf_t *bf);
 
 /****************************************************************************************
  * JSON planner objects
+ *
+ *  Queued JSON commands - M100, M101 and (MSG) comments, which arrive as {msg:"..."} -
+ *  are kept in a byte arena until their block runs, each taking only its length plus a
+ *  2 byte size (the JSON parser cuts the string up in place, so its length can't be read
+ *  back). They run and are freed in queue order, so the arena is a ring: a command that
+ *  doesn't fit before the end leaves a zero size at its write point and starts over at
+ *  the front. The planner reports full while a command of the longest line would not
+ *  fit, so writes never fail. The arena is the size the three fixed line buffers used to
+ *  be, but holds dozens of messages instead of three.
  */
 
-#define JSON_COMMAND_BUFFER_SIZE 3
-
-struct json_command_buffer_t
-{
-    char buf[RX_BUFFER_SIZE];
-    json_command_buffer_t *pv;
-    json_command_buffer_t *nx;
-};
+#define JSON_COMMAND_ARENA_SIZE (3 * RX_BUFFER_SIZE)
+#define JSON_COMMAND_MAX (RX_BUFFER_SIZE + 2)      // longest command with its size
 
 struct _json_commands_t
 {
-    json_command_buffer_t _json_bf[JSON_COMMAND_BUFFER_SIZE]; // storage of all buffers
-    json_command_buffer_t *_json_r;                           // pointer to the next "run" buffer
-    json_command_buffer_t *_json_w;                           // pointer tot he next "write" buffer
+    char arena[JSON_COMMAND_ARENA_SIZE];
+    uint16_t r;                     // start of the next command to run
+    uint16_t w;                     // where the next command is written
+    uint16_t used;                  // bytes held, including a skipped tail
 
-    int8_t available;
+    _json_commands_t() { reset(); };
 
-    // Constructor (initializer)
-    _json_commands_t()
+    // True if a command of any length the controller accepts can be written
+    bool room() const
     {
-        json_command_buffer_t *js_pv = &_json_bf[JSON_COMMAND_BUFFER_SIZE - 1];
-        for (uint8_t i = 0; i < JSON_COMMAND_BUFFER_SIZE; i++)
-        {
-            _json_bf[i].nx = &_json_bf[((i + 1 == JSON_COMMAND_BUFFER_SIZE) ? 0 : i + 1)];
-            _json_bf[i].pv = js_pv;
-            js_pv = &_json_bf[i];
+        if (used == 0) {
+            return (true);
         }
-        reset();
+        if (w > r) {
+            return (((JSON_COMMAND_ARENA_SIZE - w) >= JSON_COMMAND_MAX) || (r >= JSON_COMMAND_MAX));
+        }
+        return ((r - w) >= JSON_COMMAND_MAX);
     };
 
-    // Write a json command to the buffer, using up one slot
-    void write_buffer(char *new_json)
+    // Write a json command behind the others
+    void write_buffer(const char *new_json)
     {
-        strcpy(_json_w->buf, new_json);
-        available--;
-        _json_w = _json_w->nx;
+        uint16_t size = strlen(new_json) + 3;
+        if (used == 0) {
+            r = w = 0;
+        } else if ((JSON_COMMAND_ARENA_SIZE - w) < size) {  // wrap - the reader skips the tail
+            if ((JSON_COMMAND_ARENA_SIZE - w) >= 2) {
+                arena[w] = arena[w + 1] = 0;
+            }
+            used += JSON_COMMAND_ARENA_SIZE - w;
+            w = 0;
+        }
+        memcpy(&arena[w], &size, 2);
+        memcpy(&arena[w + 2], new_json, size - 2);
+        w += size;
+        used += size;
     };
 
-    // Read a buffer out, but do NOT free it (so it can be used directly)
+    // Read the next command, but do NOT free it (so it can be used directly)
     char *read_buffer()
     {
-        return _json_r->buf;
+        uint16_t size = 0;
+        if ((JSON_COMMAND_ARENA_SIZE - r) >= 2) {
+            memcpy(&size, &arena[r], 2);
+        }
+        if (size == 0) {                                    // skipped tail
+            used -= JSON_COMMAND_ARENA_SIZE - r;
+            r = 0;
+        }
+        return (&arena[r + 2]);
     };
 
-    // Free the last read buffer.
+    // Free the last command read
     void free_buffer()
     {
-        _json_r = _json_r->nx;
-        available++;
+        uint16_t size;
+        memcpy(&size, &arena[r], 2);
+        r += size;
+        used -= size;
     }
 
     // Reset the JSON command queue
     void reset()
     {
-        _json_r = &_json_bf[0];
-        _json_w = _json_r;
-        available = JSON_COMMAND_BUFFER_SIZE;
+        r = 0;
+        w = 0;
+        used = 0;
     }
 };
 _json_commands_t jc;
@@ -154,13 +195,19 @@ _json_commands_t jc;
  * planner_init() - initialize MP, MR and planner queue buffers
  * planner_reset() - selective reset MP and MR structures
  * planner_assert() - test planner assertions, PANIC if violation exists
+ *
+ *  planner_reset() runs on every alarm, shutdown and queue flush, so it doesn't clear and
+ *  relink the buffer pool as init does. _flush_planner_queue() marks the queued buffers
+ *  empty in place - one store per queued block - and leaves the ring as it is.
+ *  mp_get_write_buffer() clears each buffer when it is next taken, so the cost of a
+ *  flush doesn't grow with PLANNER_QUEUE_SIZE.
  */
 
 // initialize a planner queue
-void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
+void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, mpBufCold_t *cold, uint16_t size)
 {
     mpBuf_t *pv, *nx;
-    uint8_t i, nx_i;
+    uint16_t i, nx_i;
     mpPlannerQueue_t *q = &(_mp->q);
 
     memset(q, 0, sizeof(mpPlannerQueue_t)); // clear values, pointers and status
@@ -168,7 +215,15 @@ void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
     q->magic_end = MAGICNUM;
 
     memset(queue, 0, sizeof(mpBuf_t) * size); // clear all buffers in queue
+    memset(cold, 0, sizeof(mpBufCold_t) * size);
+    memset(_mp->gm_context_in, 0, sizeof(_mp->gm_context_in)); // no block holds a gcode context
+    memset((void *)_mp->gm_context_out, 0, sizeof(_mp->gm_context_out));
+    _mp->gm_context_last = 0;
+    _mp->action_in = 0;                       // no block holds an action
+    _mp->action_out = 0;
+    _mp->action_block = NULL;
     q->bf = queue;                            // link the buffer pool first
+    q->cold = cold;
     q->w = queue;                             // init all buffer pointers
     q->r = queue;
     q->queue_size = size;
@@ -177,7 +232,8 @@ void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
     pv = &q->bf[size - 1];
     for (i = 0; i < size; i++)
     {
-        q->bf[i].buffer_number = i;            // number is for diagnostics only (otherwise not used)
+        q->bf[i].buffer_number = (uint16_t)(&q->bf[i] - mp_pool); // pool index, for diagnostics only
+        q->bf[i].cold = &cold[i];              // hot and cold records share an index
         nx_i = ((i < size - 1) ? (i + 1) : 0); // buffer increment & wrap
         nx = &q->bf[nx_i];
         q->bf[i].nx = nx; // setup circular list pointers
@@ -187,7 +243,38 @@ void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
     q->bf[size - 1].nx = queue;
 }
 
-void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uint8_t queue_size)
+// empty a planner queue in place (see planner_reset())
+static void _flush_planner_queue(mpPlanner_t *_mp)
+{
+    mpPlannerQueue_t *q = &(_mp->q);
+    mpBuf_t *bf = q->r;
+
+    // queued buffers run contiguously from r, ending at w or the buffer before it
+    for (uint16_t i = 0; (i < q->queue_size) && (bf->buffer_state != MP_BUFFER_EMPTY); i++)
+    {
+        bf->buffer_state = MP_BUFFER_EMPTY;
+        bf->plannable = false;  // priming stops at the first block that isn't plannable
+        bf = bf->nx;
+    }
+    q->w = q->r;
+    q->buffers_available = q->queue_size;
+    q->horizon_in_usec = 0;
+    q->horizon_out_usec = 0;
+    q->horizon_in_um = 0;
+    q->horizon_out_um = 0;
+    q->time_in_usec = 0;
+    q->time_plan_usec = 0;
+    q->time_out_usec = 0;
+
+    memset(_mp->gm_context_in, 0, sizeof(_mp->gm_context_in)); // no block holds a gcode context
+    memset((void *)_mp->gm_context_out, 0, sizeof(_mp->gm_context_out));
+    _mp->gm_context_last = 0;
+    _mp->action_in = 0; // no block holds an action
+    _mp->action_out = 0;
+    _mp->action_block = NULL;
+}
+
+void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, mpBufCold_t *cold, uint16_t queue_size)
 {
     // init planner master structure
     memset(_mp, 0, sizeof(mpPlanner_t)); // clear all values, pointers and status
@@ -197,16 +284,19 @@ void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uin
 
     // init planner queues
     _mp->q.bf = queue; // assign puffer pool to queue manager structure
-    _init_planner_queue(_mp, queue, queue_size);
+    _init_planner_queue(_mp, queue, cold, queue_size);
 
     // init runtime structs
     _mp->mr = _mr;
     memset(_mr, 0, sizeof(mpPlannerRuntime_t)); // clear all values, pointers and status
     _mr->magic_start = MAGICNUM;                // mr assertions
     _mr->magic_end = MAGICNUM;
+    _mr->segment_usec = NOM_SEGMENT_USEC;
 
-    _mr->block[0].nx = &_mr->block[1]; // Handle the two "stub blocks" in the runtime structure
-    _mr->block[1].nx = &_mr->block[0];
+    for (uint8_t i = 0; i < MR_BLOCKS; i++) // link the runtime block ring
+    {
+        _mr->block[i].nx = &_mr->block[(i + 1) % MR_BLOCKS];
+    }
     _mr->r = &_mr->block[0];
     _mr->p = &_mr->block[1];
 }
@@ -217,7 +307,8 @@ void planner_reset(mpPlanner_t *_mp) // reset planner queue, cease MR activity,
     _mp->reset();
     _mp->mr->reset();
     jc.reset();
-    _init_planner_queue(_mp, _mp->q.bf, _mp->q.queue_size); // reset planner buffers
+    _flush_planner_queue(_mp); // empty the planner buffers
+    mp_clear_queue_stats(_mp);
 }
 
 stat_t planner_assert(const mpPlanner_t *_mp)
@@ -227,9 +318,9 @@ stat_t planner_assert(const mpPlanner_t *_mp)
     {
         return (cm_panic(STAT_PLANNER_ASSERTION_FAILURE, "planner_assert()"));
     }
-    for (uint8_t i = 0; i < _mp->q.queue_size; i++)
+    for (uint16_t i = 0; i < _mp->q.queue_size; i++)
     {
-        if ((_mp->q.bf[i].nx == nullptr) || (_mp->q.bf[i].pv == nullptr))
+        if ((_mp->q.bf[i].nx == nullptr) || (_mp->q.bf[i].pv == nullptr) || (_mp->q.bf[i].cold == nullptr))
         {
             return (cm_panic(STAT_PLANNER_ASSERTION_FAILURE, "planner buffer is corrupted"));
         }
@@ -237,6 +328,105 @@ stat_t planner_assert(const mpPlanner_t *_mp)
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * mp_pool_lend()    - lend the shared pool buffers to the secondary planner if they are free
+ * mp_pool_reclaim() - give lent buffers back to the primary once the secondary is done
+ *
+ *  Both planners draw their buffers from one pool (mp_pool). The last SECONDARY_QUEUE_MIN
+ *  buffers always belong to the secondary. The buffers ahead of them, up to
+ *  SECONDARY_QUEUE_SIZE in all, are shared: the primary holds them during normal cutting,
+ *  which deepens its lookahead, and lends them out for feedhold actions.
+ *
+ *  mp_pool_lend() is called from _enter_p2() with primary motion stopped. The shared
+ *  buffers are unlinked from the primary ring if they are all empty and linked with the
+ *  reserve into a new secondary ring, otherwise the secondary runs on its reserve alone.
+ *  The caller resets the secondary planner afterwards.
+ *  mp_pool_reclaim() is polled by the planner callback and splices the shared buffers back
+ *  into the primary ring ahead of its write pointer once the primary is the active planner
+ *  and the secondary queue has drained.
+ */
+
+static void _pool_unlink(mpPlanner_t *_mp, mpBuf_t *bf)
+{
+    mpBuf_t *nx = bf->nx;
+
+    bf->pv->nx = nx;
+    nx->pv = bf->pv;
+    if (_mp->q.w == bf) { _mp->q.w = nx; }      // only an empty queue has r on an empty buffer
+    if (_mp->q.r == bf) { _mp->q.r = nx; }
+    if (_mp->p == bf) { _mp->p = nx; }
+    if (_mp->c == bf) { _mp->c = nx; }
+    if (_mp->planning_return == bf) { _mp->planning_return = nx; }
+}
+
+static void _pool_reclaim(bool force)
+{
+    if (!mp_pool_lent || (!force && ((mp == &mp2) || (mp2.q.buffers_available != mp2.q.queue_size))))
+    {
+        return;
+    }
+    mpBuf_t *shared = &mp_pool[PLANNER_QUEUE_SIZE];
+    mpBufCold_t *shared_cold = &mp_pool_cold[PLANNER_QUEUE_SIZE];
+    const uint16_t count = PRIMARY_POOL_SIZE - PLANNER_QUEUE_SIZE;
+
+    // back to the reserve; the secondary is idle so there is nothing to keep
+    _init_planner_queue(&mp2, &mp_pool[PRIMARY_POOL_SIZE], &mp_pool_cold[PRIMARY_POOL_SIZE], SECONDARY_QUEUE_MIN);
+
+    mpPlannerQueue_t *q = &mp1.q;
+    mpBuf_t *w = q->w;
+    mpBuf_t *pv = w->pv;
+    memset(shared, 0, sizeof(mpBuf_t) * count);
+    memset(shared_cold, 0, sizeof(mpBufCold_t) * count);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        shared[i].buffer_number = PLANNER_QUEUE_SIZE + i;
+        shared[i].cold = &shared_cold[i];
+        shared[i].pv = (i == 0) ? pv : &shared[i - 1];
+        shared[i].nx = (i == count - 1) ? w : &shared[i + 1];
+    }
+    pv->nx = shared;
+    w->pv = &shared[count - 1];
+
+    // the new buffers are the next to be written, so pointers waiting at w move back to them
+    if (q->buffers_available == q->queue_size) { q->r = shared; }
+    if (mp1.p == w) { mp1.p = shared; }
+    if (mp1.c == w) { mp1.c = shared; }
+    if (mp1.planning_return == w) { mp1.planning_return = shared; }
+    q->w = shared;
+    q->queue_size += count;
+    q->buffers_available += count;
+    mp_pool_lent = false;
+}
+
+void mp_pool_reclaim() { _pool_reclaim(false); }
+
+void mp_pool_lend()
+{
+    _pool_reclaim(true);                        // the secondary is about to be reset anyway
+
+    mpBuf_t *shared = &mp_pool[PLANNER_QUEUE_SIZE];
+    const uint16_t count = PRIMARY_POOL_SIZE - PLANNER_QUEUE_SIZE;
+    bool lend = (mp1.q.buffers_available > count); // the primary keeps a free buffer at w
+
+    for (uint16_t i = 0; lend && (i < count); i++)
+    {
+        lend = (shared[i].buffer_state == MP_BUFFER_EMPTY);
+    }
+    if (!lend)
+    {
+        return;                                 // the secondary queue is still the reserve
+    }
+    for (uint16_t i = 0; i < count; i++)
+    {
+        _pool_unlink(&mp1, &shared[i]);
+    }
+    mp1.q.queue_size -= count;
+    mp1.q.buffers_available -= count;
+    // shared and reserve buffers are contiguous - link them into one secondary ring
+    _init_planner_queue(&mp2, shared, &mp_pool_cold[PLANNER_QUEUE_SIZE], SECONDARY_QUEUE_SIZE);
+    mp_pool_lent = true;
+}
+
 /****************************************************************************************
  * mp_halt_runtime() - stop runtime movement immediately
  */
@@ -244,6 +434,8 @@ void mp_halt_runtime()
 {
     stepper_reset();   // stop the steppers and dwells
     planner_reset(mp); // reset the active planner
+    raster_reset();    // and drop its raster pixels
+    shaper_reset();    // the motors stopped where they were - nothing left to settle
 }
 
 /****************************************************************************************
@@ -283,13 +475,21 @@ void mp_set_steps_to_runtime_position()
         mr->target_steps[motor] = step_position[motor];
         mr->position_steps[motor] = step_position[motor];
         mr->commanded_steps[motor] = step_position[motor];
+        mr->target_fixed[motor] = mp_steps_to_fixed(step_position[motor]);
+        mr->position_fixed[motor] = mr->target_fixed[motor];
+        mr->commanded_fixed[motor] = mr->target_fixed[motor];
         en_set_encoder_steps(motor, step_position[motor]); // write steps to encoder register
         mr->encoder_steps[motor] = en_read_encoder(motor);
 
         // These must be zero:
         mr->following_error[motor] = 0;
         st_pre.mot[motor].corrected_steps = 0;
+        st_pre.mot[motor].backlash_steps = 0;   // the encoder no longer counts them
+        st_pre.mot[motor].backlash_known = false;
     }
+    mr->motor_settle = 0; // every motor is at rest on its target
+    shaper_reset();
+
 }
 
 /****************************************************************************************
@@ -324,8 +524,8 @@ void mp_queue_command(void (*cm_exec)(float *, bool *), float *value, bool *flag
         return;
     }
     bf->block_type = BLOCK_TYPE_COMMAND;
-    bf->bf_func = _exec_command; // callback to planner queue exec function
-    bf->cm_func = cm_exec;       // callback to canonical machine exec function
+    bf->cold->bf_func = _exec_command; // callback to planner queue exec function
+    bf->cold->cm_func = cm_exec;       // callback to canonical machine exec function
 
     for (uint8_t axis = AXIS_X; axis < AXES; axis++)
     {
@@ -343,7 +543,14 @@ static stat_t _exec_command(mpBuf_t *bf)
 
 stat_t mp_runtime_command(mpBuf_t *bf)
 {
-    bf->cm_func(bf->unit, bf->axis_flags); // 2 vectors used by callbacks
+    if (bf->cold->actions != 0)
+    {
+        mp_runtime_actions(bf->cold->action_first, bf->cold->actions);
+    }
+    else
+    {
+        bf->cold->cm_func(bf->unit, bf->axis_flags); // 2 vectors used by callbacks
+    }
     if (mp_free_run_buffer())
     {
         cm_cycle_end(); // free buffer & perform cycle_end if planner is empty
@@ -351,6 +558,120 @@ stat_t mp_runtime_command(mpBuf_t *bf)
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * mp_queue_action()        - queue a non-motion command, sharing the newest block if it is one
+ * mp_queue_inline_action() - queue a non-motion command to run at the end of the newest move
+ * mp_runtime_actions()     - run a run of actions in queue order (interrupt)
+ *
+ *  The newest block can take more actions until anything else is committed behind it.
+ *  It may already be prepped by the exec - its actions only run when the loader reaches
+ *  it - so interrupts are held off while an action is added. See Planner actions in
+ *  planner.h.
+ *
+ *  An inline action joins the newest move instead, so it doesn't stop motion. If the
+ *  newest block isn't a move, or the move has already run, it is queued as an action.
+ */
+
+static void _set_action(void (*cm_exec)(float *, bool *), float *value, bool *flag)
+{
+    mpAction_t *a = &mp->action[mp->action_in & (PLANNER_ACTIONS - 1)];
+    a->cm_func = cm_exec;
+    a->flags = 0;
+    for (uint8_t i = 0; i < MP_ACTION_VALUES; i++)
+    {
+        a->value[i] = value[i];
+    }
+    for (uint8_t i = 0; (i < AXES) && (i < 8); i++)
+    {
+        a->flags |= (flag[i] ? (1 << i) : 0);
+    }
+}
+
+void mp_queue_action(void (*cm_exec)(float *, bool *), float *value, bool *flag)
+{
+    mp_commit_blend(); // a held G64 P line goes ahead of the action
+
+    if ((uint8_t)(mp->action_in - mp->action_out) >= PLANNER_ACTIONS)
+    {
+        mp->action_block = NULL;
+        mp_queue_command(cm_exec, value, flag); // ring full - use a block of its own
+        return;
+    }
+    _set_action(cm_exec, value, flag);
+
+    __disable_irq();
+    mpBuf_t *bf = mp->action_block;
+    if ((bf != NULL) && (bf->buffer_state != MP_BUFFER_EMPTY)) // still queued - add to it
+    {
+        bf->cold->actions++;
+        mp->action_in++;
+        __enable_irq();
+        return;
+    }
+    __enable_irq();
+
+    if ((bf = mp_get_write_buffer()) == NULL)
+    {
+        cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_queue_action()");
+        return;
+    }
+    bf->block_type = BLOCK_TYPE_COMMAND;
+    bf->cold->bf_func = _exec_command;
+    bf->cold->action_first = mp->action_in++;
+    bf->cold->actions = 1;
+    mp_commit_write_buffer(BLOCK_TYPE_COMMAND);
+    mp->action_block = bf; // after the commit, which clears it
+}
+
+void mp_queue_inline_action(void (*cm_exec)(float *, bool *), float *value, bool *flag)
+{
+    mp_commit_blend(); // a held G64 P line is the move to join
+
+    mpBuf_t *bf = mp->q.w->pv; // newest block
+    if ((bf->block_type != BLOCK_TYPE_ALINE) || ((uint8_t)(mp->action_in - mp->action_out) >= PLANNER_ACTIONS))
+    {
+        mp_queue_action(cm_exec, value, flag);
+        return;
+    }
+    _set_action(cm_exec, value, flag);
+
+    __disable_irq();
+    if (bf->buffer_state != MP_BUFFER_EMPTY) // not run yet - the exec hands its actions over at its end
+    {
+        if (bf->cold->actions == 0)
+        {
+            bf->cold->action_first = mp->action_in;
+        }
+        bf->cold->actions++;
+        mp->action_in++;
+        __enable_irq();
+        return;
+    }
+    __enable_irq();
+    mp_queue_action(cm_exec, value, flag);
+}
+
+void mp_runtime_actions(const uint8_t first, const uint8_t actions)
+{
+    float value[AXES] = {};
+    bool flag[AXES] = {};
+
+    for (uint8_t n = 0; n < actions; n++)
+    {
+        mpAction_t *a = &mp->action[(uint8_t)(first + n) & (PLANNER_ACTIONS - 1)];
+        for (uint8_t i = 0; i < MP_ACTION_VALUES; i++)
+        {
+            value[i] = a->value[i];
+        }
+        for (uint8_t i = 0; (i < AXES) && (i < 8); i++)
+        {
+            flag[i] = (a->flags & (1 << i));
+        }
+        a->cm_func(value, flag);
+    }
+    mp->action_out += actions;
+}
+
 /****************************************************************************************
  * _exec_json_command() - execute json string (from exec system)
  * mp_json_command()    - queue a json command
@@ -430,11 +751,63 @@ stat_t mp_json_wait(char *json_string)
         return STAT_ERROR;
     }
     bf->block_type = BLOCK_TYPE_COMMAND;
-    bf->bf_func = _exec_json_wait;              // callback to planner queue exec function
+    bf->cold->bf_func = _exec_json_wait;              // callback to planner queue exec function
     mp_commit_write_buffer(BLOCK_TYPE_COMMAND); // must be final operation before exit
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * mp_heater_wait()     - queue a wait for a heater to come to temperature
+ * _exec_heater_wait()  - test the heater, and dwell and test again until it's there
+ *
+ *  The heater and threshold are kept in the block's unit vector, as the values of a queued
+ *  command are, so each test is a direct read of the heater - nothing is parsed. A
+ *  threshold of 0 waits for the heater's PID to reach its set point, otherwise the wait
+ *  ends once the heater reads at least the threshold. The block stays at the head of the
+ *  queue while it waits, like any command, so moves behind it wait too.
+ */
+
+#if TEMPERATURE_ENABLED == true
+
+#define HEATER_WAIT_POLL_SECONDS 0.1    // time between tests of a heater wait
+
+static stat_t _exec_heater_wait(mpBuf_t *bf)
+{
+    const uint8_t heater = (uint8_t)bf->unit[0];
+    const float threshold = bf->unit[1];
+
+    bool ready = (threshold > 0) ? (cm_get_temperature(heater) >= threshold) : cm_get_at_temperature(heater);
+    if (!ready)
+    {
+        st_prep_dwell((uint32_t)(HEATER_WAIT_POLL_SECONDS * 1000000.0)); // convert seconds to uSec
+        return (STAT_OK);
+    }
+    if (mp_free_run_buffer())
+    {
+        cm_cycle_end(); // free buffer & perform cycle_end if planner is empty
+    }
+    return (STAT_OK);
+}
+
+void mp_heater_wait(const uint8_t heater, const float threshold)
+{
+    mpBuf_t *bf;
+
+    // Never supposed to fail as buffer availability was checked upstream in the controller
+    if ((bf = mp_get_write_buffer()) == NULL)
+    {
+        cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_heater_wait()");
+        return;
+    }
+    bf->block_type = BLOCK_TYPE_COMMAND;
+    bf->cold->bf_func = _exec_heater_wait; // callback to planner queue exec function
+    bf->unit[0] = heater;
+    bf->unit[1] = threshold;
+    mp_commit_write_buffer(BLOCK_TYPE_COMMAND); // must be final operation before exit
+}
+
+#endif // TEMPERATURE_ENABLED
+
 /****************************************************************************************
  * mp_dwell()    - queue a dwell
  * _exec_dwell() - dwell execution
@@ -452,7 +825,7 @@ stat_t mp_dwell(float seconds)
     {                                                                    // get write buffer or fail
         return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_dwell()")); // not ever supposed to fail
     }
-    bf->bf_func = _exec_dwell; // register callback to dwell start
+    bf->cold->bf_func = _exec_dwell; // register callback to dwell start
     bf->block_time = seconds;  // in seconds, not minutes
     bf->block_state = BLOCK_INITIAL_ACTION;
     mp_commit_write_buffer(BLOCK_TYPE_DWELL); // must be final operation before exit
@@ -476,15 +849,17 @@ static stat_t _exec_dwell(mpBuf_t *bf)
  *  The dwell will only be queued if the time is non-zero, and will only be executed
  *  if the runtime has been stopped. This function is typically called from an exec 
  *  such as _exec_spindle_control(). The dwell move is executed from mp_exec_move(). 
- *  This is useful for queuing a dwell after a spindle change. 
+ *  This is useful for queuing a dwell after a spindle change. If release is given it
+ *  can end the dwell early, and seconds is the timeout (see spindle at-speed input).
  */
 
-void mp_request_out_of_band_dwell(float seconds)
+void mp_request_out_of_band_dwell(float seconds, bool (*release)(void))
 {
     if (fp_NOT_ZERO(seconds))
     {
         mr->out_of_band_dwell_flag = true;
         mr->out_of_band_dwell_seconds = seconds;
+        mr->out_of_band_dwell_release = release;
     }
 }
 
@@ -497,15 +872,45 @@ void mp_request_out_of_band_dwell(float seconds)
  * mp_is_it_phat_city_time() - test if there is time for non-essential processes
  */
 
-uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp) // which planner are you interested in?
+uint16_t mp_get_planner_buffers(const mpPlanner_t *_mp) // which planner are you interested in?
 {
     return (_mp->q.buffers_available);
 }
 
+/*
+ * mp_clear_queue_stats() - start a new queue metrics window
+ *
+ *  Depth min and max restart from the current depth. The starved and backplan counts are
+ *  cleared too, so each queue report covers the time since the previous one.
+ */
+
+void mp_clear_queue_stats(mpPlanner_t *_mp)
+{
+    uint16_t depth = _mp->q.queue_size - _mp->q.buffers_available;
+    _mp->stats.depth_min = depth;
+    _mp->stats.depth_max = depth;
+    _mp->stats.starved = 0;
+    _mp->stats.backplans = 0;
+}
+
 bool mp_planner_is_full(const mpPlanner_t *_mp) // which planner are you interested in?
 {
     // 我们还需要确保我们有另一个JSON命令的空间
-    return ((_mp->q.buffers_available < PLANNER_BUFFER_HEADROOM) || (jc.available == 0));
+    if ((_mp->q.buffers_available < PLANNER_BUFFER_HEADROOM) || !jc.room() || !_gm_context_free(_mp))
+    {
+        return (true);
+    }
+#if PLANNER_HORIZON_ENABLED == true
+    // Only once motion is under way - a full horizon must drain on its own, as callers
+    // spin on this. Startup still waits for a full queue or the block timeout.
+    // Unsigned differences of the free running counters are correct across wraps.
+    const mpPlannerQueue_t *q = &(_mp->q);
+    return ((_mp->planner_state > PLANNER_STARTUP) &&
+            ((uint32_t)(q->horizon_in_usec - q->horizon_out_usec) >= PLANNER_HORIZON_USEC) &&
+            (((uint32_t)(q->horizon_in_um - q->horizon_out_um) * 0.001) >= _mp->horizon_brake));
+#else
+    return (false);
+#endif
 }
 
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp) // 您对哪个策划人感兴趣？）
@@ -559,6 +964,8 @@ bool mp_is_phat_city_time()
 
 stat_t mp_planner_callback()
 {
+    mp_pool_reclaim(); // return buffers lent for feedhold actions once they are done
+
     // 测试计划程序是否已转换为IDLE状态
     if ((mp->q.buffers_available == mp->q.queue_size) && // 检测并设置IDLE状态
         (cm->motion_state == MOTION_STOP) && (cm->hold_state == FEEDHOLD_OFF))
@@ -571,6 +978,8 @@ stat_t mp_planner_callback()
     if (_timed_out)
     {
         mp->block_timeout.clear(); // timer is set on commit_write_buffer()
+        mp->stats.starved++;
+        mp_commit_blend();         // the held line's corner won't come - plan it as an end
     }
 
     if (!mp->request_planning && !_timed_out)
@@ -586,7 +995,10 @@ stat_t mp_planner_callback()
     }
     if (mp->planner_state == PLANNER_STARTUP)
     {
-        if (!mp_planner_is_full(mp) && !_timed_out)
+        // The secondary planner only runs feedhold and cycle action sequences, which are
+        // queued in one pass of the main loop. Waiting for more blocks would only add the
+        // block timeout to every p1/p2 transition, so it starts planning at once.
+        if (!mp_planner_is_full(mp) && !_timed_out && (mp != &mp2))
         {
             return (STAT_OK); // remain in STARTUP
         }
@@ -617,9 +1029,47 @@ void mp_replan_queue(mpBuf_t *bf)
         }
     } while ((bf = mp_get_next_buffer(bf)) != mp_get_r());
 
+    mr->p = mr->r->nx; // the runtime blocks planned ahead go with the forward plans
     mp->request_planning = true;
 }
 
+/*
+ *  mp_unplan_queue() - revert the forward plans from bf on when the runtime stops
+ *
+ *  mr->reset() discards the runtime blocks planned ahead, so every buffer planned into
+ *  one must be forward planned again, this time entering from the stop.
+ */
+
+void mp_unplan_queue(mpBuf_t *bf)
+{
+    while (bf->buffer_state > MP_BUFFER_BACK_PLANNED)
+    {
+        bf->buffer_state = MP_BUFFER_BACK_PLANNED; // revert from RUNNING or FULLY_PLANNED
+        bf->plannable = true;                      // needed so block can be re-planned
+        bf = mp_get_next_buffer(bf);
+    }
+}
+
+/*
+ * _get_replan_block() - return the first buffer past the critical region
+ *
+ *  Buffers that are fully planned or running are locked; replanning starts at the next one.
+ */
+
+static mpBuf_t *_get_replan_block()
+{
+    mpBuf_t *bf = mp_get_r();
+
+    while (bf->buffer_state >= MP_BUFFER_FULLY_PLANNED)
+    {
+        if ((bf = mp_get_next_buffer(bf)) == mp_get_r())
+        {
+            break;
+        }
+    }
+    return (bf);
+}
+
 /*
  *  mp_start_feed_override() - gradually adjust existing and new buffers to target override percentage
  *  mp_end_feed_override() - gradually adjust existing and new buffers to no override percentage
@@ -628,15 +1078,17 @@ void mp_replan_queue(mpBuf_t *bf)
  *    - 'mfo_factor' is the override scaling factor normalized to 1.0 = 100%
  *      Values < 1.0 are speed decreases, > 1.0 are increases. Upper and lower limits are checked.
  *
- *    - 'ramp_time' is approximate, as the ramp dynamically changes move execution times
- *      The ramp will attempt to meet the time specified but it will not be exact.
+ *    - 'ramp_time' is no longer used. The ramp is as fast as the jerk of each move allows.
  */
 /*  Function:
- *  The override takes effect as close to real-time as possible. Practically, this means about 20 or
- *  so behind the current running move. How it works:
+ *  The override is a planning input. It sets the target factor and replans from the first
+ *  block past the critical region. _plan_block() then walks each block's factor toward the
+ *  target by as much as that block can absorb under its jerk limit, so the velocity change
+ *  is shaped by the normal backward pass and the zoid, not stepped into cruise velocities.
  *
  *    - If the planner is idle just apply the override factor and be done with it. That's easy.
- *    - Otherwise look for the "break point" at 20 ms
+ *    - A new target while a ramp is running just retargets it. Each block ramps from its
+ *      predecessor's factor, so there is no ramp state to restart.
  */
 
 void mp_start_feed_override(const float ramp_time, const float override_factor)
@@ -649,18 +1101,33 @@ void mp_start_feed_override(const float ramp_time, const float override_factor)
         return;
     }
 
+    // Ignore requests that don't move the target, e.g. an override knob being jiggled.
+    // Only the buffers past the critical region are re-primed, and only the ones whose
+    // vmaxes change are backplanned again (see _plan_block()).
+    if (fp_EQ(override_factor, mp->mfo_factor))
+    {
+        return;
+    }
+
     // Assume that the min and max values for override_factor have been validated upstream
-    // SUVAT: V = U+AT ==> A = (V-U)/T
-    mp->ramp_target = override_factor;
-    mp->ramp_dvdt = (override_factor - mp->c->override_factor) / ramp_time;
+    mp->mfo_factor = override_factor;
     mp->mfo_active = true;
+    mp->ramp_active = true;
+
+    mp->c = _get_replan_block();
+    mp->p = mp->c; // re-position the planner pointer
 
-    if (fp_NOT_ZERO(mp->ramp_dvdt))
-    {                  // do these things only if you actually have a ramp to run
-        mp->p = mp->c; // re-position the planner pointer
-        mp->ramp_active = true;
-        mp->request_planning = true;
+    // The backward pass marks blocks it can't improve unplannable, and would stop short of
+    // a re-primed block behind them - leaving it unplanned with the runtime waiting on it.
+    for (mpBuf_t *bf = mp->c; (bf->buffer_state > MP_BUFFER_INITIALIZING) && (bf->buffer_state < MP_BUFFER_FULLY_PLANNED);)
+    {
+        bf->plannable = true;
+        if ((bf = mp_get_next_buffer(bf)) == mp_get_r())
+        {
+            break;
+        }
     }
+    mp->request_planning = true;
 }
 
 void mp_end_feed_override(const float ramp_time)
@@ -680,10 +1147,14 @@ void mp_end_traverse_override(const float ramp_time)
 
 /*
  * mp_planner_time_accounting() - 在计划员中收集时间
+ *
+ *  Time queued behind the run buffer, from the queued time counters (see planner.h).
+ *  Called from the exec interrupt as a block starts to run.
  */
 
 void mp_planner_time_accounting()
 {
+    mpPlannerQueue_t *q = &(mp->q);
     mpBuf_t *bf = mp_get_r(); // 从运行缓冲区开始
 
     // 检查运行缓冲区以查看是否正在运行任何内容。 可能不是
@@ -691,15 +1162,8 @@ void mp_planner_time_accounting()
     { // 这不是错误条件
         return;
     }
-    mp->plannable_time = 0; //UPDATE_BF_MS(bf);     // DIAGNOSTIC
-    while ((bf = bf->nx) != mp_get_r())
-    {
-        if (bf->buffer_state == MP_BUFFER_EMPTY || bf->plannable == true)
-        {
-            break;
-        }
-        mp->plannable_time += bf->block_time;
-    }
+    uint32_t usec = q->time_in_usec + q->time_plan_usec - q->time_out_usec - bf->cold->time_usec;
+    mp->plannable_time = usec / 60000000.0;
     UPDATE_MP_DIAGNOSTICS // DIAGNOSTIC
 }
 
@@ -796,6 +1260,7 @@ mpBuf_t *mp_get_r() { return (mp->q.r); }
 
 mpBuf_t *mp_get_write_buffer() // get & clear a buffer
 {
+    mp_commit_blend();  // a held G64 P line goes ahead of whatever comes next
 
     mpPlannerQueue_t *q = &(mp->q);
 
@@ -804,6 +1269,10 @@ mpBuf_t *mp_get_write_buffer() // get & clear a buffer
         _clear_buffer(q->w); // NB: this is redundant if the buffer was cleared mp_free_run_buffer()
         q->w->buffer_state = MP_BUFFER_INITIALIZING;
         q->buffers_available--;
+        if ((q->queue_size - q->buffers_available) > mp->stats.depth_max)
+        {
+            mp->stats.depth_max = q->queue_size - q->buffers_available;
+        }
         return (mp_get_w());
     }
     // 无缓冲条件总是引起恐慌 - 由调用者调用
@@ -817,11 +1286,220 @@ void mp_unget_write_buffer() // mark buffer as empty and adjust free buffer coun
 
     if (q->w->buffer_state != MP_BUFFER_EMPTY)
     { // safety. Can't unget an empty buffer
+        if (q->w->cold->gm.context != 0)
+        {
+            mp->gm_context_in[q->w->cold->gm.context - 1]--; // the block never ran - take it back out
+            q->w->cold->gm.context = 0;
+        }
         q->w->buffer_state = MP_BUFFER_EMPTY;
         q->buffers_available++;
     }
 }
 
+/*
+ * mp_commit_blend() - commit the line held for corner blending, if there is one
+ *
+ *  Called when something other than a blendable line is queued, and from the planner
+ *  callback when no next move has arrived within the block timeout.
+ */
+
+void mp_commit_blend()
+{
+    if (mp->blend != NULL)
+    {
+        mp->blend = NULL;
+        mp_commit_write_buffer(BLOCK_TYPE_ALINE);
+    }
+}
+
+/*
+ * mp_horizon_count() - count a move block's time and length into the lookahead horizon
+ *
+ *  Called on commit, and again by the coalescer when it extends a committed block - a
+ *  recount replaces the block's earlier contribution. Time is taken at cruise_vmax, so it
+ *  is the least time the move can take.
+ */
+
+void mp_horizon_count(mpBuf_t *bf)
+{
+#if PLANNER_HORIZON_ENABLED == true
+    if (bf->cruise_vmax <= 0)
+    {
+        return;
+    }
+    mpPlannerQueue_t *q = &(mp->q);
+    uint32_t usec = (uint32_t)(bf->length / bf->cruise_vmax * 60000000);
+    uint32_t um = (uint32_t)(bf->length * 1000);
+
+    q->horizon_in_usec += usec - bf->cold->horizon_usec;
+    q->horizon_in_um += um - bf->cold->horizon_um;
+    bf->cold->horizon_usec = usec;
+    bf->cold->horizon_um = um;
+    mp->horizon_brake = mp_get_target_length(0, bf->cruise_vmax, bf);
+#endif
+}
+
+/*
+ * mp_time_count()   - count a block's time into the queued time (main loop)
+ * mp_time_recount() - recount it after forward planning has changed its block_time
+ *
+ *  Both replace the block's earlier contribution, as mp_horizon_count() does, but each
+ *  writes its own counter so the main loop and the forward plan interrupt never share
+ *  one (see planner.h).
+ */
+
+static uint32_t _time_usec(const mpBuf_t *bf)
+{
+    return ((uint32_t)(min(max(bf->block_time, 0.0f), PLANNER_TIME_BLOCK_MAX) * 60000000));
+}
+
+void mp_time_count(mpBuf_t *bf)
+{
+    uint32_t usec = _time_usec(bf);
+    mp->q.time_in_usec += usec - bf->cold->time_usec;
+    bf->cold->time_usec = usec;
+}
+
+void mp_time_recount(mpBuf_t *bf)
+{
+    uint32_t usec = _time_usec(bf);
+    mp->q.time_plan_usec += usec - bf->cold->time_usec;
+    bf->cold->time_usec = usec;
+}
+
+/*
+ * mp_set_block_gm()      - copy a gcode model state into a block, interning the modal part
+ * mp_get_block_gm()      - rebuild the full gcode state of a block
+ * mp_get_block_context() - return the modal gcode state of a block
+ *
+ *  _gm_context() clears the context before filling it so padding compares equal under
+ *  memcmp(). The last interned context is tried first - it is nearly always the one. Any
+ *  slot with matching contents is reused, live or not, otherwise the first free slot is
+ *  filled. Setting a block that already holds a context (the coalescer restating it) gives
+ *  the old one back first. Returns false only if no slot is free, which the planner full
+ *  test keeps from happening. Blocks that carry no gcode state (commands, dwells) read the
+ *  reset defaults, as they did when each block held a full GCodeState_t.
+ */
+
+static const mpGCodeContext_t _gm_context_reset = {
+    INIT_AXES_ZEROES, 0.0, CANON_PLANE_XY, INCHES, PATH_EXACT_PATH, ABSOLUTE_DISTANCE_MODE,
+    ABSOLUTE_DISTANCE_MODE, ABSOLUTE_OVERRIDE_OFF, ABSOLUTE_COORDS, 0, 0
+};
+
+static void _gm_context(mpGCodeContext_t *ctx, const GCodeState_t *_gm)
+{
+    memset(ctx, 0, sizeof(mpGCodeContext_t));
+    copy_vector(ctx->display_offset, _gm->display_offset);
+    ctx->path_tolerance = _gm->path_tolerance;
+    ctx->select_plane = _gm->select_plane;
+    ctx->units_mode = _gm->units_mode;
+    ctx->path_control = _gm->path_control;
+    ctx->distance_mode = _gm->distance_mode;
+    ctx->arc_distance_mode = _gm->arc_distance_mode;
+    ctx->absolute_override = _gm->absolute_override;
+    ctx->coord_system = _gm->coord_system;
+    ctx->tool = _gm->tool;
+    ctx->tool_select = _gm->tool_select;
+}
+
+static bool _gm_context_free(const mpPlanner_t *_mp)
+{
+    for (uint8_t i = 0; i < PLANNER_GM_CONTEXTS; i++)
+    {
+        if (_mp->gm_context_in[i] == _mp->gm_context_out[i])
+        {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+bool mp_set_block_gm(mpBuf_t *bf, const GCodeState_t *_gm)
+{
+    mpGCodeBlock_t *gm = &bf->cold->gm;
+    mpGCodeContext_t ctx;
+    _gm_context(&ctx, _gm);
+
+    if (gm->context != 0)
+    {
+        mp->gm_context_in[gm->context - 1]--;
+        gm->context = 0;
+    }
+    uint8_t slot = mp->gm_context_last;
+    if ((slot == 0) || (memcmp(&mp->gm_context[slot - 1], &ctx, sizeof(mpGCodeContext_t)) != 0))
+    {
+        uint8_t free_slot = 0;
+        slot = 0;
+        for (uint8_t i = 0; i < PLANNER_GM_CONTEXTS; i++)
+        {
+            if (memcmp(&mp->gm_context[i], &ctx, sizeof(mpGCodeContext_t)) == 0)
+            {
+                slot = i + 1;
+                break;
+            }
+            if ((free_slot == 0) && (mp->gm_context_in[i] == mp->gm_context_out[i]))
+            {
+                free_slot = i + 1;
+            }
+        }
+        if (slot == 0)
+        {
+            if (free_slot == 0)
+            {
+                return (false);
+            }
+            slot = free_slot;
+            memcpy(&mp->gm_context[slot - 1], &ctx, sizeof(mpGCodeContext_t));
+        }
+    }
+    mp->gm_context_in[slot - 1]++;
+    mp->gm_context_last = slot;
+
+    gm->context = slot;
+    gm->linenum = _gm->linenum;
+    gm->motion_mode = _gm->motion_mode;
+    copy_vector(gm->target, _gm->target);
+    gm->feed_rate = _gm->feed_rate;
+    gm->P_word = _gm->P_word;
+    gm->spindle_speed = _gm->spindle_speed;
+    gm->feed_rate_mode = _gm->feed_rate_mode;
+    return (true);
+}
+
+const mpGCodeContext_t *mp_get_block_context(const mpBuf_t *bf)
+{
+    if (bf->cold->gm.context == 0)
+    {
+        return (&_gm_context_reset);
+    }
+    return (&mp->gm_context[bf->cold->gm.context - 1]);
+}
+
+void mp_get_block_gm(const mpBuf_t *bf, GCodeState_t *gm)
+{
+    const mpGCodeBlock_t *b = &bf->cold->gm;
+    const mpGCodeContext_t *ctx = mp_get_block_context(bf);
+
+    gm->linenum = b->linenum;
+    gm->motion_mode = b->motion_mode;
+    copy_vector(gm->target, b->target);
+    copy_vector(gm->display_offset, ctx->display_offset);
+    gm->feed_rate = b->feed_rate;
+    gm->P_word = b->P_word;
+    gm->spindle_speed = b->spindle_speed;
+    gm->feed_rate_mode = b->feed_rate_mode;
+    gm->select_plane = ctx->select_plane;
+    gm->units_mode = ctx->units_mode;
+    gm->path_control = ctx->path_control;
+    gm->path_tolerance = ctx->path_tolerance;
+    gm->distance_mode = ctx->distance_mode;
+    gm->arc_distance_mode = ctx->arc_distance_mode;
+    gm->absolute_override = ctx->absolute_override;
+    gm->coord_system = ctx->coord_system;
+    gm->tool = ctx->tool;
+    gm->tool_select = ctx->tool_select;
+}
+
 /*** 警告 ***
 *调用mp_commit_write_buffer（）函数一旦有，就不能使用写缓冲区
 *已经承诺。中断可以立即使用缓冲区，使其内容无效。
@@ -843,6 +1521,14 @@ void mp_commit_write_buffer(const blockType block_type)
             st_request_forward_plan(); //如果运行时不忙，请求exec
         }
     }
+    if (block_type == BLOCK_TYPE_ALINE)
+    {
+        mp_horizon_count(q->w);
+        mp->run.blocks_in++;
+    }
+    mp_time_count(q->w);
+    mp->action_block = NULL;  // actions can no longer join an earlier block
+    _diag_commit(q->w);     // DIAGNOSTIC
     q->w->plannable = true; //启用计划块
     mp->request_planning = true;
     q->w = q->w->nx;                         //提前写入缓冲区指针
@@ -874,10 +1560,32 @@ bool mp_free_run_buffer() // EMPTY current run buffer & advance to the next
     mpBuf_t *r_now = q->r; // save this pointer is to avoid a race condition when clearing the buffer
 
     _audit_buffers();     // DIAGNOSTIC audit for buffer chain integrity (only runs in DEBUG mode)
+    _diag_free(r_now);    // DIAGNOSTIC - before the buffer is cleared
+    q->horizon_out_usec += r_now->cold->horizon_usec;   // a freed block leaves the horizon
+    q->horizon_out_um += r_now->cold->horizon_um;
+    q->time_out_usec += r_now->cold->time_usec;         // and the queued time
+    if ((r_now->block_type == BLOCK_TYPE_ALINE) && (r_now->cruise_vset > 0))
+    {
+        mp->run.length += r_now->length;                // job report totals
+        mp->run.commanded_time += r_now->length / r_now->cruise_vset;
+        mp->run.run_time += r_now->block_time;
+    }
+    if (r_now->cold->gm.context != 0)
+    {
+        mp->gm_context_out[r_now->cold->gm.context - 1]++; // the block no longer holds its gcode context
+    }
     q->r = q->r->nx;      // advance to next run buffer first...
+    if (mp->p == r_now)   // a cycle start can run a command the planner hasn't reached yet
+    {
+        mp->p = q->r;     // don't leave the planner on a buffer that's about to be empty
+    }
     _clear_buffer(r_now); // ... then clear out the old buffer (& set MP_BUFFER_EMPTY)
                           //    r_now->buffer_state = MP_BUFFER_EMPTY; //... then mark the buffer empty while preserving content for debug inspection
     q->buffers_available++;
+    if ((q->queue_size - q->buffers_available) < mp->stats.depth_min)
+    {
+        mp->stats.depth_min = q->queue_size - q->buffers_available;
+    }
     qr_request_queue_report(-1); // request a QR and add to the "removed buffers" count
     return (q->w == q->r);       // return true if the queue emptied
 }
@@ -886,7 +1594,8 @@ bool mp_free_run_buffer() // EMPTY current run buffer & advance to the next
 void mp_copy_buffer(mpBuf_t *bf, const mpBuf_t *bp)
 {
     // copy contents of bp to bf while preserving pointers in bp
-    memcpy((void *)(&bf->bf_func), (&bp->bf_func), sizeof(mpBuf_t) - (sizeof(void *) * 2));
+    memcpy((void *)(&bf->buffer_number), (&bp->buffer_number), sizeof(mpBuf_t) - (sizeof(void *) * 3));
+    memcpy((void *)(bf->cold), bp->cold, sizeof(mpBufCold_t));
 }
 */
 
@@ -914,14 +1623,14 @@ void mp_dump_planner(mpBuf_t *bf_start) // starting at bf
     do
     {
         printf("%d,", (int)bf->buffer_number);
-        printf("%d,", (int)bf->linenum);
+        printf("%d,", (int)bf->cold->gm.linenum);
         printf("%d,", (int)bf->buffer_state);
         printf("%d,", (int)bf->hint);
         printf("%d,", (int)bf->plannable);
-        printf("%d,", (int)bf->iterations);
+        printf("%d,", (int)mp_diag.slot[bf->buffer_number].iterations);
 
-        printf("%1.2f,", bf->block_time_ms);
-        printf("%1.2f,", bf->plannable_time_ms);
+        printf("%1.2f,", bf->block_time * 60000);
+        printf("%1.2f,", mp->plannable_time_ms);
         printf("%1.3f,", bf->override_factor);
         printf("%1.3f,", bf->throttle);
         printf("%1.5f,", bf->length);
@@ -1073,6 +1782,55 @@ static void _audit_buffers()
 
 #endif // __AUDIT_BUFFERS
 
+/************************************************************************************
+ * _diag_commit() - note commit time and queue depth for a block's queue slot
+ * _diag_free()   - write a ring record for a block leaving the queue
+ *
+ *  _diag_free() runs in the exec interrupt and is the only writer of the ring.
+ */
+
+static void _diag_commit(const mpBuf_t *bf)
+{
+    if (!PLANNER_DIAG_SLOT(bf))
+    {
+        return;
+    }
+    mpDiagSlot_t *s = &mp_diag.slot[bf->buffer_number];
+    s->commit_tick = SysTickTimer_getValue();
+    s->buffers_available = mp->q.buffers_available;
+    s->iterations = 0;
+    s->meet_iterations = 0;
+}
+
+static void _diag_free(const mpBuf_t *bf)
+{
+    if (!PLANNER_DIAG_SLOT(bf))
+    {
+        return;
+    }
+    const mpDiagSlot_t *s = &mp_diag.slot[bf->buffer_number];
+    mpDiagRecord_t *d = &mp_diag.ring[mp_diag.next];
+
+    d->linenum = bf->cold->gm.linenum;
+    d->queued_ms = SysTickTimer_getValue() - s->commit_tick;
+    d->buffers_available = s->buffers_available;
+    d->iterations = s->iterations;
+    d->meet_iterations = s->meet_iterations;
+    d->block_type = bf->block_type;
+    d->hint = bf->hint;
+    d->length = bf->length;
+    d->block_time_ms = bf->block_time * 60000;
+    d->plannable_time_ms = mp->plannable_time * 60000;
+    d->cruise_velocity = bf->cruise_velocity;
+    d->exit_velocity = bf->exit_velocity;
+
+    if (++mp_diag.next >= PLANNER_DIAG_RING_SIZE)
+    {
+        mp_diag.next = 0;
+    }
+    mp_diag.count++;
+}
+
 /****************************
  * END OF PLANNER FUNCTIONS *
  ****************************/
@@ -1082,7 +1840,62 @@ static void _audit_buffers()
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
 
+/*
+ * mp_get_pdg() - get planner diagnostics enable
+ * mp_set_pdg() - enable or disable planner diagnostics. Enabling starts an empty ring
+ * mp_get_pdd() - get the number of diagnostic records written since enabled
+ */
+
+stat_t mp_get_pdg(nvObj_t *nv) { return (get_integer(nv, mp_diag.enabled)); }
+
+stat_t mp_set_pdg(nvObj_t *nv)
+{
+    if (!mp_diag.enabled && (nv->value_int == 1))  // nothing records while it is off
+    {
+        memset(mp_diag.slot, 0, sizeof(mp_diag.slot));
+        mp_diag.next = 0;
+        mp_diag.count = 0;
+    }
+    return (set_integer(nv, mp_diag.enabled, 0, 1));
+}
+
+stat_t mp_get_pdd(nvObj_t *nv)
+{
+    nv->value_int = mp_diag.count;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
  ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_pdg[] = "[pdg] planner diagnostics%10d [0=off,1=on]\n";
+
+void mp_print_pdg(nvObj_t *nv) { text_print(nv, fmt_pdg);}    // TYPE_INT
+
+// list the ring oldest first
+void mp_print_pdd(nvObj_t *nv)
+{
+    char line[128];
+    uint16_t n = (mp_diag.count < PLANNER_DIAG_RING_SIZE) ? mp_diag.count : PLANNER_DIAG_RING_SIZE;
+    uint16_t i = (mp_diag.next + PLANNER_DIAG_RING_SIZE - n) % PLANNER_DIAG_RING_SIZE;
+
+    sprintf(line, "pdd:%lu records\nLine, Qms, Avail, Iter, Meet, Type, Hint, Len, Tmove, Tplan, Vc, Vx\n",
+            (unsigned long)mp_diag.count);
+    xio_writeline(line);
+    for (; n > 0; n--, i = (i + 1) % PLANNER_DIAG_RING_SIZE)
+    {
+        const mpDiagRecord_t *d = &mp_diag.ring[i];
+        sprintf(line, "%lu, %lu, %d, %d, %d, %d, %d, %1.4f, %1.2f, %1.2f, %1.0f, %1.0f\n",
+                (unsigned long)d->linenum, (unsigned long)d->queued_ms, d->buffers_available, d->iterations,
+                d->meet_iterations, d->block_type, d->hint, d->length, d->block_time_ms,
+                d->plannable_time_ms, d->cruise_velocity, d->exit_velocity);
+        xio_writeline(line);
+    }
+}
+
+#endif // __TEXT_MODE
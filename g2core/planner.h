@@ -79,10 +79,14 @@
  *  - mp_aline()         - plan and queue a move with acceleration management
  *  - mp_dwell()         - plan and queue a pause (dwell) to the planner queue
  *  - mp_queue_command() - queue a canned command
+ *  - mp_queue_action()  - queue a small non-motion command (coolant, spindle), sharing a block
+ *  - mp_queue_inline_action() - queue a non-motion command that runs at the end of the last move
  *  - mp_json_command()  - queue a JSON command for run-time interpretation and execution (M100)  
  *  - mp_json_wait()     - queue a JSON wait for run-time interpretation and execution (M101)
+ *  - mp_heater_wait()   - queue a wait for a heater to come to temperature (Marlin M109, M190)
  *  - 
- * In addition, cm_arc_feed() valaidates and sets up a arc paramewters and calls mp_aline() 
+ * In addition, cm_arc_feed() valaidates and sets up a arc paramewters and calls mp_arc()
+ * to queue the arc as a single block (see ARC_NATIVE_BLOCKS), or calls mp_aline()
  * repeatedly to spool out the arc segments into the planner queue.
  *
  * All the above queueing commands other than mp_aline() are relatively trivial; they just
@@ -150,6 +154,7 @@
 #define PLANNER_H_ONCE
 
 #include "canonical_machine.h" // used for GCodeState_t
+#include "raster.h"            // used for rasterBlock_t
 
 using Motate::Timeout;
 
@@ -194,6 +199,12 @@ typedef enum
     BLOCK_TYPE_END            // 程序结束
 } blockType;
 
+typedef enum
+{                   // bf->cold->path.type values
+    PATH_LINE = 0,  // MUST=0  straight line along bf->unit
+    PATH_ARC        // circular or helical arc interpolated at segment rate
+} pathType;
+
 typedef enum
 {
     BLOCK_INACTIVE = 0,   // 块是非活动的（必须为零）
@@ -235,26 +246,185 @@ typedef enum
 
 /*** Most of these factors are the result of a lot of tweaking. Change with caution.***/
 
-#define PLANNER_QUEUE_SIZE ((uint8_t)48)     // 建议12分钟。 限制为255
-#define SECONDARY_QUEUE_SIZE ((uint8_t)12)   // 进给保持操作的辅助二次计划程序队列 
+// PLANNER_QUEUE_SIZE is set in settings files (see settings_default.h). Recommend 12 min.
+#define SECONDARY_QUEUE_SIZE ((uint16_t)12)  // 进给保持操作的辅助二次计划程序队列 
+#ifndef SECONDARY_QUEUE_MIN                   // boards can override this value in hardware.h
+#define SECONDARY_QUEUE_MIN ((uint16_t)8)     // pool buffers always reserved for the secondary planner
+#endif
+#define PLANNER_POOL_SIZE (PLANNER_QUEUE_SIZE + SECONDARY_QUEUE_SIZE)   // buffers shared by both planners
+#define PRIMARY_POOL_SIZE (PLANNER_POOL_SIZE - SECONDARY_QUEUE_MIN)     // primary queue size when nothing is lent
 #define PLANNER_BUFFER_HEADROOM ((uint8_t)4) // 在处理新输入行之前，在计划程序中保留缓冲区
 #define JERK_MULTIPLIER ((float)1000000)     // 请勿改变 - 必须始终为100万
+#define MEET_ITERATIONS_MAX ((uint8_t)10)    // bound on the bracketed Newton search in _get_meet_velocity()
+
+#ifndef PLANNER_QUEUE_MEMORY_MAX              // boards can override this value in hardware.h
+#define PLANNER_QUEUE_MEMORY_MAX (32 * 1024)  // SRAM budget in bytes for primary + secondary queue buffers
+#endif
 
 #define JUNCTION_INTEGRATION_MIN (0.05) // JT minimum allowable setting
 #define JUNCTION_INTEGRATION_MAX (5.00) // JT maximum allowable setting
 
+#define CURVE_WINDOW 4                  // line blocks fitted for curvature at a junction (see _calculate_curve_junction_vmax())
+#define CURVE_ANGLE_MAX ((float)0.26)   // radians. A larger turn (about 15 degrees) is a corner, not a curve
+#define CURVE_RATIO_MAX ((float)2.0)    // window blocks' lengths and turns must agree within this factor
+
 #ifndef MIN_SEGMENT_MS               // boards can override this value in hardware.h
 #define MIN_SEGMENT_MS ((float)0.75) // minimum segment milliseconds
 #endif
 #define NOM_SEGMENT_MS ((float)MIN_SEGMENT_MS * 2) // nominal segment ms (at LEAST MIN_SEGMENT_MS * 2)
 #define MIN_BLOCK_MS ((float)MIN_SEGMENT_MS * 2)   // minimum block (whole move) milliseconds
 
+#if SEGMENT_TIME_ADAPTIVE == true
+#if PROFILE_ENABLED != true
+#error SEGMENT_TIME_ADAPTIVE requires PROFILE_ENABLED to measure exec headroom
+#endif
+#ifndef MAX_SEGMENT_MS                      // boards can override this value in hardware.h
+#define MAX_SEGMENT_MS ((float)NOM_SEGMENT_MS * 2) // longest segment used when exec is heavily loaded
+#endif
+#ifndef SEGMENT_EXEC_LOAD
+#define SEGMENT_EXEC_LOAD ((float)0.25)     // fraction of the segment period exec may spend computing segments
+#endif
+#define SEGMENT_ADAPT_SAMPLES 8             // exec samples required before the segment time is adjusted
+#else
+#define MAX_SEGMENT_MS NOM_SEGMENT_MS       // fixed segment time
+#endif
+
+#ifndef MR_BLOCKS                           // boards can override this value in hardware.h
+#define MR_BLOCKS 4                         // runtime block ring - the running block and up to MR_BLOCKS-1 planned ahead
+#endif
+#define MR_PLAN_AHEAD_MS ((float)NOM_SEGMENT_MS * 4) // forward plan another block while less than this is planned ahead
+
+#ifndef EXEC_TABLE_SEGMENTS                 // boards can override this value in hardware.h
+#define EXEC_TABLE_SEGMENTS 32              // most segments in a precomputed block (see EXEC_SEGMENT_TABLE)
+#endif
+
+/*
+ * Fixed point step positions
+ *
+ *  The runtime tracks each motor's step position in int64 fixed point next to the float
+ *  steps kinematics returns. Segment travel is the difference of fixed point positions, so
+ *  it stays exact at any distance from zero (a float step count has no fraction left past
+ *  2^24), and travel too small to send (under MR_STEP_TRAVEL_MIN) is held back and sent
+ *  with a later segment instead of being dropped. The following error is taken against the
+ *  fixed point commanded position as well.
+ */
+#define MR_STEP_FIXED ((float)65536)        // fixed point step units per step
+#define MR_STEP_TRAVEL_MIN ((int64_t)(0.01 * 65536)) // smallest segment travel sent to the stepper
+
+/*
+ * Collinear move coalescing (PLANNER_COALESCE_ENABLED)
+ *
+ *  mp_aline() extends the last queued block instead of taking a new buffer when the new move
+ *  continues it: same feed move state, direction within COALESCE_COS_MIN of the block's, and
+ *  the block not yet touched by planning. The merged block is capped in length and time so
+ *  a run of CAM micro-segments still leaves the planner enough blocks to look ahead with.
+ *  The worst path deviation is about COALESCE_MAX_LENGTH * acos(COALESCE_COS_MIN) (2 um).
+ */
+#ifndef COALESCE_COS_MIN                    // boards can override these values in hardware.h
+#define COALESCE_COS_MIN ((float)0.9999995) // cosine of the largest direction change merged (~0.06 degrees)
+#endif
+#ifndef COALESCE_MAX_LENGTH
+#define COALESCE_MAX_LENGTH ((float)2.0)    // longest merged block (mm)
+#endif
+#ifndef COALESCE_MAX_MS
+#define COALESCE_MAX_MS ((float)50.0)       // longest merged block at its feed rate (ms)
+#endif
+#define COALESCE_MAX_TIME ((float)(COALESCE_MAX_MS / 60000)) // DO NOT CHANGE - time in minutes
+
+/*
+ * G64 P path blending
+ *
+ *  A continuous mode feed line with a P tolerance is held at the write pointer (mp->blend)
+ *  until the next move arrives. If that move turns in the held line's plane the corner is
+ *  replaced by a tangent arc that stays within P of it, so the machine rounds the corner at
+ *  the arc's curvature limited speed instead of slowing to the junction velocity. Each
+ *  tangent is limited to half its line. Corners closer than these cosines to straight or
+ *  to a reversal are left as plain junctions.
+ */
+#ifndef BLEND_COS_MAX                       // boards can override these values in hardware.h
+#define BLEND_COS_MAX ((float)0.9999995)    // straighter than this needs no arc (~0.06 degrees)
+#endif
+#ifndef BLEND_COS_MIN
+#define BLEND_COS_MIN ((float)-0.99)        // sharper than this is left to the junction (~172 degrees)
+#endif
+
+/*
+ * Time based lookahead horizon (PLANNER_HORIZON_ENABLED)
+ *
+ *  Without the horizon the planner takes new moves until fewer than PLANNER_BUFFER_HEADROOM
+ *  buffers are left, so a queue of micro-segments may hold only a few ms of motion while a
+ *  queue of long moves holds minutes. With it the planner also reports full once the
+ *  queued moves take at least PLANNER_HORIZON_MS at their cruise velocities and are long
+ *  enough to stop from the newest move's cruise velocity. The buffer count stays as the
+ *  hard limit, so PLANNER_QUEUE_SIZE can be raised for micro-segment work without long
+ *  moves filling it. Queued time and length are kept as free running counters written by
+ *  commit (main loop) and free (interrupt), so the test needs no walk of the queue.
+ */
+#ifndef PLANNER_HORIZON_MS                 // boards can override this value in hardware.h
+#define PLANNER_HORIZON_MS ((float)250.0)  // queued move time that is enough lookahead
+#endif
+#define PLANNER_HORIZON_USEC ((uint32_t)(PLANNER_HORIZON_MS * 1000)) // DO NOT CHANGE - time in microseconds
+
+/*
+ * Queued time accounting (mp->plannable_time)
+ *
+ *  The time queued behind the running block is kept the same way as the horizon, in free
+ *  running microsecond counters: commit and the coalescer count a block in (main loop),
+ *  forward planning recounts it when its ramps change block_time (forward plan interrupt)
+ *  and free counts it out (exec interrupt). Each counter has a single writer, so none needs
+ *  a critical section, and mp_planner_time_accounting() is a subtraction rather than a walk
+ *  of the queue. A block counts for at most PLANNER_TIME_BLOCK_MAX so a queue of long
+ *  dwells can't wrap the difference.
+ */
+#define PLANNER_TIME_BLOCK_MAX ((float)(10.0 / 60))    // most time one block counts for (minutes)
+
+/*
+ * Planner gcode state (mpGCodeBlock_t, mpGCodeContext_t)
+ *
+ *  A queued move keeps only the gcode state that changes from move to move - line number,
+ *  motion mode, target, feed and P word. The modal rest (offsets, plane, units, path control,
+ *  tool) changes rarely, so mp_set_block_gm() interns it in a per-planner pool of
+ *  PLANNER_GM_CONTEXTS contexts and the block keeps the pool index. mp_get_block_gm()
+ *  rebuilds the full state for mr->gm. A context is live while blocks use it: blocks are
+ *  counted in by mp_set_block_gm() (main loop) and out by mp_free_run_buffer() (interrupt).
+ *  The planner reports full when no context is free, so a new move can always be interned.
+ */
+#ifndef PLANNER_GM_CONTEXTS                // boards can override this value in hardware.h
+#define PLANNER_GM_CONTEXTS 8              // interned modal gcode states per planner
+#endif
+
+/*
+ * Planner actions (mpAction_t)
+ *
+ *  Back-to-back non-motion commands such as coolant and spindle changes are queued by
+ *  mp_queue_action() into one command block instead of a block each. The block keeps a
+ *  run of slots in a per-planner ring of PLANNER_ACTIONS actions, and all of them run in
+ *  order at the same segment boundary. An action carries the first MP_ACTION_VALUES
+ *  values and the first 8 flags of its command. Slots are taken by mp_queue_action()
+ *  (main loop) and given back by mp_runtime_command() (interrupt). A full ring falls
+ *  back to mp_queue_command().
+ *
+ *  Inline actions (mp_queue_inline_action()) are for state changes that don't need the
+ *  machine stopped, such as coolant and T words. They join the newest move block rather
+ *  than a command block, so the planner never sees them and the move keeps its exit
+ *  velocity. The exec hands them to the move's last segment and the loader runs them
+ *  when that segment ends. A feedhold that drops the rest of the move runs them at the
+ *  hold point.
+ */
+#ifndef PLANNER_ACTIONS                    // boards can override this value in hardware.h
+#define PLANNER_ACTIONS 16                 // queued actions per planner - must be a power of 2
+#endif
+#define MP_ACTION_VALUES 2                 // command values carried by an action
+
 #define BLOCK_TIMEOUT_MS ((float)30.0) // MS before deciding there are no new blocks arriving
 #define PHAT_CITY_MS ((float)100.0)    // if you have at least this much time in the planner
 
 #define NOM_SEGMENT_TIME ((float)(NOM_SEGMENT_MS / 60000)) // DO NOT CHANGE - time in minutes
 #define NOM_SEGMENT_USEC ((float)(NOM_SEGMENT_MS * 1000))  // DO NOT CHANGE - time in microseconds
 #define MIN_SEGMENT_TIME ((float)(MIN_SEGMENT_MS / 60000)) // DO NOT CHANGE - time in minutes
+#define MIN_SEGMENT_USEC ((float)(MIN_SEGMENT_MS * 1000))  // DO NOT CHANGE - time in microseconds
+#define MAX_SEGMENT_TIME ((float)(MAX_SEGMENT_MS / 60000)) // DO NOT CHANGE - time in minutes
+#define MAX_SEGMENT_USEC ((float)(MAX_SEGMENT_MS * 1000))  // DO NOT CHANGE - time in microseconds
 #define MIN_BLOCK_TIME ((float)(MIN_BLOCK_MS / 60000))     // DO NOT CHANGE - time in minutes
 #define PHAT_CITY_TIME ((float)(PHAT_CITY_MS / 60000))     // DO NOT CHANGE - time in minutes
 
@@ -282,51 +452,103 @@ typedef enum
 #define Veq2_lo 1.0
 #define VELOCITY_ROUGHLY_EQ(v0, v1) ((v0 > Vthr2) ? fabs(v0 - v1) < Veq2_hi : fabs(v0 - v1) < Veq2_lo)
 
-/* Planner Diagnostics */
+/* Planner Diagnostics
+ *
+ *  Per-block planning statistics are kept in a fixed ring (mp_diag) instead of the planner
+ *  buffers, so they are in every build and cost nothing in mpBuf_t. Recording is off until
+ *  enabled at runtime with {pdg:1}. mp_commit_write_buffer() notes the commit time and
+ *  queue depth for the block's queue slot, the planner counts back-planning and meet
+ *  iterations against the slot, and mp_free_run_buffer() writes one ring record with all
+ *  of it plus the planned velocities. Only the free (in the interrupt) writes the ring, so
+ *  commit and free never race for it. Only the primary planner is recorded.
+ *
+ *  {pdd:n} returns the number of records written; in text mode it lists the ring.
+ *  __PLANNER_DIAGNOSTICS is left for the ASCII art trace only.
+ */
 
-//#define __PLANNER_DIAGNOSTICS   // comment this out to drop diagnostics
+//#define __PLANNER_DIAGNOSTICS   // comment this out to drop ASCII art diagnostics
 
 #ifdef __PLANNER_DIAGNOSTICS
 #define ASCII_ART(s) xio_writeline(s)
+#else
+#define ASCII_ART(s)
+#endif
 
-#define UPDATE_BF_DIAGNOSTICS(bf)                           \
-    {                                                       \
-        bf->linenum = bf->gm.linenum;                       \
-        bf->block_time_ms = bf->block_time * 60000;         \
-        bf->plannable_time_ms = bf->plannable_time * 60000; \
-    }
+#ifndef PLANNER_DIAG_RING_SIZE              // boards can override this value in hardware.h
+#define PLANNER_DIAG_RING_SIZE 32           // records kept (36 bytes each)
+#endif
+
+typedef struct mpDiagSlot
+{                             // per queue slot values gathered while the block is queued
+    uint32_t commit_tick;     // SysTick at commit
+    uint16_t buffers_available; // free buffers at commit
+    int16_t iterations;       // back-planning passes over the block (-1 for a symmetric meet shortcut)
+    uint8_t meet_iterations;  // _get_meet_velocity() passes
+} mpDiagSlot_t;
+
+typedef struct mpDiagRecord
+{                             // one record per freed block
+    uint32_t linenum;         // gcode line number
+    uint32_t queued_ms;       // commit to free
+    uint16_t buffers_available; // free buffers at commit
+    int16_t iterations;
+    uint8_t meet_iterations;
+    uint8_t block_type;
+    uint8_t hint;
+    float length;
+    float block_time_ms;      // planned block time
+    float plannable_time_ms;  // planned time queued behind the block when it was freed
+    float cruise_velocity;
+    float exit_velocity;
+} mpDiagRecord_t;
+
+typedef struct mpDiag
+{
+    uint8_t enabled;          // runtime switch {pdg:}
+    uint16_t next;            // ring index of the next record
+    uint32_t count;           // records written since enabled
+    mpDiagSlot_t slot[PLANNER_POOL_SIZE];
+    mpDiagRecord_t ring[PLANNER_DIAG_RING_SIZE];
+} mpDiag_t;
+
+extern mpDiag_t mp_diag;
+
+// bf is a planner pool buffer
+#define PLANNER_DIAG_SLOT(bf) (mp_diag.enabled && ((bf) >= mp_pool) && ((bf) < &mp_pool[PLANNER_POOL_SIZE]))
 
 #define UPDATE_MP_DIAGNOSTICS                               \
     {                                                       \
         mp->plannable_time_ms = mp->plannable_time * 60000; \
     }
-#define SET_PLANNER_ITERATIONS(i) \
-    {                             \
-        bf->iterations = i;       \
+#define SET_PLANNER_ITERATIONS(i)                                 \
+    {                                                             \
+        if (PLANNER_DIAG_SLOT(bf))                                \
+        {                                                         \
+            mp_diag.slot[bf->buffer_number].iterations = i;       \
+        }                                                         \
     }
-#define INC_PLANNER_ITERATIONS \
-    {                          \
-        bf->iterations++;      \
+#define INC_PLANNER_ITERATIONS                                    \
+    {                                                             \
+        if (PLANNER_DIAG_SLOT(bf))                                \
+        {                                                         \
+            mp_diag.slot[bf->buffer_number].iterations++;         \
+        }                                                         \
     }
-#define SET_MEET_ITERATIONS(i)   \
-    {                            \
-        bf->meet_iterations = i; \
+#define SET_MEET_ITERATIONS(i)                                    \
+    {                                                             \
+        if (PLANNER_DIAG_SLOT(bf))                                \
+        {                                                         \
+            mp_diag.slot[bf->buffer_number].meet_iterations = i;  \
+        }                                                         \
     }
-#define INC_MEET_ITERATIONS    \
-    {                          \
-        bf->meet_iterations++; \
+#define INC_MEET_ITERATIONS                                       \
+    {                                                             \
+        if (PLANNER_DIAG_SLOT(bf))                                \
+        {                                                         \
+            mp_diag.slot[bf->buffer_number].meet_iterations++;    \
+        }                                                         \
     }
 
-#else
-#define ASCII_ART(s)
-#define UPDATE_BF_DIAGNOSTICS
-#define UPDATE_MP_DIAGNOSTICS
-#define SET_PLANNER_ITERATIONS(i)
-#define INC_PLANNER_ITERATIONS
-#define SET_MEET_ITERATIONS(i)
-#define INC_MEET_ITERATIONS
-#endif
-
 /*
  *  Planner structures
  *
@@ -337,26 +559,125 @@ typedef enum
  */
 
 //**** Planner Queue Structures ****
+/*
+ *  Each planner buffer is split into a hot part (mpBuf_t) and a cold part (mpBufCold_t).
+ *  The hot part holds the linkage, lengths, velocities and jerk terms that backplanning
+ *  touches on every hop along bf->pv. The cold part holds the callbacks and the Gcode
+ *  model state, which are only needed when a block is queued and when it is executed.
+ *  Cold records live in a parallel array with the same index as their hot buffer.
+ */
 
-typedef struct mpBuffer
+/*
+ *  A PATH_ARC block carries its geometry in the cold record so one planner buffer covers
+ *  the whole arc. Positions are a function of the fraction of path.length travelled.
+ *  bf->unit is the entry tangent (for jerk and the junction into the block) and
+ *  path.exit_unit is the exit tangent (for the junction out of the block).
+ */
+typedef struct mpPath
 {
+    pathType type;          // PATH_LINE blocks ignore the rest of this struct
+    uint8_t plane_axis_0;   // arc plane axis 0 - e.g. X for G17
+    uint8_t plane_axis_1;   // arc plane axis 1 - e.g. Y for G17
+    uint8_t linear_axis;    // linear (helix) axis normal to the plane
+
+    float length;           // full path length. bf->length is the remaining length after a feedhold
+    float center_0;         // center of circle at plane axis 0
+    float center_1;         // center of circle at plane axis 1
+    float radius;           // radius at the start of the arc
+    float radius_travel;    // change in radius from start to end (within arc radius tolerance)
+    float theta;            // starting angle (radians from the positive plane axis 1)
+    float angular_travel;   // signed travel in radians
+    float linear_position;  // linear axis position at the start of the arc
+    float linear_travel;    // linear axis travel
+    float exit_unit[AXES];  // tangent unit vector at the end of the arc
+} mpPath_t;
+
+typedef struct mpGCodeContext
+{                                         // modal gcode state shared by queued moves
+    float display_offset[AXES];           // work offsets from the machine coordinate system
+    float path_tolerance;                 // G64 P blending tolerance (mm)
+    cmCanonicalPlane select_plane;        // G17,G18,G19
+    cmUnitsMode units_mode;               // G20,G21
+    cmPathControl path_control;           // G61,G61.1,G64
+    cmDistanceMode distance_mode;         // G90,G91
+    cmDistanceMode arc_distance_mode;     // G90.1,G91.1
+    cmAbsoluteOverride absolute_override; // G53
+    cmCoordSystem coord_system;           // G54-G59
+    uint8_t tool;                         // M6 tool
+    uint8_t tool_select;                  // T value
+} mpGCodeContext_t;
+
+typedef struct mpGCodeBlock
+{                                  // per-move gcode state of a queued block
+    int32_t linenum;               // Gcode block line number
+    cmMotionMode motion_mode;      // Group1 motion mode
+    float target[AXES];            // target in planner coordinates
+    float feed_rate;               // F - mm/min or inverse time in minutes
+    float P_word;                  // P - parameter
+    float spindle_speed;           // S - applied per segment by the runtime, not a queued command
+    cmFeedRateMode feed_rate_mode; // G93,G94,G95
+    uint8_t context;               // 1 + index of the interned mpGCodeContext_t, 0 if none
 
-    // *** CAUTION *** These two pointers are not reset by _clear_buffer()
-    struct mpBuffer *pv;   // 静态指针指向前一个缓冲区
-    struct mpBuffer *nx;   // 静态指向下一个缓冲区
-    uint8_t buffer_number; // DIAGNOSTIC，便于调试
+    void reset()
+    {
+        linenum = 0;
+        motion_mode = MOTION_MODE_STRAIGHT_TRAVERSE;
+        for (uint8_t i = 0; i < AXES; i++)
+        {
+            target[i] = 0.0;
+        }
+        feed_rate = 0.0;
+        P_word = 0.0;
+        spindle_speed = 0.0;
+        feed_rate_mode = INVERSE_TIME_MODE;
+        context = 0;
+    }
+} mpGCodeBlock_t;
+
+typedef struct mpAction
+{                               // one command queued by mp_queue_action()
+    cm_exec_t cm_func;          // callback to canonical machine execution function
+    float value[MP_ACTION_VALUES];
+    uint8_t flags;              // command flags 0-7 as bits
+} mpAction_t;
 
+typedef struct mpBufferCold
+{
     stat_t (*bf_func)(struct mpBuffer *bf); // 回调缓冲exec函数
     cm_exec_t cm_func;                      // 回调规范机器执行功能
 
-#ifdef __PLANNER_DIAGNOSTICS
-    uint32_t linenum; // mirror of bf->gm.linenum
-    int iterations;
-    float block_time_ms;
-    float plannable_time_ms; // time in planner
-    float plannable_length;  // length in planner
-    uint8_t meet_iterations; // iterations needed in _get_meet_velocity
-#endif
+    mpGCodeBlock_t gm; // Gcode模型状态 - 从模型传递，由计划程序和运行时使用 (see mp_set_block_gm())
+    mpPath_t path;   // curved path geometry for PATH_ARC blocks
+    rasterBlock_t raster;  // laser raster line played along a straight feed (see raster.h)
+    uint32_t horizon_usec; // time this block added to the lookahead horizon
+    uint32_t horizon_um;   // length this block added to the lookahead horizon
+    uint32_t time_usec;    // time this block added to the queued time
+    uint8_t action_first;  // first of this block's slots in the planner action ring
+    uint8_t actions;       // number of actions this block runs. 0 = run cm_func
+
+    void reset()
+    {
+        bf_func = nullptr;
+        cm_func = nullptr;
+        gm.reset();
+        path.type = PATH_LINE;
+        raster.pixels = 0;
+        horizon_usec = 0;
+        horizon_um = 0;
+        time_usec = 0;
+        action_first = 0;
+        actions = 0;
+    }
+} mpBufCold_t;
+
+typedef struct mpBuffer
+{
+
+    // *** CAUTION *** These three pointers are not reset by _clear_buffer()
+    struct mpBuffer *pv;   // 静态指针指向前一个缓冲区
+    struct mpBuffer *nx;   // 静态指向下一个缓冲区
+    mpBufCold_t *cold;     // static pointer to the parallel cold record
+    uint16_t buffer_number; // DIAGNOSTIC，便于调试
 
     bufferState buffer_state; // 用于管理排队/出队
     blockType block_type;     // 用于调度运行程序
@@ -368,6 +689,7 @@ typedef struct mpBuffer
     bool axis_flags[AXES]; // 为参与移动和命令参数的轴设置为true
 
     bool plannable; // 当此块可用于计划时设置为true
+    bool primed;    // set once the junction into this block has been computed (vmaxes are valid)
 
     float length;          // 线或螺旋的总长度，单位mm
     float block_time;      // 计算整个块的移动时间（移动）
@@ -390,27 +712,13 @@ typedef struct mpBuffer
     // between the NEXT BLOCK AND THIS ONE
 
     float jerk;             // 此移动的最大线性加加速度项
-    float jerk_sq;          // Jm ^ 2用于计划（计算和缓存）
-    float recip_jerk;       // 1 / Jm用于计划（计算和缓存）
-    float sqrt_j;           // sqrt（jM）用于规划（计算和缓存）
     float q_recip_2_sqrt_j; // (q/(2 sqrt(jM))) where q = (sqrt(10)/(3^(1/4))), used in length computations (computed and cached)
 
-    GCodeState_t gm; // Gcode模型状态 - 从模型传递，由计划程序和运行时使用
-
-    // clears the above structure
+    // clears the above structure and its cold record
     void reset()
     {
-        bf_func = nullptr;
-        cm_func = nullptr;
+        cold->reset();
 
-#ifdef __PLANNER_DIAGNOSTICS
-        linenum = 0;
-        iterations = 0;
-        block_time_ms = 0;
-        plannable_time_ms = 0;
-        plannable_length = 0;
-        meet_iterations = 0;
-#endif
         buffer_state = MP_BUFFER_EMPTY;
         block_type = BLOCK_TYPE_NULL;
         block_state = BLOCK_INACTIVE;
@@ -422,6 +730,7 @@ typedef struct mpBuffer
             axis_flags[i] = 0;
         }
         plannable = false;
+        primed = false;
         length = 0.0;
         block_time = 0.0;
         override_factor = 0.0;
@@ -433,11 +742,7 @@ typedef struct mpBuffer
         absolute_vmax = 0.0;
         junction_vmax = 0.0;
         jerk = 0.0;
-        jerk_sq = 0.0;
-        recip_jerk = 0.0;
-        sqrt_j = 0.0;
         q_recip_2_sqrt_j = 0.0;
-        gm.reset();
     }
 } mpBuf_t;
 
@@ -446,9 +751,17 @@ typedef struct mpPlannerQueue
     magic_t magic_start;       // magic number to test memory integrity
     mpBuf_t *r;                // 运行缓冲区指针
     mpBuf_t *w;                // 写缓冲区指针
-    uint8_t queue_size;        // 缓冲区总数，一个基础（例如48个不是47个）
-    uint8_t buffers_available; // 运行队列中可用缓冲区的计数
+    uint16_t queue_size;        // 缓冲区总数，一个基础（例如48个不是47个）
+    uint16_t buffers_available; // 运行队列中可用缓冲区的计数
     mpBuf_t *bf;               // 指向缓冲池的指针（存储阵列）
+    mpBufCold_t *cold;         // pointer to the parallel cold record pool
+    uint32_t horizon_in_usec;  // move time committed (free running, wraps)
+    uint32_t horizon_out_usec; // move time freed (free running, wraps)
+    uint32_t horizon_in_um;    // move length committed in microns (free running, wraps)
+    uint32_t horizon_out_um;   // move length freed in microns (free running, wraps)
+    uint32_t time_in_usec;     // block time committed or coalesced (free running, wraps)
+    uint32_t time_plan_usec;   // block time changed by forward planning (free running, wraps)
+    volatile uint32_t time_out_usec;   // block time freed (free running, wraps)
     magic_t magic_end;
 } mpPlannerQueue_t;
 
@@ -480,22 +793,46 @@ typedef struct mpPlannerRuntime
 
     bool out_of_band_dwell_flag;     // 设置为有条件地执行带外停顿
     float out_of_band_dwell_seconds; // 带外停留的时间
+    bool (*out_of_band_dwell_release)(void); // ends the dwell early, or nullptr (see st_prep_out_of_band_dwell())
 
     float unit[AXES];               // 用于轴缩放和规划的单位矢量
     bool axis_flags[AXES];          // set true for axes participating in the move
+    uint16_t axis_mask;             // axis_flags as a bit per axis - the axes segments update
+    uint8_t motor_mask;             // bit per motor that can step in the running block (see kn_active_motors())
+    uint8_t motor_settle;           // bit per idle motor whose step terms are still catching up
     float target[AXES];             // final target for bf (used to correct rounding errors)
     float position[AXES];           // current move position
+    float target_comp[AXES];        // summation compensation (Kahan) for gm.target - zeroed per block
+
+    // spindle synchronized blocks (see _exec_aline_sync())
+    bool sync_started;              // the axes are following - G33 has seen its start revolution
+    int8_t sync_direction;          // 1 if the spindle turned CW at the block start, -1 if CCW
+    int32_t sync_count0;            // encoder count the block's revolutions are taken from
+    int32_t sync_index;             // G33: whole revolution last seen while waiting to start
+    float sync_revs0;               // revolutions past sync_count0 at which travel is zero
+    float sync_command;             // travel the spindle called for at the last segment
+    float sync_travel;              // travel along the block so far (mm)
+    float sync_velocity;            // axis velocity along the block (mm/min)
+    float sync_length;              // length of the block
     float waypoint[SECTIONS][AXES]; // head/body/tail endpoints for correction
 
+    mpPath_t path;                  // copy of the running block's path geometry
+    float path_remaining;           // PATH_ARC: path length from the current position to the target
+    float waypoint_remaining[SECTIONS]; // PATH_ARC: path_remaining at each section end
+
     float target_steps[MOTORS];    // current MR target (absolute target as steps)
     float position_steps[MOTORS];  // current MR position (target from previous segment)
     float commanded_steps[MOTORS]; // will align with next encoder sample (target from 2nd previous segment)
     float encoder_steps[MOTORS];   // encoder position in steps - ideally the same as commanded_steps
     float following_error[MOTORS]; // difference between encoder_steps and commanded steps
 
+    int64_t target_fixed[MOTORS];    // target_steps in fixed point (MR_STEP_FIXED)
+    int64_t position_fixed[MOTORS];  // position sent to the stepper - target less any travel held back
+    int64_t commanded_fixed[MOTORS]; // position_fixed one segment earlier (position_steps and commanded_steps follow these)
+
     mpBlockRuntimeBuf_t *r;       // 正在运行的块
-    mpBlockRuntimeBuf_t *p;       // 正在计划的块，p可能== r
-    mpBlockRuntimeBuf_t block[2]; // 缓冲器保持所述两个块
+    mpBlockRuntimeBuf_t *p;       // next block forward planning fills. r->nx up to p are planned; p == r is full
+    mpBlockRuntimeBuf_t block[MR_BLOCKS]; // runtime block ring (see mp_forward_plan())
 
     mpBuf_t *plan_bf; // DIAGNOSTIC - 指向下一个计划缓冲区的指针
     mpBuf_t *run_bf;  // DIAGNOSTIC - 指向当前运行的缓冲区
@@ -506,6 +843,9 @@ typedef struct mpPlannerRuntime
     uint32_t segment_count; // 运行段数count of running segments
     float segment_velocity; // 计算线段的速度computed velocity for aline segment
     float segment_time;     // 每个线段的实际时间增量actual time increment per aline segment
+    float segment_usec;     // nominal segment time chosen for the running block (see SEGMENT_TIME_ADAPTIVE)
+    float segment_ramp;     // velocity change across the segment as a fraction of segment_velocity (see DDA_SEGMENT_RAMP)
+    struct mpExecTable *table; // precomputed segments of the running block, NULL if computed here (see EXEC_SEGMENT_TABLE)
 
     float forward_diff_1; // 前向差异等级1 forward difference level 1
     float forward_diff_2; // forward difference level 2
@@ -525,11 +865,41 @@ typedef struct mpPlannerRuntime
         section_state = SECTION_OFF;
         entry_velocity = 0;   // needed to ensure next block in forward planning starts from 0 velocity
         r->exit_velocity = 0; // ditto
+        p = r->nx;            // blocks planned ahead are planned again from the stop
         segment_velocity = 0;
+        segment_ramp = 0;
+        table = NULL;
     }
 
 } mpPlannerRuntime_t;
 
+//**** Queue metrics ***
+
+typedef struct mpQueueStats
+{                        // O(1) counters for queue reports - always gathered
+    uint16_t depth_min;  // fewest buffers queued since the window was cleared
+    uint16_t depth_max;  // most buffers queued since the window was cleared
+    uint32_t starved;    // block timeouts - the planner waited on input and planned without it
+    uint32_t backplans;  // blocks back-planned by _plan_block()
+} mpQueueStats_t;
+
+typedef struct mpRuntimeSnapshot
+{                            // runtime values for reports, all from the same segment (see mp_get_runtime_snapshot())
+    float position[AXES];    // machine position (mm)
+    float display[AXES];     // work display position (mm) - offsets and tram rotation applied
+    float velocity;          // segment velocity (mm/min)
+    uint32_t linenum;        // line number of the running block
+    bool held;               // true while a report holds the snapshot
+} mpRuntimeSnapshot_t;
+
+typedef struct mpRunCounters
+{                          // free running totals for job reports - never cleared, each field has one writer
+    uint32_t blocks_in;    // ALINE blocks committed (main loop)
+    float length;          // mm run by freed ALINE blocks (exec interrupt)
+    float commanded_time;  // minutes those blocks take at their requested velocities (exec interrupt)
+    float run_time;        // minutes they take as planned, with ramps and overrides (exec interrupt)
+} mpRunCounters_t;
+
 //**** Master Planner Structure ***
 
 typedef struct mpPlanner
@@ -556,9 +926,7 @@ typedef struct mpPlanner
     bool entry_changed;         // 标记如果exit_velocity变更为下一个块的提示无效
 
     // 进给覆盖和渐变变量（这些变量在cm-> GMX中扩展）
-    float mfo_factor; // 运行时覆盖因子
-    float ramp_target;
-    float ramp_dvdt;
+    float mfo_factor; // 运行时覆盖因子, also the target of any ramp in progress (see _calculate_override())
 
     // objects
     Timeout block_timeout; // 块规划的超时对象
@@ -567,8 +935,22 @@ typedef struct mpPlanner
     mpBuf_t *p;               // 规划器缓冲区指针
     mpBuf_t *c;               // 紧跟在关键区域之后的指针缓冲区
     mpBuf_t *planning_return; // 缓冲区返回到一次后退计划完成
+    mpBuf_t *blend;           // G64 P line held at the write pointer until its corner is known (see mp_aline())
+    float horizon_brake;      // length needed to stop from the newest move's cruise velocity
     mpPlannerRuntime_t *mr;   // 绑定到mr与此计划者相关联
     mpPlannerQueue_t q;       // 嵌入计划程序缓冲区队列管理器
+    mpQueueStats_t stats;     // queue metrics (see mp_clear_queue_stats())
+    mpRunCounters_t run;      // job report totals (see jr_get_stat())
+
+    mpGCodeContext_t gm_context[PLANNER_GM_CONTEXTS]; // interned modal gcode states (see mp_set_block_gm())
+    uint16_t gm_context_in[PLANNER_GM_CONTEXTS];      // blocks committed with each context (main loop)
+    volatile uint16_t gm_context_out[PLANNER_GM_CONTEXTS]; // blocks freed with each context (interrupt)
+    uint8_t gm_context_last;                          // 1 + index of the most recently interned context
+
+    mpAction_t action[PLANNER_ACTIONS]; // actions of queued command and move blocks (see mp_queue_action())
+    uint8_t action_in;                  // next action slot to take (main loop)
+    volatile uint8_t action_out;        // next action slot to run (interrupt)
+    mpBuf_t *action_block;              // newest block, if it is an action block that can take more
 
     magic_t magic_end;
 
@@ -583,6 +965,9 @@ typedef struct mpPlanner
         mfo_active = false;
         ramp_active = false;
         entry_changed = false;
+        blend = NULL;
+        action_block = NULL;
+        horizon_brake = 0;
         block_timeout.clear();
     }
 } mpPlanner_t;
@@ -597,8 +982,8 @@ extern mpPlannerRuntime_t *mr; // context for block runtime
 extern mpPlannerRuntime_t mr1; // primary planner runtime context
 extern mpPlannerRuntime_t mr2; // secondary planner runtime context
 
-extern mpBuf_t mp1_queue[PLANNER_QUEUE_SIZE];   // storage allocation for primary planner queue buffers
-extern mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE]; // storage allocation for secondary planner queue buffers
+extern mpBuf_t mp_pool[PLANNER_POOL_SIZE];          // storage allocation for both planner queues (see mp_pool_lend())
+extern mpBufCold_t mp_pool_cold[PLANNER_POOL_SIZE]; // cold records for the planner pool
 
 /*
  * Global Scope Functions
@@ -606,9 +991,11 @@ extern mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE]; // storage allocation for second
 
 //**** planner.cpp functions
 
-void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uint8_t queue_size);
+void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, mpBufCold_t *cold, uint16_t queue_size);
 void planner_reset(mpPlanner_t *_mp);
 stat_t planner_assert(const mpPlanner_t *_mp);
+void mp_pool_lend(void);
+void mp_pool_reclaim(void);
 
 void mp_halt_runtime(void);
 
@@ -617,24 +1004,31 @@ void mp_set_runtime_position(uint8_t axis, const float position);
 void mp_set_steps_to_runtime_position(void);
 
 void mp_queue_command(void (*cm_exec)(float *, bool *), float *value, bool *flag);
+void mp_queue_action(void (*cm_exec)(float *, bool *), float *value, bool *flag);
+void mp_queue_inline_action(void (*cm_exec)(float *, bool *), float *value, bool *flag);
 stat_t mp_runtime_command(mpBuf_t *bf);
+void mp_runtime_actions(const uint8_t first, const uint8_t actions);
 
 stat_t mp_json_command(char *json_string);
 stat_t mp_json_command_immediate(char *json_string);
 stat_t mp_json_wait(char *json_string);
+#if TEMPERATURE_ENABLED == true
+void mp_heater_wait(const uint8_t heater, const float threshold);
+#endif
 
 stat_t mp_dwell(const float seconds);
 void mp_end_dwell(void);
-void mp_request_out_of_band_dwell(float seconds);
+void mp_request_out_of_band_dwell(float seconds, bool (*release)(void) = nullptr);
 
 //**** planner functions and helpers
-uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp);
+uint16_t mp_get_planner_buffers(const mpPlanner_t *_mp);
 bool mp_planner_is_full(const mpPlanner_t *_mp);
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp);
 bool mp_is_phat_city_time(void);
 
 stat_t mp_planner_callback();
 void mp_replan_queue(mpBuf_t *bf);
+void mp_unplan_queue(mpBuf_t *bf);
 void mp_start_feed_override(const float ramp_time, const float override);
 void mp_end_feed_override(const float ramp_time);
 void mp_start_traverse_override(const float ramp_time, const float override);
@@ -654,20 +1048,42 @@ mpBuf_t *mp_get_r(void);
 #define mp_get_next_buffer(b) ((mpBuf_t *)(b->nx))
 
 mpBuf_t *mp_get_write_buffer(void);
+void mp_unget_write_buffer(void);
 void mp_commit_write_buffer(const blockType block_type);
+void mp_commit_blend(void);
+void mp_horizon_count(mpBuf_t *bf);
+void mp_time_count(mpBuf_t *bf);
+void mp_time_recount(mpBuf_t *bf);
+bool mp_set_block_gm(mpBuf_t *bf, const GCodeState_t *_gm);
+void mp_get_block_gm(const mpBuf_t *bf, GCodeState_t *gm);
+const mpGCodeContext_t *mp_get_block_context(const mpBuf_t *bf);
+void mp_clear_queue_stats(mpPlanner_t *_mp);
 mpBuf_t *mp_get_run_buffer(void);
 bool mp_free_run_buffer(void);
 
+static inline int64_t mp_steps_to_fixed(const float steps) { return ((int64_t)roundf(steps * MR_STEP_FIXED)); }
+static inline float mp_fixed_to_steps(const int64_t fixed) { return ((float)fixed * (1 / MR_STEP_FIXED)); }
+
+// G33, G33.1 blocks are geared to the spindle - they start and end stopped (see cycle_spindle_sync.cpp)
+static inline bool mp_is_spindle_sync(const cmMotionMode mode)
+{
+    return ((mode == MOTION_MODE_SPINDLE_SYNC) || (mode == MOTION_MODE_RIGID_TAP));
+}
+
 //**** plan_line.c functions
 void mp_zero_segment_velocity(void); // getters and setters...
 float mp_get_runtime_velocity(void);
 float mp_get_runtime_absolute_position(mpPlannerRuntime_t *_mr, uint8_t axis);
 float mp_get_runtime_display_position(uint8_t axis);
 void mp_set_runtime_display_offset(float offset[]);
+void mp_hold_runtime_snapshot(void);
+void mp_release_runtime_snapshot(void);
+const mpRuntimeSnapshot_t *mp_get_runtime_snapshot(void);
 bool mp_get_runtime_busy(void);
 bool mp_runtime_is_idle(void);
 
 stat_t mp_aline(GCodeState_t *_gm); // line planning...
+stat_t mp_arc(GCodeState_t *_gm, const mpPath_t *path); // native arc planning
 void mp_plan_block_list(void);
 void mp_plan_block_forward(mpBuf_t *bf);
 
@@ -687,8 +1103,22 @@ float mp_calc_j(const float t, const float v_0, const float v_1, const float T);
 stat_t mp_forward_plan(void);
 stat_t mp_exec_move(void);
 stat_t mp_exec_aline(mpBuf_t *bf);
+stat_t mp_exec_table_callback(void);
+float mp_get_runtime_remaining_length(void);
 void mp_exit_hold_state(void);
 
 void mp_dump_planner(mpBuf_t *bf_start);
 
+stat_t mp_get_pdg(nvObj_t *nv);
+stat_t mp_set_pdg(nvObj_t *nv);
+stat_t mp_get_pdd(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+void mp_print_pdg(nvObj_t *nv);
+void mp_print_pdd(nvObj_t *nv);
+#else
+#define mp_print_pdg tx_print_stub
+#define mp_print_pdd tx_print_stub
+#endif // __TEXT_MODE
+
 #endif // End of include Guard: PLANNER_H_ONCE
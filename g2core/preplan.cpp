@@ -0,0 +1,165 @@
+/*
+ * preplan.cpp - host-side parse and plan of a whole job
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "preplan.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "job.h"
+#include "planner.h"
+#include "plan_arc.h"
+#include "util.h"
+#include "xio.h"
+
+#include <stdio.h>
+
+/**** Allocate Structures ****/
+
+static struct preplanSingleton {
+    float velocity;                         // exit velocity of the last block taken off the queue
+    char line[PREPLAN_LINE_LEN];            // working copy - the parser edits in place
+} pp;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+
+/*
+ * _preplan_take() - plan the queue and take the run block off it, as if it had run
+ *
+ *  The planner state is stepped the way mp_planner_callback() would when the queue fills
+ *  or times out, so every block is backplanned against the moves queued behind it.
+ */
+
+static void _preplan_take(preplanResult_t *r)
+{
+    if (mp->planner_state < PLANNER_PRIMING) {
+        if (mp->planner_state == PLANNER_IDLE) {
+            mp->p = mp_get_r();
+        }
+        mp->planner_state = PLANNER_PRIMING;
+    }
+    mp_plan_block_list();
+
+    mpBuf_t *bf = mp_get_run_buffer();
+    if (bf == NULL) {
+        return;
+    }
+    if (bf->block_type == BLOCK_TYPE_ALINE) {
+        mpBlockRuntimeBuf_t block;
+        mp_calculate_ramps(&block, bf, pp.velocity);
+        pp.velocity = block.exit_velocity;
+        r->move_seconds += (block.head_time + block.body_time + block.tail_time) * 60;   // minutes
+        r->length += bf->length;
+        r->moves++;
+    } else if (bf->block_type == BLOCK_TYPE_DWELL) {
+        r->dwell_seconds += bf->block_time;     // seconds for a dwell
+        pp.velocity = 0;
+    }
+    mp_free_run_buffer();
+}
+
+/*
+ * _preplan_line() - parse one line and queue everything it generates
+ */
+
+static stat_t _preplan_line(preplanResult_t *r)
+{
+    stat_t status = gcode_parser(pp.line);
+
+    while ((cm->arc.run_state != BLOCK_INACTIVE) || cm_canned_cycle_running()) {
+        if (mp_planner_is_full(mp)) {
+            _preplan_take(r);
+            continue;
+        }
+        cm_arc_callback(cm);
+        cm_canned_cycle_callback();
+    }
+    while (mp_planner_is_full(mp)) {
+        _preplan_take(r);
+    }
+    return (status);
+}
+
+/*
+ * preplan_run() - parse and plan a Gcode file ("-" for stdin) and return its planned time
+ */
+
+stat_t preplan_run(const char *path, const bool store, preplanResult_t *r)
+{
+    memset(r, 0, sizeof(preplanResult_t));
+    memset(&pp, 0, sizeof(pp));
+
+    FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (file == NULL) {
+        return (r->status = STAT_FILE_NOT_OPEN);
+    }
+    if (store && ((r->status = job_set_state(JOB_RECORDING)) != STAT_OK)) {
+        fclose(file);
+        return (r->status);
+    }
+    while (fgets(pp.line, sizeof(pp.line), file) != NULL) {
+        r->lines++;
+        pp.line[strcspn(pp.line, "\r\n")] = NUL;
+
+        char *p = pp.line;
+        while ((*p == SPC) || (*p == TAB)) {
+            p++;
+        }
+        if ((*p == NUL) || (strchr("{$?Hh!~%", *p) != NULL)) {
+            continue;                           // not Gcode - the controller would run or trap it
+        }
+        stat_t status = STAT_OK;
+        if (store) {
+            status = job_write_line(p);
+        }
+        if (status == STAT_OK) {
+            status = _preplan_line(r);
+        }
+        if ((status == STAT_OK) || (status == STAT_NOOP)) {
+            status = cm_is_alarmed();
+        }
+        if ((status != STAT_OK) && (status != STAT_NOOP)) {
+            r->status = status;
+            r->error_line = r->lines;
+            break;
+        }
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+
+    mp_commit_blend();                          // the last line's corner won't come
+    while (mp_get_run_buffer() != NULL) {
+        _preplan_take(r);
+    }
+    if (store) {
+        job_set_state((r->status == STAT_OK) ? JOB_END : JOB_IDLE);     // a failed job is not kept
+    }
+    return (r->status);
+}
@@ -0,0 +1,72 @@
+/*
+ * preplan.h - host-side parse and plan of a whole job
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * PREPLAN
+ *
+ *  Runs a Gcode file through the firmware's own parser, canonical machine and planner on
+ *  the host, with no runtime behind them, and returns the planned cycle time. It is used
+ *  for cycle time estimates of many programs without a machine (g2-win -e, see
+ *  sim_harness.h).
+ *
+ *  Blocks are planned with the same lookahead as on the board: a block is taken off the
+ *  queue, as if it had run, only when the planner is full or the input has ended. Its
+ *  time is its planned trapezoid, entered at the exit velocity of the block before, so
+ *  junctions, corner blending, arcs and canned cycles come out as the firmware plans
+ *  them. Dwells count their P time. Commands take no time and are not run. The estimate
+ *  leaves out feedholds, overrides, spindle and heater waits, and the time of tool change
+ *  macros. Jerk is in the planned time, but the runtime's segment rounding is not.
+ *
+ *  JSON and $ lines and single character commands are skipped. The first line that fails
+ *  to parse, or an alarm, ends the estimate with its status and line number.
+ *
+ *  With store set, the Gcode lines are also recorded to the job store as {job:1} records
+ *  them (see job.h), so the job can be run from the store or copied to a board.
+ *
+ *  The parser and planner are the firmware's singletons: one job per process. Use
+ *  g2-win -j to estimate many jobs at once, one process per job.
+ */
+
+#ifndef PREPLAN_H_ONCE
+#define PREPLAN_H_ONCE
+
+#include "config.h"
+
+#define PREPLAN_LINE_LEN 256        // longest Gcode line read from the file
+
+typedef struct preplanResult {
+    uint32_t lines;                 // lines read
+    uint32_t moves;                 // motion blocks planned
+    double move_seconds;            // planned time of the moves
+    double dwell_seconds;           // time of the G4 dwells
+    double length;                  // mm travelled
+    stat_t status;                  // STAT_OK, or what ended the estimate
+    uint32_t error_line;            // line of the file that ended it, 0 if none
+} preplanResult_t;
+
+stat_t preplan_run(const char *path, const bool store, preplanResult_t *r);
+
+#endif  // End of include guard: PREPLAN_H_ONCE
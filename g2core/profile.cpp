@@ -0,0 +1,200 @@
+/*
+ * profile.cpp - interrupt cycle-budget profiling
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "profile.h"
+#include "text_parser.h"
+#include "controller.h"
+#include "xio.h"
+
+#ifdef WIN32
+#include <Windows.h>
+#elif defined(SIM_POSIX)
+#include <time.h>
+#endif
+
+/**** Allocate Structures ****/
+
+profSingleton_t prof;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+/*
+ * profile_init()   - start the cycle counter and clear statistics
+ * profile_reset()  - clear statistics
+ */
+
+void profile_init()
+{
+#if !defined(WIN32) && !defined(SIM_POSIX)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // enable the DWT block
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // start the cycle counter
+#endif
+    profile_reset();
+}
+
+void profile_reset()
+{
+    for (uint8_t r = 0; r < PROF_REGIONS; r++) {
+        prof.region[r].min = UINT32_MAX;
+        prof.region[r].max = 0;
+        prof.region[r].count = 0;
+        prof.region[r].total = 0;
+    }
+    prof.exec_overruns = 0;
+}
+
+/*
+ * prof_cycle_count() - return the free-running cycle counter (wraps at 32 bits)
+ * prof_cycle_rate()  - return the cycle counter rate in Hz
+ */
+
+#ifdef WIN32
+
+uint32_t prof_cycle_count()
+{
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return ((uint32_t)count.QuadPart);
+}
+
+uint32_t prof_cycle_rate()
+{
+    LARGE_INTEGER rate;
+    QueryPerformanceFrequency(&rate);
+    return ((uint32_t)rate.QuadPart);
+}
+
+#elif defined(SIM_POSIX)
+
+uint32_t prof_cycle_count()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec));
+}
+
+uint32_t prof_cycle_rate() { return (1000000000); }
+
+#else
+
+uint32_t prof_cycle_count() { return (DWT->CYCCNT); }
+uint32_t prof_cycle_rate() { return (SystemCoreClock); }
+
+#endif // WIN32 / SIM_POSIX
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * prof_get_stat() - get min, mean or max for a region, decoded from the token:
+ *                   prof + {d=DDA, e=exec, f=forward plan, p=backplan, l=load, k=kinematics, b=board} + {n=min, a=mean, x=max}
+ * prof_get_ov()   - get exec overrun count
+ * prof_set_ov()   - writing 0 clears all statistics
+ * prof_get_hz()   - get the cycle counter rate
+ */
+
+stat_t prof_get_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    profRegion r;
+
+    switch (token[4]) {
+        case 'd': { r = PROF_DDA; break; }
+        case 'e': { r = PROF_EXEC; break; }
+        case 'f': { r = PROF_FWD_PLAN; break; }
+        case 'p': { r = PROF_BACK_PLAN; break; }
+        case 'l': { r = PROF_LOAD; break; }
+        case 'k': { r = PROF_KINEMATICS; break; }
+        case 'b': { r = PROF_BOARD; break; }
+        default:  { return (STAT_INTERNAL_ERROR); }
+    }
+    const profStats_t *s = &prof.region[r];
+    if (s->count == 0) {
+        return (get_integer(nv, 0));
+    }
+    switch (token[5]) {
+        case 'n': { return (get_integer(nv, s->min)); }
+        case 'x': { return (get_integer(nv, s->max)); }
+        default:  { return (get_integer(nv, (int32_t)(s->total / s->count))); }
+    }
+}
+
+stat_t prof_get_ov(nvObj_t *nv) { return (get_integer(nv, prof.exec_overruns)); }
+
+stat_t prof_set_ov(nvObj_t *nv)
+{
+    if (nv->value_int != 0) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    profile_reset();
+    return (STAT_OK);
+}
+
+stat_t prof_get_hz(nvObj_t *nv) { return (get_integer(nv, prof_cycle_rate())); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_prof_stat[] = "[%s] %s cycles%18lu\n";
+static const char fmt_prof_ov[] = "[profov] exec overruns%16lu\n";
+static const char fmt_prof_hz[] = "[profhz] cycle counter rate%11lu Hz\n";
+
+void prof_print_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    const char *region;
+    switch (token[4]) {
+        case 'd': { region = "DDA"; break; }
+        case 'e': { region = "exec"; break; }
+        case 'f': { region = "fwd plan"; break; }
+        case 'p': { region = "back plan"; break; }
+        case 'l': { region = "load"; break; }
+        case 'k': { region = "kinematics"; break; }
+        default:  { region = "board"; break; }
+    }
+    const char *stat = (token[5] == 'n') ? "min" : ((token[5] == 'x') ? "max" : "mean");
+    char label[20];
+
+    sprintf(label, "%s %s", region, stat);
+    sprintf(cs.out_buf, fmt_prof_stat, token, label, (unsigned long)nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
+void prof_print_ov(nvObj_t *nv) { text_print(nv, fmt_prof_ov); }
+void prof_print_hz(nvObj_t *nv) { text_print(nv, fmt_prof_hz); }
+
+#endif // __TEXT_MODE
@@ -0,0 +1,134 @@
+/*
+ * profile.h - interrupt cycle-budget profiling
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * PROFILING
+ *
+ *  Records min / mean / max cycle counts for the stepper interrupts (DDA, exec and forward
+ *  planning) and the segment loader, for backplanning, for kinematics transform calls and for the board's housekeeping tasks, and counts exec overruns - times the loader wanted a segment but the prep
+ *  buffer was still owned by exec. Values are reported in the {"prof":n} group in units
+ *  of the cycle counter, whose rate is reported as "profhz". Writing 0 to "profov" clears
+ *  all statistics.
+ *
+ *  The cycle counter is the Cortex-M DWT cycle counter on ARM targets, the performance
+ *  counter on the Windows simulator and a nanosecond clock on the POSIX simulator.
+ *  Profiling is compiled out unless PROFILE_ENABLED is true.
+ */
+
+#ifndef PROFILE_H_ONCE
+#define PROFILE_H_ONCE
+
+#include "config.h"
+#include "settings.h"       // for PROFILE_ENABLED
+
+/**** Structures ****/
+
+typedef enum {              // profiled code regions
+    PROF_DDA = 0,           // DDA step interrupt
+    PROF_EXEC,              // exec interrupt - mp_exec_move()
+    PROF_FWD_PLAN,          // forward planning interrupt - mp_forward_plan()
+    PROF_BACK_PLAN,         // backplanning - mp_plan_block_list()
+    PROF_LOAD,              // segment loader - _load_move(), inside the DDA or exec interrupt
+    PROF_KINEMATICS,        // kn_inverse_kinematics() call
+    PROF_BOARD,             // board housekeeping controller tasks (hardware.cpp)
+    PROF_REGIONS            // must be last
+} profRegion;
+
+typedef struct profStats {
+    uint32_t min;           // fewest cycles seen
+    uint32_t max;           // most cycles seen
+    uint32_t count;         // number of samples
+    uint64_t total;         // total cycles (for mean)
+} profStats_t;
+
+typedef struct profSingleton {
+    profStats_t region[PROF_REGIONS];
+    uint32_t exec_overruns; // loader found the prep buffer still owned by exec
+} profSingleton_t;
+
+extern profSingleton_t prof;
+
+/**** Function prototypes ****/
+
+void profile_init(void);
+void profile_reset(void);
+uint32_t prof_cycle_count(void);
+uint32_t prof_cycle_rate(void);
+
+/*
+ * prof_record() - add one sample to a region
+ * profIsrTimer  - scoped timer; records the time from construction to end of scope
+ */
+
+static inline void prof_record(const profRegion r, const uint32_t cycles)
+{
+    profStats_t *s = &prof.region[r];
+    if (cycles < s->min) { s->min = cycles; }
+    if (cycles > s->max) { s->max = cycles; }
+    s->total += cycles;
+    s->count++;
+}
+
+struct profIsrTimer {
+    const profRegion _region;
+    const uint32_t _start;
+
+    profIsrTimer(const profRegion region) : _region{region}, _start{prof_cycle_count()} {};
+    ~profIsrTimer() { prof_record(_region, prof_cycle_count() - _start); };
+};
+
+#if PROFILE_ENABLED == true
+#define PROFILE_ISR(r)          profIsrTimer _prof_timer(r);
+#define PROFILE_CALL(r)         profIsrTimer _prof_timer(r);
+#define PROFILE_EXEC_OVERRUN()  prof.exec_overruns++;
+#else
+#define PROFILE_ISR(r)
+#define PROFILE_CALL(r)
+#define PROFILE_EXEC_OVERRUN()
+#endif
+
+/**** Configuration and interface functions ****/
+
+stat_t prof_get_stat(nvObj_t *nv);
+stat_t prof_get_ov(nvObj_t *nv);
+stat_t prof_set_ov(nvObj_t *nv);
+stat_t prof_get_hz(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+    void prof_print_stat(nvObj_t *nv);
+    void prof_print_ov(nvObj_t *nv);
+    void prof_print_hz(nvObj_t *nv);
+
+#else
+
+    #define prof_print_stat tx_print_stub
+    #define prof_print_ov tx_print_stub
+    #define prof_print_hz tx_print_stub
+
+#endif // __TEXT_MODE
+
+#endif  // End of include guard: PROFILE_H_ONCE
@@ -53,7 +53,14 @@ Motate::PWMOutputPin<Motate::kSpindle_Pwm2PinNumber> secondary_pwm_pin {Motate::
  *    - See system.h for timer and port assignments
  *  - Don't do this: memset(&TIMER_PWM1, 0, sizeof(PWM_TIMER_t)); // zero out the timer registers
  */
-void pwm_init() {}
+void pwm_init()
+{
+    for (uint8_t chan = 0; chan < PWMS; chan++) {
+        pwm.p[chan].compare = PWM_COMPARE_NONE;
+    }
+    pwm.p[PWM_1].top = spindle_pwm_pin.getTopValue();
+    pwm.p[PWM_2].top = secondary_pwm_pin.getTopValue();
+}
 
 /*
  * pwm_set_freq() - set PWM channel frequency
@@ -63,19 +70,25 @@ void pwm_init() {}
  *
  *  Assumes 32MHz clock.
  *  Doesn't turn time on until duty cycle is set
+ *
+ *  Caches the new timer top for pwm_get_compare(). The duty must be set again after a
+ *  frequency change, as the old compare value no longer means the same duty.
  */
 
 stat_t pwm_set_freq(uint8_t chan, float freq)
 {
-    if (chan > PWMS) { return (STAT_NO_SUCH_DEVICE);}
+    if (chan >= PWMS) { return (STAT_NO_SUCH_DEVICE);}
     //if (freq < PWM_MIN_FREQ) { return (STAT_INPUT_LESS_THAN_MIN_VALUE);}
     //if (freq > PWM_MAX_FREQ) { return (STAT_INPUT_EXCEEDS_MAX_VALUE);}
 
     if (chan == PWM_1) {
         spindle_pwm_pin.setFrequency(freq);
+        pwm.p[PWM_1].top = spindle_pwm_pin.getTopValue();
     } else if (chan == PWM_2) {
         secondary_pwm_pin.setFrequency(freq);
+        pwm.p[PWM_2].top = secondary_pwm_pin.getTopValue();
     }
+    pwm.p[chan].compare = PWM_COMPARE_NONE;
 
     return (STAT_OK);
 }
@@ -97,20 +110,46 @@ stat_t pwm_set_duty(uint8_t chan, float duty)
 {
     if (duty < 0.0) { return (STAT_INPUT_LESS_THAN_MIN_VALUE);}
     if (duty > 1.0) { return (STAT_INPUT_EXCEEDS_MAX_VALUE);}
+    if (chan >= PWMS) { return (STAT_NO_SUCH_DEVICE);}
+
+    pwm_set_compare(chan, pwm_get_compare(chan, duty));
+    return (STAT_OK);
+}
+
+/*
+ * pwm_get_compare() - timer compare value for a duty cycle, from the cached timer top
+ * pwm_set_compare() - write a compare value computed ahead of time
+ *
+ *  These split pwm_set_duty() so callers that update the PWM often - per segment, or
+ *  per raster pixel from the DDA - can work out compare values outside the interrupt
+ *  and only write a register in it. Nothing touches the frequency setup, and a value
+ *  that hasn't changed isn't written at all. The timer takes the new value through
+ *  its update (shadow) register where the chip has one, so it lands on a period boundary.
+ */
+
+uint16_t pwm_get_compare(uint8_t chan, float duty)
+{
+    return ((uint16_t)(pwm.p[chan].top * duty));
+}
+
+void pwm_set_compare(uint8_t chan, uint16_t compare)
+{
+    if (pwm.p[chan].compare == compare) {
+        return;
+    }
+    pwm.p[chan].compare = compare;
 
     if (chan == PWM_1) {
 //        if (spindle_pwm_pin.isNull()) {
 //            cm_alarm(STAT_ALARM, "attempt to turn on a non-existent spindle");
 //        }
-        spindle_pwm_pin = duty;
+        spindle_pwm_pin.writeRaw(compare);
     } else if (chan == PWM_2) {
 //        if (secondary_pwm_pin.isNull()) {
 //            cm_alarm(STAT_ALARM, "attempt to turn on a non-existent spindle");
 //        }
-        secondary_pwm_pin = duty;
+        secondary_pwm_pin.writeRaw(compare);
     }
-
-    return (STAT_OK);
 }
 
 
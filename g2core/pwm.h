@@ -42,9 +42,12 @@ typedef struct pwmConfigChannel {
 } pwmConfigChannel_t;
 
 typedef struct pwmChannel {
-    // no data required in ARM
+    uint16_t top;                   // timer counts per PWM period - cached by pwm_set_freq()
+    uint32_t compare;               // compare value last written, or PWM_COMPARE_NONE
 } pwmChannel_t;
 
+#define PWM_COMPARE_NONE 0xFFFFFFFF // forces the next compare value to be written
+
 typedef struct pwmControl {
     pwmConfigChannel_t  c[PWMS];    // array of channel configs
     pwmChannel_t        p[PWMS];    // array of PWM channels
@@ -57,6 +60,8 @@ extern pwmControl_t pwm;
 void pwm_init(void);
 stat_t pwm_set_freq(uint8_t channel, float freq);
 stat_t pwm_set_duty(uint8_t channel, float duty);
+uint16_t pwm_get_compare(uint8_t channel, float duty);
+void pwm_set_compare(uint8_t channel, uint16_t compare);
 
 stat_t pwm_set_pwm(nvObj_t *nv);
 
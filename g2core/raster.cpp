@@ -0,0 +1,271 @@
+/*
+ * raster.cpp - laser raster lines played out from the step generator
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "raster.h"
+#include "hardware.h"
+#include "stepper.h"
+#include "spindle.h"
+#include "pwm.h"
+#include "xio.h"
+#include "text_parser.h"
+#include "util.h"
+
+/**** Raster singleton structure ****
+ *
+ *  The ring is written by the main loop, freed by the exec and read by the DDA. Each
+ *  index is free-running and masked on use. Pixels are only freed when the raster line
+ *  after the one that used them starts to run, so the DDA is long done with them.
+ */
+
+struct rsRasterSingleton {
+    uint8_t ring[RASTER_BUFFER_SIZE];   // pixel power values, 0..255
+
+    // main loop
+    uint16_t write;                     // next byte to write
+    uint16_t pending;                   // first pixel not yet given to a move
+
+    // exec
+    volatile uint16_t free;             // bytes before this index may be overwritten
+    uint16_t last_start;                // first pixel of the raster line that ran last
+    rasterBlock_t line;                 // raster line of the running block
+    float target[AXES];                 // target of the running block
+    float unit[AXES];                   // unit vector of the running block
+    uint16_t compare_lo;                // PWM compare value at pixel value 0
+    int32_t compare_span;               // compare added from pixel value 0 to 255
+
+    // DDA
+    volatile bool running;              // a raster line is being played
+    uint16_t pixel;                     // ring index of the pixel being played
+    uint16_t end;                       // ring index one past the line's last pixel
+    uint16_t run_compare_lo;
+    int32_t run_compare_span;
+};
+static struct rsRasterSingleton rs;
+
+static void _write_pixel()
+{
+    int32_t span = rs.run_compare_span * rs.ring[rs.pixel & RASTER_BUFFER_MASK];
+    pwm_set_compare(PWM_1, (uint16_t)(rs.run_compare_lo + span / 255));
+}
+
+/****************************************************************************************
+ * raster_reset()   - drop all queued and pending pixels (queue flush, halt)
+ * raster_is_full() - true if the ring can't take another full input line of pixels
+ * raster_pending() - true if pixels are waiting for a move
+ * raster_running() - true while the DDA is playing a raster line
+ */
+
+void raster_reset()
+{
+    rs.running = false;
+    rs.write = 0;
+    rs.pending = 0;
+    rs.free = 0;
+    rs.last_start = 0;
+    rs.line.pixels = 0;
+}
+
+bool raster_is_full() { return ((uint16_t)(rs.write - rs.free) > (RASTER_BUFFER_SIZE - RASTER_LINE_PIXELS)); }
+
+bool raster_pending() { return (rs.write != rs.pending); }
+
+bool raster_running() { return (rs.running); }
+
+/****************************************************************************************
+ * raster_attach() - give the pending pixels to a straight feed being queued (main loop)
+ */
+
+void raster_attach(rasterBlock_t *rb, const float length)
+{
+    rb->start = rs.pending;
+    rb->pixels = rs.write - rs.pending;
+    rb->length = length;
+    rs.pending = rs.write;
+}
+
+/****************************************************************************************
+ * raster_start_block()  - set up the raster line of a block starting to run (exec)
+ * raster_prep_segment() - work out the pixels a segment plays and pass them to the stepper
+ *
+ *  raster_prep_segment() returns false if the block isn't a raster line, in which case
+ *  the caller runs the spindle as usual.
+ */
+
+void raster_start_block(const rasterBlock_t *rb, const float target[], const float unit[], const float spindle_speed)
+{
+    rs.line = *rb;
+    if (rs.line.pixels == 0) {
+        return;
+    }
+    rs.free = rs.last_start;                // the line before last is no longer needed
+    rs.last_start = rs.line.start;
+    copy_vector(rs.target, target);
+    copy_vector(rs.unit, unit);
+    rs.compare_lo = pwm_get_compare(PWM_1, spindle_power_duty(spindle_speed, 0.0));
+    rs.compare_span = (int32_t)pwm_get_compare(PWM_1, spindle_power_duty(spindle_speed, 1.0)) - rs.compare_lo;
+}
+
+static float _pixel_position(const float position[])
+{
+    float remaining = 0;                    // distance to the end of the line
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        remaining += (rs.target[axis] - position[axis]) * rs.unit[axis];
+    }
+    float p = rs.line.pixels - (remaining * rs.line.pixels / rs.line.length);
+    return (min(max(p, 0.0f), (float)rs.line.pixels));
+}
+
+bool raster_prep_segment(const float position[], const float target[], const float segment_time)
+{
+    rasterSegment_t seg = {};
+
+    if (rs.line.pixels == 0) {
+        st_prep_raster(&seg);
+        return (false);
+    }
+    float p0 = _pixel_position(position);
+    float p1 = _pixel_position(target);
+    uint32_t dda_ticks = (uint32_t)(segment_time * 60 * FREQUENCY_DDA);   // as st_prep_line()
+
+    if ((p0 < rs.line.pixels) && (p1 > p0) && (dda_ticks != 0)) {
+        uint16_t whole = (uint16_t)p0;
+        seg.pixel = rs.line.start + whole;
+        seg.end = rs.line.start + rs.line.pixels;
+        seg.phase = (uint32_t)((p0 - whole) * RASTER_PIXEL_ONE);
+        seg.increment = max((uint32_t)((p1 - p0) * RASTER_PIXEL_ONE / dda_ticks), (uint32_t)1);
+        seg.compare_lo = rs.compare_lo;
+        seg.compare_span = rs.compare_span;
+    }
+    st_prep_raster(&seg);
+    return (true);
+}
+
+/****************************************************************************************
+ * raster_load()    - start a prepared segment's pixels (loader interrupt)
+ * raster_advance() - move on by whole pixels (DDA interrupt). Returns false at line end
+ *
+ *  A segment with no pixels ends any line still playing and puts the spindle's own
+ *  duty back.
+ */
+
+void raster_load(const rasterSegment_t *seg)
+{
+    if (seg->increment == 0) {
+        if (rs.running) {
+            rs.running = false;
+            pwm_set_duty(PWM_1, spindle.duty);
+        }
+        return;
+    }
+    rs.pixel = seg->pixel;
+    rs.end = seg->end;
+    rs.run_compare_lo = seg->compare_lo;
+    rs.run_compare_span = seg->compare_span;
+    rs.running = true;
+    _write_pixel();
+}
+
+bool raster_advance(const uint32_t pixels)
+{
+    rs.pixel += pixels;
+    if ((int16_t)(rs.end - rs.pixel) <= 0) {
+        rs.running = false;
+        pwm_set_duty(PWM_1, spindle.duty);
+        return (false);
+    }
+    _write_pixel();
+    return (true);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * rs_get_rst() - number of pixels waiting for a move
+ * rs_set_rst() - append base64 pixels for the next straight feed
+ *
+ *  The whole string is rejected if it has a bad character or doesn't fit in the ring.
+ */
+
+static int8_t _base64_value(const char c)
+{
+    if ((c >= 'A') && (c <= 'Z')) { return (c - 'A'); }
+    if ((c >= 'a') && (c <= 'z')) { return (c - 'a' + 26); }
+    if ((c >= '0') && (c <= '9')) { return (c - '0' + 52); }
+    if (c == '+') { return (62); }
+    if (c == '/') { return (63); }
+    return (-1);
+}
+
+stat_t rs_get_rst(nvObj_t *nv)
+{
+    nv->value_int = (uint16_t)(rs.write - rs.pending);
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t rs_set_rst(nvObj_t *nv)
+{
+    uint16_t write = rs.write;
+    uint32_t bits = 0;
+    uint8_t bit_count = 0;
+
+    for (const char *p = *nv->stringp; (*p != NUL) && (*p != '='); p++) {
+        int8_t value = _base64_value(*p);
+        if (value < 0) {
+            return (STAT_INPUT_VALUE_RANGE_ERROR);
+        }
+        bits = (bits << 6) | value;
+        bit_count += 6;
+        if (bit_count >= 8) {
+            bit_count -= 8;
+            if ((uint16_t)(write - rs.free) >= RASTER_BUFFER_SIZE) {
+                return (STAT_BUFFER_FULL);
+            }
+            rs.ring[write++ & RASTER_BUFFER_MASK] = (uint8_t)(bits >> bit_count);
+        }
+    }
+    rs.write = write;
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_rst[] = "[rst]  raster pixels pending%8d\n";
+
+void rs_print_rst(nvObj_t *nv) { text_print(nv, fmt_rst); }  // TYPE_INT
+
+#endif // __TEXT_MODE
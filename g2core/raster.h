@@ -0,0 +1,103 @@
+/*
+ * raster.h - laser raster lines played out from the step generator
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * RASTER LINES
+ *
+ *  A raster line is one straight feed (G1) with a row of laser power values spread
+ *  evenly along it. The pixels are sent ahead of the move as base64 bytes, 0 = off and
+ *  255 = the move's S power:
+ *
+ *      {rst:"AAAAgP//gAAA"}        (may be sent more than once to append)
+ *      G1 X50 F6000 S1000
+ *
+ *  The next G1 takes all pending pixels. They are kept in a ring shared by the queued
+ *  raster moves, so the planner only sees one block per scan line. The runtime works out
+ *  where each segment starts and ends in pixels, and the DDA interrupt steps through
+ *  the pixels at tick resolution and writes the spindle PWM as each one starts. PWM
+ *  compare values are worked out by the exec, so the DDA only does integer math.
+ *  Position is measured from the move's target, so pixels stay on the same spot on the
+ *  work through a feedhold. After the last pixel the spindle's own duty is restored.
+ *
+ *  Raster moves are never coalesced or corner blended. Reading {rst:} returns the
+ *  number of pixels waiting for a move.
+ */
+
+#ifndef RASTER_H_ONCE
+#define RASTER_H_ONCE
+
+#include "config.h"
+
+#ifndef RASTER_BUFFER_SIZE
+#define RASTER_BUFFER_SIZE 2048         // pixel ring size - must be a power of 2. boards can override this value in hardware.h
+#endif
+#define RASTER_BUFFER_MASK (RASTER_BUFFER_SIZE - 1)
+#define RASTER_LINE_PIXELS ((RX_BUFFER_SIZE * 3) / 4)   // most pixels one input line can carry
+
+#define RASTER_PIXEL_SHIFT 16           // fixed point pixel position used by the DDA
+#define RASTER_PIXEL_ONE (1UL << RASTER_PIXEL_SHIFT)
+
+typedef struct rasterBlock {            // raster line carried by a planner block
+    uint16_t start;                     // ring index of the first pixel
+    uint16_t pixels;                    // pixel count, 0 if the block is not a raster line
+    float length;                       // length of the move as queued (mm)
+} rasterBlock_t;
+
+typedef struct rasterSegment {          // raster playback for one prepared segment
+    uint32_t increment;                 // pixels per DDA tick (RASTER_PIXEL_ONE = 1). 0 = no raster
+    uint32_t phase;                     // part of the first pixel already played at segment start
+    uint16_t pixel;                     // ring index of the pixel at segment start
+    uint16_t end;                       // ring index one past the line's last pixel
+    uint16_t compare_lo;                // PWM compare value for pixel value 0
+    int32_t compare_span;               // compare added from pixel value 0 to 255
+} rasterSegment_t;
+
+/**** Function Prototypes ****/
+
+void raster_reset(void);
+bool raster_is_full(void);
+bool raster_pending(void);
+void raster_attach(rasterBlock_t *rb, const float length);
+void raster_start_block(const rasterBlock_t *rb, const float target[], const float unit[], const float spindle_speed);
+bool raster_prep_segment(const float position[], const float target[], const float segment_time);
+void raster_load(const rasterSegment_t *rs);
+bool raster_advance(const uint32_t pixels);
+bool raster_running(void);
+
+stat_t rs_get_rst(nvObj_t *nv);
+stat_t rs_set_rst(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void rs_print_rst(nvObj_t *nv);
+
+#else
+
+#define rs_print_rst tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: RASTER_H_ONCE
@@ -35,6 +35,7 @@
 #include "settings.h"
 #include "util.h"
 #include "xio.h"
+#include "job.h"
 
 
 /**** Allocation ****/
@@ -62,7 +63,9 @@ stat_t rpt_exception(stat_t status, const char *msg)
             char buffer[128];
             sprintf(buffer, "{\"er\":{\"fb\":%0.2f,\"st\":%d,\"msg\":\"%s - %s\"}}\n",
                              G2CORE_FIRMWARE_BUILD, status, get_status_message(status), msg);
+            xioLane lane = xio_set_lane(XIO_LANE_ACK);
             xio_writeline(buffer);
+            xio_set_lane(lane);
         }
     }
     return (status);            // makes it possible to inline, e.g: return(rpt_exception(status));
@@ -167,6 +170,8 @@ void rpt_print_system_ready_message(void)
  */
 static stat_t _populate_unfiltered_status_report(void);
 static uint8_t _populate_filtered_status_report(void);
+static void _prepare_status_report(void);
+static bool _is_deferred(const char *group);
 
 uint8_t _is_stat(nvObj_t *nv)
 {
@@ -194,6 +199,15 @@ void sr_init_status_report()
     // record the index of the "stat" variable so we can use it during reporting
     sr.stat_index = nv_get_index((const char *)"", (const char *)"stat");
 
+    // and the indexes of the binary SR values, in record order
+    char pos_token[] = "posx";
+    sr.binary_index[0] = nv_get_index((const char *)"", (const char *)"line");
+    sr.binary_index[1] = nv_get_index((const char *)"", (const char *)"vel");
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        pos_token[3] = AXIS_CHARS[axis];
+        sr.binary_index[axis+2] = nv_get_index((const char *)"", pos_token);
+    }
+
     // setup the status report array 
     for (uint8_t i=0; i < NV_STATUS_REPORT_LEN ; i++) {
         if (sr_defaults[i][0] == NUL) break;                    // quit on first blank array entry
@@ -207,6 +221,47 @@ void sr_init_status_report()
         nv_persist(nv);                                         // conditionally persist - automatic by nv_persist()
         nv->index++;                                            // increment SR NVM index
     }
+    _prepare_status_report();
+}
+
+/*
+ * _prepare_status_report() - build the SR plan from sr.status_report_list
+ *
+ *  Resolves everything about the SR elements that is fixed once the list is set, so the
+ *  filtered report only has to fetch and compare values. Must be called any time the list
+ *  is changed. Records the element count, whether the value is carried as a float, the
+ *  change threshold derived from the display precision, and whether the element may be
+ *  left out of adaptive filtered reports under load.
+ *
+ *  Thresholds allow for floating point roundoffs, i.e. precision = 2 is 0.01 becomes --> 0.009
+ */
+static void _prepare_status_report()
+{
+    const float precision[8] = { 0.9, 0.09, 0.009, 0.0009, 0.00009, 0.000009, 0.0000009, 0.00000009 };
+
+    sr.status_report_count = 0;
+    for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
+        index_t index = sr.status_report_list[i];
+        if ((index == 0) || (index >= nv_index_max())) {
+            break;
+        }
+        sr.status_report_is_float[i] = ((valueType)(cfgArray[index].flags & F_TYPE_MASK) == TYPE_FLOAT);
+        sr.status_report_threshold[i] = precision[cfgArray[index].precision & 0x07];
+        sr.status_report_is_deferred[i] = _is_deferred(cfgArray[index].group);
+        sr.status_report_count++;
+    }
+}
+
+/*
+ * _is_deferred() - true for groups that an adaptive SR leaves out under load
+ *
+ *  Inputs, outputs, heaters and PIDs change slowly next to motion, and temperatures are
+ *  the most expensive values in the list to fetch.
+ */
+static bool _is_deferred(const char *group)
+{
+    return ((strcmp(group, "in") == 0) || (strcmp(group, "out") == 0) ||
+            (strncmp(group, "he", 2) == 0) || (strncmp(group, "pid", 3) == 0));
 }
 
 /*
@@ -243,6 +298,7 @@ stat_t sr_set_status_report(nvObj_t *nv)
         return (STAT_INPUT_LESS_THAN_MIN_VALUE);
     }
     memcpy(sr.status_report_list, status_report_list, sizeof(status_report_list));
+    _prepare_status_report();
     return(_populate_unfiltered_status_report());            // return current values
 }
 
@@ -268,6 +324,7 @@ stat_t sr_request_status_report(cmStatusReportRequest request_type)
    }
 
     sr.status_report_systick = SysTickTimer_getValue();
+    controller_wake_task(CONTROLLER_TASK_STATUS_REPORT);
     if (request_type == SR_REQUEST_IMMEDIATE) {
         sr.status_report_request = SR_FILTERED;     // will trigger a filtered or verbose report depending on verbosity setting
 
@@ -285,8 +342,28 @@ stat_t sr_request_status_report(cmStatusReportRequest request_type)
     return (STAT_OK);
 }
 
+/*
+ * _sr_constrained() - true if the system has no time to spare for status reports
+ *
+ *  The planner is short of time when its plannable time drops under PHAT_CITY_TIME, and
+ *  TX is congested when a write found the TX ring full since the last check.
+ */
+static bool _sr_constrained()
+{
+    xioStats_t stats;
+    xio_get_stats(stats);
+    bool tx_congested = (stats.tx_full_waits != sr.tx_full_waits);
+    sr.tx_full_waits = stats.tx_full_waits;
+    return (tx_congested || !mp_is_phat_city_time());
+}
+
 /*
  * sr_status_report_callback() - main loop callback to send a report if one is ready
+ *
+ *  In adaptive mode ({sa:1}) a filtered report that comes due under load is put off by
+ *  one interval at a time, up to SR_ADAPTIVE_DEFERRALS intervals, after which it is sent
+ *  without its deferred elements. Those keep their last reported values, so they go out
+ *  with the first report that has headroom. Verbose reports are never put off.
  */
 stat_t sr_status_report_callback()         // called by controller dispatcher
 {
@@ -297,8 +374,21 @@ stat_t sr_status_report_callback()         // called by controller dispatcher
         return (STAT_NOOP);
     }
 
-   // don't send an SR if you the planner is experiencing a time constraint
-   if (!mp_is_phat_city_time()) {
+    sr.constrained = false;
+    if (sr.status_report_adaptive) {
+        sr.constrained = _sr_constrained();
+        if (sr.constrained &&
+            (sr.status_report_request != SR_VERBOSE) &&
+            (sr.status_report_verbosity != SR_VERBOSE) &&
+            (sr.deferrals < SR_ADAPTIVE_DEFERRALS)) {
+            sr.deferrals++;
+            sr.status_report_systick = SysTickTimer_getValue() + sr.status_report_interval;
+            return (STAT_NOOP);
+        }
+        sr.deferrals = 0;
+
+    // don't send an SR if you the planner is experiencing a time constraint
+    } else if (!mp_is_phat_city_time()) {
         if (++sr.throttle_counter != SR_THROTTLE_COUNT) {
             return (STAT_NOOP);
         }
@@ -314,7 +404,52 @@ stat_t sr_status_report_callback()         // called by controller dispatcher
             return (STAT_OK);
         }
     }
+    xioLane lane = xio_set_lane(XIO_LANE_REPORT);
     nv_print_list(STAT_OK, TEXT_MULTILINE_FORMATTED, JSON_OBJECT_FORMAT);
+    xio_set_lane(lane);
+    return (STAT_OK);
+}
+
+/*
+ * sr_binary_report_callback() - send a binary status report on the secondary channel
+ *
+ *  Values are fetched through the cached table indexes and copied into the record as
+ *  they are, so there is no number formatting and no JSON. A record that doesn't fit in
+ *  the TX ring is dropped (and counted in the xio TX full waits) - the next one is only
+ *  {sbi:} ms away.
+ */
+stat_t sr_binary_report_callback()
+{
+    if ((sr.binary_interval == 0) || (SysTickTimer_getValue() < sr.binary_systick)) {
+        return (STAT_NOOP);
+    }
+    sr.binary_systick = SysTickTimer_getValue() + sr.binary_interval;
+
+    uint8_t payload[SR_BINARY_LEN];
+    uint32_t tick = SysTickTimer_getValue();
+    nvObj_t nv = {};
+
+    payload[0] = SR_BINARY_RECORD;
+    payload[1] = AXES;
+    payload[2] = (uint8_t)cm_get_combined_state(&cm1);
+    payload[3] = (uint8_t)min(mp_get_planner_buffers(mp), (uint16_t)UINT8_MAX);
+    memcpy(&payload[4], &tick, sizeof(uint32_t));
+
+    uint8_t *p = &payload[8];
+    mp_hold_runtime_snapshot();
+    for (uint8_t i = 0; i < AXES+2; i++) {
+        nv.index = sr.binary_index[i];
+        nv_get_nvObj(&nv);
+        if (nv.valuetype == TYPE_FLOAT) {
+            memcpy(p, &nv.value_flt, sizeof(float));
+        } else {
+            int32_t value = nv.value_int;           // line is the only integer value
+            memcpy(p, &value, sizeof(int32_t));
+        }
+        p += 4;
+    }
+    mp_release_runtime_snapshot();
+    xio_binary_write_secondary(payload, sizeof(payload));
     return (STAT_OK);
 }
 
@@ -332,11 +467,11 @@ stat_t sr_run_text_status_report()
  * _populate_unfiltered_status_report() - populate nvObj body with status values
  *
  *  Designed to be run as a response; i.e. have a "r" header and a footer.
+ *  Both populate functions hold a runtime snapshot while they run (see mp_get_runtime_snapshot())
  */
 static stat_t _populate_unfiltered_status_report()
 {
     const char sr_str[] = "sr";
-    char tmp[TOKEN_LEN+1];
     nvObj_t *nv = nv_reset_nv_list();       // sets *nv to the start of the body
 
     nv->valuetype = TYPE_PARENT;            // setup the parent object (no length checking required)
@@ -344,18 +479,18 @@ static stat_t _populate_unfiltered_status_report()
     nv->index = nv_get_index((const char *)"", sr_str);// set the index - may be needed by calling function
     nv = nv->nx;                            // no need to check for NULL as list has just been reset
 
-    for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
-        if ((nv->index = sr.status_report_list[i]) == 0) { break;}
+    mp_hold_runtime_snapshot();
+    for (uint8_t i=0; i<sr.status_report_count; i++) {
+        nv->index = sr.status_report_list[i];
         nv_get_nvObj(nv);
-
-        strcpy(tmp, nv->group);             // flatten out groups - WARNING - you cannot use strncpy here...
-        strcat(tmp, nv->token);
-        strcpy(nv->token, tmp);             //...or here.
+        strcpy(nv->token, cfgArray[nv->index].token);   // flatten out groups - table tokens carry the group prefix
 
         if ((nv = nv->nx) == NULL) {
+            mp_release_runtime_snapshot();
             return (cm_panic(STAT_BUFFER_FULL_FATAL, "_populate_unfiltered_status_report() sr link NULL"));    // should never be NULL unless SR length exceeds available buffer array
         }
     }
+    mp_release_runtime_snapshot();
     return (STAT_OK);
 }
 
@@ -365,62 +500,54 @@ static stat_t _populate_unfiltered_status_report()
  *  Designed to be displayed as a JSON object; i.e. no footer or header
  *  Returns 'true' if the report has new data, 'false' if there is nothing to report.
  *
- *  NOTE: Unlike sr_populate_unfiltered_status_report(), this function does NOT set
- *  the SR index, which is a relatively expensive operation. In current use this
- *  doesn't matter, but if the caller assumes its set it may lead to a side-effect (bug)
+ *  Runs from the SR plan built by _prepare_status_report(). Only changed values are
+ *  written into the nv list, packed from the start of the body, so the serializer never
+ *  walks filtered-out objects. Unchanged values reuse the same nvObj for the next element.
+ *  sr.status_report_value[] holds the last reported values in list order.
  *
- *  NOTE: Room for improvement - look up the SR index initially and cache it, use the
- *        cached value for all remaining reports.
+ *  NOTE: Unlike sr_populate_unfiltered_status_report(), this function does NOT set
+ *  the SR index. In current use this doesn't matter, but if the caller assumes its
+ *  set it may lead to a side-effect (bug)
  */
 static uint8_t _populate_filtered_status_report()
 {
     const char sr_str[] = "sr";
     bool has_data = false;
-    char tmp[TOKEN_LEN+1];
     float current_value;
     nvObj_t *nv = nv_reset_nv_list();           // sets nv to the start of the body
-    
-    // Set thresholds to detect value changes based on precision for the value. 
-    // Allow for floating point roundoffs, i.e. precision = 2 is 0.01 becomes --> 0.009
-    float precision[8] = { 0.9, 0.09, 0.009, 0.0009, 0.00009, 0.000009, 0.0000009, 0.00000009 };
 
     nv->valuetype = TYPE_PARENT;                // setup the parent object (no need to length check the copy)
     strcpy(nv->token, sr_str);
-//    nv->index = nv_get_index((const char *)"", sr_str);// OMITTED - set the index - may be needed by calling function
     nv = nv->nx;                                // no need to check for NULL as list has just been reset
 
-    for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
-        if ((nv->index = sr.status_report_list[i]) == 0) {  // end of list
-            break;
+    mp_hold_runtime_snapshot();
+    for (uint8_t i=0; i<sr.status_report_count; i++) {
+        if (sr.constrained && sr.status_report_is_deferred[i]) {
+            continue;                           // not even fetched - reported once there is headroom
         }
+        nv->index = sr.status_report_list[i];
         nv_get_nvObj(nv);
 
         // extract the value and cast into a float, regardless of value type 
-        if ((valueType)(cfgArray[nv->index].flags & F_TYPE_MASK) == TYPE_FLOAT) {
-            current_value = nv->value_flt;
-        } else {
-            current_value = (float)nv->value_int;
-        }
+        current_value = (sr.status_report_is_float[i]) ? nv->value_flt : (float)nv->value_int;
 
         // report values that have changed by more than the indicated precision, but always stops and ends
-        if ((fabs(current_value - sr.status_report_value[i]) > precision[cfgArray[nv->index].precision]) ||
-//            ((nv->index == sr.stat_index) && fp_EQ(nv->value_int, COMBINED_PROGRAM_STOP)) ||
-//            ((nv->index == sr.stat_index) && fp_EQ(nv->value_int, COMBINED_PROGRAM_END))) {
+        if ((fabs(current_value - sr.status_report_value[i]) > sr.status_report_threshold[i]) ||
             ((nv->index == sr.stat_index) && (nv->value_int == COMBINED_PROGRAM_STOP)) ||
             ((nv->index == sr.stat_index) && (nv->value_int == COMBINED_PROGRAM_END))) {
 
-            strcpy(tmp, nv->group);            // flatten out groups - WARNING - you cannot use strncpy here...
-            strcat(tmp, nv->token);
-            strcpy(nv->token, tmp);            //...or here.
+            strcpy(nv->token, cfgArray[nv->index].token);   // flatten out groups - table tokens carry the group prefix
             sr.status_report_value[i] = current_value;
             if ((nv = nv->nx) == NULL) {        // should never be NULL unless SR length exceeds available buffer array
+                mp_release_runtime_snapshot();
                 return (false); 
             }
             has_data = true;
         } else {
-            nv->valuetype = TYPE_EMPTY;         // filter this value out of the report
+            nv->valuetype = TYPE_EMPTY;         // filter this value out - the nvObj is reused for the next element
         }
     }
+    mp_release_runtime_snapshot();
     return (has_data);
 }
 
@@ -443,6 +570,10 @@ static uint8_t _populate_filtered_status_report()
  * sr_set_sv() - set status report verbosity
  * sr_get_si() - get status report interval
  * sr_set_si() - set status report interval
+ * sr_get_sa() - get adaptive status reports enable
+ * sr_set_sa() - set adaptive status reports enable
+ * sr_get_sbi() - get binary status report interval
+ * sr_set_sbi() - set binary status report interval. 0 turns binary reports off
  */
 
 stat_t sr_get(nvObj_t *nv) { return (_populate_unfiltered_status_report()); }
@@ -452,6 +583,20 @@ stat_t sr_get_sv(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)sr.status_repo
 stat_t sr_set_sv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)sr.status_report_verbosity, SR_OFF, SR_VERBOSE)); }
 stat_t sr_get_si(nvObj_t *nv) { return(get_integer(nv, sr.status_report_interval)); }
 stat_t sr_set_si(nvObj_t *nv) { return(set_int32(nv, sr.status_report_interval, STATUS_REPORT_MIN_MS, STATUS_REPORT_MAX_MS)); }
+stat_t sr_get_sa(nvObj_t *nv) { return(get_integer(nv, sr.status_report_adaptive)); }
+stat_t sr_set_sa(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)sr.status_report_adaptive, 0, 1)); }
+stat_t sr_get_sbi(nvObj_t *nv) { return(get_integer(nv, sr.binary_interval)); }
+
+stat_t sr_set_sbi(nvObj_t *nv)
+{
+    if (nv->value_int == 0) {
+        sr.binary_interval = 0;
+        return (STAT_OK);
+    }
+    ritorno(set_int32(nv, sr.binary_interval, SR_BINARY_MIN_MS, STATUS_REPORT_MAX_MS));
+    sr.binary_systick = SysTickTimer_getValue();
+    return (STAT_OK);
+}
 
 /*********************
  * TEXT MODE SUPPORT *
@@ -460,10 +605,14 @@ stat_t sr_set_si(nvObj_t *nv) { return(set_int32(nv, sr.status_report_interval,
 
 static const char fmt_sv[] = "[sv]  status report verbosity%6d [0=off,1=filtered,2=verbose]\n";
 static const char fmt_si[] = "[si]  status interval%14d ms\n";
+static const char fmt_sa[] = "[sa]  adaptive status reports%6d [0=off,1=on]\n";
+static const char fmt_sbi[] = "[sbi] binary status interval%7d ms [0=off]\n";
 
 void sr_print_sr(nvObj_t *nv) { _populate_unfiltered_status_report();}
 void sr_print_sv(nvObj_t *nv) { text_print(nv, fmt_sv);}
 void sr_print_si(nvObj_t *nv) { text_print(nv, fmt_si);}
+void sr_print_sa(nvObj_t *nv) { text_print(nv, fmt_sa);}
+void sr_print_sbi(nvObj_t *nv) { text_print(nv, fmt_sbi);}
 
 #endif // __TEXT_MODE
 
@@ -476,7 +625,17 @@ void sr_print_si(nvObj_t *nv) { text_print(nv, fmt_si);}
  *    - qi    buffers added to planner queue since las report
  *    - qo    buffers removed from planner queue since last report
  *
- *  A QR_SINGLE report returns qr only. A QR_TRIPLE returns all 3 values
+ *  A QR_SINGLE report returns qr only. A QR_TRIPLE returns all 3 values. A QR_METRICS
+ *  report adds queue time and activity since the last report, for telling a starving
+ *  host from a busy planner:
+ *    - qt    planned time in the queue (ms)
+ *    - qtr   run time remaining (ms)
+ *    - qmn   fewest buffers queued
+ *    - qmx   most buffers queued
+ *    - qst   times the planner gave up waiting for the next block (block timeouts)
+ *    - qbp   blocks back-planned
+ *
+ *  The counters are kept by the planner (see mpQueueStats_t) at O(1) cost per block.
  *
  *  There are 2 ways to get queue reports:
  *
@@ -529,7 +688,47 @@ void qr_request_queue_report(int8_t buffers)
     // either return or request a report
     if (qr.queue_report_verbosity != QR_OFF) {
         qr.queue_report_requested = true;
+        controller_wake_task(CONTROLLER_TASK_QUEUE_REPORT);
+    }
+}
+
+/*
+ * _credit_report() - grant the host the RX bytes freed since the last grant
+ *
+ *  Streaming on acks costs a round trip per line, and streaming on queue reports can
+ *  overfill the RX ring and stall the USB endpoint. With {crm:1} the host streams on
+ *  credits instead:
+ *
+ *    - Setting {crm:1} makes the first grant: the free RX bytes on the data channel, less
+ *      XIO_CREDIT_RESERVE. The host waits for it, then counts every byte it sends, line
+ *      endings included, against its credit.
+ *    - As lines are read out of the RX ring the freed bytes come back as grants of the
+ *      form {"cr":n,"qr":m} (cr:n, qr:m in text mode). n adds to the host's credit. m is
+ *      the planner buffers available, for hosts that also pace on planner depth.
+ *    - Control lines (!~% and JSON) may be sent with no credit left. They come out of the
+ *      reserve, and are granted back like any other line once read.
+ *
+ *  Grants are sent at most every CONTROLLER_REPORT_MS, so a burst of short lines is
+ *  granted in one message. Lines wait in the RX ring while the planner is full, so no
+ *  credit comes back for them until there is room to plan them.
+ */
+
+static void _credit_report()
+{
+    qr.credits += xio_take_credits();
+    if (qr.credits == 0) {
+        return;
+    }
+    char report[40];
+    if (cs.comm_mode == TEXT_MODE) {
+        sprintf(report, "cr:%lu, qr:%d\n", (unsigned long)qr.credits, mp_get_planner_buffers(mp));
+    } else {
+        sprintf(report, "{\"cr\":%lu,\"qr\":%d}\n", (unsigned long)qr.credits, mp_get_planner_buffers(mp));
     }
+    xioLane lane = xio_set_lane(XIO_LANE_ACK);
+    xio_writeline(report);
+    xio_set_lane(lane);
+    qr.credits = 0;
 }
 
 /*
@@ -538,6 +737,9 @@ void qr_request_queue_report(int8_t buffers)
 
 stat_t qr_queue_report_callback()         // called by controller dispatcher
 {
+    if (qr.credit_mode) {
+        _credit_report();                   // not held off like queue reports - the host is waiting on it
+    }
     if ((qr.queue_report_verbosity == QR_OFF) ||
         (js.json_verbosity == JV_SILENT) ||
         (qr.queue_report_requested == false) ||
@@ -547,23 +749,39 @@ stat_t qr_queue_report_callback()         // called by controller dispatcher
 
     qr.queue_report_requested = false;
 
-    char report[32];    // we know these reports can't be longer than 30 bytes
+    char report[128];   // a metrics report is at most about 110 bytes
+    const mpQueueStats_t *qs = &mp->stats;
 
     if (cs.comm_mode == TEXT_MODE) {
         if (qr.queue_report_verbosity == QR_SINGLE) {
             sprintf(report, "qr:%d\n", qr.buffers_available);
+        } else if (qr.queue_report_verbosity == QR_METRICS) {
+            sprintf(report, "qr:%d, qi:%d, qo:%d, qt:%d, qtr:%d, qmn:%d, qmx:%d, qst:%lu, qbp:%lu\n",
+                    qr.buffers_available, qr.buffers_added, qr.buffers_removed,
+                    (int)(mp->plannable_time * 60000), (int)(mp->run_time_remaining * 60000),
+                    qs->depth_min, qs->depth_max, (unsigned long)qs->starved, (unsigned long)qs->backplans);
         } else  {
             sprintf(report, "qr:%d, qi:%d, qo:%d\n", qr.buffers_available,qr.buffers_added,qr.buffers_removed);
         }
     } else {
         if (qr.queue_report_verbosity == QR_SINGLE) {
             sprintf(report, "{\"qr\":%d}\n", qr.buffers_available);
+        } else if (qr.queue_report_verbosity == QR_METRICS) {
+            sprintf(report, "{\"qr\":%d,\"qi\":%d,\"qo\":%d,\"qt\":%d,\"qtr\":%d,\"qmn\":%d,\"qmx\":%d,\"qst\":%lu,\"qbp\":%lu}\n",
+                    qr.buffers_available, qr.buffers_added, qr.buffers_removed,
+                    (int)(mp->plannable_time * 60000), (int)(mp->run_time_remaining * 60000),
+                    qs->depth_min, qs->depth_max, (unsigned long)qs->starved, (unsigned long)qs->backplans);
         } else {
             sprintf(report, "{\"qr\":%d,\"qi\":%d,\"qo\":%d}\n", qr.buffers_available, qr.buffers_added,qr.buffers_removed);
         }
     }
+    xioLane lane = xio_set_lane(XIO_LANE_REPORT);
     xio_writeline(report);
+    xio_set_lane(lane);
     qr_init_queue_report();
+    if (qr.queue_report_verbosity == QR_METRICS) {
+        mp_clear_queue_stats(mp);
+    }
     return (STAT_OK);
 }
 
@@ -613,8 +831,68 @@ stat_t qo_get(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/*
+ * qt_get()  - planned time in the queue (ms)
+ * qtr_get() - run time remaining (ms)
+ * qmn_get() - fewest buffers queued in the current metrics window
+ * qmx_get() - most buffers queued in the current metrics window
+ * qst_get() - block timeouts in the current metrics window
+ * qbp_get() - blocks back-planned in the current metrics window
+ *
+ *  These read without clearing - the window restarts with each QR_METRICS report.
+ */
+stat_t qt_get(nvObj_t *nv)
+{
+    nv->value_int = (int32_t)(mp->plannable_time * 60000);
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qtr_get(nvObj_t *nv)
+{
+    nv->value_int = (int32_t)(mp->run_time_remaining * 60000);
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qmn_get(nvObj_t *nv)
+{
+    nv->value_int = mp->stats.depth_min;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qmx_get(nvObj_t *nv)
+{
+    nv->value_int = mp->stats.depth_max;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qst_get(nvObj_t *nv)
+{
+    nv->value_int = mp->stats.starved;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qbp_get(nvObj_t *nv)
+{
+    nv->value_int = mp->stats.backplans;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
 stat_t qr_get_qv(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)qr.queue_report_verbosity)); }
-stat_t qr_set_qv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)qr.queue_report_verbosity, QR_OFF, QR_TRIPLE)); }
+stat_t qr_set_qv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)qr.queue_report_verbosity, QR_OFF, QR_METRICS)); }
+stat_t qr_get_crm(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)qr.credit_mode)); }
+
+stat_t qr_set_crm(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, (uint8_t &)qr.credit_mode, 0, 1));
+    qr.credits = (qr.credit_mode ? xio_credit_window() : 0);   // each {crm:1} starts over with a fresh grant
+    return (STAT_OK);
+}
 
 /*****************************************************************************
  * JOB ID REPORTS
@@ -687,6 +965,109 @@ stat_t job_get(nvObj_t *nv) { return (job_populate_job_report());}
 stat_t job_set(nvObj_t *nv) { return (job_set_job_report(nv));}
 void job_print_job(nvObj_t *nv) { job_populate_job_report();}
 
+/*****************************************************************************
+ * JOB PROGRESS REPORTS
+ *
+ *  {jr:n} returns the progress of the job in one read:
+ *    - jrln  Gcode lines processed
+ *    - jrbk  blocks queued
+ *    - jrbr  blocks queued per second
+ *    - jrfc  average commanded feed (mm/min) - at the blocks' requested velocities
+ *    - jrfa  average actual feed (mm/min) - as planned, with ramps and overrides
+ *    - jrst  time in a machining cycle with nothing left to run - planner starvation (s)
+ *    - jrhd  time in feedhold (s)
+ *    - jrel  time since the report was started (s)
+ *    - jrtr  time remaining (s)
+ *
+ *  The report starts with {jr:t} and when a stored job starts running. Lines and blocks
+ *  are counted as they are parsed and queued, feeds from the totals the planner keeps as
+ *  it frees blocks (mpRunCounters_t), so each value is a difference from its count at the
+ *  start. Starved and held time are sampled by jr_job_report_callback().
+ *
+ *  The time remaining is the time queued in the planner. While a stored job runs it adds
+ *  the job's unread bytes at the run time per byte of the part already read.
+ */
+
+static struct jrJobReport {
+    uint32_t start_tick;            // systick the report started
+    uint32_t sample_tick;           // systick of the last sample
+    uint32_t lines;                 // free running count of parsed lines
+    uint32_t starved_ms;
+    uint32_t held_ms;
+    uint32_t start_lines;           // counts at the start
+    mpRunCounters_t start;
+} jr;
+
+void jr_count_line() { jr.lines++; }
+
+void jr_reset_job_report()
+{
+    jr.start_tick = SysTickTimer_getValue();
+    jr.sample_tick = jr.start_tick;
+    jr.starved_ms = 0;
+    jr.held_ms = 0;
+    jr.start_lines = jr.lines;
+    jr.start = mp->run;
+}
+
+stat_t jr_job_report_callback()
+{
+    uint32_t now = SysTickTimer_getValue();
+    uint32_t elapsed = now - jr.sample_tick;
+    jr.sample_tick = now;
+
+    if (cm1.hold_state != FEEDHOLD_OFF) {
+        jr.held_ms += elapsed;
+    } else if ((cm1.machine_state == MACHINE_CYCLE) && (cm1.cycle_type == CYCLE_MACHINING) && !mp_get_runtime_busy()) {
+        jr.starved_ms += elapsed;
+    }
+    return (STAT_OK);
+}
+
+static float _jr_time_remaining(const float elapsed_run)    // seconds
+{
+    float remaining = mp->run_time_remaining * 60;
+    uint32_t run, left;
+    job_progress(&run, &left);
+    if ((run > 0) && (left > 0)) {
+        remaining += left * ((elapsed_run + remaining) / run);
+    }
+    return (remaining);
+}
+
+stat_t jr_get_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    float seconds = (SysTickTimer_getValue() - jr.start_tick) / 1000.0;
+    float length = mp->run.length - jr.start.length;
+    float commanded_time = mp->run.commanded_time - jr.start.commanded_time;
+    float run_time = mp->run.run_time - jr.start.run_time;
+    uint32_t blocks = mp->run.blocks_in - jr.start.blocks_in;
+
+    switch (token[2]) {
+        case 'l': { return (get_integer(nv, jr.lines - jr.start_lines)); }
+        case 'b': {
+            if (token[3] == 'k') { return (get_integer(nv, blocks)); }
+            return (get_float(nv, (seconds > 0) ? blocks / seconds : 0));
+        }
+        case 'f': {
+            float time = (token[3] == 'c') ? commanded_time : run_time;
+            return (get_float(nv, (time > 0) ? length / time : 0));
+        }
+        case 's': { return (get_float(nv, jr.starved_ms / 1000.0)); }
+        case 'h': { return (get_float(nv, jr.held_ms / 1000.0)); }
+        case 'e': { return (get_float(nv, seconds)); }
+        case 't': { return (get_float(nv, _jr_time_remaining(run_time * 60))); }
+        default:  { return (STAT_INTERNAL_ERROR); }
+    }
+}
+
+stat_t jr_set_jr(nvObj_t *nv)
+{
+    jr_reset_job_report();
+    return (STAT_OK);
+}
+
 /*********************
  * TEXT MODE SUPPORT *
  *********************/
@@ -695,11 +1076,49 @@ void job_print_job(nvObj_t *nv) { job_populate_job_report();}
 static const char fmt_qr[] = "qr:%d\n";
 static const char fmt_qi[] = "qi:%d\n";
 static const char fmt_qo[] = "qo:%d\n";
-static const char fmt_qv[] = "[qv]  queue report verbosity%7d [0=off,1=single,2=triple]\n";
+static const char fmt_qt[] = "qt:%d\n";
+static const char fmt_qtr[] = "qtr:%d\n";
+static const char fmt_qmn[] = "qmn:%d\n";
+static const char fmt_qmx[] = "qmx:%d\n";
+static const char fmt_qst[] = "qst:%d\n";
+static const char fmt_qbp[] = "qbp:%d\n";
+static const char fmt_qv[] = "[qv]  queue report verbosity%7d [0=off,1=single,2=triple,3=metrics]\n";
+static const char fmt_crm[] = "[crm] credit flow control%10d [0=off,1=on]\n";
 
 void qr_print_qr(nvObj_t *nv) { text_print(nv, fmt_qr);}    // TYPE_INT
 void qr_print_qi(nvObj_t *nv) { text_print(nv, fmt_qi);}    // TYPE_INT
 void qr_print_qo(nvObj_t *nv) { text_print(nv, fmt_qo);}    // TYPE_INT
+void qr_print_qt(nvObj_t *nv) { text_print(nv, fmt_qt);}    // TYPE_INT
+void qr_print_qtr(nvObj_t *nv) { text_print(nv, fmt_qtr);}  // TYPE_INT
+void qr_print_qmn(nvObj_t *nv) { text_print(nv, fmt_qmn);}  // TYPE_INT
+void qr_print_qmx(nvObj_t *nv) { text_print(nv, fmt_qmx);}  // TYPE_INT
+void qr_print_qst(nvObj_t *nv) { text_print(nv, fmt_qst);}  // TYPE_INT
+void qr_print_qbp(nvObj_t *nv) { text_print(nv, fmt_qbp);}  // TYPE_INT
 void qr_print_qv(nvObj_t *nv) { text_print(nv, fmt_qv);}    // TYPE_INT
+void qr_print_crm(nvObj_t *nv) { text_print(nv, fmt_crm);}  // TYPE_INT
+
+static const char fmt_jrln[] = "[jrln] lines processed%17d\n";
+static const char fmt_jrbk[] = "[jrbk] blocks queued%19d\n";
+static const char fmt_jrbr[] = "[jrbr] blocks per second%17.1f\n";
+static const char fmt_jrfc[] = "[jrfc] commanded feed%20.1f mm/min\n";
+static const char fmt_jrfa[] = "[jrfa] actual feed%23.1f mm/min\n";
+static const char fmt_jrst[] = "[jrst] time starved%22.1f s\n";
+static const char fmt_jrhd[] = "[jrhd] time in feedhold%18.1f s\n";
+static const char fmt_jrel[] = "[jrel] time elapsed%22.1f s\n";
+static const char fmt_jrtr[] = "[jrtr] time remaining%20.1f s\n";
+
+void jr_print_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    switch (token[2]) {
+        case 'l': { text_print(nv, fmt_jrln); break; }
+        case 'b': { text_print(nv, (token[3] == 'k') ? fmt_jrbk : fmt_jrbr); break; }
+        case 'f': { text_print(nv, (token[3] == 'c') ? fmt_jrfc : fmt_jrfa); break; }
+        case 's': { text_print(nv, fmt_jrst); break; }
+        case 'h': { text_print(nv, fmt_jrhd); break; }
+        case 'e': { text_print(nv, fmt_jrel); break; }
+        default:  { text_print(nv, fmt_jrtr); break; }
+    }
+}
 
 #endif // __TEXT_MODE
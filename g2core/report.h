@@ -35,8 +35,24 @@
                                                 // **** must also line up in cfgArray, se00 - seXX ****
 
 #define SR_THROTTLE_COUNT   4       // scale back filtered SR's during time-constrained intervals
+#define SR_ADAPTIVE_DEFERRALS 4     // most intervals an adaptive filtered SR is put off under load
 #define MIN_ARC_QR_INTERVAL 200     // minimum interval between QRs during arc generation (in system ticks)
 #define STATUS_REPORT_MAX_MS (MAX_LONG/1000)
+#define SR_BINARY_MIN_MS    10      // shortest binary status report interval
+
+/* Binary status report record - sent on SerialUSB1 as an xio binary frame every {sbi:} ms
+ *
+ *      type   uint8        SR_BINARY_RECORD
+ *      axes   uint8        AXES
+ *      stat   uint8        combined machine state, as "stat"
+ *      queue  uint8        planner buffers available, as "qr"
+ *      tick   uint32       SysTick (ms) when the record was taken
+ *      line   int32        as "line"
+ *      vel    float        as "vel"
+ *      pos    float[AXES]  work positions in display units, as "posx" ... "posc"
+ */
+#define SR_BINARY_RECORD    'S'
+#define SR_BINARY_LEN       (4 + 4 + 4 + 4 + 4*AXES)
 
 typedef enum {                      // status report enable, verbosity and request type
     SR_OFF = 0,                     // no reports
@@ -54,7 +70,8 @@ typedef enum {
 typedef enum {                      // planner queue enable and verbosity
     QR_OFF = 0,                     // no response is provided
     QR_SINGLE,                      // queue depth reported
-    QR_TRIPLE                       // queue depth reported for buffers, buffers added, buffered removed
+    QR_TRIPLE,                      // queue depth reported for buffers, buffers added, buffered removed
+    QR_METRICS                      // triple plus queue time, depth range, starved and backplan counts
 } qrVerbosity;
 
 typedef struct srSingleton {
@@ -62,15 +79,28 @@ typedef struct srSingleton {
     /*** config values (PUBLIC) ***/
     srVerbosity status_report_verbosity;
     int32_t status_report_interval;                     // in milliseconds
+    bool status_report_adaptive;                        // put off filtered SRs and their verbose fields under load
 
     /*** runtime values (PRIVATE) ***/
     srVerbosity status_report_request;                  // flag that SR has been requested, and what type
     uint32_t status_report_systick;                     // SysTick value for next status report
     index_t stat_index;                                 // table index value for stat - determined during initialization
     uint8_t throttle_counter;                           // slow down SRs when in a constrained time (not phat_city)
+    uint8_t deferrals;                                  // intervals the pending adaptive SR has been put off
+    bool constrained;                                   // the report being built is running under load
+    uint32_t tx_full_waits;                             // xio TX full waits seen at the last adaptive check
+    int32_t binary_interval;                            // binary SR interval in ms, 0 = off
+    uint32_t binary_systick;                            // SysTick value for next binary SR
+    index_t binary_index[AXES+2];                       // table indexes of line, vel and posx...posc
     index_t status_report_list[NV_STATUS_REPORT_LEN];   // status report elements to report
     float status_report_value[NV_STATUS_REPORT_LEN];    // previous values for filtered reporting
 
+    // SR plan - derived from status_report_list by _prepare_status_report()
+    uint8_t status_report_count;                        // number of elements in status_report_list
+    bool status_report_is_float[NV_STATUS_REPORT_LEN];  // true if the element value is carried in value_flt
+    float status_report_threshold[NV_STATUS_REPORT_LEN];// change threshold for filtered reporting
+    bool status_report_is_deferred[NV_STATUS_REPORT_LEN];// element is left out of filtered reports under load
+
 } srSingleton_t;
 
 typedef struct qrSingleton {        // data for queue reports
@@ -80,13 +110,16 @@ typedef struct qrSingleton {        // data for queue reports
 
     /*** runtime values (PRIVATE) ***/
     uint8_t queue_report_requested;         // set to true to request a report
-    uint8_t buffers_available;              // 存储的缓冲区深度由回调传递给
-    uint8_t prev_available;                 // buffers available at last count
+    uint16_t buffers_available;             // 存储的缓冲区深度由回调传递给
+    uint16_t prev_available;                // buffers available at last count
     uint16_t buffers_added;                 // buffers added since last count
     uint16_t buffers_removed;               // buffers removed since last report
     uint8_t motion_mode;                    // used to detect arc movement
     uint32_t init_tick;                     // time when values were last initialized or cleared
 
+    bool credit_mode;                       // {crm:} host streams on credits (see report.cpp)
+    uint32_t credits;                       // RX bytes not yet granted to the host
+
 } qrSingleton_t;
 
 /**** Externs - See report.c for allocation ****/
@@ -108,6 +141,7 @@ void sr_init_status_report(void);
 stat_t sr_set_status_report(nvObj_t *nv);
 stat_t sr_request_status_report(cmStatusReportRequest request_type);
 stat_t sr_status_report_callback(void);
+stat_t sr_binary_report_callback(void);
 stat_t sr_run_text_status_report(void);
 
 stat_t sr_get(nvObj_t *nv);
@@ -117,6 +151,10 @@ stat_t sr_get_sv(nvObj_t *nv);
 stat_t sr_set_sv(nvObj_t *nv);
 stat_t sr_get_si(nvObj_t *nv);
 stat_t sr_set_si(nvObj_t *nv);
+stat_t sr_get_sa(nvObj_t *nv);
+stat_t sr_set_sa(nvObj_t *nv);
+stat_t sr_get_sbi(nvObj_t *nv);
+stat_t sr_set_sbi(nvObj_t *nv);
 
 void qr_init_queue_report(void);
 void qr_request_queue_report(int8_t buffers);
@@ -128,29 +166,63 @@ stat_t rx_report_callback(void);
 stat_t qr_get(nvObj_t *nv);
 stat_t qi_get(nvObj_t *nv);
 stat_t qo_get(nvObj_t *nv);
+stat_t qt_get(nvObj_t *nv);
+stat_t qtr_get(nvObj_t *nv);
+stat_t qmn_get(nvObj_t *nv);
+stat_t qmx_get(nvObj_t *nv);
+stat_t qst_get(nvObj_t *nv);
+stat_t qbp_get(nvObj_t *nv);
 
 stat_t qr_get_qv(nvObj_t *nv);
 stat_t qr_set_qv(nvObj_t *nv);
+stat_t qr_get_crm(nvObj_t *nv);
+stat_t qr_set_crm(nvObj_t *nv);
+
+void jr_count_line(void);
+void jr_reset_job_report(void);
+stat_t jr_job_report_callback(void);
+stat_t jr_get_stat(nvObj_t *nv);
+stat_t jr_set_jr(nvObj_t *nv);
 
 #ifdef __TEXT_MODE
 
     void sr_print_sr(nvObj_t *nv);
     void sr_print_si(nvObj_t *nv);
+    void sr_print_sa(nvObj_t *nv);
+    void sr_print_sbi(nvObj_t *nv);
     void sr_print_sv(nvObj_t *nv);
     void qr_print_qv(nvObj_t *nv);
+    void qr_print_crm(nvObj_t *nv);
     void qr_print_qr(nvObj_t *nv);
     void qr_print_qi(nvObj_t *nv);
     void qr_print_qo(nvObj_t *nv);
+    void qr_print_qt(nvObj_t *nv);
+    void qr_print_qtr(nvObj_t *nv);
+    void qr_print_qmn(nvObj_t *nv);
+    void qr_print_qmx(nvObj_t *nv);
+    void qr_print_qst(nvObj_t *nv);
+    void qr_print_qbp(nvObj_t *nv);
+    void jr_print_stat(nvObj_t *nv);
 
 #else
 
     #define sr_print_sr tx_print_stub
     #define sr_print_si tx_print_stub
+    #define sr_print_sa tx_print_stub
+    #define sr_print_sbi tx_print_stub
     #define sr_print_sv tx_print_stub
     #define qr_print_qv tx_print_stub
+    #define qr_print_crm tx_print_stub
     #define qr_print_qr tx_print_stub
     #define qr_print_qi tx_print_stub
     #define qr_print_qo tx_print_stub
+    #define qr_print_qt tx_print_stub
+    #define qr_print_qtr tx_print_stub
+    #define qr_print_qmn tx_print_stub
+    #define qr_print_qmx tx_print_stub
+    #define qr_print_qst tx_print_stub
+    #define qr_print_qbp tx_print_stub
+    #define jr_print_stat tx_print_stub
 
 #endif // __TEXT_MODE
 
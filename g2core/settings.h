@@ -48,9 +48,12 @@
  * or if any values are missing from the SETTINGS_FILE file. 
  */
 
+// The board's build profile picks defaults ahead of the settings file (see board_profile.h)
+#include "board_profile.h"
+
 // This file sets up the compile-time defaults
 #ifdef SETTINGS_FILE
-#define SETTINGS_FILE_PATH <settings\SETTINGS_FILE>
+#define SETTINGS_FILE_PATH <settings/SETTINGS_FILE>
 #include SETTINGS_FILE_PATH
 #endif
 
@@ -66,6 +66,62 @@
 #define CHORDAL_TOLERANCE           0.01    // {ct: chordal tolerance for arcs (in mm)
 #endif
 
+#ifndef ARC_NATIVE_BLOCKS
+#define ARC_NATIVE_BLOCKS           true    // queue eligible arcs as one planner block instead of line segments
+#endif
+
+#ifndef KINEMATICS
+#define KINEMATICS                  KIN_CARTESIAN   // {kin: 0=cartesian, 1=corexy, 2=delta, 3=rtcp (see kinematics.h)
+#endif
+
+#ifndef KINEMATICS_DELTA_RADIUS
+#define KINEMATICS_DELTA_RADIUS     100.0   // {kdr: delta tower radius, center to carriage pivot (in mm)
+#endif
+
+#ifndef KINEMATICS_DELTA_ROD
+#define KINEMATICS_DELTA_ROD        250.0   // {kdl: delta diagonal rod length (in mm)
+#endif
+
+#ifndef KINEMATICS_RTCP_PIVOT
+#define KINEMATICS_RTCP_PIVOT       0.0     // {krp: RTCP pivot to tool tip length (in mm)
+#endif
+
+#ifndef MESH_ENABLE
+#define MESH_ENABLE                 0       // {mshe: apply probed Z mesh compensation 0=off, 1=on
+#endif
+
+#ifndef MESH_POINTS
+#define MESH_POINTS                 3       // {mshn: probing grid points per side (2 to MESH_POINTS_MAX)
+#endif
+
+#ifndef MESH_ORIGIN_X
+#define MESH_ORIGIN_X               0.0     // {mshx: machine X of the first grid point (in mm)
+#endif
+
+#ifndef MESH_ORIGIN_Y
+#define MESH_ORIGIN_Y               0.0     // {mshy: machine Y of the first grid point (in mm)
+#endif
+
+#ifndef MESH_SIZE_X
+#define MESH_SIZE_X                 100.0   // {mshi: grid extent in X (in mm)
+#endif
+
+#ifndef MESH_SIZE_Y
+#define MESH_SIZE_Y                 100.0   // {mshj: grid extent in Y (in mm)
+#endif
+
+#ifndef MESH_PROBE_Z
+#define MESH_PROBE_Z                -50.0   // {mshz: machine Z the grid probes toward (in mm)
+#endif
+
+#ifndef MESH_CLEARANCE_Z
+#define MESH_CLEARANCE_Z            -5.0    // {mshc: machine Z for moves between grid points (in mm)
+#endif
+
+#ifndef PLANNER_QUEUE_SIZE
+#define PLANNER_QUEUE_SIZE          48      // planner buffers - must fit PLANNER_QUEUE_MEMORY_MAX (see planner.h)
+#endif
+
 #ifndef MOTOR_POWER_TIMEOUT
 #define MOTOR_POWER_TIMEOUT         2.00    // {mt:  motor power timeout in seconds
 #endif
@@ -101,6 +157,30 @@
 #define SPINDLE_SPINUP_DELAY        0     // {spde:
 #endif
 
+#ifndef SPINDLE_DYNAMIC_POWER
+#define SPINDLE_DYNAMIC_POWER       false   // {spdy: scale laser power with velocity
+#endif
+
+#ifndef SPINDLE_AT_SPEED_INPUT
+#define SPINDLE_AT_SPEED_INPUT      0       // {spas: input that ends the spinup delay, 0=none
+#endif
+
+#ifndef SPINDLE_ENCODER_INPUT_A
+#define SPINDLE_ENCODER_INPUT_A     0       // {spea: spindle encoder channel A input, 0=none (no G33/G33.1)
+#endif
+
+#ifndef SPINDLE_ENCODER_INPUT_B
+#define SPINDLE_ENCODER_INPUT_B     0       // {speb: channel B input, 0=count in the commanded direction
+#endif
+
+#ifndef SPINDLE_ENCODER_PPR
+#define SPINDLE_ENCODER_PPR         1       // {sppr: channel A pulses per spindle revolution
+#endif
+
+#ifndef SPINDLE_SYNC_ACCEL
+#define SPINDLE_SYNC_ACCEL          1000    // {spsa: axis acceleration following the spindle, mm/s^2
+#endif
+
 #ifndef SPINDLE_DWELL_MAX
 #define SPINDLE_DWELL_MAX   10000000.0      // maximum allowable dwell time. May be overridden in settings files
 #endif
@@ -125,10 +205,71 @@
 #define COOLANT_PAUSE_ON_HOLD       true    // {coph:
 #endif
 
+// *** Multi-board sync settings (see sync.h) *** //
+
+#ifndef SYNC_MODE
+#define SYNC_MODE                   0       // {symo: 0=off, 1=leader, 2=follower
+#endif
+#ifndef SYNC_TICK_INPUT
+#define SYNC_TICK_INPUT             0       // {syti: input from the leader's tick line, 0=none
+#endif
+#ifndef SYNC_TICK_OUTPUT
+#define SYNC_TICK_OUTPUT            0       // {syto: output driving the tick line, 0=none
+#endif
+#ifndef SYNC_HOLD_INPUT
+#define SYNC_HOLD_INPUT             0       // {syhi: input from the other board's hold line, 0=none
+#endif
+#ifndef SYNC_HOLD_OUTPUT
+#define SYNC_HOLD_OUTPUT            0       // {syho: output driving this board's hold line, 0=none
+#endif
+#ifndef SYNC_ALARM_INPUT
+#define SYNC_ALARM_INPUT            0       // {syai: input from the other board's alarm line, 0=none
+#endif
+#ifndef SYNC_ALARM_OUTPUT
+#define SYNC_ALARM_OUTPUT           0       // {syao: output driving this board's alarm line, 0=none
+#endif
+
+// *** Torch height control settings (see thc.h) *** //
+
+#ifndef THC_ENABLE
+#define THC_ENABLE                  false   // {thce: hold the arc voltage by trimming Z
+#endif
+#ifndef THC_TARGET_VOLTS
+#define THC_TARGET_VOLTS            120.0   // {thcv: arc voltage to hold
+#endif
+#ifndef THC_VOLTS_FULL_SCALE
+#define THC_VOLTS_FULL_SCALE        250.0   // {thcs: arc voltage at ADC full scale (voltage divider ratio x ADC reference)
+#endif
+#ifndef THC_P_FACTOR
+#define THC_P_FACTOR                0.02    // {thcp: mm of correction per volt of error
+#endif
+#ifndef THC_I_FACTOR
+#define THC_I_FACTOR                0.05    // {thci: mm per volt-second of error
+#endif
+#ifndef THC_D_FACTOR
+#define THC_D_FACTOR                0.0     // {thcd: mm-seconds per volt
+#endif
+#ifndef THC_MAX_CORRECTION
+#define THC_MAX_CORRECTION          5.0     // {thcm: largest Z correction either way, mm
+#endif
+#ifndef THC_MAX_RATE
+#define THC_MAX_RATE                600.0   // {thcr: fastest the correction may change, mm/min
+#endif
+#ifndef THC_ANTI_DIVE
+#define THC_ANTI_DIVE               0.9     // {thca: hold the correction below this fraction of cruise velocity
+#endif
+#ifndef THC_ARC_DELAY
+#define THC_ARC_DELAY               0.5     // {thcw: seconds after torch on before correcting
+#endif
+
 #ifndef FEEDHOLD_Z_LIFT
 #define FEEDHOLD_Z_LIFT             0       // {zl: mm to lift Z on feedhold
 #endif
 
+#ifndef TRAVERSE_UNCOORDINATED
+#define TRAVERSE_UNCOORDINATED      false   // {tru: run G0 axes at their own velocity limits instead of along a straight line
+#endif
+
 #ifndef PROBE_REPORT_ENABLE 
 #define PROBE_REPORT_ENABLE         true    // {prbr: 
 #endif
@@ -147,6 +288,50 @@
 #define USB_SERIAL_PORTS_EXPOSED   1                        // Valid options are 1 or 2, only!
 #endif
 
+#ifndef USB_VENDOR_BULK_EXPOSED
+#define USB_VENDOR_BULK_EXPOSED    0                        // 1 = add a WinUSB/libusb bulk interface for binary frames (see xio.h)
+#endif
+
+#ifndef XIO_BINARY_CHANNEL_ENABLED
+#define XIO_BINARY_CHANNEL_ENABLED false                    // accept framed binary moves alongside JSON/text (see xio.h)
+#endif
+
+#ifndef TEMPERATURE_ENABLED
+#define TEMPERATURE_ENABLED true                            // heater, fan and PID control (see temperature.h)
+#endif
+
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED false                               // measure interrupt cycle budgets and report in {prof:n} (see profile.h)
+#endif
+
+#ifndef ENCODER_LOG_ENABLED
+#define ENCODER_LOG_ENABLED false                           // log commanded vs. encoder steps per segment, streamed by {enlst:1} (see encoder.h)
+#endif
+
+#ifndef ENCODER_MEASURE_ENABLED
+#define ENCODER_MEASURE_ENABLED true                        // measure actual velocity and acceleration from the encoders, {velm:} and {vm:} (see encoder.h)
+#endif
+
+#ifndef MOTION_TRACE_ENABLED
+#define MOTION_TRACE_ENABLED false                          // write a per-segment motion trace file from the simulator (see motion_trace.h)
+#endif
+
+#ifndef PLANNER_COALESCE_ENABLED
+#define PLANNER_COALESCE_ENABLED false                      // merge nearly collinear feed moves into one planner block (see planner.h)
+#endif
+
+#ifndef PLANNER_HORIZON_ENABLED
+#define PLANNER_HORIZON_ENABLED false                       // stop taking moves once the queue holds enough time and braking distance (see planner.h)
+#endif
+
+#ifndef SEGMENT_TIME_ADAPTIVE
+#define SEGMENT_TIME_ADAPTIVE false                         // size segments from measured exec headroom (requires PROFILE_ENABLED)
+#endif
+
+#ifndef EXEC_SEGMENT_TABLE
+#define EXEC_SEGMENT_TABLE false                            // work out the next block's segments in the main loop (see plan_exec.cpp)
+#endif
+
 #ifndef XIO_ENABLE_FLOW_CONTROL
 #define XIO_ENABLE_FLOW_CONTROL     FLOW_CONTROL_RTS        // {ex: FLOW_CONTROL_OFF, FLOW_CONTROL_XON, FLOW_CONTROL_RTS
 #endif
@@ -168,7 +353,7 @@
 #endif
 
 #ifndef QUEUE_REPORT_VERBOSITY
-#define QUEUE_REPORT_VERBOSITY      QR_OFF                  // {qv: QR_OFF, QR_SINGLE, QR_TRIPLE
+#define QUEUE_REPORT_VERBOSITY      QR_OFF                  // {qv: QR_OFF, QR_SINGLE, QR_TRIPLE, QR_METRICS
 #endif
 
 #ifndef STATUS_REPORT_VERBOSITY
@@ -183,8 +368,20 @@
 #define STATUS_REPORT_INTERVAL_MS   250                     // {si: milliseconds - set $SV=0 to disable
 #endif
 
+#ifndef STATUS_REPORT_ADAPTIVE
+#define STATUS_REPORT_ADAPTIVE      false                   // {sa: put off filtered SRs while the planner or TX is short of time
+#endif
+
+#ifndef STATUS_REPORT_BINARY_MS
+#define STATUS_REPORT_BINARY_MS     0                       // {sbi: binary SRs on SerialUSB1 every N ms - 0 = off
+#endif
+
 #ifndef STATUS_REPORT_DEFAULTS                              // {sr: See Status Reports wiki page
+#if (AXES == 3)                                             // no A axis to report
+#define STATUS_REPORT_DEFAULTS "line","posx","posy","posz","feed","vel","unit","coor","dist","admo","frmo","momo","stat"
+#else
 #define STATUS_REPORT_DEFAULTS "line","posx","posy","posz","posa","feed","vel","unit","coor","dist","admo","frmo","momo","stat"
+#endif
 // Alternate SRs that report in drawable units
 //#define STATUS_REPORT_DEFAULTS "line","vel","mpox","mpoy","mpoz","mpoa","coor","ofsa","ofsx","ofsy","ofsz","dist","unit","stat","homz","homy","homx","momo"
 #endif
@@ -233,6 +430,9 @@
 #ifndef M1_MICROSTEPS
 #define M1_MICROSTEPS               8                       // {1mi:  1,2,4,8,    16,32 (G2 ONLY)
 #endif
+#ifndef M1_COARSE_MICROSTEPS
+#define M1_COARSE_MICROSTEPS        0                       // {1mc:  0=off, microsteps at speed with DDA_MICROSTEP_SWITCH
+#endif
 #ifndef M1_STEPS_PER_UNIT
 #define M1_STEPS_PER_UNIT           0                       // {1su:  steps to issue per unit of length or degrees of rotation
 #endif
@@ -245,12 +445,21 @@
 #ifndef M1_STEP_POLARITY
 #define M1_STEP_POLARITY            IO_ACTIVE_HIGH          // {1ps:  IO_ACTIVE_LOW or IO_ACTIVE_HIGH
 #endif
+#ifndef M1_STEP_DRIVER
+#define M1_STEP_DRIVER             STEP_DRIVER_DRV8818     // {none: step pulse and direction setup timing, see step_dir_driver.h
+#endif
 #ifndef M1_POWER_MODE
 #define M1_POWER_MODE               MOTOR_DISABLED          // {1pm:  MOTOR_DISABLED, MOTOR_ALWAYS_POWERED, MOTOR_POWERED_IN_CYCLE, MOTOR_POWERED_ONLY_WHEN_MOVING
 #endif
 #ifndef M1_POWER_LEVEL
 #define M1_POWER_LEVEL              0.0                     // {1pl:   0.0=no power, 1.0=max power
 #endif
+#ifndef M1_BACKLASH
+#define M1_BACKLASH                 0.0                     // {1bl:   mm or degrees of lost motion on reversal, 0 = off
+#endif
+#ifndef M1_STALL_ACTION
+#define M1_STALL_ACTION             STALL_IGNORE            // {1sg:   0=ignore, 1=feedhold, 2=alarm on a smart driver stall
+#endif
 
 // MOTOR 2
 #ifndef M2_MOTOR_MAP
@@ -265,6 +474,9 @@
 #ifndef M2_MICROSTEPS
 #define M2_MICROSTEPS               8
 #endif
+#ifndef M2_COARSE_MICROSTEPS
+#define M2_COARSE_MICROSTEPS        0
+#endif
 #ifndef M2_STEPS_PER_UNIT
 #define M2_STEPS_PER_UNIT           0
 #endif
@@ -277,12 +489,21 @@
 #ifndef M2_STEP_POLARITY
 #define M2_STEP_POLARITY            IO_ACTIVE_HIGH
 #endif
+#ifndef M2_STEP_DRIVER
+#define M2_STEP_DRIVER             STEP_DRIVER_DRV8818
+#endif
 #ifndef M2_POWER_MODE
 #define M2_POWER_MODE               MOTOR_DISABLED
 #endif
 #ifndef M2_POWER_LEVEL
 #define M2_POWER_LEVEL              0.0
 #endif
+#ifndef M2_BACKLASH
+#define M2_BACKLASH                 0.0
+#endif
+#ifndef M2_STALL_ACTION
+#define M2_STALL_ACTION             STALL_IGNORE
+#endif
 
 // MOTOR 3
 #ifndef M3_MOTOR_MAP
@@ -297,6 +518,9 @@
 #ifndef M3_MICROSTEPS
 #define M3_MICROSTEPS               8
 #endif
+#ifndef M3_COARSE_MICROSTEPS
+#define M3_COARSE_MICROSTEPS        0
+#endif
 #ifndef M3_STEPS_PER_UNIT
 #define M3_STEPS_PER_UNIT           0
 #endif
@@ -309,12 +533,21 @@
 #ifndef M3_STEP_POLARITY
 #define M3_STEP_POLARITY            IO_ACTIVE_HIGH
 #endif
+#ifndef M3_STEP_DRIVER
+#define M3_STEP_DRIVER             STEP_DRIVER_DRV8818
+#endif
 #ifndef M3_POWER_MODE
 #define M3_POWER_MODE               MOTOR_DISABLED
 #endif
 #ifndef M3_POWER_LEVEL
 #define M3_POWER_LEVEL              0.0
 #endif
+#ifndef M3_BACKLASH
+#define M3_BACKLASH                 0.0
+#endif
+#ifndef M3_STALL_ACTION
+#define M3_STALL_ACTION             STALL_IGNORE
+#endif
 
 // MOTOR 4
 #ifndef M4_MOTOR_MAP
@@ -329,6 +562,9 @@
 #ifndef M4_MICROSTEPS
 #define M4_MICROSTEPS               8
 #endif
+#ifndef M4_COARSE_MICROSTEPS
+#define M4_COARSE_MICROSTEPS        0
+#endif
 #ifndef M4_STEPS_PER_UNIT
 #define M4_STEPS_PER_UNIT           0
 #endif
@@ -341,12 +577,21 @@
 #ifndef M4_STEP_POLARITY
 #define M4_STEP_POLARITY            IO_ACTIVE_HIGH
 #endif
+#ifndef M4_STEP_DRIVER
+#define M4_STEP_DRIVER             STEP_DRIVER_DRV8818
+#endif
 #ifndef M4_POWER_MODE
 #define M4_POWER_MODE               MOTOR_DISABLED
 #endif
 #ifndef M4_POWER_LEVEL
 #define M4_POWER_LEVEL              0.0
 #endif
+#ifndef M4_BACKLASH
+#define M4_BACKLASH                 0.0
+#endif
+#ifndef M4_STALL_ACTION
+#define M4_STALL_ACTION             STALL_IGNORE
+#endif
 
 // MOTOR 5
 #ifndef M5_MOTOR_MAP
@@ -361,6 +606,9 @@
 #ifndef M5_MICROSTEPS
 #define M5_MICROSTEPS               8
 #endif
+#ifndef M5_COARSE_MICROSTEPS
+#define M5_COARSE_MICROSTEPS        0
+#endif
 #ifndef M5_STEPS_PER_UNIT
 #define M5_STEPS_PER_UNIT           0
 #endif
@@ -373,12 +621,21 @@
 #ifndef M5_STEP_POLARITY
 #define M5_STEP_POLARITY            IO_ACTIVE_HIGH
 #endif
+#ifndef M5_STEP_DRIVER
+#define M5_STEP_DRIVER             STEP_DRIVER_DRV8818
+#endif
 #ifndef M5_POWER_MODE
 #define M5_POWER_MODE               MOTOR_DISABLED
 #endif
 #ifndef M5_POWER_LEVEL
 #define M5_POWER_LEVEL              0.0
 #endif
+#ifndef M5_BACKLASH
+#define M5_BACKLASH                 0.0
+#endif
+#ifndef M5_STALL_ACTION
+#define M5_STALL_ACTION             STALL_IGNORE
+#endif
 
 // MOTOR 6
 #ifndef M6_MOTOR_MAP
@@ -393,6 +650,9 @@
 #ifndef M6_MICROSTEPS
 #define M6_MICROSTEPS               8
 #endif
+#ifndef M6_COARSE_MICROSTEPS
+#define M6_COARSE_MICROSTEPS        0
+#endif
 #ifndef M6_STEPS_PER_UNIT
 #define M6_STEPS_PER_UNIT           0
 #endif
@@ -405,12 +665,21 @@
 #ifndef M6_STEP_POLARITY
 #define M6_STEP_POLARITY            IO_ACTIVE_HIGH
 #endif
+#ifndef M6_STEP_DRIVER
+#define M6_STEP_DRIVER             STEP_DRIVER_DRV8818
+#endif
 #ifndef M6_POWER_MODE
 #define M6_POWER_MODE               MOTOR_DISABLED
 #endif
 #ifndef M6_POWER_LEVEL
 #define M6_POWER_LEVEL              0.0
 #endif
+#ifndef M6_BACKLASH
+#define M6_BACKLASH                 0.0
+#endif
+#ifndef M6_STALL_ACTION
+#define M6_STALL_ACTION             STALL_IGNORE
+#endif
 
 //*****************************************************************************
 //*** Axis Settings ***********************************************************
@@ -438,6 +707,9 @@
 #ifndef X_JERK_HIGH_SPEED
 #define X_JERK_HIGH_SPEED           1000.0                  // {xjh:
 #endif
+#ifndef X_ACCEL_MAX
+#define X_ACCEL_MAX                 0.0                     // {xac:  mm/s^2, 0 = limited by jerk only
+#endif
 #ifndef X_HOMING_INPUT
 #define X_HOMING_INPUT              0                       // {xhi:  input used for homing or 0 to disable
 #endif
@@ -456,6 +728,15 @@
 #ifndef X_ZERO_BACKOFF
 #define X_ZERO_BACKOFF              2.0                     // {xzb:  mm
 #endif
+#ifndef X_SHAPER_FREQUENCY
+#define X_SHAPER_FREQUENCY          40.0                    // {xsf:  ringing frequency in Hz (see shaper.h)
+#endif
+#ifndef X_SHAPER_DAMPING
+#define X_SHAPER_DAMPING            0.1                     // {xsd:  damping ratio
+#endif
+#ifndef X_SHAPER_TYPE
+#define X_SHAPER_TYPE               SHAPER_OFF              // {xst:  0=off, 1=ZV, 2=ZVD, 3=MZV
+#endif
 
 // Y AXIS
 #ifndef Y_AXIS_MODE
@@ -479,6 +760,9 @@
 #ifndef Y_JERK_HIGH_SPEED
 #define Y_JERK_HIGH_SPEED           1000.0
 #endif
+#ifndef Y_ACCEL_MAX
+#define Y_ACCEL_MAX                 0.0
+#endif
 #ifndef Y_HOMING_INPUT
 #define Y_HOMING_INPUT              0
 #endif
@@ -497,6 +781,15 @@
 #ifndef Y_ZERO_BACKOFF
 #define Y_ZERO_BACKOFF              2.0
 #endif
+#ifndef Y_SHAPER_FREQUENCY
+#define Y_SHAPER_FREQUENCY          40.0
+#endif
+#ifndef Y_SHAPER_DAMPING
+#define Y_SHAPER_DAMPING            0.1
+#endif
+#ifndef Y_SHAPER_TYPE
+#define Y_SHAPER_TYPE               SHAPER_OFF
+#endif
 
 // Z AXIS
 #ifndef Z_AXIS_MODE
@@ -520,6 +813,9 @@
 #ifndef Z_JERK_HIGH_SPEED
 #define Z_JERK_HIGH_SPEED           500.0
 #endif
+#ifndef Z_ACCEL_MAX
+#define Z_ACCEL_MAX                 0.0
+#endif
 #ifndef Z_HOMING_INPUT
 #define Z_HOMING_INPUT              0
 #endif
@@ -538,6 +834,15 @@
 #ifndef Z_ZERO_BACKOFF
 #define Z_ZERO_BACKOFF              2.0
 #endif
+#ifndef Z_SHAPER_FREQUENCY
+#define Z_SHAPER_FREQUENCY          40.0
+#endif
+#ifndef Z_SHAPER_DAMPING
+#define Z_SHAPER_DAMPING            0.1
+#endif
+#ifndef Z_SHAPER_TYPE
+#define Z_SHAPER_TYPE               SHAPER_OFF
+#endif
 
 // U AXIS
 #ifndef U_AXIS_MODE
@@ -561,6 +866,9 @@
 #ifndef U_JERK_HIGH_SPEED
 #define U_JERK_HIGH_SPEED           1000.0                  // {xjh:
 #endif
+#ifndef U_ACCEL_MAX
+#define U_ACCEL_MAX                 0.0
+#endif
 #ifndef U_HOMING_INPUT
 #define U_HOMING_INPUT              0                       // {xhi:  input used for homing or 0 to disable
 #endif
@@ -602,6 +910,9 @@
 #ifndef V_JERK_HIGH_SPEED
 #define V_JERK_HIGH_SPEED           1000.0
 #endif
+#ifndef V_ACCEL_MAX
+#define V_ACCEL_MAX                 0.0
+#endif
 #ifndef V_HOMING_INPUT
 #define V_HOMING_INPUT              0
 #endif
@@ -643,6 +954,9 @@
 #ifndef W_JERK_HIGH_SPEED
 #define W_JERK_HIGH_SPEED           500.0
 #endif
+#ifndef W_ACCEL_MAX
+#define W_ACCEL_MAX                 0.0
+#endif
 #ifndef W_HOMING_INPUT
 #define W_HOMING_INPUT              0
 #endif
@@ -719,6 +1033,9 @@
 #ifndef A_JERK_HIGH_SPEED
 #define A_JERK_HIGH_SPEED           A_JERK_MAX
 #endif
+#ifndef A_ACCEL_MAX
+#define A_ACCEL_MAX                 0.0
+#endif
 #ifndef A_HOMING_INPUT
 #define A_HOMING_INPUT              0
 #endif
@@ -763,6 +1080,9 @@
 #ifndef B_JERK_HIGH_SPEED
 #define B_JERK_HIGH_SPEED           B_JERK_MAX
 #endif
+#ifndef B_ACCEL_MAX
+#define B_ACCEL_MAX                 0.0
+#endif
 #ifndef B_HOMING_INPUT
 #define B_HOMING_INPUT              0
 #endif
@@ -807,6 +1127,9 @@
 #ifndef C_JERK_HIGH_SPEED
 #define C_JERK_HIGH_SPEED           C_JERK_MAX
 #endif
+#ifndef C_ACCEL_MAX
+#define C_ACCEL_MAX                 0.0
+#endif
 #ifndef C_HOMING_INPUT
 #define C_HOMING_INPUT              0
 #endif
@@ -2195,6 +2518,19 @@
 #define TT32_C_OFFSET 0
 #endif
 
+// *** Stored Gcode Macros *** //
+// Lines are separated by \n, e.g. "G53 G0 Z0\nG53 G0 X10 Y10\nM0". Empty macros don't run.
+
+#ifndef MACRO_TOOL_CHANGE
+#define MACRO_TOOL_CHANGE ""                    // {mac:1} - also run at M6
+#endif
+#ifndef MACRO_TOOL_PROBE
+#define MACRO_TOOL_PROBE ""                     // {mac:2}
+#endif
+#ifndef MACRO_PARK
+#define MACRO_PARK ""                           // {mac:3}
+#endif
+
 // *** User-Defined Data Defaults *** //
 
 #ifndef USER_DATA_A0
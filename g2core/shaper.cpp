@@ -0,0 +1,311 @@
+/*
+ * shaper.cpp - input shaping of the segment target stream
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "shaper.h"
+#include "canonical_machine.h"
+#include "controller.h"
+#include "xio.h"
+#include "text_parser.h"
+#include "util.h"
+
+/**** Shaper singleton structure ****
+ *
+ *  The ring holds the unshaped target of X, Y and Z at the end of each segment, on a
+ *  clock that only runs while segments are played. Targets are linear between samples.
+ *  Each impulse keeps a cursor on the ring sample just before its delayed time, which only
+ *  ever moves forward, so a segment costs a step or two per impulse.
+ */
+
+typedef struct shAxis {
+    uint8_t type;                       // shaperType
+    float frequency;                    // Hz
+    float damping;                      // damping ratio
+    uint8_t impulses;                   // 0 if the axis is not shaped
+    float amplitude[SHAPER_IMPULSES];   // impulse weights, sum to 1
+    uint32_t delay[SHAPER_IMPULSES];    // impulse delays (usec), the first is 0
+} shAxis_t;
+
+typedef struct shSample {
+    uint32_t time;                      // shaper clock at the end of the segment (usec)
+    float position[SHAPER_AXES];        // unshaped target
+} shSample_t;
+
+struct shShaperSingleton {
+    shAxis_t axis[SHAPER_AXES];
+    uint32_t span;                      // longest shaper configured (usec), 0 if none
+
+    // exec
+    shSample_t ring[SHAPER_HISTORY];
+    uint16_t newest;                    // ring index of the latest sample
+    uint16_t samples;                   // samples in the ring
+    uint16_t cursor[SHAPER_AXES][SHAPER_IMPULSES];
+    uint32_t now;                       // shaper clock (usec)
+    uint32_t changed;                   // clock when a target last moved
+    bool settling;                      // shaped targets are still catching up with the targets
+};
+static struct shShaperSingleton sh;
+
+/****************************************************************************************
+ * shaper_reset()    - forget the history (halt, or position set from outside the runtime)
+ * shaper_settling() - true while the shaped targets are still catching up
+ */
+
+void shaper_reset()
+{
+    sh.samples = 0;
+    sh.settling = false;
+}
+
+bool shaper_settling() { return (sh.settling); }
+
+/****************************************************************************************
+ * shaper_segment() - shape a segment target (exec)
+ *
+ *  position is the target of the previous segment, target the target of this one. On
+ *  return shaped[] holds the target to run through kinematics. Returns false if that is
+ *  the target itself, which is always the case once the shaper has settled.
+ */
+
+static void _push(const float position[])
+{
+    bool moved = false;
+    if (sh.samples != 0) {
+        for (uint8_t a = 0; a < SHAPER_AXES; a++) {
+            if (position[a] != sh.ring[sh.newest].position[a]) {
+                moved = true;
+            }
+        }
+    }
+    uint16_t next = (sh.newest + 1) % SHAPER_HISTORY;
+    if (sh.samples == 0) {
+        for (uint8_t a = 0; a < SHAPER_AXES; a++) {
+            for (uint8_t k = 0; k < SHAPER_IMPULSES; k++) {
+                sh.cursor[a][k] = next;
+            }
+        }
+    } else if (sh.samples == SHAPER_HISTORY) {  // overwriting the oldest - move cursors off it
+        for (uint8_t a = 0; a < SHAPER_AXES; a++) {
+            for (uint8_t k = 0; k < SHAPER_IMPULSES; k++) {
+                if (sh.cursor[a][k] == next) {
+                    sh.cursor[a][k] = (next + 1) % SHAPER_HISTORY;
+                }
+            }
+        }
+    }
+    sh.newest = next;
+    sh.ring[next].time = sh.now;
+    memcpy(sh.ring[next].position, position, sizeof(sh.ring[next].position));
+    if (sh.samples < SHAPER_HISTORY) {
+        sh.samples++;
+    }
+    if (moved) {
+        sh.changed = sh.now;
+        sh.settling = true;
+    } else if ((sh.now - sh.changed) >= sh.span) {
+        sh.settling = false;
+    }
+}
+
+static float _sample(const uint8_t axis, const uint8_t k, const uint32_t time)
+{
+    uint16_t i = sh.cursor[axis][k];
+    while (i != sh.newest) {
+        uint16_t next = (i + 1) % SHAPER_HISTORY;
+        if ((int32_t)(time - sh.ring[next].time) < 0) {
+            break;
+        }
+        i = next;
+    }
+    sh.cursor[axis][k] = i;
+
+    const shSample_t *s0 = &sh.ring[i];
+    if ((i == sh.newest) || ((int32_t)(time - s0->time) < 0)) {     // at the newest, or older than the history
+        return (s0->position[axis]);
+    }
+    const shSample_t *s1 = &sh.ring[(i + 1) % SHAPER_HISTORY];
+    return (s0->position[axis] + (s1->position[axis] - s0->position[axis]) *
+            (float)(time - s0->time) / (float)(s1->time - s0->time));
+}
+
+bool shaper_segment(const float position[], const float target[], const float segment_time, float shaped[])
+{
+    memcpy(shaped, target, sizeof(float) * AXES);
+    if (!sh.settling) {
+        if ((sh.span == 0) || (cm->cycle_type == CYCLE_HOMING) || (cm->cycle_type == CYCLE_PROBE)) {
+            return (false);
+        }
+        sh.samples = 0;                     // start a new history at the segment start
+        _push(position);
+    }
+    sh.now += (uint32_t)(segment_time * 60000000);
+    _push(target);
+    if (!sh.settling) {
+        return (false);
+    }
+    for (uint8_t a = 0; a < SHAPER_AXES; a++) {
+        shAxis_t *s = &sh.axis[a];
+        if (s->impulses == 0) {
+            continue;
+        }
+        shaped[a] = 0;
+        for (uint8_t k = 0; k < s->impulses; k++) {
+            shaped[a] += s->amplitude[k] * _sample(a, k, sh.now - s->delay[k]);
+        }
+    }
+    return (true);
+}
+
+/****************************************************************************************
+ * _set_impulses() - work out an axis' impulses from its type, frequency and damping
+ *
+ *  Impulses are spaced on the damped ringing period, each weighted so the ringing the
+ *  ones before it started is cancelled. See Singer & Seering, "Preshaping Command Inputs
+ *  to Reduce System Vibration" for ZV and ZVD.
+ */
+
+static void _set_impulses(const uint8_t axis)
+{
+    shAxis_t *s = &sh.axis[axis];
+    float df = sqrt(1 - s->damping * s->damping);
+    float period = 1000000 / (s->frequency * df);
+    float k = exp(-s->damping * M_PI / df);
+    float time[SHAPER_IMPULSES];
+
+    s->impulses = 0;
+    switch ((s->frequency > 0) ? (shaperType)s->type : SHAPER_OFF) {    // frequency is 0 until it's been set
+        case SHAPER_ZV: {
+            s->impulses = 2;
+            s->amplitude[0] = 1;        time[0] = 0;
+            s->amplitude[1] = k;        time[1] = 0.5;
+            break;
+        }
+        case SHAPER_ZVD: {
+            s->impulses = 3;
+            s->amplitude[0] = 1;        time[0] = 0;
+            s->amplitude[1] = 2 * k;    time[1] = 0.5;
+            s->amplitude[2] = k * k;    time[2] = 1;
+            break;
+        }
+        case SHAPER_MZV: {
+            k = exp(-0.75 * s->damping * M_PI / df);
+            s->impulses = 3;
+            s->amplitude[0] = 1 - M_SQRT1_2;            time[0] = 0;
+            s->amplitude[1] = (M_SQRT2 - 1) * k;        time[1] = 0.375;
+            s->amplitude[2] = (1 - M_SQRT1_2) * k * k;  time[2] = 0.75;
+            break;
+        }
+        default: {}
+    }
+    float sum = 0;
+    for (uint8_t i = 0; i < s->impulses; i++) {
+        sum += s->amplitude[i];
+    }
+    for (uint8_t i = 0; i < s->impulses; i++) {
+        s->amplitude[i] /= sum;
+        s->delay[i] = (uint32_t)(time[i] * period);
+    }
+
+    sh.span = 0;
+    for (uint8_t a = 0; a < SHAPER_AXES; a++) {
+        if (sh.axis[a].impulses != 0) {
+            sh.span = max(sh.span, sh.axis[a].delay[sh.axis[a].impulses - 1]);
+        }
+    }
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * sh_get_st() - get shaper type
+ * sh_set_st() - set shaper type
+ * sh_get_sf() - get shaper frequency
+ * sh_set_sf() - set shaper frequency
+ * sh_get_sd() - get shaper damping ratio
+ * sh_set_sd() - set shaper damping ratio
+ */
+
+static uint8_t _axis(const nvObj_t *nv) { return (cfgArray[nv->index].token[0] - 'x'); }
+
+stat_t sh_get_st(nvObj_t *nv) { return (get_integer(nv, sh.axis[_axis(nv)].type)); }
+stat_t sh_set_st(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, sh.axis[_axis(nv)].type, SHAPER_OFF, SHAPER_MZV));
+    _set_impulses(_axis(nv));
+    return (STAT_OK);
+}
+
+stat_t sh_get_sf(nvObj_t *nv) { return (get_float(nv, sh.axis[_axis(nv)].frequency)); }
+stat_t sh_set_sf(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, sh.axis[_axis(nv)].frequency, SHAPER_FREQUENCY_MIN, SHAPER_FREQUENCY_MAX));
+    _set_impulses(_axis(nv));
+    return (STAT_OK);
+}
+
+stat_t sh_get_sd(nvObj_t *nv) { return (get_float(nv, sh.axis[_axis(nv)].damping)); }
+stat_t sh_set_sd(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, sh.axis[_axis(nv)].damping, 0, SHAPER_DAMPING_MAX));
+    _set_impulses(_axis(nv));
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_Xst[] = "[%s%s] %s shaper type%16d [0=off,1=ZV,2=ZVD,3=MZV]\n";
+static const char fmt_Xsf[] = "[%s%s] %s shaper frequency%11.1f Hz\n";
+static const char fmt_Xsd[] = "[%s%s] %s shaper damping%13.3f\n";
+
+void sh_print_st(nvObj_t *nv)
+{
+    text_sprintf(cs.out_buf, fmt_Xst, nv->group, nv->token, nv->group, nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
+void sh_print_sf(nvObj_t *nv)
+{
+    text_sprintf(cs.out_buf, fmt_Xsf, nv->group, nv->token, nv->group, nv->value_flt);
+    xio_writeline(cs.out_buf);
+}
+
+void sh_print_sd(nvObj_t *nv)
+{
+    text_sprintf(cs.out_buf, fmt_Xsd, nv->group, nv->token, nv->group, nv->value_flt);
+    xio_writeline(cs.out_buf);
+}
+
+#endif // __TEXT_MODE
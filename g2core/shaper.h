@@ -0,0 +1,99 @@
+/*
+ * shaper.h - input shaping of the segment target stream
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * INPUT SHAPING
+ *
+ *  A gantry axis with a resonance rings after every corner. The shaper replaces each
+ *  segment target on X, Y and Z with a weighted sum of the axis' recent targets, so the
+ *  motion the motors see is the commanded motion convolved with 2 or 3 impulses spaced
+ *  to cancel the ringing at the axis' resonant frequency:
+ *
+ *      type 0  off
+ *      type 1  ZV   2 impulses over half a ringing period. Shortest, least tolerant
+ *      type 2  ZVD  3 impulses over a full period. Tolerates a frequency that is off
+ *      type 3  MZV  3 impulses over 3/4 of a period. Between the two
+ *
+ *  Frequency is the measured ringing frequency in Hz, damping the damping ratio (0.1 is
+ *  typical). Set them with {xst:2}, {xsf:42}, {xsd:0.1}. Shaping adds up to one shaper
+ *  length of lag, and smooths corners by about (velocity * shaper length) / 2.
+ *
+ *  Shaping is done on the runtime's segment targets just before kinematics, so it acts
+ *  on the axes for any kinematics. The planned position (mr->position) stays unshaped,
+ *  the steps are shaped. When the motion stops the exec plays settle segments
+ *  (shaper_settling()) until the shaped target has caught up; feedholds and commands
+ *  wait for them. Homing and probing are never shaped.
+ */
+
+#ifndef SHAPER_H_ONCE
+#define SHAPER_H_ONCE
+
+#include "config.h"
+
+#define SHAPER_AXES 3                   // X, Y and Z can be shaped
+#define SHAPER_IMPULSES 3               // most impulses in a shaper (ZVD, MZV)
+#ifndef SHAPER_HISTORY
+#define SHAPER_HISTORY 160              // segment targets kept. Must cover the longest shaper in MIN_SEGMENT_MS segments
+#endif
+#define SHAPER_FREQUENCY_MIN 10.0       // Hz. a ZVD shaper at 10 Hz and 0.5 damping is 115 ms long
+#define SHAPER_FREQUENCY_MAX 200.0
+#define SHAPER_DAMPING_MAX 0.5
+
+enum shaperType {
+    SHAPER_OFF = 0,
+    SHAPER_ZV,
+    SHAPER_ZVD,
+    SHAPER_MZV
+};
+
+/**** Function Prototypes ****/
+
+void shaper_reset(void);
+bool shaper_settling(void);
+bool shaper_segment(const float position[], const float target[], const float segment_time, float shaped[]);
+
+stat_t sh_get_st(nvObj_t *nv);
+stat_t sh_set_st(nvObj_t *nv);
+stat_t sh_get_sf(nvObj_t *nv);
+stat_t sh_set_sf(nvObj_t *nv);
+stat_t sh_get_sd(nvObj_t *nv);
+stat_t sh_set_sd(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void sh_print_st(nvObj_t *nv);
+void sh_print_sf(nvObj_t *nv);
+void sh_print_sd(nvObj_t *nv);
+
+#else
+
+#define sh_print_st tx_print_stub
+#define sh_print_sf tx_print_stub
+#define sh_print_sd tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: SHAPER_H_ONCE
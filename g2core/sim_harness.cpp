@@ -0,0 +1,382 @@
+/*
+ * sim_harness.cpp - headless job runner for the Windows simulator
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "sim_harness.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "persistence.h"
+#include "profile.h"
+#include "benchmark.h"
+#include "preplan.h"
+#include "stress.h"
+#include "util.h"
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+
+// simulator services (Motate win/ or posix/)
+bool xio_usart_init_job(const char *path);
+bool xio_usart_job_read(void);
+bool xio_usart_init_record(const char *path);
+bool xio_usart_init_replay(const char *path);
+void xio_tim_virtual_time(const bool virtual_time, const bool report_bursts);
+void xio_tim_interrupts(const bool enable);
+void xio_tim_skip_idle(const bool skip);
+double xio_tim_motion_seconds(void);
+
+#ifdef WIN32
+#define SIM_MAX_PARALLEL_JOBS MAXIMUM_WAIT_OBJECTS
+#else
+#define SIM_MAX_PARALLEL_JOBS 1024
+#endif
+
+/**** Allocate Structures ****/
+
+typedef struct simHarness {
+    bool headless;                  // running a job or benchmarks instead of the serial port
+    uint32_t bench_ops;             // run benchmarks with this many ops each (0 = not benchmarking)
+    bool estimate;                  // parse and plan the job with no runtime (preplan.h)
+    bool store;                     // ...and record it to the job store
+    const char *job;                // job path ("-" for stdin)
+    bool started;                   // job has been polled at least once
+    uint32_t start_ms;              // SysTick at the first poll
+    uint16_t min_queue;             // fewest planner buffers queued while streaming in cycle
+    bool queue_sampled;             // min_queue holds a sample
+    bool stress;                    // job was generated by stress_generate()
+    uint32_t seed;                  // ...from this seed
+    float stress_end[3];            // ...and should end here
+    char stress_path[32];           // ...and was written here
+} simHarness_t;
+
+static simHarness_t sh;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+
+/*
+ * _run_parallel_jobs() - run each job in a child process, at most parallel at a time
+ *
+ *  Children inherit stdout, so their summary lines appear as each job finishes. A mode
+ *  option (-e) is passed on to each child. Returns the number of jobs that failed or could
+ *  not be started.
+ */
+
+#ifdef WIN32
+
+static int _run_parallel_jobs(int parallel, const char *option, int job_count, char *jobs[])
+{
+    char exe[MAX_PATH];
+    HANDLE running[SIM_MAX_PARALLEL_JOBS];
+    int active = 0;
+    int failed = 0;
+
+    GetModuleFileNameA(NULL, exe, sizeof(exe));
+    if (parallel < 1) { parallel = 1; }
+    if (parallel > SIM_MAX_PARALLEL_JOBS) { parallel = SIM_MAX_PARALLEL_JOBS; }
+
+    for (int next = 0; (next < job_count) || (active > 0); ) {
+        if ((next < job_count) && (active < parallel)) {
+            char cmdline[2 * MAX_PATH + 16];
+            STARTUPINFOA si = { sizeof(si) };
+            PROCESS_INFORMATION pi;
+
+            snprintf(cmdline, sizeof(cmdline), "\"%s\" %s \"%s\"", exe, (option != NULL) ? option : "", jobs[next++]);
+            if (!CreateProcessA(exe, cmdline, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi)) {
+                printf("[job] %s could not be started\n", jobs[next-1]);
+                failed++;
+                continue;
+            }
+            CloseHandle(pi.hThread);
+            running[active++] = pi.hProcess;
+            continue;
+        }
+        DWORD done = WaitForMultipleObjects(active, running, FALSE, INFINITE) - WAIT_OBJECT_0;
+        DWORD code = 1;
+        GetExitCodeProcess(running[done], &code);
+        CloseHandle(running[done]);
+        failed += (code != 0);
+        running[done] = running[--active];
+    }
+    printf("[jobs] %d run, %d failed\n", job_count, failed);
+    return (failed);
+}
+
+#else
+
+static int _run_parallel_jobs(int parallel, const char *option, int job_count, char *jobs[])
+{
+    int active = 0;
+    int failed = 0;
+
+    if (parallel < 1) { parallel = 1; }
+    if (parallel > SIM_MAX_PARALLEL_JOBS) { parallel = SIM_MAX_PARALLEL_JOBS; }
+
+    for (int next = 0; (next < job_count) || (active > 0); ) {
+        if ((next < job_count) && (active < parallel)) {
+            char *job = jobs[next++];
+            fflush(stdout);                             // or the child repeats buffered output
+            pid_t pid = fork();
+            if (pid == 0) {
+                char *args[] = { (char *)"g2-sim", (char *)option, job, NULL };
+                if (option == NULL) {
+                    args[1] = job;
+                    args[2] = NULL;
+                }
+                execv("/proc/self/exe", args);
+                _exit(127);
+            }
+            if (pid < 0) {
+                printf("[job] %s could not be started\n", job);
+                failed++;
+                continue;
+            }
+            active++;
+            continue;
+        }
+        int code;
+        if (wait(&code) < 0) {
+            break;
+        }
+        active--;
+        failed += !(WIFEXITED(code) && (WEXITSTATUS(code) == 0));
+    }
+    printf("[jobs] %d run, %d failed\n", job_count, failed);
+    return (failed);
+}
+
+#endif // WIN32
+
+/*
+ * sim_harness_start() - parse the command line before anything else starts
+ *
+ *  Returns true if there is no machine to run (parallel parent or a bad argument), with
+ *  the process exit code in exit_code. Otherwise selects interactive or headless mode.
+ */
+
+bool sim_harness_start(int argc, char *argv[], int &exit_code)
+{
+    if (argc < 2) {
+        return (false);                                 // interactive
+    }
+    if (strcmp(argv[1], "-j") == 0) {
+        const char *option = ((argc > 3) && (strcmp(argv[3], "-e") == 0)) ? argv[3] : NULL;
+        int first = (option != NULL) ? 4 : 3;
+        if (argc <= first) {
+            printf("usage: %s -j <parallel> [-e] <job> ...\n", argv[0]);
+            exit_code = 2;
+            return (true);
+        }
+        exit_code = _run_parallel_jobs(atoi(argv[2]), option, argc - first, &argv[first]);
+        return (true);
+    }
+    if (strcmp(argv[1], "-e") == 0) {
+        if (argc < 3) {
+            printf("usage: %s -e <job> [-s]\n", argv[0]);
+            exit_code = 2;
+            return (true);
+        }
+        sh.headless = true;
+        sh.estimate = true;
+        sh.job = argv[2];
+        sh.store = (argc > 3) && (strcmp(argv[3], "-s") == 0);
+        xio_tim_interrupts(false);                      // the estimate drives the planner directly
+        return (false);
+    }
+    if (strcmp(argv[1], "-b") == 0) {
+        sh.headless = true;
+        sh.bench_ops = (argc > 2) ? atoi(argv[2]) : BENCHMARK_DEFAULT_OPS;
+        if (sh.bench_ops == 0) { sh.bench_ops = BENCHMARK_DEFAULT_OPS; }
+        xio_tim_interrupts(false);                      // benchmarks drive the planner directly
+        return (false);
+    }
+    if (strcmp(argv[1], "-r") == 0) {                  // interactive, capturing the port input
+        if ((argc < 3) || !xio_usart_init_record(argv[2])) {
+            printf("usage: %s -r <capture>\n", argv[0]);
+            exit_code = 2;
+            return (true);
+        }
+        return (false);
+    }
+    if (strcmp(argv[1], "-z") == 0) {
+        if (argc < 3) {
+            printf("usage: %s -z <seed> [blocks]\n", argv[0]);
+            exit_code = 2;
+            return (true);
+        }
+        sh.stress = true;
+        sh.seed = strtoul(argv[2], NULL, 0);
+        uint32_t blocks = (argc > 3) ? atoi(argv[3]) : STRESS_DEFAULT_BLOCKS;
+        snprintf(sh.stress_path, sizeof(sh.stress_path), "g2-stress-%lu.gcode", (unsigned long)sh.seed);
+        if (!stress_generate(sh.seed, (blocks != 0) ? blocks : STRESS_DEFAULT_BLOCKS, sh.stress_path, sh.stress_end)) {
+            printf("[stress] %s could not be written\n", sh.stress_path);
+            exit_code = 2;
+            return (true);
+        }
+        sh.headless = true;
+        sh.job = sh.stress_path;
+        xio_tim_virtual_time(true, false);
+        if (!xio_usart_init_job(sh.job)) {
+            printf("[job] %s could not be opened\n", sh.job);
+            exit_code = 2;
+            return (true);
+        }
+        return (false);
+    }
+    bool replay = (strcmp(argv[1], "-p") == 0);
+    sh.headless = true;
+    sh.job = replay ? ((argc > 2) ? argv[2] : "") : argv[1];
+    xio_tim_virtual_time(true, false);
+    if (!(replay ? xio_usart_init_replay(sh.job) : xio_usart_init_job(sh.job))) {
+        printf("[job] %s could not be opened\n", sh.job);
+        exit_code = 2;
+        return (true);
+    }
+    return (false);
+}
+
+bool sim_harness_headless() { return (sh.headless); }
+
+/*
+ * _print_bench_result() - print one benchmark result
+ */
+
+static void _print_bench_result(const benchResult_t *r)
+{
+    double cycles = (r->ops == 0) ? 0 : (double)r->cycles / r->ops;
+    printf("[bench] %-20s %8lu ops %10.1f ns/op %10.1f cycles/op%s%s\n",
+           r->name, (unsigned long)r->ops, cycles * 1000000000 / prof_cycle_rate(), cycles,
+           (r->status == STAT_OK) ? "" : "  failed: ",
+           (r->status == STAT_OK) ? "" : get_status_message(r->status));
+}
+
+/*
+ * _print_stress_result() - print worst-case planner times and the final position error
+ *
+ *  Returns true if the machine did not end where the stress job ends.
+ */
+
+static bool _print_stress_result()
+{
+    float error = 0;
+    for (uint8_t axis = AXIS_X; axis <= AXIS_Z; axis++) {
+        error = max(error, (float)fabs(mp_get_runtime_absolute_position(mr, axis) - sh.stress_end[axis]));
+    }
+#if PROFILE_ENABLED == true
+    double us = 1000000.0 / prof_cycle_rate();
+    double plan_us = prof.region[PROF_BACK_PLAN].max * us;
+    double fwd_us = prof.region[PROF_FWD_PLAN].max * us;
+    double exec_us = prof.region[PROF_EXEC].max * us;
+#else
+    double plan_us = -1, fwd_us = -1, exec_us = -1;
+#endif
+    bool failed = (error > STRESS_POSITION_TOLERANCE);
+    printf("[stress] seed %lu max plan %.1f us, max fwd plan %.1f us, max exec %.1f us, position error %.4f mm, %s\n",
+           (unsigned long)sh.seed, plan_us, fwd_us, exec_us, error, failed ? "failed" : "ok");
+    return (failed);
+}
+
+/*
+ * sim_harness_poll() - called once per controller pass; samples the queue and ends the job
+ */
+
+void sim_harness_poll()
+{
+    if (!sh.headless) {
+        return;
+    }
+    if (sh.bench_ops != 0) {
+        stat_t status = benchmark_run(sh.bench_ops, _print_bench_result);
+        fflush(stdout);
+        exit((status == STAT_OK) ? 0 : 1);
+    }
+    if (sh.estimate) {
+        preplanResult_t r;
+        stat_t status = preplan_run(sh.job, sh.store, &r);
+        printf("[estimate] %s cycle %.3f s, moves %.3f s, dwells %.3f s, %lu moves, %.1f mm, %lu lines, %s",
+               sh.job, r.move_seconds + r.dwell_seconds, r.move_seconds, r.dwell_seconds,
+               (unsigned long)r.moves, r.length, (unsigned long)r.lines,
+               (status == STAT_OK) ? "ok\n" : "failed: ");
+        if (status != STAT_OK) {
+            printf("%s at line %lu\n", get_status_message(status), (unsigned long)r.error_line);
+        }
+        fflush(stdout);
+        exit((status == STAT_OK) ? 0 : 1);
+    }
+    if (!sh.started) {
+        sh.started = true;
+        sh.start_ms = SysTickTimer_getValue();
+    }
+    bool input_done = xio_usart_job_read();
+    xio_tim_skip_idle(input_done);                  // nothing more is coming - don't wait out timeouts in real time
+
+    if (!input_done && (cm_get_machine_state() == MACHINE_CYCLE)) {
+        uint16_t queued = mp->q.queue_size - mp_get_planner_buffers(mp);
+        if (!sh.queue_sampled || (queued < sh.min_queue)) {
+            sh.min_queue = queued;
+            sh.queue_sampled = true;
+        }
+    }
+    cmMachineState state = cm_get_machine_state();
+    bool halted = (state == MACHINE_ALARM) || (state == MACHINE_SHUTDOWN) || (state == MACHINE_PANIC);
+    if (!halted && (!input_done || (state == MACHINE_CYCLE) || !mp_runtime_is_idle() || mp_has_runnable_buffer(mp))) {
+        return;
+    }
+    if (persistence_checkpoint_busy() || ((state == MACHINE_PROGRAM_END) && (persistence_checkpoint() != NULL))) {
+        return;                                     // let a program end discard the checkpoint first
+    }
+
+#if PROFILE_ENABLED == true
+    long stalls = (long)prof.exec_overruns;
+    double exec_us = (prof.region[PROF_EXEC].count == 0) ? 0 :
+                     (double)prof.region[PROF_EXEC].max * 1000000 / prof_cycle_rate();
+#else
+    long stalls = -1;
+    double exec_us = -1;
+#endif
+    printf("[job] %s elapsed %.3f s, motion %.3f s, stalls %ld, min queue %d, max exec %.1f us, %s\n",
+           sh.job,
+           (double)(SysTickTimer_getValue() - sh.start_ms) / 1000,
+           xio_tim_motion_seconds(),
+           stalls,
+           sh.queue_sampled ? (int)sh.min_queue : -1,
+           exec_us,
+           halted ? "halted" : "ok");
+    if (sh.stress) {
+        halted |= _print_stress_result();
+    }
+    fflush(stdout);
+    exit(halted ? 1 : 0);
+}
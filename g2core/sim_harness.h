@@ -0,0 +1,71 @@
+/*
+ * sim_harness.h - headless job runner for the Windows simulator
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * HEADLESS JOB RUNNER
+ *
+ *  g2-win                      run interactively on COM3, as before
+ *  g2-win <job.gcode | ->      run one job from a file (or stdin) in virtual time, print a
+ *                              summary line and exit. Responses are discarded.
+ *  g2-win -j <N> <job> ...     run each job in its own child process, N at a time. The exit
+ *                              code is the number of jobs that failed.
+ *  g2-win -e <job> [-s]        estimate: parse and plan the job with no runtime (see preplan.h),
+ *                              print its planned cycle time and exit. -s also records the job
+ *                              to the job store image, as {job:1} would.
+ *  g2-win -j <N> -e <job> ...  estimate each job in its own child process, N at a time.
+ *  g2-win -r <capture>         run interactively, recording the raw port input and the SysTick
+ *                              time of each block to a capture file.
+ *  g2-win -p <capture>         replay a capture as a headless job, each block delivered at its
+ *                              recorded SysTick offset. Run in virtual time, so field stalls
+ *                              (starvation, buffer full) reproduce and can be profiled.
+ *  g2-win -b [ops]             run the planner and parser benchmarks (see benchmark.h) with
+ *                              the stepper interrupts stopped, print ns/op and exit.
+ *  g2-win -z <seed> [blocks]   write a random stress job from the seed (see stress.h) to
+ *                              g2-stress-<seed>.gcode and run it as a job. The summary adds the
+ *                              worst mp_plan_block_list(), mp_forward_plan() and mp_exec_move()
+ *                              times and the final position error. A position error over
+ *                              STRESS_POSITION_TOLERANCE fails the job. Stalls and the fewest
+ *                              queued buffers in the job line show queue starvation.
+ *
+ *  The summary reports simulated elapsed and motion time, planner stalls (loader found no
+ *  segment while the planner still had work), the fewest planner buffers queued while the job
+ *  was streaming, and the longest exec interrupt. Stalls and exec time come from the
+ *  profiler and are reported as -1 unless PROFILE_ENABLED is true.
+ *
+ *  A job ends when all of its input has been parsed and the planner and runtime are idle.
+ *  A job that ends in alarm, shutdown or panic exits with a non-zero code.
+ */
+
+#ifndef SIM_HARNESS_H_ONCE
+#define SIM_HARNESS_H_ONCE
+
+#include "config.h"
+
+bool sim_harness_start(int argc, char *argv[], int &exit_code);
+bool sim_harness_headless(void);
+void sim_harness_poll(void);
+
+#endif  // End of include guard: SIM_HARNESS_H_ONCE
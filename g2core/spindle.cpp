@@ -33,9 +33,11 @@
 #include "spindle.h"
 #include "planner.h"
 #include "hardware.h"
+#include "gpio.h"
 #include "settings.h"
 #include "pwm.h"
 #include "util.h"
+#include "raster.h"
 
 /**** Allocate structures ****/
 
@@ -43,7 +45,9 @@ spSpindle_t spindle;
 
 /**** Static functions ****/
 
-static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm);
+static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm, const float power = 1.0);
+static void _set_spindle_duty(const float duty);
+static void _spinup_dwell(void);
 
 #define SPINDLE_DIRECTION_ASSERT \
     if ((spindle.direction < SPINDLE_CW) || (spindle.direction > SPINDLE_CCW)) { \
@@ -62,7 +66,7 @@ void spindle_init()
         pwm.c[PWM_1].frequency = 0;
     }
     pwm_set_freq(PWM_1, pwm.c[PWM_1].frequency);
-    pwm_set_duty(PWM_1, pwm.c[PWM_1].phase_off);
+    _set_spindle_duty(pwm.c[PWM_1].phase_off);
 }
 
 void spindle_reset()
@@ -145,6 +149,9 @@ void spindle_reset()
 static void _exec_spindle_control(float *value, bool *flag)
 {
     spControl control = (spControl)((int)value[0]);//xzw168
+    if ((control == SPINDLE_CW) || (control == SPINDLE_CCW)) {
+        spindle.speed = value[1];           // M3/M4 start at the speed in effect when they were queued
+    }
     if (control > SPINDLE_ACTION_MAX) {
         return;
     }
@@ -213,10 +220,10 @@ static void _exec_spindle_control(float *value, bool *flag)
     } else {
         spindle_enable_pin.set();           // drive pin HI
     }
-    pwm_set_duty(PWM_1, _get_spindle_pwm(spindle, pwm));
+    _set_spindle_duty(_get_spindle_pwm(spindle, pwm));
 
     if (spinup_delay) {
-        mp_request_out_of_band_dwell(spindle.spinup_delay);
+        _spinup_dwell();
     }
 }
 
@@ -227,7 +234,7 @@ static void _exec_spindle_control(float *value, bool *flag)
 
 stat_t spindle_control_immediate(spControl control)
 {
-    float value[] = { (float)control };
+    float value[] = { (float)control, spindle.speed };
     _exec_spindle_control(value, nullptr);
     return(STAT_OK);
 }
@@ -240,18 +247,60 @@ stat_t spindle_control_sync(spControl control)  // uses spControl arg: OFF, CW,
     }
     
     // queue the spindle control
-    float value[] = { (float)control };
-    mp_queue_command(_exec_spindle_control, value, nullptr_bool);
+    float value[MP_ACTION_VALUES] = { (float)control, cm->gm.spindle_speed };
+    mp_queue_action(_exec_spindle_control, value, nullptr_bool);
+    return(STAT_OK);
+}
+
+/*
+ * _exec_spindle_reverse() - reverse a running spindle at once
+ * spindle_reverse_sync()   - queue a reversal to the planner buffer
+ *
+ *  Used by rigid tapping (G33.1). Unlike an M3/M4 reversal there is no spinup delay:
+ *  the tap-out move follows the spindle through the reversal, so it has to start as
+ *  soon as the direction is changed. A spindle that is off or paused is left alone.
+ */
+
+static void _exec_spindle_reverse(float *value, bool *flag)
+{
+    if ((spindle.state != SPINDLE_CW) && (spindle.state != SPINDLE_CCW)) {
+        return;
+    }
+    spindle.direction = (spindle.state == SPINDLE_CW) ? SPINDLE_CCW : SPINDLE_CW;
+    spindle.state = spindle.direction;
+    if ((spindle.direction-1) ^ spindle.dir_polarity) {
+        spindle_dir_pin.set();              // drive pin HI
+    } else {
+        spindle_dir_pin.clear();            // drive pin LO
+    }
+    _set_spindle_duty(_get_spindle_pwm(spindle, pwm));
+}
+
+stat_t spindle_reverse_sync()
+{
+    mp_queue_action(_exec_spindle_reverse, nullptr_float, nullptr_bool);
     return(STAT_OK);
 }
 
 /****************************************************************************************
  * _exec_spindle_speed()     - actually execute the spindle speed command
  * spindle_speed_immediate() - execute spindle speed change immediately
- * spindle_speed_sync()      - queue a spindle speed change to the planner buffer
+ * spindle_speed_sync()      - set the spindle speed for the moves that follow
+ * spindle_speed_segment()   - apply a move's spindle speed from the runtime
  *
  *  Setting S0 is considered as turning spindle off. Setting S to non-zero from S0
  *  will enable a spinup delay if spinups are npn-zero.
+ *
+ *  S words are not queued as commands, which would break continuous motion between
+ *  every pair of moves (laser rasters change S on nearly every line). The speed is set
+ *  in the model and carried by each motion block (gm.spindle_speed), and the runtime
+ *  applies it segment by segment through spindle_speed_segment(). Only a spinup from
+ *  S0 with a non-zero spinup delay still queues a command, as it needs the dwell.
+ *  A speed change with no move after it takes effect at the next move or M3/M4.
+ *
+ *  With dynamic power enabled {spdy:1} (lasers) the output is also scaled by the
+ *  segment velocity over the block's cruise velocity, so the energy delivered per unit
+ *  length stays even through acceleration and deceleration.
  */
 
 static void _exec_spindle_speed(float *value, bool *flag)
@@ -259,10 +308,10 @@ static void _exec_spindle_speed(float *value, bool *flag)
     float previous_speed = spindle.speed;
 
     spindle.speed = value[0];
-    pwm_set_duty(PWM_1, _get_spindle_pwm(spindle, pwm));
+    _set_spindle_duty(_get_spindle_pwm(spindle, pwm));
 
     if (fp_ZERO(previous_speed)) {
-        mp_request_out_of_band_dwell(spindle.spinup_delay);
+        _spinup_dwell();
     }
 }
 
@@ -276,6 +325,7 @@ static stat_t _casey_jones(float speed)
 stat_t spindle_speed_immediate(float speed)
 {
     ritorno(_casey_jones(speed));
+    cm->gm.spindle_speed = speed;           // or the next move would put the old speed back
     float value[] = { speed };
     _exec_spindle_speed(value, nullptr);
     return (STAT_OK);
@@ -284,16 +334,123 @@ stat_t spindle_speed_immediate(float speed)
 stat_t spindle_speed_sync(float speed)
 {
     ritorno(_casey_jones(speed));
-    float value[] = { speed };
-    mp_queue_command(_exec_spindle_speed, value, nullptr_bool);
+    bool spinup = fp_ZERO(cm->gm.spindle_speed) && fp_NOT_ZERO(spindle.spinup_delay);
+    cm->gm.spindle_speed = speed;
+    if (spinup) {
+        float value[MP_ACTION_VALUES] = { speed };
+        mp_queue_action(_exec_spindle_speed, value, nullptr_bool);
+    }
     return (STAT_OK);
 }
 
+void spindle_speed_segment(const float speed, const float velocity, const float cruise_velocity)
+{
+    if (spindle.dynamic_power && (cruise_velocity > 0)) {
+        spindle.speed = speed;
+        _set_spindle_duty(_get_spindle_pwm(spindle, pwm, min(1.0f, velocity / cruise_velocity)));
+    } else if (fp_NE(speed, spindle.speed)) {
+        spindle.speed = speed;
+        _set_spindle_duty(_get_spindle_pwm(spindle, pwm));
+    }
+}
+
+/****************************************************************************************
+ * _spinup_dwell()     - wait for the spindle to come up to speed after a start
+ * _spindle_at_speed() - dwell release for the at-speed input
+ *
+ *  Without an at-speed input {spas:} a spinup waits the full spinup delay {spde:}, which
+ *  has to be sized for the slowest start. Most VFDs have an output that is active while
+ *  the spindle is within their tolerance of the commanded speed. Wired to an input and
+ *  set as {spas:}, it ends the dwell as soon as the spindle is at speed, and the spinup
+ *  delay becomes the timeout. The input is ignored for the first few ms, as a drive
+ *  that has just been given a speed can still be showing at-speed for the old one.
+ *
+ *  _spindle_at_speed() is called from the SysTick interrupt on every tick of the dwell.
+ */
+
+static volatile uint16_t spinup_settle_ticks;
+
+static bool _spindle_at_speed()
+{
+    if (spinup_settle_ticks > 0) {
+        spinup_settle_ticks--;
+        return (false);
+    }
+    return (d_in[spindle.at_speed_input-1].state == INPUT_ACTIVE);
+}
+
+static void _spinup_dwell()
+{
+    if (spindle.at_speed_input == 0) {
+        mp_request_out_of_band_dwell(spindle.spinup_delay);
+        return;
+    }
+    spinup_settle_ticks = SPINDLE_AT_SPEED_SETTLE_MS;
+    mp_request_out_of_band_dwell(spindle.spinup_delay, _spindle_at_speed);
+}
+
+/****************************************************************************************
+ * spindle_encoder_owns_input() - true if the input is an encoder channel (no lockout, action or function)
+ * spindle_encoder_edge()       - count an encoder edge - called from the input's ISR
+ *
+ *  Spindle synchronized moves (G33, G33.1) gear an axis to the spindle position, which
+ *  is counted from an encoder on two inputs. Each leading edge of channel A {spea:}
+ *  counts one - up if channel B {speb:} is inactive at that moment, down if it is
+ *  active. With no B channel (a single slot or hall sensor) the count follows the
+ *  direction the spindle was commanded in. {sppr:} is the A pulses per revolution.
+ *  Like the sync lines, encoder inputs are handled in their pin change interrupt with
+ *  no lockout, and their action and function settings are ignored.
+ */
+
+bool spindle_encoder_owns_input(const uint8_t input)
+{
+    return ((input != 0) && ((input == spindle.encoder_input_a) || (input == spindle.encoder_input_b)));
+}
+
+void spindle_encoder_edge(const uint8_t input, const ioState state)
+{
+    if ((input != spindle.encoder_input_a) || (state != INPUT_ACTIVE)) {
+        return;                             // B is only sampled, on A's leading edge
+    }
+    bool reverse;
+    if (spindle.encoder_input_b != 0) {
+        reverse = (d_in[spindle.encoder_input_b-1].state == INPUT_ACTIVE);
+    } else {
+        reverse = (spindle.direction == SPINDLE_CCW);
+    }
+    spindle.encoder_count += reverse ? -1 : 1;
+}
+
+/****************************************************************************************
+ * spindle_power_duty() - PWM duty for a fraction of a speed, in the current direction
+ * _set_spindle_duty()  - write the spindle PWM and remember it
+ *
+ *  While a raster line is playing (see raster.h) it owns the PWM. The duty is only
+ *  remembered then, and the raster puts it back when the line ends.
+ */
+
+float spindle_power_duty(const float speed, const float power)
+{
+    spSpindle_t s = spindle;
+    s.speed = speed;
+    return (_get_spindle_pwm(s, pwm, power));
+}
+
+static void _set_spindle_duty(const float duty)
+{
+    spindle.duty = duty;
+    if (!raster_running()) {
+        pwm_set_duty(PWM_1, duty);
+    }
+}
+
 /****************************************************************************************
  * _get_spindle_pwm() - return PWM phase (duty cycle) for dir and speed
+ *
+ *  power scales the speed before it is mapped to the phase range (dynamic laser power)
  */
 
-static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm)
+static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm, const float power)
 {
     float speed_lo, speed_hi, phase_lo, phase_hi;
     if (_spindle.direction == SPINDLE_CW ) {
@@ -317,7 +474,7 @@ static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm)
             _spindle.speed = speed_hi;
         }
         // normalize speed to [0..1]
-        float speed = (_spindle.speed - speed_lo) / (speed_hi - speed_lo);
+        float speed = max(0.0f, (_spindle.speed * power - speed_lo) / (speed_hi - speed_lo));
         return ((speed * (phase_hi - phase_lo)) + phase_lo);
     } else {
         return (_pwm.c[PWM_1].phase_off);
@@ -401,8 +558,20 @@ stat_t sp_set_spdp(nvObj_t *nv) {
 
 stat_t sp_get_spph(nvObj_t *nv) { return(get_integer(nv, spindle.pause_enable)); }
 stat_t sp_set_spph(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.pause_enable, 0, 1)); }
+stat_t sp_get_spdy(nvObj_t *nv) { return(get_integer(nv, spindle.dynamic_power)); }
+stat_t sp_set_spdy(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.dynamic_power, 0, 1)); }
 stat_t sp_get_spde(nvObj_t *nv) { return(get_float(nv, spindle.spinup_delay)); }
 stat_t sp_set_spde(nvObj_t *nv) { return(set_float_range(nv, spindle.spinup_delay, 0, SPINDLE_DWELL_MAX)); }
+stat_t sp_get_spas(nvObj_t *nv) { return(get_integer(nv, spindle.at_speed_input)); }
+stat_t sp_set_spas(nvObj_t *nv) { return(set_integer(nv, spindle.at_speed_input, 0, D_IN_CHANNELS)); }
+stat_t sp_get_spea(nvObj_t *nv) { return(get_integer(nv, spindle.encoder_input_a)); }
+stat_t sp_set_spea(nvObj_t *nv) { return(set_integer(nv, spindle.encoder_input_a, 0, D_IN_CHANNELS)); }
+stat_t sp_get_speb(nvObj_t *nv) { return(get_integer(nv, spindle.encoder_input_b)); }
+stat_t sp_set_speb(nvObj_t *nv) { return(set_integer(nv, spindle.encoder_input_b, 0, D_IN_CHANNELS)); }
+stat_t sp_get_sppr(nvObj_t *nv) { return(get_integer(nv, spindle.encoder_ppr)); }
+stat_t sp_set_sppr(nvObj_t *nv) { return(set_int32(nv, spindle.encoder_ppr, 1, SPINDLE_ENCODER_PPR_MAX)); }
+stat_t sp_get_spsa(nvObj_t *nv) { return(get_float(nv, spindle.sync_accel)); }
+stat_t sp_set_spsa(nvObj_t *nv) { return(set_float_range(nv, spindle.sync_accel, 1, SPINDLE_SYNC_ACCEL_MAX)); }
 
 stat_t sp_get_spsn(nvObj_t *nv) { return(get_float(nv, spindle.speed_min)); }
 stat_t sp_set_spsn(nvObj_t *nv) { return(set_float_range(nv, spindle.speed_min, SPINDLE_SPEED_MIN, SPINDLE_SPEED_MAX)); }
@@ -434,6 +603,12 @@ const char fmt_spep[] = "[spep] spindle enable polarity%5d [0=active_low,1=activ
 const char fmt_spdp[] = "[spdp] spindle direction polarity%2d [0=CW_low,1=CW_high]\n";
 const char fmt_spph[] = "[spph] spindle pause on hold%7d [0=no,1=pause_on_hold]\n";
 const char fmt_spde[] = "[spde] spindle spinup delay%10.1f seconds\n";
+const char fmt_spdy[] = "[spdy] spindle dynamic power%7d [0=fixed,1=scale with velocity]\n";
+const char fmt_spas[] = "[spas] spindle at-speed input%6d [0=none,n=input n ends spinup delay]\n";
+const char fmt_spea[] = "[spea] spindle encoder A input%5d [0=none]\n";
+const char fmt_speb[] = "[speb] spindle encoder B input%5d [0=none,count in commanded direction]\n";
+const char fmt_sppr[] = "[sppr] spindle encoder pulses%6d per revolution\n";
+const char fmt_spsa[] = "[spsa] spindle sync acceleration%9.0f mm/s^2\n";
 const char fmt_spsn[] = "[spsn] spindle speed min%14.2f rpm\n";
 const char fmt_spsm[] = "[spsm] spindle speed max%14.2f rpm\n";
 const char fmt_spoe[] = "[spoe] spindle speed override ena%2d [0=disable,1=enable]\n";
@@ -446,6 +621,12 @@ void sp_print_spep(nvObj_t *nv) { text_print(nv, fmt_spep);}    // TYPE_INT
 void sp_print_spdp(nvObj_t *nv) { text_print(nv, fmt_spdp);}    // TYPE_INT
 void sp_print_spph(nvObj_t *nv) { text_print(nv, fmt_spph);}    // TYPE_INT
 void sp_print_spde(nvObj_t *nv) { text_print(nv, fmt_spde);}    // TYPE_FLOAT
+void sp_print_spdy(nvObj_t *nv) { text_print(nv, fmt_spdy);}    // TYPE_INT
+void sp_print_spas(nvObj_t *nv) { text_print(nv, fmt_spas);}    // TYPE_INT
+void sp_print_spea(nvObj_t *nv) { text_print(nv, fmt_spea);}    // TYPE_INT
+void sp_print_speb(nvObj_t *nv) { text_print(nv, fmt_speb);}    // TYPE_INT
+void sp_print_sppr(nvObj_t *nv) { text_print(nv, fmt_sppr);}    // TYPE_INT
+void sp_print_spsa(nvObj_t *nv) { text_print(nv, fmt_spsa);}    // TYPE_FLOAT
 void sp_print_spsn(nvObj_t *nv) { text_print(nv, fmt_spsn);}    // TYPE_FLOAT
 void sp_print_spsm(nvObj_t *nv) { text_print(nv, fmt_spsm);}    // TYPE_FLOAT
 void sp_print_spoe(nvObj_t *nv) { text_print(nv, fmt_spoe);}    // TYPE INT
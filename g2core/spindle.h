@@ -28,11 +28,16 @@
 #ifndef SPINDLE_H_ONCE
 #define SPINDLE_H_ONCE
 
+#include "gpio.h"                       // ioState for the encoder inputs
+
 #define SPINDLE_OVERRIDE_ENABLE false
 #define SPINDLE_OVERRIDE_FACTOR 1.00
 #define SPINDLE_OVERRIDE_MIN 0.05       // 5%
 #define SPINDLE_OVERRIDE_MAX 2.00       // 200%
 #define SPINDLE_OVERRIDE_RAMP_TIME 1    // change sped in seconds
+#define SPINDLE_AT_SPEED_SETTLE_MS 100  // at-speed input is ignored this long after a spinup starts
+#define SPINDLE_ENCODER_PPR_MAX 10000   // encoder pulses per revolution
+#define SPINDLE_SYNC_ACCEL_MAX 100000   // mm/s^2
 
 typedef enum {
     SPINDLE_DISABLED = 0,       // spindle will not operate
@@ -85,6 +90,7 @@ typedef struct spSpindle {
     spControl   direction;          //        1=CW, 2=CCW (subset of above state)
 
     float       speed;              // {sps:}  S in RPM
+    float       duty;               //         PWM duty last set for the spindle
     float       speed_min;          // {spsn:} minimum settable spindle speed
     float       speed_max;          // {spsm:} maximum settable spindle speed
 
@@ -92,6 +98,13 @@ typedef struct spSpindle {
     spPolarity  dir_polarity;       // {spdp:} 0=clockwise low, 1=clockwise high
     bool        pause_enable;       // {spph:} pause on feedhold
     float       spinup_delay;       // {spde:} optional delay on spindle start (set to 0 to disable)
+    uint8_t     at_speed_input;     // {spas:} input that ends the spinup delay early, 0=none
+    uint8_t     encoder_input_a;    // {spea:} spindle encoder channel A input, 0=none
+    uint8_t     encoder_input_b;    // {speb:} channel B input, 0=count in the commanded direction
+    int32_t     encoder_ppr;        // {sppr:} channel A pulses per spindle revolution
+    float       sync_accel;         // {spsa:} axis acceleration following the spindle (mm/s^2)
+    volatile int32_t encoder_count; //         A pulses counted, signed by direction (CW up)
+    bool        dynamic_power;      // {spdy:} scale output with segment velocity (lasers)
 //    float       spindown_delay;     // {spds:} optional delay on spindle stop (set to 0 to disable)
 
     bool        override_enable;    // {spoe:} TRUE = spindle speed override enabled (see also m48_enable in canonical machine)
@@ -114,8 +127,15 @@ void spindle_reset();
 
 stat_t spindle_control_immediate(spControl control);
 stat_t spindle_control_sync(spControl control);
+stat_t spindle_reverse_sync(void);
 stat_t spindle_speed_immediate(float speed);    // S parameter
 stat_t spindle_speed_sync(float speed);         // S parameter
+void spindle_speed_segment(const float speed, const float velocity, const float cruise_velocity);
+float spindle_power_duty(const float speed, const float power);
+
+bool spindle_encoder_owns_input(const uint8_t input);
+void spindle_encoder_edge(const uint8_t input, const ioState state);
+static inline bool spindle_encoder_enabled(void) { return ((spindle.encoder_input_a != 0) && (spindle.encoder_ppr > 0)); }
 
 stat_t spindle_override_control(const float P_word, const bool P_flag); // M51
 void spindle_start_override(const float ramp_time, const float override_factor);
@@ -132,6 +152,18 @@ stat_t sp_set_spph(nvObj_t *nv);
 
 stat_t sp_get_spde(nvObj_t *nv);
 stat_t sp_set_spde(nvObj_t *nv);
+stat_t sp_get_spdy(nvObj_t *nv);
+stat_t sp_set_spdy(nvObj_t *nv);
+stat_t sp_get_spas(nvObj_t *nv);
+stat_t sp_set_spas(nvObj_t *nv);
+stat_t sp_get_spea(nvObj_t *nv);
+stat_t sp_set_spea(nvObj_t *nv);
+stat_t sp_get_speb(nvObj_t *nv);
+stat_t sp_set_speb(nvObj_t *nv);
+stat_t sp_get_sppr(nvObj_t *nv);
+stat_t sp_set_sppr(nvObj_t *nv);
+stat_t sp_get_spsa(nvObj_t *nv);
+stat_t sp_set_spsa(nvObj_t *nv);
 //stat_t sp_get_spdn(nvObj_t *nv);
 //stat_t sp_set_spdn(nvObj_t *nv);
 
@@ -159,6 +191,12 @@ stat_t sp_set_sps(nvObj_t* nv);
     void sp_print_spdp(nvObj_t* nv);
     void sp_print_spph(nvObj_t* nv);
     void sp_print_spde(nvObj_t* nv);
+    void sp_print_spdy(nvObj_t* nv);
+    void sp_print_spas(nvObj_t* nv);
+    void sp_print_spea(nvObj_t* nv);
+    void sp_print_speb(nvObj_t* nv);
+    void sp_print_sppr(nvObj_t* nv);
+    void sp_print_spsa(nvObj_t* nv);
 //    void sp_print_spdn(nvObj_t* nv);
     void sp_print_spsn(nvObj_t* nv);
     void sp_print_spsm(nvObj_t* nv);
@@ -174,6 +212,12 @@ stat_t sp_set_sps(nvObj_t* nv);
     #define sp_print_spdp tx_print_stub
     #define sp_print_spph tx_print_stub
     #define sp_print_spde tx_print_stub
+    #define sp_print_spdy tx_print_stub
+    #define sp_print_spas tx_print_stub
+    #define sp_print_spea tx_print_stub
+    #define sp_print_speb tx_print_stub
+    #define sp_print_sppr tx_print_stub
+    #define sp_print_spsa tx_print_stub
 //    #define sp_print_spdn tx_print_stub
     #define sp_print_spsn tx_print_stub
     #define sp_print_spsm tx_print_stub
@@ -39,6 +39,11 @@
 #include "util.h"
 #include "controller.h"
 #include "xio.h"
+#include "profile.h"
+#include "memory_usage.h"
+#include "motion_trace.h"
+#include "kinematics.h"
+#include "sync.h"
 
 /**** Debugging output with semihosting ****/
 
@@ -57,6 +62,31 @@ static stRunSingleton_t st_run;
 /**** Static functions ****/
 
 static void _load_move(void);
+static void _reset_prep_ring(void);
+static float _prep_backlash(const uint8_t motor, const float travel, const int32_t dda_ticks);
+#if DDA_STEP_TABLE == true
+static stat_t _prep_step_table(stPrepSegment_t *seg);
+#endif
+#if DDA_MICROSTEP_SWITCH == true
+static void _set_hw_microsteps(const uint8_t motor, const uint8_t microsteps);
+static bool _prep_microstep_switch(stPrepMotor_t *m, int32_t &accumulator, uint32_t &increment, const uint32_t substeps);
+static_assert(MOTORS < 8, "DDA_MICROSTEP_SWITCH uses the top bit of the step table");
+#endif
+#if DDA_SEGMENT_RAMP == true
+static void _prep_ramp(const stPrepSegment_t *seg, stPrepSegmentMotor_t *mot, const float segment_ramp);
+#endif
+
+static_assert(STEP_CORRECTION_HOLDOFF > PREP_BUFFER_SLOTS + 1, "STEP_CORRECTION_HOLDOFF must outlast the prep ring");
+#if DDA_BATCH_SEGMENTS == true
+static_assert(DDA_STEP_TABLE == false, "DDA_BATCH_SEGMENTS and DDA_STEP_TABLE are exclusive");
+static bool _dda_batch_prepare(void);
+#endif
+#if DDA_STEP_PINSET == true
+static void _update_step_polarity(void);
+#endif
+
+#define _next_prep_slot(s) (((s) + 1) % PREP_BUFFER_SLOTS)
+#define _prev_prep_slot(s) (((s) + PREP_BUFFER_SLOTS - 1) % PREP_BUFFER_SLOTS)
 
 /**** Setup motate ****/
 
@@ -71,9 +101,11 @@ exec_timer_type exec_timer;                               // 触发下一个+ 1
 fwd_plan_timer_type fwd_plan_timer;                       // 触发下一个块的计划
 
 // SystickEvent用于处理停顿（必须在活动之前注册）
-Motate::SysTickEvent dwell_systick_event{[&] {
-                                             if (--st_run.dwell_ticks_downcount == 0)
+Motate::SysTickEvent dwell_systick_event{[] {
+                                             if ((--st_run.dwell_ticks_downcount == 0) ||
+                                                 ((st_run.dwell_release != nullptr) && st_run.dwell_release()))
                                              {
+                                                 st_run.dwell_ticks_downcount = 0;
                                                  SysTickTimer.unregisterEvent(&dwell_systick_event);
                                                  _load_move(); // 在当前中断级别加载下一步移动
                                              }
@@ -138,7 +170,7 @@ void stepper_init()
 
     // setup software interrupt exec timer & initial condition
     exec_timer.setInterrupts(kInterruptOnSoftwareTrigger | kInterruptPriorityHigh);
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;
+    _reset_prep_ring();
 
     // setup software interrupt forward plan timer & initial condition
     fwd_plan_timer.setInterrupts(kInterruptOnSoftwareTrigger | kInterruptPriorityMedium);
@@ -162,20 +194,62 @@ void stepper_init()
 void stepper_reset()
 {
     dda_timer.stop();               // stop all movement
+    st_run.dda_running = false;
     st_run.dda_ticks_downcount = 0; // signal the runtime is not busy
     st_run.dwell_ticks_downcount = 0;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC; // set to EXEC or it won't restart
+    st_run.motors_idle = false;
+    st_run.raster_increment = 0;
+    st_run.actions = 0;             // the planner drops its action ring too
+    _reset_prep_ring();             // set to EXEC or it won't restart
 
+#if DDA_STEP_PINSET == true
+    _update_step_polarity();
+#endif
     for (uint8_t motor = 0; motor < MOTORS; motor++)
     {
         st_pre.mot[motor].prev_direction = STEP_INITIAL_DIRECTION;
-        st_pre.mot[motor].direction = STEP_INITIAL_DIRECTION;
         st_run.mot[motor].substep_accumulator = 0; // will become max negative during per-motor setup;
+        st_run.mot[motor].motion_state = MOTOR_MOTION_UNKNOWN;
         st_pre.mot[motor].corrected_steps = 0;     // diagnostic only - no action effect
+#if DDA_STEP_TABLE == true
+        st_pre.mot[motor].table_direction = STEP_INITIAL_DIRECTION;
+        st_pre.mot[motor].substep_accumulator = 0;
+#endif
+#if DDA_MICROSTEP_SWITCH == true
+        if (st_pre.mot[motor].step_weight > 1)
+        { // the driver is on a full coarse step, so it can go back to fine here
+            _set_hw_microsteps(motor, st_cfg.mot[motor].microsteps);
+        }
+        st_pre.mot[motor].step_weight = 1;
+        st_pre.mot[motor].wanted_weight = 1;
+#endif
     }
     mp_set_steps_to_runtime_position(); // reset encoder to agree with the above
 }
 
+/*
+ * _reset_prep_ring() - empty the prep ring and give all slots to exec
+ */
+
+static void _reset_prep_ring()
+{
+    for (uint8_t s = 0; s < PREP_BUFFER_SLOTS; s++)
+    {
+        st_pre.seg[s].block_type = BLOCK_TYPE_NULL;
+        st_pre.seg[s].buffer_state = PREP_BUFFER_OWNED_BY_EXEC;
+        st_pre.seg[s].actions = 0;
+        for (uint8_t motor = 0; motor < MOTORS; motor++)
+        {
+            st_pre.seg[s].mot[motor].travel_steps = 0;
+        }
+    }
+    st_pre.exec_slot = 0;
+    st_pre.load_slot = 0;
+#if DDA_STEP_TABLE == true
+    st_pre.table_slot = 0;
+#endif
+}
+
 /*
  * stepper_init_assertions() - test assertions, return error code if violation exists
  * stepper_test_assertions() - test assertions, return error code if violation exists
@@ -223,32 +297,198 @@ stat_t st_clc(nvObj_t *nv) // clear diagnostic counters, reset stepper prep
 }
 
 /*
- * st_motor_power_callback() - 回调以管理电机电源排序
+ * st_request_power_timeout() - note that a motor is waiting for its power timeout to start
+ * st_motor_power_callback()  - 回调以管理电机电源排序
  *
  *  处理电机掉电定时，低功耗空闲和自适应电机功率
+ *
+ *  Motor power is event driven. The loader only calls enable() or motionStopped() when a
+ *  motor starts or stops stepping, and motionStopped() raises a request. The callback only
+ *  visits the motors when a request is pending, and puts each started timeout on a deadline
+ *  list sorted soonest first. On all other passes it only compares the first deadline.
+ *
+ *  A motor can start again before its deadline. Its entry then stays on the list and is
+ *  ignored by powerTimeoutExpired(). A new timeout for the same motor replaces the old entry.
  */
 
+static struct stPowerDeadlines {
+    volatile bool request;                  // a motor entered MOTOR_POWER_TIMEOUT_START
+    uint8_t count;                          // entries on the deadline list
+    uint8_t motor[MOTORS];                  // motors counting down, soonest deadline first
+    uint32_t deadline[MOTORS];              // SysTick time the motor times out
+} st_pwr;
+
+void st_request_power_timeout() { st_pwr.request = true; }
+
+static void _power_deadline_insert(const uint8_t motor, const uint32_t deadline)
+{
+    uint8_t kept = 0;
+    for (uint8_t j = 0; j < st_pwr.count; j++)
+    { // drop an older entry for this motor
+        if (st_pwr.motor[j] != motor)
+        {
+            st_pwr.motor[kept] = st_pwr.motor[j];
+            st_pwr.deadline[kept++] = st_pwr.deadline[j];
+        }
+    }
+    uint8_t i = kept;
+    for (; (i > 0) && ((int32_t)(st_pwr.deadline[i - 1] - deadline) > 0); i--)
+    {
+        st_pwr.motor[i] = st_pwr.motor[i - 1];
+        st_pwr.deadline[i] = st_pwr.deadline[i - 1];
+    }
+    st_pwr.motor[i] = motor;
+    st_pwr.deadline[i] = deadline;
+    st_pwr.count = kept + 1;
+}
+
 stat_t st_motor_power_callback() // 由控制器调用
 {
-    if (!mp_is_phat_city_time())
-    { // don't process this if you are time constrained in the planner
+    uint32_t now = SysTickTimer_getValue();
+
+    if (st_pwr.request)
+    { // clear the request first so a request raised during the scan is seen next pass
+        st_pwr.request = false;
+        uint32_t timeout_ms;
+        for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+        {
+            if (Motors[motor]->startPowerTimeout(timeout_ms))
+            {
+                _power_deadline_insert(motor, now + timeout_ms);
+            }
+        }
+    }
+    if ((st_pwr.count == 0) || ((int32_t)(now - st_pwr.deadline[0]) < 0))
+    {
         return (STAT_NOOP);
     }
+    while ((st_pwr.count > 0) && ((int32_t)(now - st_pwr.deadline[0]) >= 0))
+    {
+        uint8_t motor = st_pwr.motor[0];
+        st_pwr.count--;
+        for (uint8_t i = 0; i < st_pwr.count; i++)
+        {
+            st_pwr.motor[i] = st_pwr.motor[i + 1];
+            st_pwr.deadline[i] = st_pwr.deadline[i + 1];
+        }
+        Motors[motor]->powerTimeoutExpired();
+    }
+    return (STAT_OK);
+}
+
+/*
+ * st_driver_status_callback() - poll smart driver status and act on stalls and faults
+ * st_set_stall_homing()       - home the motors of an axis on their stall flags, or stop
+ * st_axis_stalled()           - true if a motor of the axis stalled since homing began
+ *
+ *  Each pass takes the status of the read queued on the previous pass and queues the next
+ *  read, so the callback never waits on the bus. Flags act once when they are raised:
+ *
+ *    - overtemperature alarms
+ *    - open load alarms in a cycle (some drivers flag it at standstill)
+ *    - a stall on a motor homing on stall ends the homing move the same way a homing
+ *      switch does (see gpio.cpp). Otherwise it does what the motor's {1sg:} says, in a cycle
+ *
+ *  Stalls are seen up to ST_DRIVER_STATUS_MS late, which is the sensorless homing
+ *  repeatability at search velocity. Stall thresholds are set in the driver.
+ */
+
+static struct stDriverState {
+    uint8_t status[MOTORS];                 // stDriverStatus flags as last polled
+    int16_t load[MOTORS];                   // load as last polled
+    uint8_t stall_homing;                   // motors homing on stall, one bit per motor
+    uint8_t stalled;                        // homing motors that stalled, held until homing ends
+} st_drv;
+
+stat_t st_driver_status_callback()
+{
+    bool polled = false;
+    bool in_cycle = (cm_get_machine_state() == MACHINE_CYCLE);
+
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        if (!Motors[motor]->hasDriverStatus())
+        {
+            continue;
+        }
+        polled = true;
+        uint8_t status = Motors[motor]->getDriverStatus();
+        uint8_t raised = status & ~st_drv.status[motor];
+        st_drv.status[motor] = status;
+        st_drv.load[motor] = Motors[motor]->getDriverLoad();
+        Motors[motor]->pollDriverStatus();
+
+        if (raised & DRIVER_OVERTEMP)
+        {
+            cm_alarm(STAT_ALARM, "motor driver overtemperature");
+        }
+        if ((raised & DRIVER_OPEN_LOAD) && in_cycle)
+        {
+            cm_alarm(STAT_ALARM, "motor open load");
+        }
+        if (!(raised & DRIVER_STALL))
+        {
+            continue;
+        }
+        uint8_t motor_bit = 1 << motor;
+        if (st_drv.stall_homing & motor_bit)
+        {
+            if (!(st_drv.stalled & motor_bit))
+            {
+                st_drv.stalled |= motor_bit;
+                en_take_encoder_snapshot();
+                cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_RESET_POSITION);
+            }
+        }
+        else if (in_cycle)
+        {
+            if (st_cfg.mot[motor].stall_action == STALL_FEEDHOLD)
+            {
+                cm_request_feedhold(FEEDHOLD_TYPE_HOLD, FEEDHOLD_EXIT_STOP);
+            }
+            else if (st_cfg.mot[motor].stall_action == STALL_ALARM)
+            {
+                cm_alarm(STAT_ALARM, "motor stall");
+            }
+        }
+    }
+    return (polled ? STAT_OK : STAT_NOOP);
+}
 
-    bool have_actually_stopped = false;
-    if ((!st_runtime_isbusy()) &&
-        (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER) &&
-        (cm_get_machine_state() != MACHINE_CYCLE))
-    { // if there are no moves to load...
-        have_actually_stopped = true;
+bool st_set_stall_homing(const uint8_t axis, const bool homing)
+{
+    bool can_stall = false;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        if (st_cfg.mot[motor].motor_map != axis)
+        {
+            continue;
+        }
+        uint8_t motor_bit = 1 << motor;
+        st_drv.stalled &= ~motor_bit;
+        if (homing && Motors[motor]->hasDriverStatus())
+        {
+            st_drv.stall_homing |= motor_bit;
+            can_stall = true;
+        }
+        else
+        {
+            st_drv.stall_homing &= ~motor_bit;
+        }
     }
+    return (can_stall);
+}
 
-    // 分别管理每台电机的电源
+bool st_axis_stalled(const uint8_t axis)
+{
     for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
     {
-        Motors[motor]->periodicCheck(have_actually_stopped);
+        if ((st_cfg.mot[motor].motor_map == axis) && (st_drv.stalled & (1 << motor)))
+        {
+            return (true);
+        }
     }
-    return (STAT_OK);
+    return (false);
 }
 
 /******************************
@@ -259,6 +499,287 @@ stat_t st_motor_power_callback() // 由控制器调用
  * ISR -  DDA定时器中断程序 - 来自DDA定时器的服务定时器
  */
 
+/*
+ * DDA kernel - generates the unrolled per-motor DDA code from DDA_MOTOR_LIST
+ *
+ *  The kernels recurse over the motor objects at compile time, so the result is the same
+ *  straight-line code as writing each motor out by hand, for any number of motors.
+ *
+ *  _dda_step_end()     - clear the step bits in a mask (the pins set during the previous interrupt)
+ *  _dda_step_start()   - run the DDA for each motor, set its step bit as it fires and return the mask
+ *  _dda_accumulate()   - run the DDA for each motor and return the step bits as a mask
+ *  _dda_write_steps()  - set the step bits in a mask (used with _dda_accumulate())
+ *
+ *  With DDA_PACKED_STEPS all accumulators are updated first and the step pins are then
+ *  written back-to-back, which keeps the pulses of all motors aligned within a tick.
+ *
+ *  The mask of pins set in a tick is kept in st_run.step_bits so the next tick only ends
+ *  the pulses that were actually started. At typical step rates most ticks start no pulse
+ *  at all, so this skips most of the stepEnd() calls the ISR would otherwise make.
+ *
+ *  With DDA_STEP_TABLE the accumulators were already run by exec (see _prep_step_table())
+ *  and the interrupt only plays the next table entry through _dda_write_steps().
+ *
+ *  With DDA_STEP_PINSET the kernels only keep the pulse counts and the pins are written
+ *  for all motors at once by _dda_pins_start() and _dda_pins_end(), one write per port.
+ *  Motors with an active low step pin are kept in st_run.step_active_low.
+ *
+ *  Driver timing comes from DDA_MOTOR_TIMING (see step_dir_driver.h). A motor whose driver
+ *  needs a pulse longer than one tick keeps its bit in st_run.step_bits until its
+ *  pulse_downcount runs out. A motor whose driver needs more than one tick of direction setup
+ *  keeps accumulating for dir_holdoff ticks after a direction change without stepping, and
+ *  catches up afterwards. Both tests are compile-time constants, so motors whose driver fits
+ *  in one tick get the same code as before.
+ */
+
+template <typename... Ms>
+constexpr uint8_t _dda_motor_count(Ms &... motors) { return (sizeof...(Ms)); }
+
+static_assert(_dda_motor_count(DDA_MOTOR_LIST) == MOTORS, "DDA_MOTOR_LIST must name exactly MOTORS motors");
+
+static constexpr stStepTiming_t _dda_timing[] = { DDA_MOTOR_TIMING };
+static_assert(sizeof(_dda_timing) / sizeof(_dda_timing[0]) == MOTORS, "DDA_MOTOR_TIMING must name exactly MOTORS motors");
+
+constexpr uint8_t _dda_pulse_ticks(const uint8_t motor) { return (step_timing_ticks(_dda_timing[motor].pulse_ns)); }
+constexpr uint8_t _dda_dir_ticks(const uint8_t motor) { return (step_timing_ticks(_dda_timing[motor].dir_setup_ns)); }
+
+template <uint8_t motor>
+static inline bool _dda_fire()
+{
+    st_run.mot[motor].substep_accumulator += st_run.mot[motor].substep_increment;
+#if DDA_SEGMENT_RAMP == true
+    st_run.mot[motor].substep_increment += st_run.mot[motor].substep_ramp;
+#endif
+    if ((_dda_dir_ticks(motor) > 1) && (st_run.mot[motor].dir_holdoff != 0))
+    { // direction setup time - keep the phase but don't step yet
+        st_run.mot[motor].dir_holdoff--;
+        return (false);
+    }
+    if (st_run.mot[motor].substep_accumulator > 0)
+    {
+        st_run.mot[motor].substep_accumulator -= st_run.dda_ticks_X_substeps;
+        INCREMENT_ENCODER(motor);
+        return (true);
+    }
+    return (false);
+}
+
+template <uint8_t motor>
+static inline void _dda_pulse_start()
+{
+    if (_dda_pulse_ticks(motor) > 1)
+    {
+        st_run.mot[motor].pulse_downcount = _dda_pulse_ticks(motor);
+    }
+}
+
+template <uint8_t motor>
+static inline uint8_t _dda_step_end(const uint8_t steps) { return (0); }
+
+template <uint8_t motor, typename M, typename... Ms>
+static inline uint8_t _dda_step_end(const uint8_t steps, M &m, Ms &... motors)
+{
+    uint8_t held = 0;
+    if (steps & (1 << motor))
+    {
+        if ((_dda_pulse_ticks(motor) > 1) && (--st_run.mot[motor].pulse_downcount != 0))
+        {
+            held = (1 << motor); // driver needs a longer pulse
+        }
+#if DDA_STEP_PINSET == false
+        else
+        {
+            m.stepEnd();
+        }
+#endif
+    }
+    return (held | _dda_step_end<motor + 1>(steps, motors...));
+}
+
+template <uint8_t motor>
+static inline uint8_t _dda_step_start() { return (0); }
+
+template <uint8_t motor, typename M, typename... Ms>
+static inline uint8_t _dda_step_start(M &m, Ms &... motors)
+{
+    uint8_t steps = 0;
+    if (_dda_fire<motor>())
+    {
+        m.stepStart(); // turn step bit on
+        _dda_pulse_start<motor>();
+        steps = (1 << motor);
+    }
+    return (steps | _dda_step_start<motor + 1>(motors...));
+}
+
+template <uint8_t motor>
+static inline uint8_t _dda_accumulate() { return (0); }
+
+template <uint8_t motor, typename M, typename... Ms>
+static inline uint8_t _dda_accumulate(M &m, Ms &... motors)
+{
+    return ((_dda_fire<motor>() ? (1 << motor) : 0) | _dda_accumulate<motor + 1>(motors...));
+}
+
+template <uint8_t motor>
+static inline uint8_t _dda_write_steps(const uint8_t steps) { return (steps); }
+
+template <uint8_t motor, typename M, typename... Ms>
+static inline uint8_t _dda_write_steps(const uint8_t steps, M &m, Ms &... motors)
+{
+    if (steps & (1 << motor))
+    {
+#if DDA_STEP_PINSET == false
+        m.stepStart();
+#endif
+        _dda_pulse_start<motor>();
+    }
+    return (_dda_write_steps<motor + 1>(steps, motors...));
+}
+
+#if DDA_STEP_PINSET == true
+
+static Motate::PinSet<DDA_STEP_PINS> _step_pins;
+
+static inline void _dda_pins_start(const uint8_t steps)
+{
+    _step_pins.set(steps & ~st_run.step_active_low);
+    _step_pins.clear(steps & st_run.step_active_low);
+}
+
+static inline void _dda_pins_end(const uint8_t steps)
+{
+    _step_pins.clear(steps & ~st_run.step_active_low);
+    _step_pins.set(steps & st_run.step_active_low);
+}
+
+static void _update_step_polarity()
+{
+    uint8_t active_low = 0;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        if (Motors[motor]->getStepPolarity() == IO_ACTIVE_LOW)
+        {
+            active_low |= (1 << motor);
+        }
+    }
+    st_run.step_active_low = active_low;
+}
+
+#else
+
+static inline void _dda_pins_start(const uint8_t steps) {}
+static inline void _dda_pins_end(const uint8_t steps) {}
+
+#endif // DDA_STEP_PINSET
+
+/*
+ * _dda_batch_steps()   - advance one motor's accumulator by ticks in closed form and return its steps
+ * _dda_batch_prepare() - called by the loader; true if the segment just loaded can be batched
+ * _dda_batch_run()     - take the whole running segment at once (DDA_BATCH_SEGMENTS)
+ * _dda_batch_check()   - trap if the per-tick DDA disagrees with the closed form (DDA_BATCH_TRACE)
+ */
+
+#if DDA_BATCH_SEGMENTS == true
+
+static inline int32_t _dda_ramp(const stRunMotor_t *m)
+{
+#if DDA_SEGMENT_RAMP == true
+    return (m->substep_ramp);
+#else
+    return (0);
+#endif
+}
+
+// a ramped segment adds increment + k*ramp on tick k, so the sum is closed form too
+static inline uint32_t _dda_batch_steps(int32_t &accumulator, const uint32_t increment, const int32_t ramp, const uint32_t ticks)
+{
+    int64_t sum = (int64_t)accumulator + (int64_t)ticks * increment + (int64_t)ramp * ticks * (ticks - 1) / 2;
+    uint32_t steps = (sum > 0) ? (uint32_t)((sum + st_run.dda_ticks_X_substeps - 1) / st_run.dda_ticks_X_substeps) : 0;
+    accumulator = (int32_t)(sum - (int64_t)steps * st_run.dda_ticks_X_substeps);
+    return (steps);
+}
+
+static bool _dda_batch_prepare()
+{
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        stRunMotor_t *m = &st_run.mot[motor];
+        if (m->substep_increment == 0)
+        {
+            continue;
+        }
+        if ((m->dir_holdoff != 0) || (m->substep_increment > st_run.dda_ticks_X_substeps) || (m->substep_accumulator > 0))
+        {
+            return (false);
+        }
+    }
+#if DDA_BATCH_TRACE == true
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        st_run.batch_accumulator[motor] = st_run.mot[motor].substep_accumulator;
+        _dda_batch_steps(st_run.batch_accumulator[motor], st_run.mot[motor].substep_increment,
+                         _dda_ramp(&st_run.mot[motor]), st_run.dda_ticks_downcount);
+    }
+#endif
+    return (true);
+}
+
+static void _dda_batch_run()
+{
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        stRunMotor_t *m = &st_run.mot[motor];
+        if (m->substep_increment != 0)
+        {
+            uint32_t steps = _dda_batch_steps(m->substep_accumulator, m->substep_increment, _dda_ramp(m), st_run.dda_ticks_downcount);
+            en.en[motor].steps_run += (int32_t)steps * en.en[motor].step_sign;
+        }
+    }
+    dda_timer.elapsed_ticks = st_run.dda_ticks_downcount;
+    st_run.dda_ticks_downcount = 0;
+}
+
+#if DDA_BATCH_TRACE == true
+static void _dda_batch_check()
+{
+    if (!st_run.batch)
+    {
+        return;
+    }
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        if ((st_run.mot[motor].substep_increment != 0) &&
+            (st_run.mot[motor].substep_accumulator != st_run.batch_accumulator[motor]))
+        {
+            debug_trap("DDA batch closed form disagrees with per-tick DDA");
+        }
+    }
+}
+#endif // DDA_BATCH_TRACE
+
+#endif // DDA_BATCH_SEGMENTS
+
+#if DDA_MICROSTEP_SWITCH == true
+/*
+ * _dda_microstep_switch() - set the microsteps of the motors that switch on this table entry
+ *
+ *  Only runs on ticks flagged with DDA_TABLE_MICROSTEP_BIT, which are rare, so the drivers
+ *  are reached through Motors[]. See _prep_microstep_switch() for where the switch is made.
+ */
+
+static void _dda_microstep_switch(const uint8_t *entry)
+{
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+    {
+        if (st_run.mot[motor].microstep_switch == entry)
+        {
+            Motors[motor]->setMicrosteps(st_cfg.mot[motor].microsteps / st_run.mot[motor].switch_weight);
+        }
+    }
+}
+#endif
+
 /*
  *  DDA定时器中断执行此操作:
  *    - 溢出时开火
@@ -267,118 +788,172 @@ stat_t st_motor_power_callback() // 由控制器调用
  *    - 如果downcount == 0并停止计时器并退出
  *    - 为每个通道运行DDA
  *    - 递减计数 - 如果达到零，则加载下一个段
- *
- *  请注意，motor_N.step.isNull（）测试是编译时测试，而不是运行时测试。
- *  如果未定义motor_N，则{}子句（即该电机）从符合的代码中删除。
  */
 
 namespace Motate
 { // 必须在Motate命名空间内定义计时器中断
 template <>
-void dda_timer_type::interrupt()
+RAMFUNC void dda_timer_type::interrupt()
 {
     dda_timer.getInterruptCause(); //清除中断条件
+    PROFILE_ISR(PROF_DDA);
+    MEM_ISR(MEM_ISR_DDA);
+    sync_dda_tick();
 
-    // 清除上一次中断的所有步骤
-    motor_1.stepEnd();
-    motor_2.stepEnd();
-#if MOTORS > 2
-    motor_3.stepEnd();
-#endif
-#if MOTORS > 3
-    motor_4.stepEnd();
-#endif
-#if MOTORS > 4
-    motor_5.stepEnd();
-#endif
-#if MOTORS > 5
-    motor_6.stepEnd();
-#endif
+    // 清除上一次中断的所有步骤 (only the pins that were actually set, and whose pulse is long enough)
+    if (st_run.step_bits)
+    {
+        uint8_t held = _dda_step_end<MOTOR_1>(st_run.step_bits, DDA_MOTOR_LIST);
+        _dda_pins_end(st_run.step_bits & ~held);
+        st_run.step_bits = held;
+    }
 
     // 在段结束后处理最后一个DDA
     if (st_run.dda_ticks_downcount == 0)
     {
-        dda_timer.stop(); // 把它关掉，否则它会继续走出最后一段
+        if (st_run.step_bits == 0)
+        { // keep ticking until the last long pulses have ended
+            dda_timer.stop(); // 把它关掉，否则它会继续走出最后一段
+            st_run.dda_running = false;
+        }
         return;
     }
 
-    //  以下代码可以使用，但是在M3上循环展开它会更快。也许不是在M7上
-    //    for (uint8_t motor=0; motor<MOTORS; motor++) {
-    //        if  ((st_run.mot[motor].substep_accumulator += st_run.mot[motor].substep_increment) > 0) {
-    //            Motors[motor]->stepStart();        // turn step bit on
-    //            st_run.mot[motor].substep_accumulator -= st_run.dda_ticks_X_substeps;
-    //            INCREMENT_ENCODER(motor);
-    //        }
-    //    }
-
-    // process DDAs for each motor
-    if ((st_run.mot[MOTOR_1].substep_accumulator += st_run.mot[MOTOR_1].substep_increment) > 0)
-    {
-        motor_1.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_1].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_1);
-		//printf("x1,%d\n", st_run.dda_ticks_downcount);
-	}
-	else {
-		//printf("x0,%d\n", st_run.dda_ticks_downcount);
-	}
-    if ((st_run.mot[MOTOR_2].substep_accumulator += st_run.mot[MOTOR_2].substep_increment) > 0)
-    {
-        motor_2.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_2].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_2);
-    }
-#if MOTORS > 2
-    if ((st_run.mot[MOTOR_3].substep_accumulator += st_run.mot[MOTOR_3].substep_increment) > 0)
-    {
-        motor_3.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_3].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_3);
+#if (DDA_BATCH_SEGMENTS == true) && (DDA_BATCH_TRACE == false)
+    if (st_run.batch)
+    { // the whole segment at once - the simulator accounts for the ticks
+        _dda_batch_run();
+        _load_move();
+        return;
     }
 #endif
-#if MOTORS > 3
-    if ((st_run.mot[MOTOR_4].substep_accumulator += st_run.mot[MOTOR_4].substep_increment) > 0)
+
+    // process DDAs for each motor
+#if DDA_STEP_TABLE == true
+#if DDA_MICROSTEP_SWITCH == true
+    uint8_t bits = *st_run.step_table++;
+    if (bits & DDA_TABLE_MICROSTEP_BIT)
     {
-        motor_4.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_4].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_4);
+        _dda_microstep_switch(st_run.step_table - 1);
+        bits &= ~DDA_TABLE_MICROSTEP_BIT;
     }
+    uint8_t steps = _dda_write_steps<MOTOR_1>(bits, DDA_MOTOR_LIST);
+#else
+    uint8_t steps = _dda_write_steps<MOTOR_1>(*st_run.step_table++, DDA_MOTOR_LIST);
 #endif
-#if MOTORS > 4
-    if ((st_run.mot[MOTOR_5].substep_accumulator += st_run.mot[MOTOR_5].substep_increment) > 0)
-    {
-        motor_5.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_5].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_5);
-    }
+    _dda_pins_start(steps);
+    st_run.step_bits |= steps;
+#elif (DDA_PACKED_STEPS == true) || (DDA_STEP_PINSET == true)
+    uint8_t steps = _dda_write_steps<MOTOR_1>(_dda_accumulate<MOTOR_1>(DDA_MOTOR_LIST), DDA_MOTOR_LIST);
+    _dda_pins_start(steps);
+    st_run.step_bits |= steps;
+#else
+    st_run.step_bits |= _dda_step_start<MOTOR_1>(DDA_MOTOR_LIST);
 #endif
-#if MOTORS > 5
-    if ((st_run.mot[MOTOR_6].substep_accumulator += st_run.mot[MOTOR_6].substep_increment) > 0)
+
+    // raster pixels are played from the DDA so they line up with the steps
+    if (st_run.raster_increment && ((st_run.raster_accumulator += st_run.raster_increment) >= RASTER_PIXEL_ONE))
     {
-        motor_6.stepStart(); // turn step bit on
-        st_run.mot[MOTOR_6].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_6);
+        if (!raster_advance(st_run.raster_accumulator >> RASTER_PIXEL_SHIFT))
+        {
+            st_run.raster_increment = 0;    // end of the raster line
+        }
+        st_run.raster_accumulator &= (RASTER_PIXEL_ONE - 1);
     }
-#endif
 
     // 处理段的结束。
     //在此过程中设置的任何脉冲都会发生一次中断。
     if (--st_run.dda_ticks_downcount == 0)
     {
+#if (DDA_BATCH_SEGMENTS == true) && (DDA_BATCH_TRACE == true)
+        _dda_batch_check();
+#endif
         _load_move(); // 在当前中断级别加载下一步移动
     }
 } // MOTATE_TIMER_INTERRUPT
 } // namespace Motate
 
+/*
+ * st_get_step_position() - step position of each motor at the current DDA tick
+ *
+ *  Used by en_take_encoder_snapshot() from the probe and homing input interrupts. The
+ *  position is the encoder count plus the steps taken so far in the running segment. The
+ *  DDA counts every step into steps_run as it fires, so this is exact to the DDA tick. With
+ *  DDA_STEP_TABLE the loader counts the whole segment up front, so the steps still waiting
+ *  in the table are taken back off.
+ *
+ *  The DDA interrupt runs at a higher priority than the inputs and may tick or load a
+ *  segment under us, so the read is repeated until the tick count (and table) is the same
+ *  before and after. With DDA_BATCH_SEGMENTS a batched segment runs in one call and is
+ *  never seen part way.
+ */
+
+void st_get_step_position(int32_t steps[])
+{
+    const volatile uint32_t *downcount = &st_run.dda_ticks_downcount;  // read through volatile here only
+    uint32_t ticks;
+#if DDA_STEP_TABLE == true
+    const uint8_t *const volatile *step_table = &st_run.step_table;
+    const uint8_t *table;
+    do {
+        ticks = *downcount;
+        table = *step_table;
+        int32_t unplayed[MOTORS] = {0};
+        for (uint32_t tick = 0; tick < ticks; tick++)
+        {
+            uint8_t bits = table[tick] & ~DDA_TABLE_MICROSTEP_BIT;
+            for (uint8_t motor = 0; bits != 0; motor++, bits >>= 1)
+            {
+#if DDA_MICROSTEP_SWITCH == true
+                const uint8_t *sw = st_run.mot[motor].microstep_switch;
+                if (bits & 1)
+                {
+                    unplayed[motor] += ((sw == nullptr) || (&table[tick] < sw)) ? st_run.mot[motor].step_weight
+                                                                                : st_run.mot[motor].switch_weight;
+                }
+#else
+                unplayed[motor] += (bits & 1);
+#endif
+            }
+        }
+        for (uint8_t motor = 0; motor < MOTORS; motor++)
+        {
+            int32_t run = en.en[motor].steps_run;
+            run = (run < 0) ? (run + unplayed[motor]) : (run - unplayed[motor]);
+            steps[motor] = en.en[motor].encoder_steps + run;
+        }
+    } while ((ticks != *downcount) || (table != *step_table));
+#else
+    do {
+        ticks = *downcount;
+        for (uint8_t motor = 0; motor < MOTORS; motor++)
+        {
+            steps[motor] = en.en[motor].encoder_steps + en.en[motor].steps_run;
+        }
+    } while (ticks != *downcount);
+#endif
+}
+
 /****************************************************************************************
  * Exec 测序代码   - 计算并准备下一个负载段
  * st_request_exec_move() - 请求执行移动的SW中断
  * exec_timer interrupt   - 用于调用exec函数的中断处理程序
+ *
+ *  The exec interrupt keeps preparing segments until the prep ring is full or the planner
+ *  has nothing more to run. Each prepared slot is handed to the loader as soon as it is done.
+ *
+ *  A command block stays at the head of the planner queue until the loader runs it, so
+ *  exec stops filling the ring behind a staged command. Otherwise the next pass would
+ *  stage the same command again into the following slot.
  */
 
 void st_request_exec_move()
 {
-    if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC)
+    if (st_pre.null_sink)
+    {
+        return;
+    }
+    if (st_pre.seg[st_pre.exec_slot].buffer_state == PREP_BUFFER_OWNED_BY_EXEC)
     { //打扰中断
         exec_timer.setInterruptPending();
         return;
@@ -391,18 +966,46 @@ template <>
 void exec_timer_type::interrupt()
 {
     exec_timer.getInterruptCause();                       // 清除中断条件
-    if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) // 正在加载临时缓冲区
+    PROFILE_ISR(PROF_EXEC);
+    MEM_ISR(MEM_ISR_EXEC);
+    while (st_pre.seg[st_pre.exec_slot].buffer_state == PREP_BUFFER_OWNED_BY_EXEC) // 正在加载临时缓冲区
     {
-        if (mp_exec_move() != STAT_NOOP)
+        stPrepSegment_t *last = &st_pre.seg[_prev_prep_slot(st_pre.exec_slot)];
+        if ((last->buffer_state == PREP_BUFFER_OWNED_BY_LOADER) && (last->block_type == BLOCK_TYPE_COMMAND))
+        { // the loader frees the command's planner buffer - exec is re-requested after it loads
+            return;
+        }
+        if (mp_exec_move() == STAT_NOOP)
         {
-            st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // 临时缓冲区已准备好加载
-            st_request_load_move();
             return;
         }
+        uint8_t slot = st_pre.exec_slot;
+        st_pre.exec_slot = _next_prep_slot(slot);
+        st_pre.seg[slot].buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // 临时缓冲区已准备好加载
+        st_request_load_move();
     }
 }
 } // namespace Motate
 
+/****************************************************************************************
+ * st_set_null_sink() - stop the stepper interrupts from picking up work
+ *
+ *  With the sink on, forward plan, exec and load requests are ignored. Whoever set it calls
+ *  mp_forward_plan() and mp_exec_move() directly; st_prep_line() still does all of its work
+ *  into the exec slot, but the slot is never handed to the loader, so the next segment
+ *  overwrites it and no motor ever steps. Turning it off resets the stepper. Used by the
+ *  on-target benchmarks (benchmark.h). Only set it with the runtime idle.
+ */
+
+void st_set_null_sink(const bool null_sink)
+{
+    st_pre.null_sink = null_sink;
+    if (!null_sink)
+    {
+        stepper_reset(); // nothing prepared into the sink may ever load
+    }
+}
+
 /****************************************************************************************
  * st_request_forward_plan  - 对倒数第二个块执行前瞻规划
  * fwd_plan interrupt       - 用于调用前向规划功能的中断处理程序
@@ -410,6 +1013,10 @@ void exec_timer_type::interrupt()
 
 void st_request_forward_plan()
 {
+    if (st_pre.null_sink)
+    {
+        return;
+    }
     fwd_plan_timer.setInterruptPending();
 }
 
@@ -419,6 +1026,8 @@ template <>
 void fwd_plan_timer_type::interrupt() //前向规划
 {
     fwd_plan_timer.getInterruptCause(); // 清除中断条件
+    PROFILE_ISR(PROF_FWD_PLAN);
+    MEM_ISR(MEM_ISR_FWD_PLAN);
     if (mp_forward_plan() != STAT_NOOP)
     { // 我们现在转向执行。
         st_request_exec_move();
@@ -439,16 +1048,32 @@ void fwd_plan_timer_type::interrupt() //前向规划
 
 void st_request_load_move()
 {
-    if (st_runtime_isbusy())
+    if (st_pre.null_sink || st_runtime_isbusy())
     { // 如果运行时忙，则不请求加载
         return;
     }
-    if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_LOADER)
+    if (st_pre.seg[st_pre.load_slot].buffer_state == PREP_BUFFER_OWNED_BY_LOADER)
     { // 打扰中断
         _load_move();
     }
 }
 
+/*
+ * st_sync_tick() - sync follower: start a loaded segment, or bring the running DDA into phase
+ *
+ *  Called from the tick input's ISR. Restarting the timer starts its period over, so
+ *  the follower's ticks line up with the leader's pulse.
+ */
+
+void st_sync_tick()
+{
+    if (st_run.dda_running || (st_run.dda_ticks_downcount != 0))
+    {
+        st_run.dda_running = true;
+        dda_timer.start();
+    }
+}
+
 /****************************************************************************************
  * _load_move() - 将移动和加载到步进器运行时结构中
  *
@@ -462,44 +1087,54 @@ void st_request_load_move()
  *  - 如果轴有0步，则必须根据功率模式设置电机功率
  */
 
-static void _load_move()
+static RAMFUNC void _load_move()
 {
+    PROFILE_CALL(PROF_LOAD);
     //请注意，dda_ticks_downcount必须等于零才能运行加载程序。
     //因此初始加载也必须将此设置为零作为初始化的一部分
     if (st_runtime_isbusy()) //st_run.dda_ticks_downcount || st_run.dwell_ticks_downcount
     {
         return; // exit if the runtime is busy
     }
+    if (st_run.actions != 0)
+    { // the segment that carried them has ended
+        uint8_t actions = st_run.actions;
+        st_run.actions = 0;
+        mp_runtime_actions(st_run.action_first, actions);
+    }
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.load_slot];
 
     // 如果没有动作加载启动电机电源超时
-    if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER) //!=临时缓冲区已准备好加载
+    if (seg->buffer_state != PREP_BUFFER_OWNED_BY_LOADER) //!=临时缓冲区已准备好加载
     {
-        motor_1.motionStopped(); // ...启动电机功率超时
-        motor_2.motionStopped();
-#if (MOTORS > 2)
-        motor_3.motionStopped();
-#endif
-#if (MOTORS > 3)
-        motor_4.motionStopped();
-#endif
-#if (MOTORS > 4)
-        motor_5.motionStopped();
-#endif
-#if (MOTORS > 5)
-        motor_6.motionStopped();
-#endif
+        if ((seg->buffer_state == PREP_BUFFER_OWNED_BY_EXEC) && mp_has_runnable_buffer(mp)) {
+            PROFILE_EXEC_OVERRUN();     // exec did not finish the next segment in time
+        }
+        if (!st_run.motors_idle)
+        { // only once per idle period - the loader is called again and again while it is idle
+            st_run.motors_idle = true;
+            for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+            {
+                st_run.mot[motor].motion_state = MOTOR_MOTION_UNKNOWN;
+                Motors[motor]->motionStopped(); // ...启动电机功率超时
+            }
+        }
         return;
-    } // if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER)
+    } // if (seg->buffer_state != PREP_BUFFER_OWNED_BY_LOADER)
 
     // 首先处理aline负载（最常见的情况）
-    if (st_pre.block_type == BLOCK_TYPE_ALINE)
+    if (seg->block_type == BLOCK_TYPE_ALINE)
     {
 
         //**** 建立新的段 ****
 
         //debug_trap_if_true((st_run.dda_ticks_downcount != 0), "_load_move() 向下计数不为零");
-        st_run.dda_ticks_downcount = st_pre.dda_ticks;
-        st_run.dda_ticks_X_substeps = st_pre.dda_ticks_X_substeps;
+        st_run.dda_ticks_downcount = seg->dda_ticks;
+        st_run.dda_ticks_X_substeps = seg->dda_ticks_X_substeps;
+        st_run.motors_idle = false;
+        st_run.raster_increment = seg->raster.increment;
+        st_run.raster_accumulator = seg->raster.phase;
+        raster_load(&seg->raster);
 		
         // INLINED VERSION: 4.3us
         //**** MOTOR_1 LOAD ****
@@ -508,7 +1143,7 @@ static void _load_move()
         //应该采用<5 uSec（Arm M3核心）。 如果你搞砸这个，要小心。
 
         // 以下if（）语句设置运行时子步增量值或将其归零
-        if ((st_run.mot[MOTOR_1].substep_increment = st_pre.mot[MOTOR_1].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_1].substep_increment = seg->mot[MOTOR_1].substep_increment) != 0)
         {
 
             //注意：如果电机有0步，则全部跳过。 这确保了状态比较
@@ -516,176 +1151,246 @@ static void _load_move()
             //段可能在两者之间处于非活动状态。
 
             // 如果自上一段以来时基已更改，则应用累加器校正
-            if (st_pre.mot[MOTOR_1].accumulator_correction_flag == true)//信号累加器需要校正
+            if (seg->mot[MOTOR_1].accumulator_correction_flag == true)//信号累加器需要校正
             {
-                st_pre.mot[MOTOR_1].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_1].substep_accumulator *= st_pre.mot[MOTOR_1].accumulator_correction;
+                seg->mot[MOTOR_1].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_1].substep_accumulator *= seg->mot[MOTOR_1].accumulator_correction;
             }
 
             //检测方向变化，如果是，
             //在硬件中设置方向位。
             //通过翻转子步骤累加器值关于其中点来补偿方向变化。
 
-            if (st_pre.mot[MOTOR_1].direction != st_pre.mot[MOTOR_1].prev_direction)
+            if (seg->mot[MOTOR_1].direction != st_pre.mot[MOTOR_1].prev_direction)
             {
-                st_pre.mot[MOTOR_1].prev_direction = st_pre.mot[MOTOR_1].direction;
+                st_pre.mot[MOTOR_1].prev_direction = seg->mot[MOTOR_1].direction;
                 st_run.mot[MOTOR_1].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_1].substep_accumulator);
-                motor_1.setDirection(st_pre.mot[MOTOR_1].direction);
+                motor_1.setDirection(seg->mot[MOTOR_1].direction);
+                st_run.mot[MOTOR_1].dir_holdoff = _dda_dir_ticks(MOTOR_1) - 1;
             }
 
             // Enable the stepper and start/update motor power management
-            motor_1.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_1, st_pre.mot[MOTOR_1].step_sign);
+            if (st_run.mot[MOTOR_1].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_1].motion_state = MOTOR_MOTION_STEPPING;
+                motor_1.enable();
+            }
+            SET_ENCODER_STEP_SIGN(MOTOR_1, seg->mot[MOTOR_1].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_1].motion_state != MOTOR_MOTION_STOPPED)
         { // 电机有0步; 可能需要激励电机进行电源模式处理
+            st_run.mot[MOTOR_1].motion_state = MOTOR_MOTION_STOPPED;
             motor_1.motionStopped();
         }
         // 累计计数步骤到步骤位置，并将当前正在加载的段的计数步骤归零
         ACCUMULATE_ENCODER(MOTOR_1);
 
 #if (MOTORS >= 2)
-        if ((st_run.mot[MOTOR_2].substep_increment = st_pre.mot[MOTOR_2].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_2].substep_increment = seg->mot[MOTOR_2].substep_increment) != 0)
         {
-            if (st_pre.mot[MOTOR_2].accumulator_correction_flag == true)
+            if (seg->mot[MOTOR_2].accumulator_correction_flag == true)
             {
-                st_pre.mot[MOTOR_2].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_2].substep_accumulator *= st_pre.mot[MOTOR_2].accumulator_correction;
+                seg->mot[MOTOR_2].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_2].substep_accumulator *= seg->mot[MOTOR_2].accumulator_correction;
             }
-            if (st_pre.mot[MOTOR_2].direction != st_pre.mot[MOTOR_2].prev_direction)
+            if (seg->mot[MOTOR_2].direction != st_pre.mot[MOTOR_2].prev_direction)
             {
-                st_pre.mot[MOTOR_2].prev_direction = st_pre.mot[MOTOR_2].direction;
+                st_pre.mot[MOTOR_2].prev_direction = seg->mot[MOTOR_2].direction;
                 st_run.mot[MOTOR_2].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_2].substep_accumulator);
-                motor_2.setDirection(st_pre.mot[MOTOR_2].direction);
+                motor_2.setDirection(seg->mot[MOTOR_2].direction);
+                st_run.mot[MOTOR_2].dir_holdoff = _dda_dir_ticks(MOTOR_2) - 1;
+            }
+            if (st_run.mot[MOTOR_2].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_2].motion_state = MOTOR_MOTION_STEPPING;
+                motor_2.enable();
             }
-            motor_2.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_2, st_pre.mot[MOTOR_2].step_sign);
+            SET_ENCODER_STEP_SIGN(MOTOR_2, seg->mot[MOTOR_2].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_2].motion_state != MOTOR_MOTION_STOPPED)
         {
+            st_run.mot[MOTOR_2].motion_state = MOTOR_MOTION_STOPPED;
             motor_2.motionStopped();
         }
         ACCUMULATE_ENCODER(MOTOR_2);
 #endif
 #if (MOTORS >= 3)
-        if ((st_run.mot[MOTOR_3].substep_increment = st_pre.mot[MOTOR_3].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_3].substep_increment = seg->mot[MOTOR_3].substep_increment) != 0)
         {
-            if (st_pre.mot[MOTOR_3].accumulator_correction_flag == true)
+            if (seg->mot[MOTOR_3].accumulator_correction_flag == true)
             {
-                st_pre.mot[MOTOR_3].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_3].substep_accumulator *= st_pre.mot[MOTOR_3].accumulator_correction;
+                seg->mot[MOTOR_3].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_3].substep_accumulator *= seg->mot[MOTOR_3].accumulator_correction;
             }
-            if (st_pre.mot[MOTOR_3].direction != st_pre.mot[MOTOR_3].prev_direction)
+            if (seg->mot[MOTOR_3].direction != st_pre.mot[MOTOR_3].prev_direction)
             {
-                st_pre.mot[MOTOR_3].prev_direction = st_pre.mot[MOTOR_3].direction;
+                st_pre.mot[MOTOR_3].prev_direction = seg->mot[MOTOR_3].direction;
                 st_run.mot[MOTOR_3].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_3].substep_accumulator);
-                motor_3.setDirection(st_pre.mot[MOTOR_3].direction);
+                motor_3.setDirection(seg->mot[MOTOR_3].direction);
+                st_run.mot[MOTOR_3].dir_holdoff = _dda_dir_ticks(MOTOR_3) - 1;
+            }
+            if (st_run.mot[MOTOR_3].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_3].motion_state = MOTOR_MOTION_STEPPING;
+                motor_3.enable();
             }
-            motor_3.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_3, st_pre.mot[MOTOR_3].step_sign);
+            SET_ENCODER_STEP_SIGN(MOTOR_3, seg->mot[MOTOR_3].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_3].motion_state != MOTOR_MOTION_STOPPED)
         {
+            st_run.mot[MOTOR_3].motion_state = MOTOR_MOTION_STOPPED;
             motor_3.motionStopped();
         }
         ACCUMULATE_ENCODER(MOTOR_3);
 #endif
 #if (MOTORS >= 4)
-        if ((st_run.mot[MOTOR_4].substep_increment = st_pre.mot[MOTOR_4].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_4].substep_increment = seg->mot[MOTOR_4].substep_increment) != 0)
         {
-            if (st_pre.mot[MOTOR_4].accumulator_correction_flag == true)
+            if (seg->mot[MOTOR_4].accumulator_correction_flag == true)
             {
-                st_pre.mot[MOTOR_4].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_4].substep_accumulator *= st_pre.mot[MOTOR_4].accumulator_correction;
+                seg->mot[MOTOR_4].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_4].substep_accumulator *= seg->mot[MOTOR_4].accumulator_correction;
             }
-            if (st_pre.mot[MOTOR_4].direction != st_pre.mot[MOTOR_4].prev_direction)
+            if (seg->mot[MOTOR_4].direction != st_pre.mot[MOTOR_4].prev_direction)
             {
-                st_pre.mot[MOTOR_4].prev_direction = st_pre.mot[MOTOR_4].direction;
+                st_pre.mot[MOTOR_4].prev_direction = seg->mot[MOTOR_4].direction;
                 st_run.mot[MOTOR_4].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_4].substep_accumulator);
-                motor_4.setDirection(st_pre.mot[MOTOR_4].direction);
+                motor_4.setDirection(seg->mot[MOTOR_4].direction);
+                st_run.mot[MOTOR_4].dir_holdoff = _dda_dir_ticks(MOTOR_4) - 1;
+            }
+            if (st_run.mot[MOTOR_4].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_4].motion_state = MOTOR_MOTION_STEPPING;
+                motor_4.enable();
             }
-            motor_4.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_4, st_pre.mot[MOTOR_4].step_sign);
+            SET_ENCODER_STEP_SIGN(MOTOR_4, seg->mot[MOTOR_4].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_4].motion_state != MOTOR_MOTION_STOPPED)
         {
+            st_run.mot[MOTOR_4].motion_state = MOTOR_MOTION_STOPPED;
             motor_4.motionStopped();
         }
         ACCUMULATE_ENCODER(MOTOR_4);
 #endif
 #if (MOTORS >= 5)
-        if ((st_run.mot[MOTOR_5].substep_increment = st_pre.mot[MOTOR_5].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_5].substep_increment = seg->mot[MOTOR_5].substep_increment) != 0)
         {
-            if (st_pre.mot[MOTOR_5].accumulator_correction_flag == true)
+            if (seg->mot[MOTOR_5].accumulator_correction_flag == true)
             {
-                st_pre.mot[MOTOR_5].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_5].substep_accumulator *= st_pre.mot[MOTOR_5].accumulator_correction;
+                seg->mot[MOTOR_5].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_5].substep_accumulator *= seg->mot[MOTOR_5].accumulator_correction;
             }
-            if (st_pre.mot[MOTOR_5].direction != st_pre.mot[MOTOR_5].prev_direction)
+            if (seg->mot[MOTOR_5].direction != st_pre.mot[MOTOR_5].prev_direction)
             {
-                st_pre.mot[MOTOR_5].prev_direction = st_pre.mot[MOTOR_5].direction;
+                st_pre.mot[MOTOR_5].prev_direction = seg->mot[MOTOR_5].direction;
                 st_run.mot[MOTOR_5].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_5].substep_accumulator);
-                motor_5.setDirection(st_pre.mot[MOTOR_5].direction);
+                motor_5.setDirection(seg->mot[MOTOR_5].direction);
+                st_run.mot[MOTOR_5].dir_holdoff = _dda_dir_ticks(MOTOR_5) - 1;
             }
-            motor_5.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_5, st_pre.mot[MOTOR_5].step_sign);
+            if (st_run.mot[MOTOR_5].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_5].motion_state = MOTOR_MOTION_STEPPING;
+                motor_5.enable();
+            }
+            SET_ENCODER_STEP_SIGN(MOTOR_5, seg->mot[MOTOR_5].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_5].motion_state != MOTOR_MOTION_STOPPED)
         {
+            st_run.mot[MOTOR_5].motion_state = MOTOR_MOTION_STOPPED;
             motor_5.motionStopped();
         }
         ACCUMULATE_ENCODER(MOTOR_5);
 #endif
 #if (MOTORS >= 6)
-        if ((st_run.mot[MOTOR_6].substep_increment = st_pre.mot[MOTOR_6].substep_increment) != 0)
+        if ((st_run.mot[MOTOR_6].substep_increment = seg->mot[MOTOR_6].substep_increment) != 0)
         {
-            if (st_pre.mot[MOTOR_6].accumulator_correction_flag == true)
+            if (seg->mot[MOTOR_6].accumulator_correction_flag == true)
             {
-                st_pre.mot[MOTOR_6].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_6].substep_accumulator *= st_pre.mot[MOTOR_6].accumulator_correction;
+                seg->mot[MOTOR_6].accumulator_correction_flag = false;
+                st_run.mot[MOTOR_6].substep_accumulator *= seg->mot[MOTOR_6].accumulator_correction;
             }
-            if (st_pre.mot[MOTOR_6].direction != st_pre.mot[MOTOR_6].prev_direction)
+            if (seg->mot[MOTOR_6].direction != st_pre.mot[MOTOR_6].prev_direction)
             {
-                st_pre.mot[MOTOR_6].prev_direction = st_pre.mot[MOTOR_6].direction;
+                st_pre.mot[MOTOR_6].prev_direction = seg->mot[MOTOR_6].direction;
                 st_run.mot[MOTOR_6].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_6].substep_accumulator);
-                motor_6.setDirection(st_pre.mot[MOTOR_6].direction);
+                motor_6.setDirection(seg->mot[MOTOR_6].direction);
+                st_run.mot[MOTOR_6].dir_holdoff = _dda_dir_ticks(MOTOR_6) - 1;
+            }
+            if (st_run.mot[MOTOR_6].motion_state != MOTOR_MOTION_STEPPING)
+            {
+                st_run.mot[MOTOR_6].motion_state = MOTOR_MOTION_STEPPING;
+                motor_6.enable();
             }
-            motor_6.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_6, st_pre.mot[MOTOR_6].step_sign);
+            SET_ENCODER_STEP_SIGN(MOTOR_6, seg->mot[MOTOR_6].step_sign);
         }
-        else
+        else if (st_run.mot[MOTOR_6].motion_state != MOTOR_MOTION_STOPPED)
         {
+            st_run.mot[MOTOR_6].motion_state = MOTOR_MOTION_STOPPED;
             motor_6.motionStopped();
         }
         ACCUMULATE_ENCODER(MOTOR_6);
 #endif
 
+#if DDA_SEGMENT_RAMP == true
+        for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+        {
+            st_run.mot[motor].substep_ramp = seg->mot[motor].substep_ramp;
+        }
+#endif
+#if DDA_STEP_TABLE == true
+        // the table already holds the steps of the segment, so count them into the encoders now
+        st_run.step_table = seg->step_table;
+        for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
+        {
+            LOAD_ENCODER_STEPS(motor, seg->mot[motor].table_steps);
+#if DDA_MICROSTEP_SWITCH == true
+            stRunMotor_t *m = &st_run.mot[motor];
+            m->microstep_switch = seg->mot[motor].microstep_tick ? &seg->step_table[seg->mot[motor].microstep_tick] : nullptr;
+            m->step_weight = seg->mot[motor].step_weight;
+            m->switch_weight = seg->mot[motor].switch_weight;
+#endif
+        }
+#endif
+#if DDA_BATCH_SEGMENTS == true
+        st_run.batch = _dda_batch_prepare();
+#endif
+        MOTION_TRACE_LOAD(st_pre.load_slot, seg->dda_ticks);
+
         // ****最后这个****
 		printf("downcount=%d,X_substeps=%d,accumulator=%d,increment=%d\n", 
 			st_run.dda_ticks_downcount,
 			st_run.dda_ticks_X_substeps, 
 			st_run.mot[MOTOR_1].substep_accumulator, 
 			st_run.mot[MOTOR_1].substep_increment);
-        dda_timer.start(); //如果尚未运行，则启动DDA计时器
+        if (st_run.dda_running || sync_dda_start())
+        { // a sync follower's segment waits for the leader's tick (see st_sync_tick())
+            st_run.dda_running = true;
+            dda_timer.start(); //如果尚未运行，则启动DDA计时器
+        }
 
         // 处理暂停和命令
     }
-    else if (st_pre.block_type == BLOCK_TYPE_DWELL)
+    else if (seg->block_type == BLOCK_TYPE_DWELL)
     {
-        st_run.dwell_ticks_downcount = st_pre.dwell_ticks;
+        st_run.dwell_ticks_downcount = seg->dwell_ticks;
+        st_run.dwell_release = seg->dwell_release;
         SysTickTimer.registerEvent(&dwell_systick_event); // We now use SysTick events to handle dwells
 
         // 处理同步命令
     }
-    else if (st_pre.block_type == BLOCK_TYPE_COMMAND)
+    else if (seg->block_type == BLOCK_TYPE_COMMAND)
     {
-        mp_runtime_command(st_pre.bf);
+        mp_runtime_command(seg->bf);
 
     } // else null - 在许多情况下这没关系
 
     // 所有其他情况下降到此处（例如，在M代码跳到此处后，Null移动）
-    st_pre.block_type = BLOCK_TYPE_NULL;             //空着 - 做一个空操作
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC; // 正在加载临时缓冲区
+    st_run.action_first = seg->action_first;         // run at the next load, when this segment has ended
+    st_run.actions = seg->actions;
+    seg->actions = 0;
+    seg->block_type = BLOCK_TYPE_NULL;               //空着 - 做一个空操作
+    st_pre.load_slot = _next_prep_slot(st_pre.load_slot);
+    seg->buffer_state = PREP_BUFFER_OWNED_BY_EXEC;   // 正在加载临时缓冲区
     st_request_exec_move();                          // 执行并准备下一步行动
 }
 
@@ -708,15 +1413,19 @@ static void _load_move()
  *  -  segment_time  - 段应运行多少分钟。如果时机不是
  * 100％准确，这将影响移动速度，但不会影响行进距离。
  *
+ *  -  segment_ramp - velocity change across the segment as a fraction of its mean velocity
+ *     (end minus start over mean, within +/-2). Only used with DDA_SEGMENT_RAMP.
+ *
  *注意：许多表达式对于转换和执行顺序都很敏感，以避免长期
  *由于浮点舍入导致的精度误差。之前的失败尝试是：
  * dda_ticks_X_substeps =（int32_t）（（微秒/ 1000000）* f_dda * dda_substeps）;
  */
 
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time)
+RAMFUNC stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time, const float segment_ramp)
 {
     // trap assertion failures and other conditions that would prevent queuing the line
-    if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_EXEC)
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.exec_slot];
+    if (seg->buffer_state != PREP_BUFFER_OWNED_BY_EXEC)
     { // never supposed to happen
         return (cm_panic(STAT_INTERNAL_ERROR, "st_prep_line() prep sync error"));
     }
@@ -732,8 +1441,20 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
     // - dda_ticks is the integer number of DDA clock ticks needed to play out the segment
     // - ticks_X_substeps is the maximum depth of the DDA accumulator (as a negative number)
 
-    st_pre.dda_ticks = (int32_t)(segment_time * 60 * FREQUENCY_DDA); // NB: converts minutes to seconds
-    st_pre.dda_ticks_X_substeps = st_pre.dda_ticks * DDA_SUBSTEPS;
+    seg->dda_ticks = (int32_t)(segment_time * 60 * FREQUENCY_DDA); // NB: converts minutes to seconds
+    seg->dda_ticks_X_substeps = seg->dda_ticks * DDA_SUBSTEPS;
+
+    // The following error is measured against the start of the previously prepped segment, but the
+    // encoder is only as far as the start of the running segment. Add back the commanded travel of
+    // the running segment and of any segments still queued ahead of the previous prep.
+    float queued_steps[MOTORS] = {0};
+    for (uint8_t s = _prev_prep_slot(st_pre.load_slot); s != _prev_prep_slot(st_pre.exec_slot); s = _next_prep_slot(s))
+    {
+        for (uint8_t motor = 0; motor < MOTORS; motor++)
+        {
+            queued_steps[motor] += st_pre.seg[s].mot[motor].travel_steps;
+        }
+    }
 
     // setup motor parameters
 
@@ -742,9 +1463,13 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
     { // remind us that this is motors, not axes
 
         // Skip this motor if there are no new steps. Leave all other values intact.
+        seg->mot[motor].travel_steps = travel_steps[motor];
+#if DDA_SEGMENT_RAMP == true
+        seg->mot[motor].substep_ramp = 0;
+#endif
         if (fp_ZERO(travel_steps[motor]))
         {
-            st_pre.mot[motor].substep_increment = 0; // substep increment also acts as a motor flag
+            seg->mot[motor].substep_increment = 0; // substep increment also acts as a motor flag
             continue;
         }
 
@@ -753,25 +1478,26 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
 
         if (travel_steps[motor] >= 0)
         { // positive direction
-            st_pre.mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
-            st_pre.mot[motor].step_sign = 1;
+            seg->mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
+            seg->mot[motor].step_sign = 1;
         }
         else
         {
-            st_pre.mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
-            st_pre.mot[motor].step_sign = -1;
+            seg->mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
+            seg->mot[motor].step_sign = -1;
         }
 
         // Detect segment time changes and setup the accumulator correction factor and flag.
         // Putting this here computes the correct factor even if the motor was dormant for some number
         // of previous moves. Correction is computed based on the last segment time actually used.
 
+        seg->mot[motor].accumulator_correction_flag = false;
         if (fabs(segment_time - st_pre.mot[motor].prev_segment_time) > 0.0000001)
         { // highly tuned FP != compare
             if (fp_NOT_ZERO(st_pre.mot[motor].prev_segment_time))
             { // special case to skip first move
-                st_pre.mot[motor].accumulator_correction_flag = true;
-                st_pre.mot[motor].accumulator_correction = segment_time / st_pre.mot[motor].prev_segment_time;
+                seg->mot[motor].accumulator_correction_flag = true;
+                seg->mot[motor].accumulator_correction = segment_time / st_pre.mot[motor].prev_segment_time;
             }
             st_pre.mot[motor].prev_segment_time = segment_time;
         }
@@ -779,12 +1505,14 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
         // 'Nudge' correction strategy. Inject a single, scaled correction value then hold off
         // NOTE: This clause can be commented out to test for numerical accuracy and accumulating errors
 
+        // Injected backlash steps are counted by the encoder but are not part of the commanded steps
+        float error = following_error[motor] + queued_steps[motor] - st_pre.mot[motor].backlash_steps;
         if ((--st_pre.mot[motor].correction_holdoff < 0) &&
-            (fabs(following_error[motor]) > STEP_CORRECTION_THRESHOLD))
+            (fabs(error) > STEP_CORRECTION_THRESHOLD))
         {
 
             st_pre.mot[motor].correction_holdoff = STEP_CORRECTION_HOLDOFF;
-            correction_steps = following_error[motor] * STEP_CORRECTION_FACTOR;
+            correction_steps = error * STEP_CORRECTION_FACTOR;
 
             if (correction_steps > 0)
             {
@@ -798,17 +1526,294 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
             travel_steps[motor] -= correction_steps;
         }
 
+        if (st_cfg.mot[motor].backlash > 0)
+        {
+            float backlash_steps = _prep_backlash(motor, travel_steps[motor], seg->dda_ticks);
+            travel_steps[motor] += backlash_steps;
+            seg->mot[motor].travel_steps += backlash_steps;
+        }
+
         // Compute substeb increment. The accumulator must be *exactly* the incoming
         // fractional steps times the substep multiplier or positional drift will occur.
         // Rounding is performed to eliminate a negative bias in the uint32 conversion
         // that results in long-term negative drift. (fabs/round order doesn't matter)
 
-        st_pre.mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS));
+#if DDA_MICROSTEP_SWITCH == true
+        // the increment is in steps of the driver's current microsteps; the rate picks the next ones
+        float rate = fabs(travel_steps[motor]) / seg->dda_ticks;
+        if (rate > STEP_MICROSTEP_COARSE_RATE)
+        {
+            st_pre.mot[motor].wanted_weight = st_cfg.mot[motor].microstep_weight;
+        }
+        else if (rate < STEP_MICROSTEP_FINE_RATE)
+        {
+            st_pre.mot[motor].wanted_weight = 1;
+        }
+        seg->mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS) / st_pre.mot[motor].step_weight);
+#else
+        seg->mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS));
+#endif
+#if DDA_SEGMENT_RAMP == true
+        _prep_ramp(seg, &seg->mot[motor], segment_ramp);
+#endif
+    }
+#if DDA_STEP_TABLE == true
+    ritorno(_prep_step_table(seg));
+#endif
+    MOTION_TRACE_PREP(st_pre.exec_slot, travel_steps, segment_time);
+    seg->block_type = BLOCK_TYPE_ALINE;                // exec interrupt hands the slot to the loader
+    return (STAT_OK);
+}
+
+/*
+ * _prep_backlash() - backlash steps to add to a moving motor's segment travel
+ *
+ *  The motor is kept backlash steps ahead of the axis while moving positive, and level
+ *  with it while moving negative. After a reversal the difference is made up in the new
+ *  direction at up to STEP_BACKLASH_MAX steps per segment (and never more than the DDA can
+ *  step), so the planner and runtime never see it. The first move after a position set
+ *  is taken to have the backlash already taken up in its direction.
+ */
+
+static float _prep_backlash(const uint8_t motor, const float travel, const int32_t dda_ticks)
+{
+    stPrepMotor_t *m = &st_pre.mot[motor];
+    float backlash = st_cfg.mot[motor].backlash * st_cfg.mot[motor].steps_per_unit;
+    float target = (travel > 0) ? backlash : 0;
+
+    if (!m->backlash_known)
+    {
+        m->backlash_known = true;
+        m->backlash_offset = target;
+        return (0);
+    }
+    float room = max((float)dda_ticks - (float)fabs(travel), (float)0);
+    float steps = target - m->backlash_offset;
+    if (travel > 0)
+    {
+        steps = min3(steps, STEP_BACKLASH_MAX, room);
+        steps = max(steps, (float)0);               // backlash was lowered - let it go
+    }
+    else
+    {
+        steps = max3(steps, -STEP_BACKLASH_MAX, -room);
+        steps = min(steps, (float)0);
+    }
+    m->backlash_offset = min(m->backlash_offset + steps, backlash);
+    m->backlash_steps += steps;
+    return (steps);
+}
+
+#if DDA_SEGMENT_RAMP == true
+/*
+ * _prep_ramp() - turn a segment's velocity ramp into a start increment and per-tick change
+ *
+ *  Over N ticks the increments inc_0 + k*ramp add up to N*inc_0 + ramp*N(N-1)/2, which must
+ *  equal N*inc for the segment to end on its travel. ramp is kept even when N-1 is odd so
+ *  inc_0 = inc - ramp*(N-1)/2 is exact. The ramp is limited so neither end of the segment
+ *  goes below zero or above one step per tick (dda_ticks_X_substeps).
+ */
+
+static void _prep_ramp(const stPrepSegment_t *seg, stPrepSegmentMotor_t *mot, const float segment_ramp)
+{
+    const int64_t ticks = seg->dda_ticks;
+    const int64_t increment = mot->substep_increment;
+    if ((ticks < 2) || (increment == 0) || fp_ZERO(segment_ramp))
+    {
+        return;
+    }
+    float ramp = segment_ramp;
+    float ramp_max = 2 * ((float)seg->dda_ticks_X_substeps / increment - 1);   // fastest tick at one step
+    if (ramp_max > 2)
+    {
+        ramp_max = 2;                                                           // slowest tick at zero
+    }
+    if (ramp > ramp_max)
+    {
+        ramp = ramp_max;
+    }
+    else if (ramp < -ramp_max)
+    {
+        ramp = -ramp_max;
+    }
+    int64_t step = (int64_t)round(increment * ramp / (ticks - 1));
+    if (((ticks - 1) & 1) && (step & 1))
+    {
+        step += (step > 0) ? -1 : 1;                                            // toward zero stays in range
+    }
+    int64_t start = increment - step * (ticks - 1) / 2;
+    int64_t end = start + step * (ticks - 1);
+    if ((start < 0) || (end < 0) || (start > seg->dda_ticks_X_substeps) || (end > seg->dda_ticks_X_substeps))
+    {
+        return;                                                                 // rounding pushed an end out - run flat
+    }
+    mot->substep_increment = (uint32_t)start;
+    mot->substep_ramp = (int32_t)step;
+}
+#endif
+
+#if DDA_STEP_TABLE == true
+/*
+ * _prep_step_table() - run the DDA for a prepped segment and store its step bits per tick
+ *
+ *  Exec keeps its own copy of each motor's accumulator and applies the same time base
+ *  correction and direction flip the loader applies to the runtime accumulators, so the
+ *  table steps exactly as the DDA interrupt would have. Exec sees every segment before the
+ *  loader does, so the two copies stay in step.
+ */
+
+static stat_t _prep_step_table(stPrepSegment_t *seg)
+{
+    if (seg->dda_ticks > DDA_STEP_TABLE_TICKS)
+    { // never supposed to happen
+        return (cm_panic(STAT_INTERNAL_ERROR, "st_prep_line() segment longer than step table"));
+    }
+    uint8_t *table = st_pre.step_table[st_pre.table_slot];
+    st_pre.table_slot = (st_pre.table_slot + 1) % DDA_STEP_TABLES;
+    memset(table, 0, seg->dda_ticks);
+    seg->step_table = table;
+
+    for (uint8_t motor = 0; motor < MOTORS; motor++)
+    {
+        stPrepSegmentMotor_t *mot = &seg->mot[motor];
+        mot->table_steps = 0;
+#if DDA_MICROSTEP_SWITCH == true
+        stPrepMotor_t *pm = &st_pre.mot[motor];
+        mot->microstep_tick = 0;
+        mot->step_weight = pm->step_weight;
+        mot->switch_weight = pm->step_weight;
+#endif
+        if (mot->substep_increment == 0)
+        {
+            continue;
+        }
+        int32_t accumulator = st_pre.mot[motor].substep_accumulator;
+        if (mot->accumulator_correction_flag == true)
+        {
+            accumulator *= mot->accumulator_correction;
+        }
+        uint32_t holdoff = 0;
+        if (mot->direction != st_pre.mot[motor].table_direction)
+        {
+            st_pre.mot[motor].table_direction = mot->direction;
+            accumulator = -(seg->dda_ticks_X_substeps + accumulator);
+            holdoff = _dda_dir_ticks(motor) - 1;    // direction setup time, as in _dda_fire()
+        }
+        const uint8_t step_bit = (1 << motor);
+        int32_t steps = 0;                          // fine steps
+        uint32_t increment = mot->substep_increment;
+        for (uint32_t tick = 0; tick < seg->dda_ticks; tick++)
+        {
+            accumulator += increment;
+#if DDA_SEGMENT_RAMP == true
+            increment += mot->substep_ramp;
+#endif
+            if ((tick >= holdoff) && (accumulator > 0))
+            {
+                table[tick] |= step_bit;
+                accumulator -= seg->dda_ticks_X_substeps;
+#if DDA_MICROSTEP_SWITCH == true
+                steps += pm->step_weight;
+                pm->microstep_phase += pm->step_weight * mot->step_sign;
+                if ((pm->wanted_weight != pm->step_weight) && (mot->microstep_tick == 0) && (tick + 1 < seg->dda_ticks) &&
+                    _prep_microstep_switch(pm, accumulator, increment, seg->dda_ticks_X_substeps))
+                {
+                    table[tick + 1] |= DDA_TABLE_MICROSTEP_BIT;
+                    mot->microstep_tick = tick + 1;
+                    mot->switch_weight = pm->step_weight;
+                    holdoff = tick + 2;             // microstep setup time, like direction setup
+                }
+#else
+                steps++;
+#endif
+            }
+        }
+        st_pre.mot[motor].substep_accumulator = accumulator;
+        mot->table_steps = steps * mot->step_sign;
     }
-    st_pre.block_type = BLOCK_TYPE_ALINE;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // signal that prep buffer is ready
     return (STAT_OK);
 }
+#endif
+
+#if DDA_MICROSTEP_SWITCH == true
+/*
+ * _prep_microstep_switch() - change a motor's step size right after one of its steps
+ *
+ *  Called with the accumulator just past a step, so the phase (accumulator + D) is the part
+ *  of the next step already run: 0 < phase <= increment. Going coarse divides phase and
+ *  increment by the size ratio and may only happen on a full coarse step of the indexer.
+ *  Going fine multiplies them, and waits while the next fine step would already be due.
+ *  Returns true if the switch was made.
+ */
+
+static bool _prep_microstep_switch(stPrepMotor_t *m, int32_t &accumulator, uint32_t &increment, const uint32_t substeps)
+{
+    int64_t phase = (int64_t)accumulator + substeps;
+    if (m->wanted_weight > m->step_weight)
+    {
+        if ((m->microstep_phase & (m->wanted_weight - 1)) != 0)
+        {
+            return (false);
+        }
+        uint8_t ratio = m->wanted_weight / m->step_weight;
+        phase /= ratio;
+        increment /= ratio;
+    }
+    else
+    {
+        uint8_t ratio = m->step_weight / m->wanted_weight;
+        if (phase * ratio > substeps)
+        {
+            return (false);
+        }
+        phase *= ratio;
+        increment *= ratio;
+    }
+    accumulator = (int32_t)(phase - substeps);
+    m->step_weight = m->wanted_weight;
+    return (true);
+}
+#endif
+
+/*
+ * _prep_non_line() - stage a non-motion block in the exec slot
+ *
+ *  Non-motion blocks have no travel, which keeps the following error alignment in
+ *  st_prep_line() correct. The exec interrupt hands the slot to the loader.
+ */
+
+static stPrepSegment_t *_prep_non_line(const blockType block_type)
+{
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.exec_slot];
+    seg->block_type = block_type;
+    for (uint8_t motor = 0; motor < MOTORS; motor++)
+    {
+        seg->mot[motor].travel_steps = 0;
+    }
+    return (seg);
+}
+
+/*
+ * st_prep_raster() - stage the raster pixels of the segment being prepped (see raster.h)
+ */
+
+void st_prep_raster(const rasterSegment_t *raster)
+{
+    st_pre.seg[st_pre.exec_slot].raster = *raster;
+}
+
+/*
+ * st_prep_actions() - run planner actions when the segment being prepped ends
+ *
+ *  Called by the exec for the last segment of a move that carries inline actions
+ *  (see mp_queue_inline_action()).
+ */
+
+void st_prep_actions(const uint8_t first, const uint8_t actions)
+{
+    st_pre.seg[st_pre.exec_slot].action_first = first;
+    st_pre.seg[st_pre.exec_slot].actions = actions;
+}
 
 /*
  * st_prep_null() - 保持装载机的快乐。 否则不执行任何操作
@@ -816,8 +1821,7 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
 
 void st_prep_null()
 {
-    st_pre.block_type = BLOCK_TYPE_NULL;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC; // 正在加载临时缓冲区
+    _prep_non_line(BLOCK_TYPE_NULL);
 }
 
 /*
@@ -826,9 +1830,7 @@ void st_prep_null()
 
 void st_prep_command(void *bf)
 {
-    st_pre.block_type = BLOCK_TYPE_COMMAND;
-    st_pre.bf = (mpBuf_t *)bf;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // signal that prep buffer is ready
+    _prep_non_line(BLOCK_TYPE_COMMAND)->bf = (mpBuf_t *)bf;
 }
 
 /*
@@ -837,10 +1839,10 @@ void st_prep_command(void *bf)
 
 void st_prep_dwell(float microseconds)
 {
-    st_pre.block_type = BLOCK_TYPE_DWELL;
+    stPrepSegment_t *seg = _prep_non_line(BLOCK_TYPE_DWELL);
     // we need dwell_ticks to be at least 1
-    st_pre.dwell_ticks = std::max((uint32_t)((microseconds / 1000000) * FREQUENCY_DWELL), 1u); //xzw168
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;                                         // signal that prep buffer is ready
+    seg->dwell_ticks = std::max((uint32_t)((microseconds / 1000000) * FREQUENCY_DWELL), 1u); //xzw168
+    seg->dwell_release = nullptr;
 }
 
 /*
@@ -849,15 +1851,21 @@ void st_prep_dwell(float microseconds)
  * Add a dwell to the loader without going through the planner buffers.
  * Only usable while exec isn't running, e.g. in feedhold or stopped states.
  * Otherwise it is skipped.
+ *
+ * If release is given the dwell ends at the first SysTick it returns true, and the
+ * time is only the timeout. It is called from the SysTick interrupt, so keep it short.
  */
 
-void st_prep_out_of_band_dwell(float microseconds)
+void st_prep_out_of_band_dwell(float microseconds, bool (*release)(void))
 {
     if (!st_runtime_isbusy())
     {
         st_prep_dwell(microseconds);
-        st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // signal that prep buffer is ready
-        st_request_load_move();
+        st_pre.seg[st_pre.exec_slot].dwell_release = release;
+    }
+    else
+    {
+        st_prep_null();
     }
 }
 
@@ -890,9 +1898,29 @@ static int8_t _motor(const index_t index)
     return (isdigit(c) ? c - 0x31 : -1); // 0x30 + 1 offsets motor 1 to == 0
 }
 
+/*
+ * _set_microstep_weight() - fine steps in a coarse step, 1 if the motor does not switch
+ */
+
+static void _set_microstep_weight(const uint8_t motor)
+{
+    uint8_t mi = st_cfg.mot[motor].microsteps;
+    uint8_t mc = st_cfg.mot[motor].coarse_microsteps;
+    uint8_t weight = 1;
+    if ((DDA_MICROSTEP_SWITCH == true) && (mc != 0) && (mc < mi) && ((mi % mc) == 0))
+    {
+        weight = mi / mc;
+        if ((weight & (weight - 1)) != 0)
+        {
+            weight = 1;                     // indexer steps only line up for powers of 2
+        }
+    }
+    st_cfg.mot[motor].microstep_weight = weight;
+}
+
 /*
  * _set_motor_steps_per_unit() - what it says
- * This function will need to be rethought if microstep morphing is implemented
+ * Steps per unit are always in the configured microsteps, also with DDA_MICROSTEP_SWITCH
  */
 
 static float _set_motor_steps_per_unit(nvObj_t *nv)
@@ -902,6 +1930,7 @@ static float _set_motor_steps_per_unit(nvObj_t *nv)
                                    (360 * st_cfg.mot[m].microsteps);
 
     st_cfg.mot[m].steps_per_unit = 1 / st_cfg.mot[m].units_per_step;
+    kn_config_changed();
     return (st_cfg.mot[m].steps_per_unit);
 }
 
@@ -928,13 +1957,16 @@ static float _set_motor_steps_per_unit(nvObj_t *nv)
  *  External axis numbers are   XYZABCUVW for axis 0-8
  *  Internal axis numbers are   XYZUVWABC for axis 0-8 (for various code reasons)
  *
- *  This function retrieves an internal axis number and remaps it to an external axis number
+ *  This function retrieves an internal axis number and remaps it to an external axis number.
+ *  Reduced builds (AXES < 9) already use the external numbering, so there is nothing to remap.
  */
 stat_t st_get_ma(nvObj_t *nv)
 {
-    uint8_t remap_axis[9] = {0, 1, 2, 6, 7, 8, 3, 4, 5};
     ritorno(get_integer(nv, st_cfg.mot[_motor(nv->index)].motor_map));
+#if (AXES == 9)
+    uint8_t remap_axis[9] = {0, 1, 2, 6, 7, 8, 3, 4, 5};
     nv->value_int = remap_axis[nv->value_int];
+#endif
     return (STAT_OK);
 }
 
@@ -961,9 +1993,12 @@ stat_t st_set_ma(nvObj_t *nv)
         return (STAT_INPUT_EXCEEDS_MAX_VALUE);
     }
     uint8_t external_axis = nv->value_int;
+#if (AXES == 9)
     uint8_t remap_axis[9] = {0, 1, 2, 6, 7, 8, 3, 4, 5};
     nv->value_int = remap_axis[nv->value_int];
+#endif
     ritorno(set_integer(nv, st_cfg.mot[_motor(nv->index)].motor_map, 0, AXES));
+    kn_config_changed();
     nv->value_int = external_axis;
     return (STAT_OK);
 }
@@ -1005,6 +2040,28 @@ stat_t st_set_mi(nvObj_t *nv)
     ritorno(set_integer(nv, st_cfg.mot[_motor(nv->index)].microsteps, 1, 255));
     _set_motor_steps_per_unit(nv);
     _set_hw_microsteps(_motor(nv->index), nv->value_int);
+    _set_microstep_weight(_motor(nv->index));
+    return (STAT_OK);
+}
+
+/*
+ * st_get_mc() - get coarse microsteps (DDA_MICROSTEP_SWITCH)
+ * st_set_mc() - set coarse microsteps
+ *
+ *  0 turns switching off. The coarse setting must be a power of 2 and divide the microsteps,
+ *  otherwise the motor stays at its configured microsteps.
+ */
+stat_t st_get_mc(nvObj_t *nv) { return (get_integer(nv, st_cfg.mot[_motor(nv->index)].coarse_microsteps)); }
+stat_t st_set_mc(nvObj_t *nv)
+{
+    uint8_t mc = (uint8_t)nv->value_int;
+    if ((mc & (mc - 1)) != 0)
+    {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    ritorno(set_integer(nv, st_cfg.mot[_motor(nv->index)].coarse_microsteps, 0, 128));
+    _set_microstep_weight(_motor(nv->index));
     return (STAT_OK);
 }
 
@@ -1040,6 +2097,7 @@ stat_t st_set_su(nvObj_t *nv)
     // You could scale any one of the other values, but TR makes the most sense
     st_cfg.mot[m].travel_rev = (360.0 * st_cfg.mot[m].microsteps) /
                                (st_cfg.mot[m].steps_per_unit * st_cfg.mot[m].step_angle);
+    kn_config_changed();
     return (STAT_OK);
 }
 
@@ -1083,6 +2141,33 @@ stat_t st_set_pl(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/*
+ * st_get_bl() - get motor backlash
+ * st_set_bl() - set motor backlash
+ *
+ *  Backlash is in mm or degrees of the motor's axis and is applied in st_prep_line().
+ */
+stat_t st_get_bl(nvObj_t *nv) { return (get_float(nv, st_cfg.mot[_motor(nv->index)].backlash)); }
+stat_t st_set_bl(nvObj_t *nv) { return (set_float_range(nv, st_cfg.mot[_motor(nv->index)].backlash, 0, 10)); }
+
+/*
+ * st_get_sg() - get motor stall action
+ * st_set_sg() - set motor stall action
+ * st_get_ld() - get smart driver load reading (-1 if the driver has none)
+ */
+stat_t st_get_sg(nvObj_t *nv) { return (get_integer(nv, st_cfg.mot[_motor(nv->index)].stall_action)); }
+stat_t st_set_sg(nvObj_t *nv) { return (set_integer(nv, st_cfg.mot[_motor(nv->index)].stall_action, STALL_IGNORE, STALL_ACTION_MAX_VALUE)); }
+
+stat_t st_get_ld(nvObj_t *nv)
+{
+    uint8_t motor = (cfgArray[nv->index].token[2] & 0x0F) - 1;
+    if (motor >= MOTORS)
+    {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    return (get_integer(nv, Motors[motor]->hasDriverStatus() ? st_drv.load[motor] : -1));
+}
+
 /*
  * st_get_pwr()	- get current motor power
  *
@@ -1166,6 +2251,9 @@ stat_t st_set_sp(nvObj_t *nv) // set motor step polarity
     };
 
     Motors[motor]->setStepPolarity((ioMode)nv->value_int);
+#if DDA_STEP_PINSET == true
+    _update_step_polarity();
+#endif
     return (STAT_OK);
 }
 
@@ -1217,6 +2305,10 @@ stat_t st_set_me(nvObj_t *nv)
     for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++)
     {
         Motors[motor]->enable(nv->value_int); // nv->value is the timeout or 0 for default
+        if ((!st_runtime_isbusy()) && (cm_get_machine_state() != MACHINE_CYCLE))
+        { // nothing is going to stop these motors, so start their timeouts now
+            Motors[motor]->requestPowerTimeout();
+        }
     }
     return (STAT_OK);
 }
@@ -1277,12 +2369,16 @@ static const char fmt_0ma[] = "[%s%s] m%s map to axis%15d [0=X,1=Y,2=Z...]\n";
 static const char fmt_0sa[] = "[%s%s] m%s step angle%20.3f%s\n";
 static const char fmt_0tr[] = "[%s%s] m%s travel per revolution%10.4f%s\n";
 static const char fmt_0mi[] = "[%s%s] m%s microsteps%16d [1,2,4,8,16,32]\n";
+static const char fmt_0mc[] = "[%s%s] m%s coarse microsteps%9d [0=off,1,2,4,8,16]\n";
 static const char fmt_0su[] = "[%s%s] m%s steps per unit %17.5f steps per%s\n";
 static const char fmt_0po[] = "[%s%s] m%s polarity%18d [0=normal,1=reverse]\n";
 static const char fmt_0ep[] = "[%s%s] m%s enable polarity%11d [0=active HIGH,1=active LOW]\n";
 static const char fmt_0sp[] = "[%s%s] m%s step polarity%13d [0=active HIGH,1=active LOW]\n";
 static const char fmt_0pm[] = "[%s%s] m%s power management%10d [0=disabled,1=always on,2=in cycle,3=when moving]\n";
 static const char fmt_0pl[] = "[%s%s] m%s motor power level%13.3f [0.000=minimum, 1.000=maximum]\n";
+static const char fmt_0bl[] = "[%s%s] m%s backlash%23.4f%s\n";
+static const char fmt_0sg[] = "[%s%s] m%s stall action%14d [0=ignore,1=feedhold,2=alarm]\n";
+static const char fmt_ld[] = "[%s%s] Motor %c load:%19d\n";
 static const char fmt_pwr[] = "[%s%s] Motor %c power level:%12.3f\n";
 
 void st_print_me(nvObj_t *nv) { text_print(nv, fmt_me); } // TYPE_NULL - message only
@@ -1291,25 +2387,31 @@ void st_print_mt(nvObj_t *nv) { text_print(nv, fmt_mt); } // TYPE_FLOAT
 
 static void _print_motor_int(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, (int)nv->value_int);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, (int)nv->value_int);
     xio_writeline(cs.out_buf);
 }
 
 static void _print_motor_flt(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt);
     xio_writeline(cs.out_buf);
 }
 
 static void _print_motor_flt_units(nvObj_t *nv, const char *format, uint8_t units)
 {
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt, GET_TEXT_ITEM(msg_units, units));
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt, GET_TEXT_ITEM(msg_units, units));
+    xio_writeline(cs.out_buf);
+}
+
+static void _print_motor_ld(nvObj_t *nv, const char *format)
+{
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->token[2], (int)nv->value_int);
     xio_writeline(cs.out_buf);
 }
 
 static void _print_motor_pwr(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->group, nv->token, nv->token[0], nv->value_flt);
+    text_sprintf(cs.out_buf, format, nv->group, nv->token, nv->token[0], nv->value_flt);
     xio_writeline(cs.out_buf);
 }
 
@@ -1317,12 +2419,16 @@ void st_print_ma(nvObj_t *nv) { _print_motor_int(nv, fmt_0ma); }
 void st_print_sa(nvObj_t *nv) { _print_motor_flt_units(nv, fmt_0sa, DEGREE_INDEX); }
 void st_print_tr(nvObj_t *nv) { _print_motor_flt_units(nv, fmt_0tr, cm_get_units_mode(MODEL)); }
 void st_print_mi(nvObj_t *nv) { _print_motor_int(nv, fmt_0mi); }
+void st_print_mc(nvObj_t *nv) { _print_motor_int(nv, fmt_0mc); }
 void st_print_su(nvObj_t *nv) { _print_motor_flt_units(nv, fmt_0su, cm_get_units_mode(MODEL)); }
 void st_print_po(nvObj_t *nv) { _print_motor_int(nv, fmt_0po); }
 void st_print_ep(nvObj_t *nv) { _print_motor_int(nv, fmt_0ep); }
 void st_print_sp(nvObj_t *nv) { _print_motor_int(nv, fmt_0sp); }
 void st_print_pm(nvObj_t *nv) { _print_motor_int(nv, fmt_0pm); }
 void st_print_pl(nvObj_t *nv) { _print_motor_flt(nv, fmt_0pl); }
+void st_print_bl(nvObj_t *nv) { _print_motor_flt_units(nv, fmt_0bl, cm_get_units_mode(MODEL)); }
+void st_print_sg(nvObj_t *nv) { _print_motor_int(nv, fmt_0sg); }
+void st_print_ld(nvObj_t *nv) { _print_motor_ld(nv, fmt_ld); }
 void st_print_pwr(nvObj_t *nv) { _print_motor_pwr(nv, fmt_pwr); }
 
 #endif // __TEXT_MODE
@@ -255,6 +255,7 @@
 #define STEPPER_H_ONCE
 
 #include "planner.h"    // planner.h must precede stepper.h for moveType typedef
+#include "raster.h"     // rasterSegment_t
 #include "gpio.h"       // for IO_ACTIVE_HIGH/IO_ACTIVE_LOW
 
 /*********************************
@@ -283,6 +284,29 @@ typedef enum {
 } stPowerMode;
 #define MOTOR_POWER_MODE_MAX_VALUE    MOTOR_POWERED_ONLY_WHEN_MOVING
 
+typedef enum {                          // loader's view of a motor, used to find power transitions
+    MOTOR_MOTION_STOPPED = 0,           // motor had no steps in the last segment loaded
+    MOTOR_MOTION_STEPPING,              // motor had steps in the last segment loaded
+    MOTOR_MOTION_UNKNOWN                // after a reset or an idle loader - next segment sets power either way
+} stMotionState;
+
+typedef enum {                          // smart driver status flags (see Stepper::getDriverStatus())
+    DRIVER_STALL = 0x01,                // load is over the driver's stall threshold
+    DRIVER_OVERTEMP = 0x02,             // driver overtemperature warning or shutdown
+    DRIVER_OPEN_LOAD = 0x04             // a coil is open or disconnected
+} stDriverStatus;
+
+typedef enum {                          // what a stall does when the motor is not homing on it
+    STALL_IGNORE = 0,
+    STALL_FEEDHOLD,                     // stop the cycle with a feedhold
+    STALL_ALARM                         // alarm - position is lost
+} stStallAction;
+#define STALL_ACTION_MAX_VALUE STALL_ALARM
+
+#ifndef ST_DRIVER_STATUS_MS
+#define ST_DRIVER_STATUS_MS 5           // smart driver status poll period - a stall stops this late
+#endif
+
 // Stepper power management settings
 #define Vcc         3.3                 // volts
 #define MaxVref    2.25                 // max vref for driver circuit. Our ckt is 2.25 volts
@@ -308,20 +332,130 @@ typedef enum {
  *
  *    MAX_LONG == 2^31, maximum signed long (depth of accumulator. NB: accumulator values are negative)
  *    FREQUENCY_DDA == DDA clock rate in Hz.
- *    NOM_SEGMENT_TIME == upper bound of segment time in minutes
+ *    MAX_SEGMENT_TIME == upper bound of segment time in minutes (NOM_SEGMENT_TIME unless adaptive)
  *    0.90 == a safety factor used to reduce the result from theoretical maximum
  *
  *  The number is about 8.5 million for the Xmega running a 50 KHz DDA with 5 millisecond segments
  *  The ARM is roughly the same as the DDA clock rate is 4x higher but the segment time is ~1/5
  *  Decreasing the nominal segment time increases the number precision.
  */
-#define DDA_SUBSTEPS ((MAX_LONG * 0.90) / (FREQUENCY_DDA * (NOM_SEGMENT_TIME * 60)))
+#define DDA_SUBSTEPS ((MAX_LONG * 0.90) / (FREQUENCY_DDA * (MAX_SEGMENT_TIME * 60)))
+
+/* DDA step generation
+ *
+ *  The DDA interrupt is generated from the board's DDA_MOTOR_LIST (see board_stepper.h).
+ *  DDA_PACKED_STEPS runs all the accumulators before setting any step pins, so the step
+ *  pin writes happen back-to-back at the end of the tick. Boards can set it in hardware.h.
+ */
+#ifndef DDA_PACKED_STEPS
+#define DDA_PACKED_STEPS false
+#endif
+
+/* Step pin set
+ *
+ *  With DDA_STEP_PINSET the step pins are written through a Motate PinSet built from the
+ *  board's DDA_STEP_PINS, so all step pins on one port are raised (and later dropped) with a
+ *  single register write instead of one write per motor. This also keeps the pulses of
+ *  motors on the same port exactly aligned. It implies DDA_PACKED_STEPS. Boards can set it
+ *  in hardware.h.
+ */
+#ifndef DDA_STEP_PINSET
+#define DDA_STEP_PINSET false
+#endif
+
+/* Step table playback
+ *
+ *  With DDA_STEP_TABLE exec runs the DDA accumulators for the whole segment when it preps it
+ *  and stores the step bits of every tick in a table. The DDA interrupt then only reads the
+ *  next table entry and writes it to the step pins, so its cost no longer grows with the
+ *  number of motors. The accumulator work moves to the exec interrupt, which runs at a lower
+ *  priority. Tables are kept for one slot more than the prep ring, so the table the DDA is
+ *  playing is never the one exec is writing. Boards can set it in hardware.h.
+ */
+#ifndef DDA_STEP_TABLE
+#define DDA_STEP_TABLE false
+#endif
+#define DDA_STEP_TABLE_TICKS ((uint32_t)(MAX_SEGMENT_TIME * 60 * FREQUENCY_DDA * 1.25) + 1) // longest segment with margin
+#define DDA_STEP_TABLES (PREP_BUFFER_SLOTS + 1)
+
+/* Segment batching (simulator builds)
+ *
+ *  With DDA_BATCH_SEGMENTS the DDA interrupt runs a whole segment in one call. The loader
+ *  leaves each accumulator at or below zero, and an increment never exceeds
+ *  dda_ticks_X_substeps (D), so after N ticks a motor has taken k = ceil((a0 + N*inc) / D)
+ *  steps and its accumulator is a0 + N*inc - k*D - exactly where the per-tick DDA ends up.
+ *  Segments that need direction setup holdoff run tick by tick as usual.
+ *  No step pulses are generated, so this is only for the simulator, which has no step pins;
+ *  the ticks taken are reported to it in dda_timer.elapsed_ticks. DDA_BATCH_TRACE runs every
+ *  segment tick by tick instead and traps if the closed form disagrees at the segment end.
+ */
+#ifndef DDA_BATCH_SEGMENTS
+#define DDA_BATCH_SEGMENTS false
+#endif
+
+/* In-segment velocity ramp
+ *
+ *  Exec passes each segment the velocity change across it as a fraction of its mean velocity
+ *  (st_prep_line() segment_ramp). With DDA_SEGMENT_RAMP prep turns that into a per-tick change
+ *  of each motor's substep increment, so the step rate rises or falls linearly through the
+ *  segment instead of jumping at segment boundaries. The start increment and per-tick change
+ *  are chosen so N ticks still add exactly N*inc - the segment ends on its travel - and no
+ *  tick exceeds one step. Step rate is then continuous across segments and acceleration is
+ *  piecewise constant, so longer segments give the same smoothness for less exec load.
+ *  Works with DDA_STEP_TABLE and DDA_BATCH_SEGMENTS. Boards can set it in hardware.h.
+ */
+#ifndef DDA_SEGMENT_RAMP
+#define DDA_SEGMENT_RAMP false
+#endif
+#ifndef DDA_BATCH_TRACE
+#define DDA_BATCH_TRACE false
+#endif
+
+/* Microstep switching
+ *
+ *  With DDA_MICROSTEP_SWITCH a motor with a coarse microstep setting ({1mc:}) runs at its
+ *  configured microsteps ({1mi:}) at low speed, and drops to the coarse setting when its step
+ *  rate goes over STEP_MICROSTEP_COARSE_RATE fine steps per tick. Rapids then fit under the
+ *  DDA frequency without giving up low speed smoothness. Positions, encoders and steps per
+ *  unit stay in the configured (fine) microsteps - a coarse step counts as several fine steps.
+ *
+ *  Exec switches while it runs the accumulators into the step table (see _prep_step_table()).
+ *  It goes coarse on the first step that lands on a full coarse step of the driver's indexer,
+ *  and back to fine on the first coarse step after the rate falls under
+ *  STEP_MICROSTEP_FINE_RATE. The accumulator and increment are rescaled to the new step size
+ *  at that step. The DDA interrupt sets the driver's microsteps on the next tick, which is
+ *  kept free of steps for the driver's setup time. The indexer is tracked from its home
+ *  state, so drivers must start there (power up or reset). Needs DDA_STEP_TABLE.
+ */
+#ifndef DDA_MICROSTEP_SWITCH
+#define DDA_MICROSTEP_SWITCH false
+#endif
+#if (DDA_MICROSTEP_SWITCH == true) && ((DDA_STEP_TABLE == false) || (DDA_SEGMENT_RAMP == true))
+#error "DDA_MICROSTEP_SWITCH needs DDA_STEP_TABLE and does not support DDA_SEGMENT_RAMP"
+#endif
+#define DDA_TABLE_MICROSTEP_BIT 0x80            // step table flag: a driver changes microsteps on this tick
+#define STEP_MICROSTEP_COARSE_RATE (float)0.50  // fine steps per tick above which a motor goes coarse
+#define STEP_MICROSTEP_FINE_RATE   (float)0.25  // fine steps per tick below which it goes back to fine
+
+/* Prep buffer ring
+ *
+ *  Exec prepares segments into a ring of PREP_BUFFER_SLOTS slots and the loader consumes them
+ *  in order. Each slot is handed back and forth by its buffer_state, so exec (MED ISR) and the
+ *  loader (HI ISR) never touch the same slot at the same time and no locking is required.
+ *  With more than one slot exec can run ahead of the DDA and absorb latency in the lower
+ *  interrupt levels. Boards can set it in hardware.h.
+ */
+#ifndef PREP_BUFFER_SLOTS
+#define PREP_BUFFER_SLOTS 3
+#endif
 
 /* Step correction settings
  *
  *  Step correction settings determine how the encoder error is fed back to correct position errors.
  *  Since the following_error is running 2 segments behind the current segment you have to be careful
- *  not to overcompensate. The threshold determines if a correction should be applied, and the factor
+ *  not to overcompensate. st_prep_line() adds back the travel of segments still waiting in the prep
+ *  ring, but a correction is still not seen by the encoder until up to PREP_BUFFER_SLOTS + 1 segments
+ *  later, so the holdoff must be longer than that. The threshold determines if a correction should be applied, and the factor
  *  is how much. The holdoff is how many segments to wait before applying another correction. If threshold
  *  is too small and/or amount too large and/or holdoff is too small you may get a runaway correction
  *  and error will grow instead of shrink (or oscillate).
@@ -330,6 +464,7 @@ typedef enum {
 #define STEP_CORRECTION_FACTOR      (float)0.25     // factor to apply to step correction for a single segment
 #define STEP_CORRECTION_MAX         (float)0.60     // max step correction allowed in a single segment
 #define STEP_CORRECTION_HOLDOFF            5        // minimum number of segments to wait between error correction
+#define STEP_BACKLASH_MAX           (float)4.00     // max backlash steps injected in a single segment
 
 /*
  * Stepper control structures
@@ -354,15 +489,19 @@ typedef struct cfgMotor {                   // per-motor configs
     // public
     uint8_t motor_map;                      // 将电机映射到轴
     uint8_t microsteps;                     // 电机细分
+    uint8_t coarse_microsteps;              // microsteps at speed with DDA_MICROSTEP_SWITCH. 0 = off
     uint8_t polarity;                       // 0=正常极性, 1=反转电机方向
     float power_level;                      // 电流 set 0.000 to 1.000 for PMW vref setting
     float step_angle;                       // 每一步的度数 (ex: 1.8)
     float travel_rev;                       // 每个电机旋转的行程mm或度
     float steps_per_unit;                   // 每毫米（或度）的步数
     float units_per_step;                   // mm or degrees of travel per microstep
+    float backlash;                         // mm or degrees of lost motion on reversal. 0 = no compensation
+    uint8_t stall_action;                   // stStallAction, for drivers that report stalls
 
     // private
     float power_level_scaled;               // scaled to internal range - must be between 0 and 1
+    uint8_t microstep_weight;               // fine steps in a coarse step, 1 if the motor does not switch
 } cfgMotor_t;
 
 typedef struct stConfig {                   // stepper configs
@@ -374,17 +513,47 @@ typedef struct stConfig {                   // stepper configs
 
 typedef struct stRunMotor {                 // one per controlled motor
     uint32_t substep_increment;             // 轴时间子步长因子的总步数
+#if DDA_SEGMENT_RAMP == true
+    int32_t substep_ramp;                   // change of substep_increment per tick
+#endif
     int32_t substep_accumulator;            // DDA相位角累加器
-    bool motor_flag;                        // 如果电机参与此移动，则为true
+    stMotionState motion_state;             // stepping or stopped in the last segment (power transitions)
+    uint8_t pulse_downcount;                // ticks left in a step pulse longer than one tick
+    uint8_t dir_holdoff;                    // ticks left before stepping after a direction change
     uint32_t power_systick;                 // sys_tick用于下一个电机功率状态转换
     float power_level_dynamic;              // 该段空闲的功率电平
+#if DDA_MICROSTEP_SWITCH == true
+    const uint8_t *microstep_switch;        // step table entry the driver switches microsteps on, or nullptr
+    uint8_t step_weight;                    // fine steps in a table step before the switch
+    uint8_t switch_weight;                  // ...and after it
+#endif
 } stRunMotor_t;
 
 typedef struct stRunSingleton {             // 步进静态值和轴参数
     magic_t magic_start;                    // magic number to test memory integrity
     uint32_t dda_ticks_downcount;           // dda tick down-counter (unscaled)
     uint32_t dwell_ticks_downcount;         // 停留计数器（未缩放）
+    bool (*dwell_release)(void);            // ends the running dwell early when it returns true, or nullptr
     uint32_t dda_ticks_X_substeps;          // 刻度乘以比例因子
+    uint8_t step_bits;                      // motors whose step pin was set in the previous DDA tick
+#if DDA_STEP_PINSET == true
+    uint8_t step_active_low;                // motors whose step polarity is IO_ACTIVE_LOW
+#endif
+    bool motors_idle;                       // loader ran out of segments and has stopped the motors
+    bool dda_running;                       // DDA timer is started - a sync follower can hold a loaded segment
+    uint32_t raster_increment;              // raster pixels per tick, 0 if no raster line is playing
+    uint32_t raster_accumulator;            // fraction of the current raster pixel played
+    uint8_t action_first;                   // planner actions to run when the running segment ends
+    uint8_t actions;
+#if DDA_STEP_TABLE == true
+    const uint8_t *step_table;              // next step bits to play in the running segment
+#endif
+#if DDA_BATCH_SEGMENTS == true
+    bool batch;                             // running segment can be taken in closed form
+#if DDA_BATCH_TRACE == true
+    int32_t batch_accumulator[MOTORS];      // accumulators the closed form predicts at segment end
+#endif
+#endif
     stRunMotor_t mot[MOTORS];               // 运行时电机结构
     magic_t magic_end;
 } stRunSingleton_t;
@@ -392,35 +561,80 @@ typedef struct stRunSingleton {             // 步进静态值和轴参数
 // Motor prep structure. Used by exec/prep ISR (MED) and read-only during load
 // Must be careful about volatiles in this one
 
-typedef struct stPrepMotor {
+typedef struct stPrepSegmentMotor {        // per-motor values for one prepared segment
     uint32_t substep_increment;             // total steps in axis times substep factor
-    bool motor_flag;                        // true if motor is participating in this move
-
-    // direction and direction change
+#if DDA_SEGMENT_RAMP == true
+    int32_t substep_ramp;                   // change of substep_increment per tick (0 for a flat segment)
+#endif
     uint8_t direction;                      // 行程方向校正极性（CW == 0.CCW == 1）
-    uint8_t prev_direction;                 // 此电机的前一段运行方向
     int8_t step_sign;                       // 编码器设置为+1或-1
+    uint8_t accumulator_correction_flag;    // 信号累加器需要校正
+    float accumulator_correction;           // factor for adjusting accumulator between segments
+    float travel_steps;                     // commanded travel before correction (aligns following error)
+#if DDA_STEP_TABLE == true
+    int32_t table_steps;                    // signed fine steps in the step table (loaded into the encoder)
+#endif
+#if DDA_MICROSTEP_SWITCH == true
+    uint16_t microstep_tick;                // tick the driver switches microsteps on, 0 if it does not
+    uint8_t step_weight;                    // fine steps in a table step at the start of the segment
+    uint8_t switch_weight;                  // ...and after the switch
+#endif
+} stPrepSegmentMotor_t;
+
+typedef struct stPrepSegment {              // one slot of the prep ring
+    volatile prepBufferState buffer_state;  // 准备缓冲区状态 - 由exec或loader拥有
+    struct mpBuffer *bf;                    // 指向相关缓冲区的静态指针
+    blockType block_type;                   // 移动类型（需要planner.h）
+
+    uint32_t dda_ticks;                     // DDA ticks for the move
+    uint32_t dwell_ticks;                   // dwell ticks remaining
+    bool (*dwell_release)(void);            // see st_prep_out_of_band_dwell()
+    uint32_t dda_ticks_X_substeps;          // DDA标记由子步骤因子缩放
+#if DDA_STEP_TABLE == true
+    const uint8_t *step_table;              // step bits for each tick of the segment
+#endif
+    rasterSegment_t raster;                 // raster pixels played during the segment (see raster.h)
+    uint8_t action_first;                   // planner actions run when the segment ends (see st_prep_actions())
+    uint8_t actions;
+    stPrepSegmentMotor_t mot[MOTORS];
+} stPrepSegment_t;
+
+typedef struct stPrepMotor {                // per-motor state carried from segment to segment
+    uint8_t prev_direction;                 // 此电机的前一段运行方向 (loader only)
 
     // following error correction
     int32_t correction_holdoff;             // count down segments between corrections
     float corrected_steps;                  // accumulated correction steps for the cycle (for diagnostic display only)
 
+    // backlash compensation (see st_prep_line())
+    bool backlash_known;                    // false until the motor has moved once after a position set
+    float backlash_offset;                  // steps the motor is ahead of the axis on the positive side, 0..backlash
+    float backlash_steps;                   // steps injected since the encoder was last set
+
     // accumulator phase correction
     float prev_segment_time;                // segment time from previous segment run for this motor
-    float accumulator_correction;           // factor for adjusting accumulator between segments
-    uint8_t accumulator_correction_flag;    // 信号累加器需要校正
+#if DDA_STEP_TABLE == true
+    int32_t substep_accumulator;            // DDA phase accumulator run ahead by exec
+    uint8_t table_direction;                // direction of the last segment put in a step table (exec only)
+#endif
+#if DDA_MICROSTEP_SWITCH == true
+    uint8_t step_weight;                    // fine steps in a table step at the driver's current microsteps
+    uint8_t wanted_weight;                  // step weight the step rate asks for (see st_prep_line())
+    uint8_t microstep_phase;                // driver indexer position in fine steps, modulo 256
+#endif
 } stPrepMotor_t;
 
 typedef struct stPrepSingleton {
     magic_t magic_start;                    // 用于测试内存完整性的幻数
-    volatile prepBufferState buffer_state;  // 准备缓冲区状态 - 由exec或loader拥有
-    struct mpBuffer *bf;                    // 指向相关缓冲区的静态指针
-    blockType block_type;                   // 移动类型（需要planner.h）
-
-    uint32_t dda_ticks;                     // DDA ticks for the move
-    uint32_t dwell_ticks;                   // dwell ticks remaining
-    uint32_t dda_ticks_X_substeps;          // DDA标记由子步骤因子缩放
+    volatile uint8_t exec_slot;             // next slot exec will prepare (written by exec only)
+    volatile uint8_t load_slot;             // next slot the loader will load (written by loader only)
+    stPrepSegment_t seg[PREP_BUFFER_SLOTS]; // prep ring
     stPrepMotor_t mot[MOTORS];              // 准备时间马达结构
+#if DDA_STEP_TABLE == true
+    uint8_t table_slot;                     // next step table exec will write (exec only)
+    uint8_t step_table[DDA_STEP_TABLES][DDA_STEP_TABLE_TICKS];
+#endif
+    volatile bool null_sink;                // segments are prepared but never loaded (see st_set_null_sink())
     magic_t magic_end;
 } stPrepSingleton_t;
 
@@ -428,11 +642,12 @@ extern stConfig_t st_cfg;                   // config结构公开。 其余的
 extern stPrepSingleton_t st_pre;            // 仅由config_app诊断程序使用
 
 
+void st_request_power_timeout(void);    // a motor entered MOTOR_POWER_TIMEOUT_START
+
 /**** Stepper (base object) ****/
 
 struct Stepper {
 protected:
-    Timeout _motor_disable_timeout;         // this is the timeout object that will let us know when time is u
     uint32_t _motor_disable_timeout_ms;     // the number of ms that the timeout is reset to
     stPowerState _power_state;              // state machine for managing motor power
     stPowerMode _power_mode;                // See stPowerMode for values
@@ -522,7 +737,6 @@ public:
             return;
         }
         this->_disableImpl();
-        _motor_disable_timeout.clear();
         _power_state = MOTOR_IDLE; // or MOTOR_OFF
     };
 
@@ -531,38 +745,58 @@ public:
         if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
             this->enable();
             _power_state = MOTOR_POWER_TIMEOUT_START;
+            st_request_power_timeout();
         } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
             if (_power_state == MOTOR_RUNNING) {
                 _power_state = MOTOR_POWER_TIMEOUT_START;
+                st_request_power_timeout();
             }
         }
     };
 
-    virtual void periodicCheck(bool have_actually_stopped) // can be overridden
-    {
-        if (have_actually_stopped && _power_state == MOTOR_RUNNING) {
-            _power_state = MOTOR_POWER_TIMEOUT_START;    // ...start motor power timeouts
+    // start the power timeout of a motor left running, e.g. after $me with the machine stopped
+    void requestPowerTimeout() {
+        if (_power_state == MOTOR_RUNNING) {
+            _power_state = MOTOR_POWER_TIMEOUT_START;
+            st_request_power_timeout();
         }
+    };
 
-        // start timeouts initiated during a load so the loader does not need to burn these cycles
-        if (_power_state == MOTOR_POWER_TIMEOUT_START && _power_mode != MOTOR_ALWAYS_POWERED) {
-            _power_state = MOTOR_POWER_TIMEOUT_COUNTDOWN;
-            if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
-                _motor_disable_timeout.set(_motor_disable_timeout_ms);
-            } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-                _motor_disable_timeout.set(st_cfg.motor_power_timeout * 1000.0);
-          }
+    // Called by st_motor_power_callback() for a requested timeout. Returns true and the
+    // timeout if the motor starts counting down, so it can be put on the deadline list
+    bool startPowerTimeout(uint32_t &timeout_ms)
+    {
+        if (_power_state != MOTOR_POWER_TIMEOUT_START || _power_mode == MOTOR_ALWAYS_POWERED) {
+            return (false);
+        }
+        _power_state = MOTOR_POWER_TIMEOUT_COUNTDOWN;
+        if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
+            timeout_ms = _motor_disable_timeout_ms;
+        } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
+            timeout_ms = st_cfg.motor_power_timeout * 1000.0;
+        } else {
+            return (false);
         }
+        return (true);
+    };
 
-        // count down and time out the motor
+    // Called when the motor's deadline comes up. A motor that started again since is left alone
+    void powerTimeoutExpired()
+    {
         if (_power_state == MOTOR_POWER_TIMEOUT_COUNTDOWN) {
-            if (_motor_disable_timeout.isPast()) {
-                disable();
-				sr_request_status_report(SR_REQUEST_TIMED);
-            }
+            disable();
+            sr_request_status_report(SR_REQUEST_TIMED);
         }
     };
 
+    // Smart drivers on a bus report their status. pollDriverStatus() queues a read of the
+    // status registers (an SPIMessage on SPI drivers) and the getters return what the last
+    // completed read found, so none of them wait on the bus. Step/dir drivers have no status.
+    virtual bool hasDriverStatus() const { return false; };
+    virtual void pollDriverStatus() {};
+    virtual uint8_t getDriverStatus() { return 0; };        // stDriverStatus flags
+    virtual int16_t getDriverLoad() { return -1; };         // load reading in the driver's units, -1 = none
+
     /* Functions that must be implemented in subclasses */
 
     virtual bool canStep() { return true; };
@@ -584,18 +818,26 @@ void stepper_init_assertions(void);
 stat_t stepper_test_assertions(void);
 
 bool st_runtime_isbusy(void);
+void st_get_step_position(int32_t steps[]);
 stat_t st_clc(nvObj_t *nv);
 void st_set_motor_power(const uint8_t motor);
 stat_t st_motor_power_callback(void);
+stat_t st_driver_status_callback(void);
+bool st_set_stall_homing(const uint8_t axis, const bool homing);
+bool st_axis_stalled(const uint8_t axis);
 
+void st_set_null_sink(const bool null_sink);
 void st_request_forward_plan(void);
 void st_request_exec_move(void);
 void st_request_load_move(void);
+void st_sync_tick(void);
 void st_prep_null(void);
 void st_prep_command(void *bf);        // use a void pointer since we don't know about mpBuf_t yet)
 void st_prep_dwell(float microseconds);
-void st_prep_out_of_band_dwell(float microseconds);
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time);
+void st_prep_out_of_band_dwell(float microseconds, bool (*release)(void) = nullptr);
+stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time, const float segment_ramp = 0);
+void st_prep_raster(const rasterSegment_t *raster);
+void st_prep_actions(const uint8_t first, const uint8_t actions);
 
 stat_t st_get_ma(nvObj_t *nv);
 stat_t st_set_ma(nvObj_t *nv);
@@ -605,6 +847,8 @@ stat_t st_get_tr(nvObj_t *nv);
 stat_t st_set_tr(nvObj_t *nv);
 stat_t st_get_mi(nvObj_t *nv);
 stat_t st_set_mi(nvObj_t *nv);
+stat_t st_get_mc(nvObj_t *nv);
+stat_t st_set_mc(nvObj_t *nv);
 stat_t st_get_su(nvObj_t *nv);
 stat_t st_set_su(nvObj_t *nv);
 
@@ -619,6 +863,11 @@ stat_t st_get_pm(nvObj_t *nv);
 stat_t st_set_pm(nvObj_t *nv);
 stat_t st_get_pl(nvObj_t *nv);
 stat_t st_set_pl(nvObj_t *nv);
+stat_t st_get_bl(nvObj_t *nv);
+stat_t st_set_bl(nvObj_t *nv);
+stat_t st_get_sg(nvObj_t *nv);
+stat_t st_set_sg(nvObj_t *nv);
+stat_t st_get_ld(nvObj_t *nv);
 
 stat_t st_get_pwr(nvObj_t *nv);
 
@@ -634,12 +883,16 @@ stat_t st_get_dw(nvObj_t *nv);
     void st_print_sa(nvObj_t *nv);
     void st_print_tr(nvObj_t *nv);
     void st_print_mi(nvObj_t *nv);
+    void st_print_mc(nvObj_t *nv);
     void st_print_su(nvObj_t *nv);
     void st_print_po(nvObj_t *nv);
     void st_print_ep(nvObj_t *nv);
     void st_print_sp(nvObj_t *nv);
     void st_print_pm(nvObj_t *nv);
     void st_print_pl(nvObj_t *nv);
+    void st_print_bl(nvObj_t *nv);
+    void st_print_sg(nvObj_t *nv);
+    void st_print_ld(nvObj_t *nv);
     void st_print_pwr(nvObj_t *nv);
     void st_print_mt(nvObj_t *nv);
     void st_print_me(nvObj_t *nv);
@@ -651,12 +904,16 @@ stat_t st_get_dw(nvObj_t *nv);
     #define st_print_sa tx_print_stub
     #define st_print_tr tx_print_stub
     #define st_print_mi tx_print_stub
+    #define st_print_mc tx_print_stub
     #define st_print_su tx_print_stub
     #define st_print_po tx_print_stub
     #define st_print_ep tx_print_stub
     #define st_print_sp tx_print_stub
     #define st_print_pm tx_print_stub
     #define st_print_pl tx_print_stub
+    #define st_print_bl tx_print_stub
+    #define st_print_sg tx_print_stub
+    #define st_print_ld tx_print_stub
     #define st_print_pwr tx_print_stub
     #define st_print_mt tx_print_stub
     #define st_print_me tx_print_stub
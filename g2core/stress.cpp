@@ -0,0 +1,159 @@
+/*
+ * stress.cpp - randomized planner stress jobs
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "stress.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#define STRESS_XY_MAX   100.0               // box the motion stays in (mm)
+#define STRESS_Z_MIN    -10.0
+
+/**** Allocate Structures ****/
+
+static struct stressSingleton {
+    uint32_t rand;                          // xorshift32 state - never 0
+    double pos[3];                          // X, Y, Z as written (rounded to the 4 places printed)
+    FILE *f;
+} st;
+
+/************************************************************************************
+ **** CODE **************************************************************************
+ ************************************************************************************/
+
+// xorshift32 - the C library rand() differs by platform and would make seeds non-portable
+static uint32_t _stress_rand()
+{
+    st.rand ^= st.rand << 13;
+    st.rand ^= st.rand >> 17;
+    st.rand ^= st.rand << 5;
+    return (st.rand);
+}
+
+static double _stress_uniform(double min, double max) { return (min + (max - min) * (_stress_rand() / 4294967296.0)); }
+static uint32_t _stress_pick(uint32_t n) { return (_stress_rand() % n); }
+static double _stress_round(double v) { return (round(v * 10000) / 10000); }
+
+static double _stress_clamp(double v, double min, double max) { return ((v < min) ? min : ((v > max) ? max : v)); }
+
+// write a G0 or G1 to x, y, z (clamped to the box) and track where it ends
+static void _stress_move(const char *g, double x, double y, double z)
+{
+    st.pos[0] = _stress_round(_stress_clamp(x, 0, STRESS_XY_MAX));
+    st.pos[1] = _stress_round(_stress_clamp(y, 0, STRESS_XY_MAX));
+    st.pos[2] = _stress_round(_stress_clamp(z, STRESS_Z_MIN, 0));
+    fprintf(st.f, "%s X%.4f Y%.4f Z%.4f\n", g, st.pos[0], st.pos[1], st.pos[2]);
+}
+
+static void _stress_micro_segments()
+{
+    double heading = _stress_uniform(0, 2 * M_PI);
+    for (uint32_t i = 5 + _stress_pick(36); i > 0; i--) {
+        double length = _stress_uniform(0.005, 0.1);
+        heading += _stress_uniform(-0.5, 0.5);
+        _stress_move("G1", st.pos[0] + length * cos(heading), st.pos[1] + length * sin(heading), st.pos[2]);
+    }
+}
+
+static void _stress_reversal()
+{
+    double x = st.pos[0], y = st.pos[1], z = st.pos[2];
+    _stress_move("G1", x + _stress_uniform(-5, 5), y + _stress_uniform(-5, 5), z);
+    _stress_move("G1", x, y, z);
+}
+
+// an arc from the current point around a center that keeps the whole circle in the box
+static void _stress_arc()
+{
+    double radius = _stress_uniform(1, 20);
+    double start = _stress_uniform(0, 2 * M_PI);            // angle of the current point about the center
+    double cx = st.pos[0] - radius * cos(start);
+    double cy = st.pos[1] - radius * sin(start);
+
+    if ((cx < radius) || (cx > STRESS_XY_MAX - radius) || (cy < radius) || (cy > STRESS_XY_MAX - radius)) {
+        _stress_reversal();                                 // no room here
+        return;
+    }
+    bool cw = _stress_pick(2);
+    double end = start + (cw ? -1 : 1) * _stress_uniform(0.3, 5);
+    double i = _stress_round(cx - st.pos[0]);
+    double j = _stress_round(cy - st.pos[1]);
+    st.pos[0] = _stress_round(cx + radius * cos(end));
+    st.pos[1] = _stress_round(cy + radius * sin(end));
+    fprintf(st.f, "%s X%.4f Y%.4f I%.4f J%.4f\n", cw ? "G2" : "G3", st.pos[0], st.pos[1], i, j);
+}
+
+static void _stress_traverse()
+{
+    _stress_move("G0", _stress_uniform(0, STRESS_XY_MAX), _stress_uniform(0, STRESS_XY_MAX),
+                 _stress_uniform(STRESS_Z_MIN, 0));
+}
+
+static void _stress_feedhold()
+{
+    fprintf(st.f, "!\n");
+    for (uint32_t i = 1 + _stress_pick(3); i > 0; i--) {    // keep the cycle start close - it must get
+        _stress_reversal();                                 // into the receive buffer behind the hold
+    }
+    fprintf(st.f, "~\n");
+}
+
+/*
+ * stress_generate() - write a job of blocks random blocks from seed to path
+ *
+ *  Returns false if the file cannot be written. end[] gets the final X, Y and Z.
+ */
+
+bool stress_generate(uint32_t seed, uint32_t blocks, const char *path, float end[])
+{
+    if ((st.f = fopen(path, "w")) == NULL) {
+        return (false);
+    }
+    st.rand = (seed != 0) ? seed : 1;
+    st.pos[0] = st.pos[1] = st.pos[2] = 0;
+
+    fprintf(st.f, "(stress job, seed %lu, %lu blocks)\nG21 G90 G17 G94 G64 M48 F2000\nG0 X0 Y0 Z0\n",
+            (unsigned long)seed, (unsigned long)blocks);
+    for (uint32_t block = 0; block < blocks; block++) {
+        uint32_t kind = _stress_pick(100);
+        if (kind < 40)      { _stress_micro_segments(); }
+        else if (kind < 55) { _stress_reversal(); }
+        else if (kind < 75) { _stress_arc(); }
+        else if (kind < 85) { _stress_traverse(); }
+        else if (kind < 92) { fprintf(st.f, "F%lu\n", (unsigned long)(100 + _stress_pick(5901))); }
+        else if (kind < 97) { fprintf(st.f, "M50 P%.2f\n", _stress_uniform(0.5, 1.5)); }
+        else                { _stress_feedhold(); }
+    }
+    fprintf(st.f, "M50 P1\n");
+    _stress_traverse();
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        end[axis] = st.pos[axis];
+    }
+    return (fclose(st.f) == 0);
+}
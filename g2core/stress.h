@@ -0,0 +1,55 @@
+/*
+ * stress.h - randomized planner stress jobs
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * PLANNER STRESS JOBS
+ *
+ *  stress_generate() writes a random but valid motion job from a seed. The same seed
+ *  always writes the same job, on any platform, so a failure found by a seed can be run
+ *  again, or the job file kept and run as an ordinary job. A job mixes:
+ *
+ *    micro-segments      runs of 5 to 40 lines 5 to 100 um long, in wandering directions
+ *    reversals           a move immediately retraced
+ *    arcs                G2/G3 of 1 to 20 mm radius and up to most of a turn
+ *    traverses           long G0 moves, including Z
+ *    feed changes        F from 100 to 6000 mm/min
+ *    overrides           M50 P0.5 to P1.5 (feed override), enabled with M48 at the start
+ *    feedholds           '!' then a cycle start '~' a few lines later, so holds land mid-block
+ *
+ *  Motion stays inside a 100 x 100 x 10 mm box at and below the starting position
+ *  (X and Y 0..100, Z -10..0). Every job ends with a G0 to a final point, which is
+ *  returned so the runner can check the position the machine ended at (see sim_harness.h).
+ */
+
+#ifndef STRESS_H_ONCE
+#define STRESS_H_ONCE
+
+#define STRESS_DEFAULT_BLOCKS   2000        // generated blocks (a burst of micro-segments is one block)
+#define STRESS_POSITION_TOLERANCE 0.001     // most mm the final position may be off before the job fails
+
+bool stress_generate(uint32_t seed, uint32_t blocks, const char *path, float end[]);
+
+#endif  // End of include guard: STRESS_H_ONCE
@@ -0,0 +1,229 @@
+/*
+ * sync.cpp - motion synchronization between boards
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "sync.h"
+#include "canonical_machine.h"
+#include "controller.h"
+#include "gpio.h"
+#include "stepper.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+/**** Sync singleton structure ****/
+
+syncSingleton_t sy;
+
+/*
+ * _set_line() - drive a sync output, if the line has one
+ * _alarmed()  - true if the machine is in an alarm, shutdown or panic
+ */
+
+static void _set_line(const uint8_t output, const bool active)
+{
+    if (output != 0) {
+        gpio_set_output(output-1, active ? 1.0 : 0.0);
+    }
+}
+
+static bool _alarmed()
+{
+    cmMachineState state = cm_get_machine_state();
+    return ((state == MACHINE_ALARM) || (state == MACHINE_SHUTDOWN) || (state == MACHINE_PANIC));
+}
+
+/*
+ * sync_dda_start() - the DDA is about to start. Returns false if it must wait for the tick line
+ * sync_leader_tick() - end the tick pulse, and start the next one every SYNC_PHASE_TICKS
+ *
+ *  Both run in the DDA or a higher priority interrupt. A follower outside a machining
+ *  cycle starts on its own.
+ */
+
+bool sync_dda_start()
+{
+    if (sy.mode == SYNC_LEADER) {
+        sy.phase_ticks = 0;
+        sy.tick_active = true;
+        _set_line(sy.tick_output, true);
+        return (true);
+    }
+    return ((sy.mode != SYNC_FOLLOWER) || (sy.tick_input == 0) || (cm->cycle_type != CYCLE_MACHINING));
+}
+
+void sync_leader_tick()
+{
+    if (sy.tick_active) {
+        sy.tick_active = false;
+        _set_line(sy.tick_output, false);
+    }
+    if (++sy.phase_ticks >= SYNC_PHASE_TICKS) {
+        sy.phase_ticks = 0;
+        sy.tick_active = true;
+        _set_line(sy.tick_output, true);
+    }
+}
+
+/*
+ * sync_owns_input()    - true if the input is a sync line (it then has no lockout, action or function)
+ * sync_input_changed() - act on a sync input edge - called from the input's ISR
+ */
+
+bool sync_owns_input(const uint8_t input)
+{
+    return ((sy.mode != SYNC_OFF) &&
+            ((input == sy.tick_input) || (input == sy.hold_input) || (input == sy.alarm_input)));
+}
+
+void sync_input_changed(const uint8_t input, const ioState state)
+{
+    if (state != INPUT_ACTIVE) {
+        return;                                 // the lines act on leading edges only
+    }
+    if ((input == sy.tick_input) && (sy.mode == SYNC_FOLLOWER)) {
+        st_sync_tick();
+    }
+    if ((input == sy.hold_input) && !sy.hold_driven) {
+        sy.hold_remote = true;                  // set first so the request is not driven back
+        cm_request_feedhold(FEEDHOLD_TYPE_HOLD, FEEDHOLD_EXIT_STOP);
+    }
+    if ((input == sy.alarm_input) && !sy.alarm_driven) {
+        sy.alarm_remote = true;
+        cm_alarm(STAT_ALARM, "sync alarm");
+    }
+}
+
+/*
+ * sync_hold_requested() - a feedhold has been accepted. Drive the hold line unless it came from it
+ * sync_alarm_raised()   - an alarm, shutdown or panic has been raised. Drive the alarm line likewise
+ * sync_callback()       - release the lines when the hold or alarm ends - runs every controller pass
+ *
+ *  The lines are driven as soon as the hold or alarm starts, and released from the
+ *  main loop once the machine has been through it and come out. A hold or alarm that
+ *  could not be taken because nothing was moving still leaves an edge for one pass.
+ */
+
+void sync_hold_requested()
+{
+    if ((sy.mode != SYNC_OFF) && !sy.hold_remote && !sy.hold_driven) {
+        sy.hold_driven = true;
+        _set_line(sy.hold_output, true);
+    }
+}
+
+void sync_alarm_raised()
+{
+    if ((sy.mode != SYNC_OFF) && !sy.alarm_remote && !sy.alarm_driven) {
+        sy.alarm_driven = true;
+        _set_line(sy.alarm_output, true);
+    }
+}
+
+void sync_callback()
+{
+    bool idle = (cm1.machine_state != MACHINE_CYCLE) && (cm1.hold_state == FEEDHOLD_OFF);
+
+    if (cm1.hold_state != FEEDHOLD_OFF) {
+        sy.hold_seen = true;
+    } else if (sy.hold_seen || idle) {         // the hold has ended, or was never taken
+        sy.hold_seen = false;
+        sy.hold_remote = false;
+        if (sy.hold_driven) {
+            sy.hold_driven = false;
+            _set_line(sy.hold_output, false);
+        }
+    }
+    if (_alarmed()) {
+        sy.alarm_seen = true;
+    } else if (sy.alarm_seen || idle) {        // cleared, or raised with no motion to stop
+        sy.alarm_seen = false;
+        sy.alarm_remote = false;
+        if (sy.alarm_driven) {
+            sy.alarm_driven = false;
+            _set_line(sy.alarm_output, false);
+        }
+    }
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ ***********************************************************************************/
+/*
+ * _line() - the input or output setting named by the token: sy + {t=tick, h=hold, a=alarm} + {i, o}
+ */
+
+static uint8_t *_line(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    bool output = (token[3] == 'o');
+    switch (token[2]) {
+        case 't': { return (output ? &sy.tick_output : &sy.tick_input); }
+        case 'h': { return (output ? &sy.hold_output : &sy.hold_input); }
+        default:  { return (output ? &sy.alarm_output : &sy.alarm_input); }
+    }
+}
+
+stat_t sy_get_symo(nvObj_t *nv) { return (get_integer(nv, sy.mode)); }
+stat_t sy_set_symo(nvObj_t *nv) { return (set_integer(nv, (uint8_t &)sy.mode, SYNC_OFF, SYNC_MODE_MAX)); }
+
+stat_t sy_get_in(nvObj_t *nv) { return (get_integer(nv, *_line(nv))); }
+stat_t sy_set_in(nvObj_t *nv) { return (set_integer(nv, *_line(nv), 0, D_IN_CHANNELS)); }
+
+stat_t sy_get_out(nvObj_t *nv) { return (get_integer(nv, *_line(nv))); }
+stat_t sy_set_out(nvObj_t *nv)
+{
+    uint8_t *output = _line(nv);
+    _set_line(*output, false);                  // release the line being replaced
+    return (set_integer(nv, *output, 0, D_OUT_CHANNELS));
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_symo[] = "[symo] sync mode%18d [0=off,1=leader,2=follower]\n";
+static const char fmt_sy_in[] = "[%s] sync %-5s line input%11d [0=none]\n";
+static const char fmt_sy_out[] = "[%s] sync %-5s line output%10d [0=none]\n";
+
+static void _print_line(nvObj_t *nv, const char *format)
+{
+    const char *token = cfgArray[nv->index].token;
+    const char *line = (token[2] == 't') ? "tick" : ((token[2] == 'h') ? "hold" : "alarm");
+    sprintf(cs.out_buf, format, token, line, (int)nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
+void sy_print_symo(nvObj_t *nv) { text_print(nv, fmt_symo); }   // TYPE_INT
+void sy_print_in(nvObj_t *nv) { _print_line(nv, fmt_sy_in); }
+void sy_print_out(nvObj_t *nv) { _print_line(nv, fmt_sy_out); }
+
+#endif // __TEXT_MODE
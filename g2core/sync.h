@@ -0,0 +1,125 @@
+/*
+ * sync.h - motion synchronization between boards
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * MULTI-BOARD SYNC
+ *
+ *  Boards that split the axes of one machine (a gantry, a tandem cell) run the same job
+ *  from the host, and are tied together by three lines between a digital output on one
+ *  board and a digital input on the other:
+ *
+ *      tick    leader {syto:n} -> follower {syti:n}. The leader pulses it for one DDA
+ *              tick when its DDA starts and every SYNC_PHASE_TICKS ticks while it runs.
+ *              A follower in a machining cycle loads its segment but holds its DDA until
+ *              the next pulse, and restarts the DDA timer on every pulse while it runs,
+ *              so both boards start together and tick in phase.
+ *      hold    {syho:n} -> {syhi:n}, both ways. Active while the board is in a feedhold
+ *              it started itself. A leading edge requests a feedhold.
+ *      alarm   {syao:n} -> {syai:n}, both ways. Active while the board is in an alarm,
+ *              shutdown or panic it raised itself. A leading edge raises an alarm.
+ *
+ *  {symo:} is 0 off, 1 leader, 2 follower. 0 for a line's input or output means the
+ *  line is not used. Sync inputs are handled in their pin change interrupt with no
+ *  lockout, and their input action and function settings are ignored. A hold or
+ *  alarm taken from the other board is not driven back to it, so a cycle start or
+ *  clear on one board does not bounce back as a new hold. Cycle start, clear and
+ *  homing are still sent to each board by the host; homing, probing and jogging
+ *  run unsynchronized.
+ */
+
+#ifndef SYNC_H_ONCE
+#define SYNC_H_ONCE
+
+#include "config.h"
+#include "gpio.h"
+
+#ifndef SYNC_PHASE_TICKS
+#define SYNC_PHASE_TICKS (FREQUENCY_DDA / 1000) // DDA ticks between leader phase pulses (1 ms)
+#endif
+
+typedef enum {
+    SYNC_OFF = 0,
+    SYNC_LEADER,                    // drives the tick line
+    SYNC_FOLLOWER                   // starts and phases its DDA from the tick line
+} syncMode;
+#define SYNC_MODE_MAX SYNC_FOLLOWER
+
+typedef struct syncSingleton {
+    syncMode mode;                  // {symo:}
+    uint8_t tick_input;             // {syti:} external input numbers, 0 = not used
+    uint8_t hold_input;             // {syhi:}
+    uint8_t alarm_input;            // {syai:}
+    uint8_t tick_output;            // {syto:} external output numbers, 0 = not used
+    uint8_t hold_output;            // {syho:}
+    uint8_t alarm_output;           // {syao:}
+
+    uint16_t phase_ticks;           // leader: DDA ticks since the last tick pulse
+    volatile bool tick_active;      // leader: tick pulse being driven
+    volatile bool hold_remote;      // the feedhold in effect was taken from the other board
+    volatile bool alarm_remote;     // the alarm in effect was taken from the other board
+    volatile bool hold_driven;      // hold output is active
+    volatile bool alarm_driven;     // alarm output is active
+    bool hold_seen;                 // the machine has entered the hold the line is driven for
+    bool alarm_seen;                // the machine has entered the alarm the line is driven for
+} syncSingleton_t;
+
+extern syncSingleton_t sy;
+
+/**** Function Prototypes ****/
+
+bool sync_dda_start(void);
+void sync_leader_tick(void);
+bool sync_owns_input(const uint8_t input);
+void sync_input_changed(const uint8_t input, const ioState state);
+void sync_hold_requested(void);
+void sync_alarm_raised(void);
+void sync_callback(void);
+
+// called by the DDA ISR on every tick
+static inline void sync_dda_tick(void) { if (sy.mode == SYNC_LEADER) { sync_leader_tick(); } }
+
+stat_t sy_get_symo(nvObj_t *nv);
+stat_t sy_set_symo(nvObj_t *nv);
+stat_t sy_get_in(nvObj_t *nv);
+stat_t sy_set_in(nvObj_t *nv);
+stat_t sy_get_out(nvObj_t *nv);
+stat_t sy_set_out(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void sy_print_symo(nvObj_t *nv);
+void sy_print_in(nvObj_t *nv);
+void sy_print_out(nvObj_t *nv);
+
+#else
+
+#define sy_print_symo tx_print_stub
+#define sy_print_in tx_print_stub
+#define sy_print_out tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: SYNC_H_ONCE
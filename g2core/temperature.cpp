@@ -39,6 +39,8 @@
 #include "util.h"
 #include "settings.h"
 
+#if TEMPERATURE_ENABLED == true     // the whole file (see temperature.h)
+
 
 /**** Local safety/limit settings ****/
 
@@ -94,6 +96,18 @@
 #define TEMP_MIN_RISE_DEGREES_FROM_TARGET (float)10.0
 #endif
 
+// Thermistors convert ADC readings through a table built from the Steinhart-Hart
+// coefficients, interpolating between entries. Set this false to run the exact
+// conversion on every reading instead (e.g. while calibrating).
+#ifndef TEMP_USE_LOOKUP_TABLE
+#define TEMP_USE_LOOKUP_TABLE true
+#endif
+
+// Thermistor readings are the average of 2^TEMP_ADC_OVERSAMPLE_SHIFT conversions.
+#ifndef TEMP_ADC_OVERSAMPLE_SHIFT
+#define TEMP_ADC_OVERSAMPLE_SHIFT 6
+#endif
+
 
 /**** Allocate structures ****/
 
@@ -107,13 +121,26 @@ using namespace Motate;
 const float kSystemVoltage = 3.3;
 
 
+// Sensor interface used by the heater table. Thermistor<> is the only implementation so far.
+struct ThermistorBase {
+    virtual float temperature() = 0;
+    virtual float get_resistance() = 0;
+    virtual float get_raw_adc() = 0;
+};
+
 template<pin_number adc_pin_num, uint16_t min_temp = 0, uint16_t max_temp = 300, uint32_t table_size=64>
-struct Thermistor {
+struct Thermistor : ThermistorBase {
     float c1, c2, c3, pullup_resistance, inline_resistance;
     // We'll pull adc top value from the adc_pin.getTop()
 
     ADCPin<adc_pin_num> adc_pin;
-    uint16_t raw_adc_value = 0;
+    float raw_adc_value = 0;            // decimated reading, with the extra resolution from oversampling
+    uint32_t sample_sum = 0;            // conversions accumulated since the last reading
+    uint32_t sample_count = 0;
+
+    // ADC reading at min_temp + i * (max_temp - min_temp) / (table_size - 1). Readings fall as
+    // temperature rises, so the table is in descending ADC order.
+    float lookup_table[table_size];
 
     typedef Thermistor<adc_pin_num, min_temp, max_temp, table_size> type;
 
@@ -150,21 +177,40 @@ struct Thermistor {
         c2 = (x-c3*v)/z;
         c1 = 1/temp_low_fixed-c3*pow(a1,3)-c2*a1;
 
-        //        int16_t temp = min_temp;
-        //        for (int i=0; temp < max_temp && i < table_size; i++) {
-        //            lookup_table[i][0] = adc_value(temp);
-        //            lookup_table[i][0] = temp;
-        //
-        //            temp += (min_temp-max_temp)/(table_size-1);
-        //        }
+        for (uint32_t i = 0; i < table_size; i++) {
+            lookup_table[i] = adc_value(min_temp + (float)i * (max_temp - min_temp) / (table_size - 1));
+        }
     };
 
-//    uint16_t adc_value_(int16_t temp) {
-//        float y = (c1 - (1/(temp+273.15))) / (2*c3);
-//        float x = sqrt(pow(c2 / (3*c3),3) + pow(y,2));
-//        float r = exp((x-y) - (x+y)); // resistance of thermistor
-//        return (r / (pullup_resistance + r)) * (adc_pin.getTop());
-//    };
+    // Inverse of Steinhart-Hart: the ADC reading expected at a given temperature
+    float adc_value(const float temp) {
+        float y = (c1 - (1/(temp+273.15))) / (2*c3);
+        float x = sqrt(pow(c2 / (3*c3),3) + pow(y,2));
+        float r = exp(cbrt(x-y) - cbrt(x+y)) + inline_resistance;  // resistance seen by the divider
+        return (r / (pullup_resistance + r)) * (adc_pin.getTop());
+    };
+
+    // Table lookup with linear interpolation. Readings outside min_temp..max_temp
+    // (including a disconnected thermistor) go through the exact conversion.
+    float temperature() override {
+        if (!TEMP_USE_LOOKUP_TABLE || (raw_adc_value > lookup_table[0]) ||
+            (raw_adc_value < lookup_table[table_size-1])) {
+            return (temperature_exact());
+        }
+        uint32_t lo = 0;                        // binary search for lookup_table[lo] >= adc > lookup_table[lo+1]
+        uint32_t hi = table_size - 1;
+        while (hi - lo > 1) {
+            uint32_t mid = (lo + hi) / 2;
+            if (raw_adc_value > lookup_table[mid]) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        float step = (float)(max_temp - min_temp) / (table_size - 1);
+        float fraction = (lookup_table[lo] - raw_adc_value) / (lookup_table[lo] - lookup_table[hi]);
+        return (min_temp + (lo + fraction) * step);
+    };
 
     float temperature_exact() {
         // Sanity check:
@@ -184,7 +230,9 @@ struct Thermistor {
         return (1/Tinv) - 273.15; // final temperature
     };
 
-    float get_resistance() {
+    float get_raw_adc() override { return raw_adc_value; }
+
+    float get_resistance() override {
         if (raw_adc_value < 1) {
             return -1; // invalid temperature from a thermistor
         }
@@ -194,8 +242,15 @@ struct Thermistor {
     }
 
     // Call back function from the ADC to tell it that the ADC has a new sample...
+    // Conversions are summed and the average is published once per 2^TEMP_ADC_OVERSAMPLE_SHIFT
+    // samples - a boxcar decimator that keeps the per-conversion work to an add and a compare.
     void adc_has_new_value() {
-        raw_adc_value = (adc_pin.getRaw() + (9 * raw_adc_value))/10;
+        sample_sum += adc_pin.getRaw();
+        if (++sample_count == (1UL << TEMP_ADC_OVERSAMPLE_SHIFT)) {
+            raw_adc_value = (float)sample_sum / (1UL << TEMP_ADC_OVERSAMPLE_SHIFT);
+            sample_sum = 0;
+            sample_count = 0;
+        }
     };
 };
 
@@ -245,36 +300,37 @@ void ADCPin<kADC0_PinNumber>::interrupt() {
 }
 #endif
 
-float last_reported_temp1 = 0; // keep track of what we've reported for SR generation
-float last_reported_temp2 = 0;
-float last_reported_temp3 = 0;
+// Heater FET interface used by the heater table
+struct HeaterOutputBase {
+    virtual void setFrequency(const uint32_t frequency) = 0;
+    virtual void write(const float duty) = 0;
+    virtual float read() = 0;
+};
 
+template<pin_number pinNum>
+struct HeaterOutput : HeaterOutputBase {
+    PWMOutputPin<pinNum> pin;// {kPWMPinInverted};
+
+    void setFrequency(const uint32_t frequency) override { pin.setFrequency(frequency); }
+    void write(const float duty) override { pin = duty; }
+    float read() override { return ((float)pin); }
+};
 
-// Output 1 FET info
-// DO_1: Extruder1_PWM
-const int16_t fet_pin1_freq = 100;
 #if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput1_PinNumber> fet_pin1;// {kPWMPinInverted};
+#define TEMP_HEATER_PIN(pinNum) pinNum
 #else
-PWMOutputPin<-1> fet_pin1;// {kPWMPinInverted};
+#define TEMP_HEATER_PIN(pinNum) -1
 #endif
 
+// DO_1: Extruder1_PWM
+HeaterOutput<TEMP_HEATER_PIN(kOutput1_PinNumber)> fet_pin1;
+
 // DO_2: Extruder2_PWM
-const int16_t fet_pin2_freq = 100;
-#if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput2_PinNumber> fet_pin2;// {kPWMPinInverted};
-#else
-PWMOutputPin<-1> fet_pin2;// {kPWMPinInverted};
-#endif
+HeaterOutput<TEMP_HEATER_PIN(kOutput2_PinNumber)> fet_pin2;
 
 // DO_11: Heated Bed FET
 // Warning, HeatBED is likely NOT a PWM pin, so it'll be binary output (duty cucle >= 50%).
-const int16_t fet_pin3_freq = 100;
-#if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput11_PinNumber> fet_pin3;// {kPWMPinInverted};
-#else
-PWMOutputPin<-1> fet_pin3;// {kPWMPinInverted};
-#endif
+HeaterOutput<TEMP_HEATER_PIN(kOutput11_PinNumber)> fet_pin3;
 
 
 // DO_3: Fan1A_PWM
@@ -444,19 +500,24 @@ struct PID {
 PID pid1 { 9.0f, 0.11f, 400.0f, TEMP_MIN_RISE_DEGREES_OVER_TIME }; // default values
 PID pid2 { 7.5f, 0.12f, 400.0f, TEMP_MIN_RISE_DEGREES_OVER_TIME }; // default values
 PID pid3 { 7.5f, 0.12f, 400.0f, TEMP_MIN_BED_RISE_DEGREES_OVER_TIME }; // default values
-Timeout pid_timeout;
 
 
-template<pin_number heater_fan_pinnum>
-struct HeaterFan {
-#if TEMPERATURE_OUTPUT_ON == 1
-    PWMOutputPin<heater_fan_pinnum> heater_fan_pin;
-#endif
+// Heater fan interface used by the heater table
+struct HeaterFanBase {
     float min_value = MIN_FAN_VALUE;
     float max_value = MAX_FAN_VALUE;
     float low_temp = MIN_FAN_TEMP;
     float high_temp = MIN_FAN_TEMP;
 
+    virtual void newTemp(float temp) = 0;
+};
+
+template<pin_number heater_fan_pinnum>
+struct HeaterFan : HeaterFanBase {
+#if TEMPERATURE_OUTPUT_ON == 1
+    PWMOutputPin<heater_fan_pinnum> heater_fan_pin;
+#endif
+
     HeaterFan() {
 #if TEMPERATURE_OUTPUT_ON == 1
         heater_fan_pin.setFrequency(200000);
@@ -464,7 +525,7 @@ struct HeaterFan {
 #endif
     }
 
-    void newTemp(float temp) {
+    void newTemp(float temp) override {
 #if TEMPERATURE_OUTPUT_ON == 1
         if ((temp > low_temp) && (temp < high_temp)) {
             heater_fan_pin = max_value * (((temp - low_temp)/(high_temp - low_temp))*(1.0 - min_value) + min_value);
@@ -479,6 +540,41 @@ struct HeaterFan {
 
 HeaterFan<kOutput3_PinNumber> heater_fan1;
 
+
+/**** Heater table ****
+ *
+ *  Everything below works on heaters[] - one row per heater, numbered from 1 in the
+ *  JSON ("he1", "pid1" ...). Adding a heater (a chamber, another extruder) takes its
+ *  sensor, output and PID objects above, one row here and the matching cfgArray rows.
+ *  The PIDs are run by temperature_pid_callback(), which the controller schedules every
+ *  CONTROLLER_TEMPERATURE_PID_MS, so each update costs one pass over the table at a fixed rate.
+ */
+
+struct Heater {
+    ThermistorBase *sensor;
+    HeaterOutputBase *output;
+    uint32_t output_frequency;      // PWM frequency of the heater FET (Hz)
+    PID *pid;
+    HeaterFanBase *fan;             // heater fan driven from this heater's temperature, or nullptr
+    float last_reported_temp;       // keep track of what we've reported for SR generation
+    float last_temp;                // reading taken by the last temperature_pid_callback() pass
+};
+
+static Heater heaters[] = {
+    { &thermistor1, &fet_pin1, 100, &pid1, &heater_fan1, 0, 0 },
+    { &thermistor2, &fet_pin2, 100, &pid2, nullptr,      0, 0 },
+    { &thermistor3, &fet_pin3, 100, &pid3, nullptr,      0, 0 },
+};
+#define HEATERS (sizeof(heaters) / sizeof(heaters[0]))
+
+static Heater *_get_heater(const uint8_t heater)   // heater number is 1-based
+{
+    if ((heater < 1) || (heater > HEATERS)) {
+        return (nullptr);
+    }
+    return (&heaters[heater - 1]);
+}
+
 /**** Static functions ****/
 
 
@@ -488,11 +584,10 @@ HeaterFan<kOutput3_PinNumber> heater_fan1;
 void temperature_init()
 {
     // setup heater PWM
-    fet_pin1.setFrequency(fet_pin1_freq);
-    fet_pin1.setInterrupts(kInterruptOnOverflow|kInterruptPriorityLowest);
-
-    fet_pin2.setFrequency(fet_pin2_freq);
-    fet_pin3.setFrequency(fet_pin3_freq);
+    for (uint8_t i = 0; i < HEATERS; i++) {
+        heaters[i].output->setFrequency(heaters[i].output_frequency);
+    }
+    fet_pin1.pin.setInterrupts(kInterruptOnOverflow|kInterruptPriorityLowest);
 
 //    fan_pin1 = 0;
 //    fan_pin1.setFrequency(200000);
@@ -512,79 +607,60 @@ void temperature_init()
 void temperature_reset()
 {
     // make setpoint 0
-    fet_pin1 = 0.0f;
-    pid1._set_point = 0.0;
-
-    fet_pin2 = 0.0f;
-    pid2._set_point = 0.0;
-
-    fet_pin3 = 0.0f;
-    pid3._set_point = 0.0;
-
-    pid_timeout.set(100);
+    for (uint8_t i = 0; i < HEATERS; i++) {
+        heaters[i].output->write(0.0f);
+        heaters[i].pid->_set_point = 0.0;
+    }
 }
 
 // Minimum difference in temp before it'll trigger an SR
 const float kTempDiffSRTrigger = 0.25;
 
+/*
+ * temperature_callback()     - heater safety: force heaters off in alarm
+ * temperature_pid_callback() - fixed-rate PID update for all heaters
+ */
+
 stat_t temperature_callback()
 {
     if (cm->machine_state == MACHINE_ALARM) {
-        // Force the heaters off (redundant with the safety circuit)
-        fet_pin1 = 0.0;
-        fet_pin2 = 0.0;
-        fet_pin3 = 0.0;
-
-        // Force all PIDs to off too
-        pid1._set_point = 0.0;
-        pid2._set_point = 0.0;
-        pid3._set_point = 0.0;
+        for (uint8_t i = 0; i < HEATERS; i++) {
+            heaters[i].output->write(0.0);      // Force the heaters off (redundant with the safety circuit)
+            heaters[i].pid->_set_point = 0.0;   // Force all PIDs to off too
+        }
+    }
+    return (STAT_OK);
+}
 
-        return (STAT_OK);
+stat_t temperature_pid_callback()
+{
+    if (cm->machine_state == MACHINE_ALARM) {
+        return (STAT_OK);                       // heaters are held off by temperature_callback()
     }
 
-    if (pid_timeout.isPast()) {
-        pid_timeout.set(100);
+    bool sr_requested = false;
 
+    for (uint8_t i = 0; i < HEATERS; i++) {
+        Heater *h = &heaters[i];
         float temp = 0.0;
-        bool sr_requested = false;
-
-        if (pid1._enable) {
-            temp = thermistor1.temperature_exact();
-            fet_pin1 = pid1.getNewOutput(temp);
-
-            if (fabs(temp - last_reported_temp1) > kTempDiffSRTrigger) {
-                last_reported_temp1 = temp;
-                sr_requested = true;
-            }
-        }
-
-        heater_fan1.newTemp(temp);
-
-        if (pid2._enable) {
-            temp = thermistor2.temperature_exact();
-            fet_pin2 = pid2.getNewOutput(temp);
 
-            if (fabs(temp - last_reported_temp2) > kTempDiffSRTrigger) {
-                last_reported_temp2 = temp;
-                sr_requested = true;
-            }
-        }
+        h->last_temp = h->sensor->temperature();
+        if (h->pid->_enable) {
+            temp = h->last_temp;
+            h->output->write(h->pid->getNewOutput(temp));
 
-        if (pid3._enable) {
-            temp = thermistor3.temperature_exact();
-            fet_pin3 = pid3.getNewOutput(temp);
-
-            if (fabs(temp - last_reported_temp3) > kTempDiffSRTrigger) {
-                last_reported_temp3 = temp;
+            if (fabs(temp - h->last_reported_temp) > kTempDiffSRTrigger) {
+                h->last_reported_temp = temp;
                 sr_requested = true;
             }
         }
-
-        if (sr_requested) {
-            sr_request_status_report(SR_REQUEST_TIMED);
+        if (h->fan != nullptr) {
+            h->fan->newTemp(temp);
         }
     }
+    if (sr_requested) {
+        sr_request_status_report(SR_REQUEST_TIMED);
+    }
     return (STAT_OK);
 }
 
@@ -597,24 +673,32 @@ stat_t temperature_callback()
  * CONFIGURATION AND INTERFACE FUNCTIONS
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
-/*  In these function there are usually 3 PIDs, so a simple switch works.
- *  The default is a failsafe - can only get there if it's set up in config_app, but not here.
+/*  The heater number comes from the group or token and indexes heaters[].
+ *  A nullptr is a failsafe - can only get there if it's set up in config_app, but not here.
  */
 
-// helpers 
+// helpers
 
-char _get_heater_number(nvObj_t *nv) {  // In these functions nv->group == "he1", "he2", or "he3"
+static Heater *_heater(nvObj_t *nv) {   // In these functions nv->group == "he1", "he2", or "he3"
     if (!nv->group[0]) {
-        return nv->token[2];
+        return _get_heater(nv->token[2] - '0');
     }
-    return nv->group[2];
+    return _get_heater(nv->group[2] - '0');
 }
 
-char _get_pid_number(nvObj_t *nv) { // In these functions, nv->group == "pid1", "pid2", or "pid3"
+static Heater *_pid_heater(nvObj_t *nv) {   // In these functions, nv->group == "pid1", "pid2", or "pid3"
     if (!nv->group[0]) {
-        return nv->token[3];
+        return _get_heater(nv->token[3] - '0');
     }
-    return nv->group[3];
+    return _get_heater(nv->group[3] - '0');
+}
+
+static stat_t _get_heater_float(nvObj_t *nv, const float value)
+{
+    nv->value_flt = value;
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
 }
 
 /****************************************************************************************
@@ -626,29 +710,27 @@ char _get_pid_number(nvObj_t *nv) { // In these functions, nv->group == "pid1",
 
 stat_t cm_get_heater_enable(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_int = pid1._enable; break; }
-        case '2': { nv->value_int = pid2._enable; break; }
-        case '3': { nv->value_int = pid3._enable; break; }
-        default: { return(STAT_INPUT_VALUE_RANGE_ERROR); break; }
+    Heater *h = _heater(nv);
+    if (h == nullptr) {
+        return(STAT_INPUT_VALUE_RANGE_ERROR);
     }
+    nv->value_int = h->pid->_enable;
     nv->valuetype = TYPE_BOOLEAN;
     return (STAT_OK);
 }
 
 stat_t cm_set_heater_enable(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._enable = nv->value_int; break; }
-        case '2': { pid2._enable = nv->value_int; break; }
-        case '3': { pid3._enable = nv->value_int; break; }
-        default: { return(STAT_INPUT_VALUE_RANGE_ERROR); break; }
+    Heater *h = _heater(nv);
+    if (h == nullptr) {
+        return(STAT_INPUT_VALUE_RANGE_ERROR);
     }
+    h->pid->_enable = nv->value_int;
     return (STAT_OK);
 }
 
 /****************************************************************************************
- * cm_get_heater_p() - set the P parameter of the PID 
+ * cm_get_heater_p() - set the P parameter of the PID
  * cm_set_heater_p() - set the P parameter of the PID
  * cm_get_heater_i() - set the I parameter of the PID
  * cm_set_heater_i() - set the I parameter of the PID
@@ -658,70 +740,45 @@ stat_t cm_set_heater_enable(nvObj_t *nv)
 
 stat_t cm_get_heater_p(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {  // there are three of them, so we can use a simple switch
-        case '1': { nv->value_flt = pid1._p_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._p_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._p_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_p_factor * 100.0));
 }
+
 stat_t cm_set_heater_p(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._p_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._p_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._p_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if (h != nullptr) {
+        h->pid->_p_factor = nv->value_flt / 100.0;
     }
     return (STAT_OK);
 }
 
 stat_t cm_get_heater_i(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = pid1._i_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._i_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._i_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_i_factor * 100.0));
 }
 
 stat_t cm_set_heater_i(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._i_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._i_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._i_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if (h != nullptr) {
+        h->pid->_i_factor = nv->value_flt / 100.0;
     }
     return (STAT_OK);
 }
 
 stat_t cm_get_heater_d(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = pid1._d_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._d_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._d_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_d_factor * 100.0));
 }
+
 stat_t cm_set_heater_d(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._d_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._d_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._d_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if (h != nullptr) {
+        h->pid->_d_factor = nv->value_flt / 100.0;
     }
     return (STAT_OK);
 }
@@ -735,77 +792,69 @@ stat_t cm_set_heater_d(nvObj_t *nv)
 
 float cm_get_set_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return pid1._set_point; break; }
-        case 2: { return pid2._set_point; break; }
-        case 3: { return pid3._set_point; break; }
-        default: { break; }
-    }
-    return 0.0;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->pid->_set_point);
 }
 
 stat_t cm_get_set_temperature(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_set_temperature(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_set_point));
 }
 
 void cm_set_set_temperature(const uint8_t heater, const float value)
 {
-    switch(heater) {
-        case 1: { pid1._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-        case 2: { pid2._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-        case 3: { pid3._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-
-        // default to quiet the compiler
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if (h != nullptr) {
+        h->pid->_set_point = min(TEMP_MAX_SETPOINT, value);
     }
 }
+
 stat_t cm_set_set_temperature(nvObj_t *nv)
 {
-    cm_set_set_temperature(_get_heater_number(nv) - '0', nv->value_flt);
+    Heater *h = _heater(nv);
+    if (h != nullptr) {
+        h->pid->_set_point = min(TEMP_MAX_SETPOINT, nv->value_flt);
+    }
     return (STAT_OK);
 }
 
 /****************************************************************************************
  * cm_get_fan_power() - get the set high-value setting of the heater fan
  * cm_set_fan_power() - set the set high-value setting of the heater fan
+ *
+ *  Heaters without a fan read back 0 and ignore sets.
  */
 
 float cm_get_fan_power(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return min(1.0f, heater_fan1.max_value); }
-//      case 2: { return min(1.0f, heater_fan2.max_value); }
-//      case 3: { return min(1.0f, heater_fan3.max_value); }
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if ((h == nullptr) || (h->fan == nullptr)) {
+        return 0.0;
     }
-    return 0.0;
+    return min(1.0f, h->fan->max_value);
 }
 
 stat_t cm_get_fan_power(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_fan_power(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, ((h == nullptr) || (h->fan == nullptr)) ? 0.0 : min(1.0f, h->fan->max_value)));
 }
 
 void cm_set_fan_power(const uint8_t heater, const float value)
 {
-    switch(heater) {
-        case 1: { heater_fan1.max_value = max(0.0f, value); break; }
-//      case 2: { heater_fan2.max_value = max(0.0, value); break; }
-//      case 3: { heater_fan3.max_value = max(0.0, value); break; }
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if ((h != nullptr) && (h->fan != nullptr)) {
+        h->fan->max_value = max(0.0f, value);
     }
 }
 
 stat_t cm_set_fan_power(nvObj_t *nv)
 {
-    cm_set_fan_power(_get_heater_number(nv) - '0', nv->value_flt);
+    Heater *h = _heater(nv);
+    if ((h != nullptr) && (h->fan != nullptr)) {
+        h->fan->max_value = max(0.0f, nv->value_flt);
+    }
     return (STAT_OK);
 }
 
@@ -816,24 +865,15 @@ stat_t cm_set_fan_power(nvObj_t *nv)
 
 stat_t cm_get_fan_min_power(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.min_value; break; }
-//      case '2': { nv->value_flt = heater_fan2.min_value; break; }
-//      case '3': { nv->value_flt = heater_fan3.min_value; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, ((h == nullptr) || (h->fan == nullptr)) ? 0.0 : h->fan->min_value));
 }
 
 stat_t cm_set_fan_min_power(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.max_value = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.min_value = min(0.0, nv->value_flt); break; }
-//      case '3': { heater_fan3.min_value = min(0.0, nv->value_flt); break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if ((h != nullptr) && (h->fan != nullptr)) {
+        h->fan->min_value = max(0.0f, nv->value_flt);
     }
     return (STAT_OK);
 }
@@ -845,24 +885,15 @@ stat_t cm_set_fan_min_power(nvObj_t *nv)
 
 stat_t cm_get_fan_low_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.low_temp; break; }
-//      case '2': { nv->value_flt = heater_fan2.low_temp; break; }
-//      case '3': { nv->value_flt = heater_fan3.low_temp; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }    
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, ((h == nullptr) || (h->fan == nullptr)) ? 0.0 : h->fan->low_temp));
 }
 
 stat_t cm_set_fan_low_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.low_temp = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.low_temp = min(0.0f, nv->value_flt); break; }
-//      case '3': { heater_fan3.low_temp = min(0.0f, nv->value_flt); break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if ((h != nullptr) && (h->fan != nullptr)) {
+        h->fan->low_temp = max(0.0f, nv->value_flt);
     }
     return (STAT_OK);
 }
@@ -874,24 +905,15 @@ stat_t cm_set_fan_low_temp(nvObj_t *nv)
 
 stat_t cm_get_fan_high_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.high_temp; break; }
-//      case '2': { nv->value_flt = heater_fan2.high_temp; break; }
-//      case '3': { nv->value_flt = heater_fan3.high_temp; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, ((h == nullptr) || (h->fan == nullptr)) ? 0.0 : h->fan->high_temp));
 }
 
 stat_t cm_set_fan_high_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.high_temp = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.high_temp = min(0.0f, nv->value_flt); break; }
-//      case '3': { heater_fan3.high_temp = min(0.0f, nv->value_flt); break; }
-        default: { break; }
+    Heater *h = _heater(nv);
+    if ((h != nullptr) && (h->fan != nullptr)) {
+        h->fan->high_temp = max(0.0f, nv->value_flt);
     }
     return (STAT_OK);
 }
@@ -902,18 +924,14 @@ stat_t cm_set_fan_high_temp(nvObj_t *nv)
 
 bool cm_get_at_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return pid1._at_set_point; }
-        case 2: { return pid2._at_set_point; }
-        case 3: { return pid3._at_set_point; }
-        default: { break; }
-    }
-    return false;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? false : h->pid->_at_set_point);
 }
 
 stat_t cm_get_at_temperature(nvObj_t *nv)
 {
-    nv->value_int = cm_get_at_temperature(_get_heater_number(nv) - '0');
+    Heater *h = _heater(nv);
+    nv->value_int = (h == nullptr) ? false : h->pid->_at_set_point;
     nv->precision = GET_TABLE_WORD(precision);
     nv->valuetype = TYPE_BOOLEAN;
     return (STAT_OK);
@@ -925,21 +943,14 @@ stat_t cm_get_at_temperature(nvObj_t *nv)
 
 float cm_get_heater_output(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return (float)fet_pin1; }
-        case 2: { return (float)fet_pin2; }
-        case 3: { return (float)fet_pin3; }
-        default: { break; }
-    }
-    return 0.0;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->output->read());
 }
 
 stat_t cm_get_heater_output(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_heater_output(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->output->read()));
 }
 
 /****************************************************************************************
@@ -948,38 +959,38 @@ stat_t cm_get_heater_output(nvObj_t *nv)
 
 stat_t cm_get_heater_adc(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = (float)thermistor1.raw_adc_value; break; }
-        case '2': { nv->value_flt = (float)thermistor2.raw_adc_value; break; }
-        case '3': { nv->value_flt = (float)thermistor3.raw_adc_value; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->sensor->get_raw_adc()));
 }
 
 /****************************************************************************************
- * cm_get_temperature() - get the current temperature
+ * cm_get_temperature()      - get the current temperature
+ * cm_get_last_temperature() - get the temperature read by the last PID pass
+ *
+ *  cm_get_last_temperature() is at most CONTROLLER_TEMPERATURE_PID_MS old and costs
+ *  nothing to read, so it suits hosts that poll (Marlin M105). Unlike a current reading
+ *  it doesn't touch the SR change tracking.
  */
 
+float cm_get_last_temperature(const uint8_t heater)
+{
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->last_temp);
+}
+
 float cm_get_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return (last_reported_temp1 = thermistor1.temperature_exact()); }
-        case 2: { return (last_reported_temp2 = thermistor2.temperature_exact()); }
-        case 3: { return (last_reported_temp3 = thermistor3.temperature_exact()); }
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if (h == nullptr) {
+        return 0.0;
     }
-    return 0.0;
+    return (h->last_reported_temp = h->sensor->temperature());
 }
 
 stat_t cm_get_temperature(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_temperature(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : (h->last_reported_temp = h->sensor->temperature())));
 }
 
 /****************************************************************************************
@@ -988,16 +999,8 @@ stat_t cm_get_temperature(nvObj_t *nv)
 
 stat_t cm_get_thermistor_resistance(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = thermistor1.get_resistance(); break; }
-        case '2': { nv->value_flt = thermistor2.get_resistance(); break; }
-        case '3': { nv->value_flt = thermistor3.get_resistance(); break; }
-
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->sensor->get_resistance()));
 }
 
 
@@ -1009,47 +1012,20 @@ stat_t cm_get_thermistor_resistance(nvObj_t *nv)
 
 stat_t cm_get_pid_p(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._proportional; break; }
-        case '2': { nv->value_flt = pid2._proportional; break; }
-        case '3': { nv->value_flt = pid3._proportional; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _pid_heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_proportional));
 }
 
 stat_t cm_get_pid_i(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._integral; break; }
-        case '2': { nv->value_flt = pid2._integral; break; }
-        case '3': { nv->value_flt = pid3._integral; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _pid_heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_integral));
 }
 
 stat_t cm_get_pid_d(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._derivative; break; }
-        case '2': { nv->value_flt = pid2._derivative; break; }
-        case '3': { nv->value_flt = pid3._derivative; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *h = _pid_heater(nv);
+    return (_get_heater_float(nv, (h == nullptr) ? 0.0 : h->pid->_derivative));
 }
 
 /***********************************************************************************
@@ -1080,3 +1056,5 @@ stat_t cm_get_pid_d(nvObj_t *nv)
 //void cm_print_sps(nvObj_t *nv)  { text_print(nv, fmt_sps);}     // TYPE_FLOAT
 
 #endif // __TEXT_MODE
+
+#endif // TEMPERATURE_ENABLED
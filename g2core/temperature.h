@@ -29,13 +29,34 @@
 #ifndef TEMPERATURE_H_ONCE
 #define TEMPERATURE_H_ONCE
 
+#include "settings.h"           // for TEMPERATURE_ENABLED
+
+/*
+ * TEMPERATURE_ENABLED false compiles out heater, fan and PID control along with their
+ * controller tasks and {he1:} / {pid1:} groups. The init and reset calls are left as
+ * empty inlines so callers don't need to test for it.
+ */
+#if (TEMPERATURE_ENABLED == false) && (MARLIN_COMPAT_ENABLED == true)
+#error "MARLIN_COMPAT_ENABLED requires TEMPERATURE_ENABLED"
+#endif
+
 /*
  * Global Scope Functions
  */
 
+#if TEMPERATURE_ENABLED == true
+
 void   temperature_init();
 void   temperature_reset();
 stat_t temperature_callback();
+stat_t temperature_pid_callback();
+
+#else
+
+inline void temperature_init() {}
+inline void temperature_reset() {}
+
+#endif
 
 stat_t cm_get_heater_enable(nvObj_t *nv);
 stat_t cm_set_heater_enable(nvObj_t *nv);
@@ -78,6 +99,7 @@ stat_t cm_get_heater_output(nvObj_t* nv);
 stat_t cm_get_heater_adc(nvObj_t* nv);
 
 float cm_get_temperature(const uint8_t heater);
+float cm_get_last_temperature(const uint8_t heater);
 stat_t cm_get_temperature(nvObj_t* nv);
 
 stat_t cm_get_thermistor_resistance(nvObj_t* nv);
@@ -25,6 +25,7 @@
  * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdarg.h>
 #include "g2core.h"
 #include "config.h"
 #include "canonical_machine.h"
@@ -121,8 +122,7 @@ static stat_t _text_parser_kernal(char *str, nvObj_t *nv)
         *rd = NUL;                              // terminate at end of name
         strncpy(nv->token, str, TOKEN_LEN);
         str = ++rd;
-        nv->value_int = atol(str);              // collect the number as an integer
-        nv->value_flt = strtof(str, &rd);       // collect the number as a float - rd used as end pointer
+        rd = atonum(str, &nv->value_flt, &nv->value_int, true); // collect float and integer - rd used as end pointer
         if (rd != str) {
             nv->valuetype = TYPE_FLOAT;         // provisionally set it as a float
         }
@@ -176,7 +176,9 @@ void text_response(const stat_t status, char *buf)
         p += sprintf(p, (char *)*nv->stringp);
     }
     sprintf(p, "\n");
+    xioLane lane = xio_set_lane(XIO_LANE_ACK);
     xio_writeline(buffer);
+    xio_set_lane(lane);
 }
 
 /***** PRINT FUNCTIONS ********************************************************
@@ -227,6 +229,119 @@ void tx_print(nvObj_t *nv) {
     }
 }
 
+/*
+ * text_sprintf() - sprintf() for the text mode format strings
+ *
+ *  Handles the conversions the fmt_ strings use - %s %c %d %i %u %f, with the '-' and '0'
+ *  flags, width, precision and an 'l' length. Literal text is copied and numbers are formatted
+ *  by fixedtoa() and a plain integer conversion, which avoids the libc printf engine and its
+ *  float support on every line of a $ listing. Any other conversion hands the whole format
+ *  to vsprintf(). Output matches sprintf() except that exact float ties round away from zero.
+ */
+
+static int _text_utoa(char *str, unsigned long n)
+{
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+    for (int i = 0; i < count; i++) {
+        str[i] = digits[count-1-i];
+    }
+    return (count);
+}
+
+int text_sprintf(char *buf, const char *format, ...)
+{
+    va_list ap, ap_fallback;
+    va_start(ap, format);
+    va_copy(ap_fallback, ap);
+
+    char *str = buf;
+    const char *f = format;
+    while (*f != NUL) {
+        if (*f != '%') {
+            *str++ = *f++;
+            continue;
+        }
+        if (*(++f) == '%') {
+            *str++ = *f++;
+            continue;
+        }
+        bool left = false;
+        bool zero = false;
+        for ( ; (*f == '-') || (*f == '0'); f++) {
+            if (*f == '-') { left = true; } else { zero = true; }
+        }
+        int width = 0;
+        while (isdigit(*f)) {
+            width = width * 10 + (*f++ - '0');
+        }
+        int precision = -1;
+        if (*f == '.') {
+            precision = 0;
+            while (isdigit(*(++f))) {
+                precision = precision * 10 + (*f - '0');
+            }
+        }
+        bool is_long = false;
+        if (*f == 'l') {
+            is_long = true;
+            f++;
+        }
+
+        char tmp[24];
+        const char *field = tmp;
+        int len;
+        char c = *f++;
+        if ((c == 's') && (precision < 0)) {
+            field = va_arg(ap, const char *);
+            len = strlen(field);
+        } else if ((c == 'c') && (precision < 0)) {
+            tmp[0] = (char)va_arg(ap, int);
+            len = 1;
+        } else if (((c == 'd') || (c == 'i')) && (precision < 0)) {
+            long n = is_long ? va_arg(ap, long) : va_arg(ap, int);
+            len = 0;
+            if (n < 0) {
+                tmp[len++] = '-';
+            }
+            len += _text_utoa(&tmp[len], (n < 0) ? -(unsigned long)n : (unsigned long)n);
+        } else if ((c == 'u') && (precision < 0)) {
+            len = _text_utoa(tmp, is_long ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int));
+        } else if ((c == 'f') && (precision <= 10)) {
+            len = fixedtoa(tmp, (float)va_arg(ap, double), (precision < 0) ? 6 : precision, sizeof(tmp)-1);
+        } else {
+            va_end(ap);                         // not one of ours - let libc do the whole line
+            int n = vsprintf(buf, format, ap_fallback);
+            va_end(ap_fallback);
+            return (n);
+        }
+
+        int pad = width - len;
+        if ((pad > 0) && !left) {
+            if (zero && (c != 's') && (c != 'c')) {
+                if (*field == '-') {            // sign goes ahead of the zeroes
+                    *str++ = *field++;
+                    len--;
+                }
+                while (pad-- > 0) { *str++ = '0'; }
+            } else {
+                while (pad-- > 0) { *str++ = ' '; }
+            }
+        }
+        memcpy(str, field, len);
+        str += len;
+        while (pad-- > 0) { *str++ = ' '; }     // left justified
+    }
+    *str = NUL;
+    va_end(ap);
+    va_end(ap_fallback);
+    return (str - buf);
+}
+
 /*
  * Text print primitives using external formats
  *
@@ -240,32 +355,32 @@ void text_print_nul(nvObj_t *nv, const char *string)
 
 void text_print_str(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, *nv->stringp);
+    text_sprintf(cs.out_buf, format, *nv->stringp);
     xio_writeline(cs.out_buf);
 }
 
 void text_print_int(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->value_int);
+    text_sprintf(cs.out_buf, format, nv->value_int);
     xio_writeline(cs.out_buf);
 }
 
 void text_print_flt(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->value_flt);
+    text_sprintf(cs.out_buf, format, nv->value_flt);
     xio_writeline(cs.out_buf);
 }
 
 void text_print_flt_units(nvObj_t *nv, const char *format, const char *units)
 {
-    sprintf(cs.out_buf, format, nv->value_flt, units);
+    text_sprintf(cs.out_buf, format, nv->value_flt, units);
     xio_writeline(cs.out_buf);
 }
 
 void text_print_bool(nvObj_t *nv, const char *format)
 {
 //    sprintf(cs.out_buf, format, !!((uint32_t)nv->value)?"True":"False");
-    sprintf(cs.out_buf, format, (nv->value_int ? "True" : "False"));
+    text_sprintf(cs.out_buf, format, (nv->value_int ? "True" : "False"));
     xio_writeline(cs.out_buf);
 }
 
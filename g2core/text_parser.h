@@ -64,6 +64,7 @@ void tx_print_ui8(nvObj_t* nv);
 void tx_print_int(nvObj_t* nv);
 void tx_print_flt(nvObj_t* nv);
 
+int text_sprintf(char* buf, const char* format, ...);  // sprintf() for fmt_ strings
 void text_print(nvObj_t* nv, const char* format);  // does all formats except units
 void text_print_nul(nvObj_t* nv, const char* format);
 void text_print_str(nvObj_t* nv, const char* format);
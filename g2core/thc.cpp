@@ -0,0 +1,204 @@
+/*
+ * thc.cpp - torch height control for plasma cutting
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "g2core.h"
+#include "config.h"
+#include "thc.h"
+#include "canonical_machine.h"
+#include "hardware.h"
+#include "spindle.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+/**** Arc voltage ADC ****/
+
+// Boards with a spare ADC input read the torch's voltage tap on ADC3 unless the
+// board or settings name another pin. Without one THC still runs but sees 0 volts.
+#ifndef THC_ADC_AVAILABLE
+#if defined(ADC3_AVAILABLE)
+#define THC_ADC_AVAILABLE ADC3_AVAILABLE
+#define THC_ADC_PinNumber kADC3_PinNumber
+#else
+#define THC_ADC_AVAILABLE 0
+#endif
+#endif
+
+/**** THC singleton structure ****/
+
+thcSingleton_t thc;
+
+#if THC_ADC_AVAILABLE == 1
+
+static ADCPin<THC_ADC_PinNumber> thc_adc_pin;
+
+// Conversions are summed between segments, so each segment sees the mean of
+// every conversion since the last one rather than a single noisy reading.
+namespace Motate {
+template<>
+void ADCPin<THC_ADC_PinNumber>::interrupt() {
+    thc.sample_sum += thc_adc_pin.getRaw();
+    thc.sample_count++;
+};
+}
+
+#endif
+
+/*
+ * _read_volts() - update thc.volts from the conversions since the last segment and start the next one
+ */
+
+static void _read_volts()
+{
+#if THC_ADC_AVAILABLE == 1
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t sum = thc.sample_sum;
+    uint32_t count = thc.sample_count;
+    thc.sample_sum = 0;
+    thc.sample_count = 0;
+    __set_PRIMASK(primask);
+
+    if (count > 0) {
+        thc.volts = (float)sum / count * thc.volts_full_scale / thc_adc_pin.getTop();
+    }
+    ADC_Module::startSampling();
+#endif
+}
+
+/*
+ * thc_segment() - update the Z offset for the segment about to be converted to steps
+ *
+ *  velocity and cruise_velocity are the segment's and the block's (mm/min), segment_time
+ *  is in minutes, and feed is false for traverses. Runs in the exec.
+ */
+
+void thc_segment(const float velocity, const float cruise_velocity, const float segment_time, const bool feed)
+{
+    float dt = segment_time * 60;       // seconds
+    _read_volts();
+
+    bool torch = (spindle.state == SPINDLE_CW) || (spindle.state == SPINDLE_CCW);
+    thc.arc_time = torch ? (thc.arc_time + dt) : 0;
+
+    float offset = 0;                   // released - slew back to zero
+    if (thc.enable && torch && feed && (thc.arc_time >= thc.arc_delay) && (cm->hold_state == FEEDHOLD_OFF)) {
+        if (velocity < thc.anti_dive * cruise_velocity) {
+            thc.running = false;        // anti-dive - hold the offset and integrator
+            return;
+        }
+        float error = thc.target_volts - thc.volts;    // arc too short (torch too low) is positive
+        thc.integral += error * dt;
+        if (thc.i_factor > 0) {         // don't wind up past what the offset can use
+            float limit = thc.max_correction / thc.i_factor;
+            thc.integral = min(max(thc.integral, -limit), limit);
+        }
+        float derivative = thc.running ? (error - thc.previous_error) / dt : 0;
+        thc.previous_error = error;
+        thc.running = true;
+
+        offset = thc.p_factor * error + thc.i_factor * thc.integral + thc.d_factor * derivative;
+        offset = min(max(offset, -thc.max_correction), thc.max_correction);
+    } else {
+        thc.integral = 0;
+        thc.running = false;
+    }
+    float step = thc.max_rate * segment_time;
+    thc.z_offset += min(max(offset - thc.z_offset, -step), step);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ ***********************************************************************************/
+
+stat_t thc_get_thce(nvObj_t *nv) { return (get_integer(nv, thc.enable)); }
+stat_t thc_set_thce(nvObj_t *nv)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {   // segment tables are chosen by it at block start
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    return (set_integer(nv, (uint8_t &)thc.enable, 0, 1));
+}
+
+stat_t thc_get_thcv(nvObj_t *nv) { return (get_float(nv, thc.target_volts)); }
+stat_t thc_set_thcv(nvObj_t *nv) { return (set_float_range(nv, thc.target_volts, 0, 500)); }
+stat_t thc_get_thcs(nvObj_t *nv) { return (get_float(nv, thc.volts_full_scale)); }
+stat_t thc_set_thcs(nvObj_t *nv) { return (set_float_range(nv, thc.volts_full_scale, 0, 1000)); }
+stat_t thc_get_thcp(nvObj_t *nv) { return (get_float(nv, thc.p_factor)); }
+stat_t thc_set_thcp(nvObj_t *nv) { return (set_float_range(nv, thc.p_factor, 0, 10)); }
+stat_t thc_get_thci(nvObj_t *nv) { return (get_float(nv, thc.i_factor)); }
+stat_t thc_set_thci(nvObj_t *nv) { return (set_float_range(nv, thc.i_factor, 0, 100)); }
+stat_t thc_get_thcd(nvObj_t *nv) { return (get_float(nv, thc.d_factor)); }
+stat_t thc_set_thcd(nvObj_t *nv) { return (set_float_range(nv, thc.d_factor, 0, 10)); }
+stat_t thc_get_thcm(nvObj_t *nv) { return (get_float(nv, thc.max_correction)); }
+stat_t thc_set_thcm(nvObj_t *nv) { return (set_float_range(nv, thc.max_correction, 0, 50)); }
+stat_t thc_get_thcr(nvObj_t *nv) { return (get_float(nv, thc.max_rate)); }
+stat_t thc_set_thcr(nvObj_t *nv) { return (set_float_range(nv, thc.max_rate, 0, 10000)); }
+stat_t thc_get_thca(nvObj_t *nv) { return (get_float(nv, thc.anti_dive)); }
+stat_t thc_set_thca(nvObj_t *nv) { return (set_float_range(nv, thc.anti_dive, 0, 1)); }
+stat_t thc_get_thcw(nvObj_t *nv) { return (get_float(nv, thc.arc_delay)); }
+stat_t thc_set_thcw(nvObj_t *nv) { return (set_float_range(nv, thc.arc_delay, 0, 60)); }
+
+stat_t thc_get_thcu(nvObj_t *nv) { return (get_float(nv, thc.volts)); }
+stat_t thc_get_thcz(nvObj_t *nv) { return (get_float(nv, thc.z_offset)); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_thce[] = "[thce] torch height control%12d [0=disable,1=enable]\n";
+static const char fmt_thcv[] = "[thcv] thc target arc voltage%12.1f V\n";
+static const char fmt_thcs[] = "[thcs] thc volts at ADC full scale%7.1f V\n";
+static const char fmt_thcp[] = "[thcp] thc proportional factor%11.4f mm/V\n";
+static const char fmt_thci[] = "[thci] thc integral factor%15.4f mm/V-s\n";
+static const char fmt_thcd[] = "[thcd] thc derivative factor%13.4f mm-s/V\n";
+static const char fmt_thcm[] = "[thcm] thc max correction%16.3f mm\n";
+static const char fmt_thcr[] = "[thcr] thc max correction rate%11.1f mm/min\n";
+static const char fmt_thca[] = "[thca] thc anti-dive velocity%12.2f x cruise\n";
+static const char fmt_thcw[] = "[thcw] thc arc delay%21.2f sec\n";
+static const char fmt_thcu[] = "[thcu] thc arc voltage%19.1f V\n";
+static const char fmt_thcz[] = "[thcz] thc Z correction%18.3f mm\n";
+
+void thc_print_thce(nvObj_t *nv) { text_print(nv, fmt_thce); }    // TYPE_INT
+void thc_print_thcv(nvObj_t *nv) { text_print(nv, fmt_thcv); }
+void thc_print_thcs(nvObj_t *nv) { text_print(nv, fmt_thcs); }
+void thc_print_thcp(nvObj_t *nv) { text_print(nv, fmt_thcp); }
+void thc_print_thci(nvObj_t *nv) { text_print(nv, fmt_thci); }
+void thc_print_thcd(nvObj_t *nv) { text_print(nv, fmt_thcd); }
+void thc_print_thcm(nvObj_t *nv) { text_print(nv, fmt_thcm); }
+void thc_print_thcr(nvObj_t *nv) { text_print(nv, fmt_thcr); }
+void thc_print_thca(nvObj_t *nv) { text_print(nv, fmt_thca); }
+void thc_print_thcw(nvObj_t *nv) { text_print(nv, fmt_thcw); }
+void thc_print_thcu(nvObj_t *nv) { text_print(nv, fmt_thcu); }
+void thc_print_thcz(nvObj_t *nv) { text_print(nv, fmt_thcz); }
+
+#endif // __TEXT_MODE
@@ -0,0 +1,145 @@
+/*
+ * thc.h - torch height control for plasma cutting
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * TORCH HEIGHT CONTROL
+ *
+ *  A plasma arc's voltage rises with the torch's height over the plate. THC reads it on
+ *  an ADC pin (through the divider the torch's voltage tap needs - {thcs:} is the arc
+ *  voltage at ADC full scale) and trims Z every segment to hold it at {thcv:}.
+ *
+ *  The trim is a Z offset added ahead of the kinematics transform, as mesh compensation
+ *  is (see kinematics.h). It moves Z between the planned targets without going through
+ *  the planner, and is not part of the reported position. thc_segment() is run by the
+ *  exec once per segment and updates the offset from the volts read since the last one:
+ *
+ *      - PID on the voltage error, output in mm: {thcp:} mm/V, {thci:} mm/V-s, {thcd:} mm-s/V
+ *      - offset clamped to +/-{thcm:} mm and slewed at no more than {thcr:} mm/min
+ *      - runs only when enabled, the torch (spindle) has been on for {thcw:} seconds,
+ *        the move is a feed, and there is no feedhold. Otherwise the offset slews back
+ *        to zero on the moves that follow - typically the retract
+ *      - anti-dive: while the segment velocity is below {thca:} x the block's cruise
+ *        velocity (corners, acceleration and deceleration) the arc voltage rises as the
+ *        torch slows, so the offset and the integrator are held where they are
+ *
+ *  Segment tables are not played while THC is enabled, since their steps are converted
+ *  ahead of time with whatever offset was current then.
+ */
+
+#ifndef THC_H_ONCE
+#define THC_H_ONCE
+
+#include "config.h"
+
+typedef struct thcSingleton {
+    bool enable;                    // {thce:}
+    float target_volts;             // {thcv:} arc voltage to hold
+    float volts_full_scale;         // {thcs:} arc voltage at ADC full scale
+    float p_factor;                 // {thcp:} mm per volt
+    float i_factor;                 // {thci:} mm per volt-second
+    float d_factor;                 // {thcd:} mm-seconds per volt
+    float max_correction;           // {thcm:} mm
+    float max_rate;                 // {thcr:} mm/min
+    float anti_dive;                // {thca:} fraction of cruise velocity below which the offset is held
+    float arc_delay;                // {thcw:} seconds after the torch comes on
+
+    float volts;                    // {thcu:} arc voltage from the last segment's samples
+    float z_offset;                 // {thcz:} Z correction in effect, mm
+    float integral;                 // volt-seconds
+    float previous_error;           // volts
+    bool  running;                  // the PID ran on the previous segment (previous_error is good)
+    float arc_time;                 // seconds the torch has been on while moving
+
+    volatile uint32_t sample_sum;   // ADC conversions since the last segment - written by the ADC interrupt
+    volatile uint32_t sample_count;
+} thcSingleton_t;
+
+extern thcSingleton_t thc;
+
+/**** Function Prototypes ****/
+
+void thc_segment(const float velocity, const float cruise_velocity, const float segment_time, const bool feed);
+
+// true when Z can move under a move that does not command it - an offset left from a
+// cut is slewed out by the moves after it, with THC enabled or not
+static inline bool thc_active(void) { return (thc.enable || (thc.z_offset != 0)); }
+
+stat_t thc_get_thce(nvObj_t *nv);
+stat_t thc_set_thce(nvObj_t *nv);
+stat_t thc_get_thcv(nvObj_t *nv);
+stat_t thc_set_thcv(nvObj_t *nv);
+stat_t thc_get_thcs(nvObj_t *nv);
+stat_t thc_set_thcs(nvObj_t *nv);
+stat_t thc_get_thcp(nvObj_t *nv);
+stat_t thc_set_thcp(nvObj_t *nv);
+stat_t thc_get_thci(nvObj_t *nv);
+stat_t thc_set_thci(nvObj_t *nv);
+stat_t thc_get_thcd(nvObj_t *nv);
+stat_t thc_set_thcd(nvObj_t *nv);
+stat_t thc_get_thcm(nvObj_t *nv);
+stat_t thc_set_thcm(nvObj_t *nv);
+stat_t thc_get_thcr(nvObj_t *nv);
+stat_t thc_set_thcr(nvObj_t *nv);
+stat_t thc_get_thca(nvObj_t *nv);
+stat_t thc_set_thca(nvObj_t *nv);
+stat_t thc_get_thcw(nvObj_t *nv);
+stat_t thc_set_thcw(nvObj_t *nv);
+stat_t thc_get_thcu(nvObj_t *nv);
+stat_t thc_get_thcz(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+void thc_print_thce(nvObj_t *nv);
+void thc_print_thcv(nvObj_t *nv);
+void thc_print_thcs(nvObj_t *nv);
+void thc_print_thcp(nvObj_t *nv);
+void thc_print_thci(nvObj_t *nv);
+void thc_print_thcd(nvObj_t *nv);
+void thc_print_thcm(nvObj_t *nv);
+void thc_print_thcr(nvObj_t *nv);
+void thc_print_thca(nvObj_t *nv);
+void thc_print_thcw(nvObj_t *nv);
+void thc_print_thcu(nvObj_t *nv);
+void thc_print_thcz(nvObj_t *nv);
+
+#else
+
+#define thc_print_thce tx_print_stub
+#define thc_print_thcv tx_print_stub
+#define thc_print_thcs tx_print_stub
+#define thc_print_thcp tx_print_stub
+#define thc_print_thci tx_print_stub
+#define thc_print_thcd tx_print_stub
+#define thc_print_thcm tx_print_stub
+#define thc_print_thcr tx_print_stub
+#define thc_print_thca tx_print_stub
+#define thc_print_thcw tx_print_stub
+#define thc_print_thcu tx_print_stub
+#define thc_print_thcz tx_print_stub
+
+#endif  // __TEXT_MODE
+
+#endif  // End of include guard: THC_H_ONCE
@@ -37,14 +37,18 @@
 #include "xio.h"                // for LAGERs
 
 
+#if (AXES >= 6)
 bool FLAGS_NONE[AXES] = { false, false, false, false, false, false };
 bool FLAGS_ONE[AXES]  = { true, false, false, false, false, false };
 bool FLAGS_ALL[AXES]  = { true, true, true, true, true, true };
+#else
+bool FLAGS_NONE[AXES] = INIT_AXES_FALSE;
+bool FLAGS_ONE[AXES]  = { true };
+bool FLAGS_ALL[AXES]  = INIT_AXES_TRUE;
+#endif
 
 /**** Vector utilities ****
  * copy_vector()            - copy vector of arbitrary length
- * vector_equal()           - test if vectors are equal
- * get_axis_vector_length(  - return the length of an axis vector
  * set_vector()             - load values into vector form
  * set_vector_by_axis()     - load a single value into a zero vector
  */
@@ -58,50 +62,24 @@ void copy_vector(float dst[], const float src[])
 }
 */
 
-uint8_t vector_equal(const float a[], const float b[])
-{
-    if ((fp_EQ(a[AXIS_X], b[AXIS_X])) &&
-        (fp_EQ(a[AXIS_Y], b[AXIS_Y])) &&
-        (fp_EQ(a[AXIS_Z], b[AXIS_Z])) &&
-        (fp_EQ(a[AXIS_A], b[AXIS_A])) &&
-        (fp_EQ(a[AXIS_B], b[AXIS_B])) &&
-        (fp_EQ(a[AXIS_C], b[AXIS_C]))) {
-        return (true);
-    }
-    return (false);
-}
-
-float get_axis_vector_length(const float a[], const float b[])
-{
-    return (sqrt(square(a[AXIS_X] - b[AXIS_X]) +
-                 square(a[AXIS_Y] - b[AXIS_Y]) +
-                 square(a[AXIS_Z] - b[AXIS_Z]) +
-                 square(a[AXIS_A] - b[AXIS_A]) +
-                 square(a[AXIS_B] - b[AXIS_B]) +
-                 square(a[AXIS_C] - b[AXIS_C])));
-}
+// vector_equal() and get_axis_vector_length() are inline in util.h
 
 float *set_vector(float x, float y, float z, float a, float b, float c)
 {
     vector[AXIS_X] = x;
     vector[AXIS_Y] = y;
     vector[AXIS_Z] = z;
-    vector[AXIS_A] = a;
-    vector[AXIS_B] = b;
-    vector[AXIS_C] = c;
+    if (AXIS_ACTIVE(AXIS_A)) { vector[AXIS_A] = a; }
+    if (AXIS_ACTIVE(AXIS_B)) { vector[AXIS_B] = b; }
+    if (AXIS_ACTIVE(AXIS_C)) { vector[AXIS_C] = c; }
     return (vector);
 }
 
 float *set_vector_by_axis(float value, uint8_t axis)
 {
     clear_vector(vector);
-    switch (axis) {
-        case (AXIS_X): vector[AXIS_X] = value; break;
-        case (AXIS_Y): vector[AXIS_Y] = value; break;
-        case (AXIS_Z): vector[AXIS_Z] = value; break;
-        case (AXIS_A): vector[AXIS_A] = value; break;
-        case (AXIS_B): vector[AXIS_B] = value; break;
-        case (AXIS_C): vector[AXIS_C] = value;
+    if (AXIS_ACTIVE(axis)) {
+        vector[axis] = value;
     }
     return (vector);
 }
@@ -238,6 +216,11 @@ uint32_t SysTickTimer_getValue()
  *  It suppresses trailing zeros and decimal points, 20.100 --> 20.1, 20.000 --> 20
  *  Like sprintf, floattoa returns length of string, less the terminating NUL character 
  *
+ *  The value is scaled by 10^precision from a table, rounded once, and the digits of the
+ *  resulting integer are peeled off with a multiply-high divide by 10, so the digit loop has
+ *  no divisions and no float arithmetic. Values too large to scale into 32 bits fall back to
+ *  _floattoa_wide(), which formats the integer and fraction parts separately.
+ *
  *  !!! Precision cannot be greater than 10 !!!
  */
 
@@ -270,6 +253,10 @@ char floattoa(char *str, float n, int precision, int maxlen /*= 16*/)
 
 // *** floattoa() starts here ***
 
+constexpr float scale_lookup_[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10     // precision 0 - 10
+};
+
 constexpr float round_lookup_[] = {
     0.5,          // precision 0
     0.05,         // precision 1
@@ -292,26 +279,11 @@ int c_strreverse(char * const t, const int count_, char hold = 0) {
     : count_;
 }
 
-char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen = 16
+static char _floattoa_wide(char *str, float n, int precision, int maxlen)
 {
-    // handle special cases
-    if (isnan(n)) {
-        strcpy(str, "nan");
-        return (3);
-    }
-    else if (isinf(n)) {
-        strcpy(str, "inf");
-        return (3);
-    }
-
     int length_ = 0;
     char *b_ = str;
 
-    if (n < 0.0) {
-        *b_++ = '-';
-        return floattoa(b_, -n, precision, maxlen-1) + 1;
-    }
-
     n += round_lookup_[precision];
     int int_length_ = 0;
     int integer_part_ = (int)n;
@@ -366,6 +338,85 @@ char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen
     return length_;
 }
 
+static inline uint32_t _div10(uint32_t v)   // exact v/10 for any 32 bit v
+{
+    return ((uint32_t)(((uint64_t)v * 0xCCCCCCCDULL) >> 35));
+}
+
+static char _floattoa(char *str, float n, int precision, int maxlen, bool strip)
+{
+    // handle special cases
+    if (isnan(n)) {
+        strcpy(str, "nan");
+        return (3);
+    }
+    else if (isinf(n)) {
+        strcpy(str, "inf");
+        return (3);
+    }
+
+    char *b_ = str;
+
+    if (n < 0.0) {
+        *b_++ = '-';
+        return _floattoa(b_, -n, precision, maxlen-1, strip) + 1;
+    }
+
+    float scaled_ = n * scale_lookup_[precision] + 0.5;
+    if (scaled_ >= 4294967040.0) {              // largest float below 2^32
+        if (!strip) {
+            return (snprintf(str, maxlen+1, "%.*f", precision, (double)n));
+        }
+        return _floattoa_wide(str, n, precision, maxlen);
+    }
+    uint32_t value_ = (uint32_t)scaled_;
+
+    // right strip trailing zeroes before emitting anything
+    while (strip && (precision > 0) && (value_ == _div10(value_) * 10)) {
+        value_ = _div10(value_);
+        precision--;
+    }
+
+    char digits_[12];                           // least significant first
+    int count_ = 0;
+    do {
+        uint32_t t_ = _div10(value_);
+        digits_[count_++] = '0' + (value_ - (t_*10));
+        value_ = t_;
+    } while (value_ > 0);
+    while (count_ <= precision) {               // leading zeroes so there is an integer digit
+        digits_[count_++] = '0';
+    }
+
+    int length_ = count_ + ((precision > 0) ? 1 : 0);
+    if (length_ > maxlen) {
+        *str = 0;
+        return 0;
+    }
+    while (count_ > 0) {
+        if (count_ == precision) {
+            *b_++ = '.';
+        }
+        *b_++ = digits_[--count_];
+    }
+    *b_ = 0;
+    return length_;
+}
+
+char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen = 16
+{
+    return (_floattoa(str, n, precision, maxlen, true));
+}
+
+/*
+ * fixedtoa() - floattoa() without zero suppression, as printf("%.*f") - 20.100 stays 20.100
+ */
+
+char fixedtoa(char *str, float n, int precision, int maxlen /*= 16*/)
+{
+    return (_floattoa(str, n, precision, maxlen, false));
+}
+
 /***********************************************************************************
  * inttoa() - integer to ASCII
  *
@@ -698,6 +749,103 @@ char inttoa(char *str, int n)
     return (strlen(str));
 }
 
+/******************************************
+ **** Fast ASCII to Number Conversion ****
+ ******************************************/
+
+/***********************************************************************************
+ * atonum() - convert a decimal number to float and integer in a single pass
+ *
+ *  Returns a pointer to the first character after the number, or str with zero
+ *  values if no digits were found (like strtod()). value_int is the truncated integer part, as atol()
+ *  would return. Leading blanks and a sign are accepted. If allow_exponent is set
+ *  an 'e' or 'E' exponent is also accepted - G-code must not set it as E is a word.
+ *
+ *  Digits are collected into one integer mantissa and scaled by a single divide, so
+ *  numbers with up to 7 significant digits (what CAM posts emit) round exactly once.
+ *  Digits past 9 significant digits only move the decimal scale. value_int saturates
+ *  at INT32_MAX. Locale is never consulted.
+ */
+
+static const float _pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+char *atonum(char *str, float *value, int32_t *value_int, bool allow_exponent)
+{
+    char *p = str;
+    bool negative = false;
+    bool digits = false;
+    uint32_t mantissa = 0;
+    int16_t scale = 0;                              // power of 10 to apply to the mantissa
+
+    while ((*p == ' ') || (*p == '\t')) {
+        p++;
+    }
+    if ((*p == '-') || (*p == '+')) {
+        negative = (*p++ == '-');
+    }
+    while ((*p >= '0') && (*p <= '9')) {            // integer part
+        if (mantissa < 100000000) {
+            mantissa = (mantissa * 10) + (*p - '0');
+        } else {
+            scale++;                                // dropped digit - still counts as a place
+        }
+        p++;
+        digits = true;
+    }
+    int32_t integer = (scale > 0) ? INT32_MAX : (int32_t)mantissa;
+    if (*p == '.') {                                // fraction part
+        p++;
+        while ((*p >= '0') && (*p <= '9')) {
+            if (mantissa < 100000000) {
+                mantissa = (mantissa * 10) + (*p - '0');
+                scale--;
+            }
+            p++;
+            digits = true;
+        }
+    }
+    if (!digits) {
+        *value = 0;
+        *value_int = 0;
+        return (str);
+    }
+    bool exponent_found = false;
+    if (allow_exponent && ((*p == 'e') || (*p == 'E'))) {
+        char *q = p + 1;
+        bool negative_exponent = false;
+        int16_t exponent = 0;
+
+        if ((*q == '-') || (*q == '+')) {
+            negative_exponent = (*q++ == '-');
+        }
+        if ((*q >= '0') && (*q <= '9')) {           // otherwise the 'e' is not part of the number
+            while ((*q >= '0') && (*q <= '9')) {
+                if (exponent < 100) {
+                    exponent = (exponent * 10) + (*q - '0');
+                }
+                q++;
+            }
+            scale += negative_exponent ? -exponent : exponent;
+            exponent_found = true;
+            p = q;
+        }
+    }
+    float result = (float)mantissa;
+    for (; scale > 9; scale -= 9) {
+        result *= _pow10[9];
+    }
+    for (; scale < -9; scale += 9) {
+        result /= _pow10[9];
+    }
+    result = (scale < 0) ? (result / _pow10[-scale]) : (result * _pow10[scale]);
+    if (exponent_found) {
+        integer = (result < 2147483648.0f) ? (int32_t)result : INT32_MAX;
+    }
+    *value = negative ? -result : result;
+    *value_int = negative ? -integer : integer;
+    return (p);
+}
+
 //*** debug utilities ***
 
 void LAGER(const char * msg)
@@ -56,8 +56,6 @@ extern float vector[AXES]; // vector of axes for passing to subroutines
 #define clear_vector(a) (memset(a,0,sizeof(a)))
 #define copy_vector(d,s) (memcpy(d,s,sizeof(d)))
 
-float get_axis_vector_length(const float a[], const float b[]);
-uint8_t vector_equal(const float a[], const float b[]);
 float *set_vector(float x, float y, float z, float a, float b, float c);
 float *set_vector_by_axis(float value, uint8_t axis);
 
@@ -68,9 +66,25 @@ float *set_vector_by_axis(float value, uint8_t axis);
 #define INIT_AXES_ONES   {1,1,1,1,1,1,1,1,1}
 #define INIT_AXES_FALSE  INIT_AXES_ZEROES
 #define INIT_AXES_TRUE   INIT_AXES_ONES
+#elif (AXES == 6)
+#define INIT_AXES_ZEROES {0,0,0,0,0,0}
+#define INIT_AXES_ONES   {1,1,1,1,1,1}
+#elif (AXES == 5)
+#define INIT_AXES_ZEROES {0,0,0,0,0}
+#define INIT_AXES_ONES   {1,1,1,1,1}
+#elif (AXES == 4)
+#define INIT_AXES_ZEROES {0,0,0,0}
+#define INIT_AXES_ONES   {1,1,1,1}
+#elif (AXES == 3)
+#define INIT_AXES_ZEROES {0,0,0}
+#define INIT_AXES_ONES   {1,1,1}
 #else
 #warning UNSUPPORTED AXES SETTING!
 #endif
+#ifndef INIT_AXES_FALSE
+#define INIT_AXES_FALSE  INIT_AXES_ZEROES
+#define INIT_AXES_TRUE   INIT_AXES_ONES
+#endif
 
 //*** math utilities ***
 
@@ -86,7 +100,9 @@ uint8_t isnumber(char c);
 char *escape_string(char *dst, char *src);
 uint16_t compute_checksum(char const *string, const uint16_t length);
 char floattoa(char *buffer, float in, int precision, int maxlen = 16);
+char fixedtoa(char *buffer, float in, int precision, int maxlen = 16);
 char inttoa(char *str, int n);
+char *atonum(char *str, float *value, int32_t *value_int, bool allow_exponent);
 
 //*** other utilities ***
 
@@ -141,6 +157,33 @@ inline T avg(const T a,const T b) {return (a+b)/2; }
 #define fp_TRUE(a) (a > EPSILON)
 #endif
 
+/*
+ * get_axis_vector_length() - return the length of the axis vector from b to a
+ * vector_equal()           - test if vectors are equal
+ *
+ *  Both cover all AXES. They are inline with a fixed trip count so the compiler can
+ *  unroll them into straight-line FPU code at the call site.
+ */
+
+inline float get_axis_vector_length(const float a[], const float b[])
+{
+    float length_square = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        length_square += square(a[axis] - b[axis]);
+    }
+    return (sqrt(length_square));
+}
+
+inline uint8_t vector_equal(const float a[], const float b[])
+{
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (fp_NE(a[axis], b[axis])) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
 // Constants
 #define MAX_LONG (2147483647)
 #define MAX_ULONG (4294967295)
@@ -165,22 +208,6 @@ inline T avg(const T a,const T b) {return (a+b)/2; }
 #define M_SQRT3 (1.73205080756888)
 #endif
 
-// Fraction part
-constexpr float c_atof_frac_(char *&p_, float v_, float m_) {
-    return ((*p_ >= '0') && (*p_ <= '9')) ? (v_ = ((v_) + ((*p_) - '0') * m_), c_atof_frac_(++p_, v_, m_ / 10.0)) : v_;
-}
-
-// Integer part
-template <typename int_type>
-constexpr float c_atof_int_(char *&p_, int_type v_) {
-    return (*p_ == '.')
-    ? (float)(v_) + c_atof_frac_(++p_, 0, 1.0 / 10.0)
-    : (((*p_ >= '0') && (*p_ <= '9')) ? ((v_ = ((*p_) - '0') + (v_ * 10)), c_atof_int_(++p_, v_)) : v_);
-}
-
-// Start portion
-constexpr float c_atof(char *&p_) { return (*p_ == '-') ? (c_atof_int_(++p_, 0) * -1.0) : ( (*p_ == '+') ? c_atof_int_(++p_, 0) : (c_atof_int_(p_, 0))); }
-
 // It's assumed that the string buffer contains at lest count_ non-\0 chars
 //constexpr int c_strreverse(char * const t, const int count_, char hold = 0) {
 //    return count_>1 ? (hold=*t, *t=*(t+(count_-1)), *(t+(count_-1))=hold), c_strreverse(t+1, count_-2), count_ : count_;
@@ -164,8 +164,13 @@ struct xioDeviceWrapperBase {                // C++ base class for device primit
     virtual void flushRead() {};       // This should call _flushLine() before flushing the device.
     virtual bool flushToCommand() { return false; };
     virtual int16_t write(const char *buffer, int16_t len) { return -1; };
+    virtual int16_t writeWhole(const char *buffer, int16_t len) { return -1; };
 
     virtual char *readline(devflags_t limit_flags, uint16_t &size) { return nullptr; };
+    virtual uint32_t headerExhaustedCount() { return 0; };
+    virtual void addStats(xioStats_t &stats) {};
+    virtual uint16_t takeCredits() { return 0; };
+    virtual uint16_t creditWindow() { return 0; };
 
 #if MARLIN_COMPAT_ENABLED == true
     virtual void exitFakeBootloaderMode() {};
@@ -195,6 +200,44 @@ struct xio_t {
         return false;
     };
 
+    uint32_t headerExhaustedCount() {
+        uint32_t count = 0;
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            count += DeviceWrappers[i]->headerExhaustedCount();
+        }
+        return count;
+    };
+
+    void getStats(xioStats_t &stats) {
+        stats = {};
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            DeviceWrappers[i]->addStats(stats);
+        }
+    };
+
+    // Credits are counted on every device so they never go stale, but only the data
+    // channel's are handed out - that is the one a host streams to
+    uint16_t takeCredits() {
+        uint16_t credits = 0;
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            uint16_t freed = DeviceWrappers[i]->takeCredits();
+            if (DeviceWrappers[i]->isDataAndActive()) {
+                credits += freed;
+            }
+        }
+        return credits;
+    };
+
+    uint16_t creditWindow() {
+        uint16_t window = 0;
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            if (DeviceWrappers[i]->isDataAndActive()) {
+                window += DeviceWrappers[i]->creditWindow();
+            }
+        }
+        return window;
+    };
+
     bool othersConnected(xioDeviceWrapperBase* except) {
         for (int8_t i = 0; i < _dev_count; ++i) {
             if((DeviceWrappers[i] != except) && (!DeviceWrappers[i]->isAlwaysDataAndCtrl()) && DeviceWrappers[i]->isConnected()) {
@@ -413,7 +456,7 @@ extern xio_t xio;
 
 // LineRXBuffer takes the Motate RXBuffer (which handles "transfers", usually DMA), 
 // and adds G2 line-reading semantics to it.
-template <uint16_t _size, typename owner_type, uint8_t _header_count = 8, uint16_t _line_buffer_size = RX_BUFFER_SIZE>
+template <uint16_t _size, typename owner_type, uint8_t _header_count = 16, uint16_t _line_buffer_size = RX_BUFFER_SIZE>
 struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     typedef RXBuffer<_size, owner_type, char> parent_type;
 
@@ -426,10 +469,13 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     using parent_type::isEmpty;
     using parent_type::_restartTransfer;
     using parent_type::_canBeRead;
+    using parent_type::getReadSpan;
+    using parent_type::consume;
 
 
     // START OF LineRXBuffer PROPER
     static_assert(((_header_count-1)&_header_count)==0, "_header_count must be 2^N");
+    static_assert(_line_buffer_size <= RX_BUFFER_SIZE, "_line_buffer_size must not exceed RX_BUFFER_SIZE");
 
     char _line_buffer[_line_buffer_size+1]; // hold exactly one line to return
     uint32_t _line_end_guard = 0xBEEF;
@@ -449,6 +495,11 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     volatile uint16_t _last_scan_offset;  // DIAGNOSTIC
 
     bool _last_returned_a_control = false;
+    uint16_t _read_pending = 0;         // length of the line last returned in place - consumed on the next readline()
+
+    uint32_t _header_exhausted_count = 0; // times readline() could not scan because all skip headers were in use
+    uint32_t _lines_skipped = 0;          // too-long lines that had their tail skipped
+    uint16_t _credit_offset = 0;          // _read_offset at the last takeCredits()
 
 #if MARLIN_COMPAT_ENABLED == true
     enum class STK500V2_State {
@@ -478,6 +529,22 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
     LineRXBuffer(owner_type owner) : parent_type{owner} {};
 
+    // Bytes read out of the ring since the last call. Every way of reading - lines, controls,
+    // skipped tails and flushes - moves _read_offset, so the credits follow the free space.
+    uint16_t takeCredits() {
+        uint16_t freed = (_read_offset - _credit_offset) & (_size-1);
+        _credit_offset = _read_offset;
+        return freed;
+    };
+
+    // Bytes a host can have in flight now: the ring less the DMA padding (see RXBuffer),
+    // what is still waiting in it, and a reserve for control lines sent outside the credits
+    uint16_t creditWindow() {
+        uint16_t waiting = (_getWriteOffset() - _read_offset) & (_size-1);
+        int32_t window = (int32_t)(_size - 1 - 4) - waiting - XIO_CREDIT_RESERVE;
+        return ((window > 0) ? window : 0);
+    };
+
     void init() {
         parent_type::init();
         _at_start_of_line = true;
@@ -490,7 +557,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             uint16_t end_offset;    // the offset of the next character to read after skipping
         };
 
-        static constexpr uint16_t _section_count = 16;
+        static constexpr uint16_t _section_count = _header_count;
         SkipSection _sections[_section_count];
 
         uint8_t read_section_idx;   // index of the first skip section to skip
@@ -558,6 +625,38 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
         return _canBeRead(_scan_offset);
     };
 
+    // true if any byte of word w equals the byte replicated through pattern
+    static bool _wordHasByte(const uint32_t w, const uint32_t pattern) {
+        uint32_t x = w ^ pattern;
+        return (((x - 0x01010101) & ~x & 0x80808080) != 0);
+    }
+
+    /*
+     * _skipLineBody() - advance _scan_offset a word at a time through the middle of a line
+     *
+     * Only CR, LF and NUL change scanner state once a line has started (single-character
+     * controls are only recognized at the start of a line), so whole words free of those
+     * can be stepped over without classifying each character. Stops short of the ring
+     * wrap, the last known write position, and the too-long-line split point so the
+     * per-character scan handles all of those exactly as before.
+     */
+    void _skipLineBody() {
+        uint16_t available = (_last_known_write_offset - _scan_offset) & (_size-1);
+
+        while ((available >= 4) &&
+               ((_scan_offset + 4) <= _size) &&
+               ((_last_line_length + 4) < (_line_buffer_size - 1))) {
+            uint32_t w;
+            memcpy(&w, &_data[_scan_offset], sizeof(w));
+            if (_wordHasByte(w, 0x0A0A0A0A) || _wordHasByte(w, 0x0D0D0D0D) || _wordHasByte(w, 0)) {
+                break;
+            }
+            _scan_offset = (_scan_offset + 4) & (_size-1);
+            _last_line_length += 4;
+            available -= 4;
+        }
+    }
+
     /*
      * _scanBuffer()
      *
@@ -628,6 +727,17 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     bool _scanBuffer() {
         _last_scan_offset = _scan_offset;
         while (_isMoreToScan()) {
+#if MARLIN_COMPAT_ENABLED == true
+            if (!_at_start_of_line && (_stk_parser_state == STK500V2_State::Done)) {
+#else
+            if (!_at_start_of_line) {
+#endif
+                _skipLineBody();
+                if (!_isMoreToScan()) {
+                    break;
+                }
+            }
+
             bool ends_line  = false;
             bool is_control = false;
             char c = _data[_scan_offset];
@@ -792,6 +902,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             } // if ends_line
             else if (_last_line_length == (_line_buffer_size - 1)) {
                 // force an end-of-line, splitting this line into two lines
+                _lines_skipped++;
                 _ignore_until_next_line = true;
                 _line_start_offset = _scan_offset;
                 _lines_found++;
@@ -817,11 +928,26 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
      *
      * Exit condition when a control is found: _line_start_offset and _scan_offset should be the same.
      * If the control was the first char of the buffer it also moves the _data_offset, marking it as read
+     *
+     * A data line that doesn't wrap the end of the ring is returned in place rather than
+     * copied to _line_buffer: its line ending is overwritten with the NUL, and it stays
+     * unread - so the transfer can't write over it - until the next call. Either way the
+     * line is only good until readline() is called again.
      */
     char *readline(bool control_only, uint16_t &line_size) {
+        if (_read_pending != 0) {
+            consume(_read_pending);     // the caller is done with the line returned in place
+            _read_pending = 0;
+        }
+
         // This is tricky: if we don't have room for more skip_sections, then we
         // can't scan any more for controls. So we don't scan, amd hope some lines are read.
-        bool found_control = _skip_sections.isFull() ? false : _scanBuffer();
+        bool found_control = false;
+        if (_skip_sections.isFull()) {
+            _header_exhausted_count++;
+        } else {
+            found_control = _scanBuffer();
+        }
 
         _restartTransfer();
 
@@ -914,6 +1040,19 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             c = _data[_read_offset];
         }
 
+        // return the line in place if it ends before the end of the ring
+        char *span;
+        uint16_t span_length = std::min(getReadSpan(span), (uint16_t)(_line_buffer_size - 1));
+        for (uint16_t i = 0; i < span_length; i++) {
+            if ((span[i] == '\r') || (span[i] == '\n')) {
+                span[i] = 0;
+                line_size = i;
+                _read_pending = i + 1;
+                --_lines_found;
+                return span;
+            }
+        }
+
         while (line_size < (_line_buffer_size - 1)) {
             _read_offset = (_read_offset+1)&(_size-1);
 
@@ -949,6 +1088,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
     // this is called from flushRead()
     void flush() {
+        _read_pending = 0;
         parent_type::flush();
         _scan_offset = _read_offset;
 
@@ -985,6 +1125,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
         // flush to.
 
         // move the read buffer up to where we ended scanning
+        _read_pending = 0;
         _read_offset = _scan_offset;
 
         // record that we have 0 lines (of data) in the buffer
@@ -1016,13 +1157,15 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
  *     void setConnectionCallback(std::function<void(bool)> &&callback)
  */
 
-template<typename Device>
+template<typename Device, uint16_t _rx_size = 1024, uint16_t _tx_size = 1024,
+         uint8_t _header_count = 16, uint16_t _line_buffer_size = RX_BUFFER_SIZE>
 struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for reading and writing
     Device _dev;
 
-    // TODO - make _buffer_size, _header_count, and _line_buffer_size configurable
-    LineRXBuffer<1024, Device> _rx_buffer;
-    TXBuffer<1024, Device> _tx_buffer;
+    // sizes are selected per device in board_xio.h
+    LineRXBuffer<_rx_size, Device, _header_count, _line_buffer_size> _rx_buffer;
+    TXBuffer<_tx_size, Device> _tx_buffer;
+    uint32_t _tx_bytes = 0;
 
     xioDeviceWrapper(Device dev, uint8_t _caps) : xioDeviceWrapperBase(_caps), _dev{dev}, _rx_buffer{_dev}, _tx_buffer{_dev}
     {
@@ -1064,7 +1207,23 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
         if (!isConnected()) {
             return -1;
         }
-        return _tx_buffer.write(buffer, len);
+        int16_t written = _tx_buffer.write(buffer, len);
+        if (written > 0) {
+            _tx_bytes += written;
+        }
+        return written;
+    }
+
+    // write all of buffer or none of it - never waits for the TX ring to drain
+    virtual int16_t writeWhole(const char *buffer, int16_t len) final {
+        if (!isConnected()) {
+            return -1;
+        }
+        if (_tx_buffer.space() < len) {
+            _tx_buffer._full_waits++;
+            return -1;
+        }
+        return write(buffer, len);
     }
 
     virtual char *readline(devflags_t limit_flags, uint16_t &size) final {
@@ -1076,6 +1235,27 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
         return NULL;
     };
 
+    uint32_t headerExhaustedCount() final {
+        return _rx_buffer._header_exhausted_count;
+    };
+
+    uint16_t takeCredits() final {
+        return _rx_buffer.takeCredits();
+    };
+
+    uint16_t creditWindow() final {
+        return _rx_buffer.creditWindow();
+    };
+
+    void addStats(xioStats_t &stats) final {
+        stats.rx_bytes += _rx_buffer._rx_bytes;
+        stats.tx_bytes += _tx_bytes;
+        stats.rx_stalls += _rx_buffer._stall_count;
+        stats.rx_high_water = std::max(stats.rx_high_water, (uint32_t)_rx_buffer._high_water);
+        stats.tx_full_waits += _tx_buffer._full_waits;
+        stats.lines_skipped += _rx_buffer._lines_skipped;
+    };
+
     void connectedStateChanged(bool connected) {
         if (connected) {
             if (isNotConnected()) {
@@ -1194,7 +1374,7 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
 
 
 // Specialization for xio_flash_file -- we don't need most of the structure around a Device for xio_flash_file
-template<uint16_t _line_buffer_size = 512>
+template<uint16_t _line_buffer_size = XIO_FLASH_LINE_BUFFER_SIZE>
 struct xioFlashFileDeviceWrapper : xioDeviceWrapperBase {    // describes a device for reading and writing
     xio_flash_file *_current_file = nullptr;
 
@@ -1275,12 +1455,14 @@ xioFlashFileDeviceWrapper<> flashFileWrapper {};
 // ALLOCATIONS
 // Declare a device wrapper class for SerialUSB and SerialUSB1
 #if XIO_HAS_USB == 1
-xioDeviceWrapper<decltype(&SerialUSB)> serialUSB0Wrapper {
+xioDeviceWrapper<decltype(&SerialUSB), XIO_USB0_RX_BUFFER_SIZE, XIO_USB0_TX_BUFFER_SIZE,
+                 XIO_USB0_HEADER_COUNT, XIO_USB0_LINE_BUFFER_SIZE> serialUSB0Wrapper {
     &SerialUSB,
     (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
 };
 #if USB_SERIAL_PORTS_EXPOSED == 2
-xioDeviceWrapper<decltype(&SerialUSB1)> serialUSB1Wrapper {
+xioDeviceWrapper<decltype(&SerialUSB1), XIO_USB1_RX_BUFFER_SIZE, XIO_USB1_TX_BUFFER_SIZE,
+                 XIO_USB1_HEADER_COUNT, XIO_USB1_LINE_BUFFER_SIZE> serialUSB1Wrapper {
     &SerialUSB1,
     (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
 };
@@ -1292,7 +1474,8 @@ constexpr devflags_t _serial0ExtraFlags = DEV_IS_ALWAYS_BOTH | DEV_IS_MUTE_SECON
 #else
 constexpr devflags_t _serial0ExtraFlags = DEV_IS_ALWAYS_BOTH;
 #endif
-xioDeviceWrapper<decltype(&Serial)> serial0Wrapper {
+xioDeviceWrapper<decltype(&Serial), XIO_UART_RX_BUFFER_SIZE, XIO_UART_TX_BUFFER_SIZE,
+                 XIO_UART_HEADER_COUNT, XIO_UART_LINE_BUFFER_SIZE> serial0Wrapper {
     &Serial,
     (DEV_CAN_READ | DEV_CAN_WRITE | _serial0ExtraFlags)
 };
@@ -1354,10 +1537,23 @@ stat_t xio_test_assertions()
 /*
  * write() - write a buffer to a device
  */
-int xiom_write(const char *buffer, int len);
+int xiom_write(const char *buffer, int len, int lane);
+static xioLane _lane = XIO_LANE_BULK;
+
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted /*= false*/)
 {
-	return xiom_write(buffer, size);//xio.write(buffer, size, only_to_muted);
+	return xiom_write(buffer, size, _lane);//xio.write(buffer, size, only_to_muted);
+}
+
+/*
+ * xio_set_lane() - send the following writes in lane; returns the lane it replaces
+ */
+
+xioLane xio_set_lane(xioLane lane)
+{
+    xioLane was = _lane;
+    _lane = lane;
+    return (was);
 }
 
 /*
@@ -1371,10 +1567,28 @@ char *xio_readline(devflags_t &flags, uint16_t &size)
 {
     return xio.readline(flags, size);
 }
-int xiom_writeline(const char *buffer);
+int xiom_writeline(const char *buffer, int lane);
 int16_t xio_writeline(const char *buffer, bool only_to_muted /*= false*/)
 {
-    return xiom_writeline(buffer); //xio.writeline(buffer, only_to_muted);
+    return xiom_writeline(buffer, _lane); //xio.writeline(buffer, only_to_muted);
+}
+
+/*
+ * xio_credit_window() - start a credit stream: drop the old counts and return the first grant
+ * xio_take_credits()  - RX bytes freed on the data channel since the last call
+ *
+ *  See _credit_report() in report.cpp for the protocol.
+ */
+
+uint16_t xio_credit_window()
+{
+    xio.takeCredits();
+    return (xio.creditWindow());
+}
+
+uint16_t xio_take_credits()
+{
+    return (xio.takeCredits());
 }
 
 /*
@@ -1412,6 +1626,342 @@ void xio_exit_fake_bootloader() {
 }
 #endif
 
+/***********************************************************************************
+ * Binary move channel
+ *
+ *  xio_binary_rx()         - feed one byte from a frames-only stream to the frame decoder
+ *  xio_binary_rx_at()      - feed one byte from a text stream to the frame decoder. Returns
+ *                            true if the byte was consumed as part of a binary frame, false
+ *                            if it should be handled as normal line input. mark is the
+ *                            stream position the frame sits at (see xio_usart_rx_reached()).
+ *  xio_binary_ready()      - true if the oldest decoded move can run now
+ *  xio_binary_read_move()  - copy the oldest decoded move into *move. Returns false if
+ *                            no move is waiting, or if the text in front of it hasn't been read.
+ *  xio_binary_overrun()    - true once if frames were dropped because the queue was full.
+ *                            *linenum is set to the line number of the first one dropped.
+ *  xio_binary_error_count()- number of frames dropped for bad length, checksum or overrun
+ *  xio_binary_encode()     - build the payload for a move. Returns the payload length
+ *  xio_binary_decode()     - unpack a payload into *move. Returns false if it is malformed
+ *
+ *  The decoder runs in the receive context and the reader runs in the controller, so
+ *  the decoded moves are passed through a single-producer / single-consumer ring.
+ *  Frames from the vendor bulk interface are pulled in by xio_binary_read_move() itself,
+ *  and only while the ring has room, so a fast host is held off by the endpoint instead
+ *  of losing frames.
+ *
+ *  In a text stream SYNC is only taken as a frame start at the start of a line (or right
+ *  after another frame). 0xA5 is a UTF-8 continuation byte, so it can't start a line of
+ *  text but can appear anywhere inside one. A frame runs only after the text received
+ *  before it has been read, so moves and lines execute in the order they were sent.
+ *
+ *  A frame that finds the queue full is dropped, and so is every frame after it until the
+ *  host resends the dropped one (a frame with the same line number). The controller reports
+ *  the overrun, so the host can go back to that line without the moves getting reordered.
+ ***********************************************************************************/
+
+bool xio_usart_rx_reached(const uint32_t mark);    // text stream has been read up to mark
+
+#if XIO_BINARY_CHANNEL_ENABLED == true
+
+enum xioBinaryRxState {
+    BIN_RX_IDLE = 0,                        // waiting for XIO_BINARY_SYNC
+    BIN_RX_LEN,                             // waiting for payload length
+    BIN_RX_PAYLOAD,                         // collecting payload
+    BIN_RX_CHECK                            // waiting for checksum byte
+};
+
+static struct xioBinary {
+    xioBinaryRxState state;
+    bool in_line;                           // text stream: inside a line, where SYNC is text
+    bool rx_sequenced;                      // frame being decoded came in a text stream
+    uint32_t rx_mark;                       // ...and sits at this stream position
+    uint8_t len;                            // payload length from the frame header
+    uint8_t count;                          // payload bytes received so far
+    uint8_t check;                          // running XOR of the payload
+    uint8_t payload[XIO_BINARY_PAYLOAD_MAX];
+
+    xioBinaryMove_t queue[XIO_BINARY_QUEUE_SIZE];
+    uint32_t mark[XIO_BINARY_QUEUE_SIZE];   // stream position of each sequenced move
+    bool sequenced[XIO_BINARY_QUEUE_SIZE];
+    volatile uint8_t head;                  // written by the receive side only
+    volatile uint8_t tail;                  // written by the controller only
+    volatile uint32_t errors;
+
+    volatile bool overrun;                  // receive side: dropping frames until the host resends
+    volatile int32_t overrun_line;          // line number of the first frame dropped
+    volatile bool overrun_reported;         // controller: the overrun has been reported
+} xb;
+
+static void _binary_queue()
+{
+    uint8_t next = (xb.head + 1) & (XIO_BINARY_QUEUE_SIZE - 1);
+    xioBinaryMove_t *move = &xb.queue[xb.head];
+
+    if (!xio_binary_decode(xb.payload, xb.len, move)) {
+        xb.errors++;
+        return;
+    }
+    if (xb.overrun) {                       // go back to the dropped frame, not past it
+        if ((move->linenum != xb.overrun_line) || (next == xb.tail)) {
+            if (move->linenum == xb.overrun_line) {
+                xb.overrun_reported = false;    // resent into a queue that's still full - report again
+            }
+            xb.errors++;
+            return;
+        }
+        xb.overrun = false;
+    } else if (next == xb.tail) {
+        xb.overrun_line = move->linenum;
+        xb.overrun_reported = false;
+        xb.overrun = true;
+        xb.errors++;
+        return;
+    }
+    xb.mark[xb.head] = xb.rx_mark;
+    xb.sequenced[xb.head] = xb.rx_sequenced;
+    xb.head = next;
+}
+
+static bool _binary_rx(const uint8_t c)
+{
+    switch (xb.state) {
+        case BIN_RX_IDLE: {
+            if (c != XIO_BINARY_SYNC) { return (false); }
+            xb.state = BIN_RX_LEN;
+            break;
+        }
+        case BIN_RX_LEN: {
+            if (c > XIO_BINARY_PAYLOAD_MAX) {
+                xb.errors++;
+                xb.state = BIN_RX_IDLE;
+                break;
+            }
+            xb.len = c;
+            xb.count = 0;
+            xb.check = 0;
+            xb.state = (c == 0) ? BIN_RX_CHECK : BIN_RX_PAYLOAD;
+            break;
+        }
+        case BIN_RX_PAYLOAD: {
+            xb.payload[xb.count++] = c;
+            xb.check ^= c;
+            if (xb.count == xb.len) { xb.state = BIN_RX_CHECK; }
+            break;
+        }
+        case BIN_RX_CHECK: {
+            xb.state = BIN_RX_IDLE;
+            if (c != xb.check) {
+                xb.errors++;
+                break;
+            }
+            _binary_queue();
+            break;
+        }
+    }
+    return (true);
+}
+
+bool xio_binary_rx(const uint8_t c)
+{
+    xb.rx_sequenced = false;
+    return (_binary_rx(c));
+}
+
+bool xio_binary_rx_at(const uint8_t c, const uint32_t mark)
+{
+    if ((xb.state == BIN_RX_IDLE) && xb.in_line) {
+        xb.in_line = (c != CR) && (c != LF);
+        return (false);                     // SYNC inside a line is text
+    }
+    xb.rx_sequenced = true;
+    xb.rx_mark = mark;
+    if (_binary_rx(c)) {
+        return (true);                      // frames can follow frames
+    }
+    xb.in_line = (c != CR) && (c != LF);
+    return (false);
+}
+
+#if (XIO_HAS_USB == 1) && (USB_VENDOR_BULK_EXPOSED == 1)
+#define XIO_VENDOR_RX_CHUNK 64              // bytes taken from the bulk endpoint at a time
+
+static struct xioVendorRx {
+    char buf[XIO_VENDOR_RX_CHUNK];
+    uint16_t len;
+    uint16_t pos;
+} xv;
+
+static void _vendor_rx()
+{
+    while (((xb.head + 1) & (XIO_BINARY_QUEUE_SIZE - 1)) != xb.tail) {
+        if (xv.pos == xv.len) {
+            xv.pos = 0;
+            if ((xv.len = VendorUSB.readSome(xv.buf, sizeof(xv.buf))) == 0) {
+                return;
+            }
+        }
+        xio_binary_rx(xv.buf[xv.pos++]);
+    }
+}
+#endif
+
+bool xio_binary_ready()
+{
+    if (xb.tail == xb.head) {
+        return (false);
+    }
+    return (!xb.sequenced[xb.tail] || xio_usart_rx_reached(xb.mark[xb.tail])); // text sent ahead of it has run
+}
+
+bool xio_binary_read_move(xioBinaryMove_t *move)
+{
+#if (XIO_HAS_USB == 1) && (USB_VENDOR_BULK_EXPOSED == 1)
+    _vendor_rx();
+#endif
+    if (!xio_binary_ready()) {
+        return (false);
+    }
+    *move = xb.queue[xb.tail];
+    xb.tail = (xb.tail + 1) & (XIO_BINARY_QUEUE_SIZE - 1);
+    return (true);
+}
+
+bool xio_binary_overrun(int32_t *linenum)
+{
+    if (!xb.overrun || xb.overrun_reported) {
+        return (false);
+    }
+    *linenum = xb.overrun_line;
+    xb.overrun_reported = true;
+    return (true);
+}
+
+uint32_t xio_binary_error_count() { return (xb.errors); }
+
+#else
+
+bool xio_binary_rx(const uint8_t c) { return (false); }
+bool xio_binary_rx_at(const uint8_t c, const uint32_t mark) { return (false); }
+bool xio_binary_ready() { return (false); }
+bool xio_binary_read_move(xioBinaryMove_t *move) { return (false); }
+bool xio_binary_overrun(int32_t *linenum) { return (false); }
+uint32_t xio_binary_error_count() { return (0); }
+
+#endif // XIO_BINARY_CHANNEL_ENABLED
+
+uint8_t xio_binary_encode(const xioBinaryMove_t *move, uint8_t *payload)
+{
+    uint8_t *p = payload;
+    uint16_t axes = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (move->flags[axis]) { axes |= (1 << axis); }
+    }
+    memcpy(p, &axes, sizeof(axes));                 p += sizeof(axes);
+    *p++ = move->move_flags;
+    memcpy(p, &move->linenum, sizeof(int32_t));     p += sizeof(int32_t);
+
+    if (move->move_flags & XIO_BINARY_FEED) {
+        memcpy(p, &move->feed_rate, sizeof(float)); p += sizeof(float);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (move->flags[axis]) {
+            memcpy(p, &move->target[axis], sizeof(float)); p += sizeof(float);
+        }
+    }
+    return (p - payload);
+}
+
+bool xio_binary_decode(const uint8_t *payload, const uint8_t len, xioBinaryMove_t *move)
+{
+    const uint8_t *p = payload;
+    const uint8_t *end = payload + len;
+    uint16_t axes;
+
+    if (len < 7) { return (false); }
+    memcpy(&axes, p, sizeof(axes));                 p += sizeof(axes);
+    move->move_flags = *p++;
+    memcpy(&move->linenum, p, sizeof(int32_t));     p += sizeof(int32_t);
+
+    if (move->move_flags & XIO_BINARY_FEED) {
+        if (p + sizeof(float) > end) { return (false); }
+        memcpy(&move->feed_rate, p, sizeof(float)); p += sizeof(float);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        move->flags[axis] = axes & (1 << axis);
+        if (move->flags[axis]) {
+            if (p + sizeof(float) > end) { return (false); }
+            memcpy(&move->target[axis], p, sizeof(float)); p += sizeof(float);
+        } else {
+            move->target[axis] = 0;
+        }
+    }
+    return (p == end);                              // trailing garbage is a framing error too
+}
+
+/*
+ * xio_binary_write()           - send one payload to the host as a binary frame
+ * xio_binary_write_secondary() - send one payload as a binary frame on SerialUSB1 only
+ *
+ *  xio_binary_write_secondary() never waits. It returns false, and the frame is dropped,
+ *  if the board has no second USB port, the port isn't open or its TX ring has no room
+ *  for the whole frame. If the vendor bulk interface is open it is used instead; a frame
+ *  is smaller than one bulk packet, so one that has started is finished rather than cut.
+ */
+
+void xio_binary_write(const uint8_t *payload, const uint8_t len)
+{
+    uint8_t header[2] = { XIO_BINARY_SYNC, len };
+    uint8_t check = 0;
+
+    for (uint8_t i = 0; i < len; i++) {
+        check ^= payload[i];
+    }
+    xio_write((const char *)header, sizeof(header));
+    xio_write((const char *)payload, len);
+    xio_write((const char *)&check, 1);
+}
+
+bool xio_binary_write_secondary(const uint8_t *payload, const uint8_t len)
+{
+#if (XIO_HAS_USB == 1) && ((USB_SERIAL_PORTS_EXPOSED == 2) || (USB_VENDOR_BULK_EXPOSED == 1))
+    uint8_t frame[2 + UINT8_MAX + 1];
+    uint8_t check = 0;
+
+    frame[0] = XIO_BINARY_SYNC;
+    frame[1] = len;
+    for (uint8_t i = 0; i < len; i++) {
+        frame[2 + i] = payload[i];
+        check ^= payload[i];
+    }
+    frame[2 + len] = check;
+#if USB_VENDOR_BULK_EXPOSED == 1
+    if (VendorUSB.isConnected()) {
+        int32_t sent = VendorUSB.writeSome((const char *)frame, len + 3);
+        if (sent <= 0) {
+            return (false);
+        }
+        while (sent < len + 3) {
+            int32_t more = VendorUSB.writeSome((const char *)frame + sent, len + 3 - sent);
+            if (more < 0) {
+                return (false);
+            }
+            sent += more;
+        }
+        VendorUSB.flush();
+        return (true);
+    }
+#endif
+#if USB_SERIAL_PORTS_EXPOSED == 2
+    return (serialUSB1Wrapper.writeWhole((const char *)frame, len + 3) > 0);
+#else
+    return (false);
+#endif
+#else
+    return (false);
+#endif
+}
+
 /***********************************************************************************
  * newlib-nano support functions
  * Here we wire printf to xio
@@ -1428,6 +1978,90 @@ int _write( int file, char *ptr, int len )
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
 
+/*
+ * xio_get_rxhx() - get count of readline() calls that skipped scanning because a device
+ *                  had used all of its RX line headers (summed over all devices)
+ */
+stat_t xio_get_rxhx(nvObj_t *nv)
+{
+    nv->value_int = xio.headerExhaustedCount();
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+/*
+ * xio_get_stats() - get all transfer statistics, summed over all devices
+ */
+void xio_get_stats(xioStats_t &stats)
+{
+    xio.getStats(stats);
+}
+
+/*
+ * xio_get_stat() - get one transfer statistic, summed over all devices, decoded from the token:
+ *                  xio + {rb=RX bytes, tb=TX bytes, rs=RX stalls, hw=RX high-water,
+ *                         tw=TX full waits, ls=lines skipped}
+ *
+ *  An RX stall is a full RX ring with no transfer running - the host is NAKed until
+ *  lines are read. TX full waits are writes that found the TX ring full and had to wait
+ *  (or were refused, for non-blocking writes).
+ */
+stat_t xio_get_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    xioStats_t stats;
+    xio.getStats(stats);
+
+    switch (token[3]) {
+        case 'r': { return (get_integer(nv, (token[4] == 'b') ? stats.rx_bytes : stats.rx_stalls)); }
+        case 't': { return (get_integer(nv, (token[4] == 'b') ? stats.tx_bytes : stats.tx_full_waits)); }
+        case 'h': { return (get_integer(nv, stats.rx_high_water)); }
+        case 'l': { return (get_integer(nv, stats.lines_skipped)); }
+        default:  { return (STAT_INTERNAL_ERROR); }
+    }
+}
+
+/*
+ * xio_rx_buffer_bytes() - RAM held for receiving: device RX rings and line buffers,
+ *                         the flash file line buffer and the binary move queue
+ * xio_tx_buffer_bytes() - RAM held by the device TX rings
+ */
+uint32_t xio_rx_buffer_bytes()
+{
+    uint32_t bytes = sizeof(flashFileWrapper);
+#if XIO_BINARY_CHANNEL_ENABLED == true
+    bytes += sizeof(xb);
+#if (XIO_HAS_USB == 1) && (USB_VENDOR_BULK_EXPOSED == 1)
+    bytes += sizeof(xv);
+#endif
+#endif // XIO_BINARY_CHANNEL_ENABLED
+#if XIO_HAS_USB == 1
+    bytes += sizeof(serialUSB0Wrapper._rx_buffer);
+#if USB_SERIAL_PORTS_EXPOSED == 2
+    bytes += sizeof(serialUSB1Wrapper._rx_buffer);
+#endif
+#endif // XIO_HAS_USB
+#if XIO_HAS_UART == 1
+    bytes += sizeof(serial0Wrapper._rx_buffer);
+#endif
+    return (bytes);
+}
+
+uint32_t xio_tx_buffer_bytes()
+{
+    uint32_t bytes = 0;
+#if XIO_HAS_USB == 1
+    bytes += sizeof(serialUSB0Wrapper._tx_buffer);
+#if USB_SERIAL_PORTS_EXPOSED == 2
+    bytes += sizeof(serialUSB1Wrapper._tx_buffer);
+#endif
+#endif // XIO_HAS_USB
+#if XIO_HAS_UART == 1
+    bytes += sizeof(serial0Wrapper._tx_buffer);
+#endif
+    return (bytes);
+}
+
 /*
  * xio_set_spi() = 0=disable, 1=enable
  */
@@ -1458,4 +2092,20 @@ int _write( int file, char *ptr, int len )
 static const char fmt_spi[] = "[spi] SPI state%20d [0=disabled,1=enabled]\n";
 void xio_print_spi(nvObj_t *nv) { text_print(nv, fmt_spi);} // TYPE_INT
 
+static const char fmt_xio_stat[] = "[%s] %s%*lu\n";
+
+void xio_print_stat(nvObj_t *nv)
+{
+    const char *token = cfgArray[nv->index].token;
+    const char *label;
+    switch (token[3]) {
+        case 'r': { label = (token[4] == 'b') ? "RX bytes" : "RX stalls"; break; }
+        case 't': { label = (token[4] == 'b') ? "TX bytes" : "TX full waits"; break; }
+        case 'h': { label = "RX high-water"; break; }
+        default:  { label = "lines skipped"; break; }
+    }
+    sprintf(cs.out_buf, fmt_xio_stat, token, label, (int)(30 - strlen(label)), (unsigned long)nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
 #endif // __TEXT_MODE
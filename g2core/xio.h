@@ -110,6 +110,22 @@ enum xioSPIMode {
 /**** readline stuff *****/
 
 #define RX_BUFFER_SIZE       512            // maximum length of recieved lines from xio_readline
+#ifndef XIO_CREDIT_RESERVE
+#define XIO_CREDIT_RESERVE   128            // RX bytes kept back from credits for control lines (see {crm:})
+#endif
+
+/**** output lanes ****/
+/*  Output is queued in one of three lanes. The port drains the highest lane that has data,
+ *  switching only between whole lines, so a long report or help dump never holds back the
+ *  acks the host is waiting on. Writes go to the current lane - set it with xio_set_lane()
+ *  around the writes and put the old lane back after.
+ */
+enum xioLane {
+    XIO_LANE_ACK = 0,                       // responses, footers, exceptions and alarms
+    XIO_LANE_REPORT,                        // status and queue reports
+    XIO_LANE_BULK,                          // everything else - text listings, help, diagnostics
+    XIO_LANES
+};
 
 /**** function prototypes ****/
 
@@ -119,13 +135,31 @@ stat_t xio_test_assertions(void);
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted = false);
 char *xio_readline(devflags_t &flags, uint16_t &size);
 int16_t xio_writeline(const char *buffer, bool only_to_muted = false);
+xioLane xio_set_lane(xioLane lane);
 bool xio_connected();
 void xio_flush_to_command();
+uint16_t xio_credit_window();
+uint16_t xio_take_credits();
+uint32_t xio_rx_buffer_bytes();
+uint32_t xio_tx_buffer_bytes();
 #if MARLIN_COMPAT_ENABLED == true
 void xio_exit_fake_bootloader();
 #endif
 
 stat_t xio_set_spi(nvObj_t *nv);
+stat_t xio_get_rxhx(nvObj_t *nv);
+stat_t xio_get_stat(nvObj_t *nv);
+
+typedef struct xioStats {           // transfer statistics, summed over all devices
+    uint32_t rx_bytes;              // bytes received
+    uint32_t tx_bytes;              // bytes written
+    uint32_t rx_stalls;             // times an RX ring filled and receiving stopped
+    uint32_t rx_high_water;         // most bytes waiting in any one RX ring
+    uint32_t tx_full_waits;         // writes that found the TX ring full
+    uint32_t lines_skipped;         // too-long lines that had their tail skipped
+} xioStats_t;
+
+void xio_get_stats(xioStats_t &stats);
 
 /**** newlib-nano support function(s) ****/
 extern "C" {
@@ -228,13 +262,84 @@ constexpr xio_flash_file make_xio_flash_file(const char (&data)[length]) {
 
 bool xio_send_file(xio_flash_file &file);
 
+/**** Binary move channel ****
+ *
+ *  Optional framed binary channel for high-density toolpaths. Each frame carries one
+ *  pre-tokenized straight move that is handed directly to cm_straight_feed() (or
+ *  cm_straight_traverse()), bypassing line scanning, block normalization and number parsing.
+ *  JSON and text commands continue to use the normal line-oriented path.
+ *
+ *  Frame layout (multi-byte fields are little-endian):
+ *
+ *      SYNC     uint8      XIO_BINARY_SYNC - only at the start of a line, or right after a frame
+ *      LEN      uint8      length of the payload that follows
+ *      payload:
+ *        axes   uint16     one bit per axis, (1 << AXIS_X) ... (1 << AXIS_C)
+ *        flags  uint8      XIO_BINARY_ flags, below
+ *        line   int32      line number (reported as "line" in status reports)
+ *        feed   float      feed rate - present only if XIO_BINARY_FEED is set
+ *        target float[n]   one float per set axis bit, in axis order
+ *      CHECK    uint8      XOR of all payload bytes
+ *
+ *  Targets are interpreted in the current gcode modal state (units, distance mode,
+ *  coordinate system), exactly as the axis words of a G0 or G1 block would be.
+ *  Frames that fail the length or checksum test are dropped and counted.
+ *
+ *  Frames and text lines run in the order they were sent. The host paces frames using queue
+ *  reports. A frame that finds the move queue full is dropped, and is reported as a
+ *  STAT_BUFFER_FULL exception naming its line number. Frames after it are dropped until
+ *  that line is sent again.
+ *
+ *  The same payload is used for the moves of a stored job (see job.h).
+ *
+ *  Bulk diagnostic records are sent to the host with the same framing by xio_binary_write().
+ *  The first payload byte of an outgoing frame is a record type (e.g. ENCODER_LOG_RECORD).
+ *  Outgoing frames are not affected by XIO_BINARY_CHANNEL_ENABLED. Records meant for a
+ *  monitor rather than the controlling host (e.g. SR_BINARY_RECORD) go out on SerialUSB1
+ *  through xio_binary_write_secondary(), which drops a frame rather than wait.
+ *
+ *  With USB_VENDOR_BULK_EXPOSED the board also has a vendor-class bulk interface (WinUSB /
+ *  libusb, no tty). Move frames sent to it are decoded like those on the serial port, and
+ *  a host that has it open gets the secondary records there instead of on SerialUSB1.
+ *  Nothing but frames goes on it. The host opens it with the kVendorBulkSetOpen request
+ *  (see MotateUSBVendor.h).
+ */
+
+#define XIO_BINARY_SYNC         0xA5        // frame start marker
+#define XIO_BINARY_QUEUE_SIZE   8           // decoded moves waiting for the controller (must be power of 2)
+#define XIO_BINARY_PAYLOAD_MAX  (2 + 1 + 4 + 4 + 4*AXES)
+
+#define XIO_BINARY_TRAVERSE     (0x01)      // run as G0 instead of G1
+#define XIO_BINARY_FEED         (0x02)      // frame carries a feed rate (G1 F word)
+
+typedef struct xioBinaryMove {
+    int32_t linenum;                        // line number of the move
+    float feed_rate;                        // valid if XIO_BINARY_FEED is set
+    float target[AXES];                     // targets for flagged axes
+    bool flags[AXES];                       // axis flags as passed to cm_straight_feed()
+    uint8_t move_flags;                     // XIO_BINARY_ flags
+} xioBinaryMove_t;
+
+bool xio_binary_rx(const uint8_t c);
+bool xio_binary_rx_at(const uint8_t c, const uint32_t mark);
+bool xio_binary_ready(void);
+bool xio_binary_read_move(xioBinaryMove_t *move);
+bool xio_binary_overrun(int32_t *linenum);
+uint32_t xio_binary_error_count(void);
+uint8_t xio_binary_encode(const xioBinaryMove_t *move, uint8_t *payload);
+bool xio_binary_decode(const uint8_t *payload, const uint8_t len, xioBinaryMove_t *move);
+void xio_binary_write(const uint8_t *payload, const uint8_t len);
+bool xio_binary_write_secondary(const uint8_t *payload, const uint8_t len);
+
 #ifdef __TEXT_MODE
 
     void xio_print_spi(nvObj_t *nv);
+    void xio_print_stat(nvObj_t *nv);
 
 #else
 
     #define xio_print_spi tx_print_stub
+    #define xio_print_stat tx_print_stub
 
 #endif // __TEXT_MODE
 